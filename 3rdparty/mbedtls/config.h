@@ -430,7 +430,9 @@
 //#define MBEDTLS_MD5_PROCESS_ALT
 //#define MBEDTLS_RIPEMD160_PROCESS_ALT
 //#define MBEDTLS_SHA1_PROCESS_ALT
-//#define MBEDTLS_SHA256_PROCESS_ALT
+// Open Enclave: Use the SHA extensions when available (see
+// mbedtls_sha256_process.c).
+#define MBEDTLS_SHA256_PROCESS_ALT
 //#define MBEDTLS_SHA512_PROCESS_ALT
 //#define MBEDTLS_DES_SETKEY_ALT
 //#define MBEDTLS_DES_CRYPT_ECB_ALT
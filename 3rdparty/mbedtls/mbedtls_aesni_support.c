@@ -0,0 +1,23 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/types.h>
+
+#if defined(__x86_64__)
+#include <openenclave/internal/cpuid.h>
+
+int __wrap_mbedtls_aesni_has_support(unsigned int what);
+
+/*
+ * mbedtls_aesni_has_support() executes CPUID, which traps in an SGX enclave,
+ * the first time that each thread races to call it. The enclave links with
+ * --wrap=mbedtls_aesni_has_support, so that the callers in aes.c and gcm.c
+ * read the CPUID table cached at enclave creation instead. The features are
+ * those of ECX of leaf 1 (MBEDTLS_AESNI_AES and MBEDTLS_AESNI_CLMUL).
+ */
+int __wrap_mbedtls_aesni_has_support(unsigned int what)
+{
+    return oe_has_cpuid_feature(1, what, OE_CPUID_RCX);
+}
+#endif
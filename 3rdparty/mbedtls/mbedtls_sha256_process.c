@@ -0,0 +1,115 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/types.h>
+#include "mbedtls/include/mbedtls/sha256.h"
+
+#if defined(__x86_64__)
+#include <openenclave/internal/cpuid.h>
+#endif
+
+int mbedtls_internal_sha256_process(
+    mbedtls_sha256_context* ctx,
+    const unsigned char data[64]);
+
+void oe_sha256_ni_process(
+    uint32_t state[8],
+    const unsigned char* data,
+    size_t blocks);
+
+static const uint32_t _k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define S0(x) (ROTR(x, 7) ^ ROTR(x, 18) ^ ((x) >> 3))
+#define S1(x) (ROTR(x, 17) ^ ROTR(x, 19) ^ ((x) >> 10))
+#define S2(x) (ROTR(x, 2) ^ ROTR(x, 13) ^ ROTR(x, 22))
+#define S3(x) (ROTR(x, 6) ^ ROTR(x, 11) ^ ROTR(x, 25))
+#define CH(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
+#define MAJ(x, y, z) (((x) & (y)) | ((z) & ((x) | (y))))
+
+/* The portable block function, equivalent to the one in sha256.c. */
+static void _process(uint32_t state[8], const unsigned char data[64])
+{
+    uint32_t w[64];
+    uint32_t s[8];
+    size_t i;
+
+    for (i = 0; i < 16; i++)
+    {
+        w[i] = (uint32_t)data[4 * i] << 24 | (uint32_t)data[4 * i + 1] << 16 |
+               (uint32_t)data[4 * i + 2] << 8 | (uint32_t)data[4 * i + 3];
+    }
+
+    for (; i < 64; i++)
+        w[i] = S1(w[i - 2]) + w[i - 7] + S0(w[i - 15]) + w[i - 16];
+
+    for (i = 0; i < 8; i++)
+        s[i] = state[i];
+
+    for (i = 0; i < 64; i++)
+    {
+        uint32_t t1 = s[7] + S3(s[4]) + CH(s[4], s[5], s[6]) + _k[i] + w[i];
+        uint32_t t2 = S2(s[0]) + MAJ(s[0], s[1], s[2]);
+
+        s[7] = s[6];
+        s[6] = s[5];
+        s[5] = s[4];
+        s[4] = s[3] + t1;
+        s[3] = s[2];
+        s[2] = s[1];
+        s[1] = s[0];
+        s[0] = t1 + t2;
+    }
+
+    for (i = 0; i < 8; i++)
+        state[i] += s[i];
+}
+
+#if defined(__x86_64__)
+/* 1 if the SHA extensions are available, 0 if not, -1 if not checked yet. */
+static volatile int _has_sha_ni = -1;
+#endif
+
+/*
+ * MBEDTLS links this function definition when MBEDTLS_SHA256_PROCESS_ALT is
+ * defined in the MBEDTLS config.h file. It hashes with the SHA extensions when
+ * the CPUID table of the enclave reports them and with portable C otherwise.
+ * All SHA-256 hashing in the enclave goes through it, including
+ * oe_sha256_*() and oe_hmac_sha256_*().
+ */
+int mbedtls_internal_sha256_process(
+    mbedtls_sha256_context* ctx,
+    const unsigned char data[64])
+{
+#if defined(__x86_64__)
+    /* Hashes computed before the CPUID table is initialized use portable C,
+     * without caching that choice. */
+    if (_has_sha_ni < 0 && oe_is_cpuid_initialized())
+    {
+        _has_sha_ni =
+            oe_has_cpuid_feature(7, OE_CPUID_SHA_FEATURE, OE_CPUID_RBX) ? 1
+                                                                        : 0;
+    }
+
+    if (_has_sha_ni > 0)
+    {
+        oe_sha256_ni_process(ctx->state, data, 1);
+        return 0;
+    }
+#endif
+
+    _process(ctx->state, data);
+    return 0;
+}
@@ -0,0 +1,26 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_BENCHMARKS_H
+#define _OE_BENCHMARKS_H
+
+/* The OCALLs enc_call_host() makes in a loop. */
+#define BENCHMARK_OCALL_EMPTY 0
+#define BENCHMARK_OCALL_SWITCHLESS 1
+#define BENCHMARK_OCALL_IN 2
+#define BENCHMARK_OCALL_OUT 3
+
+/* The functions enc_mem() calls in a loop. */
+#define BENCHMARK_MEM_MEMCPY 0
+#define BENCHMARK_MEM_MEMMOVE 1
+#define BENCHMARK_MEM_MEMSET 2
+#define BENCHMARK_MEM_MEMCMP 3
+
+/* Added to the kinds above to call the portable versions of oecore
+ * instead. */
+#define BENCHMARK_MEM_GENERIC 4
+
+/* The most host threads that call into the enclave at the same time. */
+#define BENCHMARK_MAX_THREADS 8
+
+#endif /* _OE_BENCHMARKS_H */
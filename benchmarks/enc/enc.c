@@ -0,0 +1,371 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/corelibc/errno.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/crypto/hmac.h>
+#include <openenclave/internal/crypto/sha.h>
+#include <openenclave/internal/memfuncs.h>
+#include <openenclave/internal/syscall/arpa/inet.h>
+#include <openenclave/internal/syscall/device.h>
+#include <openenclave/internal/syscall/fcntl.h>
+#include <openenclave/internal/syscall/netinet/in.h>
+#include <openenclave/internal/syscall/sys/socket.h>
+#include <openenclave/internal/syscall/unistd.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../benchmarks.h"
+#include "benchmarks_t.h"
+
+void enc_empty(void)
+{
+}
+
+void enc_in(const void* buf, size_t size)
+{
+    OE_UNUSED(buf);
+    OE_UNUSED(size);
+}
+
+void enc_out(void* buf, size_t size)
+{
+    OE_UNUSED(buf);
+    OE_UNUSED(size);
+}
+
+int enc_call_host(uint64_t iterations, size_t size, int kind)
+{
+    int ret = -1;
+    uint8_t* buf = NULL;
+
+    if (size && !(buf = calloc(1, size)))
+        goto done;
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        oe_result_t result = OE_UNEXPECTED;
+
+        switch (kind)
+        {
+            case BENCHMARK_OCALL_EMPTY:
+                result = host_empty();
+                break;
+            case BENCHMARK_OCALL_SWITCHLESS:
+                result = host_empty_switchless();
+                break;
+            case BENCHMARK_OCALL_IN:
+                result = host_in(buf, size);
+                break;
+            case BENCHMARK_OCALL_OUT:
+                result = host_out(buf, size);
+                break;
+        }
+
+        if (result != OE_OK)
+            goto done;
+    }
+
+    ret = 0;
+
+done:
+    free(buf);
+    return ret;
+}
+
+int enc_malloc(uint64_t iterations, size_t size)
+{
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        void* ptr = malloc(size);
+
+        if (!ptr)
+            return -1;
+
+        /* Touch the block so that the allocation cannot be elided. */
+        *(volatile uint8_t*)ptr = (uint8_t)i;
+        free(ptr);
+    }
+
+    return 0;
+}
+
+/* Two threads take turns: each waits until it is its turn, hands the turn
+ * to the other one and wakes it up. Every round flips the turn twice, so the
+ * state is back to player 0 when both threads return. */
+static pthread_mutex_t _ping_pong_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _ping_pong_cond = PTHREAD_COND_INITIALIZER;
+static int _ping_pong_turn;
+
+int enc_ping_pong(uint64_t iterations, int player)
+{
+    if (player != 0 && player != 1)
+        return -1;
+
+    pthread_mutex_lock(&_ping_pong_mutex);
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        while (_ping_pong_turn != player)
+            pthread_cond_wait(&_ping_pong_cond, &_ping_pong_mutex);
+
+        _ping_pong_turn = !player;
+        pthread_cond_signal(&_ping_pong_cond);
+    }
+
+    pthread_mutex_unlock(&_ping_pong_mutex);
+
+    return 0;
+}
+
+int enc_hostfs(const char* path, uint64_t iterations, size_t size, bool write)
+{
+    int ret = -1;
+    int fd = -1;
+    uint8_t* buf = NULL;
+    const int flags = write ? OE_O_WRONLY | OE_O_CREAT | OE_O_TRUNC
+                            : OE_O_RDONLY;
+
+    if (oe_load_module_host_file_system() != OE_OK)
+        goto done;
+
+    if (!(buf = calloc(1, size)))
+        goto done;
+
+    fd = oe_open_d(OE_DEVID_HOST_FILE_SYSTEM, path, flags, 0644);
+    if (fd < 0)
+        goto done;
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        ssize_t n = write ? oe_write(fd, buf, size) : oe_read(fd, buf, size);
+
+        if (n != (ssize_t)size)
+            goto done;
+    }
+
+    ret = 0;
+
+done:
+    if (fd >= 0)
+        oe_close(fd);
+
+    free(buf);
+    return ret;
+}
+
+/* Both ends of the connection live in the enclave and every chunk that is
+ * sent is received before the next one, so the socket buffers never fill up
+ * and a single thread can drive the transfer. */
+int enc_hostsock(uint64_t iterations, size_t size)
+{
+    int ret = -1;
+    int listener = -1;
+    int client = -1;
+    int server = -1;
+    uint8_t* buf = NULL;
+    struct oe_sockaddr_in addr = {0};
+    oe_socklen_t addrlen = sizeof(addr);
+
+    if (oe_load_module_host_socket_interface() != OE_OK)
+        goto done;
+
+    if (!(buf = calloc(1, size)))
+        goto done;
+
+    addr.sin_family = OE_AF_INET;
+    addr.sin_addr.s_addr = oe_htonl(OE_INADDR_LOOPBACK);
+    addr.sin_port = 0;
+
+    if ((listener = oe_socket(OE_AF_INET, OE_SOCK_STREAM, 0)) < 0 ||
+        oe_bind(listener, (struct oe_sockaddr*)&addr, sizeof(addr)) != 0 ||
+        oe_listen(listener, 1) != 0 ||
+        oe_getsockname(listener, (struct oe_sockaddr*)&addr, &addrlen) != 0)
+        goto done;
+
+    if ((client = oe_socket(OE_AF_INET, OE_SOCK_STREAM, 0)) < 0 ||
+        oe_connect(client, (struct oe_sockaddr*)&addr, sizeof(addr)) != 0)
+        goto done;
+
+    if ((server = oe_accept(listener, NULL, NULL)) < 0)
+        goto done;
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        size_t received = 0;
+
+        if (oe_send(client, buf, size, 0) != (ssize_t)size)
+            goto done;
+
+        while (received < size)
+        {
+            ssize_t n = oe_recv(server, buf + received, size - received, 0);
+
+            if (n <= 0)
+                goto done;
+
+            received += (size_t)n;
+        }
+    }
+
+    ret = 0;
+
+done:
+    if (server >= 0)
+        oe_close(server);
+
+    if (client >= 0)
+        oe_close(client);
+
+    if (listener >= 0)
+        oe_close(listener);
+
+    free(buf);
+    return ret;
+}
+
+int enc_random(uint64_t iterations, size_t size)
+{
+    int ret = -1;
+    uint8_t* buf = NULL;
+
+    if (!(buf = malloc(size)))
+        goto done;
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        if (oe_random(buf, size) != OE_OK)
+            goto done;
+    }
+
+    ret = 0;
+
+done:
+    free(buf);
+    return ret;
+}
+
+int enc_sha256(uint64_t iterations, size_t size)
+{
+    int ret = -1;
+    uint8_t* buf = NULL;
+
+    if (!(buf = calloc(1, size)))
+        goto done;
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        oe_sha256_context_t context;
+        OE_SHA256 hash;
+
+        if (oe_sha256_init(&context) != OE_OK ||
+            oe_sha256_update(&context, buf, size) != OE_OK ||
+            oe_sha256_final(&context, &hash) != OE_OK)
+            goto done;
+    }
+
+    ret = 0;
+
+done:
+    free(buf);
+    return ret;
+}
+
+int enc_hmac_sha256(uint64_t iterations, size_t size)
+{
+    int ret = -1;
+    uint8_t* buf = NULL;
+    static const uint8_t key[32] = {0x42};
+
+    if (!(buf = calloc(1, size)))
+        goto done;
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        oe_hmac_sha256_context_t context;
+        OE_SHA256 hash;
+
+        if (oe_hmac_sha256_init(&context, key, sizeof(key)) != OE_OK)
+            goto done;
+
+        if (oe_hmac_sha256_update(&context, buf, size) != OE_OK ||
+            oe_hmac_sha256_final(&context, &hash) != OE_OK)
+        {
+            oe_hmac_sha256_free(&context);
+            goto done;
+        }
+
+        oe_hmac_sha256_free(&context);
+    }
+
+    ret = 0;
+
+done:
+    free(buf);
+    return ret;
+}
+
+int enc_mem(uint64_t iterations, size_t size, int kind)
+{
+    int ret = -1;
+    uint8_t* dest = NULL;
+    uint8_t* src = NULL;
+    const bool generic = kind >= BENCHMARK_MEM_GENERIC;
+    volatile int sink = 0;
+
+    /* One byte more, so that memmove() can move the buffer onto itself. */
+    if (!(dest = calloc(1, size + 1)) || !(src = calloc(1, size)))
+        goto done;
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        switch (generic ? kind - BENCHMARK_MEM_GENERIC : kind)
+        {
+            case BENCHMARK_MEM_MEMCPY:
+                if (generic)
+                    oe_generic_memcpy(dest, src, size);
+                else
+                    memcpy(dest, src, size);
+                break;
+            case BENCHMARK_MEM_MEMMOVE:
+                if (generic)
+                    oe_generic_memmove(dest + 1, dest, size);
+                else
+                    memmove(dest + 1, dest, size);
+                break;
+            case BENCHMARK_MEM_MEMSET:
+                if (generic)
+                    oe_generic_memset(dest, (int)i, size);
+                else
+                    memset(dest, (int)i, size);
+                break;
+            case BENCHMARK_MEM_MEMCMP:
+                /* The buffers are equal, so every byte is compared. */
+                if (generic)
+                    sink += oe_generic_memcmp(dest, src, size);
+                else
+                    sink += memcmp(dest, src, size);
+                break;
+            default:
+                goto done;
+        }
+
+        sink += dest[size];
+    }
+
+    ret = 0;
+
+done:
+    free(dest);
+    free(src);
+    return ret;
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,                        /* ProductID */
+    1,                        /* SecurityVersion */
+    true,                     /* AllowDebug */
+    4096,                     /* HeapPageCount */
+    64,                       /* StackPageCount */
+    BENCHMARK_MAX_THREADS + 2 /* TCSCount */
+);
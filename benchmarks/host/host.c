@@ -0,0 +1,711 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <inttypes.h>
+#include <openenclave/host.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../common/sgx/collateral.h"
+#include "../../common/sgx/quote.h"
+#include "../../host/hostthread.h"
+#include "../benchmarks.h"
+#include "benchmarks_u.h"
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#define DEFAULT_QUOTE_PATH "sgx_report.bin"
+#define DEFAULT_COLLATERAL_PATH "sgx_report.bin.col"
+#define HOSTFS_FILE_NAME "benchmarks_hostfs.tmp"
+
+static const size_t _marshalling_sizes[] = {64, 1024, 16 * 1024, 256 * 1024};
+static const size_t _hash_sizes[] = {64, 4096, 64 * 1024};
+static const size_t _mem_sizes[] =
+    {8, 64, 256, 1024, 4096, 64 * 1024, 1024 * 1024};
+static const size_t _malloc_threads[] = {1, 2, 4, BENCHMARK_MAX_THREADS};
+
+static struct
+{
+    double scale;
+    const char* filter;
+    const char* quote_path;
+    const char* collateral_path;
+    FILE* output;
+    size_t num_results;
+    size_t num_failures;
+} _options = {
+    .scale = 1.0,
+    .quote_path = DEFAULT_QUOTE_PATH,
+    .collateral_path = DEFAULT_COLLATERAL_PATH,
+};
+
+void host_empty(void)
+{
+}
+
+void host_empty_switchless(void)
+{
+}
+
+void host_in(const void* buf, size_t size)
+{
+    OE_UNUSED(buf);
+    OE_UNUSED(size);
+}
+
+void host_out(void* buf, size_t size)
+{
+    OE_UNUSED(buf);
+    OE_UNUSED(size);
+}
+
+static uint64_t _now_ns(void)
+{
+#if defined(_WIN32)
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)(
+        (double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/* Scale the default iteration count of a benchmark by --scale. */
+static uint64_t _iterations(uint64_t count)
+{
+    uint64_t scaled = (uint64_t)((double)count * _options.scale);
+    return scaled ? scaled : 1;
+}
+
+static bool _selected(const char* name)
+{
+    return !_options.filter || strstr(name, _options.filter);
+}
+
+static void _begin_result(const char* name)
+{
+    fprintf(
+        _options.output,
+        "%s\n    {\"name\": \"%s\"",
+        _options.num_results++ ? "," : "",
+        name);
+}
+
+/* Write one result. operations is the number of operations that took
+ * elapsed_ns in total, and bytes the number of bytes each one moved. */
+static void _report(
+    const char* name,
+    uint64_t operations,
+    uint64_t bytes,
+    uint64_t elapsed_ns)
+{
+    const double seconds = (double)(elapsed_ns ? elapsed_ns : 1) / 1e9;
+    const double ns_per_op = (double)elapsed_ns / (double)operations;
+    const double ops_per_sec = (double)operations / seconds;
+
+    _begin_result(name);
+    fprintf(
+        _options.output,
+        ", \"iterations\": %" PRIu64 ", \"total_ns\": %" PRIu64
+        ", \"ns_per_op\": %.1f, \"ops_per_sec\": %.1f",
+        operations,
+        elapsed_ns,
+        ns_per_op,
+        ops_per_sec);
+
+    if (bytes)
+    {
+        fprintf(
+            _options.output,
+            ", \"bytes_per_op\": %" PRIu64 ", \"mb_per_sec\": %.2f",
+            bytes,
+            (double)bytes * ops_per_sec / (1024 * 1024));
+    }
+
+    fprintf(_options.output, "}");
+    fprintf(stderr, "%-32s %12.1f ns/op\n", name, ns_per_op);
+}
+
+static void _report_skipped(const char* name, const char* reason)
+{
+    _begin_result(name);
+    fprintf(_options.output, ", \"skipped\": \"%s\"}", reason);
+    fprintf(stderr, "%-32s skipped: %s\n", name, reason);
+}
+
+static void _report_failed(const char* name, oe_result_t result)
+{
+    _begin_result(name);
+    fprintf(
+        _options.output, ", \"failed\": \"%s\"}", oe_result_str(result));
+    fprintf(stderr, "%-32s failed: %s\n", name, oe_result_str(result));
+    _options.num_failures++;
+}
+
+/* Report a benchmark that ran an ECALL returning an int. */
+static void _report_call(
+    const char* name,
+    oe_result_t result,
+    int ret,
+    uint64_t operations,
+    uint64_t bytes,
+    uint64_t elapsed_ns)
+{
+    if (result == OE_OK && ret != 0)
+        result = OE_FAILURE;
+
+    if (result == OE_OK)
+        _report(name, operations, bytes, elapsed_ns);
+    else
+        _report_failed(name, result);
+}
+
+static void _bench_transitions(oe_enclave_t* enclave)
+{
+    const char* name;
+    uint64_t n;
+    uint64_t start;
+    oe_result_t result = OE_OK;
+    int ret = 0;
+
+    if (_selected(name = "ecall_empty"))
+    {
+        n = _iterations(100000);
+        start = _now_ns();
+
+        for (uint64_t i = 0; i < n && result == OE_OK; i++)
+            result = enc_empty(enclave);
+
+        _report_call(name, result, 0, n, 0, _now_ns() - start);
+    }
+
+    /* The OCALL benchmarks time a single ECALL that makes all the OCALLs, so
+     * the cost of the one ECALL is spread over all of them. */
+    if (_selected(name = "ocall_empty"))
+    {
+        n = _iterations(100000);
+        start = _now_ns();
+        result = enc_call_host(enclave, &ret, n, 0, BENCHMARK_OCALL_EMPTY);
+        _report_call(name, result, ret, n, 0, _now_ns() - start);
+    }
+}
+
+static void _bench_switchless(const char* path, uint32_t flags)
+{
+    const char* name = "ocall_switchless";
+    oe_enclave_t* enclave = NULL;
+    oe_enclave_setting_context_switchless_t switchless_setting = {1, 0};
+    oe_enclave_setting_t settings[] = {
+        {.setting_type = OE_ENCLAVE_SETTING_CONTEXT_SWITCHLESS,
+         .u.context_switchless_setting = &switchless_setting}};
+    oe_result_t result;
+    uint64_t n;
+    uint64_t start;
+    int ret = 0;
+
+    if (!_selected(name))
+        return;
+
+    /* Use an enclave of its own so that the host worker thread does not
+     * compete with the other benchmarks for a processor. */
+    if ((result = oe_create_benchmarks_enclave(
+             path,
+             OE_ENCLAVE_TYPE_SGX,
+             flags,
+             settings,
+             OE_COUNTOF(settings),
+             &enclave)) != OE_OK)
+    {
+        _report_failed(name, result);
+        return;
+    }
+
+    n = _iterations(100000);
+    start = _now_ns();
+    result = enc_call_host(enclave, &ret, n, 0, BENCHMARK_OCALL_SWITCHLESS);
+    _report_call(name, result, ret, n, 0, _now_ns() - start);
+
+    oe_terminate_enclave(enclave);
+}
+
+static void _bench_marshalling(oe_enclave_t* enclave)
+{
+    uint8_t* buf = NULL;
+    const size_t max_size =
+        _marshalling_sizes[OE_COUNTOF(_marshalling_sizes) - 1];
+
+    if (!(buf = calloc(1, max_size)))
+        oe_put_err("calloc() failed");
+
+    for (size_t i = 0; i < OE_COUNTOF(_marshalling_sizes); i++)
+    {
+        const size_t size = _marshalling_sizes[i];
+        const uint64_t n = _iterations(size > 16 * 1024 ? 2000 : 20000);
+        char name[64];
+        uint64_t start;
+        oe_result_t result;
+        int ret = 0;
+
+        snprintf(name, sizeof(name), "ecall_in/%zu", size);
+        if (_selected(name))
+        {
+            result = OE_OK;
+            start = _now_ns();
+            for (uint64_t j = 0; j < n && result == OE_OK; j++)
+                result = enc_in(enclave, buf, size);
+            _report_call(name, result, 0, n, size, _now_ns() - start);
+        }
+
+        snprintf(name, sizeof(name), "ecall_out/%zu", size);
+        if (_selected(name))
+        {
+            result = OE_OK;
+            start = _now_ns();
+            for (uint64_t j = 0; j < n && result == OE_OK; j++)
+                result = enc_out(enclave, buf, size);
+            _report_call(name, result, 0, n, size, _now_ns() - start);
+        }
+
+        snprintf(name, sizeof(name), "ocall_in/%zu", size);
+        if (_selected(name))
+        {
+            start = _now_ns();
+            result =
+                enc_call_host(enclave, &ret, n, size, BENCHMARK_OCALL_IN);
+            _report_call(name, result, ret, n, size, _now_ns() - start);
+        }
+
+        snprintf(name, sizeof(name), "ocall_out/%zu", size);
+        if (_selected(name))
+        {
+            start = _now_ns();
+            result =
+                enc_call_host(enclave, &ret, n, size, BENCHMARK_OCALL_OUT);
+            _report_call(name, result, ret, n, size, _now_ns() - start);
+        }
+    }
+
+    free(buf);
+}
+
+typedef struct _thread_args
+{
+    oe_enclave_t* enclave;
+    uint64_t iterations;
+    int player;
+    oe_result_t result;
+    int ret;
+} thread_args_t;
+
+static void* _malloc_thread(void* arg)
+{
+    thread_args_t* args = (thread_args_t*)arg;
+
+    args->result =
+        enc_malloc(args->enclave, &args->ret, args->iterations, 64);
+    return NULL;
+}
+
+static void* _ping_pong_thread(void* arg)
+{
+    thread_args_t* args = (thread_args_t*)arg;
+
+    args->result = enc_ping_pong(
+        args->enclave, &args->ret, args->iterations, args->player);
+    return NULL;
+}
+
+/* Run func on num_threads host threads at once and report the total number
+ * of iterations over the wall-clock time they took together. */
+static void _run_threads(
+    const char* name,
+    oe_enclave_t* enclave,
+    size_t num_threads,
+    uint64_t iterations,
+    uint64_t operations,
+    void* (*func)(void*))
+{
+    oe_thread_t threads[BENCHMARK_MAX_THREADS];
+    thread_args_t args[BENCHMARK_MAX_THREADS];
+    oe_result_t result = OE_OK;
+    int ret = 0;
+    uint64_t start = _now_ns();
+
+    for (size_t i = 0; i < num_threads; i++)
+    {
+        args[i].enclave = enclave;
+        args[i].iterations = iterations;
+        args[i].player = (int)i;
+        args[i].result = OE_UNEXPECTED;
+        args[i].ret = -1;
+
+        if (oe_thread_create(&threads[i], func, &args[i]) != 0)
+            oe_put_err("oe_thread_create() failed");
+    }
+
+    for (size_t i = 0; i < num_threads; i++)
+    {
+        oe_thread_join(threads[i]);
+
+        if (args[i].result != OE_OK)
+            result = args[i].result;
+        else if (args[i].ret != 0)
+            ret = args[i].ret;
+    }
+
+    _report_call(name, result, ret, operations, 0, _now_ns() - start);
+}
+
+static void _bench_threads(oe_enclave_t* enclave)
+{
+    char name[64];
+
+    for (size_t i = 0; i < OE_COUNTOF(_malloc_threads); i++)
+    {
+        const size_t num_threads = _malloc_threads[i];
+        const uint64_t n = _iterations(200000);
+
+        snprintf(name, sizeof(name), "malloc_free/%zu_threads", num_threads);
+        if (_selected(name))
+            _run_threads(
+                name, enclave, num_threads, n, n * num_threads, _malloc_thread);
+    }
+
+    /* One operation is a round trip: each thread waits for the other once. */
+    if (_selected("mutex_cond_ping_pong"))
+    {
+        const uint64_t n = _iterations(20000);
+
+        _run_threads(
+            "mutex_cond_ping_pong", enclave, 2, n, n, _ping_pong_thread);
+    }
+}
+
+static void _bench_hostfs(oe_enclave_t* enclave)
+{
+    static const size_t sizes[] = {4096, 64 * 1024};
+    char path[1024];
+
+#if defined(_WIN32)
+    if (!GetCurrentDirectoryA(sizeof(path), path))
+        oe_put_err("GetCurrentDirectory() failed");
+#else
+    if (!getcwd(path, sizeof(path)))
+        oe_put_err("getcwd() failed");
+#endif
+
+    strncat(path, "/" HOSTFS_FILE_NAME, sizeof(path) - strlen(path) - 1);
+
+    for (size_t i = 0; i < OE_COUNTOF(sizes); i++)
+    {
+        const size_t size = sizes[i];
+        const uint64_t n = _iterations(size > 4096 ? 500 : 5000);
+        char write_name[64];
+        char read_name[64];
+        uint64_t start;
+        oe_result_t result;
+        int ret = 0;
+
+        snprintf(write_name, sizeof(write_name), "hostfs_write/%zu", size);
+        snprintf(read_name, sizeof(read_name), "hostfs_read/%zu", size);
+
+        /* The read benchmark reads back what the write benchmark wrote. */
+        if (_selected(write_name) || _selected(read_name))
+        {
+            start = _now_ns();
+            result = enc_hostfs(enclave, &ret, path, n, size, true);
+            if (_selected(write_name))
+                _report_call(
+                    write_name, result, ret, n, size, _now_ns() - start);
+        }
+
+        if (_selected(read_name))
+        {
+            start = _now_ns();
+            result = enc_hostfs(enclave, &ret, path, n, size, false);
+            _report_call(read_name, result, ret, n, size, _now_ns() - start);
+        }
+
+        remove(path);
+    }
+}
+
+static void _bench_hostsock(oe_enclave_t* enclave)
+{
+    const size_t size = 16 * 1024;
+    const uint64_t n = _iterations(10000);
+    const char* name = "hostsock_loopback/16384";
+    uint64_t start;
+    oe_result_t result;
+    int ret = 0;
+
+    if (!_selected(name))
+        return;
+
+    start = _now_ns();
+    result = enc_hostsock(enclave, &ret, n, size);
+    _report_call(name, result, ret, n, size, _now_ns() - start);
+}
+
+static void _bench_crypto(oe_enclave_t* enclave)
+{
+    static const size_t random_sizes[] = {32, 4096};
+    char name[64];
+    uint64_t start;
+    oe_result_t result;
+    int ret = 0;
+
+    for (size_t i = 0; i < OE_COUNTOF(random_sizes); i++)
+    {
+        const size_t size = random_sizes[i];
+        const uint64_t n = _iterations(size > 32 ? 10000 : 100000);
+
+        snprintf(name, sizeof(name), "oe_random/%zu", size);
+        if (_selected(name))
+        {
+            start = _now_ns();
+            result = enc_random(enclave, &ret, n, size);
+            _report_call(name, result, ret, n, size, _now_ns() - start);
+        }
+    }
+
+    for (size_t i = 0; i < OE_COUNTOF(_hash_sizes); i++)
+    {
+        const size_t size = _hash_sizes[i];
+        const uint64_t n = _iterations(size > 4096 ? 2000 : 50000);
+
+        snprintf(name, sizeof(name), "sha256/%zu", size);
+        if (_selected(name))
+        {
+            start = _now_ns();
+            result = enc_sha256(enclave, &ret, n, size);
+            _report_call(name, result, ret, n, size, _now_ns() - start);
+        }
+
+        snprintf(name, sizeof(name), "hmac_sha256/%zu", size);
+        if (_selected(name))
+        {
+            start = _now_ns();
+            result = enc_hmac_sha256(enclave, &ret, n, size);
+            _report_call(name, result, ret, n, size, _now_ns() - start);
+        }
+    }
+}
+
+static void _bench_mem(oe_enclave_t* enclave)
+{
+    static const char* const names[] = {
+        "memcpy", "memmove", "memset", "memcmp"};
+    char name[64];
+    uint64_t start;
+    oe_result_t result;
+    int ret = 0;
+
+    for (size_t i = 0; i < OE_COUNTOF(_mem_sizes); i++)
+    {
+        const size_t size = _mem_sizes[i];
+        const uint64_t n = _iterations(size > 4096 ? 2000 : 1000000);
+
+        for (int kind = 0; kind < (int)OE_COUNTOF(names); kind++)
+        {
+            snprintf(name, sizeof(name), "%s/%zu", names[kind], size);
+            if (_selected(name))
+            {
+                start = _now_ns();
+                result = enc_mem(enclave, &ret, n, size, kind);
+                _report_call(name, result, ret, n, size, _now_ns() - start);
+            }
+
+            snprintf(
+                name, sizeof(name), "%s_generic/%zu", names[kind], size);
+            if (_selected(name))
+            {
+                start = _now_ns();
+                result = enc_mem(
+                    enclave, &ret, n, size, kind + BENCHMARK_MEM_GENERIC);
+                _report_call(name, result, ret, n, size, _now_ns() - start);
+            }
+        }
+    }
+}
+
+static bool _read_file(const char* path, uint8_t** data, size_t* size)
+{
+    FILE* stream = NULL;
+    long length;
+    bool ok = false;
+
+    *data = NULL;
+    *size = 0;
+
+    if (!(stream = fopen(path, "rb")))
+        goto done;
+
+    if (fseek(stream, 0, SEEK_END) != 0 || (length = ftell(stream)) <= 0 ||
+        fseek(stream, 0, SEEK_SET) != 0)
+        goto done;
+
+    if (!(*data = malloc((size_t)length)))
+        goto done;
+
+    if (fread(*data, 1, (size_t)length, stream) != (size_t)length)
+        goto done;
+
+    *size = (size_t)length;
+    ok = true;
+
+done:
+    if (stream)
+        fclose(stream);
+
+    if (!ok)
+    {
+        free(*data);
+        *data = NULL;
+    }
+
+    return ok;
+}
+
+/* Verify the quote and endorsements recorded by oecert, once with the
+ * collateral cache kept warm and once with it cleared before every call. */
+static void _bench_quote_verification(void)
+{
+    static const char* names[] = {"verify_quote", "verify_quote_cold"};
+    uint8_t* quote = NULL;
+    size_t quote_size = 0;
+    uint8_t* collateral = NULL;
+    size_t collateral_size = 0;
+    bool loaded = false;
+
+    for (size_t i = 0; i < OE_COUNTOF(names); i++)
+    {
+        const bool cold = i == 1;
+        const uint64_t n = _iterations(cold ? 200 : 2000);
+        oe_result_t result = OE_OK;
+        uint64_t start;
+
+        if (!_selected(names[i]))
+            continue;
+
+        if (!loaded &&
+            (!_read_file(_options.quote_path, &quote, &quote_size) ||
+             !_read_file(
+                 _options.collateral_path, &collateral, &collateral_size)))
+        {
+            _report_skipped(names[i], "no recorded quote and collateral");
+            continue;
+        }
+
+        loaded = true;
+        oe_sgx_clear_collateral_cache();
+        start = _now_ns();
+
+        for (uint64_t j = 0; j < n && result == OE_OK; j++)
+        {
+            if (cold)
+                oe_sgx_clear_collateral_cache();
+
+            result = oe_verify_sgx_quote(
+                quote, quote_size, collateral, collateral_size, NULL);
+        }
+
+        _report_call(names[i], result, 0, n, 0, _now_ns() - start);
+    }
+
+    free(quote);
+    free(collateral);
+}
+
+static void _usage(const char* program)
+{
+    fprintf(
+        stderr,
+        "Usage: %s ENCLAVE_PATH [--scale FACTOR] [--filter SUBSTRING]\n"
+        "       [--output FILE] [--quote FILE] [--collateral FILE]\n",
+        program);
+    exit(1);
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_result_t result;
+    oe_enclave_t* enclave = NULL;
+    const uint32_t flags = oe_get_create_flags();
+    const char* output_path = NULL;
+
+    if (argc < 2)
+        _usage(argv[0]);
+
+    for (int i = 2; i < argc; i++)
+    {
+        if (i + 1 == argc)
+            _usage(argv[0]);
+
+        if (strcmp(argv[i], "--scale") == 0)
+            _options.scale = atof(argv[++i]);
+        else if (strcmp(argv[i], "--filter") == 0)
+            _options.filter = argv[++i];
+        else if (strcmp(argv[i], "--output") == 0)
+            output_path = argv[++i];
+        else if (strcmp(argv[i], "--quote") == 0)
+            _options.quote_path = argv[++i];
+        else if (strcmp(argv[i], "--collateral") == 0)
+            _options.collateral_path = argv[++i];
+        else
+            _usage(argv[0]);
+    }
+
+    if (_options.scale <= 0)
+        _usage(argv[0]);
+
+    _options.output = stdout;
+    if (output_path && !(_options.output = fopen(output_path, "w")))
+        oe_put_err("cannot open %s", output_path);
+
+    if ((result = oe_create_benchmarks_enclave(
+             argv[1], OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclave)) !=
+        OE_OK)
+        oe_put_err("oe_create_enclave(): result=%u", result);
+
+    fprintf(
+        _options.output,
+        "{\n  \"simulation\": %s,\n  \"scale\": %g,\n  \"benchmarks\": [",
+        (flags & OE_ENCLAVE_FLAG_SIMULATE) ? "true" : "false",
+        _options.scale);
+
+    _bench_transitions(enclave);
+    _bench_switchless(argv[1], flags);
+    _bench_marshalling(enclave);
+    _bench_threads(enclave);
+    _bench_hostfs(enclave);
+    _bench_hostsock(enclave);
+    _bench_crypto(enclave);
+    _bench_mem(enclave);
+    _bench_quote_verification();
+
+    fprintf(_options.output, "\n  ]\n}\n");
+
+    if (_options.output != stdout)
+        fclose(_options.output);
+
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+
+    return _options.num_failures ? 1 : 0;
+}
@@ -0,0 +1,165 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/bits/safemath.h>
+#include <openenclave/internal/channel.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/utils.h>
+
+oe_result_t oe_channel_init(
+    oe_channel_t* channel,
+    void* region,
+    uint64_t region_size,
+    uint64_t num_slots,
+    bool is_host)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint64_t ring_size = 0;
+    uint64_t rings_size = 0;
+    oe_channel_ring_t* to_enclave = NULL;
+    oe_channel_ring_t* to_host = NULL;
+
+    if (!channel || !region)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if ((uint64_t)region % OE_CHANNEL_ALIGNMENT)
+        OE_RAISE(OE_BAD_ALIGNMENT);
+
+    /* The number of slots is a power of two, so that the indexes of the
+     * rings can wrap around. */
+    if (num_slots == 0 || num_slots > OE_CHANNEL_MAX_SLOTS ||
+        (num_slots & (num_slots - 1)))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    ring_size = oe_round_up_to_multiple(
+        sizeof(oe_channel_ring_t) + num_slots * sizeof(oe_channel_message_t),
+        OE_CHANNEL_ALIGNMENT);
+    rings_size = 2 * ring_size;
+
+    if (region_size < rings_size)
+        OE_RAISE(OE_BUFFER_TOO_SMALL);
+
+    to_enclave = (oe_channel_ring_t*)region;
+    to_host = (oe_channel_ring_t*)((uint8_t*)region + ring_size);
+
+    channel->magic = OE_CHANNEL_MAGIC;
+    channel->region = (uint8_t*)region;
+    channel->region_size = region_size;
+    channel->num_slots = num_slots;
+    channel->send_ring = is_host ? to_enclave : to_host;
+    channel->receive_ring = is_host ? to_host : to_enclave;
+    channel->data = (uint8_t*)region + rings_size;
+    channel->data_size = region_size - rings_size;
+    channel->send_tail = channel->send_ring->tail;
+    channel->receive_head = channel->receive_ring->head;
+    channel->next = NULL;
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+bool oe_channel_is_within_data(
+    const oe_channel_t* channel,
+    uint64_t offset,
+    uint64_t size)
+{
+    uint64_t end = 0;
+
+    if (oe_safe_add_u64(offset, size, &end) != OE_OK)
+        return false;
+
+    return end <= channel->data_size;
+}
+
+oe_result_t oe_channel_send(
+    oe_channel_t* channel,
+    const oe_channel_message_t* message)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_channel_ring_t* ring = NULL;
+    uint64_t tail = 0;
+
+    if (!channel || channel->magic != OE_CHANNEL_MAGIC || !message)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (!oe_channel_is_within_data(channel, message->offset, message->size))
+        OE_RAISE(OE_OUT_OF_BOUNDS);
+
+    ring = channel->send_ring;
+    tail = channel->send_tail;
+
+    /* The head is written by the other side. If it is not valid, the ring
+     * is seen as full. */
+    if (tail - ring->head >= channel->num_slots)
+        OE_RAISE_NO_TRACE(OE_BUSY);
+
+    ring->messages[tail & (channel->num_slots - 1)] = *message;
+
+    /* Publish the message after it is written. */
+    OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+    ring->tail = channel->send_tail = tail + 1;
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_channel_receive(
+    oe_channel_t* channel,
+    oe_channel_message_t* message)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_channel_ring_t* ring = NULL;
+    volatile oe_channel_message_t* slot = NULL;
+    uint64_t head = 0;
+    uint64_t tail = 0;
+
+    if (!channel || channel->magic != OE_CHANNEL_MAGIC || !message)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    ring = channel->receive_ring;
+    head = channel->receive_head;
+    tail = ring->tail;
+
+    if (tail == head)
+        OE_RAISE_NO_TRACE(OE_NOT_FOUND);
+
+    /* The tail is written by the other side, which cannot have sent more
+     * messages than the ring holds. */
+    if (tail - head > channel->num_slots)
+        OE_RAISE(OE_UNEXPECTED);
+
+    /* Read the message after its tail. */
+    OE_ATOMIC_MEMORY_BARRIER_ACQUIRE();
+
+    /* Read each field of the message once, since the other side may change
+     * it. */
+    slot = &ring->messages[head & (channel->num_slots - 1)];
+    message->offset = slot->offset;
+    message->size = slot->size;
+    message->tag = slot->tag;
+
+    /* Release the slot after the message is read. */
+    OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+    ring->head = channel->receive_head = head + 1;
+
+    if (!oe_channel_is_within_data(channel, message->offset, message->size))
+        OE_RAISE(OE_OUT_OF_BOUNDS);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+void* oe_channel_get_data(oe_channel_t* channel, size_t* size)
+{
+    if (!channel || channel->magic != OE_CHANNEL_MAGIC || !size)
+        return NULL;
+
+    *size = channel->data_size;
+    return channel->data;
+}
@@ -226,6 +226,11 @@ int32_t oe_datetime_compare(
 }
 
 oe_result_t oe_datetime_now(oe_datetime_t* value)
+{
+    return oe_datetime_from_now(0, value);
+}
+
+oe_result_t oe_datetime_from_now(uint32_t seconds, oe_datetime_t* value)
 {
     oe_result_t result = OE_UNEXPECTED;
     time_t now;
@@ -235,6 +240,7 @@ oe_result_t oe_datetime_now(oe_datetime_t* value)
         OE_RAISE(OE_INVALID_PARAMETER);
 
     time(&now);
+    now += (time_t)seconds;
     timeinfo = gmtime(&now);
 
     value->year = (uint32_t)timeinfo->tm_year + 1900;
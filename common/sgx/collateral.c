@@ -0,0 +1,396 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include "collateral.h"
+#include <openenclave/internal/crypto/crl.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/trace.h>
+#include "../common.h"
+
+#ifdef OE_BUILD_ENCLAVE
+#include <openenclave/internal/thread.h>
+#else
+#include "../../host/hostthread.h"
+#endif
+
+typedef struct _collateral_list
+{
+    oe_sgx_collateral_t* head;
+    size_t count;
+    uint64_t hits;
+} collateral_list_t;
+
+static collateral_list_t _lists[OE_SGX_COLLATERAL_KIND_COUNT];
+
+#ifdef OE_BUILD_ENCLAVE
+static oe_spinlock_t _lock = OE_SPINLOCK_INITIALIZER;
+#define _LOCK() oe_spin_lock(&_lock)
+#define _UNLOCK() oe_spin_unlock(&_lock)
+#else
+static oe_mutex _lock = OE_H_MUTEX_INITIALIZER;
+#define _LOCK() oe_mutex_lock(&_lock)
+#define _UNLOCK() oe_mutex_unlock(&_lock)
+#endif
+
+static bool _is_expired(
+    const oe_sgx_collateral_t* collateral,
+    const oe_datetime_t* now)
+{
+    if (collateral->expiry.year == 0)
+        return false;
+
+    return oe_datetime_compare(now, &collateral->expiry) >= 0;
+}
+
+/* Whether entries of the given kind are created with an expiry. */
+static bool _can_expire(oe_sgx_collateral_kind_t kind)
+{
+    return kind == OE_SGX_COLLATERAL_ENDORSEMENTS ||
+           kind == OE_SGX_COLLATERAL_ATTESTATION_CERT ||
+           kind == OE_SGX_COLLATERAL_OWN_REPORT ||
+           kind == OE_SGX_COLLATERAL_OWN_CERT;
+}
+
+/* Drop a reference with the lock held. Returns the entry if it has to be
+ * destroyed (which is done without holding the lock). */
+static oe_sgx_collateral_t* _unref_locked(oe_sgx_collateral_t* collateral)
+{
+    if (--collateral->refs == 0)
+        return collateral;
+
+    return NULL;
+}
+
+static void _destroy_all(oe_sgx_collateral_t* list)
+{
+    while (list)
+    {
+        oe_sgx_collateral_t* next = list->next;
+        list->destroy(list);
+        list = next;
+    }
+}
+
+void oe_sgx_collateral_init(
+    oe_sgx_collateral_t* collateral,
+    oe_sgx_collateral_kind_t kind,
+    const OE_SHA256* key,
+    void (*destroy)(oe_sgx_collateral_t* collateral))
+{
+    memset(collateral, 0, sizeof(oe_sgx_collateral_t));
+    collateral->refs = 1;
+    collateral->kind = kind;
+    collateral->key = *key;
+    collateral->destroy = destroy;
+}
+
+oe_sgx_collateral_t* oe_sgx_collateral_cache_find(
+    oe_sgx_collateral_kind_t kind,
+    const OE_SHA256* key)
+{
+    collateral_list_t* list = &_lists[kind];
+    oe_sgx_collateral_t* prev = NULL;
+    oe_sgx_collateral_t* p;
+    oe_sgx_collateral_t* found = NULL;
+    oe_sgx_collateral_t* garbage = NULL;
+    oe_datetime_t now = {0};
+
+    /* Entries without an expiry never need the time. */
+    if (_can_expire(kind) && oe_datetime_now(&now) != OE_OK)
+        return NULL;
+
+    _LOCK();
+
+    for (p = list->head; p; prev = p, p = p->next)
+    {
+        if (memcmp(&p->key, key, sizeof(OE_SHA256)) != 0)
+            continue;
+
+        /* Unlink the entry, either to drop it or to move it to the front. */
+        if (prev)
+            prev->next = p->next;
+        else
+            list->head = p->next;
+
+        if (_is_expired(p, &now))
+        {
+            list->count--;
+            if (_unref_locked(p))
+            {
+                p->next = NULL;
+                garbage = p;
+            }
+        }
+        else
+        {
+            p->next = list->head;
+            list->head = p;
+            p->refs++;
+            list->hits++;
+            found = p;
+        }
+        break;
+    }
+
+    _UNLOCK();
+
+    _destroy_all(garbage);
+    return found;
+}
+
+void oe_sgx_collateral_cache_insert(oe_sgx_collateral_t* collateral)
+{
+    collateral_list_t* list = &_lists[collateral->kind];
+    oe_sgx_collateral_t* prev = NULL;
+    oe_sgx_collateral_t* p;
+    oe_sgx_collateral_t* garbage = NULL;
+
+    _LOCK();
+
+    /* Remove an entry with the same key (inserted by a concurrent miss) and,
+     * if the list is full, the least recently used entry. */
+    for (p = list->head; p;)
+    {
+        oe_sgx_collateral_t* next = p->next;
+        bool same = memcmp(&p->key, &collateral->key, sizeof(OE_SHA256)) == 0;
+        bool last = next == NULL;
+
+        if (same || (last && list->count >= OE_SGX_COLLATERAL_CACHE_SIZE))
+        {
+            if (prev)
+                prev->next = next;
+            else
+                list->head = next;
+
+            list->count--;
+
+            if (_unref_locked(p))
+            {
+                p->next = garbage;
+                garbage = p;
+            }
+        }
+        else
+        {
+            prev = p;
+        }
+
+        p = next;
+    }
+
+    collateral->refs++;
+    collateral->next = list->head;
+    list->head = collateral;
+    list->count++;
+
+    _UNLOCK();
+
+    _destroy_all(garbage);
+}
+
+void oe_sgx_collateral_release(oe_sgx_collateral_t* collateral)
+{
+    oe_sgx_collateral_t* garbage;
+
+    if (!collateral)
+        return;
+
+    _LOCK();
+    garbage = _unref_locked(collateral);
+    _UNLOCK();
+
+    if (garbage)
+        garbage->destroy(garbage);
+}
+
+size_t oe_sgx_collateral_cache_get_all(
+    oe_sgx_collateral_kind_t kind,
+    oe_sgx_collateral_t** entries,
+    size_t count)
+{
+    size_t n = 0;
+
+    _LOCK();
+
+    for (oe_sgx_collateral_t* p = _lists[kind].head; p && n < count;
+         p = p->next)
+    {
+        p->refs++;
+        entries[n++] = p;
+    }
+
+    _UNLOCK();
+
+    return n;
+}
+
+uint64_t oe_sgx_collateral_cache_hits(oe_sgx_collateral_kind_t kind)
+{
+    uint64_t hits;
+
+    _LOCK();
+    hits = _lists[kind].hits;
+    _UNLOCK();
+
+    return hits;
+}
+
+static oe_sgx_collateral_t* _clear_list_locked(
+    collateral_list_t* list,
+    oe_sgx_collateral_t* garbage)
+{
+    oe_sgx_collateral_t* p = list->head;
+
+    while (p)
+    {
+        oe_sgx_collateral_t* next = p->next;
+
+        if (_unref_locked(p))
+        {
+            p->next = garbage;
+            garbage = p;
+        }
+
+        p = next;
+    }
+
+    list->head = NULL;
+    list->count = 0;
+    return garbage;
+}
+
+void oe_sgx_clear_collateral_cache(void)
+{
+    oe_sgx_collateral_t* garbage = NULL;
+
+    _LOCK();
+
+    for (size_t i = 0; i < OE_COUNTOF(_lists); i++)
+        garbage = _clear_list_locked(&_lists[i], garbage);
+
+    _UNLOCK();
+
+    _destroy_all(garbage);
+}
+
+void oe_sgx_clear_collateral_cache_kind(oe_sgx_collateral_kind_t kind)
+{
+    oe_sgx_collateral_t* garbage;
+
+    _LOCK();
+    garbage = _clear_list_locked(&_lists[kind], NULL);
+    _UNLOCK();
+
+    _destroy_all(garbage);
+}
+
+oe_result_t oe_sgx_collateral_hash_items(
+    const oe_sgx_endorsements_t* sgx_endorsements,
+    uint32_t first,
+    uint32_t last,
+    OE_SHA256* key)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sha256_context_t context;
+
+    if (!sgx_endorsements || !key || first > last ||
+        last >= OE_SGX_ENDORSEMENT_COUNT)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(oe_sha256_init(&context));
+
+    /* Include the sizes so that the item boundaries are part of the key. */
+    for (uint32_t i = first; i <= last; i++)
+    {
+        const oe_sgx_endorsement_item* item = &sgx_endorsements->items[i];
+
+        OE_CHECK(oe_sha256_update(&context, &item->size, sizeof(item->size)));
+        OE_CHECK(oe_sha256_update(&context, item->data, item->size));
+    }
+
+    OE_CHECK(oe_sha256_final(&context, key));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_sgx_get_json_next_update(
+    const uint8_t* json,
+    size_t json_size,
+    oe_datetime_t* next_update)
+{
+    oe_result_t result = OE_NOT_FOUND;
+    static const char name[] = "\"nextUpdate\"";
+    const size_t name_length = sizeof(name) - 1;
+    const uint8_t* end = json + json_size;
+
+    if (!json || !next_update)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    for (const uint8_t* p = json; (size_t)(end - p) > name_length; p++)
+    {
+        const uint8_t* value;
+
+        if (*p != '"' || memcmp(p, name, name_length) != 0)
+            continue;
+
+        p += name_length;
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+            p++;
+        if (p == end || *p++ != ':')
+            break;
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+            p++;
+        if (p == end || *p++ != '"')
+            break;
+
+        for (value = p; p < end && *p != '"'; p++)
+            ;
+        if (p == end)
+            break;
+
+        OE_CHECK(oe_datetime_from_string(
+            (const char*)value, (size_t)(p - value), next_update));
+        result = OE_OK;
+        break;
+    }
+
+done:
+    return result;
+}
+
+oe_result_t oe_sgx_get_revocation_info_expiry(
+    const oe_get_revocation_info_args_t* revocation_info,
+    oe_datetime_t* expiry)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_datetime_t this_update;
+    oe_datetime_t next_update;
+    oe_crl_t crl = {{0}};
+
+    if (!revocation_info || !expiry ||
+        revocation_info->num_crl_urls > OE_COUNTOF(revocation_info->crl))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(oe_sgx_get_json_next_update(
+        revocation_info->tcb_info, revocation_info->tcb_info_size, expiry));
+
+    for (uint32_t i = 0; i < revocation_info->num_crl_urls; i++)
+    {
+        OE_CHECK(oe_crl_read_der(
+            &crl, revocation_info->crl[i], revocation_info->crl_size[i]));
+        result = oe_crl_get_update_dates(&crl, &this_update, &next_update);
+        oe_crl_free(&crl);
+        OE_CHECK(result);
+
+        if (oe_datetime_compare(&next_update, expiry) < 0)
+            *expiry = next_update;
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
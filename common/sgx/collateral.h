@@ -0,0 +1,190 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_COMMON_SGX_COLLATERAL_H
+#define _OE_COMMON_SGX_COLLATERAL_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/result.h>
+#include <openenclave/bits/types.h>
+#include <openenclave/internal/crypto/sha.h>
+#include <openenclave/internal/datetime.h>
+#include <openenclave/internal/report.h>
+#include "endorsements.h"
+
+OE_EXTERNC_BEGIN
+
+/*
+**==============================================================================
+**
+** SGX collateral cache:
+**
+**     Verifying a quote without caller-supplied endorsements fetches the
+**     TCB info, the QE identity and two CRLs from the quote provider and
+**     then parses and verifies all of them. Since the same collateral
+**     applies to every quote from a platform until its next update, the
+**     results of this work are kept in a cache that is shared by all
+**     threads. The cache holds:
+**
+**         - OE_SGX_COLLATERAL_ENDORSEMENTS: the raw endorsements buffer
+**           created by oe_get_sgx_endorsements(), keyed by the FMSPC and the
+**           CRL distribution point URLs. It expires at the earliest
+**           nextUpdate of the TCB info, the QE identity and the CRLs.
+**
+**         - OE_SGX_COLLATERAL_REVOCATION: the parsed CRLs and issuer chains
+**           (with a verified TCB info signature) used by
+**           oe_validate_revocation_list(), keyed by a hash of their raw data.
+**
+**         - OE_SGX_COLLATERAL_QE_IDENTITY: the parsed and verified QE
+**           identity used by oe_validate_qe_identity(), keyed by a hash of
+**           its raw data.
+**
+**         - OE_SGX_COLLATERAL_PCK_CHAIN: the parsed and verified PCK
+**           certificate chain of a quote (see oe_sgx_pck_chain_t), keyed by
+**           a hash of the PEM chain embedded in the quote.
+**
+**         - OE_SGX_COLLATERAL_ATTESTATION_CERT: the parsed report of a
+**           certificate accepted by oe_verify_attestation_certificate(),
+**           keyed by a hash of the certificate. It expires after the TTL set
+**           with oe_set_attestation_certificate_cache_ttl(), or earlier when
+**           the certificate or the collateral of its quote does.
+**
+**         - OE_SGX_COLLATERAL_OWN_REPORT and OE_SGX_COLLATERAL_OWN_CERT: the
+**           remote reports and attestation certificates generated by the
+**           enclave itself while the evidence cache is enabled with
+**           oe_set_evidence_cache_freshness(). They expire at the end of the
+**           freshness window.
+**
+**     The other parsed entries only depend on the bytes they are keyed by, so
+**     they do not expire. Each kind of entry is kept in its own list of at most
+**     OE_SGX_COLLATERAL_CACHE_SIZE entries from which the least recently
+**     used entry is evicted.
+**
+**     Entries are reference counted. An entry returned by
+**     oe_sgx_collateral_cache_find() remains valid until released with
+**     oe_sgx_collateral_release(), even if it is evicted in the meantime.
+**     Entries are immutable once inserted into the cache.
+**
+**==============================================================================
+*/
+
+/* Enough for the endorsements of a few dozen platforms verified in turn. */
+#define OE_SGX_COLLATERAL_CACHE_SIZE 32
+
+typedef enum _oe_sgx_collateral_kind
+{
+    OE_SGX_COLLATERAL_ENDORSEMENTS,
+    OE_SGX_COLLATERAL_REVOCATION,
+    OE_SGX_COLLATERAL_QE_IDENTITY,
+    OE_SGX_COLLATERAL_PCK_CHAIN,
+    OE_SGX_COLLATERAL_ATTESTATION_CERT,
+    OE_SGX_COLLATERAL_OWN_REPORT,
+    OE_SGX_COLLATERAL_OWN_CERT,
+    OE_SGX_COLLATERAL_KIND_COUNT
+} oe_sgx_collateral_kind_t;
+
+typedef struct _oe_sgx_collateral oe_sgx_collateral_t;
+
+/* Header of every cache entry. Entries embed it as their first member. */
+struct _oe_sgx_collateral
+{
+    oe_sgx_collateral_t* next;
+    uint64_t refs;
+    oe_sgx_collateral_kind_t kind;
+    OE_SHA256 key;
+
+    /* The entry is dropped once this time is reached (never if all zero). */
+    oe_datetime_t expiry;
+
+    /* Releases the entry once its last reference is dropped. */
+    void (*destroy)(oe_sgx_collateral_t* collateral);
+};
+
+/**
+ * Initialize the header of a new cache entry, which is returned to the caller
+ * with a single reference.
+ */
+void oe_sgx_collateral_init(
+    oe_sgx_collateral_t* collateral,
+    oe_sgx_collateral_kind_t kind,
+    const OE_SHA256* key,
+    void (*destroy)(oe_sgx_collateral_t* collateral));
+
+/**
+ * Find the unexpired entry of the given kind and key.
+ *
+ * @returns The entry with a new reference or NULL if there is none.
+ */
+oe_sgx_collateral_t* oe_sgx_collateral_cache_find(
+    oe_sgx_collateral_kind_t kind,
+    const OE_SHA256* key);
+
+/**
+ * Add an entry to the cache, replacing any entry with the same kind and key.
+ * The cache takes its own reference, so the caller must still release the
+ * entry.
+ */
+void oe_sgx_collateral_cache_insert(oe_sgx_collateral_t* collateral);
+
+/**
+ * Get up to count entries of the given kind, most recently used first.
+ *
+ * @returns The number of entries stored in entries, each with a new reference.
+ */
+size_t oe_sgx_collateral_cache_get_all(
+    oe_sgx_collateral_kind_t kind,
+    oe_sgx_collateral_t** entries,
+    size_t count);
+
+/**
+ * Get the number of times oe_sgx_collateral_cache_find() found an entry of
+ * the given kind. Clearing the cache does not reset it.
+ */
+uint64_t oe_sgx_collateral_cache_hits(oe_sgx_collateral_kind_t kind);
+
+/**
+ * Drop a reference to an entry. Accepts NULL.
+ */
+void oe_sgx_collateral_release(oe_sgx_collateral_t* collateral);
+
+/**
+ * Remove all entries from the cache, so that the next quote verification
+ * fetches and parses its collateral again.
+ */
+void oe_sgx_clear_collateral_cache(void);
+
+/**
+ * Remove all entries of the given kind from the cache.
+ */
+void oe_sgx_clear_collateral_cache_kind(oe_sgx_collateral_kind_t kind);
+
+/**
+ * Hash the given endorsement items (first to last inclusive) into a cache
+ * key.
+ */
+oe_result_t oe_sgx_collateral_hash_items(
+    const oe_sgx_endorsements_t* sgx_endorsements,
+    uint32_t first,
+    uint32_t last,
+    OE_SHA256* key);
+
+/**
+ * Get the date of the "nextUpdate" property of a TCB info or QE identity
+ * JSON document.
+ */
+oe_result_t oe_sgx_get_json_next_update(
+    const uint8_t* json,
+    size_t json_size,
+    oe_datetime_t* next_update);
+
+/**
+ * Get the earliest nextUpdate date of the TCB info and CRLs in the given
+ * revocation info.
+ */
+oe_result_t oe_sgx_get_revocation_info_expiry(
+    const oe_get_revocation_info_args_t* revocation_info,
+    oe_datetime_t* expiry);
+
+OE_EXTERNC_END
+
+#endif // _OE_COMMON_SGX_COLLATERAL_H
@@ -8,6 +8,7 @@
 #include <openenclave/internal/raise.h>
 #include "../common.h"
 
+#include "collateral.h"
 #include "qeidentity.h"
 #include "quote.h"
 #include "revocation.h"
@@ -329,6 +330,167 @@ done:
     return result;
 }
 
+/**
+ * Endorsements shared through the collateral cache.
+ */
+typedef struct _endorsements_collateral
+{
+    oe_sgx_collateral_t base;
+    uint8_t* data;
+    size_t size;
+} endorsements_collateral_t;
+
+static void _free_endorsements_collateral(oe_sgx_collateral_t* base)
+{
+    endorsements_collateral_t* collateral = (endorsements_collateral_t*)base;
+
+    oe_free(collateral->data);
+    oe_free(collateral);
+}
+
+/**
+ * The endorsements are determined by the FMSPC and the CRL distribution
+ * points of the PCK certificate chain (the QE identity is the same for all
+ * platforms).
+ */
+static oe_result_t _get_endorsements_key(
+    const oe_get_revocation_info_args_t* revocation_info,
+    OE_SHA256* key)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sha256_context_t context;
+
+    OE_CHECK(oe_sha256_init(&context));
+    OE_CHECK(oe_sha256_update(
+        &context, revocation_info->fmspc, sizeof(revocation_info->fmspc)));
+
+    for (uint32_t i = 0; i < revocation_info->num_crl_urls; i++)
+    {
+        // Include the terminating null character as a separator.
+        OE_CHECK(oe_sha256_update(
+            &context,
+            revocation_info->crl_urls[i],
+            oe_strlen(revocation_info->crl_urls[i]) + 1));
+    }
+
+    OE_CHECK(oe_sha256_final(&context, key));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+static oe_result_t _copy_endorsements(
+    const uint8_t* data,
+    size_t size,
+    uint8_t** endorsements_buffer,
+    size_t* endorsements_buffer_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint8_t* buffer = NULL;
+
+    if (!(buffer = (uint8_t*)oe_malloc(size)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    OE_CHECK(oe_memcpy_s(buffer, size, data, size));
+
+    *endorsements_buffer = buffer;
+    *endorsements_buffer_size = size;
+    buffer = NULL;
+    result = OE_OK;
+
+done:
+    oe_free(buffer);
+    return result;
+}
+
+/**
+ * Add newly fetched endorsements to the collateral cache until the earliest
+ * next update of the TCB info, the QE identity and the CRLs. Endorsements
+ * that cannot be cached are simply not cached.
+ */
+static void _cache_endorsements(
+    const OE_SHA256* key,
+    const oe_get_revocation_info_args_t* revocation_info,
+    const oe_get_qe_identity_info_args_t* qe_id_info,
+    const uint8_t* endorsements_buffer,
+    size_t endorsements_buffer_size)
+{
+    endorsements_collateral_t* collateral = NULL;
+    oe_datetime_t expiry;
+    oe_datetime_t next_update;
+    oe_datetime_t now;
+
+    if (oe_sgx_get_revocation_info_expiry(revocation_info, &expiry) != OE_OK ||
+        oe_sgx_get_json_next_update(
+            qe_id_info->qe_id_info,
+            qe_id_info->qe_id_info_size,
+            &next_update) != OE_OK ||
+        oe_datetime_now(&now) != OE_OK)
+        return;
+
+    if (oe_datetime_compare(&next_update, &expiry) < 0)
+        expiry = next_update;
+
+    if (oe_datetime_compare(&now, &expiry) >= 0)
+    {
+        oe_datetime_log("Not caching endorsements that expired at: ", &expiry);
+        return;
+    }
+
+    if (!(collateral = oe_calloc(1, sizeof(endorsements_collateral_t))))
+        return;
+
+    oe_sgx_collateral_init(
+        &collateral->base,
+        OE_SGX_COLLATERAL_ENDORSEMENTS,
+        key,
+        _free_endorsements_collateral);
+    collateral->base.expiry = expiry;
+
+    if (_copy_endorsements(
+            endorsements_buffer,
+            endorsements_buffer_size,
+            &collateral->data,
+            &collateral->size) == OE_OK)
+    {
+        oe_sgx_collateral_cache_insert(&collateral->base);
+    }
+
+    oe_sgx_collateral_release(&collateral->base);
+}
+
+oe_result_t oe_get_sgx_endorsements_key(
+    const uint8_t* remote_report,
+    size_t remote_report_size,
+    OE_SHA256* key)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_get_revocation_info_args_t revocation_info = {0};
+    oe_sgx_pck_chain_t* pck_chain = NULL;
+
+    if (key == NULL)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(oe_get_sgx_quote_pck_chain(
+        remote_report, remote_report_size, &pck_chain));
+    OE_CHECK(oe_get_revocation_info_args_from_certs(
+        &pck_chain->leaf_cert,
+        &pck_chain->intermediate_cert,
+        &revocation_info));
+    OE_CHECK(_get_endorsements_key(&revocation_info, key));
+
+    result = OE_OK;
+
+done:
+    if (pck_chain)
+        oe_sgx_collateral_release(&pck_chain->base);
+    oe_free_revocation_info_urls(&revocation_info);
+
+    return result;
+}
+
 oe_result_t oe_get_sgx_endorsements(
     const uint8_t* remote_report,
     size_t remote_report_size,
@@ -339,11 +501,10 @@ oe_result_t oe_get_sgx_endorsements(
     oe_get_qe_identity_info_args_t qe_id_info = {0};
     oe_get_revocation_info_args_t revocation_info = {0};
 
-    const uint8_t* pem_pck_certificate = NULL;
-    size_t pem_pck_certificate_size = 0;
-    oe_cert_chain_t pck_cert_chain = {0};
-    oe_cert_t leaf_cert = {0};
-    oe_cert_t intermediate_cert = {0};
+    oe_sgx_pck_chain_t* pck_chain = NULL;
+
+    OE_SHA256 key;
+    endorsements_collateral_t* collateral = NULL;
 
     OE_TRACE_INFO("Enter call %s\n", __FUNCTION__);
 
@@ -357,36 +518,49 @@ oe_result_t oe_get_sgx_endorsements(
 
     //
     // Get the uri from the quote certificates, and then get the
-    // CRL (oe_get_revocation_info_from_certs)
+    // CRL (oe_get_revocation_info)
     //
 
     // Get PCK cert chain from the quote.
     OE_CHECK_MSG(
-        oe_get_quote_cert_chain_internal(
-            remote_report,
-            remote_report_size,
-            &pem_pck_certificate,
-            &pem_pck_certificate_size,
-            &pck_cert_chain),
+        oe_get_sgx_quote_pck_chain(
+            remote_report, remote_report_size, &pck_chain),
         "Failed to get certificate chain from quote. %s",
         oe_result_str(result));
 
-    // Fetch leaf and intermediate certificates.
-    OE_CHECK_MSG(
-        oe_cert_chain_get_leaf_cert(&pck_cert_chain, &leaf_cert),
-        "Failed to get leaf certificate. %s",
-        oe_result_str(result));
     OE_CHECK_MSG(
-        oe_cert_chain_get_cert(&pck_cert_chain, 1, &intermediate_cert),
-        "Failed to get intermediate certificate. %s",
+        oe_get_revocation_info_args_from_certs(
+            &pck_chain->leaf_cert,
+            &pck_chain->intermediate_cert,
+            &revocation_info),
+        "Failed to get certificate revocation information. %s",
         oe_result_str(result));
 
+    //
+    // Use cached endorsements for the platform if they are still current
+    //
+    OE_CHECK(_get_endorsements_key(&revocation_info, &key));
+
+    collateral = (endorsements_collateral_t*)oe_sgx_collateral_cache_find(
+        OE_SGX_COLLATERAL_ENDORSEMENTS, &key);
+
+    if (collateral)
+    {
+        OE_TRACE_INFO("Using cached SGX endorsements\n");
+        OE_CHECK(_copy_endorsements(
+            collateral->data,
+            collateral->size,
+            endorsements_buffer,
+            endorsements_buffer_size));
+        result = OE_OK;
+        goto done;
+    }
+
     //
     // Get revocation information
     //
     OE_CHECK_MSG(
-        oe_get_revocation_info_from_certs(
-            &leaf_cert, &intermediate_cert, &revocation_info),
+        oe_get_revocation_info(&revocation_info),
         "Failed to get certificate revocation information. %s",
         oe_result_str(result));
 
@@ -410,12 +584,21 @@ oe_result_t oe_get_sgx_endorsements(
         "Failed to create SGX endorsements.",
         oe_result_str(result));
 
+    _cache_endorsements(
+        &key,
+        &revocation_info,
+        &qe_id_info,
+        *endorsements_buffer,
+        *endorsements_buffer_size);
+
     result = OE_OK;
 
 done:
-    oe_cert_free(&leaf_cert);
-    oe_cert_free(&intermediate_cert);
-    oe_cert_chain_free(&pck_cert_chain);
+    if (collateral)
+        oe_sgx_collateral_release(&collateral->base);
+    if (pck_chain)
+        oe_sgx_collateral_release(&pck_chain->base);
+    oe_free_revocation_info_urls(&revocation_info);
     oe_free_get_revocation_info_args(&revocation_info);
     oe_free_qe_identity_info_args(&qe_id_info);
 
@@ -7,6 +7,7 @@
 #include <openenclave/bits/attestation.h>
 #include <openenclave/bits/defs.h>
 #include <openenclave/bits/result.h>
+#include <openenclave/internal/crypto/sha.h>
 
 OE_EXTERNC_BEGIN
 
@@ -89,6 +90,20 @@ oe_result_t oe_parse_sgx_endorsements(
     const size_t endorsements_size,
     oe_sgx_endorsements_t* sgx_endorsements);
 
+/**
+ * Get the key that identifies the endorsements of an SGX remote report, which
+ * is the same for all quotes from a platform. It is derived from the FMSPC
+ * and the CRL distribution points of the PCK certificate chain.
+ *
+ * @param[in] remote_report The remote report.
+ * @param[in] remote_report_size The size of the remote report.
+ * @param[out] key The key of the endorsements.
+ */
+oe_result_t oe_get_sgx_endorsements_key(
+    const uint8_t* remote_report,
+    size_t remote_report_size,
+    OE_SHA256* key);
+
 /**
  * Get the endorsements for the respective SGX remote report.
  *
@@ -204,6 +204,202 @@ done:
     return result;
 }
 
+static void _update_validity(
+    oe_datetime_t* latest_from,
+    oe_datetime_t* earliest_until,
+    oe_datetime_t* from,
+    oe_datetime_t* until)
+{
+    if (oe_datetime_compare(from, latest_from) > 0)
+    {
+        *latest_from = *from;
+    }
+
+    if (oe_datetime_compare(until, earliest_until) < 0)
+    {
+        *earliest_until = *until;
+    }
+}
+
+static void _free_pck_chain(oe_sgx_collateral_t* collateral)
+{
+    oe_sgx_pck_chain_t* pck_chain = (oe_sgx_pck_chain_t*)collateral;
+
+    oe_cert_free(&pck_chain->leaf_cert);
+    oe_cert_free(&pck_chain->intermediate_cert);
+    oe_cert_chain_free(&pck_chain->chain);
+    oe_free(pck_chain);
+}
+
+/**
+ * Parse and verify a PEM PCK certificate chain into a new (not yet cached)
+ * collateral object.
+ */
+static oe_result_t _read_pck_chain(
+    const uint8_t* pem_pck_certificate,
+    size_t pem_pck_certificate_size,
+    const OE_SHA256* key,
+    oe_sgx_pck_chain_t** pck_chain_out)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sgx_pck_chain_t* pck_chain = NULL;
+    oe_cert_t root_cert = {0};
+    oe_ec_public_key_t root_public_key = {0};
+    oe_ec_public_key_t expected_root_public_key = {0};
+    bool key_equal = false;
+    oe_datetime_t from;
+    oe_datetime_t until;
+
+    if (!(pck_chain = oe_calloc(1, sizeof(oe_sgx_pck_chain_t))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    oe_sgx_collateral_init(
+        &pck_chain->base, OE_SGX_COLLATERAL_PCK_CHAIN, key, _free_pck_chain);
+
+    // Read and validate the chain.
+    OE_CHECK_MSG(
+        oe_cert_chain_read_pem(
+            &pck_chain->chain, pem_pck_certificate, pem_pck_certificate_size),
+        "Failed to parse certificate chain.",
+        NULL);
+
+    // Fetch leaf, intermediate and root certificates.
+    OE_CHECK_MSG(
+        oe_cert_chain_get_leaf_cert(&pck_chain->chain, &pck_chain->leaf_cert),
+        "Failed to get leaf certificate.",
+        NULL);
+    OE_CHECK_MSG(
+        oe_cert_chain_get_cert(
+            &pck_chain->chain, 1, &pck_chain->intermediate_cert),
+        "Failed to get intermediate certificate.",
+        NULL);
+    OE_CHECK_MSG(
+        oe_cert_chain_get_root_cert(&pck_chain->chain, &root_cert),
+        "Failed to get root certificate.",
+        NULL);
+
+    // Ensure that the root certificate matches root of trust.
+    OE_CHECK_MSG(
+        oe_cert_get_ec_public_key(&root_cert, &root_public_key),
+        "Failed to get root cert public key.",
+        NULL);
+    OE_CHECK_MSG(
+        oe_ec_public_key_read_pem(
+            &expected_root_public_key,
+            (const uint8_t*)g_expected_root_certificate_key,
+            oe_strlen(g_expected_root_certificate_key) + 1),
+        "Failed to read expected root cert key.",
+        NULL);
+    OE_CHECK_MSG(
+        oe_ec_public_key_equal(
+            &root_public_key, &expected_root_public_key, &key_equal),
+        "Failed to compare keys.",
+        NULL);
+    if (!key_equal)
+        OE_RAISE_MSG(
+            OE_QUOTE_VERIFICATION_ERROR,
+            "Failed to verify root public key.",
+            NULL);
+
+    // Process certs validity dates.
+    OE_CHECK_MSG(
+        oe_cert_get_validity_dates(
+            &root_cert, &pck_chain->valid_from, &pck_chain->valid_until),
+        "Failed to get validity info from cert. %s",
+        oe_result_str(result));
+    OE_CHECK_MSG(
+        oe_cert_get_validity_dates(
+            &pck_chain->intermediate_cert, &from, &until),
+        "Failed to get validity info from cert. %s",
+        oe_result_str(result));
+    _update_validity(
+        &pck_chain->valid_from, &pck_chain->valid_until, &from, &until);
+    OE_CHECK_MSG(
+        oe_cert_get_validity_dates(&pck_chain->leaf_cert, &from, &until),
+        "Failed to get validity info from cert. %s",
+        oe_result_str(result));
+    _update_validity(
+        &pck_chain->valid_from, &pck_chain->valid_until, &from, &until);
+
+    *pck_chain_out = pck_chain;
+    pck_chain = NULL;
+    result = OE_OK;
+
+done:
+    if (pck_chain)
+        _free_pck_chain(&pck_chain->base);
+    oe_ec_public_key_free(&root_public_key);
+    oe_ec_public_key_free(&expected_root_public_key);
+    oe_cert_free(&root_cert);
+    return result;
+}
+
+static oe_result_t _get_pck_chain(
+    const sgx_qe_cert_data_t* qe_cert_data,
+    oe_sgx_pck_chain_t** pck_chain)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sha256_context_t sha256_ctx = {0};
+    OE_SHA256 key;
+
+    // Chains are cached by their raw bytes, so a chain that fails to verify
+    // or to match the root of trust is never found in the cache.
+    OE_CHECK(oe_sha256_init(&sha256_ctx));
+    OE_CHECK(
+        oe_sha256_update(&sha256_ctx, qe_cert_data->data, qe_cert_data->size));
+    OE_CHECK(oe_sha256_final(&sha256_ctx, &key));
+
+    *pck_chain = (oe_sgx_pck_chain_t*)oe_sgx_collateral_cache_find(
+        OE_SGX_COLLATERAL_PCK_CHAIN, &key);
+
+    if (!*pck_chain)
+    {
+        OE_CHECK(_read_pck_chain(
+            qe_cert_data->data, qe_cert_data->size, &key, pck_chain));
+        oe_sgx_collateral_cache_insert(&(*pck_chain)->base);
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_get_sgx_quote_pck_chain(
+    const uint8_t* quote,
+    size_t quote_size,
+    oe_sgx_pck_chain_t** pck_chain)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    sgx_quote_t* sgx_quote = NULL;
+    sgx_quote_auth_data_t* quote_auth_data = NULL;
+    sgx_qe_auth_data_t qe_auth_data = {0};
+    sgx_qe_cert_data_t qe_cert_data = {0};
+
+    if (quote == NULL || pck_chain == NULL)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    *pck_chain = NULL;
+
+    OE_CHECK_MSG(
+        _parse_quote(
+            quote,
+            quote_size,
+            &sgx_quote,
+            &quote_auth_data,
+            &qe_auth_data,
+            &qe_cert_data),
+        "Failed to parse quote. %s",
+        oe_result_str(result));
+
+    OE_CHECK(_get_pck_chain(&qe_cert_data, pck_chain));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
 static oe_result_t oe_verify_quote_internal(
     const uint8_t* quote,
     size_t quote_size)
@@ -213,20 +409,11 @@ static oe_result_t oe_verify_quote_internal(
     sgx_quote_auth_data_t* quote_auth_data = NULL;
     sgx_qe_auth_data_t qe_auth_data = {0};
     sgx_qe_cert_data_t qe_cert_data = {0};
-    oe_cert_chain_t pck_cert_chain = {0};
+    oe_sgx_pck_chain_t* pck_chain = NULL;
     oe_sha256_context_t sha256_ctx = {0};
     OE_SHA256 sha256 = {0};
     oe_ec_public_key_t attestation_key = {0};
-    oe_cert_t leaf_cert = {0};
-    oe_cert_t root_cert = {0};
-    oe_cert_t intermediate_cert = {0};
     oe_ec_public_key_t leaf_public_key = {0};
-    oe_ec_public_key_t root_public_key = {0};
-    oe_ec_public_key_t expected_root_public_key = {0};
-    bool key_equal = false;
-
-    uint8_t* pem_pck_certificate = NULL;
-    size_t pem_pck_certificate_size = 0;
 
     OE_CHECK_MSG(
         _parse_quote(
@@ -239,61 +426,13 @@ static oe_result_t oe_verify_quote_internal(
         "Failed to parse quote. %s",
         oe_result_str(result));
 
-    pem_pck_certificate = qe_cert_data.data;
-    pem_pck_certificate_size = qe_cert_data.size;
-
-    // PckCertificate Chain validations.
-    {
-        // Read and validate the chain.
-        OE_CHECK_MSG(
-            oe_cert_chain_read_pem(
-                &pck_cert_chain, pem_pck_certificate, pem_pck_certificate_size),
-            "Failed to parse certificate chain.",
-            NULL);
-
-        // Fetch leaf and root certificates.
-        OE_CHECK_MSG(
-            oe_cert_chain_get_leaf_cert(&pck_cert_chain, &leaf_cert),
-            "Failed to get leaf certificate.",
-            NULL);
-        OE_CHECK_MSG(
-            oe_cert_chain_get_root_cert(&pck_cert_chain, &root_cert),
-            "Failed to get root certificate.",
-            NULL);
-        OE_CHECK_MSG(
-            oe_cert_chain_get_cert(&pck_cert_chain, 1, &intermediate_cert),
-            "Failed to get intermediate certificate.",
-            NULL);
-
-        // Get public keys.
-        OE_CHECK_MSG(
-            oe_cert_get_ec_public_key(&leaf_cert, &leaf_public_key),
-            "Failed to get leaf cert public key.",
-            NULL);
-        OE_CHECK_MSG(
-            oe_cert_get_ec_public_key(&root_cert, &root_public_key),
-            "Failed to get root cert public key.",
-            NULL);
+    // PckCertificate Chain validations (done once per distinct chain).
+    OE_CHECK(_get_pck_chain(&qe_cert_data, &pck_chain));
 
-        // Ensure that the root certificate matches root of trust.
-        OE_CHECK_MSG(
-            oe_ec_public_key_read_pem(
-                &expected_root_public_key,
-                (const uint8_t*)g_expected_root_certificate_key,
-                oe_strlen(g_expected_root_certificate_key) + 1),
-            "Failed to read expected root cert key.",
-            NULL);
-        OE_CHECK_MSG(
-            oe_ec_public_key_equal(
-                &root_public_key, &expected_root_public_key, &key_equal),
-            "Failed to compare keys.",
-            NULL);
-        if (!key_equal)
-            OE_RAISE_MSG(
-                OE_QUOTE_VERIFICATION_ERROR,
-                "Failed to verify root public key.",
-                NULL);
-    }
+    OE_CHECK_MSG(
+        oe_cert_get_ec_public_key(&pck_chain->leaf_cert, &leaf_public_key),
+        "Failed to get leaf cert public key.",
+        NULL);
 
     // Quote validations.
     {
@@ -354,75 +493,12 @@ static oe_result_t oe_verify_quote_internal(
 
 done:
     oe_ec_public_key_free(&leaf_public_key);
-    oe_ec_public_key_free(&root_public_key);
-    oe_ec_public_key_free(&expected_root_public_key);
     oe_ec_public_key_free(&attestation_key);
-    oe_cert_free(&leaf_cert);
-    oe_cert_free(&root_cert);
-    oe_cert_free(&intermediate_cert);
-    oe_cert_chain_free(&pck_cert_chain);
+    if (pck_chain)
+        oe_sgx_collateral_release(&pck_chain->base);
     return result;
 }
 
-oe_result_t oe_get_quote_cert_chain_internal(
-    const uint8_t* quote,
-    const size_t quote_size,
-    const uint8_t** pem_pck_certificate,
-    size_t* pem_pck_certificate_size,
-    oe_cert_chain_t* pck_cert_chain)
-{
-    oe_result_t result = OE_UNEXPECTED;
-    sgx_quote_t* sgx_quote = NULL;
-    sgx_quote_auth_data_t* quote_auth_data = NULL;
-    sgx_qe_auth_data_t qe_auth_data = {0};
-    sgx_qe_cert_data_t qe_cert_data = {0};
-
-    if (quote == NULL || pem_pck_certificate == NULL || pck_cert_chain == NULL)
-    {
-        OE_RAISE(OE_INVALID_PARAMETER);
-    }
-
-    OE_CHECK_MSG(
-        _parse_quote(
-            quote,
-            quote_size,
-            &sgx_quote,
-            &quote_auth_data,
-            &qe_auth_data,
-            &qe_cert_data),
-        "Failed to parse quote. %s",
-        oe_result_str(result));
-
-    *pem_pck_certificate = qe_cert_data.data;
-    *pem_pck_certificate_size = qe_cert_data.size;
-
-    // Read and validate the chain.
-    OE_CHECK(oe_cert_chain_read_pem(
-        pck_cert_chain, *pem_pck_certificate, *pem_pck_certificate_size));
-
-    result = OE_OK;
-done:
-
-    return result;
-}
-
-static void _update_validity(
-    oe_datetime_t* latest_from,
-    oe_datetime_t* earliest_until,
-    oe_datetime_t* from,
-    oe_datetime_t* until)
-{
-    if (oe_datetime_compare(from, latest_from) > 0)
-    {
-        *latest_from = *from;
-    }
-
-    if (oe_datetime_compare(until, earliest_until) < 0)
-    {
-        *earliest_until = *until;
-    }
-}
-
 oe_result_t oe_verify_sgx_quote(
     const uint8_t* quote,
     size_t quote_size,
@@ -566,13 +642,7 @@ oe_result_t oe_get_sgx_quote_validity(
     sgx_qe_auth_data_t qe_auth_data = {0};
     sgx_qe_cert_data_t qe_cert_data = {0};
 
-    const uint8_t* pem_pck_certificate = NULL;
-    size_t pem_pck_certificate_size = 0;
-    oe_cert_chain_t pck_cert_chain = {0};
-
-    oe_cert_t root_cert = {0};
-    oe_cert_t intermediate_cert = {0};
-    oe_cert_t pck_cert = {0};
+    oe_sgx_pck_chain_t* pck_chain = NULL;
 
     oe_datetime_t latest_from = {0};
     oe_datetime_t earliest_until = {0};
@@ -596,53 +666,19 @@ oe_result_t oe_get_sgx_quote_validity(
         "Failed to parse quote. %s",
         oe_result_str(result));
 
-    pem_pck_certificate = qe_cert_data.data;
-    pem_pck_certificate_size = qe_cert_data.size;
-
     OE_CHECK_MSG(
-        oe_get_quote_cert_chain_internal(
-            quote,
-            quote_size,
-            &pem_pck_certificate,
-            &pem_pck_certificate_size,
-            &pck_cert_chain),
+        _get_pck_chain(&qe_cert_data, &pck_chain),
         "Failed to retreive PCK cert chain. %s",
         oe_result_str(result));
 
-    // Fetch certificates.
-    OE_CHECK_MSG(
-        oe_cert_chain_get_leaf_cert(&pck_cert_chain, &pck_cert),
-        "Failed to get leaf certificate.",
-        NULL);
-    OE_CHECK_MSG(
-        oe_cert_chain_get_root_cert(&pck_cert_chain, &root_cert),
-        "Failed to get root certificate.",
-        NULL);
-    OE_CHECK_MSG(
-        oe_cert_chain_get_cert(&pck_cert_chain, 1, &intermediate_cert),
-        "Failed to get intermediate certificate.",
-        NULL);
-
-    // Process certs validity dates.
-    OE_CHECK_MSG(
-        oe_cert_get_validity_dates(&root_cert, &latest_from, &earliest_until),
-        "Failed to get validity info from cert. %s",
-        oe_result_str(result));
-    OE_CHECK_MSG(
-        oe_cert_get_validity_dates(&intermediate_cert, &from, &until),
-        "Failed to get validity info from cert. %s",
-        oe_result_str(result));
-    _update_validity(&latest_from, &earliest_until, &from, &until);
-
-    OE_CHECK_MSG(
-        oe_cert_get_validity_dates(&pck_cert, &from, &until),
-        "Failed to get validity info from cert. %s",
-        oe_result_str(result));
-    _update_validity(&latest_from, &earliest_until, &from, &until);
+    // Certs validity dates.
+    latest_from = pck_chain->valid_from;
+    earliest_until = pck_chain->valid_until;
 
     // Fetch revocation info validity dates.
     OE_CHECK_MSG(
-        oe_validate_revocation_list(&pck_cert, sgx_endorsements, &from, &until),
+        oe_validate_revocation_list(
+            &pck_chain->leaf_cert, sgx_endorsements, &from, &until),
 
         "Failed to validate revocation info. %s",
         oe_result_str(result));
@@ -671,10 +707,8 @@ oe_result_t oe_get_sgx_quote_validity(
     result = OE_OK;
 
 done:
-    oe_cert_free(&pck_cert);
-    oe_cert_free(&intermediate_cert);
-    oe_cert_free(&root_cert);
-    oe_cert_chain_free(&pck_cert_chain);
+    if (pck_chain)
+        oe_sgx_collateral_release(&pck_chain->base);
 
     return result;
 }
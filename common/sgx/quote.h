@@ -9,30 +9,47 @@
 #include <openenclave/bits/types.h>
 #include <openenclave/internal/crypto/cert.h>
 #include <openenclave/internal/datetime.h>
+#include "collateral.h"
 #include "endorsements.h"
 
 OE_EXTERNC_BEGIN
 
 /*!
- * Retrieves certifate chain from the quote.
+ * The parsed and verified PCK certificate chain of a quote.
  *
- * Caller is responsible for deallocating memory in pck_cert_chain.
+ * The chain has been verified and its root key matches Intel's root of trust.
+ * Chains are shared through the SGX collateral cache (keyed by a hash of the
+ * PEM chain in the quote), so all members must be treated as read-only. In
+ * particular, callers copy the PCK public key out of leaf_cert instead of
+ * sharing a key object, since verifying with an EC key updates its state.
+ */
+typedef struct _oe_sgx_pck_chain
+{
+    oe_sgx_collateral_t base;
+    oe_cert_chain_t chain;
+    oe_cert_t leaf_cert;
+    oe_cert_t intermediate_cert;
+
+    /* Overall validity of the root, intermediate and PCK certificates. */
+    oe_datetime_t valid_from;
+    oe_datetime_t valid_until;
+} oe_sgx_pck_chain_t;
+
+/*!
+ * Get the verified PCK certificate chain of a quote, from the cache if it has
+ * been seen before.
+ *
+ * Caller is responsible for releasing the chain by calling
+ * oe_sgx_collateral_release(&pck_chain->base).
  *
  * @param[in] quote Input quote.
  * @param[in] quote_size The size of the quote.
- * @param[out] pem_pck_certifcate Pointer to the quote where the certificate PCK
- * starts.
- * @param[out] pem_pck_certificate_size Size of the PCK certificate.
- * @param[out] pck_cert_chain Reference to an instance of oe_cert_chain_t where
- * to store the chain.  Caller needs to free resources by calling
- * oe_cert_chain_free()
+ * @param[out] pck_chain The PCK certificate chain.
  */
-oe_result_t oe_get_quote_cert_chain_internal(
+oe_result_t oe_get_sgx_quote_pck_chain(
     const uint8_t* quote,
-    const size_t quote_size,
-    const uint8_t** pem_pck_certificate,
-    size_t* pem_pck_certificate_size,
-    oe_cert_chain_t* pck_cert_chain);
+    size_t quote_size,
+    oe_sgx_pck_chain_t** pck_chain);
 
 /*!
  * Verify SGX quote and endorsements.
@@ -19,6 +19,7 @@
 #include <openenclave/internal/trace.h>
 #include <openenclave/internal/utils.h>
 #include "../common.h"
+#include "collateral.h"
 #include "tcbinfo.h"
 
 // Defaults to Intel SGX 1.8 Release Date.
@@ -240,10 +241,10 @@ done:
 }
 
 /**
- * Call into host to fetch revocation information given the CA and PCK
- * certificates.
+ * Gather the FMSPC and CRL distribution point URLs that identify the
+ * revocation info for the given CA and PCK certificates.
  */
-oe_result_t oe_get_revocation_info_from_certs(
+oe_result_t oe_get_revocation_info_args_from_certs(
     oe_cert_t* leaf_cert,
     oe_cert_t* intermediate_cert,
     oe_get_revocation_info_args_t* args)
@@ -253,7 +254,7 @@ oe_result_t oe_get_revocation_info_from_certs(
     char* intermediate_crl_url = NULL;
     char* leaf_crl_url = NULL;
 
-    if (intermediate_cert == NULL || leaf_cert == NULL)
+    if (intermediate_cert == NULL || leaf_cert == NULL || args == NULL)
         OE_RAISE(OE_INVALID_PARAMETER);
 
     // Gather fmspc.
@@ -272,8 +273,8 @@ oe_result_t oe_get_revocation_info_from_certs(
     args->crl_urls[0] = leaf_crl_url;
     args->crl_urls[1] = intermediate_crl_url;
     args->num_crl_urls = 2;
-
-    OE_CHECK(oe_get_revocation_info(args));
+    leaf_crl_url = NULL;
+    intermediate_crl_url = NULL;
 
     result = OE_OK;
 done:
@@ -284,53 +285,113 @@ done:
     return result;
 }
 
-oe_result_t oe_validate_revocation_list(
-    oe_cert_t* pck_cert,
-    const oe_sgx_endorsements_t* sgx_endorsements,
-    oe_datetime_t* validity_from,
-    oe_datetime_t* validity_until)
+void oe_free_revocation_info_urls(oe_get_revocation_info_args_t* args)
 {
-    oe_result_t result = OE_UNEXPECTED;
+    if (args)
+    {
+        for (size_t i = 0; i < OE_COUNTOF(args->crl_urls); i++)
+        {
+            oe_free((char*)args->crl_urls[i]);
+            args->crl_urls[i] = NULL;
+        }
+    }
+}
 
-    ParsedExtensionInfo parsed_extension_info = {{0}};
-    oe_cert_chain_t tcb_issuer_chain = {0};
-    oe_cert_chain_t crl_issuer_chain[3] = {{{0}}};
-    oe_cert_t tcb_cert = {0};
-    oe_parsed_tcb_info_t parsed_tcb_info = {0};
-    oe_tcb_info_tcb_level_t platform_tcb_level = {{0}};
+/**
+ * Call into host to fetch revocation information given the CA and PCK
+ * certificates.
+ */
+oe_result_t oe_get_revocation_info_from_certs(
+    oe_cert_t* leaf_cert,
+    oe_cert_t* intermediate_cert,
+    oe_get_revocation_info_args_t* args)
+{
+    oe_result_t result = OE_FAILURE;
 
-    uint32_t version = 0;
-    oe_crl_t crls[2] = {{{0}}};
-    const oe_crl_t* crl_ptrs[2] = {&crls[0], &crls[1]};
-    oe_datetime_t from = {0};
-    oe_datetime_t until = {0};
-    oe_datetime_t latest_from = {0};
-    oe_datetime_t earliest_until = {0};
+    OE_CHECK(oe_get_revocation_info_args_from_certs(
+        leaf_cert, intermediate_cert, args));
+    OE_CHECK(oe_get_revocation_info(args));
 
-    if (pck_cert == NULL || sgx_endorsements == NULL)
-        OE_RAISE(OE_INVALID_PARAMETER);
+    result = OE_OK;
+done:
+    oe_free_revocation_info_urls(args);
 
-    version =
-        *(uint32_t*)sgx_endorsements->items[OE_SGX_ENDORSEMENT_FIELD_VERSION]
-             .data;
-    if (version != OE_SGX_ENDORSEMENTS_VERSION)
-        OE_RAISE_MSG(
-            OE_INVALID_PARAMETER,
-            "SGX endorsement version is %d, expected %d",
-            version,
-            OE_SGX_ENDORSEMENTS_VERSION);
+    return result;
+}
+
+/**
+ * Parsed revocation collateral shared through the collateral cache. Once
+ * inserted into the cache, the TCB info signature has been verified against
+ * the TCB issuer chain and the validity dates have been computed. The TCB
+ * levels are kept as a table so that each quote only evaluates its platform
+ * TCB level against them.
+ */
+typedef struct _revocation_collateral
+{
+    oe_sgx_collateral_t base;
+    oe_cert_chain_t tcb_issuer_chain;
+    oe_crl_t crls[OE_SGX_ENDORSEMENTS_CRL_COUNT];
+    oe_cert_chain_t crl_issuer_chain[OE_SGX_ENDORSEMENTS_CRL_COUNT];
+    oe_datetime_t crl_from;
+    oe_datetime_t crl_until;
+    oe_datetime_t tcb_cert_from;
+    oe_datetime_t tcb_cert_until;
+    oe_parsed_tcb_info_t parsed_tcb_info;
+    oe_tcb_info_tcb_level_t* tcb_levels;
+    size_t tcb_level_count;
+} revocation_collateral_t;
+
+static void _free_revocation_collateral(oe_sgx_collateral_t* base)
+{
+    revocation_collateral_t* collateral = (revocation_collateral_t*)base;
+
+    for (int32_t i = (int32_t)OE_SGX_ENDORSEMENTS_CRL_COUNT - 1; i >= 0; --i)
+    {
+        oe_crl_free(&collateral->crls[i]);
+    }
+    for (uint32_t i = 0; i < OE_SGX_ENDORSEMENTS_CRL_COUNT; ++i)
+    {
+        oe_cert_chain_free(&collateral->crl_issuer_chain[i]);
+    }
+    oe_cert_chain_free(&collateral->tcb_issuer_chain);
+    oe_free(collateral->tcb_levels);
+    oe_free(collateral);
+}
 
-    OE_STATIC_ASSERT(
-        OE_COUNTOF(crl_issuer_chain) >= OE_SGX_ENDORSEMENTS_CRL_COUNT);
+/**
+ * Read the TCB info levels, the TCB issuer chain, the CRLs and the CRL issuer
+ * chains from the endorsements into a new (not yet cached) collateral object.
+ */
+static oe_result_t _read_revocation_collateral(
+    const oe_sgx_endorsements_t* sgx_endorsements,
+    const OE_SHA256* key,
+    revocation_collateral_t** collateral_out)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    revocation_collateral_t* collateral = NULL;
+
+    if (!(collateral = oe_calloc(1, sizeof(revocation_collateral_t))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    oe_sgx_collateral_init(
+        &collateral->base,
+        OE_SGX_COLLATERAL_REVOCATION,
+        key,
+        _free_revocation_collateral);
 
     OE_CHECK_MSG(
-        _parse_sgx_extensions(pck_cert, &parsed_extension_info),
-        "Failed to parse SGX extensions from leaf cert. %s",
+        oe_parse_tcb_info_json_levels(
+            sgx_endorsements->items[OE_SGX_ENDORSEMENT_FIELD_TCB_INFO].data,
+            sgx_endorsements->items[OE_SGX_ENDORSEMENT_FIELD_TCB_INFO].size,
+            &collateral->parsed_tcb_info,
+            &collateral->tcb_levels,
+            &collateral->tcb_level_count),
+        "Failed to parse TCB info. %s",
         oe_result_str(result));
 
     OE_CHECK_MSG(
         oe_cert_chain_read_pem(
-            &tcb_issuer_chain,
+            &collateral->tcb_issuer_chain,
             sgx_endorsements->items[OE_SGX_ENDORSEMENT_FIELD_TCB_ISSUER_CHAIN]
                 .data,
             sgx_endorsements->items[OE_SGX_ENDORSEMENT_FIELD_TCB_ISSUER_CHAIN]
@@ -344,7 +405,7 @@ oe_result_t oe_validate_revocation_list(
     {
         OE_CHECK_MSG(
             oe_crl_read_der(
-                &crls[i],
+                &collateral->crls[i],
                 sgx_endorsements
                     ->items[OE_SGX_ENDORSEMENT_FIELD_CRL_PCK_CERT + i]
                     .data,
@@ -355,7 +416,7 @@ oe_result_t oe_validate_revocation_list(
             oe_result_str(result));
         OE_CHECK_MSG(
             oe_cert_chain_read_pem(
-                &crl_issuer_chain[i],
+                &collateral->crl_issuer_chain[i],
                 sgx_endorsements
                     ->items
                         [OE_SGX_ENDORSEMENT_FIELD_CRL_ISSUER_CHAIN_PCK_CERT + i]
@@ -374,6 +435,126 @@ oe_result_t oe_validate_revocation_list(
                 .data);
     }
 
+    *collateral_out = collateral;
+    collateral = NULL;
+    result = OE_OK;
+
+done:
+    if (collateral)
+        _free_revocation_collateral(&collateral->base);
+
+    return result;
+}
+
+/**
+ * Verify the TCB info signature of newly read collateral and compute its
+ * validity dates, after which it can be shared through the cache.
+ */
+static oe_result_t _verify_revocation_collateral(
+    revocation_collateral_t* collateral)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_parsed_tcb_info_t* parsed_tcb_info = &collateral->parsed_tcb_info;
+    oe_cert_t tcb_cert = {0};
+
+    OE_CHECK_MSG(
+        oe_verify_ecdsa256_signature(
+            parsed_tcb_info->tcb_info_start,
+            parsed_tcb_info->tcb_info_size,
+            (sgx_ecdsa256_signature_t*)parsed_tcb_info->signature,
+            &collateral->tcb_issuer_chain),
+        "Failed to verify ECDSA 256 signature in TCB. %s",
+        oe_result_str(result));
+
+    // The signed bytes point into the endorsements of the first quote, which
+    // do not outlive this call.
+    parsed_tcb_info->tcb_info_start = NULL;
+    parsed_tcb_info->tcb_info_size = 0;
+
+    OE_CHECK_MSG(
+        _get_revocation_validity(
+            parsed_tcb_info,
+            collateral->crls,
+            OE_COUNTOF(collateral->crls),
+            &collateral->crl_from,
+            &collateral->crl_until),
+        "Failed to get revocation validity datetime info. %s",
+        oe_result_str(result));
+
+    // Get TCB cert validity period.
+    OE_CHECK_MSG(
+        oe_cert_chain_get_leaf_cert(&collateral->tcb_issuer_chain, &tcb_cert),
+        "Failed to get TCB certificate.",
+        NULL);
+    oe_cert_get_validity_dates(
+        &tcb_cert, &collateral->tcb_cert_from, &collateral->tcb_cert_until);
+
+    result = OE_OK;
+
+done:
+    oe_cert_free(&tcb_cert);
+
+    return result;
+}
+
+oe_result_t oe_validate_revocation_list(
+    oe_cert_t* pck_cert,
+    const oe_sgx_endorsements_t* sgx_endorsements,
+    oe_datetime_t* validity_from,
+    oe_datetime_t* validity_until)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    ParsedExtensionInfo parsed_extension_info = {{0}};
+    OE_SHA256 key;
+    revocation_collateral_t* collateral = NULL;
+    bool cached = false;
+    oe_tcb_info_tcb_level_t platform_tcb_level = {{0}};
+
+    uint32_t version = 0;
+    const oe_crl_t* crl_ptrs[OE_SGX_ENDORSEMENTS_CRL_COUNT];
+    oe_datetime_t latest_from = {0};
+    oe_datetime_t earliest_until = {0};
+
+    if (pck_cert == NULL || sgx_endorsements == NULL)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    version =
+        *(uint32_t*)sgx_endorsements->items[OE_SGX_ENDORSEMENT_FIELD_VERSION]
+             .data;
+    if (version != OE_SGX_ENDORSEMENTS_VERSION)
+        OE_RAISE_MSG(
+            OE_INVALID_PARAMETER,
+            "SGX endorsement version is %d, expected %d",
+            version,
+            OE_SGX_ENDORSEMENTS_VERSION);
+
+    OE_CHECK_MSG(
+        _parse_sgx_extensions(pck_cert, &parsed_extension_info),
+        "Failed to parse SGX extensions from leaf cert. %s",
+        oe_result_str(result));
+
+    // The parsed CRLs and issuer chains only depend on the TCB info, CRL and
+    // issuer chain items, so they are shared by all quotes that come with
+    // the same endorsements.
+    OE_CHECK(oe_sgx_collateral_hash_items(
+        sgx_endorsements,
+        OE_SGX_ENDORSEMENT_FIELD_TCB_INFO,
+        OE_SGX_ENDORSEMENT_FIELD_CRL_ISSUER_CHAIN_PCK_PROC_CA,
+        &key));
+
+    collateral = (revocation_collateral_t*)oe_sgx_collateral_cache_find(
+        OE_SGX_COLLATERAL_REVOCATION, &key);
+
+    if (collateral)
+        cached = true;
+    else
+        OE_CHECK(
+            _read_revocation_collateral(sgx_endorsements, &key, &collateral));
+
+    for (uint32_t i = 0; i < OE_SGX_ENDORSEMENTS_CRL_COUNT; ++i)
+        crl_ptrs[i] = &collateral->crls[i];
+
     // Verify the leaf cert.
     // oe_cert_verify incorporates openssl -crl_check_all semantics.
     // For successful verification:
@@ -391,7 +572,10 @@ oe_result_t oe_validate_revocation_list(
     // for certificates in the chain.
     OE_CHECK_MSG(
         oe_cert_verify(
-            pck_cert, crl_issuer_chain, crl_ptrs, OE_COUNTOF(crl_ptrs)),
+            pck_cert,
+            collateral->crl_issuer_chain,
+            crl_ptrs,
+            OE_COUNTOF(crl_ptrs)),
         "Failed to verify leaf certificate. %s",
         oe_result_str(result));
 
@@ -405,32 +589,22 @@ oe_result_t oe_validate_revocation_list(
     platform_tcb_level.status.AsUINT32 = OE_TCB_LEVEL_STATUS_UNKNOWN;
 
     OE_CHECK_MSG(
-        oe_parse_tcb_info_json(
-            sgx_endorsements->items[OE_SGX_ENDORSEMENT_FIELD_TCB_INFO].data,
-            sgx_endorsements->items[OE_SGX_ENDORSEMENT_FIELD_TCB_INFO].size,
-            &platform_tcb_level,
-            &parsed_tcb_info),
-        "Failed to parse TCB info. %s",
+        oe_evaluate_tcb_info_levels(
+            collateral->tcb_levels,
+            collateral->tcb_level_count,
+            &platform_tcb_level),
+        "Failed to evaluate TCB info. %s",
         oe_result_str(result));
 
-    OE_CHECK_MSG(
-        oe_verify_ecdsa256_signature(
-            parsed_tcb_info.tcb_info_start,
-            parsed_tcb_info.tcb_info_size,
-            (sgx_ecdsa256_signature_t*)parsed_tcb_info.signature,
-            &tcb_issuer_chain),
-        "Failed to verify ECDSA 256 signature in TCB. %s",
-        oe_result_str(result));
+    // Collateral from the cache has already been verified.
+    if (!cached)
+    {
+        OE_CHECK(_verify_revocation_collateral(collateral));
+        oe_sgx_collateral_cache_insert(&collateral->base);
+    }
 
-    OE_CHECK_MSG(
-        _get_revocation_validity(
-            &parsed_tcb_info,
-            crls,
-            OE_COUNTOF(crls),
-            &latest_from,
-            &earliest_until),
-        "Failed to get revocation validity datetime info. %s",
-        oe_result_str(result));
+    latest_from = collateral->crl_from;
+    earliest_until = collateral->crl_until;
 
     if (oe_datetime_compare(&latest_from, &_sgx_minimim_crl_tcb_issue_date) < 0)
     {
@@ -457,19 +631,13 @@ oe_result_t oe_validate_revocation_list(
             oe_result_str(result));
     }
 
-    // Get TCB cert validity period.
-    OE_CHECK_MSG(
-        oe_cert_chain_get_leaf_cert(&tcb_issuer_chain, &tcb_cert),
-        "Failed to get TCB certificate.",
-        NULL);
-    oe_cert_get_validity_dates(&tcb_cert, &from, &until);
-    oe_datetime_log("TCB cert issue date: ", &from);
-    oe_datetime_log("TCB cert next update: ", &until);
-
-    if (oe_datetime_compare(&from, &latest_from) > 0)
-        latest_from = from;
-    if (oe_datetime_compare(&until, &earliest_until) < 0)
-        earliest_until = until;
+    oe_datetime_log("TCB cert issue date: ", &collateral->tcb_cert_from);
+    oe_datetime_log("TCB cert next update: ", &collateral->tcb_cert_until);
+
+    if (oe_datetime_compare(&collateral->tcb_cert_from, &latest_from) > 0)
+        latest_from = collateral->tcb_cert_from;
+    if (oe_datetime_compare(&collateral->tcb_cert_until, &earliest_until) < 0)
+        earliest_until = collateral->tcb_cert_until;
     oe_datetime_log("Revocation overall issue date: ", &latest_from);
     oe_datetime_log("Revocation overall next update: ", &earliest_until);
 
@@ -484,16 +652,8 @@ oe_result_t oe_validate_revocation_list(
     result = OE_OK;
 
 done:
-    for (int32_t i = (int32_t)OE_SGX_ENDORSEMENTS_CRL_COUNT - 1; i >= 0; --i)
-    {
-        oe_crl_free(&crls[i]);
-    }
-    for (uint32_t i = 0; i < OE_SGX_ENDORSEMENTS_CRL_COUNT; ++i)
-    {
-        oe_cert_chain_free(&crl_issuer_chain[i]);
-    }
-    oe_cert_chain_free(&tcb_issuer_chain);
-    oe_cert_free(&tcb_cert);
+    if (collateral)
+        oe_sgx_collateral_release(&collateral->base);
 
     return result;
 }
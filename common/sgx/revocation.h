@@ -49,6 +49,29 @@ oe_result_t oe_get_revocation_info_from_certs(
     oe_cert_t* intermediate_cert,
     oe_get_revocation_info_args_t* args);
 
+/**
+ * Fill in the FMSPC and CRL distribution point URLs of the revocation info
+ * input parameters from the PCK certificate and CA certificate.
+ *
+ * Caller is responsible for freeing the URLs by calling
+ * oe_free_revocation_info_urls().
+ *
+ * @param[in] leaf_cert The PCK certificate.
+ * @param[in] intermediate_cert The CA certificate.
+ * @param[out] args The revocation info.
+ */
+oe_result_t oe_get_revocation_info_args_from_certs(
+    oe_cert_t* leaf_cert,
+    oe_cert_t* intermediate_cert,
+    oe_get_revocation_info_args_t* args);
+
+/**
+ * Free the URLs allocated by oe_get_revocation_info_args_from_certs().
+ *
+ * @param[in] args The revocation info.
+ */
+void oe_free_revocation_info_urls(oe_get_revocation_info_args_t* args);
+
 /**
  * Get the revocation info from the quote provider.  Caller is responsible for
  * configuring the revocation info input parameters.
@@ -84,6 +84,201 @@ done:
     return result;
 }
 
+#if defined(__GNUC__) && defined(__SSE2__)
+/*
+ * The scanners below compare 16 bytes at a time with SSE2. They use the vector
+ * extensions of the compiler rather than the intrinsics headers, which are not
+ * available to enclaves (built with -nostdinc).
+ */
+#define _USE_SSE2
+
+typedef char _vector_t __attribute__((vector_size(16), aligned(1), may_alias));
+
+OE_INLINE _vector_t _splat(char c)
+{
+    _vector_t v = {c, c, c, c, c, c, c, c, c, c, c, c, c, c, c, c};
+    return v;
+}
+
+// Bit i of the result is set if byte i of v is c.
+OE_INLINE uint64_t _match(_vector_t v, char c)
+{
+    return (uint32_t)__builtin_ia32_pmovmskb128((_vector_t)(v == _splat(c)));
+}
+#endif
+
+// Classification of 64 bytes of json: bit i of each mask is set if byte i
+// is of the given kind.
+typedef struct _json_block
+{
+    uint64_t quote;
+    uint64_t backslash;
+    uint64_t open;  // '[' or '{'
+    uint64_t close; // ']' or '}'
+} json_block_t;
+
+static void _classify_block(const uint8_t* p, json_block_t* block)
+{
+    block->quote = block->backslash = block->open = block->close = 0;
+
+#if defined(_USE_SSE2)
+    for (uint32_t i = 0; i < 64; i += 16)
+    {
+        _vector_t v = *(const _vector_t*)(p + i);
+
+        // '[' and ']' only differ from '{' and '}' in the 0x20 bit.
+        _vector_t lower = v | _splat(0x20);
+
+        block->quote |= _match(v, '"') << i;
+        block->backslash |= _match(v, '\\') << i;
+        block->open |= _match(lower, '{') << i;
+        block->close |= _match(lower, '}') << i;
+    }
+#else
+    for (uint32_t i = 0; i < 64; ++i)
+    {
+        uint64_t bit = 1ULL << i;
+
+        if (p[i] == '"')
+            block->quote |= bit;
+        else if (p[i] == '\\')
+            block->backslash |= bit;
+        else if (p[i] == '[' || p[i] == '{')
+            block->open |= bit;
+        else if (p[i] == ']' || p[i] == '}')
+            block->close |= bit;
+    }
+#endif
+}
+
+// Set each bit to the xor of itself and all lower bits. For a mask of quotes,
+// this sets the bits from an opening quote up to the closing quote.
+OE_INLINE uint64_t _prefix_xor(uint64_t x)
+{
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+// Find the first '"' or '\\' at or after p.
+static const uint8_t* _scan_string(const uint8_t* p, const uint8_t* end)
+{
+#if defined(_USE_SSE2)
+    while (end - p >= 16)
+    {
+        _vector_t v = *(const _vector_t*)p;
+        uint64_t found = _match(v, '"') | _match(v, '\\');
+
+        if (found)
+            return p + __builtin_ctzll(found);
+        p += 16;
+    }
+#endif
+    while (p < end && *p != '"' && *p != '\\')
+        ++p;
+    return p;
+}
+
+// Skip the remaining values of the array the current position is in.
+// Consume everything up to, but not including, the ']' that closes the array.
+// Nested arrays and objects are skipped as a whole and brackets within
+// strings are ignored. The json is classified 64 bytes at a time, so that only
+// the brackets outside of strings are looked at one by one.
+static oe_result_t _skip_to_array_end(const uint8_t** itr, const uint8_t* end)
+{
+    oe_result_t result = OE_JSON_INFO_PARSE_ERROR;
+    const uint8_t* p = *itr;
+    uint64_t in_string = 0;
+    size_t depth = 0;
+
+    while (end - p >= 64)
+    {
+        json_block_t block;
+        uint64_t strings = 0;
+        uint64_t open = 0;
+        uint64_t brackets = 0;
+
+        _classify_block(p, &block);
+
+        // JSON escape sequences are not supported.
+        if (block.backslash)
+            OE_RAISE(OE_JSON_INFO_PARSE_ERROR);
+
+        // in_string is all ones if the previous block ended within a string.
+        strings = _prefix_xor(block.quote) ^ in_string;
+        in_string = 0 - (strings >> 63);
+
+        open = block.open & ~strings;
+        brackets = open | (block.close & ~strings);
+        for (; brackets; brackets &= brackets - 1)
+        {
+            uint64_t bit = brackets & (0 - brackets);
+
+            if (open & bit)
+            {
+                ++depth;
+            }
+            else if (depth > 0)
+            {
+                --depth;
+            }
+            else
+            {
+                while (!(bit & 1))
+                {
+                    bit >>= 1;
+                    ++p;
+                }
+                goto found;
+            }
+        }
+        p += 64;
+    }
+
+    for (; p < end; ++p)
+    {
+        if (in_string)
+        {
+            if (*p == '"')
+                in_string = 0;
+            else if (*p == '\\')
+                OE_RAISE(OE_JSON_INFO_PARSE_ERROR);
+        }
+        else if (*p == '"')
+        {
+            in_string = 1;
+        }
+        else if (*p == '[' || *p == '{')
+        {
+            ++depth;
+        }
+        else if (*p == ']' || *p == '}')
+        {
+            if (depth == 0)
+                goto found;
+            --depth;
+        }
+        else if (*p == '\\')
+        {
+            OE_RAISE(OE_JSON_INFO_PARSE_ERROR);
+        }
+    }
+    OE_RAISE(OE_JSON_INFO_PARSE_ERROR);
+
+found:
+    if (*p != ']')
+        OE_RAISE(OE_JSON_INFO_PARSE_ERROR);
+
+    *itr = p;
+    result = OE_OK;
+done:
+    return result;
+}
+
 // Read a string literal in current position.
 // Only the necessary subset of json strings are supported.
 // JSON escape sequences are not supported.
@@ -101,13 +296,7 @@ static oe_result_t _read_string(
     if (p < end && *p == '"')
     {
         *str = ++p;
-        while (p < end && *p != '"')
-        {
-            if (*p == '\\')
-                OE_RAISE(OE_JSON_INFO_PARSE_ERROR);
-
-            ++p;
-        }
+        p = _scan_string(p, end);
 
         if (p < end && *p == '"')
         {
@@ -116,7 +305,6 @@ static oe_result_t _read_string(
             result = OE_OK;
         }
     }
-done:
     return result;
 }
 
@@ -162,40 +350,43 @@ done:
     return result;
 }
 
+// Read the expected property name and the colon that follows it. The name is
+// compared in place against the json, without first scanning the whole
+// string, so that a mismatch is detected at the first differing character.
 static oe_result_t _read_property_name_and_colon(
     const char* property_name,
     const uint8_t** itr,
     const uint8_t* end)
 {
     oe_result_t result = OE_JSON_INFO_PARSE_ERROR;
-    const uint8_t* name = NULL;
-    size_t name_length = 0;
-    const uint8_t* tmp_itr = *itr;
+    const uint8_t* p = _skip_ws(*itr, end);
 
-    OE_CHECK(_read_string(&tmp_itr, end, &name, &name_length));
-    if (name_length == oe_strlen(property_name) &&
-        memcmp(property_name, name, name_length) == 0)
+    if (p >= end || *p++ != '"')
+        goto done;
+
+    for (; *property_name; ++property_name, ++p)
     {
-        OE_CHECK(_read(':', &tmp_itr, end));
-        *itr = tmp_itr;
-        result = OE_OK;
+        if (p >= end || *p != (uint8_t)*property_name)
+            goto done;
     }
+
+    if (p >= end || *p != '"')
+        goto done;
+
+    p = _skip_ws(p + 1, end);
+    OE_CHECK(_read(':', &p, end));
+    *itr = p;
+    result = OE_OK;
 done:
     return result;
 }
 
-static bool _json_str_equal(
-    const uint8_t* str1,
-    size_t str1_length,
-    const char* str2)
-{
-    size_t str2_length = oe_strlen(str2);
-
-    // Strings in json stream are not zero terminated.
-    // Hence the special comparison function.
-    return (str1_length == str2_length) &&
-           (memcmp(str1, str2, str2_length) == 0);
-}
+// Strings in json stream are not zero terminated.
+// Hence the special comparison function. The expected strings are literals,
+// so their lengths are known at compile time.
+#define _json_str_equal(str, str_length, literal) \
+    ((str_length) == sizeof(literal) - 1 &&       \
+     memcmp(str, literal, sizeof(literal) - 1) == 0)
 
 static oe_result_t _trace_json_string(const uint8_t* str, size_t str_length)
 {
@@ -227,18 +418,32 @@ static oe_tcb_level_status_t _parse_tcb_status(
     oe_tcb_level_status_t status;
     status.AsUINT32 = OE_TCB_LEVEL_STATUS_UNKNOWN;
 
-    if (_json_str_equal(str, length, "UpToDate"))
-        status.fields.up_to_date = 1;
-    else if (_json_str_equal(str, length, "OutOfDate"))
-        status.fields.outofdate = 1;
-    else if (_json_str_equal(str, length, "Revoked"))
-        status.fields.revoked = 1;
-    else if (_json_str_equal(str, length, "ConfigurationNeeded"))
-        status.fields.configuration_needed = 1;
-    else if (_json_str_equal(str, length, "OutOfDateConfigurationNeeded"))
+    // The status names all have different lengths.
+    switch (length)
     {
-        status.fields.qe_identity_out_of_date = 1;
-        status.fields.configuration_needed = 1;
+        case sizeof("UpToDate") - 1:
+            if (_json_str_equal(str, length, "UpToDate"))
+                status.fields.up_to_date = 1;
+            break;
+        case sizeof("OutOfDate") - 1:
+            if (_json_str_equal(str, length, "OutOfDate"))
+                status.fields.outofdate = 1;
+            break;
+        case sizeof("Revoked") - 1:
+            if (_json_str_equal(str, length, "Revoked"))
+                status.fields.revoked = 1;
+            break;
+        case sizeof("ConfigurationNeeded") - 1:
+            if (_json_str_equal(str, length, "ConfigurationNeeded"))
+                status.fields.configuration_needed = 1;
+            break;
+        case sizeof("OutOfDateConfigurationNeeded") - 1:
+            if (_json_str_equal(str, length, "OutOfDateConfigurationNeeded"))
+            {
+                status.fields.qe_identity_out_of_date = 1;
+                status.fields.configuration_needed = 1;
+            }
+            break;
     }
 
     return status;
@@ -321,7 +526,7 @@ done:
 // 4. If no tcb level was chosen, then the status of the platform is unknown.
 static void _determine_platform_tcb_info_tcb_level(
     oe_tcb_info_tcb_level_t* platform_tcb_level,
-    oe_tcb_info_tcb_level_t* tcb_level)
+    const oe_tcb_info_tcb_level_t* tcb_level)
 {
     // If the platform's status has already been determined, return.
     if (platform_tcb_level->status.AsUINT32 != OE_TCB_LEVEL_STATUS_UNKNOWN)
@@ -357,10 +562,9 @@ static void _determine_platform_tcb_info_tcb_level(
 static oe_result_t _read_tcb_info_tcb_level_v1(
     const uint8_t** itr,
     const uint8_t* end,
-    oe_tcb_info_tcb_level_t* platform_tcb_level)
+    oe_tcb_info_tcb_level_t* tcb_level)
 {
     oe_result_t result = OE_JSON_INFO_PARSE_ERROR;
-    oe_tcb_info_tcb_level_t tcb_level = {{0}};
     const uint8_t* status = NULL;
     size_t status_length = 0;
 
@@ -368,7 +572,7 @@ static oe_result_t _read_tcb_info_tcb_level_v1(
 
     OE_TRACE_VERBOSE("Reading tcb");
     OE_CHECK(_read_property_name_and_colon("tcb", itr, end));
-    OE_CHECK(_read_tcb_info_tcb_level(itr, end, &tcb_level));
+    OE_CHECK(_read_tcb_info_tcb_level(itr, end, tcb_level));
     OE_CHECK(_read(',', itr, end));
 
     OE_TRACE_VERBOSE("Reading status");
@@ -378,12 +582,9 @@ static oe_result_t _read_tcb_info_tcb_level_v1(
 
     OE_CHECK(_read('}', itr, end));
 
-    tcb_level.status = _parse_tcb_status(status, status_length);
-    if (tcb_level.status.AsUINT32 != OE_TCB_LEVEL_STATUS_UNKNOWN)
-    {
-        _determine_platform_tcb_info_tcb_level(platform_tcb_level, &tcb_level);
+    tcb_level->status = _parse_tcb_status(status, status_length);
+    if (tcb_level->status.AsUINT32 != OE_TCB_LEVEL_STATUS_UNKNOWN)
         result = OE_OK;
-    }
 
 done:
     return result;
@@ -406,7 +607,6 @@ static oe_result_t _read_tcb_info_tcb_level_v2(
     const uint8_t* info_json,
     const uint8_t** itr,
     const uint8_t* end,
-    oe_tcb_info_tcb_level_t* platform_tcb_level,
     oe_tcb_info_tcb_level_t* tcb_level)
 {
     oe_result_t result = OE_JSON_INFO_PARSE_ERROR;
@@ -443,26 +643,51 @@ static oe_result_t _read_tcb_info_tcb_level_v2(
         OE_CHECK(_read('[', itr, end));
 
         tcb_level->advisory_ids_offset = (size_t)(*itr - info_json);
-        size_t size = 0;
-
-        while (*itr < end && **itr != ']')
-        {
-            (*itr)++;
-            size++;
-        }
+        OE_CHECK(_skip_to_array_end(itr, end));
+        tcb_level->advisory_ids_size =
+            (size_t)(*itr - info_json) - tcb_level->advisory_ids_offset;
         OE_CHECK(_read(']', itr, end));
-        tcb_level->advisory_ids_size = size;
     }
 
     OE_CHECK(_read('}', itr, end));
 
     tcb_level->status = _parse_tcb_status(status, status_length);
     if (tcb_level->status.AsUINT32 != OE_TCB_LEVEL_STATUS_UNKNOWN)
-    {
-        _determine_platform_tcb_info_tcb_level(platform_tcb_level, tcb_level);
         result = OE_OK;
+
+done:
+    return result;
+}
+
+// The TCB levels collected by oe_parse_tcb_info_json_levels().
+typedef struct _tcb_level_table
+{
+    oe_tcb_info_tcb_level_t* levels;
+    size_t count;
+    size_t capacity;
+} tcb_level_table_t;
+
+static oe_result_t _add_tcb_level(
+    tcb_level_table_t* table,
+    oe_tcb_info_tcb_level_t** tcb_level)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (table->count == table->capacity)
+    {
+        size_t capacity = table->capacity ? table->capacity * 2 : 8;
+        oe_tcb_info_tcb_level_t* levels = (oe_tcb_info_tcb_level_t*)oe_realloc(
+            table->levels, capacity * sizeof(oe_tcb_info_tcb_level_t));
+
+        if (!levels)
+            OE_RAISE(OE_OUT_OF_MEMORY);
+
+        table->levels = levels;
+        table->capacity = capacity;
     }
 
+    *tcb_level = &table->levels[table->count++];
+    result = OE_OK;
 done:
     return result;
 }
@@ -496,7 +721,8 @@ static oe_result_t _read_tcb_info(
     const uint8_t** itr,
     const uint8_t* end,
     oe_tcb_info_tcb_level_t* platform_tcb_level,
-    oe_parsed_tcb_info_t* parsed_info)
+    oe_parsed_tcb_info_t* parsed_info,
+    tcb_level_table_t* table)
 {
     oe_result_t result = OE_JSON_INFO_PARSE_ERROR;
     uint64_t value = 0;
@@ -572,53 +798,8 @@ static oe_result_t _read_tcb_info(
         OE_CHECK(_read_integer(itr, end, &value));
         parsed_info->tcb_evaluation_data_number = (uint32_t)value;
         OE_CHECK(_read(',', itr, end));
-
-        OE_TRACE_VERBOSE("Reading tcbLevels (V2)");
-        OE_CHECK(_read_property_name_and_colon("tcbLevels", itr, end));
-        OE_CHECK(_read('[', itr, end));
-        while (*itr < end)
-        {
-            OE_CHECK(_read_tcb_info_tcb_level_v2(
-                tcb_info_json,
-                itr,
-                end,
-                platform_tcb_level,
-                &parsed_info->tcb_level));
-
-            // Optimization
-            if (platform_tcb_level->status.AsUINT32 !=
-                OE_TCB_LEVEL_STATUS_UNKNOWN)
-            {
-                // Found matching TCB level, go to the end of the array.
-                while (*itr < end && **itr != ']')
-                    (*itr)++;
-            }
-
-            // Read end of array or comma separator.
-            if (*itr < end && **itr == ']')
-                break;
-
-            OE_CHECK(_read(',', itr, end));
-        }
-        OE_CHECK(_read(']', itr, end));
-    }
-    else if (parsed_info->version == 1)
-    {
-        OE_TRACE_VERBOSE("Reading tcbLevels (V1)");
-        OE_CHECK(_read_property_name_and_colon("tcbLevels", itr, end));
-        OE_CHECK(_read('[', itr, end));
-        while (*itr < end)
-        {
-            OE_CHECK(_read_tcb_info_tcb_level_v1(itr, end, platform_tcb_level));
-            // Read end of array or comma separator.
-            if (*itr < end && **itr == ']')
-                break;
-
-            OE_CHECK(_read(',', itr, end));
-        }
-        OE_CHECK(_read(']', itr, end));
     }
-    else
+    else if (parsed_info->version != 1)
     {
         OE_RAISE_MSG(
             OE_JSON_INFO_PARSE_ERROR,
@@ -626,6 +807,49 @@ static oe_result_t _read_tcb_info(
             parsed_info->version);
     }
 
+    OE_TRACE_VERBOSE("Reading tcbLevels (V%d)", parsed_info->version);
+    OE_CHECK(_read_property_name_and_colon("tcbLevels", itr, end));
+    OE_CHECK(_read('[', itr, end));
+    while (*itr < end)
+    {
+        oe_tcb_info_tcb_level_t* tcb_level = &parsed_info->tcb_level;
+
+        if (table)
+            OE_CHECK(_add_tcb_level(table, &tcb_level));
+        memset(tcb_level, 0, sizeof(*tcb_level));
+
+        if (parsed_info->version == 2)
+            OE_CHECK(_read_tcb_info_tcb_level_v2(
+                tcb_info_json, itr, end, tcb_level));
+        else
+            OE_CHECK(_read_tcb_info_tcb_level_v1(itr, end, tcb_level));
+
+        if (platform_tcb_level)
+        {
+            _determine_platform_tcb_info_tcb_level(
+                platform_tcb_level, tcb_level);
+
+            // The levels are sorted, so the first matching level is the
+            // platform's level. V2 levels after it are skipped unparsed.
+            if (parsed_info->version == 2 &&
+                platform_tcb_level->status.AsUINT32 !=
+                    OE_TCB_LEVEL_STATUS_UNKNOWN)
+                OE_CHECK(_skip_to_array_end(itr, end));
+        }
+
+        // Read end of array or comma separator.
+        if (*itr < end && **itr == ']')
+            break;
+
+        OE_CHECK(_read(',', itr, end));
+    }
+    OE_CHECK(_read(']', itr, end));
+
+    // In table mode the levels are read into the table, so copy the last one
+    // as in single platform mode.
+    if (table && table->count)
+        parsed_info->tcb_level = table->levels[table->count - 1];
+
     // itr is expected to point to the '}' that denotes the end of the tcb
     // object. The signature is generated over the entire object including the
     // '}'.
@@ -638,6 +862,41 @@ done:
     return result;
 }
 
+// Raise OE_TCB_LEVEL_INVALID unless the platform's TCB level is up to date.
+static oe_result_t _check_platform_tcb_level(
+    const oe_tcb_info_tcb_level_t* platform_tcb_level)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (platform_tcb_level->status.fields.up_to_date != 1)
+    {
+        for (uint32_t i = 0;
+             i < OE_COUNTOF(platform_tcb_level->sgx_tcb_comp_svn);
+             ++i)
+            OE_TRACE_VERBOSE(
+                "sgx_tcb_comp_svn[%d] = 0x%x",
+                i,
+                platform_tcb_level->sgx_tcb_comp_svn[i]);
+        OE_TRACE_VERBOSE("pce_svn = 0x%x", platform_tcb_level->pce_svn);
+        OE_RAISE_MSG(
+            OE_TCB_LEVEL_INVALID,
+            "Platform TCB (%d) is not up-to-date",
+            platform_tcb_level->status);
+    }
+
+    // Display any advisory IDs as warnings
+    if (platform_tcb_level->advisory_ids_size > 0)
+    {
+        OE_TRACE_WARNING(
+            "Found %d AdvisoryIDs for this tcb level.",
+            platform_tcb_level->advisory_ids_size);
+    }
+
+    result = OE_OK;
+done:
+    return result;
+}
+
 /**
  * Schema:
  * {
@@ -645,34 +904,32 @@ done:
  *    "signature" : "hex string"
  * }
  */
-oe_result_t oe_parse_tcb_info_json(
+static oe_result_t _parse_tcb_info_json(
     const uint8_t* tcb_info_json,
     size_t tcb_info_json_size,
     oe_tcb_info_tcb_level_t* platform_tcb_level,
-    oe_parsed_tcb_info_t* parsed_info)
+    oe_parsed_tcb_info_t* parsed_info,
+    tcb_level_table_t* table)
 {
     oe_result_t result = OE_JSON_INFO_PARSE_ERROR;
     const uint8_t* itr = tcb_info_json;
     const uint8_t* end = tcb_info_json + tcb_info_json_size;
 
     if (tcb_info_json == NULL || tcb_info_json_size == 0 ||
-        platform_tcb_level == NULL || parsed_info == NULL)
+        parsed_info == NULL)
         OE_RAISE(OE_INVALID_PARAMETER);
 
     // Pointer wrapping.
     if (end <= itr)
         OE_RAISE(OE_INVALID_PARAMETER);
 
-    // Initialize status
-    platform_tcb_level->status.AsUINT32 = OE_TCB_LEVEL_STATUS_UNKNOWN;
-
     itr = _skip_ws(itr, end);
     OE_CHECK(_read('{', &itr, end));
 
     OE_TRACE_VERBOSE("Reading tcbInfo");
     OE_CHECK(_read_property_name_and_colon("tcbInfo", &itr, end));
     OE_CHECK(_read_tcb_info(
-        tcb_info_json, &itr, end, platform_tcb_level, parsed_info));
+        tcb_info_json, &itr, end, platform_tcb_level, parsed_info, table));
     OE_CHECK(_read(',', &itr, end));
 
     OE_TRACE_VERBOSE("Reading signature");
@@ -682,34 +939,90 @@ oe_result_t oe_parse_tcb_info_json(
 
     OE_CHECK(_read('}', &itr, end));
 
-    if (itr == end)
-    {
-        if (platform_tcb_level->status.fields.up_to_date != 1)
-        {
-            for (uint32_t i = 0;
-                 i < OE_COUNTOF(platform_tcb_level->sgx_tcb_comp_svn);
-                 ++i)
-                OE_TRACE_VERBOSE(
-                    "sgx_tcb_comp_svn[%d] = 0x%x",
-                    i,
-                    platform_tcb_level->sgx_tcb_comp_svn[i]);
-            OE_TRACE_VERBOSE("pce_svn = 0x%x", platform_tcb_level->pce_svn);
-            OE_RAISE_MSG(
-                OE_TCB_LEVEL_INVALID,
-                "Platform TCB (%d) is not up-to-date",
-                platform_tcb_level->status);
-        }
+    if (itr != end)
+        OE_RAISE(OE_JSON_INFO_PARSE_ERROR);
 
-        // Display any advisory IDs as warnings
-        if (platform_tcb_level->advisory_ids_size > 0)
-        {
-            OE_TRACE_WARNING(
-                "Found %d AdvisoryIDs for this tcb level.",
-                platform_tcb_level->advisory_ids_size);
-        }
+    result = OE_OK;
+done:
+    return result;
+}
 
-        result = OE_OK;
-    }
+oe_result_t oe_parse_tcb_info_json(
+    const uint8_t* tcb_info_json,
+    size_t tcb_info_json_size,
+    oe_tcb_info_tcb_level_t* platform_tcb_level,
+    oe_parsed_tcb_info_t* parsed_info)
+{
+    oe_result_t result = OE_JSON_INFO_PARSE_ERROR;
+
+    if (platform_tcb_level == NULL)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    // Initialize status
+    platform_tcb_level->status.AsUINT32 = OE_TCB_LEVEL_STATUS_UNKNOWN;
+
+    OE_CHECK(_parse_tcb_info_json(
+        tcb_info_json,
+        tcb_info_json_size,
+        platform_tcb_level,
+        parsed_info,
+        NULL));
+    OE_CHECK(_check_platform_tcb_level(platform_tcb_level));
+
+    result = OE_OK;
+done:
+    return result;
+}
+
+oe_result_t oe_parse_tcb_info_json_levels(
+    const uint8_t* tcb_info_json,
+    size_t tcb_info_json_size,
+    oe_parsed_tcb_info_t* parsed_info,
+    oe_tcb_info_tcb_level_t** tcb_levels,
+    size_t* tcb_level_count)
+{
+    oe_result_t result = OE_JSON_INFO_PARSE_ERROR;
+    tcb_level_table_t table = {0};
+
+    if (tcb_levels == NULL || tcb_level_count == NULL)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(_parse_tcb_info_json(
+        tcb_info_json, tcb_info_json_size, NULL, parsed_info, &table));
+
+    *tcb_levels = table.levels;
+    *tcb_level_count = table.count;
+    table.levels = NULL;
+    result = OE_OK;
+done:
+    oe_free(table.levels);
+    return result;
+}
+
+oe_result_t oe_evaluate_tcb_info_levels(
+    const oe_tcb_info_tcb_level_t* tcb_levels,
+    size_t tcb_level_count,
+    oe_tcb_info_tcb_level_t* platform_tcb_level)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if ((tcb_levels == NULL && tcb_level_count > 0) ||
+        platform_tcb_level == NULL)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    // The table is sorted, so the first level that the platform meets is the
+    // platform's level.
+    platform_tcb_level->status.AsUINT32 = OE_TCB_LEVEL_STATUS_UNKNOWN;
+    for (size_t i = 0; i < tcb_level_count &&
+                       platform_tcb_level->status.AsUINT32 ==
+                           OE_TCB_LEVEL_STATUS_UNKNOWN;
+         ++i)
+        _determine_platform_tcb_info_tcb_level(
+            platform_tcb_level, &tcb_levels[i]);
+
+    OE_CHECK(_check_platform_tcb_level(platform_tcb_level));
+
+    result = OE_OK;
 done:
     return result;
 }
@@ -975,15 +1288,10 @@ static oe_result_t _read_qe_tcb_level(
         OE_CHECK(_read('[', itr, end));
 
         tcb_level->advisory_ids_offset = (size_t)(*itr - info_json);
-        size_t size = 0;
-
-        while (*itr < end && **itr != ']')
-        {
-            (*itr)++;
-            size++;
-        }
+        OE_CHECK(_skip_to_array_end(itr, end));
+        tcb_level->advisory_ids_size =
+            (size_t)(*itr - info_json) - tcb_level->advisory_ids_offset;
         OE_CHECK(_read(']', itr, end));
-        tcb_level->advisory_ids_size = size;
     }
 
     OE_CHECK(_read('}', itr, end));
@@ -1133,14 +1441,11 @@ static oe_result_t _read_qe_identity_info_v2(
         OE_CHECK(_read_qe_tcb_level(
             info_json, itr, end, platform_tcb_level, &parsed_info->tcb_level));
 
-        // Optimization
+        // The levels are sorted, so the first matching level is the
+        // platform's level and the levels after it are skipped unparsed.
         if (platform_tcb_level->tcb_status.AsUINT32 !=
             OE_TCB_LEVEL_STATUS_UNKNOWN)
-        {
-            // Found matching TCB level, go to the end of the array.
-            while (*itr < end && **itr != ']')
-                (*itr)++;
-        }
+            OE_CHECK(_skip_to_array_end(itr, end));
 
         // Read end of array or comma separator.
         if (*itr < end && **itr == ']')
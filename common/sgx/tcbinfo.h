@@ -116,6 +116,48 @@ oe_result_t oe_parse_tcb_info_json(
     oe_tcb_info_tcb_level_t* platform_tcb_level,
     oe_parsed_tcb_info_t* parsed_info);
 
+/**
+ * oe_parse_tcb_info_json_levels parses the given tcb info json string like
+ * oe_parse_tcb_info_json, but instead of determining the status of a single
+ * platform it returns all of the TCB levels, in the order of the json. The
+ * table can then be evaluated for any number of platforms with
+ * oe_evaluate_tcb_info_levels without parsing the json again.
+ *
+ * The tcb_level field of parsed_info is the last TCB level of the table.
+ *
+ * @param[in] tcb_info_json The json string to parse.
+ * @param[in] tcb_info_json_size The string length of info_json
+ * @param[out] parsed_info The parsed results.
+ * @param[out] tcb_levels The TCB levels. Must be freed with oe_free().
+ * @param[out] tcb_level_count The number of TCB levels.
+ */
+oe_result_t oe_parse_tcb_info_json_levels(
+    const uint8_t* tcb_info_json,
+    size_t tcb_info_json_size,
+    oe_parsed_tcb_info_t* parsed_info,
+    oe_tcb_info_tcb_level_t** tcb_levels,
+    size_t* tcb_level_count);
+
+/**
+ * oe_evaluate_tcb_info_levels determines the status of the platform_tcb_level
+ * from a table returned by oe_parse_tcb_info_json_levels, using the same
+ * algorithm as oe_parse_tcb_info_json. The table is walked once and the walk
+ * stops at the first matching level.
+ *
+ * If the plaform's tcb level status was determined to be not uptodate,
+ * then OE_TCB_LEVEL_INVALID is returned.
+ *
+ * @param[in] tcb_levels The TCB levels.
+ * @param[in] tcb_level_count The number of TCB levels.
+ * @param[in,out] platform_tcb_level The platform tcb level.
+ *                The sgx_tcb_comp_svn and pce_svn fields are required to be
+ * set. The status field is updated as output.
+ */
+oe_result_t oe_evaluate_tcb_info_levels(
+    const oe_tcb_info_tcb_level_t* tcb_levels,
+    size_t tcb_level_count,
+    oe_tcb_info_tcb_level_t* platform_tcb_level);
+
 oe_result_t oe_verify_ecdsa256_signature(
     const uint8_t* tcb_info_start,
     size_t tcb_info_size,
@@ -6,16 +6,140 @@
 #include <openenclave/bits/safemath.h>
 #include <openenclave/internal/calls.h>
 #include <openenclave/internal/cert.h>
+#include <openenclave/internal/datetime.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/report.h>
 #include <openenclave/internal/utils.h>
 #include "../common/common.h"
+#include "collateral.h"
+#include "endorsements.h"
 #include "quote.h"
 
 #define KEY_BUFF_SIZE 2048
 
 static const char* oid_oe_report = X509_OID_FOR_QUOTE_STRING;
 
+/* Seconds for which verified certificates are cached (0 disables caching). */
+static uint32_t _cache_ttl;
+
+/* A certificate accepted by oe_verify_attestation_certificate() and the report
+ * parsed from it, which points into the copy of the report that follows. */
+typedef struct _attestation_cert_collateral
+{
+    oe_sgx_collateral_t base;
+    oe_report_t parsed_report;
+    size_t report_size;
+    uint8_t report[];
+} attestation_cert_collateral_t;
+
+static void _free_attestation_cert_collateral(oe_sgx_collateral_t* collateral)
+{
+    oe_free(collateral);
+}
+
+oe_result_t oe_set_attestation_certificate_cache_ttl(uint32_t ttl_seconds)
+{
+    _cache_ttl = ttl_seconds;
+
+    // Entries were added with the previous TTL.
+    oe_sgx_clear_collateral_cache_kind(OE_SGX_COLLATERAL_ATTESTATION_CERT);
+    return OE_OK;
+}
+
+/* Get the time at which the quote in the report needs newer collateral. */
+static oe_result_t _get_collateral_expiry(
+    const uint8_t* report,
+    size_t report_size,
+    oe_datetime_t* expiry)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    const oe_report_header_t* header = (const oe_report_header_t*)report;
+    uint8_t* endorsements = NULL;
+    size_t endorsements_size = 0;
+    oe_sgx_endorsements_t sgx_endorsements;
+    oe_datetime_t from;
+
+    if (report_size < sizeof(*header) ||
+        report_size - sizeof(*header) < header->report_size ||
+        header->report_type != OE_REPORT_TYPE_SGX_REMOTE)
+        OE_RAISE(OE_UNSUPPORTED);
+
+    // The endorsements and their parsed form come from the collateral cache
+    // filled by the verification of the same quote.
+    OE_CHECK(oe_get_sgx_endorsements(
+        header->report,
+        header->report_size,
+        &endorsements,
+        &endorsements_size));
+    OE_CHECK(oe_parse_sgx_endorsements(
+        (oe_endorsements_t*)endorsements,
+        endorsements_size,
+        &sgx_endorsements));
+    OE_CHECK(oe_get_sgx_quote_validity(
+        header->report,
+        header->report_size,
+        &sgx_endorsements,
+        &from,
+        expiry));
+
+    result = OE_OK;
+
+done:
+    oe_free_sgx_endorsements(endorsements);
+    return result;
+}
+
+static void _cache_attestation_cert(
+    uint32_t ttl,
+    const OE_SHA256* key,
+    oe_cert_t* cert,
+    const uint8_t* report,
+    size_t report_size)
+{
+    attestation_cert_collateral_t* collateral = NULL;
+    oe_datetime_t expiry;
+    oe_datetime_t from;
+    oe_datetime_t until;
+    size_t size;
+
+    if (oe_datetime_from_now(ttl, &expiry) != OE_OK)
+        return;
+
+    if (oe_cert_get_validity_dates(cert, &from, &until) != OE_OK)
+        return;
+    if (oe_datetime_compare(&until, &expiry) < 0)
+        expiry = until;
+
+    if (_get_collateral_expiry(report, report_size, &until) != OE_OK)
+        return;
+    if (oe_datetime_compare(&until, &expiry) < 0)
+        expiry = until;
+
+    if (oe_safe_add_sizet(
+            sizeof(attestation_cert_collateral_t), report_size, &size) != OE_OK)
+        return;
+
+    if (!(collateral = (attestation_cert_collateral_t*)oe_malloc(size)))
+        return;
+
+    oe_sgx_collateral_init(
+        &collateral->base,
+        OE_SGX_COLLATERAL_ATTESTATION_CERT,
+        key,
+        _free_attestation_cert_collateral);
+    collateral->base.expiry = expiry;
+    collateral->report_size = report_size;
+    memcpy(collateral->report, report, report_size);
+
+    if (oe_parse_report(
+            collateral->report,
+            collateral->report_size,
+            &collateral->parsed_report) == OE_OK)
+        oe_sgx_collateral_cache_insert(&collateral->base);
+
+    oe_sgx_collateral_release(&collateral->base);
+}
+
 // verify report user data against peer certificate
 static oe_result_t verify_report_user_data(
     uint8_t* key_buff,
@@ -89,6 +213,33 @@ oe_result_t oe_verify_attestation_certificate(
     uint8_t* pub_key_buf = NULL;
     size_t pub_key_buf_size = KEY_BUFF_SIZE;
     oe_report_t parsed_report = {0};
+    oe_sha256_context_t sha256_ctx = {0};
+    OE_SHA256 key;
+    attestation_cert_collateral_t* collateral = NULL;
+    uint32_t ttl = _cache_ttl;
+
+    // Skip the verification of certificates accepted within the cache TTL.
+    if (ttl)
+    {
+        if (!cert_in_der)
+            OE_RAISE(OE_INVALID_PARAMETER);
+
+        OE_CHECK(oe_sha256_init(&sha256_ctx));
+        OE_CHECK(oe_sha256_update(&sha256_ctx, cert_in_der, cert_in_der_len));
+        OE_CHECK(oe_sha256_final(&sha256_ctx, &key));
+
+        collateral =
+            (attestation_cert_collateral_t*)oe_sgx_collateral_cache_find(
+                OE_SGX_COLLATERAL_ATTESTATION_CERT, &key);
+
+        if (collateral)
+        {
+            OE_TRACE_VERBOSE("Using cached certificate verification");
+            parsed_report = collateral->parsed_report;
+            result = OE_OK;
+            goto verify_identity;
+        }
+    }
 
     pub_key_buf = (uint8_t*)oe_malloc(KEY_BUFF_SIZE);
     if (!pub_key_buf)
@@ -149,6 +300,11 @@ oe_result_t oe_verify_attestation_certificate(
     OE_CHECK(result);
     OE_TRACE_VERBOSE("user data: hash(public key) validation passed", NULL);
 
+    if (ttl)
+        _cache_attestation_cert(ttl, &key, &cert, report, report_size);
+
+verify_identity:
+
     //---------------------------------------
     // call client to check enclave identity
     // --------------------------------------
@@ -167,6 +323,8 @@ oe_result_t oe_verify_attestation_certificate(
     }
 
 done:
+    if (collateral)
+        oe_sgx_collateral_release(&collateral->base);
     oe_free(pub_key_buf);
     oe_cert_free(&cert);
     oe_free(report);
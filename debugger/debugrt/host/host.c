@@ -6,6 +6,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__linux__)
+#include "perfmap.h"
+#endif
+
 /**
  * In Windows, debugrt is built as a separate DLL that
  * OE host applications call into. Hence, this module cannot
@@ -184,6 +188,10 @@ oe_result_t oe_debug_notify_enclave_created(oe_debug_enclave_t* enclave)
 {
     oe_result_t result = OE_UNEXPECTED;
     bool locked = false;
+#if defined(__linux__)
+    char* path = NULL;
+    uint64_t base_address = 0;
+#endif
 
     if (enclave == NULL || enclave->magic != OE_DEBUG_ENCLAVE_MAGIC)
     {
@@ -200,12 +208,28 @@ oe_result_t oe_debug_notify_enclave_created(oe_debug_enclave_t* enclave)
 
     result = OE_OK;
 
+#if defined(__linux__)
+    // The perf map is written once the lock is released, since every ECALL
+    // into a debug enclave takes it.
+    if (enclave->path)
+        path = strdup(enclave->path);
+    base_address = (uint64_t)enclave->base_address;
+#endif
+
     oe_notify_debugger_enclave_creation(enclave);
 
 done:
     if (locked)
         spin_unlock();
 
+#if defined(__linux__)
+    if (path)
+    {
+        oe_perf_map_add_enclave(path, base_address);
+        free(path);
+    }
+#endif
+
     return result;
 }
 
@@ -213,6 +237,10 @@ oe_result_t oe_debug_notify_enclave_terminated(oe_debug_enclave_t* enclave)
 {
     oe_result_t result = OE_UNEXPECTED;
     bool locked = false;
+#if defined(__linux__)
+    uint64_t base_address = 0;
+    uint64_t size = 0;
+#endif
 
     if (enclave == NULL || enclave->magic != OE_DEBUG_ENCLAVE_MAGIC)
     {
@@ -242,12 +270,22 @@ oe_result_t oe_debug_notify_enclave_terminated(oe_debug_enclave_t* enclave)
     enclave->next = NULL;
     result = OE_OK;
 
+#if defined(__linux__)
+    base_address = (uint64_t)enclave->base_address;
+    size = (uint64_t)enclave->size;
+#endif
+
     oe_notify_debugger_enclave_termination(enclave);
 
 done:
     if (locked)
         spin_unlock();
 
+#if defined(__linux__)
+    if (result == OE_OK)
+        oe_perf_map_remove_enclave(base_address, size);
+#endif
+
     return result;
 }
 
@@ -0,0 +1,276 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include "perfmap.h"
+#include <elf.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+**==============================================================================
+**
+** perf map files:
+**
+**     When OE_PERF_MAP is set in the environment, the functions of each debug
+**     enclave are written to /tmp/perf-<pid>.map at their load address, one
+**     line per function:
+**
+**         <start> <size> <name>
+**
+**     in hexadecimal. perf reads this file for the addresses that are not in
+**     a file mapped by the dynamic loader, which is the case of the enclave
+**     image. The lines of an enclave are removed when it is terminated, and
+**     the file is removed with the last of them, unless OE_PERF_MAP is set to
+**     "keep", so that perf report can still read them after the process
+**     exits.
+**
+**==============================================================================
+*/
+
+#define PERF_MAP_PATH_SIZE 64
+
+/* Serializes the updates of the file by the threads of the process. */
+static pthread_mutex_t _mutex = PTHREAD_MUTEX_INITIALIZER;
+
+typedef enum _perf_map_mode
+{
+    PERF_MAP_OFF,
+    PERF_MAP_ON,
+    PERF_MAP_KEEP
+} perf_map_mode_t;
+
+static perf_map_mode_t _get_mode(void)
+{
+    const char* value = getenv("OE_PERF_MAP");
+
+    if (!value || !*value || strcmp(value, "0") == 0)
+        return PERF_MAP_OFF;
+
+    if (strcmp(value, "keep") == 0)
+        return PERF_MAP_KEEP;
+
+    return PERF_MAP_ON;
+}
+
+static void _get_path(char path[PERF_MAP_PATH_SIZE])
+{
+    snprintf(path, PERF_MAP_PATH_SIZE, "/tmp/perf-%d.map", (int)getpid());
+}
+
+/* Open the map file as a stream. The file is in a world-writable directory,
+ * so a symbolic link planted in its place is not followed. */
+static FILE* _open_map(const char* path, int flags, const char* mode)
+{
+    int fd;
+    FILE* stream;
+
+    if ((fd = open(path, flags | O_NOFOLLOW | O_CLOEXEC, 0600)) < 0)
+        return NULL;
+
+    if (!(stream = fdopen(fd, mode)))
+        close(fd);
+
+    return stream;
+}
+
+/* Write the defined functions of the symbol table of an ELF image. */
+static int _write_functions(
+    FILE* stream,
+    const uint8_t* image,
+    size_t image_size,
+    uint64_t base_address)
+{
+    const Elf64_Ehdr* ehdr = (const Elf64_Ehdr*)image;
+    const Elf64_Shdr* shdrs;
+
+    if (image_size < sizeof(Elf64_Ehdr) ||
+        memcmp(ehdr->e_ident, ELFMAG, SELFMAG) != 0 ||
+        ehdr->e_ident[EI_CLASS] != ELFCLASS64 ||
+        ehdr->e_shentsize != sizeof(Elf64_Shdr) ||
+        ehdr->e_shoff > image_size ||
+        ehdr->e_shnum > (image_size - ehdr->e_shoff) / sizeof(Elf64_Shdr))
+        return -1;
+
+    shdrs = (const Elf64_Shdr*)(image + ehdr->e_shoff);
+
+    for (size_t i = 0; i < ehdr->e_shnum; i++)
+    {
+        const Elf64_Shdr* symtab = &shdrs[i];
+        const Elf64_Shdr* strtab;
+        const Elf64_Sym* syms;
+        const char* strings;
+
+        /* The full symbol table also has the static functions. */
+        if (symtab->sh_type != SHT_SYMTAB || symtab->sh_link >= ehdr->e_shnum)
+            continue;
+
+        strtab = &shdrs[symtab->sh_link];
+
+        if (symtab->sh_entsize != sizeof(Elf64_Sym) ||
+            symtab->sh_offset > image_size ||
+            symtab->sh_size > image_size - symtab->sh_offset ||
+            strtab->sh_offset > image_size ||
+            strtab->sh_size > image_size - strtab->sh_offset ||
+            strtab->sh_size == 0)
+            return -1;
+
+        syms = (const Elf64_Sym*)(image + symtab->sh_offset);
+        strings = (const char*)(image + strtab->sh_offset);
+
+        for (size_t j = 0; j < symtab->sh_size / sizeof(Elf64_Sym); j++)
+        {
+            const Elf64_Sym* sym = &syms[j];
+            size_t max_length;
+
+            if (ELF64_ST_TYPE(sym->st_info) != STT_FUNC ||
+                sym->st_shndx == SHN_UNDEF || sym->st_size == 0 ||
+                sym->st_name >= strtab->sh_size)
+                continue;
+
+            /* The name must end within the string table. */
+            max_length = strtab->sh_size - sym->st_name;
+            if (strnlen(strings + sym->st_name, max_length) == max_length)
+                continue;
+
+            fprintf(
+                stream,
+                "%lx %lx %s\n",
+                (unsigned long)(base_address + sym->st_value),
+                (unsigned long)sym->st_size,
+                strings + sym->st_name);
+        }
+    }
+
+    return 0;
+}
+
+void oe_perf_map_add_enclave(const char* image_path, uint64_t base_address)
+{
+    char path[PERF_MAP_PATH_SIZE];
+    int fd = -1;
+    struct stat st;
+    void* image = MAP_FAILED;
+    FILE* stream = NULL;
+
+    if (!image_path || _get_mode() == PERF_MAP_OFF)
+        return;
+
+    if ((fd = open(image_path, O_RDONLY | O_CLOEXEC)) < 0 ||
+        fstat(fd, &st) != 0 || st.st_size <= 0)
+        goto done;
+
+    image = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (image == MAP_FAILED)
+        goto done;
+
+    _get_path(path);
+
+    pthread_mutex_lock(&_mutex);
+
+    if ((stream = _open_map(path, O_WRONLY | O_APPEND | O_CREAT, "a")))
+    {
+        _write_functions(
+            stream, (const uint8_t*)image, (size_t)st.st_size, base_address);
+        fclose(stream);
+    }
+
+    pthread_mutex_unlock(&_mutex);
+
+done:
+    if (image != MAP_FAILED)
+        munmap(image, (size_t)st.st_size);
+
+    if (fd >= 0)
+        close(fd);
+}
+
+void oe_perf_map_remove_enclave(uint64_t base_address, uint64_t size)
+{
+    char path[PERF_MAP_PATH_SIZE];
+    char tmp_path[PERF_MAP_PATH_SIZE + 8];
+    int tmp_fd;
+    FILE* in = NULL;
+    FILE* out = NULL;
+    char* line = NULL;
+    size_t line_size = 0;
+    size_t num_lines = 0;
+    const uint64_t start = base_address;
+    const uint64_t end = start + size;
+
+    if (_get_mode() != PERF_MAP_ON)
+        return;
+
+    _get_path(path);
+    snprintf(tmp_path, sizeof(tmp_path), "%s.XXXXXX", path);
+
+    pthread_mutex_lock(&_mutex);
+
+    if (!(in = _open_map(path, O_RDONLY, "r")))
+        goto done;
+
+    /* Create a new file under a unique name, which cannot be a planted link,
+     * and rename it over the map file once it is written. */
+    if ((tmp_fd = mkstemp(tmp_path)) < 0)
+        goto done;
+
+    if (!(out = fdopen(tmp_fd, "w")))
+    {
+        close(tmp_fd);
+        remove(tmp_path);
+        goto done;
+    }
+
+    /* Keep the lines of the other enclaves and of other producers. */
+    while (getline(&line, &line_size, in) > 0)
+    {
+        char* p = NULL;
+        uint64_t address = strtoull(line, &p, 16);
+
+        if (p != line && address >= start && address < end)
+            continue;
+
+        fputs(line, out);
+        num_lines++;
+    }
+
+    fclose(in);
+    in = NULL;
+
+    if (fclose(out) != 0)
+    {
+        out = NULL;
+        remove(tmp_path);
+        goto done;
+    }
+
+    out = NULL;
+
+    if (num_lines)
+    {
+        rename(tmp_path, path);
+    }
+    else
+    {
+        remove(tmp_path);
+        remove(path);
+    }
+
+done:
+    if (out)
+    {
+        fclose(out);
+        remove(tmp_path);
+    }
+
+    if (in)
+        fclose(in);
+
+    pthread_mutex_unlock(&_mutex);
+    free(line);
+}
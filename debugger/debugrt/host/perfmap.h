@@ -0,0 +1,27 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_DEBUGRT_PERFMAP_H
+#define _OE_DEBUGRT_PERFMAP_H
+
+#include <openenclave/internal/debugrt/host.h>
+
+OE_EXTERNC_BEGIN
+
+/**
+ * Write the functions of an enclave to the perf map file of the process, if
+ * enabled by the OE_PERF_MAP environment variable. The file is read and
+ * written under a lock of its own, so this must not be called with the lock
+ * of the debugger lists held.
+ */
+void oe_perf_map_add_enclave(const char* path, uint64_t base_address);
+
+/**
+ * Remove the functions of an enclave from the perf map file of the process.
+ * The same locking rule as for oe_perf_map_add_enclave() applies.
+ */
+void oe_perf_map_remove_enclave(uint64_t base_address, uint64_t size);
+
+OE_EXTERNC_END
+
+#endif // _OE_DEBUGRT_PERFMAP_H
@@ -0,0 +1,144 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/bits/safemath.h>
+#include <openenclave/corelibc/stdlib.h>
+#include <openenclave/corelibc/string.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/channel.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/thread.h>
+
+/* The channels opened by the enclave. A region of host memory belongs to at
+ * most one of them. */
+static oe_channel_t* _channels;
+static oe_spinlock_t _channels_lock = OE_SPINLOCK_INITIALIZER;
+
+static bool _overlaps(const oe_channel_t* channel, uint8_t* region, size_t size)
+{
+    return region < channel->region + channel->region_size &&
+           channel->region < region + size;
+}
+
+oe_result_t oe_channel_open(
+    const oe_channel_descriptor_t* descriptor,
+    oe_channel_t** channel_out)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_channel_descriptor_t desc;
+    oe_channel_t* channel = NULL;
+    bool locked = false;
+
+    if (channel_out)
+        *channel_out = NULL;
+
+    if (!descriptor || !channel_out)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* Copy the descriptor to enclave memory to avoid TOCTOU issues. */
+    desc = *descriptor;
+
+    /* The whole region, rings and data area, must be in host memory. */
+    if (!oe_is_outside_enclave(desc.region, desc.region_size))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (!(channel = oe_calloc(1, sizeof(*channel))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    OE_CHECK(oe_channel_init(
+        channel, desc.region, desc.region_size, desc.num_slots, false));
+
+    oe_spin_lock(&_channels_lock);
+    locked = true;
+
+    for (const oe_channel_t* p = _channels; p; p = p->next)
+    {
+        if (_overlaps(p, channel->region, channel->region_size))
+            OE_RAISE(OE_ALREADY_EXISTS);
+    }
+
+    channel->next = _channels;
+    _channels = channel;
+
+    *channel_out = channel;
+    channel = NULL;
+    result = OE_OK;
+
+done:
+    if (locked)
+        oe_spin_unlock(&_channels_lock);
+
+    oe_free(channel);
+    return result;
+}
+
+oe_result_t oe_channel_close(oe_channel_t* channel)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    bool found = false;
+
+    if (!channel)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    oe_spin_lock(&_channels_lock);
+
+    for (oe_channel_t** p = &_channels; *p; p = &(*p)->next)
+    {
+        if (*p == channel)
+        {
+            *p = channel->next;
+            found = true;
+            break;
+        }
+    }
+
+    oe_spin_unlock(&_channels_lock);
+
+    if (!found)
+        OE_RAISE(OE_NOT_FOUND);
+
+    channel->magic = 0;
+    oe_free(channel);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_channel_snapshot(
+    oe_channel_t* channel,
+    const oe_channel_message_t* message,
+    size_t offset,
+    void* buffer,
+    size_t size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint64_t end = 0;
+
+    if (!channel || channel->magic != OE_CHANNEL_MAGIC || !message)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (!buffer && size)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* The slice must be within the data of the message, and the data of the
+     * message within the data area. */
+    OE_CHECK(oe_safe_add_u64(offset, size, &end));
+
+    if (end > message->size ||
+        !oe_channel_is_within_data(channel, message->offset, message->size))
+        OE_RAISE(OE_OUT_OF_BOUNDS);
+
+    if (size && !oe_is_within_enclave(buffer, size))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* Read the slice once. The enclave only uses the copy, so the host
+     * cannot change the data after it has been checked. */
+    memcpy(buffer, channel->data + message->offset + offset, size);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
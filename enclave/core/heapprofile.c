@@ -0,0 +1,695 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/corelibc/stdarg.h>
+#include <openenclave/corelibc/stdio.h>
+#include <openenclave/corelibc/stdlib.h>
+#include <openenclave/corelibc/string.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/atomic.h>
+#include <openenclave/internal/backtrace.h>
+#include <openenclave/internal/heapprofile.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/thread.h>
+#include <openenclave/internal/types.h>
+#include <openenclave/internal/utils.h>
+
+/*
+**==============================================================================
+**
+** Sampling heap profiler:
+**
+**     Each thread counts down the bytes that it allocates, samples the
+**     allocation that reaches zero, and draws the next count uniformly
+**     between 1 and twice the sampling interval. An allocation of S bytes is
+**     thus sampled with a probability of about min(1, S / interval), and its
+**     sample stands for max(1, interval / S) allocations and max(S, interval)
+**     bytes.
+**
+**     A sample holds the backtrace of the allocation. Each thread writes its
+**     samples to its own buffers, so sampling takes no lock, and adds a buffer
+**     when all of its samples are live. The live samples are also kept in an
+**     index keyed by the address of their block, from which the thread that
+**     frees the block removes its sample with a compare-and-swap. The samples
+**     that cannot be recorded are counted in the profile.
+**
+**     The profiler allocates its own memory with dlmalloc(), so that it is
+**     neither sampled nor tracked by debug malloc.
+**
+**==============================================================================
+*/
+
+extern void* dlmalloc(size_t size);
+extern void* dlcalloc(size_t nmemb, size_t size);
+extern void* dlrealloc(void* ptr, size_t size);
+extern void dlfree(void* ptr);
+
+/* The number of slots of the index that a block may be stored in. */
+#define INDEX_PROBES 8
+
+/* The value of a slot of the index whose sample was removed. */
+#define REMOVED ((void*)1)
+
+typedef struct _sample
+{
+    /* The sampled block, or NULL if the sample is free. */
+    void* volatile ptr;
+
+    /* The number of allocations and bytes that the sample stands for. */
+    uint64_t count;
+    uint64_t bytes;
+
+    /* Return addresses obtained by oe_backtrace_frames() */
+    void* addrs[OE_BACKTRACE_MAX];
+    uint64_t num_addrs;
+} sample_t;
+
+typedef struct _sample_buffer
+{
+    /* The buffers are kept on a list that is only ever pushed to. */
+    struct _sample_buffer* next;
+
+    /* The previous buffer of the same thread. */
+    struct _sample_buffer* older;
+
+    /* The thread that owns the buffer, the only one to take its samples. */
+    oe_thread_t thread;
+
+    /* Where the owner looks for a free sample first. */
+    uint64_t cursor;
+
+    sample_t samples[OE_HEAP_PROFILE_SAMPLES_PER_THREAD];
+} sample_buffer_t;
+
+/* The mean number of bytes allocated between two samples, or zero if heap
+ * profiling is stopped. */
+static volatile uint64_t _interval;
+
+static sample_buffer_t* volatile _buffers;
+
+/* Each slot of the index holds NULL if it was never used, REMOVED, or a live
+ * sample. A slot never goes back to NULL, so a lookup stops at NULL. */
+static void* volatile* _index;
+static volatile uint64_t _num_live;
+
+/* The samples that were dropped for lack of memory or of a slot. */
+static volatile uint64_t _num_dropped;
+
+static volatile uint64_t _seed;
+static oe_spinlock_t _lock = OE_SPINLOCK_INITIALIZER;
+
+/* The thread-local state is cleared when the thread leaves the enclave, and
+ * is set up again by the next allocation. */
+static __thread sample_buffer_t* _buffer;
+static __thread uint64_t _bytes_left;
+static __thread uint64_t _random;
+
+static uint64_t _next_random(void)
+{
+    if (_random == 0)
+    {
+        uint64_t seed = oe_atomic_increment(&_seed) * 0x9e3779b97f4a7c15;
+        _random = (seed ^ oe_thread_self()) | 1;
+    }
+
+    /* xorshift64* */
+    _random ^= _random >> 12;
+    _random ^= _random << 25;
+    _random ^= _random >> 27;
+
+    return _random * 0x2545f4914f6cdd1d;
+}
+
+static uint64_t _next_bytes_left(uint64_t interval)
+{
+    return 1 + _next_random() % (2 * interval - 1);
+}
+
+OE_INLINE uint64_t _hash(const void* ptr)
+{
+    return ((uint64_t)ptr * 0x9e3779b97f4a7c15) >> 32;
+}
+
+static sample_buffer_t* _new_buffer(oe_thread_t self, sample_buffer_t* older)
+{
+    sample_buffer_t* buffer;
+
+    if (!(buffer = dlcalloc(1, sizeof(sample_buffer_t))))
+        return NULL;
+
+    buffer->thread = self;
+    buffer->older = older;
+
+    do
+    {
+        buffer->next = _buffers;
+    } while (!oe_atomic_compare_and_swap_ptr(
+        (void* volatile*)&_buffers, buffer->next, buffer));
+
+    return _buffer = buffer;
+}
+
+/* Get the newest buffer of the calling thread. */
+static sample_buffer_t* _get_buffer(void)
+{
+    oe_thread_t self;
+    sample_buffer_t* buffer;
+
+    if (_buffer)
+        return _buffer;
+
+    /* The buffers of the thread survive its thread-local state. Buffers are
+     * pushed to the front of the list, so the newest one is found first. */
+    self = oe_thread_self();
+
+    for (buffer = _buffers; buffer; buffer = buffer->next)
+    {
+        if (oe_thread_equal(buffer->thread, self))
+            return _buffer = buffer;
+    }
+
+    return _new_buffer(self, NULL);
+}
+
+/* Take a free sample of the calling thread, adding a buffer if they are all
+ * live. */
+static sample_t* _take_sample(void)
+{
+    sample_buffer_t* newest;
+
+    if (!(newest = _get_buffer()))
+        return NULL;
+
+    for (sample_buffer_t* buffer = newest; buffer; buffer = buffer->older)
+    {
+        for (size_t i = 0; i < OE_HEAP_PROFILE_SAMPLES_PER_THREAD; i++)
+        {
+            size_t n =
+                (buffer->cursor + i) % OE_HEAP_PROFILE_SAMPLES_PER_THREAD;
+
+            if (!buffer->samples[n].ptr)
+            {
+                buffer->cursor = n + 1;
+                return &buffer->samples[n];
+            }
+        }
+    }
+
+    if (!(newest = _new_buffer(newest->thread, newest)))
+        return NULL;
+
+    newest->cursor = 1;
+    return &newest->samples[0];
+}
+
+static bool _insert(sample_t* sample)
+{
+    uint64_t slot = _hash(sample->ptr) & (OE_HEAP_PROFILE_INDEX_SIZE - 1);
+
+    for (size_t i = 0; i < INDEX_PROBES; i++)
+    {
+        void* entry = _index[slot];
+
+        if ((entry == NULL || entry == REMOVED) &&
+            oe_atomic_compare_and_swap_ptr(&_index[slot], entry, sample))
+        {
+            oe_atomic_increment(&_num_live);
+            return true;
+        }
+
+        slot = (slot + 1) & (OE_HEAP_PROFILE_INDEX_SIZE - 1);
+    }
+
+    return false;
+}
+
+/* Remove the sample of a block from the index, and return it. Its owner
+ * cannot take it again until it is released. */
+static sample_t* _detach(void* ptr)
+{
+    uint64_t slot = _hash(ptr) & (OE_HEAP_PROFILE_INDEX_SIZE - 1);
+
+    for (size_t i = 0; i < INDEX_PROBES; i++)
+    {
+        void* entry = _index[slot];
+
+        if (entry == NULL)
+            return NULL;
+
+        /* The sample of a block stays in the index until the block is freed,
+         * so it cannot be removed by another thread meanwhile. */
+        if (entry != REMOVED && ((sample_t*)entry)->ptr == ptr)
+        {
+            if (!oe_atomic_compare_and_swap_ptr(&_index[slot], entry, REMOVED))
+                return NULL;
+
+            oe_atomic_decrement(&_num_live);
+            return (sample_t*)entry;
+        }
+
+        slot = (slot + 1) & (OE_HEAP_PROFILE_INDEX_SIZE - 1);
+    }
+
+    return NULL;
+}
+
+/* Let the owner of a detached sample take it again. */
+static void _release(sample_t* sample)
+{
+    OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+    sample->ptr = NULL;
+}
+
+void oe_heap_profile_malloc(void* ptr, size_t size)
+{
+    uint64_t interval = _interval;
+    sample_t* sample;
+
+    if (!interval || !ptr)
+        return;
+
+    if (_bytes_left == 0)
+        _bytes_left = _next_bytes_left(interval);
+
+    if (size < _bytes_left)
+    {
+        _bytes_left -= size;
+        return;
+    }
+
+    _bytes_left = _next_bytes_left(interval);
+
+    if (!(sample = _take_sample()))
+    {
+        oe_atomic_increment(&_num_dropped);
+        return;
+    }
+
+    if (size >= interval)
+    {
+        sample->count = 1;
+        sample->bytes = size;
+    }
+    else
+    {
+        sample->count = interval / size;
+        sample->bytes = interval;
+    }
+
+    sample->num_addrs =
+        (uint64_t)oe_backtrace_frames(sample->addrs, OE_BACKTRACE_MAX);
+
+    /* Publish the sample after it is written. The block is not freed before
+     * the allocator returns it, so the sample cannot be removed before it is
+     * indexed. */
+    OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+    sample->ptr = ptr;
+
+    if (!_insert(sample))
+    {
+        sample->ptr = NULL;
+        oe_atomic_increment(&_num_dropped);
+    }
+}
+
+void oe_heap_profile_free(void* ptr)
+{
+    sample_t* sample;
+
+    if (!ptr || !_num_live)
+        return;
+
+    if ((sample = _detach(ptr)))
+        _release(sample);
+}
+
+void* oe_heap_profile_realloc_begin(void* ptr)
+{
+    if (!ptr || !_num_live)
+        return NULL;
+
+    return _detach(ptr);
+}
+
+void oe_heap_profile_realloc_end(void* handle, bool failed)
+{
+    sample_t* sample = (sample_t*)handle;
+
+    if (!sample)
+        return;
+
+    /* The block is still live if the reallocation failed. */
+    if (failed && _insert(sample))
+        return;
+
+    _release(sample);
+}
+
+oe_result_t oe_start_heap_profiling(size_t sample_interval)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (sample_interval == 0)
+        sample_interval = OE_HEAP_PROFILE_DEFAULT_INTERVAL;
+
+    if (sample_interval > OE_UINT32_MAX)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    oe_spin_lock(&_lock);
+
+    if (!_index)
+    {
+        void* volatile* index =
+            dlcalloc(OE_HEAP_PROFILE_INDEX_SIZE, sizeof(void*));
+
+        if (!index)
+        {
+            oe_spin_unlock(&_lock);
+            OE_RAISE(OE_OUT_OF_MEMORY);
+        }
+
+        _index = index;
+    }
+
+    /* Publish the index before the first sample. */
+    OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+    _interval = sample_interval;
+
+    oe_spin_unlock(&_lock);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_stop_heap_profiling(void)
+{
+    _interval = 0;
+    return OE_OK;
+}
+
+/*
+**==============================================================================
+**
+** oe_get_heap_profile()
+**
+**     Writes the live samples in the legacy text format of the heap profiles
+**     of gperftools, with the symbols of their addresses, as below. The
+**     counts are already scaled, so pprof reads them as they are.
+**
+**         --- symbol
+**         binary=enclave
+**         0x00007f3a12345678 function
+**         ---
+**         --- heap
+**         heap profile: <count>: <bytes> [<count>: <bytes>] @ heapprofile
+**         # <count> samples were dropped
+**         <count>: <bytes> [<count>: <bytes>] @ <address> <address> ...
+**
+**     The comment line is only written if samples were dropped.
+**
+**==============================================================================
+*/
+
+typedef struct _entry
+{
+    const sample_t* sample;
+    uint64_t count;
+    uint64_t bytes;
+} entry_t;
+
+typedef struct _text
+{
+    char* data;
+    size_t size;
+    size_t capacity;
+} text_t;
+
+static oe_result_t _append(text_t* text, const char* format, ...)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_va_list ap;
+    int n;
+
+    for (;;)
+    {
+        size_t available = text->capacity - text->size;
+
+        oe_va_start(ap, format);
+        n = oe_vsnprintf(text->data + text->size, available, format, ap);
+        oe_va_end(ap);
+
+        if (n < 0)
+            OE_RAISE(OE_FAILURE);
+
+        if ((size_t)n < available)
+            break;
+
+        {
+            size_t capacity = text->capacity * 2 + (size_t)n + 1;
+            char* data = dlrealloc(text->data, capacity);
+
+            if (!data)
+                OE_RAISE(OE_OUT_OF_MEMORY);
+
+            text->data = data;
+            text->capacity = capacity;
+        }
+    }
+
+    text->size += (size_t)n;
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+static size_t _table_size(size_t n)
+{
+    size_t size = 16;
+
+    while (size < 2 * n)
+        size *= 2;
+
+    return size;
+}
+
+static uint64_t _hash_stack(const sample_t* sample)
+{
+    uint64_t hash = 0xcbf29ce484222325;
+
+    for (uint64_t i = 0; i < sample->num_addrs; i++)
+        hash = (hash ^ (uint64_t)sample->addrs[i]) * 0x100000001b3;
+
+    return hash;
+}
+
+static bool _same_stack(const sample_t* a, const sample_t* b)
+{
+    return a->num_addrs == b->num_addrs &&
+           memcmp(a->addrs, b->addrs, a->num_addrs * sizeof(void*)) == 0;
+}
+
+/* Copy the live samples. The samples may be freed or taken again while they
+ * are copied, so a copy is kept only if its block has not changed. */
+static size_t _copy_samples(sample_t* samples, size_t max_samples)
+{
+    size_t n = 0;
+
+    for (sample_buffer_t* b = _buffers; b; b = b->next)
+    {
+        for (size_t i = 0; i < OE_HEAP_PROFILE_SAMPLES_PER_THREAD; i++)
+        {
+            const sample_t* sample = &b->samples[i];
+            void* ptr = sample->ptr;
+
+            if (!ptr || n == max_samples)
+                continue;
+
+            OE_ATOMIC_MEMORY_BARRIER_ACQUIRE();
+            samples[n] = *sample;
+            OE_ATOMIC_MEMORY_BARRIER_ACQUIRE();
+
+            if (sample->ptr == ptr && samples[n].num_addrs <= OE_BACKTRACE_MAX)
+                n++;
+        }
+    }
+
+    return n;
+}
+
+oe_result_t oe_get_heap_profile(char** profile, size_t* profile_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    size_t max_samples = 0;
+    sample_t* samples = NULL;
+    size_t num_samples;
+    entry_t* entries = NULL;
+    size_t entries_size = 0;
+    void** addrs = NULL;
+    size_t addrs_size = 0;
+    size_t num_addrs = 0;
+    char** symbols = NULL;
+    uint64_t total_count = 0;
+    uint64_t total_bytes = 0;
+    const uint64_t num_dropped = _num_dropped;
+    text_t text = {NULL, 0, 0};
+
+    if (profile)
+        *profile = NULL;
+
+    if (profile_size)
+        *profile_size = 0;
+
+    if (!profile || !profile_size)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    for (sample_buffer_t* b = _buffers; b; b = b->next)
+        max_samples += OE_HEAP_PROFILE_SAMPLES_PER_THREAD;
+
+    if (max_samples &&
+        !(samples = dlmalloc(max_samples * sizeof(sample_t))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    num_samples = _copy_samples(samples, max_samples);
+
+    /* Merge the samples with the same backtrace. */
+    entries_size = _table_size(num_samples);
+
+    if (!(entries = dlcalloc(entries_size, sizeof(entry_t))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    for (size_t i = 0; i < num_samples; i++)
+    {
+        const sample_t* sample = &samples[i];
+        size_t slot = _hash_stack(sample) & (entries_size - 1);
+
+        while (entries[slot].sample &&
+               !_same_stack(entries[slot].sample, sample))
+            slot = (slot + 1) & (entries_size - 1);
+
+        entries[slot].sample = sample;
+        entries[slot].count += sample->count;
+        entries[slot].bytes += sample->bytes;
+        total_count += sample->count;
+        total_bytes += sample->bytes;
+    }
+
+    /* Symbolize the distinct addresses with a single OCALL. */
+    for (size_t i = 0; i < num_samples; i++)
+        addrs_size += samples[i].num_addrs;
+
+    addrs_size = _table_size(addrs_size);
+
+    if (!(addrs = dlcalloc(addrs_size, sizeof(void*))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    for (size_t i = 0; i < num_samples; i++)
+    {
+        for (uint64_t j = 0; j < samples[i].num_addrs; j++)
+        {
+            void* addr = samples[i].addrs[j];
+            size_t slot = _hash(addr) & (addrs_size - 1);
+
+            while (addrs[slot] && addrs[slot] != addr)
+                slot = (slot + 1) & (addrs_size - 1);
+
+            if (!addrs[slot])
+            {
+                addrs[slot] = addr;
+                num_addrs++;
+            }
+        }
+    }
+
+    /* Pack the addresses at the start of the table. */
+    for (size_t i = 0, n = 0; i < addrs_size; i++)
+    {
+        if (addrs[i])
+            addrs[n++] = addrs[i];
+    }
+
+    /* The profile is still written without symbols if they are not
+     * available. */
+    if (num_addrs)
+        symbols = oe_backtrace_symbols(addrs, (int)num_addrs);
+
+    if (symbols)
+    {
+        OE_CHECK(_append(&text, "--- symbol\nbinary=enclave\n"));
+
+        for (size_t i = 0; i < num_addrs; i++)
+        {
+            OE_CHECK(_append(
+                &text,
+                "0x%016llx %s\n",
+                OE_LLX((uint64_t)addrs[i]),
+                symbols[i]));
+        }
+
+        OE_CHECK(_append(&text, "---\n--- heap\n"));
+    }
+
+    OE_CHECK(_append(
+        &text,
+        "heap profile: %llu: %llu [%llu: %llu] @ heapprofile\n",
+        OE_LLU(total_count),
+        OE_LLU(total_bytes),
+        OE_LLU(total_count),
+        OE_LLU(total_bytes)));
+
+    if (num_dropped)
+    {
+        OE_CHECK(_append(
+            &text, "# %llu samples were dropped\n", OE_LLU(num_dropped)));
+    }
+
+    for (size_t i = 0; i < entries_size; i++)
+    {
+        const entry_t* entry = &entries[i];
+
+        if (!entry->sample)
+            continue;
+
+        OE_CHECK(_append(
+            &text,
+            "%llu: %llu [%llu: %llu] @",
+            OE_LLU(entry->count),
+            OE_LLU(entry->bytes),
+            OE_LLU(entry->count),
+            OE_LLU(entry->bytes)));
+
+        for (uint64_t j = 0; j < entry->sample->num_addrs; j++)
+        {
+            OE_CHECK(_append(
+                &text,
+                " 0x%016llx",
+                OE_LLX((uint64_t)entry->sample->addrs[j])));
+        }
+
+        OE_CHECK(_append(&text, "\n"));
+    }
+
+    /* Return the profile in memory that the caller frees with oe_free(). */
+    if (!(*profile = oe_malloc(text.size + 1)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    memcpy(*profile, text.data, text.size);
+    (*profile)[text.size] = '\0';
+    *profile_size = text.size;
+
+    result = OE_OK;
+
+done:
+
+    if (symbols)
+        oe_backtrace_symbols_free(symbols);
+
+    dlfree(text.data);
+    dlfree(addrs);
+    dlfree(entries);
+    dlfree(samples);
+
+    return result;
+}
@@ -7,6 +7,7 @@
 #include <openenclave/enclave.h>
 #include <openenclave/internal/fault.h>
 #include <openenclave/internal/globals.h>
+#include <openenclave/internal/heapprofile.h>
 #include <openenclave/internal/malloc.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/thread.h>
@@ -80,16 +81,20 @@ void* oe_malloc(size_t size)
             _failure_callback(__FILE__, __LINE__, __FUNCTION__, size);
     }
 
+    oe_heap_profile_malloc(p, size);
+
     return p;
 }
 
 void oe_free(void* ptr)
 {
+    oe_heap_profile_free(ptr);
     FREE(ptr);
 }
 
 void oe_memalign_free(void* ptr)
 {
+    oe_heap_profile_free(ptr);
     FREE(ptr);
 }
 
@@ -105,12 +110,20 @@ void* oe_calloc(size_t nmemb, size_t size)
             _failure_callback(__FILE__, __LINE__, __FUNCTION__, nmemb * size);
     }
 
+    oe_heap_profile_malloc(p, nmemb * size);
+
     return p;
 }
 
 void* oe_realloc(void* ptr, size_t size)
 {
-    void* p = REALLOC(ptr, size);
+    void* p;
+
+    /* The block may be freed or moved by the reallocation, after which
+     * another thread may get it, so its sample is removed first. */
+    void* sample = oe_heap_profile_realloc_begin(ptr);
+    p = REALLOC(ptr, size);
+    oe_heap_profile_realloc_end(sample, !p && size);
 
     if (!p && size)
     {
@@ -120,6 +133,8 @@ void* oe_realloc(void* ptr, size_t size)
             _failure_callback(__FILE__, __LINE__, __FUNCTION__, size);
     }
 
+    oe_heap_profile_malloc(p, size);
+
     return p;
 }
 
@@ -135,6 +150,9 @@ int oe_posix_memalign(void** memptr, size_t alignment, size_t size)
             _failure_callback(__FILE__, __LINE__, __FUNCTION__, size);
     }
 
+    if (rc == 0)
+        oe_heap_profile_malloc(*memptr, size);
+
     return rc;
 }
 
@@ -150,6 +168,8 @@ void* oe_memalign(size_t alignment, size_t size)
             _failure_callback(__FILE__, __LINE__, __FUNCTION__, size);
     }
 
+    oe_heap_profile_malloc(p, size);
+
     return p;
 }
 
@@ -12,6 +12,14 @@ int oe_backtrace(void** buffer, int size)
     return 0;
 }
 
+int oe_backtrace_frames(void** buffer, int size)
+{
+    OE_UNUSED(buffer);
+    OE_UNUSED(size);
+
+    return 0;
+}
+
 char** oe_backtrace_symbols(void* const* buffer, int size)
 {
     OE_UNUSED(buffer);
@@ -0,0 +1,27 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+
+oe_result_t oe_cpuid(
+    uint32_t leaf,
+    uint32_t subleaf,
+    uint32_t* eax,
+    uint32_t* ebx,
+    uint32_t* ecx,
+    uint32_t* edx)
+{
+    OE_UNUSED(leaf);
+    OE_UNUSED(subleaf);
+    OE_UNUSED(eax);
+    OE_UNUSED(ebx);
+    OE_UNUSED(ecx);
+    OE_UNUSED(edx);
+
+    return OE_UNSUPPORTED;
+}
+
+uint64_t oe_rdtsc(void)
+{
+    return 0;
+}
@@ -380,8 +380,22 @@ oe_result_t oe_ocall(uint16_t func, uint64_t arg_in, uint64_t* arg_out)
     return result;
 }
 
+static void (*_abort_handler)(void);
+
+void oe_set_abort_handler(void (*handler)(void))
+{
+    _abort_handler = handler;
+}
+
 void oe_abort(void)
 {
+    /* Run the abort handler at most once (it may itself abort). */
+    void (*handler)(void) = _abort_handler;
+    _abort_handler = NULL;
+
+    if (handler)
+        handler();
+
     /* No return */
     TEE_Panic(TEE_ERROR_GENERIC);
 }
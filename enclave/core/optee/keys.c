@@ -40,3 +40,7 @@ oe_result_t oe_get_seal_key_v2(
 
     return OE_UNSUPPORTED;
 }
+
+void oe_clear_key_cache(void)
+{
+}
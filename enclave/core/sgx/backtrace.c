@@ -26,6 +26,51 @@ const void* _check_address(const void* ptr)
     return ptr;
 }
 
+/* Walk up the call-stack from the given frame.
+ *
+ * Upon entry to a function, rsp + 0 contains the return address.
+ * Generally, the first thing that a function does upong entry is
+ *     push %rbp
+ * rbp is expected to contain the callee's frame pointer.
+ * Thus after saving rbp,
+ *     rsp + 0  (frame[0]) contains callee's frame pointer.
+ *     rsp + 8  (frame[1]) contains return address (within the callee).
+ *
+ * However, the compiler may not always store the callee's frame-ptr in the
+ * rbp register. Within optimizations enabled, the compiler could use rbp
+ * just like other general-purpose register and hold some value rather than
+ * the frame-pointer. While frame[1] always contains the return address,
+ * frame[0] may not always contain the pointer to callee's stack frame.
+ * To be on the safer-side, we always check that the values we access
+ * while traversing the stack always lie within the enclave.
+ */
+static int _walk_frames(void** frame, void** buffer, int size)
+{
+    int n = 0;
+    while (n < size)
+    {
+        // Ensure that the current frame is safe to access.
+        if (!_check_address(frame))
+            break;
+
+        // Ensure that the return address is valid.
+        if (!_check_address(frame[1]))
+            break;
+
+        // Store address and move to previous frame.
+        buffer[n++] = frame[1];
+
+        // The stack grows down, so the frame of the caller is above. This
+        // stops the walk at most values of rbp that are not frame pointers.
+        if ((void**)*frame <= frame)
+            break;
+
+        frame = (void**)*frame;
+    }
+
+    return n;
+}
+
 /* Safe implementation of oe_backtrace.
  *
  * The original implementation used the ___builtin_return_address intrinsic.
@@ -51,43 +96,19 @@ int oe_backtrace(void** buffer, int size)
                  : /* no clobbers */
     );
 
-    // Upon entry to a function, rsp + 0 contains the return address.
-    // Generally, the first thing that a function does upong entry is
-    //     push %rbp
-    // rbp is expected to contain the callee's frame pointer.
-    // Thus after saving rbp,
-    //     rsp + 0  (frame[0]) contains callee's frame pointer.
-    //     rsp + 8  (frame[1]) contains return address (within the callee).
-    //
-    // However, the compiler may not always store the callee's frame-ptr in the
-    // rbp register. Within optimizations enabled, the compiler could use rbp
-    // just like other general-purpose register and hold some value rather than
-    // the frame-pointer. While frame[1] always contains the return address,
-    // frame[0] may not always contain the pointer to callee's stack frame.
-    // To be on the safer-side, we always check that the values we access
-    // while traversing the stack always lie within the enclave.
-    int n = 0;
-    while (n < size)
-    {
-        // Ensure that the current frame is safe to access.
-        if (!_check_address(frame))
-            break;
-
-        // Ensure that the return address is valid.
-        if (!_check_address(frame[1]))
-            break;
-
-        // Store address and move to previous frame.
-        buffer[n++] = frame[1];
-        frame = (void**)*frame;
-    }
-
-    return n;
+    return _walk_frames(frame, buffer, size);
 #else
     return 0;
 #endif
 }
 
+OE_NEVER_INLINE int oe_backtrace_frames(void** buffer, int size)
+{
+    // __builtin_frame_address() makes the compiler keep the frame-pointer of
+    // this function even when the frame-pointers are omitted elsewhere.
+    return _walk_frames(__builtin_frame_address(0), buffer, size);
+}
+
 char** oe_backtrace_symbols(void* const* buffer, int size)
 {
     /* Backtrace must use the internal allocator to bypass debug-malloc. */
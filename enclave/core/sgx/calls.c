@@ -14,6 +14,7 @@
 #include <openenclave/internal/globals.h>
 #include <openenclave/internal/jump.h>
 #include <openenclave/internal/malloc.h>
+#include <openenclave/internal/memfuncs.h>
 #include <openenclave/internal/print.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/sgxtypes.h>
@@ -167,6 +168,9 @@ static oe_result_t _handle_init_enclave(uint64_t arg_in)
             /* Initialize the CPUID table before calling global constructors. */
             OE_CHECK(oe_initialize_cpuid());
 
+            /* Select the mem functions for the CPU from the CPUID table. */
+            oe_initialize_memfuncs();
+
             /* Call global constructors. Now they can safely use simulated
              * instructions like CPUID. */
             oe_call_init_functions();
@@ -183,6 +187,126 @@ done:
     return result;
 }
 
+/*
+**==============================================================================
+**
+** ECALL marshalling buffers
+**
+**     Each thread keeps the marshalling buffer of its last ECALL in its td_t,
+**     so that the ECALLs that follow do not allocate one. Buffers bigger than
+**     OE_MAX_CACHED_ECALL_BUFFER_SIZE are allocated and freed for each call.
+**     The kept buffers of all the threads are linked together, so that they
+**     can be freed when the enclave is terminated.
+**
+**==============================================================================
+*/
+
+#define ECALL_BUFFER_GRANULARITY 1024
+
+typedef struct _ecall_buffer
+{
+    struct _ecall_buffer* next;
+    struct _ecall_buffer* prev;
+    td_t* td;
+    uint64_t size;
+} ecall_buffer_t;
+
+OE_STATIC_ASSERT(sizeof(ecall_buffer_t) % OE_EDGER8R_BUFFER_ALIGNMENT == 0);
+
+static ecall_buffer_t* _ecall_buffers;
+static oe_spinlock_t _ecall_buffers_lock = OE_SPINLOCK_INITIALIZER;
+
+/* The caller holds _ecall_buffers_lock. */
+static void _unlink_ecall_buffer(ecall_buffer_t* buffer)
+{
+    if (buffer->prev)
+        buffer->prev->next = buffer->next;
+    else
+        _ecall_buffers = buffer->next;
+
+    if (buffer->next)
+        buffer->next->prev = buffer->prev;
+}
+
+static void _free_ecall_buffer(ecall_buffer_t* buffer)
+{
+    oe_spin_lock(&_ecall_buffers_lock);
+    _unlink_ecall_buffer(buffer);
+    oe_spin_unlock(&_ecall_buffers_lock);
+
+    oe_free(buffer);
+}
+
+static uint8_t* _get_ecall_buffer(td_t* td, size_t size)
+{
+    ecall_buffer_t* buffer = td->base.ecall_buffer;
+    uint64_t buffer_size;
+
+    if (size > OE_MAX_CACHED_ECALL_BUFFER_SIZE)
+        return oe_malloc(size);
+
+    // The buffer is taken from the thread while it is in use.
+    td->base.ecall_buffer = NULL;
+
+    if (buffer && buffer->size >= size)
+        return (uint8_t*)(buffer + 1);
+
+    if (buffer)
+        _free_ecall_buffer(buffer);
+
+    buffer_size = oe_round_up_to_multiple(size, ECALL_BUFFER_GRANULARITY);
+
+    if (!(buffer = oe_malloc(sizeof(ecall_buffer_t) + buffer_size)))
+        return NULL;
+
+    buffer->prev = NULL;
+    buffer->td = td;
+    buffer->size = buffer_size;
+
+    oe_spin_lock(&_ecall_buffers_lock);
+    if ((buffer->next = _ecall_buffers))
+        buffer->next->prev = buffer;
+    _ecall_buffers = buffer;
+    oe_spin_unlock(&_ecall_buffers_lock);
+
+    return (uint8_t*)(buffer + 1);
+}
+
+static void _put_ecall_buffer(td_t* td, uint8_t* data, size_t size)
+{
+    ecall_buffer_t* buffer = (ecall_buffer_t*)data - 1;
+
+    if (size > OE_MAX_CACHED_ECALL_BUFFER_SIZE)
+        oe_free(data);
+    else if (td->base.ecall_buffer)
+        _free_ecall_buffer(buffer);
+    else
+        td->base.ecall_buffer = buffer;
+}
+
+/* Free the buffers kept by the threads, which are not in use. */
+static void _free_ecall_buffers(void)
+{
+    ecall_buffer_t* buffer;
+    ecall_buffer_t* next;
+
+    oe_spin_lock(&_ecall_buffers_lock);
+
+    for (buffer = _ecall_buffers; buffer; buffer = next)
+    {
+        next = buffer->next;
+
+        if (buffer->td->base.ecall_buffer != buffer)
+            continue;
+
+        buffer->td->base.ecall_buffer = NULL;
+        _unlink_ecall_buffer(buffer);
+        oe_free(buffer);
+    }
+
+    oe_spin_unlock(&_ecall_buffers_lock);
+}
+
 /**
  * This is the preferred way to call enclave functions.
  */
@@ -197,6 +321,7 @@ static oe_result_t _handle_call_enclave_function(uint64_t arg_in)
     size_t buffer_size = 0;
     size_t output_bytes_written = 0;
     ecall_table_t ecall_table;
+    td_t* td = oe_get_td();
 
     // Ensure that args lies outside the enclave.
     if (!oe_is_outside_enclave(
@@ -259,17 +384,20 @@ static oe_result_t _handle_call_enclave_function(uint64_t arg_in)
     if (func == NULL)
         OE_RAISE(OE_NOT_FOUND);
 
-    // Allocate buffers in enclave memory
-    buffer = input_buffer = oe_malloc(buffer_size);
+    // Get buffers in enclave memory. The buffer may have been used by a
+    // previous ECALL of this thread.
+    buffer = input_buffer = _get_ecall_buffer(td, buffer_size);
     if (buffer == NULL)
         OE_RAISE(OE_OUT_OF_MEMORY);
 
     // Copy input buffer to enclave buffer.
     memcpy(input_buffer, args.input_buffer, args.input_buffer_size);
 
-    // Clear out output buffer.
-    // This ensures reproducible behavior if say the function is reading from
-    // output buffer.
+    // Clear out output buffer, which is the only part of the buffer that the
+    // function may read before writing it: the input part was overwritten
+    // above. This ensures reproducible behavior if say the function is
+    // reading from output buffer, and that no data of a previous ECALL is
+    // copied back to the host.
     output_buffer = buffer + args.input_buffer_size;
     memset(output_buffer, 0, args.output_buffer_size);
 
@@ -298,11 +426,56 @@ static oe_result_t _handle_call_enclave_function(uint64_t arg_in)
 
 done:
     if (buffer)
-        oe_free(buffer);
+        _put_ecall_buffer(td, buffer, buffer_size);
 
     return result;
 }
 
+/**
+ * Make the calls of a batch one after the other in this single ECALL. The
+ * result of each call is stored in its own arguments, and a call that fails
+ * does not stop the calls after it.
+ */
+static oe_result_t _handle_call_enclave_function_batch(uint64_t arg_in)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_call_enclave_function_batch_args_t args;
+    oe_call_enclave_function_args_t* calls = NULL;
+    size_t calls_size = 0;
+
+    // Ensure that args lies outside the enclave.
+    if (!oe_is_outside_enclave(
+            (void*)arg_in, sizeof(oe_call_enclave_function_batch_args_t)))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    // Copy args to enclave memory to avoid TOCTOU issues.
+    args = *(oe_call_enclave_function_batch_args_t*)arg_in;
+    calls = args.calls;
+
+    // Ensure that the array of calls lies outside the enclave.
+    OE_CHECK(oe_safe_mul_u64(
+        args.num_calls, sizeof(oe_call_enclave_function_args_t), &calls_size));
+
+    if (args.num_calls &&
+        (calls == NULL || !oe_is_outside_enclave(calls, calls_size)))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    for (size_t i = 0; i < args.num_calls; i++)
+    {
+        oe_result_t call_result =
+            _handle_call_enclave_function((uint64_t)&calls[i]);
+
+        // Successful calls have already stored their result.
+        if (call_result != OE_OK)
+            calls[i].result = call_result;
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
 /*
 **==============================================================================
 **
@@ -390,6 +563,11 @@ static void _handle_ecall(
             arg_out = _handle_call_enclave_function(arg_in);
             break;
         }
+        case OE_ECALL_CALL_ENCLAVE_FUNCTION_BATCH:
+        {
+            arg_out = _handle_call_enclave_function_batch(arg_in);
+            break;
+        }
         case OE_ECALL_DESTRUCTOR:
         {
             /* Call functions installed by __cxa_atexit() and oe_atexit() */
@@ -398,6 +576,12 @@ static void _handle_ecall(
             /* Call all finalization functions */
             oe_call_fini_functions();
 
+            /* Wipe the cached report and seal keys */
+            oe_clear_key_cache();
+
+            /* Free the ECALL buffers kept by the threads */
+            _free_ecall_buffers();
+
 #if defined(OE_USE_DEBUG_MALLOC)
 
             /* If memory still allocated, print a trace and return an error */
@@ -597,10 +781,14 @@ oe_result_t oe_call_host_function_by_table_id(
     {
         oe_result_t post_result = oe_post_switchless_ocall(args);
 
-        // Fall back to regular OCALL if host worker threads are unavailable
+        // Fall back to regular OCALL if host worker threads are unavailable.
+        // The result tells the host's call profiler that the call missed.
         if (post_result == OE_CONTEXT_SWITCHLESS_OCALL_MISSED)
+        {
+            args->result = OE_CONTEXT_SWITCHLESS_OCALL_MISSED;
             OE_CHECK(
                 oe_ocall(OE_OCALL_CALL_HOST_FUNCTION, (uint64_t)args, NULL));
+        }
         else
         {
             OE_CHECK(post_result);
@@ -892,12 +1080,26 @@ void oe_notify_nested_exit_start(
     return;
 }
 
+static void (*_abort_handler)(void);
+
+void oe_set_abort_handler(void (*handler)(void))
+{
+    _abort_handler = handler;
+}
+
 void oe_abort(void)
 {
     // Once it starts to crash, the state can only transit forward, not
     // backward.
     if (__oe_enclave_status < OE_ENCLAVE_ABORTING)
     {
+        // Run the abort handler at most once (it may itself abort).
+        void (*handler)(void) = _abort_handler;
+        _abort_handler = NULL;
+
+        if (handler)
+            handler();
+
         __oe_enclave_status = OE_ENCLAVE_ABORTING;
     }
 
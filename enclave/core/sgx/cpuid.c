@@ -10,6 +10,9 @@
 #include "sgx_t.h"
 
 static uint32_t _cpuid_table[OE_CPUID_LEAF_COUNT][OE_CPUID_REG_COUNT];
+static bool _cpuid_initialized;
+
+volatile bool oe_rdtsc_traps;
 
 /*
 **==============================================================================
@@ -36,6 +39,7 @@ oe_result_t oe_initialize_cpuid(void)
     if (!(_cpuid_table[1][OE_CPUID_RCX] & OE_CPUID_AESNI_FEATURE))
         oe_abort();
 
+    __atomic_store_n(&_cpuid_initialized, true, __ATOMIC_RELEASE);
     result = OE_OK;
 
 done:
@@ -94,3 +98,79 @@ int oe_emulate_cpuid(uint64_t* rax, uint64_t* rbx, uint64_t* rcx, uint64_t* rdx)
     }
     return -1;
 }
+
+bool oe_has_cpuid_feature(
+    uint32_t leaf,
+    uint32_t feature,
+    uint32_t feature_register)
+{
+    uint64_t r[OE_CPUID_REG_COUNT] = {0};
+
+    if (feature_register >= OE_CPUID_REG_COUNT)
+        return false;
+
+    r[OE_CPUID_RAX] = leaf;
+    return oe_emulate_cpuid(
+               &r[OE_CPUID_RAX],
+               &r[OE_CPUID_RBX],
+               &r[OE_CPUID_RCX],
+               &r[OE_CPUID_RDX]) == 0 &&
+           (r[feature_register] & feature) == feature;
+}
+
+bool oe_is_cpuid_initialized(void)
+{
+    return __atomic_load_n(&_cpuid_initialized, __ATOMIC_ACQUIRE);
+}
+
+oe_result_t oe_cpuid(
+    uint32_t leaf,
+    uint32_t subleaf,
+    uint32_t* eax,
+    uint32_t* ebx,
+    uint32_t* ecx,
+    uint32_t* edx)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint64_t r[OE_CPUID_REG_COUNT] = {0};
+
+    if (!eax || !ebx || !ecx || !edx)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    r[OE_CPUID_RAX] = leaf;
+    r[OE_CPUID_RCX] = subleaf;
+
+    if (oe_emulate_cpuid(
+            &r[OE_CPUID_RAX],
+            &r[OE_CPUID_RBX],
+            &r[OE_CPUID_RCX],
+            &r[OE_CPUID_RDX]) != 0)
+        OE_RAISE_NO_TRACE(OE_UNSUPPORTED);
+
+    *eax = (uint32_t)r[OE_CPUID_RAX];
+    *ebx = (uint32_t)r[OE_CPUID_RBX];
+    *ecx = (uint32_t)r[OE_CPUID_RCX];
+    *edx = (uint32_t)r[OE_CPUID_RDX];
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+uint64_t oe_rdtsc(void)
+{
+    uint64_t tsc = 0;
+
+    /* RDTSC is legal on SGX2, so it is only replaced by the OCALL, which
+     * costs less than a trap, once it has trapped. */
+    if (oe_rdtsc_traps)
+    {
+        if (oe_rdtsc_ocall(&tsc) != OE_OK)
+            return 0;
+
+        return tsc;
+    }
+
+    return oe_execute_rdtsc();
+}
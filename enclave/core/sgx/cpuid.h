@@ -16,4 +16,12 @@ int oe_emulate_cpuid(
 
 oe_result_t oe_initialize_cpuid(void);
 
+/* Set once RDTSC has trapped, after which oe_rdtsc() reads the time stamp
+ * counter of the host with an OCALL. */
+extern volatile bool oe_rdtsc_traps;
+
+/* Execute RDTSC as the first instruction of the function, whose traps are
+ * always emulated. */
+uint64_t oe_execute_rdtsc(void);
+
 #endif /* _OE_CPUID_ENCLAVE_H */
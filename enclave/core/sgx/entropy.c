@@ -3,31 +3,14 @@
 
 #include <openenclave/corelibc/string.h>
 #include <openenclave/enclave.h>
+#include <openenclave/internal/cpuid.h>
 #include <openenclave/internal/entropy.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/rdrand.h>
 #include <openenclave/internal/rdseed.h>
-#include "cpuid.h"
 
 typedef uint64_t (*_entropy_function_t)(void);
 
-OE_INLINE bool _has_cpuid_feature(
-    uint32_t leaf,
-    uint32_t feature,
-    uint32_t feature_register)
-{
-    oe_assert(feature_register < OE_CPUID_REG_COUNT);
-    uint64_t r[OE_CPUID_REG_COUNT] = {0};
-    r[OE_CPUID_RAX] = leaf;
-    return (
-        (oe_emulate_cpuid(
-             &r[OE_CPUID_RAX],
-             &r[OE_CPUID_RBX],
-             &r[OE_CPUID_RCX],
-             &r[OE_CPUID_RDX]) == 0) &&
-        (r[feature_register] & feature));
-}
-
 static oe_entropy_kind_t _get_entropy_kind()
 {
     oe_entropy_kind_t result = OE_ENTROPY_KIND_NONE;
@@ -36,10 +19,10 @@ static oe_entropy_kind_t _get_entropy_kind()
      * stronger entropy sources to supersede the weaker ones, so
      * go from least to most preferred sources.
      */
-    if (_has_cpuid_feature(1, OE_CPUID_RDRAND_FEATURE, OE_CPUID_RCX))
+    if (oe_has_cpuid_feature(1, OE_CPUID_RDRAND_FEATURE, OE_CPUID_RCX))
         result = OE_ENTROPY_KIND_RDRAND;
 
-    if (_has_cpuid_feature(7, OE_CPUID_RDSEED_FEATURE, OE_CPUID_RBX))
+    if (oe_has_cpuid_feature(7, OE_CPUID_RDSEED_FEATURE, OE_CPUID_RBX))
         result = OE_ENTROPY_KIND_RDSEED;
 
     return result;
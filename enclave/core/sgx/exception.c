@@ -13,6 +13,7 @@
 #include <openenclave/internal/sgxtypes.h>
 #include <openenclave/internal/thread.h>
 #include <openenclave/internal/trace.h>
+#include <openenclave/internal/trapprofile.h>
 #include "asmdefs.h"
 #include "cpuid.h"
 #include "init.h"
@@ -210,19 +211,36 @@ static struct
 ** _emulate_illegal_instruction()
 **
 ** Handle illegal instruction exceptions such as CPUID as part of the first
-** chance exception dispatcher.
+** chance exception dispatcher. The host passes its time stamp counter, read
+** when it handled the exception, to emulate RDTSC. RDTSC is only emulated
+** here for oe_rdtsc() or if the enclave has no exception handler; otherwise
+** it is dispatched to the handlers of the enclave as it always was.
 **
 **==============================================================================
 */
-int _emulate_illegal_instruction(sgx_ssa_gpr_t* ssa_gpr)
+int _emulate_illegal_instruction(sgx_ssa_gpr_t* ssa_gpr, uint64_t host_tsc)
 {
+    const uint16_t opcode = *((uint16_t*)ssa_gpr->rip);
+
     // Emulate CPUID
-    if (*((uint16_t*)ssa_gpr->rip) == OE_CPUID_OPCODE)
+    if (opcode == OE_CPUID_OPCODE)
     {
         return oe_emulate_cpuid(
             &ssa_gpr->rax, &ssa_gpr->rbx, &ssa_gpr->rcx, &ssa_gpr->rdx);
     }
 
+    // Emulate RDTSC, which is illegal on SGX1. The upper bits of RAX and RDX
+    // are zeroed as by the instruction.
+    if (opcode == OE_RDTSC_OPCODE &&
+        (ssa_gpr->rip == (uint64_t)oe_execute_rdtsc ||
+         g_current_exception_handler_count == 0))
+    {
+        ssa_gpr->rax = host_tsc & 0xFFFFFFFF;
+        ssa_gpr->rdx = host_tsc >> 32;
+        oe_rdtsc_traps = true;
+        return 0;
+    }
+
     return -1;
 }
 
@@ -304,7 +322,8 @@ void oe_real_exception_dispatcher(oe_context_t* oe_context)
 **
 **  The virtual (first pass) exception dispatcher. It checks whether or not
 **  there is an exception in current enclave thread, and save minimal exception
-**  context to TLS, and then return to host.
+**  context to TLS, and then return to host. The arg_in is the time stamp
+**  counter of the host, used to emulate RDTSC.
 **
 **==============================================================================
 */
@@ -314,7 +333,6 @@ void oe_virtual_exception_dispatcher(
     uint64_t* arg_out)
 {
     SSA_Info ssa_info = {0};
-    OE_UNUSED(arg_in);
 
     // Verify if the first SSA has valid exception info.
     if (_get_enclave_thread_first_ssa_info(td, &ssa_info) != 0)
@@ -357,8 +375,17 @@ void oe_virtual_exception_dispatcher(
         td->base.exception_flags |= OE_EXCEPTION_FLAGS_SOFTWARE;
     }
 
-    if (td->base.exception_code == OE_EXCEPTION_ILLEGAL_INSTRUCTION &&
-        _emulate_illegal_instruction(ssa_gpr) == 0)
+    bool emulated = false;
+
+    if (td->base.exception_code == OE_EXCEPTION_ILLEGAL_INSTRUCTION)
+    {
+        emulated = _emulate_illegal_instruction(ssa_gpr, arg_in) == 0;
+
+        // Count the traps of each instruction (see oe_dump_trap_profile()).
+        oe_trap_profile_record(ssa_gpr->rip, emulated);
+    }
+
+    if (emulated)
     {
         // Restore the RBP & RSP as required by return from EENTER
         td->host_rbp = td->host_previous_rbp;
@@ -0,0 +1,38 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/corelibc/stdlib.h>
+#include <openenclave/corelibc/string.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/raise.h>
+#include "sgx_t.h"
+
+oe_result_t oe_get_heap_profile_ecall(
+    void* buffer,
+    size_t buffer_size,
+    size_t* profile_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    char* profile = NULL;
+    size_t size = 0;
+
+    if (!profile_size)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(oe_get_heap_profile(&profile, &size));
+
+    /* The profile may grow before the host calls again with a larger
+     * buffer, which is then sized from this one. */
+    *profile_size = size;
+
+    if (!buffer || buffer_size < size)
+        OE_RAISE_NO_TRACE(OE_BUFFER_TOO_SMALL);
+
+    memcpy(buffer, profile, size);
+
+    result = OE_OK;
+
+done:
+    oe_free(profile);
+    return result;
+}
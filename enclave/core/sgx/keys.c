@@ -3,9 +3,12 @@
 
 #include <openenclave/bits/safecrt.h>
 #include <openenclave/corelibc/stdlib.h>
+#include <openenclave/corelibc/string.h>
 #include <openenclave/enclave.h>
 #include <openenclave/internal/raise.h>
+#include <openenclave/internal/sgxkeys.h>
 #include <openenclave/internal/sgxtypes.h>
+#include <openenclave/internal/thread.h>
 #include <openenclave/internal/utils.h>
 #include "asmdefs.h"
 #include "report.h"
@@ -75,10 +78,124 @@ static oe_result_t _get_key_imp(
     return result;
 }
 
+/*
+ * Cache of the report and seal keys returned by EGETKEY. A key only depends on
+ * the key request and on the enclave, so it does not change during the
+ * lifetime of the enclave. Entries are keyed by the fields of the request in
+ * front of reserved2, which must be zero.
+ */
+#define KEY_CACHE_SIZE 16
+#define KEY_REQUEST_FIELDS_SIZE OE_OFFSETOF(sgx_key_request_t, reserved2)
+
+typedef struct _cached_key
+{
+    uint8_t request[KEY_REQUEST_FIELDS_SIZE];
+    sgx_key_t key;
+    uint64_t last_use;
+    bool valid;
+} cached_key_t;
+
+static cached_key_t _key_cache[KEY_CACHE_SIZE];
+static uint64_t _key_cache_clock;
+static uint64_t _key_cache_generation;
+static oe_spinlock_t _key_cache_lock = OE_SPINLOCK_INITIALIZER;
+static void (*_key_cache_clear_hook)(void);
+
+static bool _is_cacheable(const sgx_key_request_t* sgx_key_request)
+{
+    return sgx_key_request->key_name == SGX_KEYSELECT_REPORT ||
+           sgx_key_request->key_name == SGX_KEYSELECT_SEAL;
+}
+
+static bool _find_cached_key(
+    const sgx_key_request_t* sgx_key_request,
+    sgx_key_t* sgx_key)
+{
+    bool found = false;
+
+    oe_spin_lock(&_key_cache_lock);
+
+    for (size_t i = 0; i < KEY_CACHE_SIZE; i++)
+    {
+        cached_key_t* entry = &_key_cache[i];
+
+        if (entry->valid &&
+            memcmp(entry->request, sgx_key_request, KEY_REQUEST_FIELDS_SIZE) ==
+                0)
+        {
+            *sgx_key = entry->key;
+            entry->last_use = ++_key_cache_clock;
+            found = true;
+            break;
+        }
+    }
+
+    oe_spin_unlock(&_key_cache_lock);
+    return found;
+}
+
+/* Add a key to the cache, replacing the least recently used one if full. */
+static void _cache_key(
+    const sgx_key_request_t* sgx_key_request,
+    const sgx_key_t* sgx_key)
+{
+    cached_key_t* entry = &_key_cache[0];
+
+    oe_spin_lock(&_key_cache_lock);
+
+    for (size_t i = 0; i < KEY_CACHE_SIZE; i++)
+    {
+        if (!_key_cache[i].valid)
+        {
+            entry = &_key_cache[i];
+            break;
+        }
+
+        if (_key_cache[i].last_use < entry->last_use)
+            entry = &_key_cache[i];
+    }
+
+    memcpy(entry->request, sgx_key_request, KEY_REQUEST_FIELDS_SIZE);
+    entry->key = *sgx_key;
+    entry->last_use = ++_key_cache_clock;
+    entry->valid = true;
+
+    oe_spin_unlock(&_key_cache_lock);
+}
+
+void oe_clear_key_cache(void)
+{
+    oe_spin_lock(&_key_cache_lock);
+    oe_secure_zero_fill(_key_cache, sizeof(_key_cache));
+    _key_cache_generation++;
+    oe_spin_unlock(&_key_cache_lock);
+
+    if (_key_cache_clear_hook)
+        _key_cache_clear_hook();
+}
+
+void oe_register_key_cache_clear_hook(void (*hook)(void))
+{
+    _key_cache_clear_hook = hook;
+}
+
+uint64_t oe_get_key_cache_generation(void)
+{
+    uint64_t generation;
+
+    oe_spin_lock(&_key_cache_lock);
+    generation = _key_cache_generation;
+    oe_spin_unlock(&_key_cache_lock);
+
+    return generation;
+}
+
 oe_result_t oe_get_key(
     const sgx_key_request_t* sgx_key_request,
     sgx_key_t* sgx_key)
 {
+    oe_result_t result;
+
     // Check the input parameters.
     // Key request and key must be inside enclave.
     if ((sgx_key_request == NULL) ||
@@ -119,7 +236,17 @@ oe_result_t oe_get_key(
         return OE_INVALID_PARAMETER;
     }
 
-    return _get_key_imp(sgx_key_request, sgx_key);
+    if (!_is_cacheable(sgx_key_request))
+        return _get_key_imp(sgx_key_request, sgx_key);
+
+    if (_find_cached_key(sgx_key_request, sgx_key))
+        return OE_OK;
+
+    result = _get_key_imp(sgx_key_request, sgx_key);
+    if (result == OE_OK)
+        _cache_key(sgx_key_request, sgx_key);
+
+    return result;
 }
 
 oe_result_t oe_get_seal_key_v2(
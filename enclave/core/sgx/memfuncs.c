@@ -0,0 +1,437 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/corelibc/string.h>
+#include <openenclave/internal/cpuid.h>
+#include <openenclave/internal/memfuncs.h>
+
+/*
+**==============================================================================
+**
+** memcpy(), memmove(), memset() and memcmp() for x86-64:
+**
+**     Every copy of marshalled parameters and most crypto buffer operations
+**     go through these functions, mostly with small sizes. Up to 32 bytes
+**     are handled without a loop, by loads and stores that may overlap.
+**     Larger sizes use 16-byte SSE2 or 32-byte AVX2 vectors with aligned
+**     stores, and REP MOVSB or REP STOSB from OE_MEMFUNCS_ERMS_THRESHOLD
+**     bytes if the CPU has enhanced REP MOVSB/STOSB (ERMS).
+**
+**     The implementation is selected once from the CPUID table cached at
+**     enclave initialization, since CPUID traps in an enclave. The portable
+**     versions from musl are used until then.
+**
+**==============================================================================
+*/
+
+typedef char v16_t __attribute__((__vector_size__(16)));
+typedef char v32_t __attribute__((__vector_size__(32)));
+typedef uint64_t v2u64_t __attribute__((__vector_size__(16)));
+typedef uint64_t v4u64_t __attribute__((__vector_size__(32)));
+
+/* The types to access memory with, aligned or not, which may alias any
+ * other type. */
+typedef v16_t v16a_t __attribute__((__may_alias__));
+typedef v32_t v32a_t __attribute__((__may_alias__));
+typedef v16_t v16u_t __attribute__((__aligned__(1), __may_alias__));
+typedef v32_t v32u_t __attribute__((__aligned__(1), __may_alias__));
+typedef uint64_t u64u_t __attribute__((__aligned__(1), __may_alias__));
+typedef uint32_t u32u_t __attribute__((__aligned__(1), __may_alias__));
+
+#define AVX2 __attribute__((target("avx2")))
+
+static int _memfuncs = OE_MEMFUNCS_GENERIC;
+static bool _erms;
+
+void oe_initialize_memfuncs(void)
+{
+    uint32_t xcr0_low;
+    uint32_t xcr0_high;
+
+    _erms = oe_has_cpuid_feature(7, OE_CPUID_ERMS_FEATURE, OE_CPUID_RBX);
+    _memfuncs = OE_MEMFUNCS_SSE2;
+
+    if (!oe_has_cpuid_feature(1, OE_CPUID_OSXSAVE_FEATURE, OE_CPUID_RCX) ||
+        !oe_has_cpuid_feature(7, OE_CPUID_AVX2_FEATURE, OE_CPUID_RBX))
+        return;
+
+    // The enclave's XFRM must enable the SSE and AVX state.
+    asm volatile("xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0));
+    OE_UNUSED(xcr0_high);
+
+    if ((xcr0_low & 0x6) == 0x6)
+        _memfuncs = OE_MEMFUNCS_AVX2;
+}
+
+int oe_get_memfuncs(bool* erms)
+{
+    if (erms)
+        *erms = _erms;
+
+    return _memfuncs;
+}
+
+/* Copy up to 32 bytes. All the bytes are loaded before any is stored, so the
+ * buffers may overlap. */
+static void _copy_small(uint8_t* d, const uint8_t* s, size_t n)
+{
+    if (n >= 16)
+    {
+        const v16_t head = *(const v16u_t*)s;
+        const v16_t tail = *(const v16u_t*)(s + n - 16);
+
+        *(v16u_t*)d = head;
+        *(v16u_t*)(d + n - 16) = tail;
+    }
+    else if (n >= 8)
+    {
+        const uint64_t head = *(const u64u_t*)s;
+        const uint64_t tail = *(const u64u_t*)(s + n - 8);
+
+        *(u64u_t*)d = head;
+        *(u64u_t*)(d + n - 8) = tail;
+    }
+    else if (n >= 4)
+    {
+        const uint32_t head = *(const u32u_t*)s;
+        const uint32_t tail = *(const u32u_t*)(s + n - 4);
+
+        *(u32u_t*)d = head;
+        *(u32u_t*)(d + n - 4) = tail;
+    }
+    else if (n)
+    {
+        const uint8_t first = s[0];
+        const uint8_t middle = s[n / 2];
+        const uint8_t last = s[n - 1];
+
+        d[0] = first;
+        d[n / 2] = middle;
+        d[n - 1] = last;
+    }
+}
+
+/* Copy more than 32 bytes. The first store aligns the destination, and the
+ * last one ends it, so they overlap the loop. */
+static void _copy_sse2(uint8_t* d, const uint8_t* s, size_t n)
+{
+    const v16_t head = *(const v16u_t*)s;
+    const v16_t tail = *(const v16u_t*)(s + n - 16);
+    uint8_t* const last = d + n - 16;
+    const size_t skew = 16 - ((uintptr_t)d & 15);
+
+    *(v16u_t*)d = head;
+    d += skew;
+    s += skew;
+    n -= skew;
+
+    for (; n > 64; d += 64, s += 64, n -= 64)
+    {
+        const v16_t a = *(const v16u_t*)s;
+        const v16_t b = *(const v16u_t*)(s + 16);
+        const v16_t c = *(const v16u_t*)(s + 32);
+        const v16_t e = *(const v16u_t*)(s + 48);
+
+        *(v16a_t*)d = a;
+        *(v16a_t*)(d + 16) = b;
+        *(v16a_t*)(d + 32) = c;
+        *(v16a_t*)(d + 48) = e;
+    }
+
+    for (; n > 16; d += 16, s += 16, n -= 16)
+        *(v16a_t*)d = *(const v16u_t*)s;
+
+    *(v16u_t*)last = tail;
+}
+
+/* Copy more than 64 bytes, as _copy_sse2() does. */
+AVX2 static void _copy_avx2(uint8_t* d, const uint8_t* s, size_t n)
+{
+    const v32_t head = *(const v32u_t*)s;
+    const v32_t tail = *(const v32u_t*)(s + n - 32);
+    uint8_t* const last = d + n - 32;
+    const size_t skew = 32 - ((uintptr_t)d & 31);
+
+    *(v32u_t*)d = head;
+    d += skew;
+    s += skew;
+    n -= skew;
+
+    for (; n > 128; d += 128, s += 128, n -= 128)
+    {
+        const v32_t a = *(const v32u_t*)s;
+        const v32_t b = *(const v32u_t*)(s + 32);
+        const v32_t c = *(const v32u_t*)(s + 64);
+        const v32_t e = *(const v32u_t*)(s + 96);
+
+        *(v32a_t*)d = a;
+        *(v32a_t*)(d + 32) = b;
+        *(v32a_t*)(d + 64) = c;
+        *(v32a_t*)(d + 96) = e;
+    }
+
+    for (; n > 32; d += 32, s += 32, n -= 32)
+        *(v32a_t*)d = *(const v32u_t*)s;
+
+    *(v32u_t*)last = tail;
+}
+
+void* memcpy(void* OE_RESTRICT dest, const void* OE_RESTRICT src, size_t n)
+{
+    uint8_t* d = (uint8_t*)dest;
+    const uint8_t* s = (const uint8_t*)src;
+
+    if (_memfuncs == OE_MEMFUNCS_GENERIC)
+        return oe_generic_memcpy(dest, src, n);
+
+    if (n <= 32)
+        _copy_small(d, s, n);
+    else if (_erms && n >= OE_MEMFUNCS_ERMS_THRESHOLD)
+        asm volatile("rep movsb" : "+D"(d), "+S"(s), "+c"(n) : : "memory");
+    else if (_memfuncs == OE_MEMFUNCS_AVX2 && n > 64)
+        _copy_avx2(d, s, n);
+    else
+        _copy_sse2(d, s, n);
+
+    return dest;
+}
+
+/* Copy more than 32 bytes to a lower address that may overlap. Each vector
+ * is loaded before it is stored, over source bytes that are already read. */
+static void _move_forward(uint8_t* d, const uint8_t* s, size_t n)
+{
+    const v16_t tail = *(const v16u_t*)(s + n - 16);
+    uint8_t* const last = d + n - 16;
+
+    for (; n > 16; d += 16, s += 16, n -= 16)
+        *(v16u_t*)d = *(const v16u_t*)s;
+
+    *(v16u_t*)last = tail;
+}
+
+/* Copy more than 32 bytes to a higher address that may overlap. */
+static void _move_backward(uint8_t* d, const uint8_t* s, size_t n)
+{
+    const v16_t head = *(const v16u_t*)s;
+    uint8_t* const first = d;
+
+    for (d += n, s += n; n > 16; n -= 16)
+    {
+        d -= 16;
+        s -= 16;
+        *(v16u_t*)d = *(const v16u_t*)s;
+    }
+
+    *(v16u_t*)first = head;
+}
+
+void* memmove(void* dest, const void* src, size_t n)
+{
+    uint8_t* d = (uint8_t*)dest;
+    const uint8_t* s = (const uint8_t*)src;
+
+    if (_memfuncs == OE_MEMFUNCS_GENERIC)
+        return oe_generic_memmove(dest, src, n);
+
+    if (n <= 32)
+        _copy_small(d, s, n);
+    else if (
+        (uintptr_t)d - (uintptr_t)s >= n && (uintptr_t)s - (uintptr_t)d >= n)
+        memcpy(d, s, n);
+    else if (d < s)
+        _move_forward(d, s, n);
+    else if (d > s)
+        _move_backward(d, s, n);
+
+    return dest;
+}
+
+/* Set up to 32 bytes. */
+static void _set_small(uint8_t* d, uint64_t c, size_t n)
+{
+    if (n >= 16)
+    {
+        const v16_t x = (v16_t)(v2u64_t){c, c};
+
+        *(v16u_t*)d = x;
+        *(v16u_t*)(d + n - 16) = x;
+    }
+    else if (n >= 8)
+    {
+        *(u64u_t*)d = c;
+        *(u64u_t*)(d + n - 8) = c;
+    }
+    else if (n >= 4)
+    {
+        *(u32u_t*)d = (uint32_t)c;
+        *(u32u_t*)(d + n - 4) = (uint32_t)c;
+    }
+    else if (n)
+    {
+        d[0] = (uint8_t)c;
+        d[n / 2] = (uint8_t)c;
+        d[n - 1] = (uint8_t)c;
+    }
+}
+
+/* Set more than 32 bytes, with the same stores as _copy_sse2(). */
+static void _set_sse2(uint8_t* d, uint64_t c, size_t n)
+{
+    const v16_t x = (v16_t)(v2u64_t){c, c};
+    uint8_t* const last = d + n - 16;
+    const size_t skew = 16 - ((uintptr_t)d & 15);
+
+    *(v16u_t*)d = x;
+    d += skew;
+    n -= skew;
+
+    for (; n > 64; d += 64, n -= 64)
+    {
+        *(v16a_t*)d = x;
+        *(v16a_t*)(d + 16) = x;
+        *(v16a_t*)(d + 32) = x;
+        *(v16a_t*)(d + 48) = x;
+    }
+
+    for (; n > 16; d += 16, n -= 16)
+        *(v16a_t*)d = x;
+
+    *(v16u_t*)last = x;
+}
+
+/* Set more than 64 bytes. */
+AVX2 static void _set_avx2(uint8_t* d, uint64_t c, size_t n)
+{
+    const v32_t x = (v32_t)(v4u64_t){c, c, c, c};
+    uint8_t* const last = d + n - 32;
+    const size_t skew = 32 - ((uintptr_t)d & 31);
+
+    *(v32u_t*)d = x;
+    d += skew;
+    n -= skew;
+
+    for (; n > 128; d += 128, n -= 128)
+    {
+        *(v32a_t*)d = x;
+        *(v32a_t*)(d + 32) = x;
+        *(v32a_t*)(d + 64) = x;
+        *(v32a_t*)(d + 96) = x;
+    }
+
+    for (; n > 32; d += 32, n -= 32)
+        *(v32a_t*)d = x;
+
+    *(v32u_t*)last = x;
+}
+
+void* memset(void* dest, int c, size_t n)
+{
+    uint8_t* d = (uint8_t*)dest;
+    const uint64_t x = 0x0101010101010101ull * (uint8_t)c;
+
+    if (_memfuncs == OE_MEMFUNCS_GENERIC)
+        return oe_generic_memset(dest, c, n);
+
+    if (n <= 32)
+        _set_small(d, x, n);
+    else if (_erms && n >= OE_MEMFUNCS_ERMS_THRESHOLD)
+        asm volatile("rep stosb" : "+D"(d), "+c"(n) : "a"(c) : "memory");
+    else if (_memfuncs == OE_MEMFUNCS_AVX2 && n > 64)
+        _set_avx2(d, x, n);
+    else
+        _set_sse2(d, x, n);
+
+    return dest;
+}
+
+/* Return the difference of the first bytes that differ in two words. */
+static int _difference(uint64_t a, uint64_t b)
+{
+    const unsigned int shift = (unsigned int)__builtin_ctzll(a ^ b) & ~7u;
+
+    return (int)((a >> shift) & 0xff) - (int)((b >> shift) & 0xff);
+}
+
+static int _compare_sse2(const uint8_t* l, const uint8_t* r, size_t n)
+{
+    for (; n >= 16; l += 16, r += 16, n -= 16)
+    {
+        const v16_t a = *(const v16u_t*)l;
+        const v16_t b = *(const v16u_t*)r;
+        const unsigned int equal =
+            (unsigned int)__builtin_ia32_pmovmskb128((v16_t)(a == b));
+
+        if (equal != 0xffff)
+        {
+            const int i = __builtin_ctz(~equal);
+            return l[i] - r[i];
+        }
+    }
+
+    if (n >= 8)
+    {
+        const uint64_t a = *(const u64u_t*)l;
+        const uint64_t b = *(const u64u_t*)r;
+
+        if (a != b)
+            return _difference(a, b);
+
+        l += 8;
+        r += 8;
+        n -= 8;
+    }
+
+    if (n >= 4)
+    {
+        const uint32_t a = *(const u32u_t*)l;
+        const uint32_t b = *(const u32u_t*)r;
+
+        if (a != b)
+            return _difference(a, b);
+
+        l += 4;
+        r += 4;
+        n -= 4;
+    }
+
+    for (; n; l++, r++, n--)
+    {
+        if (*l != *r)
+            return *l - *r;
+    }
+
+    return 0;
+}
+
+AVX2 static int _compare_avx2(const uint8_t* l, const uint8_t* r, size_t n)
+{
+    for (; n >= 32; l += 32, r += 32, n -= 32)
+    {
+        const v32_t a = *(const v32u_t*)l;
+        const v32_t b = *(const v32u_t*)r;
+        const unsigned int equal =
+            (unsigned int)__builtin_ia32_pmovmskb256((v32_t)(a == b));
+
+        if (equal != 0xffffffff)
+        {
+            const int i = __builtin_ctz(~equal);
+            return l[i] - r[i];
+        }
+    }
+
+    return _compare_sse2(l, r, n);
+}
+
+int memcmp(const void* vl, const void* vr, size_t n)
+{
+    const uint8_t* l = (const uint8_t*)vl;
+    const uint8_t* r = (const uint8_t*)vr;
+
+    if (_memfuncs == OE_MEMFUNCS_GENERIC)
+        return oe_generic_memcmp(vl, vr, n);
+
+    if (_memfuncs == OE_MEMFUNCS_AVX2 && n >= 64)
+        return _compare_avx2(l, r, n);
+
+    return _compare_sse2(l, r, n);
+}
@@ -247,8 +247,10 @@ void td_init(td_t* td)
         // td_t.hostsp, td_t.hostbp, and td_t.retaddr already set by
         // oe_enter().
 
-        /* Clear base structure */
+        /* Clear base structure, except for the cached ECALL buffer */
+        void* ecall_buffer = td->base.ecall_buffer;
         memset(&td->base, 0, sizeof(td->base));
+        td->base.ecall_buffer = ecall_buffer;
 
         /* Set pointer to self */
         td->base.self_addr = (uint64_t)td;
@@ -302,8 +304,10 @@ void td_clear(td_t* td)
     if (td->depth != 0 || td->callsites != NULL)
         oe_abort();
 
-    /* Clear base structure */
+    /* Clear base structure, except for the cached ECALL buffer */
+    void* ecall_buffer = td->base.ecall_buffer;
     memset(&td->base, 0, sizeof(td->base));
+    td->base.ecall_buffer = ecall_buffer;
 
     /* Clear the magic number */
     td->magic = 0;
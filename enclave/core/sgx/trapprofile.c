@@ -0,0 +1,118 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/corelibc/string.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/atomic.h>
+#include <openenclave/internal/globals.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/trapprofile.h>
+#include "sgx_t.h"
+
+/*
+**==============================================================================
+**
+** Illegal instruction traps:
+**
+**     An instruction that is illegal in an SGX enclave, such as CPUID or
+**     RDTSC on SGX1, exits the enclave and is handled by the host signal
+**     handler, which enters the enclave again to emulate it. This costs
+**     tens of thousands of cycles, so the traps are counted per instruction
+**     to find the code that executes them in a loop. The table is updated
+**     with compare-and-swap by the first pass exception handler of any
+**     thread, and is never cleared.
+**
+**==============================================================================
+*/
+
+typedef struct _trap_slot
+{
+    /* The address of the instruction, or zero if the slot is free. */
+    volatile int64_t address;
+    volatile uint64_t count;
+    volatile uint64_t emulated;
+} trap_slot_t;
+
+static trap_slot_t _slots[OE_TRAP_PROFILE_SIZE];
+
+/* The traps that did not fit in the table. */
+static volatile uint64_t _num_dropped;
+
+static size_t _hash(uint64_t address)
+{
+    return (size_t)((address * 0x9E3779B97F4A7C15) >> 56) %
+           OE_TRAP_PROFILE_SIZE;
+}
+
+void oe_trap_profile_record(uint64_t address, bool emulated)
+{
+    const size_t start = _hash(address);
+
+    for (size_t i = 0; i < OE_TRAP_PROFILE_SIZE; i++)
+    {
+        trap_slot_t* slot = &_slots[(start + i) % OE_TRAP_PROFILE_SIZE];
+
+        /* Claim the slot if it is free. The weak compare-and-swap may fail
+         * spuriously, in which case the slot is read again. */
+        while (slot->address == 0 &&
+               !oe_atomic_compare_and_swap(&slot->address, 0, (int64_t)address))
+            ;
+
+        if (slot->address == (int64_t)address)
+        {
+            oe_atomic_increment(&slot->count);
+
+            if (emulated)
+                oe_atomic_increment(&slot->emulated);
+
+            return;
+        }
+    }
+
+    oe_atomic_increment(&_num_dropped);
+}
+
+oe_result_t oe_get_trap_profile_ecall(
+    void* buffer,
+    size_t buffer_size,
+    size_t* num_entries,
+    uint64_t* num_dropped)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_trap_profile_entry_t* entries = (oe_trap_profile_entry_t*)buffer;
+    const uint64_t base = (uint64_t)__oe_get_enclave_base();
+    const size_t max_entries = buffer_size / sizeof(*entries);
+    size_t n = 0;
+
+    if (!buffer || !num_entries || !num_dropped)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    for (size_t i = 0; i < OE_TRAP_PROFILE_SIZE; i++)
+    {
+        const trap_slot_t* slot = &_slots[i];
+        const uint64_t address = (uint64_t)slot->address;
+
+        if (!address)
+            continue;
+
+        if (n == max_entries)
+            OE_RAISE(OE_BUFFER_TOO_SMALL);
+
+        /* The instruction is read again rather than recorded with the trap,
+         * so a slot is complete as soon as it is claimed. */
+        memset(&entries[n], 0, sizeof(entries[n]));
+        entries[n].address = address - base;
+        entries[n].opcode = *(const uint16_t*)address;
+        entries[n].count = slot->count;
+        entries[n].emulated = slot->emulated;
+        n++;
+    }
+
+    *num_entries = n;
+    *num_dropped = _num_dropped;
+
+    result = OE_OK;
+
+done:
+    return result;
+}
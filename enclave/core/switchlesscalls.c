@@ -7,6 +7,7 @@
 #include <openenclave/internal/atomic.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/utils.h>
+#include <string.h>
 
 // The number of host thread workers. Initialized by host through ECALL
 static size_t _host_worker_count = 0;
@@ -14,6 +15,9 @@ static size_t _host_worker_count = 0;
 // The array of host worker contexts. Initialized by host through ECALL
 static oe_host_worker_context_t* _host_worker_contexts = NULL;
 
+// The ring of asynchronous ocalls. Initialized by host through ECALL
+static oe_async_ocall_ring_t* _async_ocall_ring = NULL;
+
 /*
 **==============================================================================
 **
@@ -60,6 +64,8 @@ oe_result_t oe_handle_init_switchless(uint64_t arg_in)
             safe_manager.host_worker_contexts, contexts_size) ||
         !oe_is_outside_enclave(
             safe_manager.host_worker_threads, threads_size) ||
+        !oe_is_outside_enclave(
+            safe_manager.async_ocall_ring, sizeof(oe_async_ocall_ring_t)) ||
         safe_manager.num_host_workers == 0)
     {
         OE_RAISE(OE_INVALID_PARAMETER);
@@ -71,12 +77,56 @@ oe_result_t oe_handle_init_switchless(uint64_t arg_in)
     // Copy the worker context array pointer and its size to avoid TOCTOU
     _host_worker_count = safe_manager.num_host_workers;
     _host_worker_contexts = safe_manager.host_worker_contexts;
+    _async_ocall_ring = safe_manager.async_ocall_ring;
     result = OE_OK;
 
 done:
     return result;
 }
 
+/*
+**==============================================================================
+**
+** _wake_host_worker()
+**
+**  Make sure that the given host worker thread is awake or has a pending wake
+**  notification, so that it looks for work again.
+**
+**==============================================================================
+*/
+static void _wake_host_worker(oe_host_worker_context_t* context)
+{
+    // If event is 0, it means that it has gone to sleep. Wake it by
+    // making an ocall (OE_OCALL_WAKE_HOST_WORKER).
+    // Note: it is important to use an atomic cas operation to set
+    // the value to 1 before making the ocall. Setting the value to
+    // 1 prevents the host worker from simulataneously going to
+    // sleep. If instead, just a compare operation is used to
+    // determine if the host thread is sleeping or not, the host
+    // thread could go to sleep after the enclave has determined
+    // that the host is not sleeping, causing a deadlock.
+    //
+    // If event is 1, that indicates a pending wake notification.
+    int32_t oldval = 0;
+    int32_t newval = 1;
+    // Weak operation could sporadically fail.
+    // We need a strong operation.
+    bool weak = false;
+    if (__atomic_compare_exchange_n(
+            &context->event,
+            &oldval,
+            newval,
+            weak,
+            __ATOMIC_ACQ_REL,
+            __ATOMIC_ACQUIRE))
+    {
+        // The pevious value of the event was 0 which means that the
+        // worker was previously sleeping.
+        // Wake it via an ocall.
+        oe_ocall(OE_OCALL_WAKE_HOST_WORKER, (uint64_t)context, NULL);
+    }
+}
+
 /*
 **==============================================================================
 **
@@ -114,39 +164,7 @@ oe_result_t oe_post_switchless_ocall(oe_call_host_function_args_t* args)
             {
                 // The worker thread has been marked to execute this switchless
                 // call. Determine if it needs to be woken up or not.
-                //
-                // If event is 0, it means that it has gone to sleep. Wake it by
-                // making an ocall (OE_OCALL_WAKE_HOST_WORKER).
-                // Note: it is important to use an atomic cas operation to set
-                // the value to 1 before making the ocall. Setting the value to
-                // 1 prevents the host worker from simulataneously going to
-                // sleep. If instead, just a compare operation is used to
-                // determine if the host thread is sleeping or not, the host
-                // thread could go to sleep after the enclave has determined
-                // that the host is not sleeping, causing a deadlock.
-                //
-                // If event is 1, that indicates a pending wake notification.
-                int32_t oldval = 0;
-                int32_t newval = 1;
-                // Weak operation could sporadically fail.
-                // We need a strong operation.
-                bool weak = false;
-                if (__atomic_compare_exchange_n(
-                        &_host_worker_contexts[tries].event,
-                        &oldval,
-                        newval,
-                        weak,
-                        __ATOMIC_ACQ_REL,
-                        __ATOMIC_ACQUIRE))
-                {
-                    // The pevious value of the event was 0 which means that the
-                    // worker was previously sleeping.
-                    // Wake it via an ocall.
-                    oe_ocall(
-                        OE_OCALL_WAKE_HOST_WORKER,
-                        (uint64_t)&_host_worker_contexts[tries],
-                        NULL);
-                }
+                _wake_host_worker(&_host_worker_contexts[tries]);
 
                 return OE_OK;
             }
@@ -184,3 +202,182 @@ oe_result_t oe_switchless_call_host_function(
         output_bytes_written,
         true /* switchless */);
 }
+
+/*
+**==============================================================================
+**
+** oe_post_async_ocall()
+**
+**  Copy the function call into a free slot of the ring of asynchronous ocalls
+**  and return without waiting for the host workers to execute it.
+**
+**==============================================================================
+*/
+oe_result_t oe_post_async_ocall(
+    uint64_t table_id,
+    uint64_t function_id,
+    const void* input_buffer,
+    size_t input_buffer_size,
+    size_t output_buffer_size)
+{
+    const uint64_t mask = OE_ASYNC_OCALL_RING_SIZE - 1;
+    oe_async_ocall_ring_t* ring = _async_ocall_ring;
+    oe_async_ocall_slot_t* slot = NULL;
+    uint64_t pos = 0;
+
+    if (!ring || input_buffer_size > OE_ASYNC_OCALL_BUFFER_SIZE ||
+        output_buffer_size > OE_ASYNC_OCALL_BUFFER_SIZE - input_buffer_size)
+        return OE_CONTEXT_SWITCHLESS_OCALL_MISSED;
+
+    // Claim the slot at the head. The ring is full if the host workers have
+    // not executed the call of the previous round in that slot yet. The slot
+    // index is masked here, so the host cannot point the copy elsewhere.
+    for (pos = ring->head;; pos = ring->head)
+    {
+        slot = &ring->slots[pos & mask];
+        int64_t diff = (int64_t)(slot->sequence - pos);
+
+        if (diff < 0)
+            return OE_CONTEXT_SWITCHLESS_OCALL_MISSED;
+
+        if (diff == 0 &&
+            oe_atomic_compare_and_swap(
+                (int64_t volatile*)&ring->head, (int64_t)pos, (int64_t)pos + 1))
+            break;
+    }
+
+    slot->args.table_id = table_id;
+    slot->args.function_id = function_id;
+    slot->args.input_buffer_size = input_buffer_size;
+    slot->args.output_buffer_size = output_buffer_size;
+    slot->args.output_bytes_written = 0;
+    // Means the call was not made by an enclave thread, as for switchless
+    // ocalls.
+    slot->args.result = __OE_RESULT_MAX;
+    memcpy(slot->buffer, input_buffer, input_buffer_size);
+
+    // Publish the call.
+    OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+    slot->sequence = pos + 1;
+
+    // A worker with a pending wake notification looks at the ring again
+    // before it goes to sleep. Otherwise wake one of them.
+    for (size_t i = 0; i < _host_worker_count; i++)
+    {
+        if (_host_worker_contexts[i].event == 1)
+            return OE_OK;
+    }
+
+    _wake_host_worker(&_host_worker_contexts[pos % _host_worker_count]);
+
+    return OE_OK;
+}
+
+/*
+**==============================================================================
+**
+** oe_async_call_host_function_by_table_id()
+**
+**==============================================================================
+*/
+
+oe_result_t oe_async_call_host_function_by_table_id(
+    uint64_t table_id,
+    uint64_t function_id,
+    const void* input_buffer,
+    size_t input_buffer_size,
+    void* output_buffer,
+    size_t output_buffer_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    size_t output_bytes_written = 0;
+
+    if (!input_buffer || input_buffer_size == 0)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    result = oe_post_async_ocall(
+        table_id,
+        function_id,
+        input_buffer,
+        input_buffer_size,
+        output_buffer_size);
+
+    // Make the call synchronously if there are no host workers, the ring is
+    // full or the call does not fit in a slot.
+    if (result == OE_CONTEXT_SWITCHLESS_OCALL_MISSED)
+        result = oe_call_host_function_by_table_id(
+            table_id,
+            function_id,
+            input_buffer,
+            input_buffer_size,
+            output_buffer,
+            output_buffer_size,
+            &output_bytes_written,
+            true /* switchless */);
+
+done:
+    return result;
+}
+
+/*
+**==============================================================================
+**
+** oe_async_call_host_function()
+**
+**==============================================================================
+*/
+
+oe_result_t oe_async_call_host_function(
+    size_t function_id,
+    const void* input_buffer,
+    size_t input_buffer_size,
+    void* output_buffer,
+    size_t output_buffer_size)
+{
+    return oe_async_call_host_function_by_table_id(
+        OE_UINT64_MAX,
+        function_id,
+        input_buffer,
+        input_buffer_size,
+        output_buffer,
+        output_buffer_size);
+}
+
+/*
+**==============================================================================
+**
+** oe_flush_async_ocalls()
+**
+**==============================================================================
+*/
+
+oe_result_t oe_flush_async_ocalls(void)
+{
+    const uint64_t mask = OE_ASYNC_OCALL_RING_SIZE - 1;
+    oe_async_ocall_ring_t* ring = _async_ocall_ring;
+    uint64_t head = 0;
+    uint64_t pos = 0;
+
+    if (!ring)
+        return OE_OK;
+
+    // The calls before head - OE_ASYNC_OCALL_RING_SIZE have been executed,
+    // since their slots have been claimed again. The call at position pos
+    // has been executed once its slot is free for position
+    // pos + OE_ASYNC_OCALL_RING_SIZE.
+    head = ring->head;
+    if (head > OE_ASYNC_OCALL_RING_SIZE)
+        pos = head - OE_ASYNC_OCALL_RING_SIZE;
+
+    for (; pos < head; pos++)
+    {
+        volatile uint64_t* sequence = &ring->slots[pos & mask].sequence;
+
+        while ((int64_t)(*sequence - (pos + OE_ASYNC_OCALL_RING_SIZE)) < 0)
+            OE_CPU_RELAX();
+    }
+
+    OE_ATOMIC_MEMORY_BARRIER_ACQUIRE();
+
+    return OE_OK;
+}
@@ -12,4 +12,11 @@ oe_result_t oe_handle_init_switchless(uint64_t arg_in);
 
 oe_result_t oe_post_switchless_ocall(oe_call_host_function_args_t* args);
 
+oe_result_t oe_post_async_ocall(
+    uint64_t table_id,
+    uint64_t function_id,
+    const void* input_buffer,
+    size_t input_buffer_size,
+    size_t output_buffer_size);
+
 #endif // _OE_SWITCHLESSCALLS_H
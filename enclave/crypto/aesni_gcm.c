@@ -0,0 +1,465 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#if defined(__x86_64__)
+
+#include <mbedtls/aesni.h>
+#include <openenclave/internal/cpuid.h>
+#include <string.h>
+#include "aesni_gcm.h"
+
+#define PCLMULQDQ_FEATURE 0x00000002u /* Leaf 1, subleaf 0, ECX */
+#define SSSE3_FEATURE 0x00000200u     /* Leaf 1, subleaf 0, ECX */
+
+/*
+ * SSE registers as GCC/Clang vector types. The intrinsics headers are not
+ * available to enclaves (which are built with -nostdinc), so instructions
+ * without a C operator are written as inline assembly.
+ */
+typedef long long block_t __attribute__((vector_size(16)));
+typedef uint32_t block32_t __attribute__((vector_size(16)));
+typedef uint8_t block8_t __attribute__((vector_size(16)));
+typedef long long unaligned_block_t
+    __attribute__((vector_size(16), aligned(1), may_alias));
+
+#define PSLLDQ(b, n) __asm__("pslldq $" #n ", %0" : "+x"(b))
+#define PSRLDQ(b, n) __asm__("psrldq $" #n ", %0" : "+x"(b))
+
+/* Reverses the bytes of a block with PSHUFB. */
+static const block8_t _bswap_mask =
+    {15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0};
+
+static const block32_t _one = {1, 0, 0, 0};
+
+OE_INLINE block_t _load(const void* p)
+{
+    return *(const unaligned_block_t*)p;
+}
+
+OE_INLINE void _store(void* p, block_t b)
+{
+    *(unaligned_block_t*)p = b;
+}
+
+OE_INLINE block_t _bswap(block_t b)
+{
+    __asm__("pshufb %1, %0" : "+x"(b) : "x"(_bswap_mask));
+    return b;
+}
+
+OE_INLINE block_t _aesenc(block_t b, block_t round_key)
+{
+    __asm__("aesenc %1, %0" : "+x"(b) : "x"(round_key));
+    return b;
+}
+
+OE_INLINE block_t _aesenclast(block_t b, block_t round_key)
+{
+    __asm__("aesenclast %1, %0" : "+x"(b) : "x"(round_key));
+    return b;
+}
+
+/* Carry-less multiplications of the selected 64-bit halves. */
+OE_INLINE block_t _clmul_00(block_t a, block_t b)
+{
+    __asm__("pclmulqdq $0x00, %1, %0" : "+x"(a) : "x"(b));
+    return a;
+}
+
+OE_INLINE block_t _clmul_01(block_t a, block_t b)
+{
+    __asm__("pclmulqdq $0x01, %1, %0" : "+x"(a) : "x"(b));
+    return a;
+}
+
+OE_INLINE block_t _clmul_10(block_t a, block_t b)
+{
+    __asm__("pclmulqdq $0x10, %1, %0" : "+x"(a) : "x"(b));
+    return a;
+}
+
+OE_INLINE block_t _clmul_11(block_t a, block_t b)
+{
+    __asm__("pclmulqdq $0x11, %1, %0" : "+x"(a) : "x"(b));
+    return a;
+}
+
+/* An unreduced 256-bit GHASH product (lo ^ mid << 64 ^ hi << 128). */
+typedef struct _product
+{
+    block_t lo;
+    block_t mid;
+    block_t hi;
+} product_t;
+
+OE_INLINE void _multiply_add(product_t* p, block_t a, block_t b)
+{
+    p->lo ^= _clmul_00(a, b);
+    p->mid ^= _clmul_01(a, b) ^ _clmul_10(a, b);
+    p->hi ^= _clmul_11(a, b);
+}
+
+/*
+ * Reduce a product of byte-reversed operands modulo the GCM polynomial
+ * x^128 + x^7 + x^2 + x + 1, as described in the Intel white paper "Intel
+ * Carry-Less Multiplication Instruction and its Usage for Computing the GCM
+ * Mode" (the product is shifted left by one bit since the operands are bit
+ * reflected).
+ */
+OE_INLINE block_t _reduce(const product_t* p)
+{
+    block_t mid_lo = p->mid;
+    block_t mid_hi = p->mid;
+    block32_t lo;
+    block32_t hi;
+    block32_t carry_lo;
+    block32_t carry_hi;
+    block32_t carry_mid;
+    block32_t t;
+    block32_t u;
+
+    PSLLDQ(mid_lo, 8);
+    PSRLDQ(mid_hi, 8);
+    lo = (block32_t)(p->lo ^ mid_lo);
+    hi = (block32_t)(p->hi ^ mid_hi);
+
+    /* Shift the 256-bit product left by one bit. */
+    carry_lo = lo >> 31;
+    carry_hi = hi >> 31;
+    carry_mid = carry_lo;
+    PSRLDQ(carry_mid, 12);
+    PSLLDQ(carry_hi, 4);
+    PSLLDQ(carry_lo, 4);
+    lo = (lo << 1) | carry_lo;
+    hi = (hi << 1) | carry_hi | carry_mid;
+
+    /* First phase of the reduction. */
+    t = (lo << 31) ^ (lo << 30) ^ (lo << 25);
+    u = t;
+    PSRLDQ(u, 4);
+    PSLLDQ(t, 12);
+    lo ^= t;
+
+    /* Second phase of the reduction. */
+    t = (lo >> 1) ^ (lo >> 2) ^ (lo >> 7) ^ u;
+    lo ^= t;
+
+    return (block_t)(hi ^ lo);
+}
+
+OE_INLINE block_t _gfmul(block_t a, block_t b)
+{
+    product_t p = {{0}, {0}, {0}};
+
+    _multiply_add(&p, a, b);
+    return _reduce(&p);
+}
+
+OE_INLINE block_t _round_key(const oe_aesni_gcm_key_t* key, uint32_t round)
+{
+    return _load(key->round_keys[round]);
+}
+
+OE_INLINE block_t _h_power(const oe_aesni_gcm_key_t* key, uint32_t power)
+{
+    return _load(key->h_powers[power - 1]);
+}
+
+static block_t _encrypt_block(const oe_aesni_gcm_key_t* key, block_t b)
+{
+    b ^= _round_key(key, 0);
+
+    for (uint32_t round = 1; round < key->rounds; round++)
+        b = _aesenc(b, _round_key(key, round));
+
+    return _aesenclast(b, _round_key(key, key->rounds));
+}
+
+/*
+ * Apply a statement to each of eight blocks. The loops over the blocks are
+ * written out so that the blocks are kept in registers.
+ */
+#define FOR_EACH_BLOCK(statement)                                  \
+    statement(0) statement(1) statement(2) statement(3) statement(4) \
+        statement(5) statement(6) statement(7)
+
+/* Encrypt the byte-reversed counter blocks ctr + 1 ... ctr + 8. */
+static void _encrypt_counters8(
+    const oe_aesni_gcm_key_t* key,
+    block32_t ctr,
+    block_t b[8])
+{
+    block_t round_key = _round_key(key, 0);
+
+#define COUNTER(i)                                              \
+    b[i] = _bswap((block_t)(ctr + (block32_t){i + 1, 0, 0, 0})) ^ \
+           round_key;
+#define AESENC(i) b[i] = _aesenc(b[i], round_key);
+#define AESENCLAST(i) b[i] = _aesenclast(b[i], round_key);
+
+    FOR_EACH_BLOCK(COUNTER)
+
+    for (uint32_t round = 1; round < key->rounds; round++)
+    {
+        round_key = _round_key(key, round);
+        FOR_EACH_BLOCK(AESENC)
+    }
+
+    round_key = _round_key(key, key->rounds);
+    FOR_EACH_BLOCK(AESENCLAST)
+
+#undef COUNTER
+#undef AESENC
+#undef AESENCLAST
+}
+
+/* Add eight blocks to the (byte-reversed) GHASH state. */
+static block_t _ghash8(
+    const oe_aesni_gcm_key_t* key,
+    block_t state,
+    const block_t b[8])
+{
+    product_t p = {{0}, {0}, {0}};
+    block_t x[8];
+
+#define BSWAP(i) x[i] = _bswap(b[i]);
+#define MULTIPLY_ADD(i) _multiply_add(&p, x[i], _h_power(key, 8 - i));
+
+    FOR_EACH_BLOCK(BSWAP)
+    x[0] ^= state;
+    FOR_EACH_BLOCK(MULTIPLY_ADD)
+
+#undef BSWAP
+
+#undef MULTIPLY_ADD
+
+    return _reduce(&p);
+}
+
+/* Add the zero-padded data to the GHASH state. */
+static block_t _ghash(
+    const oe_aesni_gcm_key_t* key,
+    block_t state,
+    const uint8_t* data,
+    size_t size)
+{
+    block_t b[8];
+    uint8_t last[16] = {0};
+
+    for (; size >= sizeof(b); data += sizeof(b), size -= sizeof(b))
+    {
+#define LOAD(i) b[i] = _load(data + 16 * i);
+        FOR_EACH_BLOCK(LOAD)
+#undef LOAD
+
+        state = _ghash8(key, state, b);
+    }
+
+    for (; size >= 16; data += 16, size -= 16)
+        state = _gfmul(state ^ _bswap(_load(data)), _h_power(key, 1));
+
+    if (size)
+    {
+        memcpy(last, data, size);
+        state = _gfmul(state ^ _bswap(_load(last)), _h_power(key, 1));
+    }
+
+    return state;
+}
+
+bool oe_aesni_gcm_is_supported(void)
+{
+    return oe_has_cpuid_feature(
+        1,
+        OE_CPUID_AESNI_FEATURE | PCLMULQDQ_FEATURE | SSSE3_FEATURE,
+        OE_CPUID_RCX);
+}
+
+void oe_aesni_gcm_init(
+    oe_aesni_gcm_key_t* key,
+    const uint8_t* key_bytes,
+    size_t key_size)
+{
+    block_t h;
+    block_t power;
+
+    memset(key, 0, sizeof(*key));
+    key->rounds = (uint32_t)key_size / 4 + 6;
+    mbedtls_aesni_setkey_enc(
+        &key->round_keys[0][0], key_bytes, key_size * 8);
+
+    /* H is the encryption of the zero block. */
+    h = _bswap(_encrypt_block(key, (block_t){0, 0}));
+    power = h;
+    _store(key->h_powers[0], h);
+
+    for (size_t i = 1; i < OE_AESNI_GCM_H_POWERS; i++)
+    {
+        power = _gfmul(power, h);
+        _store(key->h_powers[i], power);
+    }
+}
+
+/*
+ * Encrypt or decrypt with counter mode and hash the ciphertext. Returns the
+ * byte-reversed GHASH state and sets j0 to the initial counter block.
+ */
+static block_t _crypt(
+    const oe_aesni_gcm_key_t* key,
+    bool encrypt,
+    const uint8_t* iv,
+    size_t iv_size,
+    const uint8_t* aad,
+    size_t aad_size,
+    const uint8_t* input,
+    size_t size,
+    uint8_t* output,
+    block_t* j0)
+{
+    block_t state = {0, 0};
+    block32_t ctr;
+    block_t b[8];
+    block_t c[8];
+    uint8_t last[16];
+    uint8_t lengths[16];
+    uint64_t aad_bits = (uint64_t)aad_size * 8;
+    uint64_t bits = (uint64_t)size * 8;
+
+    /* J0 is IV || 0^31 || 1 for 96-bit IVs and the GHASH of the IV else. */
+    if (iv_size == 12)
+    {
+        memset(last, 0, sizeof(last));
+        memcpy(last, iv, iv_size);
+        last[15] = 1;
+        ctr = (block32_t)_bswap(_load(last));
+    }
+    else
+    {
+        uint64_t iv_bits = (uint64_t)iv_size * 8;
+
+        memset(lengths, 0, sizeof(lengths));
+        for (size_t i = 0; i < 8; i++)
+            lengths[15 - i] = (uint8_t)(iv_bits >> (8 * i));
+
+        ctr = (block32_t)_ghash(key, state, iv, iv_size);
+        ctr = (block32_t)_ghash(key, (block_t)ctr, lengths, sizeof(lengths));
+    }
+
+    *j0 = _bswap((block_t)ctr);
+    state = _ghash(key, state, aad, aad_size);
+
+    for (; size >= sizeof(b); input += sizeof(b), output += sizeof(b))
+    {
+        _encrypt_counters8(key, ctr, b);
+        ctr += (block32_t){8, 0, 0, 0};
+
+#define XOR(i)                     \
+    c[i] = _load(input + 16 * i);  \
+    b[i] ^= c[i];                  \
+    _store(output + 16 * i, b[i]); \
+    if (encrypt)                   \
+        c[i] = b[i];
+
+        FOR_EACH_BLOCK(XOR)
+
+#undef XOR
+
+        state = _ghash8(key, state, c);
+        size -= sizeof(b);
+    }
+
+    for (; size; input += 16, output += 16)
+    {
+        size_t n = size < 16 ? size : 16;
+        block_t keystream;
+        block_t in;
+
+        ctr += _one;
+        keystream = _encrypt_block(key, _bswap((block_t)ctr));
+
+        memset(last, 0, sizeof(last));
+        memcpy(last, input, n);
+        in = _load(last);
+
+        _store(last, in ^ keystream);
+        memcpy(output, last, n);
+
+        /* Hash the zero-padded ciphertext. */
+        if (encrypt)
+            memset(last + n, 0, sizeof(last) - n);
+        else
+            _store(last, in);
+
+        state = _gfmul(state ^ _bswap(_load(last)), _h_power(key, 1));
+        size -= n;
+    }
+
+    for (size_t i = 0; i < 8; i++)
+    {
+        lengths[7 - i] = (uint8_t)(aad_bits >> (8 * i));
+        lengths[15 - i] = (uint8_t)(bits >> (8 * i));
+    }
+
+    return _gfmul(state ^ _bswap(_load(lengths)), _h_power(key, 1));
+}
+
+static void _compute_tag(
+    const oe_aesni_gcm_key_t* key,
+    block_t state,
+    block_t j0,
+    uint8_t tag[16])
+{
+    _store(tag, _bswap(state) ^ _encrypt_block(key, j0));
+}
+
+void oe_aesni_gcm_encrypt(
+    const oe_aesni_gcm_key_t* key,
+    const uint8_t* iv,
+    size_t iv_size,
+    const uint8_t* aad,
+    size_t aad_size,
+    const uint8_t* input,
+    size_t size,
+    uint8_t* output,
+    uint8_t tag[16])
+{
+    block_t j0;
+    block_t state = _crypt(
+        key, true, iv, iv_size, aad, aad_size, input, size, output, &j0);
+
+    _compute_tag(key, state, j0, tag);
+}
+
+bool oe_aesni_gcm_decrypt(
+    const oe_aesni_gcm_key_t* key,
+    const uint8_t* iv,
+    size_t iv_size,
+    const uint8_t* aad,
+    size_t aad_size,
+    const uint8_t* input,
+    size_t size,
+    uint8_t* output,
+    const uint8_t tag[16])
+{
+    block_t j0;
+    uint8_t expected[16];
+    uint8_t diff = 0;
+    block_t state = _crypt(
+        key, false, iv, iv_size, aad, aad_size, input, size, output, &j0);
+
+    _compute_tag(key, state, j0, expected);
+
+    /* Compare in constant time. */
+    for (size_t i = 0; i < sizeof(expected); i++)
+        diff |= (uint8_t)(expected[i] ^ tag[i]);
+
+    if (diff != 0)
+    {
+        memset(output, 0, size);
+        return false;
+    }
+
+    return true;
+}
+
+#endif /* defined(__x86_64__) */
@@ -0,0 +1,85 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_ENCLAVE_CRYPTO_AESNI_GCM_H
+#define _OE_ENCLAVE_CRYPTO_AESNI_GCM_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/types.h>
+
+OE_EXTERNC_BEGIN
+
+/*
+**==============================================================================
+**
+** AES-GCM with AES-NI and PCLMULQDQ (x86-64 only):
+**
+**     Counter mode encrypts eight blocks at a time so that the AESENC
+**     latencies overlap, and GHASH multiplies eight blocks by the powers
+**     H^8 ... H^1 of the hash key before a single reduction. The key schedule
+**     and the powers of H are computed once per key.
+**
+**==============================================================================
+*/
+
+#define OE_AESNI_GCM_MAX_ROUNDS 14
+#define OE_AESNI_GCM_H_POWERS 8
+
+typedef struct _oe_aesni_gcm_key
+{
+    /* The AES encryption round keys. */
+    uint8_t round_keys[OE_AESNI_GCM_MAX_ROUNDS + 1][16];
+
+    /* H^1 ... H^8, byte-reversed for PCLMULQDQ. */
+    uint8_t h_powers[OE_AESNI_GCM_H_POWERS][16];
+
+    uint32_t rounds;
+} oe_aesni_gcm_key_t;
+
+/**
+ * Whether the CPU supports AES-NI, PCLMULQDQ and SSSE3.
+ */
+bool oe_aesni_gcm_is_supported(void);
+
+/**
+ * Expand a 16, 24 or 32 byte key. The caller must check the key size.
+ */
+void oe_aesni_gcm_init(
+    oe_aesni_gcm_key_t* key,
+    const uint8_t* key_bytes,
+    size_t key_size);
+
+/**
+ * Encrypt and authenticate a buffer (see oe_aes_gcm_encrypt()).
+ */
+void oe_aesni_gcm_encrypt(
+    const oe_aesni_gcm_key_t* key,
+    const uint8_t* iv,
+    size_t iv_size,
+    const uint8_t* aad,
+    size_t aad_size,
+    const uint8_t* input,
+    size_t size,
+    uint8_t* output,
+    uint8_t tag[16]);
+
+/**
+ * Authenticate and decrypt a buffer (see oe_aes_gcm_decrypt()).
+ *
+ * @returns false if the tag does not match, in which case the output is
+ *          cleared.
+ */
+bool oe_aesni_gcm_decrypt(
+    const oe_aesni_gcm_key_t* key,
+    const uint8_t* iv,
+    size_t iv_size,
+    const uint8_t* aad,
+    size_t aad_size,
+    const uint8_t* input,
+    size_t size,
+    uint8_t* output,
+    const uint8_t tag[16]);
+
+OE_EXTERNC_END
+
+#endif /* _OE_ENCLAVE_CRYPTO_AESNI_GCM_H */
@@ -238,18 +238,95 @@ static mbedtls_x509_crt* _find_root_cert(mbedtls_x509_crt* chain)
     return p;
 }
 
-/* Return true if the CRL list contains a CRL for this CA. */
-static mbedtls_x509_crl* _crl_list_find_issuer_for_cert(
-    mbedtls_x509_crl* crl_list,
+/* Return true if the CRLs contain a CRL for this CA. */
+static bool _crls_find_issuer_for_cert(
+    const oe_crl_t* const* crls,
+    size_t num_crls,
     mbedtls_x509_crt* crt)
 {
-    for (mbedtls_x509_crl* p = crl_list; p; p = p->next)
+    for (size_t i = 0; i < num_crls; i++)
     {
-        if (_x509_buf_equal(&p->issuer_raw, &crt->subject_raw))
-            return p;
+        const crl_t* crl_impl = (const crl_t*)crls[i];
+
+        if (_x509_buf_equal(&crl_impl->crl->issuer_raw, &crt->subject_raw))
+            return true;
     }
     OE_TRACE_ERROR("CRL list does not contains a CRL for this CA\n");
-    return NULL;
+    return false;
+}
+
+/* Check the certificate against a CRL of its issuer. Several certificates of
+ * the trusted chain may have the issuer's name (such as after a key
+ * rollover), so the CRL is checked with each of them until one has signed
+ * it. */
+static uint32_t _crl_check_issuers(
+    const crl_t* crl_impl,
+    mbedtls_x509_crt* crt,
+    mbedtls_x509_crt* trust_chain)
+{
+    uint32_t flags = MBEDTLS_X509_BADCRL_NOT_TRUSTED;
+
+    for (mbedtls_x509_crt* p = trust_chain; p; p = p->next)
+    {
+        if (!_x509_buf_equal(&p->subject_raw, &crt->issuer_raw))
+            continue;
+
+        flags = crl_check(crl_impl, crt, p);
+
+        if (!(flags & MBEDTLS_X509_BADCRL_NOT_TRUSTED))
+            break;
+    }
+
+    return flags;
+}
+
+/* Check the certificate against the CRLs of its issuer in the trusted chain,
+ * as mbedtls_x509_crt_verify() does when it is given the CRLs, and return the
+ * resulting verification flags. */
+static uint32_t _crls_check_cert(
+    const oe_crl_t* const* crls,
+    size_t num_crls,
+    mbedtls_x509_crt* crt,
+    mbedtls_x509_crt* trust_chain)
+{
+    mbedtls_x509_crt* issuer;
+    uint32_t flags = 0;
+
+    /* Trusted self-signed certificates are not checked */
+    if (_x509_buf_equal(&crt->issuer_raw, &crt->subject_raw))
+    {
+        for (mbedtls_x509_crt* p = trust_chain; p; p = p->next)
+        {
+            if (_x509_buf_equal(&p->raw, &crt->raw))
+                return 0;
+        }
+    }
+
+    for (issuer = trust_chain; issuer; issuer = issuer->next)
+    {
+        if (_x509_buf_equal(&issuer->subject_raw, &crt->issuer_raw))
+            break;
+    }
+
+    /* mbedtls_x509_crt_verify() fails without an issuer */
+    if (!issuer)
+        return 0;
+
+    for (size_t i = 0; i < num_crls; i++)
+    {
+        const crl_t* crl_impl = (const crl_t*)crls[i];
+
+        if (!_x509_buf_equal(&crl_impl->crl->issuer_raw, &crt->issuer_raw))
+            continue;
+
+        flags |= _crl_check_issuers(crl_impl, crt, trust_chain);
+
+        if (flags &
+            (MBEDTLS_X509_BADCRL_NOT_TRUSTED | MBEDTLS_X509_BADCERT_REVOKED))
+            break;
+    }
+
+    return flags;
 }
 
 /**
@@ -321,16 +398,23 @@ static mbedtls_x509_crt* _sort_certs_by_issue_date(mbedtls_x509_crt* chain)
     return sorted;
 }
 
-/* Call mbedlts_x509_crt_verify and handle error logging */
+/* Call mbedlts_x509_crt_verify and handle error logging. The CRLs are not
+ * passed to mbedtls, which would search them linearly and hash them for every
+ * certificate: they are checked by _crls_check_cert(). */
 static oe_result_t _mbedtls_x509_crt_verify(
     mbedtls_x509_crt* leaf_cert,
     mbedtls_x509_crt* ca_cert_chain,
-    mbedtls_x509_crl* ca_crls)
+    const oe_crl_t* const* crls,
+    size_t num_crls)
 {
     oe_result_t result = OE_UNEXPECTED;
     uint32_t flags = 0;
-    if (mbedtls_x509_crt_verify(
-            leaf_cert, ca_cert_chain, ca_crls, NULL, &flags, NULL, NULL) != 0)
+    int rc = mbedtls_x509_crt_verify(
+        leaf_cert, ca_cert_chain, NULL, NULL, &flags, NULL, NULL);
+
+    flags |= _crls_check_cert(crls, num_crls, leaf_cert, ca_cert_chain);
+
+    if (rc != 0 || flags != 0)
     {
         char error[1024] = {0};
         mbedtls_x509_crt_verify_info(error, sizeof(error), "", flags);
@@ -375,7 +459,7 @@ static oe_result_t _verify_whole_chain(mbedtls_x509_crt* chain)
         mbedtls_x509_crt* subchain = p->next;
 
         /* Verify the next certificate against its following predecessors */
-        OE_CHECK(_mbedtls_x509_crt_verify(p, subchain, NULL));
+        OE_CHECK(_mbedtls_x509_crt_verify(p, subchain, NULL, 0));
 
         /* If the final certificate is not the root */
         if (subchain->next == NULL && root != subchain)
@@ -800,7 +884,7 @@ oe_result_t oe_cert_verify(
     oe_result_t result = OE_UNEXPECTED;
     Cert* cert_impl = (Cert*)cert;
     CertChain* chain_impl = (CertChain*)chain;
-    mbedtls_x509_crl* crl_list = NULL;
+    mbedtls_x509_crt* trust_chain;
 
     /* Reject invalid certificate */
     if (!_cert_is_valid(cert_impl))
@@ -814,46 +898,22 @@ oe_result_t oe_cert_verify(
         OE_RAISE_MSG(OE_INVALID_PARAMETER, "Invalid chain parameter", NULL);
     }
 
-    // Build the list of CRLS if any. Copy them onto auxiliary memory
-    // to avoid modifying them when putting them on the list.
-    if (crls && num_crls)
-    {
-        mbedtls_x509_crl* last = NULL;
-
-        for (size_t i = 0; i < num_crls; i++)
-        {
-            const crl_t* crl_impl = (crl_t*)crls[i];
-            mbedtls_x509_crl* p;
-
-            if (!crl_is_valid(crl_impl))
-                OE_RAISE_MSG(
-                    OE_INVALID_PARAMETER, "Invalid crls parameter", NULL);
-
-            if (!(p = malloc(sizeof(mbedtls_x509_crl))))
-                OE_RAISE(OE_OUT_OF_MEMORY);
+    // Check the CRLs if any.
+    if (!crls)
+        num_crls = 0;
 
-            OE_CHECK(oe_memcpy_s(
-                p, sizeof(*p), crl_impl->crl, sizeof(mbedtls_x509_crl)));
-
-            /* Append to the linked-list */
-            {
-                p->next = NULL;
-
-                if (crl_list)
-                    last->next = p;
-                else
-                    crl_list = p;
-            }
-
-            last = p;
-        }
+    for (size_t i = 0; i < num_crls; i++)
+    {
+        if (!crl_is_valid((const crl_t*)crls[i]))
+            OE_RAISE_MSG(OE_INVALID_PARAMETER, "Invalid crls parameter", NULL);
     }
 
+    trust_chain =
+        (chain != NULL) ? chain_impl->referent->crt : cert_impl->cert;
+
     /* Verify the certificate */
     OE_CHECK(_mbedtls_x509_crt_verify(
-        cert_impl->cert,
-        (chain != NULL) ? chain_impl->referent->crt : cert_impl->cert,
-        crl_list));
+        cert_impl->cert, trust_chain, crls, num_crls));
 
     if (chain)
     {
@@ -861,15 +921,12 @@ oe_result_t oe_cert_verify(
         for (mbedtls_x509_crt* p = chain_impl->referent->crt; p; p = p->next)
         {
             /* Verify the current certificate in the chain. */
-            OE_CHECK(_mbedtls_x509_crt_verify(
-                p,
-                ((chain != NULL) ? chain_impl->referent->crt : NULL),
-                crl_list));
+            OE_CHECK(_mbedtls_x509_crt_verify(p, trust_chain, crls, num_crls));
 
             /* Verify that the CRL list has an issuer for this certificate. */
-            if (crl_list)
+            if (num_crls)
             {
-                if (!_crl_list_find_issuer_for_cert(crl_list, p))
+                if (!_crls_find_issuer_for_cert(crls, num_crls, p))
                 {
                     OE_RAISE_MSG(
                         OE_VERIFY_CRL_MISSING,
@@ -882,18 +939,6 @@ oe_result_t oe_cert_verify(
     result = OE_OK;
 
 done:
-
-    if (crl_list)
-    {
-        /* Free the linked list of CRL objects */
-        for (mbedtls_x509_crl* p = crl_list; p;)
-        {
-            mbedtls_x509_crl* next = p->next;
-            free(p);
-            p = next;
-        }
-    }
-
     return result;
 }
 
@@ -2,12 +2,16 @@
 // Licensed under the MIT License.
 
 #include "crl.h"
+#include <mbedtls/md.h>
 #include <mbedtls/platform.h>
+#include <mbedtls/sha256.h>
 #include <openenclave/bits/safecrt.h>
 #include <openenclave/internal/crypto/crl.h>
 #include <openenclave/internal/print.h>
 #include <openenclave/internal/raise.h>
+#include <openenclave/internal/thread.h>
 #include <openenclave/internal/utils.h>
+#include <stdlib.h>
 #include <string.h>
 
 /* Randomly generated magic number */
@@ -15,19 +19,245 @@
 
 OE_STATIC_ASSERT(sizeof(crl_t) <= sizeof(oe_crl_t));
 
-OE_INLINE void _crl_init(crl_t* impl, mbedtls_x509_crl* crl)
+/*
+**==============================================================================
+**
+** crl_index_t:
+**
+**     Verifying a certificate against a CRL with mbedtls searches the revoked
+**     entries linearly and hashes the whole CRL to check its signature, every
+**     time. Instead, the revoked entries are sorted by serial number and the
+**     CRL is hashed once when it is read, and the CA that last verified its
+**     signature is remembered, so that checking a certificate against a CRL
+**     that is kept across verifications is a binary search.
+**
+**==============================================================================
+*/
+
+struct _crl_index
+{
+    /* The revoked entries, sorted by serial number */
+    const mbedtls_x509_crl_entry** entries;
+    size_t num_entries;
+
+    /* The hash of the signed part of the CRL (zero-sized if the CRL uses an
+     * unsupported hash algorithm) */
+    uint8_t tbs_hash[MBEDTLS_MD_MAX_SIZE];
+    size_t tbs_hash_size;
+
+    /* The hash of the CA certificate that verified the signature */
+    oe_spinlock_t lock;
+    bool signer_verified;
+    uint8_t signer_hash[32];
+};
+
+OE_INLINE void _crl_init(crl_t* impl, mbedtls_x509_crl* crl, crl_index_t* index)
 {
     impl->magic = OE_CRL_MAGIC;
     impl->crl = crl;
+    impl->index = index;
 }
 
 bool crl_is_valid(const crl_t* impl)
 {
-    return impl && (impl->magic == OE_CRL_MAGIC) && impl->crl;
+    return impl && (impl->magic == OE_CRL_MAGIC) && impl->crl && impl->index;
+}
+
+/* Order serial numbers by length and then by value. Like mbedtls, serial
+ * numbers are equal only if their encodings are. */
+static int _compare_serials(
+    const mbedtls_x509_buf* serial1,
+    const mbedtls_x509_buf* serial2)
+{
+    if (serial1->len != serial2->len)
+        return serial1->len < serial2->len ? -1 : 1;
+
+    return memcmp(serial1->p, serial2->p, serial1->len);
+}
+
+static int _compare_entries(const void* entry1, const void* entry2)
+{
+    return _compare_serials(
+        &(*(const mbedtls_x509_crl_entry* const*)entry1)->serial,
+        &(*(const mbedtls_x509_crl_entry* const*)entry2)->serial);
+}
+
+static void _index_free(crl_index_t* index)
+{
+    if (index)
+    {
+        mbedtls_free(index->entries);
+        memset(index, 0, sizeof(crl_index_t));
+        mbedtls_free(index);
+    }
+}
+
+static oe_result_t _index_new(const mbedtls_x509_crl* crl, crl_index_t** out)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    crl_index_t* index = NULL;
+    const mbedtls_x509_crl_entry* entry;
+    const mbedtls_md_info_t* md_info;
+    size_t num_entries = 0;
+
+    *out = NULL;
+
+    if (!(index = mbedtls_calloc(1, sizeof(crl_index_t))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    /* A CRL without revoked entries has an empty first entry */
+    for (entry = &crl->entry; entry && entry->serial.len; entry = entry->next)
+        num_entries++;
+
+    if (num_entries)
+    {
+        if (!(index->entries =
+                  mbedtls_calloc(num_entries, sizeof(*index->entries))))
+            OE_RAISE(OE_OUT_OF_MEMORY);
+
+        for (entry = &crl->entry; entry && entry->serial.len;
+             entry = entry->next)
+            index->entries[index->num_entries++] = entry;
+
+        qsort(
+            index->entries,
+            index->num_entries,
+            sizeof(*index->entries),
+            _compare_entries);
+    }
+
+    if ((md_info = mbedtls_md_info_from_type(crl->sig_md)) &&
+        mbedtls_md(md_info, crl->tbs.p, crl->tbs.len, index->tbs_hash) == 0)
+    {
+        index->tbs_hash_size = mbedtls_md_get_size(md_info);
+    }
+
+    *out = index;
+    index = NULL;
+    result = OE_OK;
+
+done:
+    _index_free(index);
+    return result;
+}
+
+static bool _index_is_revoked(
+    const crl_index_t* index,
+    const mbedtls_x509_buf* serial)
+{
+    size_t low = 0;
+    size_t high = index->num_entries;
+
+    /* Find the first entry whose serial number is not less than serial */
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+
+        if (_compare_serials(&index->entries[middle]->serial, serial) < 0)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    /* A serial number can be listed more than once. As in mbedtls, an entry
+     * only revokes the certificate once its revocation date has passed. */
+    for (; low < index->num_entries &&
+           _compare_serials(&index->entries[low]->serial, serial) == 0;
+         low++)
+    {
+        if (mbedtls_x509_time_is_past(&index->entries[low]->revocation_date))
+            return true;
+    }
+
+    return false;
+}
+
+/* Return true if the CA signed the CRL. */
+static bool _crl_is_signed_by(const crl_t* impl, mbedtls_x509_crt* ca)
+{
+    crl_index_t* index = impl->index;
+    const mbedtls_x509_crl* crl = impl->crl;
+    uint8_t signer_hash[sizeof(index->signer_hash)];
+    bool verified;
+
+    if (index->tbs_hash_size == 0)
+        return false;
+
+    if (mbedtls_sha256_ret(ca->raw.p, ca->raw.len, signer_hash, 0) != 0)
+        return false;
+
+    oe_spin_lock(&index->lock);
+    verified =
+        index->signer_verified &&
+        memcmp(index->signer_hash, signer_hash, sizeof(signer_hash)) == 0;
+    oe_spin_unlock(&index->lock);
+
+    if (verified)
+        return true;
+
+    if (mbedtls_pk_verify_ext(
+            crl->sig_pk,
+            crl->sig_opts,
+            &ca->pk,
+            crl->sig_md,
+            index->tbs_hash,
+            index->tbs_hash_size,
+            crl->sig.p,
+            crl->sig.len) != 0)
+    {
+        return false;
+    }
+
+    oe_spin_lock(&index->lock);
+    memcpy(index->signer_hash, signer_hash, sizeof(signer_hash));
+    index->signer_verified = true;
+    oe_spin_unlock(&index->lock);
+
+    return true;
+}
+
+/* This follows x509_crt_verifycrl() in mbedtls, for a single CRL. */
+uint32_t crl_check(
+    const crl_t* impl,
+    const mbedtls_x509_crt* crt,
+    mbedtls_x509_crt* ca)
+{
+    const mbedtls_x509_crt_profile* profile = &mbedtls_x509_crt_profile_default;
+    const mbedtls_x509_crl* crl = impl->crl;
+    uint32_t flags = 0;
+
+#if defined(MBEDTLS_X509_CHECK_KEY_USAGE)
+    if (mbedtls_x509_crt_check_key_usage(ca, MBEDTLS_X509_KU_CRL_SIGN) != 0)
+        return MBEDTLS_X509_BADCRL_NOT_TRUSTED;
+#endif
+
+    if (crl->sig_md == MBEDTLS_MD_NONE ||
+        !(profile->allowed_mds & (uint32_t)MBEDTLS_X509_ID_FLAG(crl->sig_md)))
+        flags |= MBEDTLS_X509_BADCRL_BAD_MD;
+
+    if (crl->sig_pk == MBEDTLS_PK_NONE ||
+        !(profile->allowed_pks & (uint32_t)MBEDTLS_X509_ID_FLAG(crl->sig_pk)))
+        flags |= MBEDTLS_X509_BADCRL_BAD_PK;
+
+    /* The key of the CA is checked when the certificate is verified */
+    if (!_crl_is_signed_by(impl, ca))
+        return flags | MBEDTLS_X509_BADCRL_NOT_TRUSTED;
+
+    if (mbedtls_x509_time_is_past(&crl->next_update))
+        flags |= MBEDTLS_X509_BADCRL_EXPIRED;
+
+    if (mbedtls_x509_time_is_future(&crl->this_update))
+        flags |= MBEDTLS_X509_BADCRL_FUTURE;
+
+    if (_index_is_revoked(impl->index, &crt->serial))
+        flags |= MBEDTLS_X509_BADCERT_REVOKED;
+
+    return flags;
 }
 
 OE_INLINE void _crl_free(crl_t* impl)
 {
+    _index_free(impl->index);
     mbedtls_x509_crl_free(impl->crl);
     memset(impl->crl, 0, sizeof(mbedtls_x509_crl));
     mbedtls_free(impl->crl);
@@ -42,6 +272,7 @@ oe_result_t oe_crl_read_der(
     oe_result_t result = OE_UNEXPECTED;
     crl_t* impl = (crl_t*)crl;
     mbedtls_x509_crl* x509_crl = NULL;
+    crl_index_t* index = NULL;
     int rc = 0;
 
     /* Clear the implementation */
@@ -64,8 +295,10 @@ oe_result_t oe_crl_read_der(
     if (rc != 0)
         OE_RAISE_MSG(OE_CRYPTO_ERROR, "rc = 0x%x\n", rc);
 
+    OE_CHECK(_index_new(x509_crl, &index));
+
     /* Initialize the implementation */
-    _crl_init(impl, x509_crl);
+    _crl_init(impl, x509_crl, index);
     x509_crl = NULL;
 
     result = OE_OK;
@@ -5,15 +5,30 @@
 #define _OE_ENCLAVE_CRL_H
 
 #include <mbedtls/x509_crl.h>
+#include <mbedtls/x509_crt.h>
 
 #include <openenclave/internal/crypto/crl.h>
 
+typedef struct _crl_index crl_index_t;
+
 typedef struct _crl
 {
     uint64_t magic;
     mbedtls_x509_crl* crl;
+
+    /* The revoked entries sorted by serial number, and the hash and signature
+     * check of the CRL, computed once for all verifications */
+    crl_index_t* index;
 } crl_t;
 
 bool crl_is_valid(const crl_t* impl);
 
+/* Check the CRL of the CA for the certificate like mbedtls_x509_crt_verify()
+ * does. Returns the MBEDTLS_X509_BADCRL_* flags, and
+ * MBEDTLS_X509_BADCERT_REVOKED if the CRL revokes the certificate. */
+uint32_t crl_check(
+    const crl_t* impl,
+    const mbedtls_x509_crt* crt,
+    mbedtls_x509_crt* ca);
+
 #endif /* _OE_ENCLAVE_CRL_H */
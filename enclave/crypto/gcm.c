@@ -0,0 +1,228 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <mbedtls/gcm.h>
+
+#include <openenclave/bits/types.h>
+#include <openenclave/internal/crypto/gcm.h>
+#include <openenclave/internal/defs.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/utils.h>
+
+#if defined(__x86_64__)
+#include <openenclave/internal/cpuid.h>
+#include "aesni_gcm.h"
+#endif
+
+typedef struct _oe_aes_gcm_context_impl
+{
+    /* Whether the context uses the AES-NI implementation or mbedtls. */
+    bool aesni;
+    union {
+        mbedtls_gcm_context ctx;
+#if defined(__x86_64__)
+        oe_aesni_gcm_key_t aesni_key;
+#endif
+    } u;
+} oe_aes_gcm_context_impl_t;
+
+OE_STATIC_ASSERT(
+    sizeof(oe_aes_gcm_context_impl_t) <= sizeof(oe_aes_gcm_context_t));
+
+#if defined(__x86_64__)
+/* 1 if AES-NI and PCLMULQDQ are available, 0 if not, -1 if not checked yet. */
+static volatile int _has_aesni = -1;
+
+static bool _use_aesni(void)
+{
+    /* Every feature reads as missing until the CPUID table is initialized,
+     * so the result is only cached after that. */
+    if (_has_aesni < 0)
+    {
+        if (!oe_is_cpuid_initialized())
+            return false;
+
+        _has_aesni = oe_aesni_gcm_is_supported() ? 1 : 0;
+    }
+
+    return _has_aesni != 0;
+}
+#endif
+
+oe_result_t oe_aes_gcm_init(
+    oe_aes_gcm_context_t* context,
+    const uint8_t* key,
+    size_t key_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_aes_gcm_context_impl_t* impl = (oe_aes_gcm_context_impl_t*)context;
+    int rc = 0;
+
+    if (!context || !key)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (key_size != 16 && key_size != 24 && key_size != 32)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+#if defined(__x86_64__)
+    if (_use_aesni())
+    {
+        impl->aesni = true;
+        oe_aesni_gcm_init(&impl->u.aesni_key, key, key_size);
+        result = OE_OK;
+        goto done;
+    }
+#endif
+
+    impl->aesni = false;
+    mbedtls_gcm_init(&impl->u.ctx);
+
+    rc = mbedtls_gcm_setkey(
+        &impl->u.ctx, MBEDTLS_CIPHER_ID_AES, key, (unsigned int)key_size * 8);
+    if (rc != 0)
+    {
+        mbedtls_gcm_free(&impl->u.ctx);
+        OE_RAISE_MSG(OE_CRYPTO_ERROR, "rc = 0x%x\n", rc);
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_aes_gcm_encrypt(
+    oe_aes_gcm_context_t* context,
+    const uint8_t* iv,
+    size_t iv_size,
+    const uint8_t* aad,
+    size_t aad_size,
+    const uint8_t* input,
+    size_t size,
+    uint8_t* output,
+    uint8_t tag[OE_GCM_TAG_SIZE])
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_aes_gcm_context_impl_t* impl = (oe_aes_gcm_context_impl_t*)context;
+    int rc = 0;
+
+    if (!context || !iv || (aad_size && !aad) || (size && !input) ||
+        (size && !output) || !tag)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+#if defined(__x86_64__)
+    if (impl->aesni)
+    {
+        oe_aesni_gcm_encrypt(
+            &impl->u.aesni_key,
+            iv,
+            iv_size,
+            aad,
+            aad_size,
+            input,
+            size,
+            output,
+            tag);
+        result = OE_OK;
+        goto done;
+    }
+#endif
+
+    rc = mbedtls_gcm_crypt_and_tag(
+        &impl->u.ctx,
+        MBEDTLS_GCM_ENCRYPT,
+        size,
+        iv,
+        iv_size,
+        aad,
+        aad_size,
+        input,
+        output,
+        OE_GCM_TAG_SIZE,
+        tag);
+    if (rc != 0)
+        OE_RAISE_MSG(OE_CRYPTO_ERROR, "rc = 0x%x\n", rc);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_aes_gcm_decrypt(
+    oe_aes_gcm_context_t* context,
+    const uint8_t* iv,
+    size_t iv_size,
+    const uint8_t* aad,
+    size_t aad_size,
+    const uint8_t* input,
+    size_t size,
+    uint8_t* output,
+    const uint8_t tag[OE_GCM_TAG_SIZE])
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_aes_gcm_context_impl_t* impl = (oe_aes_gcm_context_impl_t*)context;
+    int rc = 0;
+
+    if (!context || !iv || (aad_size && !aad) || (size && !input) ||
+        (size && !output) || !tag)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* Authentication failures are expected (e.g., tampered host data), so
+     * they are reported without tracing. */
+#if defined(__x86_64__)
+    if (impl->aesni)
+    {
+        result = OE_CRYPTO_ERROR;
+        if (oe_aesni_gcm_decrypt(
+                &impl->u.aesni_key,
+                iv,
+                iv_size,
+                aad,
+                aad_size,
+                input,
+                size,
+                output,
+                tag))
+            result = OE_OK;
+        goto done;
+    }
+#endif
+
+    rc = mbedtls_gcm_auth_decrypt(
+        &impl->u.ctx,
+        size,
+        iv,
+        iv_size,
+        aad,
+        aad_size,
+        tag,
+        OE_GCM_TAG_SIZE,
+        input,
+        output);
+    if (rc == MBEDTLS_ERR_GCM_AUTH_FAILED)
+    {
+        result = OE_CRYPTO_ERROR;
+        goto done;
+    }
+    else if (rc != 0)
+        OE_RAISE_MSG(OE_CRYPTO_ERROR, "rc = 0x%x\n", rc);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+void oe_aes_gcm_free(oe_aes_gcm_context_t* context)
+{
+    oe_aes_gcm_context_impl_t* impl = (oe_aes_gcm_context_impl_t*)context;
+
+    if (!context)
+        return;
+
+    if (impl->aesni)
+        oe_secure_zero_fill(impl, sizeof(*impl));
+    else
+        mbedtls_gcm_free(&impl->u.ctx);
+}
@@ -7,6 +7,11 @@
 #include <openenclave/internal/crypto/sha.h>
 #include <openenclave/internal/defs.h>
 #include <openenclave/internal/raise.h>
+#include <string.h>
+
+#if defined(__x86_64__)
+#include <openenclave/internal/cpuid.h>
+#endif
 
 typedef struct _oe_sha256_context_impl
 {
@@ -77,3 +82,307 @@ oe_result_t oe_sha256_final(oe_sha256_context_t* context, OE_SHA256* sha256)
 done:
     return result;
 }
+
+static oe_result_t _sha256(const void* data, size_t size, OE_SHA256* hash)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sha256_context_t context;
+
+    OE_CHECK(oe_sha256_init(&context));
+    if (size)
+        OE_CHECK(oe_sha256_update(&context, data, size));
+    OE_CHECK(oe_sha256_final(&context, hash));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+#if defined(__x86_64__)
+
+/*
+**==============================================================================
+**
+** Multi-buffer SHA-256 with AVX2:
+**
+**     Each 32-bit lane of the 256-bit vectors holds the state of a different
+**     message, so that eight messages are hashed with the instructions needed
+**     for one. A lane that finishes its message takes the next one. This pays
+**     off for many small messages on CPUs without the SHA extensions, which
+**     hash a single message faster (see mbedtls_sha256_process.c).
+**
+**==============================================================================
+*/
+
+#define SHA256_LANES 8
+
+/* Use the multi-buffer code for at least this many messages. */
+#define SHA256_MIN_LANES 4
+
+typedef uint32_t sha256_lanes_t __attribute__((vector_size(32)));
+
+typedef struct _sha256_lane
+{
+    /* Index of the message or OE_SIZE_MAX if the lane is idle. */
+    size_t message;
+    size_t block;
+    size_t blocks;
+    uint8_t padding[64];
+} sha256_lane_t;
+
+static const uint32_t _sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+static const uint32_t _sha256_iv[8] = {0x6a09e667,
+                                       0xbb67ae85,
+                                       0x3c6ef372,
+                                       0xa54ff53a,
+                                       0x510e527f,
+                                       0x9b05688c,
+                                       0x1f83d9ab,
+                                       0x5be0cd19};
+
+static const uint8_t _zero_block[64];
+
+/* 1 if the multi-buffer code is used, 0 if not, -1 if not checked yet. */
+static volatile int _use_sha256_lanes = -1;
+
+static bool _can_use_sha256_lanes(void)
+{
+    uint32_t xcr0_low;
+    uint32_t xcr0_high;
+
+    // Prefer the SHA extensions, which mbedtls uses for each message.
+    if (oe_has_cpuid_feature(7, OE_CPUID_SHA_FEATURE, OE_CPUID_RBX))
+        return false;
+
+    if (!oe_has_cpuid_feature(1, OE_CPUID_OSXSAVE_FEATURE, OE_CPUID_RCX) ||
+        !oe_has_cpuid_feature(7, OE_CPUID_AVX2_FEATURE, OE_CPUID_RBX))
+        return false;
+
+    // The enclave's XFRM must enable the SSE and AVX state.
+    asm volatile("xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0));
+    OE_UNUSED(xcr0_high);
+
+    return (xcr0_low & 0x6) == 0x6;
+}
+
+static uint32_t _load_be32(const uint8_t* p)
+{
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 |
+           (uint32_t)p[3];
+}
+
+/* Start hashing the next message in the lane or make the lane idle. */
+static void _start_lane(
+    sha256_lane_t* lane,
+    const size_t* sizes,
+    size_t count,
+    size_t* next)
+{
+    if (*next == count)
+    {
+        lane->message = OE_SIZE_MAX;
+        return;
+    }
+
+    lane->message = (*next)++;
+    lane->block = 0;
+    lane->blocks = (sizes[lane->message] + 9 + 63) / 64;
+}
+
+/* Get the next block of the message in the lane, padding it as needed. */
+static const uint8_t* _get_lane_block(
+    sha256_lane_t* lane,
+    const void* const* data,
+    const size_t* sizes)
+{
+    const uint8_t* message;
+    size_t size;
+    size_t offset;
+
+    if (lane->message == OE_SIZE_MAX)
+        return _zero_block;
+
+    message = (const uint8_t*)data[lane->message];
+    size = sizes[lane->message];
+    offset = lane->block * 64;
+
+    if (size >= offset + 64)
+        return message + offset;
+
+    memset(lane->padding, 0, sizeof(lane->padding));
+
+    if (size > offset)
+        memcpy(lane->padding, message + offset, size - offset);
+
+    if (size >= offset)
+        lane->padding[size - offset] = 0x80;
+
+    if (lane->block + 1 == lane->blocks)
+    {
+        uint64_t bits = (uint64_t)size * 8;
+
+        for (size_t i = 0; i < 8; i++)
+            lane->padding[63 - i] = (uint8_t)(bits >> (8 * i));
+    }
+
+    return lane->padding;
+}
+
+#define SHA256_ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define SHA256_S0(x) (SHA256_ROTR(x, 7) ^ SHA256_ROTR(x, 18) ^ ((x) >> 3))
+#define SHA256_S1(x) (SHA256_ROTR(x, 17) ^ SHA256_ROTR(x, 19) ^ ((x) >> 10))
+#define SHA256_S2(x) \
+    (SHA256_ROTR(x, 2) ^ SHA256_ROTR(x, 13) ^ SHA256_ROTR(x, 22))
+#define SHA256_S3(x) \
+    (SHA256_ROTR(x, 6) ^ SHA256_ROTR(x, 11) ^ SHA256_ROTR(x, 25))
+#define SHA256_CH(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
+#define SHA256_MAJ(x, y, z) (((x) & (y)) | ((z) & ((x) | (y))))
+
+__attribute__((target("avx2"))) static void _sha256_lanes(
+    const void* const* data,
+    const size_t* sizes,
+    size_t count,
+    OE_SHA256* hashes)
+{
+    sha256_lane_t lanes[SHA256_LANES];
+    sha256_lanes_t state[8];
+    size_t next = 0;
+    size_t active = 0;
+
+    for (size_t j = 0; j < SHA256_LANES; j++)
+    {
+        _start_lane(&lanes[j], sizes, count, &next);
+        active += lanes[j].message != OE_SIZE_MAX;
+    }
+
+    for (size_t i = 0; i < 8; i++)
+    {
+        for (size_t j = 0; j < SHA256_LANES; j++)
+            state[i][j] = _sha256_iv[i];
+    }
+
+    while (active)
+    {
+        const uint8_t* blocks[SHA256_LANES];
+        sha256_lanes_t w[16];
+        sha256_lanes_t s[8];
+
+        for (size_t j = 0; j < SHA256_LANES; j++)
+            blocks[j] = _get_lane_block(&lanes[j], data, sizes);
+
+        for (size_t i = 0; i < 16; i++)
+        {
+            for (size_t j = 0; j < SHA256_LANES; j++)
+                w[i][j] = _load_be32(blocks[j] + 4 * i);
+        }
+
+        for (size_t i = 0; i < 8; i++)
+            s[i] = state[i];
+
+        for (size_t t = 0; t < 64; t++)
+        {
+            sha256_lanes_t t1;
+            sha256_lanes_t t2;
+
+            if (t >= 16)
+            {
+                w[t & 15] += SHA256_S1(w[(t + 14) & 15]) + w[(t + 9) & 15] +
+                             SHA256_S0(w[(t + 1) & 15]);
+            }
+
+            t1 = s[7] + SHA256_S3(s[4]) + SHA256_CH(s[4], s[5], s[6]) +
+                 _sha256_k[t] + w[t & 15];
+            t2 = SHA256_S2(s[0]) + SHA256_MAJ(s[0], s[1], s[2]);
+
+            s[7] = s[6];
+            s[6] = s[5];
+            s[5] = s[4];
+            s[4] = s[3] + t1;
+            s[3] = s[2];
+            s[2] = s[1];
+            s[1] = s[0];
+            s[0] = t1 + t2;
+        }
+
+        for (size_t i = 0; i < 8; i++)
+            state[i] += s[i];
+
+        // Output the finished messages and refill their lanes.
+        for (size_t j = 0; j < SHA256_LANES; j++)
+        {
+            sha256_lane_t* lane = &lanes[j];
+
+            if (lane->message == OE_SIZE_MAX || ++lane->block < lane->blocks)
+                continue;
+
+            for (size_t i = 0; i < 8; i++)
+            {
+                uint32_t word = state[i][j];
+                uint8_t* p = hashes[lane->message].buf + 4 * i;
+
+                p[0] = (uint8_t)(word >> 24);
+                p[1] = (uint8_t)(word >> 16);
+                p[2] = (uint8_t)(word >> 8);
+                p[3] = (uint8_t)word;
+                state[i][j] = _sha256_iv[i];
+            }
+
+            _start_lane(lane, sizes, count, &next);
+            active -= lane->message == OE_SIZE_MAX;
+        }
+    }
+}
+
+#endif /* defined(__x86_64__) */
+
+oe_result_t oe_sha256_multi(
+    const void* const* data,
+    const size_t* sizes,
+    size_t count,
+    OE_SHA256* hashes)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if ((!data || !sizes || !hashes) && count)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!data[i] && sizes[i])
+            OE_RAISE(OE_INVALID_PARAMETER);
+    }
+
+#if defined(__x86_64__)
+    /* The choice is only made once the CPUID table is initialized. */
+    if (_use_sha256_lanes < 0 && oe_is_cpuid_initialized())
+        _use_sha256_lanes = _can_use_sha256_lanes() ? 1 : 0;
+
+    if (_use_sha256_lanes > 0 && count >= SHA256_MIN_LANES)
+    {
+        _sha256_lanes(data, sizes, count, hashes);
+        result = OE_OK;
+        goto done;
+    }
+#endif
+
+    for (size_t i = 0; i < count; i++)
+        OE_CHECK(_sha256(data[i], sizes[i], &hashes[i]));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
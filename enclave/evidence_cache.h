@@ -0,0 +1,83 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_ENCLAVE_EVIDENCE_CACHE_H
+#define _OE_ENCLAVE_EVIDENCE_CACHE_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/result.h>
+#include <openenclave/bits/types.h>
+
+OE_EXTERNC_BEGIN
+
+/*
+**==============================================================================
+**
+** Evidence cache:
+**
+**     While enabled with oe_set_evidence_cache_freshness(), the remote
+**     reports and attestation certificates generated by the enclave are
+**     reused for the freshness window instead of generating a new quote for
+**     every request. The platform-specific part lives in sgx/ and optee/.
+**
+**==============================================================================
+*/
+
+/**
+ * Get a report like oe_get_report(), reusing a remote report for the same
+ * report data and parameters while the evidence cache is enabled. The report
+ * is freed with oe_free_report().
+ */
+oe_result_t oe_get_report_from_cache(
+    uint32_t flags,
+    const uint8_t* report_data,
+    size_t report_data_size,
+    const void* opt_params,
+    size_t opt_params_size,
+    uint8_t** report_buffer,
+    size_t* report_buffer_size);
+
+/**
+ * Get a copy of the cached attestation certificate generated for the given
+ * subject name and keys.
+ *
+ * @returns OE_NOT_FOUND if there is none or the cache is disabled.
+ */
+oe_result_t oe_get_cached_attestation_certificate(
+    const unsigned char* subject_name,
+    const uint8_t* private_key,
+    size_t private_key_size,
+    const uint8_t* public_key,
+    size_t public_key_size,
+    uint8_t** output_cert,
+    size_t* output_cert_size);
+
+/**
+ * Add an attestation certificate generated for the given subject name and
+ * keys to the cache if it is enabled.
+ */
+void oe_cache_attestation_certificate(
+    const unsigned char* subject_name,
+    const uint8_t* private_key,
+    size_t private_key_size,
+    const uint8_t* public_key,
+    size_t public_key_size,
+    const uint8_t* cert,
+    size_t cert_size);
+
+/**
+ * Generate an attestation certificate with a new quote, bypassing the cache.
+ * Implemented in tls_cert.c.
+ */
+oe_result_t oe_generate_attestation_certificate_uncached(
+    const unsigned char* subject_name,
+    uint8_t* private_key,
+    size_t private_key_size,
+    uint8_t* public_key,
+    size_t public_key_size,
+    uint8_t** output_cert,
+    size_t* output_cert_size);
+
+OE_EXTERNC_END
+
+#endif /* _OE_ENCLAVE_EVIDENCE_CACHE_H */
@@ -0,0 +1,72 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include "../evidence_cache.h"
+#include <openenclave/enclave.h>
+
+oe_result_t oe_get_report_from_cache(
+    uint32_t flags,
+    const uint8_t* report_data,
+    size_t report_data_size,
+    const void* opt_params,
+    size_t opt_params_size,
+    uint8_t** report_buffer,
+    size_t* report_buffer_size)
+{
+    return oe_get_report(
+        flags,
+        report_data,
+        report_data_size,
+        opt_params,
+        opt_params_size,
+        report_buffer,
+        report_buffer_size);
+}
+
+oe_result_t oe_get_cached_attestation_certificate(
+    const unsigned char* subject_name,
+    const uint8_t* private_key,
+    size_t private_key_size,
+    const uint8_t* public_key,
+    size_t public_key_size,
+    uint8_t** output_cert,
+    size_t* output_cert_size)
+{
+    OE_UNUSED(subject_name);
+    OE_UNUSED(private_key);
+    OE_UNUSED(private_key_size);
+    OE_UNUSED(public_key);
+    OE_UNUSED(public_key_size);
+    OE_UNUSED(output_cert);
+    OE_UNUSED(output_cert_size);
+
+    return OE_NOT_FOUND;
+}
+
+void oe_cache_attestation_certificate(
+    const unsigned char* subject_name,
+    const uint8_t* private_key,
+    size_t private_key_size,
+    const uint8_t* public_key,
+    size_t public_key_size,
+    const uint8_t* cert,
+    size_t cert_size)
+{
+    OE_UNUSED(subject_name);
+    OE_UNUSED(private_key);
+    OE_UNUSED(private_key_size);
+    OE_UNUSED(public_key);
+    OE_UNUSED(public_key_size);
+    OE_UNUSED(cert);
+    OE_UNUSED(cert_size);
+}
+
+oe_result_t oe_set_evidence_cache_freshness(uint32_t freshness_seconds)
+{
+    return freshness_seconds ? OE_UNSUPPORTED : OE_OK;
+}
+
+oe_result_t oe_refresh_evidence_cache(void)
+{
+    return OE_OK;
+}
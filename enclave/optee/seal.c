@@ -0,0 +1,113 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+
+oe_result_t oe_seal(
+    oe_seal_policy_t seal_policy,
+    const void* plaintext,
+    size_t plaintext_size,
+    const void* additional_data,
+    size_t additional_data_size,
+    uint8_t* blob,
+    size_t* blob_size)
+{
+    OE_UNUSED(seal_policy);
+    OE_UNUSED(plaintext);
+    OE_UNUSED(plaintext_size);
+    OE_UNUSED(additional_data);
+    OE_UNUSED(additional_data_size);
+    OE_UNUSED(blob);
+    OE_UNUSED(blob_size);
+
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_unseal(
+    const uint8_t* blob,
+    size_t blob_size,
+    const void* additional_data,
+    size_t additional_data_size,
+    uint8_t* plaintext,
+    size_t* plaintext_size)
+{
+    OE_UNUSED(blob);
+    OE_UNUSED(blob_size);
+    OE_UNUSED(additional_data);
+    OE_UNUSED(additional_data_size);
+    OE_UNUSED(plaintext);
+    OE_UNUSED(plaintext_size);
+
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_seal_init(
+    oe_seal_policy_t seal_policy,
+    uint32_t chunk_size,
+    const void* additional_data,
+    size_t additional_data_size,
+    uint8_t header[OE_SEAL_HEADER_SIZE],
+    oe_seal_context_t** context)
+{
+    OE_UNUSED(seal_policy);
+    OE_UNUSED(chunk_size);
+    OE_UNUSED(additional_data);
+    OE_UNUSED(additional_data_size);
+    OE_UNUSED(header);
+    OE_UNUSED(context);
+
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_seal_update(
+    oe_seal_context_t* context,
+    const void* chunk,
+    size_t chunk_size,
+    bool final,
+    uint8_t* output)
+{
+    OE_UNUSED(context);
+    OE_UNUSED(chunk);
+    OE_UNUSED(chunk_size);
+    OE_UNUSED(final);
+    OE_UNUSED(output);
+
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_unseal_init(
+    const uint8_t header[OE_SEAL_HEADER_SIZE],
+    const void* additional_data,
+    size_t additional_data_size,
+    uint32_t* chunk_size,
+    oe_seal_context_t** context)
+{
+    OE_UNUSED(header);
+    OE_UNUSED(additional_data);
+    OE_UNUSED(additional_data_size);
+    OE_UNUSED(chunk_size);
+    OE_UNUSED(context);
+
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_unseal_update(
+    oe_seal_context_t* context,
+    const uint8_t* sealed_chunk,
+    size_t sealed_chunk_size,
+    bool final,
+    uint8_t* output)
+{
+    OE_UNUSED(context);
+    OE_UNUSED(sealed_chunk);
+    OE_UNUSED(sealed_chunk_size);
+    OE_UNUSED(final);
+    OE_UNUSED(output);
+
+    return OE_UNSUPPORTED;
+}
+
+void oe_seal_free(oe_seal_context_t* context)
+{
+    OE_UNUSED(context);
+}
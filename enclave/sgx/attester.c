@@ -14,6 +14,7 @@
 #include <mbedtls/sha256.h>
 
 #include "../common/sgx/endorsements.h"
+#include "../evidence_cache.h"
 
 static oe_result_t _on_register(
     oe_attestation_role_t* context,
@@ -156,9 +157,10 @@ static oe_result_t _get_evidence(
         "SGX Plugin: Failed to serialize claims. %s",
         oe_result_str(result));
 
-    // Get the report with the hash of the claims as the report data.
+    // Get the report with the hash of the claims as the report data. While
+    // the evidence cache is enabled, the same claims reuse the same quote.
     OE_CHECK_MSG(
-        oe_get_report(
+        oe_get_report_from_cache(
             flags,
             hash.buf,
             sizeof(hash.buf),
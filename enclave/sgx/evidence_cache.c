@@ -0,0 +1,531 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include "../evidence_cache.h"
+#include <openenclave/corelibc/stdlib.h>
+#include <openenclave/corelibc/string.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/crypto/sha.h>
+#include <openenclave/internal/datetime.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/report.h>
+#include <openenclave/internal/thread.h>
+#include <openenclave/internal/utils.h>
+#include "../../common/sgx/collateral.h"
+
+/* Seconds for which generated evidence is reused (0 disables the cache). */
+static uint32_t _freshness;
+
+/* The times at which a cache entry is due for a refresh and expires. */
+typedef struct _entry_times
+{
+    oe_datetime_t refresh;
+    oe_datetime_t expiry;
+} entry_times_t;
+
+/* A remote report with the inputs it was generated from. */
+typedef struct _report_entry
+{
+    oe_sgx_collateral_t base;
+    oe_datetime_t refresh;
+    uint32_t flags;
+    uint8_t report_data[OE_REPORT_DATA_SIZE];
+    size_t report_data_size;
+    uint8_t* opt_params;
+    size_t opt_params_size;
+    uint8_t* report;
+    size_t report_size;
+} report_entry_t;
+
+/* An attestation certificate with the inputs it was generated from. */
+typedef struct _cert_entry
+{
+    oe_sgx_collateral_t base;
+    oe_datetime_t refresh;
+    unsigned char* subject_name;
+    uint8_t* private_key;
+    size_t private_key_size;
+    uint8_t* public_key;
+    size_t public_key_size;
+    uint8_t* cert;
+    size_t cert_size;
+} cert_entry_t;
+
+static oe_once_t _atexit_once = OE_ONCE_INIT;
+
+/* Wipe the cached evidence, and the private keys of the certificates, when
+ * the enclave is terminated. */
+static void _clear_evidence_cache(void)
+{
+    oe_sgx_clear_collateral_cache_kind(OE_SGX_COLLATERAL_OWN_REPORT);
+    oe_sgx_clear_collateral_cache_kind(OE_SGX_COLLATERAL_OWN_CERT);
+}
+
+static void _register_atexit(void)
+{
+    oe_atexit(_clear_evidence_cache);
+}
+
+static uint8_t* _copy(const void* data, size_t size)
+{
+    uint8_t* copy;
+
+    if (!data || size == 0)
+        return NULL;
+
+    if ((copy = (uint8_t*)oe_malloc(size)))
+        memcpy(copy, data, size);
+
+    return copy;
+}
+
+/* New entries are refreshed after half of the freshness window. */
+static oe_result_t _get_entry_times(uint32_t freshness, entry_times_t* times)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    OE_CHECK(oe_datetime_from_now(freshness / 2, &times->refresh));
+    OE_CHECK(oe_datetime_from_now(freshness, &times->expiry));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/* Hash a buffer and its size into a cache key. */
+static oe_result_t _hash_item(
+    oe_sha256_context_t* context,
+    const void* data,
+    size_t size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    OE_CHECK(oe_sha256_update(context, &size, sizeof(size)));
+    if (size)
+        OE_CHECK(oe_sha256_update(context, data, size));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+static oe_result_t _get_report_key(
+    uint32_t flags,
+    const uint8_t* report_data,
+    size_t report_data_size,
+    const void* opt_params,
+    size_t opt_params_size,
+    OE_SHA256* key)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sha256_context_t context;
+
+    OE_CHECK(oe_sha256_init(&context));
+    OE_CHECK(oe_sha256_update(&context, &flags, sizeof(flags)));
+    OE_CHECK(_hash_item(&context, report_data, report_data_size));
+    OE_CHECK(_hash_item(&context, opt_params, opt_params_size));
+    OE_CHECK(oe_sha256_final(&context, key));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+static oe_result_t _get_cert_key(
+    const unsigned char* subject_name,
+    const uint8_t* private_key,
+    size_t private_key_size,
+    const uint8_t* public_key,
+    size_t public_key_size,
+    OE_SHA256* key)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sha256_context_t context;
+    size_t subject_name_size =
+        subject_name ? oe_strlen((const char*)subject_name) + 1 : 0;
+
+    OE_CHECK(oe_sha256_init(&context));
+    OE_CHECK(_hash_item(&context, subject_name, subject_name_size));
+    OE_CHECK(_hash_item(&context, private_key, private_key_size));
+    OE_CHECK(_hash_item(&context, public_key, public_key_size));
+    OE_CHECK(oe_sha256_final(&context, key));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+static void _free_report_entry(oe_sgx_collateral_t* collateral)
+{
+    report_entry_t* entry = (report_entry_t*)collateral;
+
+    oe_free(entry->opt_params);
+    oe_free_report(entry->report);
+    oe_free(entry);
+}
+
+static void _free_cert_entry(oe_sgx_collateral_t* collateral)
+{
+    cert_entry_t* entry = (cert_entry_t*)collateral;
+
+    if (entry->private_key)
+        oe_secure_zero_fill(entry->private_key, entry->private_key_size);
+
+    oe_free(entry->subject_name);
+    oe_free(entry->private_key);
+    oe_free(entry->public_key);
+    oe_free(entry->cert);
+    oe_free(entry);
+}
+
+/* Add a copy of a new remote report to the cache. */
+static void _cache_report(
+    uint32_t freshness,
+    const OE_SHA256* key,
+    uint32_t flags,
+    const uint8_t* report_data,
+    size_t report_data_size,
+    const void* opt_params,
+    size_t opt_params_size,
+    const uint8_t* report,
+    size_t report_size)
+{
+    report_entry_t* entry;
+    entry_times_t times;
+
+    if (_get_entry_times(freshness, &times) != OE_OK)
+        return;
+
+    if (!(entry = (report_entry_t*)oe_calloc(1, sizeof(report_entry_t))))
+        return;
+
+    oe_sgx_collateral_init(
+        &entry->base, OE_SGX_COLLATERAL_OWN_REPORT, key, _free_report_entry);
+    entry->base.expiry = times.expiry;
+    entry->refresh = times.refresh;
+    entry->flags = flags;
+    entry->report_data_size = report_data_size;
+    if (report_data_size)
+        memcpy(entry->report_data, report_data, report_data_size);
+    entry->opt_params = _copy(opt_params, opt_params_size);
+    entry->opt_params_size = opt_params_size;
+    entry->report = _copy(report, report_size);
+    entry->report_size = report_size;
+
+    if (entry->report && (entry->opt_params || !opt_params_size))
+    {
+        oe_once(&_atexit_once, _register_atexit);
+        oe_sgx_collateral_cache_insert(&entry->base);
+    }
+
+    oe_sgx_collateral_release(&entry->base);
+}
+
+oe_result_t oe_get_report_from_cache(
+    uint32_t flags,
+    const uint8_t* report_data,
+    size_t report_data_size,
+    const void* opt_params,
+    size_t opt_params_size,
+    uint8_t** report_buffer,
+    size_t* report_buffer_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint32_t freshness = _freshness;
+    report_entry_t* entry = NULL;
+    OE_SHA256 key;
+
+    // Local reports are generated without leaving the enclave, so only
+    // remote reports are worth caching.
+    if (freshness == 0 || flags != OE_REPORT_FLAGS_REMOTE_ATTESTATION ||
+        report_data_size > OE_REPORT_DATA_SIZE ||
+        (!report_data && report_data_size) ||
+        (!opt_params && opt_params_size) || !report_buffer ||
+        !report_buffer_size)
+    {
+        return oe_get_report(
+            flags,
+            report_data,
+            report_data_size,
+            opt_params,
+            opt_params_size,
+            report_buffer,
+            report_buffer_size);
+    }
+
+    OE_CHECK(_get_report_key(
+        flags,
+        report_data,
+        report_data_size,
+        opt_params,
+        opt_params_size,
+        &key));
+
+    entry = (report_entry_t*)oe_sgx_collateral_cache_find(
+        OE_SGX_COLLATERAL_OWN_REPORT, &key);
+    if (entry)
+    {
+        if (!(*report_buffer = _copy(entry->report, entry->report_size)))
+            OE_RAISE(OE_OUT_OF_MEMORY);
+
+        *report_buffer_size = entry->report_size;
+        result = OE_OK;
+        goto done;
+    }
+
+    OE_CHECK(oe_get_report(
+        flags,
+        report_data,
+        report_data_size,
+        opt_params,
+        opt_params_size,
+        report_buffer,
+        report_buffer_size));
+
+    _cache_report(
+        freshness,
+        &key,
+        flags,
+        report_data,
+        report_data_size,
+        opt_params,
+        opt_params_size,
+        *report_buffer,
+        *report_buffer_size);
+
+    result = OE_OK;
+
+done:
+    if (entry)
+        oe_sgx_collateral_release(&entry->base);
+    return result;
+}
+
+oe_result_t oe_get_cached_attestation_certificate(
+    const unsigned char* subject_name,
+    const uint8_t* private_key,
+    size_t private_key_size,
+    const uint8_t* public_key,
+    size_t public_key_size,
+    uint8_t** output_cert,
+    size_t* output_cert_size)
+{
+    oe_result_t result = OE_NOT_FOUND;
+    cert_entry_t* entry = NULL;
+    OE_SHA256 key;
+
+    if (_freshness == 0)
+        goto done;
+
+    OE_CHECK(_get_cert_key(
+        subject_name,
+        private_key,
+        private_key_size,
+        public_key,
+        public_key_size,
+        &key));
+
+    entry = (cert_entry_t*)oe_sgx_collateral_cache_find(
+        OE_SGX_COLLATERAL_OWN_CERT, &key);
+    if (!entry)
+    {
+        result = OE_NOT_FOUND;
+        goto done;
+    }
+
+    if (!(*output_cert = _copy(entry->cert, entry->cert_size)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    *output_cert_size = entry->cert_size;
+    result = OE_OK;
+
+done:
+    if (entry)
+        oe_sgx_collateral_release(&entry->base);
+    return result;
+}
+
+void oe_cache_attestation_certificate(
+    const unsigned char* subject_name,
+    const uint8_t* private_key,
+    size_t private_key_size,
+    const uint8_t* public_key,
+    size_t public_key_size,
+    const uint8_t* cert,
+    size_t cert_size)
+{
+    uint32_t freshness = _freshness;
+    cert_entry_t* entry;
+    entry_times_t times;
+    OE_SHA256 key;
+    size_t subject_name_size =
+        subject_name ? oe_strlen((const char*)subject_name) + 1 : 0;
+
+    if (freshness == 0 || !private_key || !public_key || !cert)
+        return;
+
+    if (_get_cert_key(
+            subject_name,
+            private_key,
+            private_key_size,
+            public_key,
+            public_key_size,
+            &key) != OE_OK)
+        return;
+
+    if (_get_entry_times(freshness, &times) != OE_OK)
+        return;
+
+    if (!(entry = (cert_entry_t*)oe_calloc(1, sizeof(cert_entry_t))))
+        return;
+
+    oe_sgx_collateral_init(
+        &entry->base, OE_SGX_COLLATERAL_OWN_CERT, &key, _free_cert_entry);
+    entry->base.expiry = times.expiry;
+    entry->refresh = times.refresh;
+    entry->subject_name = _copy(subject_name, subject_name_size);
+    entry->private_key = _copy(private_key, private_key_size);
+    entry->private_key_size = private_key_size;
+    entry->public_key = _copy(public_key, public_key_size);
+    entry->public_key_size = public_key_size;
+    entry->cert = _copy(cert, cert_size);
+    entry->cert_size = cert_size;
+
+    if ((entry->subject_name || !subject_name) && entry->private_key &&
+        entry->public_key && entry->cert)
+    {
+        oe_once(&_atexit_once, _register_atexit);
+        oe_sgx_collateral_cache_insert(&entry->base);
+    }
+
+    oe_sgx_collateral_release(&entry->base);
+}
+
+/* Generate a new report for a cached one and replace it in the cache. */
+static oe_result_t _refresh_report(uint32_t freshness, report_entry_t* entry)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint8_t* report = NULL;
+    size_t report_size = 0;
+
+    OE_CHECK(oe_get_report(
+        entry->flags,
+        entry->report_data,
+        entry->report_data_size,
+        entry->opt_params,
+        entry->opt_params_size,
+        &report,
+        &report_size));
+
+    _cache_report(
+        freshness,
+        &entry->base.key,
+        entry->flags,
+        entry->report_data,
+        entry->report_data_size,
+        entry->opt_params,
+        entry->opt_params_size,
+        report,
+        report_size);
+
+    result = OE_OK;
+
+done:
+    oe_free_report(report);
+    return result;
+}
+
+/* Generate a new certificate for a cached one and replace it in the cache. */
+static oe_result_t _refresh_cert(cert_entry_t* entry)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint8_t* cert = NULL;
+    size_t cert_size = 0;
+
+    OE_CHECK(oe_generate_attestation_certificate_uncached(
+        entry->subject_name,
+        entry->private_key,
+        entry->private_key_size,
+        entry->public_key,
+        entry->public_key_size,
+        &cert,
+        &cert_size));
+
+    oe_cache_attestation_certificate(
+        entry->subject_name,
+        entry->private_key,
+        entry->private_key_size,
+        entry->public_key,
+        entry->public_key_size,
+        cert,
+        cert_size);
+
+    result = OE_OK;
+
+done:
+    oe_free_attestation_certificate(cert);
+    return result;
+}
+
+oe_result_t oe_set_evidence_cache_freshness(uint32_t freshness_seconds)
+{
+    _freshness = freshness_seconds;
+
+    // Entries were added with the previous freshness window.
+    oe_sgx_clear_collateral_cache_kind(OE_SGX_COLLATERAL_OWN_REPORT);
+    oe_sgx_clear_collateral_cache_kind(OE_SGX_COLLATERAL_OWN_CERT);
+    return OE_OK;
+}
+
+oe_result_t oe_refresh_evidence_cache(void)
+{
+    oe_result_t result = OE_OK;
+    uint32_t freshness = _freshness;
+    oe_sgx_collateral_t* entries[OE_SGX_COLLATERAL_CACHE_SIZE];
+    size_t count;
+    oe_datetime_t now;
+
+    if (freshness == 0)
+        return OE_OK;
+
+    OE_CHECK(oe_datetime_now(&now));
+
+    // Every entry is regenerated even if another one fails, and the first
+    // failure is returned.
+    count = oe_sgx_collateral_cache_get_all(
+        OE_SGX_COLLATERAL_OWN_REPORT, entries, OE_COUNTOF(entries));
+    for (size_t i = 0; i < count; i++)
+    {
+        report_entry_t* entry = (report_entry_t*)entries[i];
+        oe_result_t entry_result = OE_OK;
+
+        if (oe_datetime_compare(&now, &entry->refresh) >= 0)
+            entry_result = _refresh_report(freshness, entry);
+
+        if (result == OE_OK)
+            result = entry_result;
+        oe_sgx_collateral_release(entries[i]);
+    }
+
+    count = oe_sgx_collateral_cache_get_all(
+        OE_SGX_COLLATERAL_OWN_CERT, entries, OE_COUNTOF(entries));
+    for (size_t i = 0; i < count; i++)
+    {
+        cert_entry_t* entry = (cert_entry_t*)entries[i];
+        oe_result_t entry_result = OE_OK;
+
+        if (oe_datetime_compare(&now, &entry->refresh) >= 0)
+            entry_result = _refresh_cert(entry);
+
+        if (result == OE_OK)
+            result = entry_result;
+        oe_sgx_collateral_release(entries[i]);
+    }
+
+done:
+    return result;
+}
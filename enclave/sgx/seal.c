@@ -0,0 +1,899 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/bits/safemath.h>
+#include <openenclave/corelibc/stdlib.h>
+#include <openenclave/corelibc/string.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/crypto/gcm.h>
+#include <openenclave/internal/crypto/sha.h>
+#include <openenclave/internal/defs.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/sgxkeys.h>
+#include <openenclave/internal/thread.h>
+#include <openenclave/internal/utils.h>
+
+#define SEAL_MAGIC 0x4c45534fu /* "OSEL" */
+#define SEAL_VERSION 1
+
+/*
+ * The number of chunks sealed with a key before it is replaced by a key with
+ * a new random key ID, which keeps the probability of a random nonce being
+ * reused negligible.
+ */
+#define SEAL_KEY_MAX_USES (1u << 24)
+
+/* The number of seal keys whose expanded AES-GCM contexts are cached. */
+#define SEAL_KEY_CACHE_SIZE 8
+
+/* The fields of the key request from which a seal key is derived again. */
+OE_PACK_BEGIN
+typedef struct _seal_key_info
+{
+    uint16_t key_policy;
+    uint16_t isv_svn;
+    uint16_t config_svn;
+    uint16_t reserved;
+    uint8_t cpu_svn[SGX_CPUSVN_SIZE];
+    uint8_t key_id[SGX_KEYID_SIZE];
+} seal_key_info_t;
+OE_PACK_END
+
+/* The header of a sealed blob (little endian). */
+OE_PACK_BEGIN
+typedef struct _seal_header
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t chunk_size;
+
+    /* Chunk i is encrypted with the nonce XORed with i. */
+    uint8_t nonce[OE_GCM_IV_SIZE];
+
+    seal_key_info_t key_info;
+} seal_header_t;
+OE_PACK_END
+
+OE_STATIC_ASSERT(sizeof(seal_header_t) == OE_SEAL_HEADER_SIZE);
+OE_STATIC_ASSERT(OE_SEAL_CHUNK_OVERHEAD == OE_GCM_TAG_SIZE);
+
+/* The additional data of each chunk. */
+OE_PACK_BEGIN
+typedef struct _chunk_aad
+{
+    /* Hash of the header and the caller's additional data. */
+    OE_SHA256 digest;
+    uint64_t index;
+    uint8_t final;
+    uint8_t reserved[7];
+} chunk_aad_t;
+OE_PACK_END
+
+/* A cached seal key. The entry is shared by concurrent oe_seal() and
+ * oe_unseal() calls, and the mbedtls implementation of AES-GCM updates its
+ * context on every call, so the context is only used with the lock held.
+ * Entries are reference counted, so an entry evicted while in use is only
+ * zeroized once its last user releases it. */
+typedef struct _seal_key_entry
+{
+    struct _seal_key_entry* next;
+    uint64_t refs;
+    OE_SHA256 cache_key;
+    oe_spinlock_t lock;
+    oe_aes_gcm_context_t gcm;
+} seal_key_entry_t;
+
+struct _oe_seal_context
+{
+    seal_key_entry_t* key;
+    seal_header_t header;
+    chunk_aad_t aad;
+
+    /* The number of chunks accounted for when the sealing key was taken. */
+    uint64_t reserved_chunks;
+
+    bool sealing;
+    bool finished;
+};
+
+/* The key used for sealing with each policy. */
+typedef struct _sealing_key
+{
+    seal_key_info_t info;
+    OE_SHA256 cache_key;
+    uint32_t uses;
+    bool valid;
+} sealing_key_t;
+
+static sealing_key_t _sealing_keys[OE_SEAL_POLICY_PRODUCT + 1];
+static oe_spinlock_t _lock = OE_SPINLOCK_INITIALIZER;
+static oe_once_t _hook_once = OE_ONCE_INIT;
+
+/* The cached seal keys, most recently used first. They are kept apart from
+ * the quote collateral cache, which only holds public data. */
+static seal_key_entry_t* _key_cache;
+static size_t _key_cache_count;
+static oe_spinlock_t _key_cache_lock = OE_SPINLOCK_INITIALIZER;
+
+static oe_result_t _hash_key_info(
+    const seal_key_info_t* info,
+    OE_SHA256* cache_key)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sha256_context_t context;
+
+    OE_CHECK(oe_sha256_init(&context));
+    OE_CHECK(oe_sha256_update(&context, info, sizeof(*info)));
+    OE_CHECK(oe_sha256_final(&context, cache_key));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+static void _destroy_key_entries(seal_key_entry_t* entry)
+{
+    while (entry)
+    {
+        seal_key_entry_t* next = entry->next;
+
+        oe_aes_gcm_free(&entry->gcm);
+        oe_secure_zero_fill(entry, sizeof(*entry));
+        oe_free(entry);
+        entry = next;
+    }
+}
+
+/* Drop a reference with the cache lock held. Returns whether the entry has
+ * to be destroyed (which is done without holding the lock). */
+static bool _unref_key_locked(seal_key_entry_t* entry)
+{
+    return --entry->refs == 0;
+}
+
+static void _release_key(seal_key_entry_t* entry)
+{
+    bool destroy;
+
+    oe_spin_lock(&_key_cache_lock);
+    destroy = _unref_key_locked(entry);
+    oe_spin_unlock(&_key_cache_lock);
+
+    if (destroy)
+    {
+        entry->next = NULL;
+        _destroy_key_entries(entry);
+    }
+}
+
+/* Find a cached seal key and move it to the front of the cache. */
+static seal_key_entry_t* _find_key(const OE_SHA256* cache_key)
+{
+    seal_key_entry_t* prev = NULL;
+    seal_key_entry_t* found = NULL;
+
+    oe_spin_lock(&_key_cache_lock);
+
+    for (seal_key_entry_t* p = _key_cache; p; prev = p, p = p->next)
+    {
+        if (memcmp(&p->cache_key, cache_key, sizeof(*cache_key)) != 0)
+            continue;
+
+        if (prev)
+        {
+            prev->next = p->next;
+            p->next = _key_cache;
+            _key_cache = p;
+        }
+
+        p->refs++;
+        found = p;
+        break;
+    }
+
+    oe_spin_unlock(&_key_cache_lock);
+
+    return found;
+}
+
+/* Add a seal key to the cache, evicting an entry with the same key (added by
+ * a concurrent miss) and, if the cache is full, the least recently used one.
+ * The cache takes its own reference. */
+static void _insert_key(seal_key_entry_t* entry)
+{
+    seal_key_entry_t* prev = NULL;
+    seal_key_entry_t* garbage = NULL;
+
+    oe_spin_lock(&_key_cache_lock);
+
+    for (seal_key_entry_t* p = _key_cache; p;)
+    {
+        seal_key_entry_t* next = p->next;
+        bool same =
+            memcmp(&p->cache_key, &entry->cache_key, sizeof(OE_SHA256)) == 0;
+
+        if (same || (!next && _key_cache_count >= SEAL_KEY_CACHE_SIZE))
+        {
+            if (prev)
+                prev->next = next;
+            else
+                _key_cache = next;
+
+            _key_cache_count--;
+
+            if (_unref_key_locked(p))
+            {
+                p->next = garbage;
+                garbage = p;
+            }
+        }
+        else
+        {
+            prev = p;
+        }
+
+        p = next;
+    }
+
+    entry->refs++;
+    entry->next = _key_cache;
+    _key_cache = entry;
+    _key_cache_count++;
+
+    oe_spin_unlock(&_key_cache_lock);
+
+    _destroy_key_entries(garbage);
+}
+
+/* Drop the expanded seal keys when oe_clear_key_cache() is called. */
+static void _clear_seal_keys(void)
+{
+    seal_key_entry_t* p;
+    seal_key_entry_t* garbage = NULL;
+
+    oe_spin_lock(&_key_cache_lock);
+
+    p = _key_cache;
+    _key_cache = NULL;
+    _key_cache_count = 0;
+
+    while (p)
+    {
+        seal_key_entry_t* next = p->next;
+
+        if (_unref_key_locked(p))
+        {
+            p->next = garbage;
+            garbage = p;
+        }
+
+        p = next;
+    }
+
+    oe_spin_unlock(&_key_cache_lock);
+
+    _destroy_key_entries(garbage);
+}
+
+static void _register_hook(void)
+{
+    oe_register_key_cache_clear_hook(_clear_seal_keys);
+}
+
+/* Get the cached AES-GCM context of a seal key, deriving the key if needed. */
+static oe_result_t _get_key(
+    const seal_key_info_t* info,
+    const OE_SHA256* cache_key,
+    seal_key_entry_t** entry_out)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    sgx_key_request_t request = {0};
+    sgx_key_t key = {{0}};
+    seal_key_entry_t* entry = NULL;
+    uint64_t generation;
+
+    oe_once(&_hook_once, _register_hook);
+
+    if ((entry = _find_key(cache_key)))
+    {
+        *entry_out = entry;
+        return OE_OK;
+    }
+
+    request.key_name = SGX_KEYSELECT_SEAL;
+    request.key_policy = info->key_policy;
+    request.isv_svn = info->isv_svn;
+    request.config_svn = info->config_svn;
+    memcpy(request.cpu_svn, info->cpu_svn, sizeof(request.cpu_svn));
+    memcpy(request.key_id, info->key_id, sizeof(request.key_id));
+    request.attribute_mask.flags = OE_SEALKEY_DEFAULT_FLAGSMASK;
+    request.attribute_mask.xfrm = OE_SEALKEY_DEFAULT_XFRMMASK;
+    request.misc_attribute_mask = OE_SEALKEY_DEFAULT_MISCMASK;
+
+    generation = oe_get_key_cache_generation();
+    OE_CHECK(oe_get_key(&request, &key));
+
+    if (!(entry = (seal_key_entry_t*)oe_calloc(1, sizeof(*entry))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    entry->refs = 1;
+    entry->cache_key = *cache_key;
+    entry->lock = OE_SPINLOCK_INITIALIZER;
+
+    if ((result = oe_aes_gcm_init(&entry->gcm, key.buf, sizeof(key.buf))) !=
+        OE_OK)
+    {
+        oe_free(entry);
+        entry = NULL;
+        OE_RAISE(result);
+    }
+
+    /* A key derived before a concurrent oe_clear_key_cache() is only used
+     * for this call. */
+    if (generation == oe_get_key_cache_generation())
+        _insert_key(entry);
+
+    *entry_out = entry;
+    result = OE_OK;
+
+done:
+    oe_secure_zero_fill(&key, sizeof(key));
+    return result;
+}
+
+/* Create the info of a new sealing key for the current enclave version. */
+static oe_result_t _new_key_info(
+    oe_seal_policy_t seal_policy,
+    seal_key_info_t* info)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint8_t* key = NULL;
+    size_t key_size = 0;
+    uint8_t* key_info = NULL;
+    size_t key_info_size = 0;
+    const sgx_key_request_t* request;
+
+    OE_CHECK(oe_get_seal_key_by_policy_v2(
+        seal_policy, &key, &key_size, &key_info, &key_info_size));
+
+    if (key_info_size != sizeof(sgx_key_request_t))
+        OE_RAISE(OE_UNEXPECTED);
+
+    request = (const sgx_key_request_t*)key_info;
+    memset(info, 0, sizeof(*info));
+    info->key_policy = request->key_policy;
+    info->isv_svn = request->isv_svn;
+    info->config_svn = request->config_svn;
+    memcpy(info->cpu_svn, request->cpu_svn, sizeof(info->cpu_svn));
+    OE_CHECK(oe_random(info->key_id, sizeof(info->key_id)));
+
+    result = OE_OK;
+
+done:
+    oe_free_seal_key(key, key_info);
+    return result;
+}
+
+/*
+ * Get the key for sealing the given number of chunks with the given policy,
+ * replacing it once it was used for SEAL_KEY_MAX_USES chunks.
+ */
+static oe_result_t _get_sealing_key(
+    oe_seal_policy_t seal_policy,
+    uint64_t chunks,
+    seal_key_info_t* info,
+    seal_key_entry_t** entry)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    sealing_key_t* sealing_key;
+    seal_key_info_t new_info;
+    OE_SHA256 cache_key;
+    bool valid;
+
+    if (seal_policy != OE_SEAL_POLICY_UNIQUE &&
+        seal_policy != OE_SEAL_POLICY_PRODUCT)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    sealing_key = &_sealing_keys[seal_policy];
+
+    oe_spin_lock(&_lock);
+    valid = sealing_key->valid && chunks <= SEAL_KEY_MAX_USES &&
+            sealing_key->uses <= SEAL_KEY_MAX_USES - chunks;
+    if (valid)
+    {
+        sealing_key->uses += (uint32_t)chunks;
+        *info = sealing_key->info;
+        cache_key = sealing_key->cache_key;
+    }
+    oe_spin_unlock(&_lock);
+
+    if (!valid)
+    {
+        OE_CHECK(_new_key_info(seal_policy, &new_info));
+        OE_CHECK(_hash_key_info(&new_info, &cache_key));
+
+        oe_spin_lock(&_lock);
+        sealing_key->info = new_info;
+        sealing_key->cache_key = cache_key;
+        sealing_key->uses = (uint32_t)(
+            chunks < SEAL_KEY_MAX_USES ? chunks : SEAL_KEY_MAX_USES);
+        sealing_key->valid = true;
+        oe_spin_unlock(&_lock);
+
+        *info = new_info;
+    }
+
+    OE_CHECK(_get_key(info, &cache_key, entry));
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/* Account for one more chunk sealed with the given key. */
+static void _add_key_use(const OE_SHA256* cache_key)
+{
+    oe_spin_lock(&_lock);
+
+    for (size_t i = 0; i < OE_COUNTOF(_sealing_keys); i++)
+    {
+        sealing_key_t* sealing_key = &_sealing_keys[i];
+
+        if (sealing_key->valid && sealing_key->uses < SEAL_KEY_MAX_USES &&
+            memcmp(&sealing_key->cache_key, cache_key, sizeof(*cache_key)) ==
+                0)
+            sealing_key->uses++;
+    }
+
+    oe_spin_unlock(&_lock);
+}
+
+static oe_result_t _init_aad(
+    const seal_header_t* header,
+    const void* additional_data,
+    size_t additional_data_size,
+    chunk_aad_t* aad)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sha256_context_t context;
+
+    if (additional_data_size && !additional_data)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    memset(aad, 0, sizeof(*aad));
+    OE_CHECK(oe_sha256_init(&context));
+    OE_CHECK(oe_sha256_update(&context, header, sizeof(*header)));
+    if (additional_data_size)
+    {
+        OE_CHECK(oe_sha256_update(
+            &context, additional_data, additional_data_size));
+    }
+    OE_CHECK(oe_sha256_final(&context, &aad->digest));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+static uint64_t _count_chunks(size_t plaintext_size, uint32_t chunk_size)
+{
+    if (plaintext_size == 0)
+        return 1;
+
+    return (plaintext_size - 1) / chunk_size + 1;
+}
+
+static oe_result_t _seal_init(
+    oe_seal_policy_t seal_policy,
+    uint32_t chunk_size,
+    uint64_t chunks,
+    const void* additional_data,
+    size_t additional_data_size,
+    oe_seal_context_t* context)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    seal_header_t* header = &context->header;
+
+    memset(context, 0, sizeof(*context));
+    context->sealing = true;
+    context->reserved_chunks = chunks;
+
+    header->magic = SEAL_MAGIC;
+    header->version = SEAL_VERSION;
+    header->chunk_size = chunk_size;
+    OE_CHECK(oe_random(header->nonce, sizeof(header->nonce)));
+    OE_CHECK(_get_sealing_key(
+        seal_policy, chunks, &header->key_info, &context->key));
+    OE_CHECK(_init_aad(
+        header, additional_data, additional_data_size, &context->aad));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+static oe_result_t _unseal_init(
+    const uint8_t* header,
+    const void* additional_data,
+    size_t additional_data_size,
+    oe_seal_context_t* context)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    OE_SHA256 cache_key;
+
+    memset(context, 0, sizeof(*context));
+    memcpy(&context->header, header, sizeof(context->header));
+
+    if (context->header.magic != SEAL_MAGIC ||
+        context->header.chunk_size == 0)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (context->header.version != SEAL_VERSION)
+        OE_RAISE(OE_UNSUPPORTED);
+
+    OE_CHECK(_hash_key_info(&context->header.key_info, &cache_key));
+    OE_CHECK(_get_key(&context->header.key_info, &cache_key, &context->key));
+    OE_CHECK(_init_aad(
+        &context->header,
+        additional_data,
+        additional_data_size,
+        &context->aad));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+static void _release_context(oe_seal_context_t* context)
+{
+    _release_key(context->key);
+    oe_secure_zero_fill(context, sizeof(*context));
+}
+
+/* Seal (or unseal) the next chunk, whose plaintext has the given size. */
+static oe_result_t _crypt_chunk(
+    oe_seal_context_t* context,
+    const uint8_t* input,
+    size_t size,
+    bool final,
+    uint8_t* output)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint8_t nonce[OE_GCM_IV_SIZE];
+    uint64_t index = context->aad.index;
+
+    if (context->finished || size > context->header.chunk_size ||
+        (!final && size != context->header.chunk_size))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    memcpy(nonce, context->header.nonce, sizeof(nonce));
+    for (size_t i = 0; i < sizeof(index); i++)
+        nonce[sizeof(nonce) - 1 - i] ^= (uint8_t)(index >> (8 * i));
+
+    context->aad.final = final ? 1 : 0;
+
+    if (context->sealing)
+    {
+        if (index >= context->reserved_chunks)
+            _add_key_use(&context->key->cache_key);
+
+        oe_spin_lock(&context->key->lock);
+        result = oe_aes_gcm_encrypt(
+            &context->key->gcm,
+            nonce,
+            sizeof(nonce),
+            (const uint8_t*)&context->aad,
+            sizeof(context->aad),
+            input,
+            size,
+            output,
+            output + size);
+        oe_spin_unlock(&context->key->lock);
+        OE_CHECK(result);
+    }
+    else
+    {
+        /* Authentication failures are expected for tampered blobs, so they
+         * are not traced. */
+        oe_spin_lock(&context->key->lock);
+        result = oe_aes_gcm_decrypt(
+            &context->key->gcm,
+            nonce,
+            sizeof(nonce),
+            (const uint8_t*)&context->aad,
+            sizeof(context->aad),
+            input,
+            size,
+            output,
+            input + size);
+        oe_spin_unlock(&context->key->lock);
+        if (result != OE_OK)
+            goto done;
+    }
+
+    context->aad.index++;
+    context->finished = final;
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_seal(
+    oe_seal_policy_t seal_policy,
+    const void* plaintext,
+    size_t plaintext_size,
+    const void* additional_data,
+    size_t additional_data_size,
+    uint8_t* blob,
+    size_t* blob_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_seal_context_t context = {0};
+    const uint8_t* input = (const uint8_t*)plaintext;
+    uint64_t chunks;
+    size_t size;
+    size_t offset;
+
+    if ((plaintext_size && !plaintext) || !blob_size)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* size = header + plaintext + a tag per chunk. */
+    chunks = _count_chunks(plaintext_size, OE_SEAL_DEFAULT_CHUNK_SIZE);
+    OE_CHECK(oe_safe_mul_sizet(chunks, OE_SEAL_CHUNK_OVERHEAD, &size));
+    OE_CHECK(oe_safe_add_sizet(size, OE_SEAL_HEADER_SIZE, &size));
+    OE_CHECK(oe_safe_add_sizet(size, plaintext_size, &size));
+
+    if (!blob || *blob_size < size)
+    {
+        *blob_size = size;
+        OE_RAISE_NO_TRACE(OE_BUFFER_TOO_SMALL);
+    }
+
+    OE_CHECK(_seal_init(
+        seal_policy,
+        OE_SEAL_DEFAULT_CHUNK_SIZE,
+        chunks,
+        additional_data,
+        additional_data_size,
+        &context));
+
+    memcpy(blob, &context.header, sizeof(context.header));
+    offset = sizeof(context.header);
+
+    for (uint64_t i = 0; i < chunks; i++)
+    {
+        size_t n = plaintext_size < OE_SEAL_DEFAULT_CHUNK_SIZE
+                       ? plaintext_size
+                       : OE_SEAL_DEFAULT_CHUNK_SIZE;
+
+        OE_CHECK(
+            _crypt_chunk(&context, input, n, i + 1 == chunks, blob + offset));
+
+        input += n;
+        plaintext_size -= n;
+        offset += n + OE_SEAL_CHUNK_OVERHEAD;
+    }
+
+    *blob_size = size;
+    result = OE_OK;
+
+done:
+    if (context.key)
+        _release_context(&context);
+
+    return result;
+}
+
+oe_result_t oe_unseal(
+    const uint8_t* blob,
+    size_t blob_size,
+    const void* additional_data,
+    size_t additional_data_size,
+    uint8_t* plaintext,
+    size_t* plaintext_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_seal_context_t context = {0};
+    seal_header_t header;
+    size_t sealed_chunk_size;
+    size_t sealed_size;
+    size_t size;
+    size_t input_offset = OE_SEAL_HEADER_SIZE;
+    size_t output_offset = 0;
+    uint64_t chunks;
+
+    if (!blob || blob_size < OE_SEAL_HEADER_SIZE + OE_SEAL_CHUNK_OVERHEAD ||
+        !plaintext_size)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    memcpy(&header, blob, sizeof(header));
+    if (header.chunk_size == 0)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* Every chunk but the last has chunk_size + OE_SEAL_CHUNK_OVERHEAD bytes
+     * and the last one has at least OE_SEAL_CHUNK_OVERHEAD bytes. */
+    sealed_chunk_size = (size_t)header.chunk_size + OE_SEAL_CHUNK_OVERHEAD;
+    sealed_size = blob_size - OE_SEAL_HEADER_SIZE;
+    chunks = (sealed_size - 1) / sealed_chunk_size + 1;
+    if (sealed_size % sealed_chunk_size != 0 &&
+        sealed_size % sealed_chunk_size < OE_SEAL_CHUNK_OVERHEAD)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    size = sealed_size - chunks * OE_SEAL_CHUNK_OVERHEAD;
+    if (!plaintext || *plaintext_size < size)
+    {
+        *plaintext_size = size;
+        OE_RAISE_NO_TRACE(OE_BUFFER_TOO_SMALL);
+    }
+
+    OE_CHECK(
+        _unseal_init(blob, additional_data, additional_data_size, &context));
+
+    for (uint64_t i = 0; i < chunks; i++)
+    {
+        size_t n = blob_size - input_offset < sealed_chunk_size
+                       ? blob_size - input_offset
+                       : sealed_chunk_size;
+
+        n -= OE_SEAL_CHUNK_OVERHEAD;
+        result = _crypt_chunk(
+            &context,
+            blob + input_offset,
+            n,
+            i + 1 == chunks,
+            plaintext + output_offset);
+        if (result != OE_OK)
+        {
+            oe_secure_zero_fill(plaintext, size);
+            goto done;
+        }
+
+        input_offset += n + OE_SEAL_CHUNK_OVERHEAD;
+        output_offset += n;
+    }
+
+    *plaintext_size = size;
+    result = OE_OK;
+
+done:
+    if (context.key)
+        _release_context(&context);
+
+    return result;
+}
+
+oe_result_t oe_seal_init(
+    oe_seal_policy_t seal_policy,
+    uint32_t chunk_size,
+    const void* additional_data,
+    size_t additional_data_size,
+    uint8_t header[OE_SEAL_HEADER_SIZE],
+    oe_seal_context_t** context_out)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_seal_context_t* context = NULL;
+
+    if (!header || !context_out)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    *context_out = NULL;
+
+    if (chunk_size == 0)
+        chunk_size = OE_SEAL_DEFAULT_CHUNK_SIZE;
+
+    if (!(context = (oe_seal_context_t*)oe_calloc(1, sizeof(*context))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    /* The number of chunks is not known yet, so the chunks after the first
+     * one are accounted for as they are sealed. */
+    OE_CHECK(_seal_init(
+        seal_policy,
+        chunk_size,
+        1,
+        additional_data,
+        additional_data_size,
+        context));
+
+    memcpy(header, &context->header, sizeof(context->header));
+    *context_out = context;
+    context = NULL;
+    result = OE_OK;
+
+done:
+    oe_seal_free(context);
+    return result;
+}
+
+oe_result_t oe_seal_update(
+    oe_seal_context_t* context,
+    const void* chunk,
+    size_t chunk_size,
+    bool final,
+    uint8_t* output)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!context || !context->sealing || (chunk_size && !chunk) || !output)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(_crypt_chunk(
+        context, (const uint8_t*)chunk, chunk_size, final, output));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_unseal_init(
+    const uint8_t header[OE_SEAL_HEADER_SIZE],
+    const void* additional_data,
+    size_t additional_data_size,
+    uint32_t* chunk_size,
+    oe_seal_context_t** context_out)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_seal_context_t* context = NULL;
+
+    if (!header || !chunk_size || !context_out)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    *context_out = NULL;
+
+    if (!(context = (oe_seal_context_t*)oe_calloc(1, sizeof(*context))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    OE_CHECK(
+        _unseal_init(header, additional_data, additional_data_size, context));
+
+    *chunk_size = context->header.chunk_size;
+    *context_out = context;
+    context = NULL;
+    result = OE_OK;
+
+done:
+    oe_seal_free(context);
+    return result;
+}
+
+oe_result_t oe_unseal_update(
+    oe_seal_context_t* context,
+    const uint8_t* sealed_chunk,
+    size_t sealed_chunk_size,
+    bool final,
+    uint8_t* output)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!context || context->sealing || !sealed_chunk ||
+        sealed_chunk_size < OE_SEAL_CHUNK_OVERHEAD ||
+        (sealed_chunk_size > OE_SEAL_CHUNK_OVERHEAD && !output))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    result = _crypt_chunk(
+        context,
+        sealed_chunk,
+        sealed_chunk_size - OE_SEAL_CHUNK_OVERHEAD,
+        final,
+        output);
+
+done:
+    return result;
+}
+
+void oe_seal_free(oe_seal_context_t* context)
+{
+    if (!context)
+        return;
+
+    if (context->key)
+        _release_context(context);
+
+    oe_free(context);
+}
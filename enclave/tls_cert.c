@@ -17,6 +17,7 @@
 #include "crypto/ec.h"
 #include "crypto/key.h"
 #include "crypto/rsa.h"
+#include "evidence_cache.h"
 
 // Todo: consider set CN with enclave's MRENCLAVE values
 #define SUBJECT_NAME "CN=Open Enclave SDK,O=OESDK TLS,C=US"
@@ -81,29 +82,7 @@ done:
     return result;
 }
 
-/**
- * oe_generate_attestation_certificate.
- *
- * This function generates a self-signed x.509 certificate with an embedded
- * quote from the underlying enclave.
- *
- * @param[in] subject_name a string contains an X.509 distinguished
- * name (DN) for customizing the generated certificate. This name is also used
- * as the issuer name because this is a self-signed certificate
- * See RFC5280 (https://tools.ietf.org/html/rfc5280) specification for details
- * Example value "CN=Open Enclave SDK,O=OESDK TLS,C=US"
- *
- * @param[in] private_key a private key used to sign this certificate
- * @param[in] private_key_size The size of the private_key buffer
- * @param[in] public_key a public key used as the certificate's subject key
- * @param[in] public_key_size The size of the public_key buffer.
- *
- * @param[out] output_cert a pointer to buffer pointer
- * @param[out] output_cert_size size of the buffer above
- *
- * @return OE_OK on success
- */
-oe_result_t oe_generate_attestation_certificate(
+oe_result_t oe_generate_attestation_certificate_uncached(
     const unsigned char* subject_name,
     uint8_t* private_key,
     size_t private_key_size,
@@ -169,6 +148,80 @@ done:
     return result;
 }
 
+/**
+ * oe_generate_attestation_certificate.
+ *
+ * This function generates a self-signed x.509 certificate with an embedded
+ * quote from the underlying enclave.
+ *
+ * @param[in] subject_name a string contains an X.509 distinguished
+ * name (DN) for customizing the generated certificate. This name is also used
+ * as the issuer name because this is a self-signed certificate
+ * See RFC5280 (https://tools.ietf.org/html/rfc5280) specification for details
+ * Example value "CN=Open Enclave SDK,O=OESDK TLS,C=US"
+ *
+ * @param[in] private_key a private key used to sign this certificate
+ * @param[in] private_key_size The size of the private_key buffer
+ * @param[in] public_key a public key used as the certificate's subject key
+ * @param[in] public_key_size The size of the public_key buffer.
+ *
+ * @param[out] output_cert a pointer to buffer pointer
+ * @param[out] output_cert_size size of the buffer above
+ *
+ * @return OE_OK on success
+ */
+oe_result_t oe_generate_attestation_certificate(
+    const unsigned char* subject_name,
+    uint8_t* private_key,
+    size_t private_key_size,
+    uint8_t* public_key,
+    size_t public_key_size,
+    uint8_t** output_cert,
+    size_t* output_cert_size)
+{
+    oe_result_t result = OE_FAILURE;
+
+    if (!output_cert || !output_cert_size)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    // Reuse the certificate generated for the same name and keys while it is
+    // within the freshness window of the evidence cache.
+    if (oe_get_cached_attestation_certificate(
+            subject_name,
+            private_key,
+            private_key_size,
+            public_key,
+            public_key_size,
+            output_cert,
+            output_cert_size) == OE_OK)
+    {
+        result = OE_OK;
+        goto done;
+    }
+
+    OE_CHECK(oe_generate_attestation_certificate_uncached(
+        subject_name,
+        private_key,
+        private_key_size,
+        public_key,
+        public_key_size,
+        output_cert,
+        output_cert_size));
+
+    oe_cache_attestation_certificate(
+        subject_name,
+        private_key,
+        private_key_size,
+        public_key,
+        public_key_size,
+        *output_cert,
+        *output_cert_size);
+
+    result = OE_OK;
+done:
+    return result;
+}
+
 void oe_free_attestation_certificate(uint8_t* cert)
 {
     if (cert)
@@ -0,0 +1,250 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/attestation/plugin.h>
+#include <openenclave/bits/safemath.h>
+#include <openenclave/internal/atomic.h>
+#include <openenclave/internal/crypto/sha.h>
+#include <openenclave/internal/raise.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hostthread.h"
+#include "platformkey.h"
+
+/* Evidence starts with the attestation header written by oe_get_evidence(),
+ * which is followed by the data for the plugin of the format. */
+typedef struct _evidence_header
+{
+    uint32_t version;
+    oe_uuid_t format_id;
+    uint64_t data_size;
+    uint8_t data[];
+} evidence_header_t;
+
+typedef struct _batch_entry
+{
+    OE_SHA256 group;
+    size_t index;
+} batch_entry_t;
+
+typedef struct _batch
+{
+    oe_evidence_batch_item_t* items;
+    const oe_policy_t* policies;
+    size_t policies_size;
+
+    /* Item indices in the order of verification (group leaders first). */
+    const size_t* order;
+
+    /* The range of the order being verified. */
+    volatile uint64_t next;
+    uint64_t end;
+} batch_t;
+
+static oe_result_t _get_group(
+    const oe_evidence_batch_item_t* item,
+    OE_SHA256* group)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sha256_context_t context;
+    const evidence_header_t* header =
+        (const evidence_header_t*)item->evidence_buffer;
+    OE_SHA256 platform;
+
+    OE_CHECK(oe_sha256_init(&context));
+
+    if (header && item->evidence_buffer_size >= sizeof(*header))
+    {
+        OE_CHECK(oe_sha256_update(
+            &context, &header->format_id, sizeof(header->format_id)));
+
+        // Without endorsements, the verifier fetches the endorsements of the
+        // platform of the evidence, which other platforms cannot share.
+        if (!item->endorsements_buffer &&
+            header->data_size <=
+                item->evidence_buffer_size - sizeof(*header) &&
+            oe_get_evidence_platform_key(
+                &header->format_id,
+                header->data,
+                (size_t)header->data_size,
+                &platform) == OE_OK)
+        {
+            OE_CHECK(oe_sha256_update(&context, &platform, sizeof(platform)));
+        }
+    }
+
+    if (item->endorsements_buffer)
+    {
+        OE_CHECK(oe_sha256_update(
+            &context,
+            item->endorsements_buffer,
+            item->endorsements_buffer_size));
+    }
+
+    OE_CHECK(oe_sha256_final(&context, group));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+static int _compare_entries(const void* a, const void* b)
+{
+    const batch_entry_t* entry_a = (const batch_entry_t*)a;
+    const batch_entry_t* entry_b = (const batch_entry_t*)b;
+    int ret = memcmp(&entry_a->group, &entry_b->group, sizeof(OE_SHA256));
+
+    if (ret != 0)
+        return ret;
+
+    if (entry_a->index != entry_b->index)
+        return entry_a->index < entry_b->index ? -1 : 1;
+
+    return 0;
+}
+
+/* Whether the i-th of the sorted entries is the first of its group. */
+static bool _is_group_leader(const batch_entry_t* entries, size_t i)
+{
+    return i == 0 || memcmp(
+                         &entries[i].group,
+                         &entries[i - 1].group,
+                         sizeof(OE_SHA256)) != 0;
+}
+
+static void* _worker(void* arg)
+{
+    batch_t* batch = (batch_t*)arg;
+    uint64_t i;
+
+    while ((i = oe_atomic_increment(&batch->next) - 1) < batch->end)
+    {
+        oe_evidence_batch_item_t* item = &batch->items[batch->order[i]];
+
+        item->result = oe_verify_evidence(
+            item->evidence_buffer,
+            item->evidence_buffer_size,
+            item->endorsements_buffer,
+            item->endorsements_buffer_size,
+            batch->policies,
+            batch->policies_size,
+            &item->claims,
+            &item->claims_length);
+    }
+
+    return NULL;
+}
+
+/* Verify the items at positions [begin, end) of the order. The calling thread
+ * takes part, so the items are still verified if no thread can be created. */
+static void _run(
+    batch_t* batch,
+    oe_thread_t* threads,
+    size_t num_threads,
+    size_t begin,
+    size_t end)
+{
+    size_t created = 0;
+
+    if (num_threads > end - begin)
+        num_threads = end - begin;
+
+    batch->next = begin;
+    batch->end = end;
+
+    while (created + 1 < num_threads &&
+           oe_thread_create(&threads[created], _worker, batch) == 0)
+        created++;
+
+    _worker(batch);
+
+    for (size_t i = 0; i < created; i++)
+        oe_thread_join(threads[i]);
+}
+
+oe_result_t oe_verify_evidence_batch(
+    oe_evidence_batch_item_t* items,
+    size_t items_length,
+    const oe_policy_t* policies,
+    size_t policies_size,
+    size_t num_threads)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    batch_entry_t* entries = NULL;
+    size_t* order = NULL;
+    oe_thread_t* threads = NULL;
+    size_t num_leaders = 0;
+    size_t num_followers = 0;
+    size_t size;
+    batch_t batch;
+
+    if ((!items && items_length) || (!policies && policies_size))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (items_length == 0)
+    {
+        result = OE_OK;
+        goto done;
+    }
+
+    if (num_threads == 0)
+        num_threads = oe_thread_get_processor_count();
+
+    OE_CHECK(oe_safe_mul_sizet(items_length, sizeof(batch_entry_t), &size));
+    if (!(entries = (batch_entry_t*)malloc(size)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    OE_CHECK(oe_safe_mul_sizet(items_length, sizeof(size_t), &size));
+    if (!(order = (size_t*)malloc(size)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    OE_CHECK(oe_safe_mul_sizet(num_threads, sizeof(oe_thread_t), &size));
+    if (!(threads = (oe_thread_t*)malloc(size)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    for (size_t i = 0; i < items_length; i++)
+    {
+        items[i].result = OE_UNEXPECTED;
+        items[i].claims = NULL;
+        items[i].claims_length = 0;
+
+        entries[i].index = i;
+        OE_CHECK(_get_group(&items[i], &entries[i].group));
+    }
+
+    // Sort the items by group, keeping their order within a group, and put
+    // the first item of each group ahead of all others.
+    qsort(entries, items_length, sizeof(batch_entry_t), _compare_entries);
+
+    for (size_t i = 0; i < items_length; i++)
+    {
+        if (_is_group_leader(entries, i))
+            num_leaders++;
+    }
+
+    for (size_t i = 0; i < items_length; i++)
+    {
+        if (_is_group_leader(entries, i))
+            order[i - num_followers] = entries[i].index;
+        else
+            order[num_leaders + num_followers++] = entries[i].index;
+    }
+
+    batch.items = items;
+    batch.policies = policies;
+    batch.policies_size = policies_size;
+    batch.order = order;
+
+    // The group leaders fill the collateral caches for their groups.
+    _run(&batch, threads, num_threads, 0, num_leaders);
+    _run(&batch, threads, num_threads, num_leaders, items_length);
+
+    result = OE_OK;
+
+done:
+    free(threads);
+    free(order);
+    free(entries);
+    return result;
+}
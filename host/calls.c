@@ -3,6 +3,8 @@
 
 #include <openenclave/host.h>
 #include <openenclave/internal/raise.h>
+#include <openenclave/internal/utils.h>
+#include <stdlib.h>
 
 #include "calls.h"
 
@@ -131,3 +133,323 @@ oe_result_t oe_call_enclave_function(
         output_buffer_size,
         output_bytes_written);
 }
+
+/*
+**==============================================================================
+**
+** oe_allocate_ecall_buffer()
+** oe_free_ecall_buffer()
+**
+** Allocate and free the marshalling buffers of the ECALLs made by the
+** oeedger8r generated code. Each thread keeps the buffer of its last ECALL
+** for the next one, so that small ECALLs do not go through malloc() and
+** free(). Buffers bigger than OE_MAX_CACHED_ECALL_BUFFER_SIZE, and those of
+** the ECALLs made while the kept buffer is in use (e.g. from an OCALL that
+** calls another enclave), are allocated for each call.
+**
+**==============================================================================
+*/
+
+#define ECALL_BUFFER_GRANULARITY 1024
+
+typedef struct _ecall_buffer
+{
+    /* The size of the data that follows this header. */
+    uint64_t size;
+
+    /* Whether the buffer is kept by the thread, and if so, whether it is in
+     * use. */
+    uint32_t kept;
+    uint32_t in_use;
+} ecall_buffer_t;
+
+OE_STATIC_ASSERT(sizeof(ecall_buffer_t) % OE_EDGER8R_BUFFER_ALIGNMENT == 0);
+
+static oe_once_type _ecall_buffer_once = OE_H_ONCE_INITIALIZER;
+static oe_thread_key _ecall_buffer_key;
+static bool _ecall_buffer_key_created;
+
+static void _free_kept_ecall_buffer(void* buffer)
+{
+    free(buffer);
+}
+
+static void _create_ecall_buffer_key(void)
+{
+    _ecall_buffer_key_created = oe_thread_key_create_with_destructor(
+                                    &_ecall_buffer_key,
+                                    _free_kept_ecall_buffer) == 0;
+}
+
+void* oe_allocate_ecall_buffer(size_t size)
+{
+    ecall_buffer_t* buffer = NULL;
+    uint64_t buffer_size = size;
+    bool keep = false;
+
+    if (size <= OE_MAX_CACHED_ECALL_BUFFER_SIZE)
+    {
+        oe_once(&_ecall_buffer_once, _create_ecall_buffer_key);
+
+        if (_ecall_buffer_key_created)
+        {
+            buffer = oe_thread_getspecific(_ecall_buffer_key);
+
+            if (buffer && !buffer->in_use && buffer->size >= size)
+            {
+                buffer->in_use = 1;
+                return buffer + 1;
+            }
+
+            /* Replace a kept buffer that is too small. */
+            if (buffer && !buffer->in_use)
+            {
+                oe_thread_setspecific(_ecall_buffer_key, NULL);
+                free(buffer);
+                buffer = NULL;
+            }
+
+            if (!buffer)
+            {
+                buffer_size =
+                    oe_round_up_to_multiple(size, ECALL_BUFFER_GRANULARITY);
+                keep = true;
+            }
+        }
+    }
+
+    if (!(buffer = malloc(sizeof(ecall_buffer_t) + buffer_size)))
+        return NULL;
+
+    buffer->size = buffer_size;
+    buffer->kept = keep;
+    buffer->in_use = 1;
+
+    if (keep && oe_thread_setspecific(_ecall_buffer_key, buffer) != 0)
+        buffer->kept = 0;
+
+    return buffer + 1;
+}
+
+void oe_free_ecall_buffer(void* data)
+{
+    ecall_buffer_t* buffer;
+
+    if (!data)
+        return;
+
+    buffer = (ecall_buffer_t*)data - 1;
+
+    if (buffer->kept)
+        buffer->in_use = 0;
+    else
+        free(buffer);
+}
+
+/*
+**==============================================================================
+**
+** oe_call_enclave_function_batch_by_table_id()
+**
+** Call several enclave functions of the given table in a single ECALL.
+**
+**==============================================================================
+*/
+
+oe_result_t oe_call_enclave_function_batch_by_table_id(
+    oe_enclave_t* enclave,
+    uint64_t table_id,
+    oe_enclave_function_call_t* calls,
+    size_t num_calls)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_call_enclave_function_batch_args_t batch_args;
+    oe_call_enclave_function_args_t* args = NULL;
+
+    /* Reject invalid parameters */
+    if (!enclave || (!calls && num_calls))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (num_calls == 0)
+    {
+        result = OE_OK;
+        goto done;
+    }
+
+    if (!(args = calloc(num_calls, sizeof(*args))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    /* Initialize the call_enclave_args structure of each call */
+    for (size_t i = 0; i < num_calls; i++)
+    {
+        args[i].table_id = table_id;
+        args[i].function_id = calls[i].function_id;
+        args[i].input_buffer = calls[i].input_buffer;
+        args[i].input_buffer_size = calls[i].input_buffer_size;
+        args[i].output_buffer = calls[i].output_buffer;
+        args[i].output_buffer_size = calls[i].output_buffer_size;
+        args[i].output_bytes_written = 0;
+        args[i].result = OE_UNEXPECTED;
+    }
+
+    batch_args.calls = args;
+    batch_args.num_calls = num_calls;
+
+    /* Perform the ECALL */
+    {
+        uint64_t arg_out = 0;
+
+        OE_CHECK(oe_ecall(
+            enclave,
+            OE_ECALL_CALL_ENCLAVE_FUNCTION_BATCH,
+            (uint64_t)&batch_args,
+            &arg_out));
+        OE_CHECK((oe_result_t)arg_out);
+    }
+
+    for (size_t i = 0; i < num_calls; i++)
+    {
+        calls[i].output_bytes_written = args[i].output_bytes_written;
+        calls[i].result = args[i].result;
+    }
+
+    result = OE_OK;
+
+done:
+    free(args);
+    return result;
+}
+
+/*
+**==============================================================================
+**
+** oe_call_enclave_function_batch()
+**
+** Call several enclave functions of the default function table in a single
+** ECALL.
+**
+**==============================================================================
+*/
+
+oe_result_t oe_call_enclave_function_batch(
+    oe_enclave_t* enclave,
+    oe_enclave_function_call_t* calls,
+    size_t num_calls)
+{
+    return oe_call_enclave_function_batch_by_table_id(
+        enclave, OE_UINT64_MAX, calls, num_calls);
+}
+
+/*
+**==============================================================================
+**
+** oe_register_call_function_names()
+**
+** Register the function names of an EDL file for the call profiler. The names
+** of the system EDL files are indexed by table id, and those of the enclaves'
+** own EDL files are looked up by the address of their ocall table.
+**
+**==============================================================================
+*/
+
+typedef struct _call_function_names
+{
+    const oe_ocall_func_t* ocall_table;
+    const char* const* ecall_names;
+    size_t num_ecalls;
+    const char* const* ocall_names;
+    size_t num_ocalls;
+    struct _call_function_names* next;
+} call_function_names_t;
+
+static call_function_names_t _table_names[OE_MAX_OCALL_TABLES];
+static call_function_names_t* _enclave_names;
+static oe_mutex _names_lock = OE_H_MUTEX_INITIALIZER;
+
+void oe_register_call_function_names(
+    uint64_t table_id,
+    const oe_ocall_func_t* ocall_table,
+    const char* const* ecall_names,
+    size_t num_ecalls,
+    const char* const* ocall_names,
+    size_t num_ocalls)
+{
+    call_function_names_t* names = NULL;
+
+    oe_mutex_lock(&_names_lock);
+
+    if (table_id == OE_UINT64_MAX)
+    {
+        if (!ocall_table)
+            goto done;
+
+        for (names = _enclave_names; names; names = names->next)
+        {
+            if (names->ocall_table == ocall_table)
+                break;
+        }
+
+        if (!names)
+        {
+            if (!(names = calloc(1, sizeof(*names))))
+                goto done;
+
+            names->ocall_table = ocall_table;
+            names->next = _enclave_names;
+            _enclave_names = names;
+        }
+    }
+    else if (table_id < OE_MAX_OCALL_TABLES)
+    {
+        names = &_table_names[table_id];
+    }
+    else
+    {
+        goto done;
+    }
+
+    names->ecall_names = ecall_names;
+    names->num_ecalls = num_ecalls;
+    names->ocall_names = ocall_names;
+    names->num_ocalls = num_ocalls;
+
+done:
+    oe_mutex_unlock(&_names_lock);
+}
+
+const char* oe_get_call_function_name(
+    uint64_t table_id,
+    const oe_ocall_func_t* ocall_table,
+    bool is_ocall,
+    uint64_t function_id)
+{
+    const char* name = NULL;
+    const call_function_names_t* names = NULL;
+
+    oe_mutex_lock(&_names_lock);
+
+    if (table_id == OE_UINT64_MAX)
+    {
+        for (names = _enclave_names; names; names = names->next)
+        {
+            if (names->ocall_table == ocall_table)
+                break;
+        }
+    }
+    else if (table_id < OE_MAX_OCALL_TABLES)
+    {
+        names = &_table_names[table_id];
+    }
+
+    if (names)
+    {
+        if (is_ocall && function_id < names->num_ocalls)
+            name = names->ocall_names[function_id];
+        else if (!is_ocall && function_id < names->num_ecalls)
+            name = names->ecall_names[function_id];
+    }
+
+    oe_mutex_unlock(&_names_lock);
+
+    return name;
+}
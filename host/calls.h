@@ -19,4 +19,13 @@ extern ocall_table_t _ocall_tables[];
 
 oe_result_t oe_handle_call_host_function(uint64_t arg, oe_enclave_t* enclave);
 
+/* Get the name registered with oe_register_call_function_names() for an ecall
+ * or an ocall, or NULL if it has none. The ocall_table identifies the EDL file
+ * of the enclave when table_id is OE_UINT64_MAX. */
+const char* oe_get_call_function_name(
+    uint64_t table_id,
+    const oe_ocall_func_t* ocall_table,
+    bool is_ocall,
+    uint64_t function_id);
+
 #endif /* OE_HOST_CALLS_H */
@@ -0,0 +1,77 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/channel.h>
+#include <openenclave/internal/raise.h>
+#include <stdlib.h>
+#include <string.h>
+
+oe_result_t oe_channel_create(
+    void* region,
+    size_t region_size,
+    size_t num_slots,
+    oe_channel_t** channel_out)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_channel_t* channel = NULL;
+
+    if (channel_out)
+        *channel_out = NULL;
+
+    if (!region || !channel_out)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (!(channel = calloc(1, sizeof(*channel))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    OE_CHECK(oe_channel_init(channel, region, region_size, num_slots, true));
+
+    /* Start with empty rings. */
+    memset(region, 0, (size_t)(channel->data - channel->region));
+    channel->send_tail = 0;
+    channel->receive_head = 0;
+
+    *channel_out = channel;
+    channel = NULL;
+    result = OE_OK;
+
+done:
+    free(channel);
+    return result;
+}
+
+oe_result_t oe_channel_get_descriptor(
+    oe_channel_t* channel,
+    oe_channel_descriptor_t* descriptor)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!channel || channel->magic != OE_CHANNEL_MAGIC || !descriptor)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    descriptor->region = channel->region;
+    descriptor->region_size = channel->region_size;
+    descriptor->num_slots = channel->num_slots;
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_channel_destroy(oe_channel_t* channel)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!channel || channel->magic != OE_CHANNEL_MAGIC)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    channel->magic = 0;
+    free(channel);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
@@ -81,3 +81,31 @@ oe_result_t oe_sha256_final(oe_sha256_context_t* context, OE_SHA256* sha256)
 done:
     return result;
 }
+
+oe_result_t oe_sha256_multi(
+    const void* const* data,
+    const size_t* sizes,
+    size_t count,
+    OE_SHA256* hashes)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sha256_context_t context;
+
+    if ((!data || !sizes || !hashes) && count)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!data[i] && sizes[i])
+            OE_RAISE(OE_INVALID_PARAMETER);
+
+        OE_CHECK(oe_sha256_init(&context));
+        OE_CHECK(oe_sha256_update(&context, data[i], sizes[i]));
+        OE_CHECK(oe_sha256_final(&context, &hashes[i]));
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
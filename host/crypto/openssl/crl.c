@@ -67,6 +67,7 @@ oe_result_t oe_crl_read_der(
     crl_t* impl = (crl_t*)crl;
     BIO* bio = NULL;
     X509_CRL* x509_crl = NULL;
+    STACK_OF(X509_REVOKED) * revoked;
 
     /* Clear the implementation */
     if (impl)
@@ -84,6 +85,12 @@ oe_result_t oe_crl_read_der(
     if (!(x509_crl = d2i_X509_CRL_bio(bio, NULL)))
         goto done;
 
+    /* Sort the revoked entries by serial number now. OpenSSL looks the
+     * certificates up with a binary search, but otherwise sorts the entries
+     * under the lock of the CRL during the first verification. */
+    if ((revoked = X509_CRL_get_REVOKED(x509_crl)))
+        sk_X509_REVOKED_sort(revoked);
+
     /* Initialize the implementation */
     _crl_init(impl, x509_crl);
     x509_crl = NULL;
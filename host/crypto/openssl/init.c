@@ -2,14 +2,59 @@
 // Licensed under the MIT License.
 
 #include "init.h"
+#include <openssl/crypto.h>
 #include <openssl/err.h>
 #include <openssl/pem.h>
 #include <pthread.h>
+#include <stdlib.h>
 
 static pthread_once_t _once = PTHREAD_ONCE_INIT;
 
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+/* OpenSSL versions before 1.1.0 are only thread-safe once the application
+ * provides locks, which the host needs to verify quotes on several threads
+ * (see oe_verify_evidence_batch()). Later versions manage their own locks. */
+static pthread_mutex_t* _locks;
+
+static void _locking_callback(int mode, int n, const char* file, int line)
+{
+    (void)file;
+    (void)line;
+
+    if (mode & CRYPTO_LOCK)
+        pthread_mutex_lock(&_locks[n]);
+    else
+        pthread_mutex_unlock(&_locks[n]);
+}
+
+static unsigned long _thread_id_callback(void)
+{
+    return (unsigned long)pthread_self();
+}
+
+static void _initialize_locks(void)
+{
+    /* Applications that use OpenSSL themselves may have set up locking. */
+    if (CRYPTO_get_locking_callback())
+        return;
+
+    _locks = calloc((size_t)CRYPTO_num_locks(), sizeof(pthread_mutex_t));
+    if (!_locks)
+        return;
+
+    for (int i = 0; i < CRYPTO_num_locks(); i++)
+        pthread_mutex_init(&_locks[i], NULL);
+
+    CRYPTO_set_id_callback(_thread_id_callback);
+    CRYPTO_set_locking_callback(_locking_callback);
+}
+#endif
+
 static void _initialize(void)
 {
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+    _initialize_locks();
+#endif
     OpenSSL_add_all_algorithms();
     ERR_load_BIO_strings();
     ERR_load_crypto_strings();
@@ -89,6 +89,13 @@ oe_thread_t oe_thread_self(void);
  */
 int oe_thread_equal(oe_thread_t thread1, oe_thread_t thread2);
 
+/**
+ * Returns the number of processors available to the host.
+ *
+ * @returns Returns the number of online processors (at least one).
+ */
+size_t oe_thread_get_processor_count(void);
+
 /**
  * Calls the given function exactly once.
  *
@@ -193,6 +200,23 @@ int oe_mutex_destroy(oe_mutex* mutex);
  */
 int oe_thread_key_create(oe_thread_key* key);
 
+/**
+ * Create a key for accessing thread-specific data, with a destructor.
+ *
+ * This function is like oe_thread_key_create(), but when a thread exits,
+ * **destructor** is called with the value of the thread-specific data entry
+ * of that thread, if it is not NULL.
+ *
+ * @param key Set this key to refer to the newly allocated TSD entry.
+ * @param destructor Call this function with the value of the entry of each
+ * exiting thread.
+ *
+ * @return Returns zero on success.
+ */
+int oe_thread_key_create_with_destructor(
+    oe_thread_key* key,
+    void (*destructor)(void*));
+
 /**
  * Delete a key for accessing thread-specific data.
  *
@@ -5,6 +5,7 @@
 #include <assert.h>
 #include <openenclave/host.h>
 #include <pthread.h>
+#include <unistd.h>
 
 /*
 **==============================================================================
@@ -33,6 +34,12 @@ int oe_thread_equal(oe_thread_t thread1, oe_thread_t thread2)
     return pthread_equal(thread1, thread2);
 }
 
+size_t oe_thread_get_processor_count(void)
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (size_t)count : 1;
+}
+
 /*
 **==============================================================================
 **
@@ -96,6 +103,13 @@ int oe_thread_key_create(oe_thread_key* key)
     return pthread_key_create(key, NULL);
 }
 
+int oe_thread_key_create_with_destructor(
+    oe_thread_key* key,
+    void (*destructor)(void*))
+{
+    return pthread_key_create(key, destructor);
+}
+
 int oe_thread_key_delete(oe_thread_key key)
 {
     return pthread_key_delete(key);
@@ -15,6 +15,7 @@
 #include <sys/epoll.h>
 #include <sys/ioctl.h>
 #include <sys/poll.h>
+#include <sys/sendfile.h>
 #include <sys/signal.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
@@ -146,6 +147,172 @@ done:
     return ret;
 }
 
+ssize_t oe_syscall_pread_ocall(
+    oe_host_fd_t fd,
+    void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    errno = 0;
+
+    return pread((int)fd, buf, count, offset);
+}
+
+ssize_t oe_syscall_pwrite_ocall(
+    oe_host_fd_t fd,
+    const void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    errno = 0;
+
+    return pwrite((int)fd, buf, count, offset);
+}
+
+/* Wait until a descriptor that returned EAGAIN is ready for writing. */
+static int _wait_writable(int fd)
+{
+    struct pollfd pfd = {.fd = fd, .events = POLLOUT};
+
+    if (poll(&pfd, 1, -1) < 0 && errno != EINTR)
+        return -1;
+
+    return 0;
+}
+
+/* Relay data from a descriptor that sendfile() does not accept as input
+ * (such as a socket) by splicing it through a pipe. Everything read from the
+ * input is written to the output before more is read, so on error the
+ * returned count (and the input offset) cover only the data delivered. */
+static ssize_t _splice_relay(int out_fd, int in_fd, off_t* offset, size_t count)
+{
+    ssize_t ret = -1;
+    int pipefd[2] = {-1, -1};
+    const off_t start = offset ? *offset : 0;
+    size_t total = 0;
+
+    if (pipe(pipefd) != 0)
+        goto done;
+
+    while (total < count)
+    {
+        ssize_t n;
+        const unsigned int flags = SPLICE_F_MOVE;
+
+        n = splice(in_fd, offset, pipefd[1], NULL, count - total, flags);
+
+        if (n == 0)
+            break;
+
+        if (n < 0 && errno == EINTR)
+            continue;
+
+        if (n < 0)
+            goto done;
+
+        /* Drain the pipe into the output descriptor, waiting whenever a
+         * non-blocking output is full. */
+        while (n > 0)
+        {
+            ssize_t m = splice(pipefd[0], NULL, out_fd, NULL, (size_t)n, flags);
+
+            if (m > 0)
+            {
+                n -= m;
+                total += (size_t)m;
+                continue;
+            }
+
+            if (m < 0 && errno == EINTR)
+                continue;
+
+            if (m < 0 && errno == EAGAIN && _wait_writable(out_fd) == 0)
+                continue;
+
+            if (m == 0)
+                errno = EIO;
+
+            goto done;
+        }
+    }
+
+    ret = (ssize_t)total;
+
+done:
+
+    /* Report the data already relayed, as sendfile() does. */
+    if (total)
+        ret = (ssize_t)total;
+
+    /* Advance the input offset only past the data delivered. */
+    if (offset)
+        *offset = start + (off_t)total;
+
+    if (pipefd[0] != -1)
+    {
+        int err = errno;
+        close(pipefd[0]);
+        close(pipefd[1]);
+        errno = err;
+    }
+
+    return ret;
+}
+
+ssize_t oe_syscall_sendfile_ocall(
+    oe_host_fd_t out_fd,
+    oe_host_fd_t in_fd,
+    oe_off_t* offset,
+    size_t count)
+{
+    ssize_t ret = -1;
+    off_t off = offset ? (off_t)*offset : 0;
+    off_t* poff = offset ? &off : NULL;
+    size_t total = 0;
+
+    errno = 0;
+
+    while (total < count)
+    {
+        ssize_t n = sendfile((int)out_fd, (int)in_fd, poff, count - total);
+
+        if (n == -1 && total == 0 && (errno == EINVAL || errno == ENOSYS))
+        {
+            ret = _splice_relay((int)out_fd, (int)in_fd, poff, count);
+            goto done;
+        }
+
+        if (n == -1 && errno == EINTR)
+            continue;
+
+        if (n == -1)
+        {
+            /* Report the data already sent, as sendfile() does. */
+            if (total)
+                break;
+
+            goto done;
+        }
+
+        if (n == 0)
+            break;
+
+        total += (size_t)n;
+    }
+
+    ret = (ssize_t)total;
+
+done:
+
+    if (ret != -1)
+        errno = 0;
+
+    if (offset)
+        *offset = (oe_off_t)off;
+
+    return ret;
+}
+
 oe_off_t oe_syscall_lseek_ocall(oe_host_fd_t fd, oe_off_t offset, int whence)
 {
     errno = 0;
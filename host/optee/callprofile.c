@@ -0,0 +1,53 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+
+oe_result_t oe_start_call_profiling(
+    oe_enclave_t* enclave,
+    uint32_t dump_interval_ms,
+    const char* dump_path)
+{
+    OE_UNUSED(enclave);
+    OE_UNUSED(dump_interval_ms);
+    OE_UNUSED(dump_path);
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_stop_call_profiling(oe_enclave_t* enclave)
+{
+    OE_UNUSED(enclave);
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_get_call_profile(
+    oe_enclave_t* enclave,
+    oe_call_profile_entry_t** entries,
+    size_t* num_entries)
+{
+    OE_UNUSED(enclave);
+    OE_UNUSED(entries);
+    OE_UNUSED(num_entries);
+    return OE_UNSUPPORTED;
+}
+
+void oe_free_call_profile(oe_call_profile_entry_t* entries)
+{
+    free(entries);
+}
+
+uint64_t oe_call_profile_percentile(
+    const oe_call_profile_entry_t* entry,
+    double percentile)
+{
+    OE_UNUSED(entry);
+    OE_UNUSED(percentile);
+    return 0;
+}
+
+oe_result_t oe_dump_call_profile(oe_enclave_t* enclave, FILE* stream)
+{
+    OE_UNUSED(enclave);
+    OE_UNUSED(stream);
+    return OE_UNSUPPORTED;
+}
@@ -0,0 +1,11 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+
+oe_result_t oe_dump_heap_profile(oe_enclave_t* enclave, const char* path)
+{
+    OE_UNUSED(enclave);
+    OE_UNUSED(path);
+    return OE_UNSUPPORTED;
+}
@@ -510,6 +510,24 @@ done:
     return result;
 }
 
+/* The TA takes the buffers of one call per command, so the calls of a batch
+ * are invoked one by one. */
+static oe_result_t _handle_call_enclave_function_batch(
+    oe_enclave_t* enclave,
+    oe_call_enclave_function_batch_args_t* args)
+{
+    for (size_t i = 0; i < args->num_calls; i++)
+    {
+        oe_call_enclave_function_args_t* call = &args->calls[i];
+        oe_result_t result = _handle_call_enclave_function(enclave, call);
+
+        if (result != OE_OK)
+            call->result = result;
+    }
+
+    return OE_OK;
+}
+
 oe_result_t oe_ecall(
     oe_enclave_t* enclave,
     uint16_t func,
@@ -528,6 +546,11 @@ oe_result_t oe_ecall(
         result = _handle_call_enclave_function(
             enclave, (oe_call_enclave_function_args_t*)arg_in);
     }
+    else if (func == OE_ECALL_CALL_ENCLAVE_FUNCTION_BATCH)
+    {
+        result = _handle_call_enclave_function_batch(
+            enclave, (oe_call_enclave_function_batch_args_t*)arg_in);
+    }
     else
     {
         result = _handle_call_builtin_function(enclave, func, arg_in, arg_out);
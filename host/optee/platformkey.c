@@ -0,0 +1,17 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include "../platformkey.h"
+
+oe_result_t oe_get_evidence_platform_key(
+    const oe_uuid_t* format_id,
+    const uint8_t* data,
+    size_t data_size,
+    OE_SHA256* key)
+{
+    OE_UNUSED(format_id);
+    OE_UNUSED(data);
+    OE_UNUSED(data_size);
+    OE_UNUSED(key);
+    return OE_UNSUPPORTED;
+}
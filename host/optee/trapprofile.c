@@ -0,0 +1,11 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+
+oe_result_t oe_dump_trap_profile(oe_enclave_t* enclave, FILE* stream)
+{
+    OE_UNUSED(enclave);
+    OE_UNUSED(stream);
+    return OE_UNSUPPORTED;
+}
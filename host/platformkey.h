@@ -0,0 +1,22 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_HOST_PLATFORMKEY_H
+#define _OE_HOST_PLATFORMKEY_H
+
+#include <openenclave/bits/report.h>
+#include <openenclave/bits/result.h>
+#include <openenclave/bits/types.h>
+#include <openenclave/internal/crypto/sha.h>
+
+/* Get a key that identifies the platform of the evidence data of the given
+ * format, which determines the endorsements that the verifier fetches for it.
+ * Returns OE_UNSUPPORTED for formats that have no such platform.
+ */
+oe_result_t oe_get_evidence_platform_key(
+    const oe_uuid_t* format_id,
+    const uint8_t* data,
+    size_t data_size,
+    OE_SHA256* key);
+
+#endif /* _OE_HOST_PLATFORMKEY_H */
@@ -0,0 +1,853 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include "callprofile.h"
+#include <inttypes.h>
+#include <openenclave/host.h>
+#include <openenclave/internal/calls.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/utils.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../calls.h"
+#include "../hostthread.h"
+#include "../ocalls.h"
+#include "../strings.h"
+#include "enclave.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+/*
+**==============================================================================
+**
+** The call profile of an enclave.
+**
+** Each host thread records the calls it makes or handles in counters of its
+** own, so that recording takes no lock and shares no cache line with other
+** threads. The counters of a thread are arrays indexed by function id, one per
+** function table and call direction, that the thread grows as it sees larger
+** function ids. The arrays it replaces are kept until the profile is freed,
+** since a reader may still be merging them. Readers merge the counters of all
+** threads under the profile lock, which is only taken by a thread the first
+** time it records a call.
+**
+**==============================================================================
+*/
+
+/* The tables of the EDL files of the SDK are indexed by their table id, and
+ * the table of the EDL file of the enclave follows them. */
+#define _ENCLAVE_TABLE OE_MAX_OCALL_TABLES
+#define _NUM_TABLES (OE_MAX_OCALL_TABLES + 1)
+
+/* Calls to larger function ids are not recorded. */
+#define _MAX_FUNCTIONS 4096
+#define _MIN_FUNCTIONS 16
+
+/* The number of histogram buckets per power of two. */
+#define _SUB_BUCKET_BITS 3
+#define _SUB_BUCKETS (1 << _SUB_BUCKET_BITS)
+
+/* How often the dump thread checks whether it should stop. */
+#define _DUMP_POLL_MS 100
+
+typedef struct _call_stats
+{
+    uint64_t count;
+    uint64_t bytes_in;
+    uint64_t bytes_out;
+    uint64_t switchless_hits;
+    uint64_t switchless_misses;
+    uint64_t total_ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+    uint64_t histogram[OE_CALL_PROFILE_HISTOGRAM_BUCKETS];
+} call_stats_t;
+
+typedef struct _call_stats_array
+{
+    size_t num_functions;
+    call_stats_t* functions;
+    struct _call_stats_array* next_retired;
+} call_stats_array_t;
+
+typedef struct _thread_profile
+{
+    /* Indexed by [is_ocall][table] */
+    call_stats_array_t* volatile tables[2][_NUM_TABLES];
+    call_stats_array_t* retired;
+    struct _thread_profile* next;
+} thread_profile_t;
+
+struct _oe_call_profile
+{
+    oe_enclave_t* enclave;
+    volatile bool enabled;
+
+    /* The thread_profile_t of each thread */
+    oe_thread_key key;
+
+    /* Protects the list of threads */
+    oe_mutex lock;
+    thread_profile_t* threads;
+
+    /* Protects the dump settings and thread */
+    oe_mutex dump_lock;
+    uint32_t dump_interval_ms;
+    char* dump_path;
+    oe_thread_t dump_thread;
+    bool dump_running;
+    volatile bool dump_stop;
+};
+
+static uint64_t _now_ns(void)
+{
+#if defined(_WIN32)
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+
+    if (!frequency.QuadPart)
+        QueryPerformanceFrequency(&frequency);
+
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)(
+        (double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+#else
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+        return 0;
+
+    return (uint64_t)ts.tv_sec * 1000000000UL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static size_t _bucket(uint64_t ns)
+{
+    size_t msb;
+    size_t shift;
+    size_t bucket;
+
+    if (ns < _SUB_BUCKETS)
+        return (size_t)ns;
+
+#if defined(_MSC_VER)
+    {
+        unsigned long index;
+        _BitScanReverse64(&index, ns);
+        msb = index;
+    }
+#else
+    msb = 63 - (size_t)__builtin_clzll(ns);
+#endif
+
+    shift = msb - _SUB_BUCKET_BITS;
+    bucket = ((shift + 1) << _SUB_BUCKET_BITS) +
+             (size_t)((ns >> shift) & (_SUB_BUCKETS - 1));
+
+    if (bucket >= OE_CALL_PROFILE_HISTOGRAM_BUCKETS)
+        bucket = OE_CALL_PROFILE_HISTOGRAM_BUCKETS - 1;
+
+    return bucket;
+}
+
+static uint64_t _bucket_upper_bound(size_t bucket)
+{
+    size_t shift;
+
+    if (bucket < _SUB_BUCKETS)
+        return bucket;
+
+    shift = (bucket >> _SUB_BUCKET_BITS) - 1;
+    return ((uint64_t)(_SUB_BUCKETS + (bucket & (_SUB_BUCKETS - 1)) + 1)
+            << shift) -
+           1;
+}
+
+static thread_profile_t* _get_thread_profile(oe_call_profile_t* profile)
+{
+    thread_profile_t* thread = oe_thread_getspecific(profile->key);
+
+    if (!thread)
+    {
+        if (!(thread = calloc(1, sizeof(*thread))))
+            return NULL;
+
+        if (oe_thread_setspecific(profile->key, thread) != 0)
+        {
+            free(thread);
+            return NULL;
+        }
+
+        oe_mutex_lock(&profile->lock);
+        thread->next = profile->threads;
+        profile->threads = thread;
+        oe_mutex_unlock(&profile->lock);
+    }
+
+    return thread;
+}
+
+static call_stats_t* _get_stats(
+    thread_profile_t* thread,
+    bool is_ocall,
+    size_t table,
+    size_t function_id)
+{
+    call_stats_array_t* array = thread->tables[is_ocall][table];
+
+    if (!array || function_id >= array->num_functions)
+    {
+        call_stats_array_t* grown = NULL;
+        size_t num_functions = array ? array->num_functions : _MIN_FUNCTIONS;
+
+        while (num_functions <= function_id)
+            num_functions *= 2;
+
+        grown = calloc(
+            1, sizeof(*grown) + num_functions * sizeof(call_stats_t));
+        if (!grown)
+            return NULL;
+
+        grown->num_functions = num_functions;
+        grown->functions = (call_stats_t*)(grown + 1);
+
+        if (array)
+        {
+            memcpy(
+                grown->functions,
+                array->functions,
+                array->num_functions * sizeof(call_stats_t));
+            array->next_retired = thread->retired;
+            thread->retired = array;
+        }
+
+        /* Publish the counters after they are copied. */
+        OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+        thread->tables[is_ocall][table] = grown;
+        array = grown;
+    }
+
+    return &array->functions[function_id];
+}
+
+uint64_t oe_call_profile_begin(oe_enclave_t* enclave)
+{
+    oe_call_profile_t* profile = enclave->call_profile;
+
+    if (!profile || !profile->enabled)
+        return 0;
+
+    return _now_ns();
+}
+
+void oe_call_profile_end(
+    oe_enclave_t* enclave,
+    uint64_t start,
+    bool is_ocall,
+    uint64_t table_id,
+    uint64_t function_id,
+    uint64_t bytes_in,
+    uint64_t bytes_out,
+    oe_call_profile_dispatch_t dispatch)
+{
+    oe_call_profile_t* profile = enclave->call_profile;
+    uint64_t ns = _now_ns() - start;
+    size_t table;
+    thread_profile_t* thread;
+    call_stats_t* stats;
+
+    if (!profile || function_id >= _MAX_FUNCTIONS)
+        return;
+
+    if (table_id == OE_UINT64_MAX)
+        table = _ENCLAVE_TABLE;
+    else if (table_id < OE_MAX_OCALL_TABLES)
+        table = (size_t)table_id;
+    else
+        return;
+
+    if (!(thread = _get_thread_profile(profile)))
+        return;
+
+    if (!(stats = _get_stats(thread, is_ocall, table, (size_t)function_id)))
+        return;
+
+    if (stats->count == 0 || ns < stats->min_ns)
+        stats->min_ns = ns;
+
+    if (ns > stats->max_ns)
+        stats->max_ns = ns;
+
+    stats->count++;
+    stats->bytes_in += bytes_in;
+    stats->bytes_out += bytes_out;
+    stats->total_ns += ns;
+    stats->histogram[_bucket(ns)]++;
+
+    if (dispatch == OE_CALL_PROFILE_SWITCHLESS_HIT)
+        stats->switchless_hits++;
+    else if (dispatch == OE_CALL_PROFILE_SWITCHLESS_MISS)
+        stats->switchless_misses++;
+}
+
+static int _compare_entries(const void* left, const void* right)
+{
+    const oe_call_profile_entry_t* l = (const oe_call_profile_entry_t*)left;
+    const oe_call_profile_entry_t* r = (const oe_call_profile_entry_t*)right;
+
+    if (l->total_ns != r->total_ns)
+        return l->total_ns > r->total_ns ? -1 : 1;
+
+    return l->count > r->count ? -1 : l->count < r->count;
+}
+
+static void _add_stats(
+    oe_call_profile_entry_t* entry,
+    const call_stats_t* stats)
+{
+    if (stats->count == 0)
+        return;
+
+    if (entry->count == 0 || stats->min_ns < entry->min_ns)
+        entry->min_ns = stats->min_ns;
+
+    if (stats->max_ns > entry->max_ns)
+        entry->max_ns = stats->max_ns;
+
+    entry->count += stats->count;
+    entry->bytes_in += stats->bytes_in;
+    entry->bytes_out += stats->bytes_out;
+    entry->switchless_hits += stats->switchless_hits;
+    entry->switchless_misses += stats->switchless_misses;
+    entry->total_ns += stats->total_ns;
+
+    for (size_t i = 0; i < OE_CALL_PROFILE_HISTOGRAM_BUCKETS; i++)
+        entry->histogram[i] += stats->histogram[i];
+}
+
+static oe_result_t _merge_profile(
+    oe_call_profile_t* profile,
+    oe_call_profile_entry_t** entries_out,
+    size_t* num_entries_out)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    size_t offsets[2][_NUM_TABLES];
+    size_t sizes[2][_NUM_TABLES];
+    size_t total = 0;
+    size_t num_entries = 0;
+    oe_call_profile_entry_t* entries = NULL;
+    bool locked = false;
+
+    *entries_out = NULL;
+    *num_entries_out = 0;
+
+    oe_mutex_lock(&profile->lock);
+    locked = true;
+
+    /* Lay out one entry per function id seen by any thread. */
+    for (size_t d = 0; d < 2; d++)
+    {
+        for (size_t t = 0; t < _NUM_TABLES; t++)
+        {
+            sizes[d][t] = 0;
+
+            for (thread_profile_t* thread = profile->threads; thread;
+                 thread = thread->next)
+            {
+                call_stats_array_t* array = thread->tables[d][t];
+
+                OE_ATOMIC_MEMORY_BARRIER_ACQUIRE();
+                if (array && array->num_functions > sizes[d][t])
+                    sizes[d][t] = array->num_functions;
+            }
+
+            offsets[d][t] = total;
+            total += sizes[d][t];
+        }
+    }
+
+    if (total == 0)
+    {
+        result = OE_OK;
+        goto done;
+    }
+
+    if (!(entries = calloc(total, sizeof(*entries))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    for (thread_profile_t* thread = profile->threads; thread;
+         thread = thread->next)
+    {
+        for (size_t d = 0; d < 2; d++)
+        {
+            for (size_t t = 0; t < _NUM_TABLES; t++)
+            {
+                call_stats_array_t* array = thread->tables[d][t];
+
+                OE_ATOMIC_MEMORY_BARRIER_ACQUIRE();
+                if (!array)
+                    continue;
+
+                for (size_t f = 0; f < array->num_functions; f++)
+                {
+                    _add_stats(
+                        &entries[offsets[d][t] + f], &array->functions[f]);
+                }
+            }
+        }
+    }
+
+    oe_mutex_unlock(&profile->lock);
+    locked = false;
+
+    /* Keep the functions that were called, and name them. */
+    for (size_t d = 0; d < 2; d++)
+    {
+        for (size_t t = 0; t < _NUM_TABLES; t++)
+        {
+            for (size_t f = 0; f < sizes[d][t]; f++)
+            {
+                oe_call_profile_entry_t* entry = &entries[offsets[d][t] + f];
+
+                if (entry->count == 0)
+                    continue;
+
+                entry->is_ocall = (d == 1);
+                entry->table_id = t == _ENCLAVE_TABLE ? OE_UINT64_MAX : t;
+                entry->function_id = f;
+                entry->name = oe_get_call_function_name(
+                    entry->table_id,
+                    profile->enclave->ocalls,
+                    entry->is_ocall,
+                    entry->function_id);
+
+                if (entry != &entries[num_entries])
+                    entries[num_entries] = *entry;
+
+                num_entries++;
+            }
+        }
+    }
+
+    qsort(entries, num_entries, sizeof(*entries), _compare_entries);
+
+    *entries_out = entries;
+    *num_entries_out = num_entries;
+    entries = NULL;
+    result = OE_OK;
+
+done:
+    if (locked)
+        oe_mutex_unlock(&profile->lock);
+
+    free(entries);
+
+    return result;
+}
+
+static oe_result_t _write_profile(oe_call_profile_t* profile, FILE* stream)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_call_profile_entry_t* entries = NULL;
+    size_t num_entries = 0;
+
+    OE_CHECK(_merge_profile(profile, &entries, &num_entries));
+
+    fprintf(
+        stream,
+        "Call profile of enclave %s:\n"
+        "%-5s %-40s %10s %12s %12s %10s %10s %12s %10s %10s %10s %10s\n",
+        profile->enclave->path ? profile->enclave->path : "",
+        "type",
+        "function",
+        "calls",
+        "bytes in",
+        "bytes out",
+        "sl hits",
+        "sl misses",
+        "total us",
+        "mean us",
+        "p50 us",
+        "p99 us",
+        "max us");
+
+    for (size_t i = 0; i < num_entries; i++)
+    {
+        const oe_call_profile_entry_t* entry = &entries[i];
+        char name[64];
+
+        if (entry->name)
+            snprintf(name, sizeof(name), "%s", entry->name);
+        else if (entry->table_id == OE_UINT64_MAX)
+            snprintf(name, sizeof(name), "#%" PRIu64, entry->function_id);
+        else
+            snprintf(
+                name,
+                sizeof(name),
+                "#%" PRIu64 ":%" PRIu64,
+                entry->table_id,
+                entry->function_id);
+
+        fprintf(
+            stream,
+            "%-5s %-40s %10" PRIu64 " %12" PRIu64 " %12" PRIu64 " %10" PRIu64
+            " %10" PRIu64 " %12.1f %10.1f %10.1f %10.1f %10.1f\n",
+            entry->is_ocall ? "ocall" : "ecall",
+            name,
+            entry->count,
+            entry->bytes_in,
+            entry->bytes_out,
+            entry->switchless_hits,
+            entry->switchless_misses,
+            (double)entry->total_ns / 1000.0,
+            (double)entry->total_ns / (double)entry->count / 1000.0,
+            (double)oe_call_profile_percentile(entry, 50) / 1000.0,
+            (double)oe_call_profile_percentile(entry, 99) / 1000.0,
+            (double)entry->max_ns / 1000.0);
+    }
+
+    fflush(stream);
+    result = OE_OK;
+
+done:
+    oe_free_call_profile(entries);
+
+    return result;
+}
+
+static void _dump_profile(oe_call_profile_t* profile)
+{
+    FILE* stream = stderr;
+
+    if (profile->dump_path)
+    {
+#if defined(_WIN32)
+        if (fopen_s(&stream, profile->dump_path, "a") != 0)
+            stream = NULL;
+#else
+        stream = fopen(profile->dump_path, "a");
+#endif
+        if (!stream)
+        {
+            OE_TRACE_ERROR("cannot open %s", profile->dump_path);
+            return;
+        }
+    }
+
+    _write_profile(profile, stream);
+
+    if (stream != stderr)
+        fclose(stream);
+}
+
+static void* _dump_thread(void* arg)
+{
+    oe_call_profile_t* profile = (oe_call_profile_t*)arg;
+    uint32_t step = profile->dump_interval_ms < _DUMP_POLL_MS
+                        ? profile->dump_interval_ms
+                        : _DUMP_POLL_MS;
+    uint32_t elapsed = 0;
+
+    while (!profile->dump_stop)
+    {
+        oe_handle_sleep(step);
+        elapsed += step;
+
+        if (elapsed >= profile->dump_interval_ms && !profile->dump_stop)
+        {
+            _dump_profile(profile);
+            elapsed = 0;
+        }
+    }
+
+    return NULL;
+}
+
+/* Called with the dump lock held. */
+static void _stop_dump_thread(oe_call_profile_t* profile)
+{
+    if (profile->dump_running)
+    {
+        profile->dump_stop = true;
+        oe_thread_join(profile->dump_thread);
+        profile->dump_running = false;
+    }
+}
+
+static void _free_profile(oe_call_profile_t* profile)
+{
+    thread_profile_t* thread = profile->threads;
+
+    while (thread)
+    {
+        thread_profile_t* next = thread->next;
+        call_stats_array_t* retired = thread->retired;
+
+        for (size_t d = 0; d < 2; d++)
+        {
+            for (size_t t = 0; t < _NUM_TABLES; t++)
+                free(thread->tables[d][t]);
+        }
+
+        while (retired)
+        {
+            call_stats_array_t* next_retired = retired->next_retired;
+            free(retired);
+            retired = next_retired;
+        }
+
+        free(thread);
+        thread = next;
+    }
+
+    oe_thread_key_delete(profile->key);
+    oe_mutex_destroy(&profile->lock);
+    oe_mutex_destroy(&profile->dump_lock);
+    free(profile->dump_path);
+    free(profile);
+}
+
+static oe_result_t _get_profile(
+    oe_enclave_t* enclave,
+    bool create,
+    oe_call_profile_t** profile_out)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_call_profile_t* profile = NULL;
+    bool key_created = false;
+    bool lock_created = false;
+    bool dump_lock_created = false;
+    bool locked = false;
+
+    if (!enclave || enclave->magic != ENCLAVE_MAGIC || !profile_out)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    oe_mutex_lock(&enclave->lock);
+    locked = true;
+
+    if (!enclave->call_profile && create)
+    {
+        if (!(profile = calloc(1, sizeof(*profile))))
+            OE_RAISE(OE_OUT_OF_MEMORY);
+
+        if (oe_thread_key_create(&profile->key) != 0)
+            OE_RAISE(OE_FAILURE);
+        key_created = true;
+
+        if (oe_mutex_init(&profile->lock) != 0)
+            OE_RAISE(OE_FAILURE);
+        lock_created = true;
+
+        if (oe_mutex_init(&profile->dump_lock) != 0)
+            OE_RAISE(OE_FAILURE);
+        dump_lock_created = true;
+
+        profile->enclave = enclave;
+
+        /* Publish the profile once it is initialized. */
+        OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+        enclave->call_profile = profile;
+        profile = NULL;
+    }
+
+    *profile_out = enclave->call_profile;
+    result = OE_OK;
+
+done:
+    if (locked)
+        oe_mutex_unlock(&enclave->lock);
+
+    if (profile)
+    {
+        if (key_created)
+            oe_thread_key_delete(profile->key);
+        if (lock_created)
+            oe_mutex_destroy(&profile->lock);
+        if (dump_lock_created)
+            oe_mutex_destroy(&profile->dump_lock);
+        free(profile);
+    }
+
+    return result;
+}
+
+oe_result_t oe_start_call_profiling(
+    oe_enclave_t* enclave,
+    uint32_t dump_interval_ms,
+    const char* dump_path)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_call_profile_t* profile = NULL;
+    char* path = NULL;
+    bool locked = false;
+
+    OE_CHECK(_get_profile(enclave, true, &profile));
+
+    if (dump_path && !(path = oe_strdup(dump_path)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    oe_mutex_lock(&profile->dump_lock);
+    locked = true;
+
+    _stop_dump_thread(profile);
+
+    free(profile->dump_path);
+    profile->dump_path = path;
+    profile->dump_interval_ms = dump_interval_ms;
+    path = NULL;
+
+    if (dump_interval_ms)
+    {
+        profile->dump_stop = false;
+
+        if (oe_thread_create(&profile->dump_thread, _dump_thread, profile) !=
+            0)
+        {
+            profile->dump_interval_ms = 0;
+            OE_RAISE_MSG(OE_FAILURE, "cannot create the dump thread", NULL);
+        }
+
+        profile->dump_running = true;
+    }
+
+    profile->enabled = true;
+    result = OE_OK;
+
+done:
+    if (locked)
+        oe_mutex_unlock(&profile->dump_lock);
+
+    free(path);
+
+    return result;
+}
+
+oe_result_t oe_stop_call_profiling(oe_enclave_t* enclave)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_call_profile_t* profile = NULL;
+
+    OE_CHECK(_get_profile(enclave, false, &profile));
+
+    if (profile)
+    {
+        profile->enabled = false;
+
+        oe_mutex_lock(&profile->dump_lock);
+        _stop_dump_thread(profile);
+        profile->dump_interval_ms = 0;
+        oe_mutex_unlock(&profile->dump_lock);
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_get_call_profile(
+    oe_enclave_t* enclave,
+    oe_call_profile_entry_t** entries,
+    size_t* num_entries)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_call_profile_t* profile = NULL;
+
+    if (!entries || !num_entries)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    *entries = NULL;
+    *num_entries = 0;
+
+    OE_CHECK(_get_profile(enclave, false, &profile));
+
+    if (profile)
+        OE_CHECK(_merge_profile(profile, entries, num_entries));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+void oe_free_call_profile(oe_call_profile_entry_t* entries)
+{
+    free(entries);
+}
+
+uint64_t oe_call_profile_percentile(
+    const oe_call_profile_entry_t* entry,
+    double percentile)
+{
+    double position;
+    uint64_t rank;
+    uint64_t seen = 0;
+
+    if (!entry || entry->count == 0)
+        return 0;
+
+    if (percentile < 0.0)
+        percentile = 0.0;
+    else if (percentile > 100.0)
+        percentile = 100.0;
+
+    /* The rank of the percentile among the calls, rounded up. */
+    position = percentile * (double)entry->count / 100.0;
+    rank = (uint64_t)position;
+    if ((double)rank < position || rank == 0)
+        rank++;
+
+    for (size_t i = 0; i < OE_CALL_PROFILE_HISTOGRAM_BUCKETS; i++)
+    {
+        seen += entry->histogram[i];
+
+        if (seen >= rank)
+        {
+            uint64_t bound = _bucket_upper_bound(i);
+            return bound < entry->max_ns ? bound : entry->max_ns;
+        }
+    }
+
+    return entry->max_ns;
+}
+
+oe_result_t oe_dump_call_profile(oe_enclave_t* enclave, FILE* stream)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_call_profile_t* profile = NULL;
+
+    if (!stream)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(_get_profile(enclave, false, &profile));
+
+    if (profile)
+        OE_CHECK(_write_profile(profile, stream));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+void oe_call_profile_free(oe_enclave_t* enclave)
+{
+    oe_call_profile_t* profile = enclave->call_profile;
+
+    if (!profile)
+        return;
+
+    oe_mutex_lock(&profile->dump_lock);
+    _stop_dump_thread(profile);
+    if (profile->dump_interval_ms)
+        _dump_profile(profile);
+    oe_mutex_unlock(&profile->dump_lock);
+
+    enclave->call_profile = NULL;
+    _free_profile(profile);
+}
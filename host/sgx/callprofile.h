@@ -0,0 +1,39 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_HOST_SGX_CALLPROFILE_H
+#define _OE_HOST_SGX_CALLPROFILE_H
+
+#include <openenclave/host.h>
+
+typedef struct _oe_call_profile oe_call_profile_t;
+
+/* How a recorded call was dispatched. */
+typedef enum _oe_call_profile_dispatch
+{
+    OE_CALL_PROFILE_REGULAR,
+    OE_CALL_PROFILE_SWITCHLESS_HIT,
+    OE_CALL_PROFILE_SWITCHLESS_MISS
+} oe_call_profile_dispatch_t;
+
+/* Return the start time of a call in nanoseconds, or 0 if the calls of the
+ * enclave are not being profiled. */
+uint64_t oe_call_profile_begin(oe_enclave_t* enclave);
+
+/* Record a call that started at start, a non-zero value returned by
+ * oe_call_profile_begin(), in the counters of the calling thread. */
+void oe_call_profile_end(
+    oe_enclave_t* enclave,
+    uint64_t start,
+    bool is_ocall,
+    uint64_t table_id,
+    uint64_t function_id,
+    uint64_t bytes_in,
+    uint64_t bytes_out,
+    oe_call_profile_dispatch_t dispatch);
+
+/* Stop the periodic dump, write the last one and free the profile of the
+ * enclave. Called when the enclave is terminated. */
+void oe_call_profile_free(oe_enclave_t* enclave);
+
+#endif /* _OE_HOST_SGX_CALLPROFILE_H */
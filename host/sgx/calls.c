@@ -32,6 +32,7 @@
 #include "../hostthread.h"
 #include "../ocalls.h"
 #include "asmdefs.h"
+#include "callprofile.h"
 #include "enclave.h"
 #include "ocalls.h"
 
@@ -238,6 +239,8 @@ oe_result_t oe_handle_call_host_function(uint64_t arg, oe_enclave_t* enclave)
     oe_ocall_func_t func = NULL;
     size_t buffer_size = 0;
     ocall_table_t ocall_table;
+    uint64_t profile_start = 0;
+    oe_call_profile_dispatch_t dispatch = OE_CALL_PROFILE_REGULAR;
 
     args_ptr = (oe_call_host_function_args_t*)arg;
     if (args_ptr == NULL)
@@ -288,6 +291,16 @@ oe_result_t oe_handle_call_host_function(uint64_t arg, oe_enclave_t* enclave)
     if ((args_ptr->output_buffer_size % OE_EDGER8R_BUFFER_ALIGNMENT) != 0)
         OE_RAISE(OE_INVALID_PARAMETER);
 
+    // A switchless ocall is posted with the result __OE_RESULT_MAX, and the
+    // enclave marks the ones that fell back to a regular ocall.
+    if ((profile_start = oe_call_profile_begin(enclave)) != 0)
+    {
+        if (args_ptr->result == __OE_RESULT_MAX)
+            dispatch = OE_CALL_PROFILE_SWITCHLESS_HIT;
+        else if (args_ptr->result == OE_CONTEXT_SWITCHLESS_OCALL_MISSED)
+            dispatch = OE_CALL_PROFILE_SWITCHLESS_MISS;
+    }
+
     // Call the function.
     func(
         args_ptr->input_buffer,
@@ -296,6 +309,17 @@ oe_result_t oe_handle_call_host_function(uint64_t arg, oe_enclave_t* enclave)
         args_ptr->output_buffer_size,
         &args_ptr->output_bytes_written);
 
+    if (profile_start)
+        oe_call_profile_end(
+            enclave,
+            profile_start,
+            true,
+            args_ptr->table_id,
+            args_ptr->function_id,
+            args_ptr->input_buffer_size,
+            args_ptr->output_bytes_written,
+            dispatch);
+
     // The ocall succeeded.
     OE_ATOMIC_MEMORY_BARRIER_RELEASE();
     args_ptr->result = OE_OK;
@@ -339,6 +363,7 @@ static const char* oe_ecall_str(oe_func_t ecall)
         "CALL_ENCLAVE_FUNCTION",
         "VIRTUAL_EXCEPTION_HANDLER",
         "INIT_CONTEXT_SWITCHLESS",
+        "CALL_ENCLAVE_FUNCTION_BATCH",
     };
     // clang-format on
 
@@ -656,6 +681,7 @@ oe_result_t oe_ecall(
     uint16_t func_out = 0;
     uint16_t result_out = 0;
     uint64_t arg_out = 0;
+    uint64_t profile_start = 0;
 
     if (!enclave)
         OE_RAISE(OE_INVALID_PARAMETER);
@@ -669,9 +695,16 @@ oe_result_t oe_ecall(
         "%s 0x%x %s: %s\n",
         enclave->path,
         enclave->addr,
-        func == OE_ECALL_CALL_ENCLAVE_FUNCTION ? "EDL_ECALL" : "OE_ECALL",
+        (func == OE_ECALL_CALL_ENCLAVE_FUNCTION ||
+         func == OE_ECALL_CALL_ENCLAVE_FUNCTION_BATCH)
+            ? "EDL_ECALL"
+            : "OE_ECALL",
         oe_ecall_str(func));
 
+    /* Only the ecalls to EDL functions are profiled */
+    if (func == OE_ECALL_CALL_ENCLAVE_FUNCTION)
+        profile_start = oe_call_profile_begin(enclave);
+
     /* Perform ECALL or ORET */
     OE_CHECK(_do_eenter(
         enclave,
@@ -685,6 +718,22 @@ oe_result_t oe_ecall(
         &result_out,
         &arg_out));
 
+    if (profile_start)
+    {
+        const oe_call_enclave_function_args_t* args =
+            (const oe_call_enclave_function_args_t*)arg;
+
+        oe_call_profile_end(
+            enclave,
+            profile_start,
+            false,
+            args->table_id,
+            args->function_id,
+            args->input_buffer_size,
+            args->output_bytes_written,
+            OE_CALL_PROFILE_REGULAR);
+    }
+
     /* Process OCALLS */
     if (code_out != OE_CODE_ERET)
         OE_RAISE(OE_UNEXPECTED);
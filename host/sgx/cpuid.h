@@ -4,8 +4,11 @@
 #ifndef _OE_CPUIDCOUNT_H
 #define _OE_CPUIDCOUNT_H
 
+#include <stdint.h>
+
 #if defined(__GNUC__)
 #include <cpuid.h>
+#include <x86intrin.h>
 #elif defined(_MSC_VER)
 #include <intrin.h>
 #include <limits.h>
@@ -37,4 +40,11 @@ static inline void oe_get_cpuid(
     *__edx = (unsigned int)registers[3];
 #endif
 }
+
+/* Read the time stamp counter, on behalf of an enclave when RDTSC is illegal
+ * in the enclave. */
+static inline uint64_t oe_get_tsc(void)
+{
+    return __rdtsc();
+}
 #endif /* _OE_CPUIDCOUNT_H */
@@ -50,6 +50,7 @@ static char* get_fullpath(const char* path)
 #include <openenclave/internal/utils.h>
 #include <string.h>
 #include "../memalign.h"
+#include "callprofile.h"
 #include "cpuid.h"
 #include "enclave.h"
 #include "exception.h"
@@ -369,6 +370,11 @@ done:
     return result;
 }
 
+uint64_t oe_rdtsc_ocall(void)
+{
+    return oe_get_tsc();
+}
+
 /*
 **==============================================================================
 **
@@ -851,6 +857,9 @@ oe_result_t oe_terminate_enclave(oe_enclave_t* enclave)
     /* Shut down the switchless manager */
     OE_CHECK(oe_stop_switchless_manager(enclave));
 
+    /* Write the last dump of the call profile and free it */
+    oe_call_profile_free(enclave);
+
     /* Clear the magic number */
     enclave->magic = 0;
 
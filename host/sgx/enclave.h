@@ -124,6 +124,9 @@ struct _oe_enclave
 
     /* Manager for switchless calls */
     oe_switchless_call_manager_t* switchless_manager;
+
+    /* Call profile, created by oe_start_call_profiling() */
+    struct _oe_call_profile* volatile call_profile;
 };
 
 /* Get the event for the given TCS */
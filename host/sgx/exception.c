@@ -6,6 +6,7 @@
 #include <openenclave/internal/calls.h>
 #include <stdio.h>
 #include "asmdefs.h"
+#include "cpuid.h"
 #include "enclave.h"
 
 /**
@@ -44,10 +45,14 @@ uint64_t oe_host_handle_exception(oe_host_exception_context_t* context)
         // Set the flag marks this thread is handling an enclave exception.
         thread_data->flags |= _OE_THREAD_HANDLING_EXCEPTION;
 
-        // Call into enclave first pass exception handler.
+        // Call into enclave first pass exception handler. It is passed the
+        // time stamp counter in case the exception is an RDTSC to emulate.
         uint64_t arg_out = 0;
-        oe_result_t result =
-            oe_ecall(enclave, OE_ECALL_VIRTUAL_EXCEPTION_HANDLER, 0, &arg_out);
+        oe_result_t result = oe_ecall(
+            enclave,
+            OE_ECALL_VIRTUAL_EXCEPTION_HANDLER,
+            oe_get_tsc(),
+            &arg_out);
 
         // Reset the flag
         thread_data->flags &= (~_OE_THREAD_HANDLING_EXCEPTION);
@@ -0,0 +1,70 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/trace.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "sgx_u.h"
+
+/* The size of the first buffer that the profile is read into. */
+#define _INITIAL_BUFFER_SIZE (64 * 1024)
+
+/* The number of times the profile is read again if it grows meanwhile. */
+#define _MAX_RETRIES 4
+
+oe_result_t oe_dump_heap_profile(oe_enclave_t* enclave, const char* path)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_result_t retval = OE_UNEXPECTED;
+    char* buffer = NULL;
+    size_t buffer_size = _INITIAL_BUFFER_SIZE;
+    size_t profile_size = 0;
+    FILE* stream = NULL;
+
+    if (!enclave || !path)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    for (size_t i = 0; i <= _MAX_RETRIES; i++)
+    {
+        char* p;
+
+        if (!(p = realloc(buffer, buffer_size)))
+            OE_RAISE(OE_OUT_OF_MEMORY);
+
+        buffer = p;
+
+        OE_CHECK(oe_get_heap_profile_ecall(
+            enclave, &retval, buffer, buffer_size, &profile_size));
+
+        if (retval != OE_BUFFER_TOO_SMALL)
+            break;
+
+        /* Leave room for the samples taken until the next call. */
+        buffer_size = profile_size + profile_size / 4;
+    }
+
+    OE_CHECK(retval);
+
+#if defined(_WIN32)
+    if (fopen_s(&stream, path, "w") != 0)
+        stream = NULL;
+#else
+    stream = fopen(path, "w");
+#endif
+    if (!stream)
+        OE_RAISE_MSG(OE_FAILURE, "cannot open %s", path);
+
+    if (fwrite(buffer, 1, profile_size, stream) != profile_size)
+        OE_RAISE_MSG(OE_FAILURE, "cannot write %s", path);
+
+    result = OE_OK;
+
+done:
+    if (stream)
+        fclose(stream);
+
+    free(buffer);
+    return result;
+}
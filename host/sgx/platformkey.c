@@ -0,0 +1,42 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include "../platformkey.h"
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/report.h>
+#include <openenclave/internal/sgx/plugin.h>
+#include <string.h>
+#include "../../common/sgx/endorsements.h"
+
+oe_result_t oe_get_evidence_platform_key(
+    const oe_uuid_t* format_id,
+    const uint8_t* data,
+    size_t data_size,
+    OE_SHA256* key)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    const oe_uuid_t sgx_format_id = {OE_SGX_PLUGIN_UUID};
+    const oe_report_header_t* header = (const oe_report_header_t*)data;
+
+    if (!format_id || !data || !key)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (memcmp(format_id, &sgx_format_id, sizeof(oe_uuid_t)) != 0)
+        OE_RAISE_NO_TRACE(OE_UNSUPPORTED);
+
+    if (data_size < sizeof(*header) ||
+        data_size - sizeof(*header) < header->report_size)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    // Local reports are verified without endorsements.
+    if (header->report_type != OE_REPORT_TYPE_SGX_REMOTE)
+        OE_RAISE_NO_TRACE(OE_UNSUPPORTED);
+
+    OE_CHECK(oe_get_sgx_endorsements_key(
+        header->report, header->report_size, key));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
@@ -9,6 +9,7 @@
 
 // Override oe_call_enclave_function() with _call_sgx_enclave_function().
 #define oe_call_enclave_function _call_sgx_enclave_function
+#define oe_call_enclave_function_batch _call_sgx_enclave_function_batch
 
 /* The ocall edge routines will use this function to route ecalls. */
 static oe_result_t _call_sgx_enclave_function(
@@ -31,6 +32,15 @@ static oe_result_t _call_sgx_enclave_function(
         output_bytes_written);
 }
 
+static oe_result_t _call_sgx_enclave_function_batch(
+    oe_enclave_t* enclave,
+    oe_enclave_function_call_t* calls,
+    size_t num_calls)
+{
+    return oe_call_enclave_function_batch_by_table_id(
+        enclave, OE_SGX_ECALL_FUNCTION_TABLE_ID, calls, num_calls);
+}
+
 /* Ignore missing edge-routine prototypes. */
 #if defined(__GNUC__)
 #pragma GCC diagnostic ignored "-Wmissing-prototypes"
@@ -47,5 +57,14 @@ oe_result_t oe_register_sgx_ocall_function_table(void)
     const oe_ocall_func_t* ocalls = __sgx_ocall_function_table;
     const size_t num_ocalls = OE_COUNTOF(__sgx_ocall_function_table);
 
+    /* The name tables end with NULL. */
+    oe_register_call_function_names(
+        table_id,
+        ocalls,
+        __sgx_ecall_function_names,
+        OE_COUNTOF(__sgx_ecall_function_names) - 1,
+        __sgx_ocall_function_names,
+        OE_COUNTOF(__sgx_ocall_function_names) - 1);
+
     return oe_register_ocall_function_table(table_id, ocalls, num_ocalls);
 }
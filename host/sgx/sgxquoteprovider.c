@@ -2,6 +2,9 @@
 // Licensed under the MIT License.
 
 #include <openenclave/bits/safecrt.h>
+#include <openenclave/internal/atomic.h>
+#include <openenclave/internal/crypto/sha.h>
+#include <openenclave/internal/datetime.h>
 #include <openenclave/internal/hexdump.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/trace.h>
@@ -9,9 +12,19 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "../../common/sgx/collateral.h"
+#include "../dupenv.h"
+#include "../fopen.h"
 #include "../hostthread.h"
 #include "sgxquoteprovider.h"
 
+#if defined(_WIN32)
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
 /**
  * This file manages the dcap_quoteprov shared library.
  * It loads the library during program startup and keeps it loaded until the
@@ -50,6 +63,305 @@ done:
     return result;
 }
 
+/**
+ * On-disk cache of the collateral fetched from the quote provider, shared by
+ * all processes on the host. It is enabled by setting the environment
+ * variable OE_SGX_COLLATERAL_CACHE_DIR to an existing directory. Each fetch
+ * is stored in its own file until the earliest nextUpdate of the collateral
+ * it contains. The collateral is signed, so a damaged or modified file can
+ * only cause a verification failure; files that cannot be read are ignored
+ * and fetched again.
+ *
+ * File format: header, num_items item sizes (uint64_t), item data.
+ */
+#define COLLATERAL_CACHE_DIR_ENV "OE_SGX_COLLATERAL_CACHE_DIR"
+#define COLLATERAL_CACHE_MAGIC "OECOLL01"
+#define COLLATERAL_CACHE_MAX_ITEMS 8
+#define COLLATERAL_CACHE_MAX_ITEM_SIZE (1024 * 1024)
+
+typedef struct _collateral_cache_header
+{
+    char magic[8];
+    oe_datetime_t expiry;
+    uint32_t num_items;
+} collateral_cache_header_t;
+
+/* Get the path of the cache file for the collateral identified by the given
+ * bytes, or NULL if the cache is disabled. */
+static char* _get_collateral_cache_path(
+    const char* kind,
+    const uint8_t* id,
+    size_t id_size)
+{
+    char* dir = oe_dupenv(COLLATERAL_CACHE_DIR_ENV);
+    oe_sha256_context_t context;
+    OE_SHA256 hash;
+    char* path = NULL;
+    size_t path_size;
+    size_t n;
+
+    if (!dir || !*dir)
+        goto done;
+
+    if (oe_sha256_init(&context) != OE_OK ||
+        oe_sha256_update(&context, id, id_size) != OE_OK ||
+        oe_sha256_final(&context, &hash) != OE_OK)
+        goto done;
+
+    path_size = strlen(dir) + strlen(kind) + 2 * sizeof(hash.buf) + 3;
+    if (!(path = (char*)malloc(path_size)))
+        goto done;
+
+    n = (size_t)snprintf(path, path_size, "%s/%s-", dir, kind);
+    for (size_t i = 0; i < sizeof(hash.buf); i++)
+        n += (size_t)snprintf(path + n, path_size - n, "%02x", hash.buf[i]);
+
+done:
+    free(dir);
+    return path;
+}
+
+/* Read a cache file into a single buffer. Returns OE_NOT_FOUND if there is
+ * no usable file. */
+static oe_result_t _read_collateral_cache(
+    const char* path,
+    uint32_t num_items,
+    uint8_t** buffer_out,
+    uint8_t** items,
+    size_t* sizes)
+{
+    oe_result_t result = OE_NOT_FOUND;
+    FILE* stream = NULL;
+    collateral_cache_header_t header;
+    uint64_t item_sizes[COLLATERAL_CACHE_MAX_ITEMS];
+    oe_datetime_t now;
+    size_t total = 0;
+    uint8_t* buffer = NULL;
+    uint8_t* p;
+
+    if (oe_fopen(&stream, path, "rb") != 0)
+        goto done;
+
+    if (fread(&header, sizeof(header), 1, stream) != 1 ||
+        memcmp(header.magic, COLLATERAL_CACHE_MAGIC, sizeof(header.magic)) !=
+            0 ||
+        header.num_items != num_items || num_items > OE_COUNTOF(item_sizes))
+        goto done;
+
+    if (oe_datetime_now(&now) != OE_OK ||
+        oe_datetime_compare(&now, &header.expiry) >= 0)
+        goto done;
+
+    if (fread(item_sizes, sizeof(uint64_t), num_items, stream) != num_items)
+        goto done;
+
+    for (uint32_t i = 0; i < num_items; i++)
+    {
+        if (item_sizes[i] == 0 ||
+            item_sizes[i] > COLLATERAL_CACHE_MAX_ITEM_SIZE)
+            goto done;
+        total += (size_t)item_sizes[i];
+    }
+
+    if (!(buffer = (uint8_t*)malloc(total)))
+        goto done;
+
+    if (fread(buffer, 1, total, stream) != total)
+        goto done;
+
+    p = buffer;
+    for (uint32_t i = 0; i < num_items; i++)
+    {
+        items[i] = p;
+        sizes[i] = (size_t)item_sizes[i];
+        p += sizes[i];
+    }
+
+    OE_TRACE_INFO("Read cached collateral from %s\n", path);
+    *buffer_out = buffer;
+    buffer = NULL;
+    result = OE_OK;
+
+done:
+    if (stream)
+        fclose(stream);
+    free(buffer);
+
+    return result;
+}
+
+/* Write a cache file. It is written under a temporary name first so that
+ * readers never see a partial file. The name is unique to the process and
+ * the call, so that concurrent writers of the same entry never share it. */
+static void _write_collateral_cache(
+    const char* path,
+    const oe_datetime_t* expiry,
+    uint32_t num_items,
+    uint8_t* const* items,
+    const size_t* sizes)
+{
+    FILE* stream = NULL;
+    collateral_cache_header_t header = {{0}};
+    uint64_t item_sizes[COLLATERAL_CACHE_MAX_ITEMS];
+    static volatile uint64_t counter;
+    char* temp_path = NULL;
+    size_t temp_path_size = strlen(path) + sizeof(".4294967295.") + 20 + 4;
+    bool written = false;
+
+    if (num_items > OE_COUNTOF(item_sizes))
+        return;
+
+    if (!(temp_path = (char*)malloc(temp_path_size)))
+        return;
+    snprintf(
+        temp_path,
+        temp_path_size,
+        "%s.%u.%llu.tmp",
+        path,
+        (unsigned int)getpid(),
+        (unsigned long long)oe_atomic_increment(&counter));
+
+    /* Never write into a file left behind by a process with the same id. */
+    if (oe_fopen(&stream, temp_path, "wbx") != 0)
+        goto done;
+
+    memcpy(header.magic, COLLATERAL_CACHE_MAGIC, sizeof(header.magic));
+    header.expiry = *expiry;
+    header.num_items = num_items;
+    for (uint32_t i = 0; i < num_items; i++)
+        item_sizes[i] = sizes[i];
+
+    if (fwrite(&header, sizeof(header), 1, stream) != 1 ||
+        fwrite(item_sizes, sizeof(uint64_t), num_items, stream) != num_items)
+        goto done;
+
+    for (uint32_t i = 0; i < num_items; i++)
+    {
+        if (fwrite(items[i], 1, sizes[i], stream) != sizes[i])
+            goto done;
+    }
+
+    written = true;
+
+done:
+    if (stream && fclose(stream) != 0)
+        written = false;
+
+    if (written)
+    {
+        // rename() does not replace an existing file on Windows.
+        remove(path);
+        if (rename(temp_path, path) == 0)
+            OE_TRACE_INFO("Cached collateral in %s\n", path);
+    }
+    else if (stream)
+    {
+        remove(temp_path);
+    }
+
+    free(temp_path);
+}
+
+/* The revocation info items in cache file order. */
+static uint32_t _get_revocation_info_items(
+    oe_get_revocation_info_args_t* args,
+    uint8_t*** items,
+    size_t** sizes)
+{
+    uint32_t n = 0;
+
+    items[n] = &args->tcb_info;
+    sizes[n++] = &args->tcb_info_size;
+    items[n] = &args->tcb_issuer_chain;
+    sizes[n++] = &args->tcb_issuer_chain_size;
+
+    for (uint32_t i = 0; i < args->num_crl_urls; i++)
+    {
+        items[n] = &args->crl[i];
+        sizes[n++] = &args->crl_size[i];
+        items[n] = &args->crl_issuer_chain[i];
+        sizes[n++] = &args->crl_issuer_chain_size[i];
+    }
+
+    return n;
+}
+
+static char* _get_revocation_info_cache_path(
+    const oe_get_revocation_info_args_t* args)
+{
+    uint8_t id[1024];
+    size_t id_size = 0;
+
+    OE_STATIC_ASSERT(sizeof(args->fmspc) < sizeof(id));
+    memcpy(id, args->fmspc, sizeof(args->fmspc));
+    id_size += sizeof(args->fmspc);
+
+    // The URLs are separated by their terminating null characters.
+    for (uint32_t i = 0; i < args->num_crl_urls; i++)
+    {
+        size_t length = strlen(args->crl_urls[i]) + 1;
+
+        if (length > sizeof(id) - id_size)
+            return NULL;
+
+        memcpy(id + id_size, args->crl_urls[i], length);
+        id_size += length;
+    }
+
+    return _get_collateral_cache_path("revocation", id, id_size);
+}
+
+static oe_result_t _read_cached_revocation_info(
+    const char* path,
+    oe_get_revocation_info_args_t* args)
+{
+    oe_result_t result = OE_NOT_FOUND;
+    uint8_t** fields[COLLATERAL_CACHE_MAX_ITEMS];
+    size_t* field_sizes[COLLATERAL_CACHE_MAX_ITEMS];
+    uint8_t* items[COLLATERAL_CACHE_MAX_ITEMS];
+    size_t sizes[COLLATERAL_CACHE_MAX_ITEMS];
+    uint32_t n;
+
+    if (args->num_crl_urls > OE_COUNTOF(args->crl))
+        return result;
+
+    n = _get_revocation_info_items(args, fields, field_sizes);
+    if (_read_collateral_cache(path, n, &args->buffer, items, sizes) != OE_OK)
+        return result;
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        *fields[i] = items[i];
+        *field_sizes[i] = sizes[i];
+    }
+
+    return OE_OK;
+}
+
+static void _write_cached_revocation_info(
+    const char* path,
+    oe_get_revocation_info_args_t* args)
+{
+    uint8_t** fields[COLLATERAL_CACHE_MAX_ITEMS];
+    size_t* field_sizes[COLLATERAL_CACHE_MAX_ITEMS];
+    uint8_t* items[COLLATERAL_CACHE_MAX_ITEMS];
+    size_t sizes[COLLATERAL_CACHE_MAX_ITEMS];
+    oe_datetime_t expiry;
+    uint32_t n;
+
+    if (oe_sgx_get_revocation_info_expiry(args, &expiry) != OE_OK)
+        return;
+
+    n = _get_revocation_info_items(args, fields, field_sizes);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        items[i] = *fields[i];
+        sizes[i] = *field_sizes[i];
+    }
+
+    _write_collateral_cache(path, &expiry, n, items, sizes);
+}
+
 oe_result_t oe_get_revocation_info(oe_get_revocation_info_args_t* args)
 {
     oe_result_t result = OE_FAILURE;
@@ -59,12 +371,20 @@ oe_result_t oe_get_revocation_info(oe_get_revocation_info_args_t* args)
     uint32_t host_buffer_size = 0;
     uint8_t* p = 0;
     uint8_t* p_end = 0;
+    char* cache_path = NULL;
 
     OE_CHECK(oe_initialize_quote_provider());
 
     if (!provider.get_revocation_info || !provider.free_revocation_info)
         OE_RAISE(OE_QUOTE_PROVIDER_LOAD_ERROR);
 
+    cache_path = _get_revocation_info_cache_path(args);
+    if (cache_path && _read_cached_revocation_info(cache_path, args) == OE_OK)
+    {
+        result = OE_OK;
+        goto done;
+    }
+
     params.version = SGX_QL_REVOCATION_INFO_VERSION_1;
     params.fmspc = args->fmspc;
     params.fmspc_size = sizeof(args->fmspc);
@@ -224,10 +544,14 @@ oe_result_t oe_get_revocation_info(oe_get_revocation_info_args_t* args)
     if (p != p_end)
         OE_RAISE(OE_UNEXPECTED);
 
+    if (cache_path)
+        _write_cached_revocation_info(cache_path, args);
+
     result = OE_OK;
 done:
     if (revocation_info != NULL)
         provider.free_revocation_info(revocation_info);
+    free(cache_path);
 
     return result;
 }
@@ -249,6 +573,10 @@ oe_result_t oe_get_qe_identity_info(oe_get_qe_identity_info_args_t* args)
     uint32_t host_buffer_size = 0;
     uint8_t* p = 0;
     uint8_t* p_end = 0;
+    char* cache_path = NULL;
+    uint8_t* items[2];
+    size_t sizes[2];
+    oe_datetime_t expiry;
     OE_TRACE_INFO("Calling %s\n", __FUNCTION__);
 
     OE_CHECK(oe_initialize_quote_provider());
@@ -261,6 +589,24 @@ oe_result_t oe_get_qe_identity_info(oe_get_qe_identity_info_args_t* args)
         goto done;
     }
 
+    // The QE identity is the same for all platforms.
+    cache_path = _get_collateral_cache_path(
+        "qe_identity", (const uint8_t*)"qe_identity", sizeof("qe_identity"));
+    if (cache_path && _read_collateral_cache(
+                          cache_path,
+                          OE_COUNTOF(items),
+                          &args->host_out_buffer,
+                          items,
+                          sizes) == OE_OK)
+    {
+        args->qe_id_info = items[0];
+        args->qe_id_info_size = sizes[0];
+        args->issuer_chain = items[1];
+        args->issuer_chain_size = sizes[1];
+        result = OE_OK;
+        goto done;
+    }
+
     // fetch qe identity information
     r = provider.get_qe_identity_info(&identity);
     if (r != SGX_PLAT_ERROR_OK || identity == NULL)
@@ -320,12 +666,25 @@ oe_result_t oe_get_qe_identity_info(oe_get_qe_identity_info_args_t* args)
     if (p != p_end)
         OE_RAISE(OE_UNEXPECTED);
 
+    if (cache_path && oe_sgx_get_json_next_update(
+                          args->qe_id_info, args->qe_id_info_size, &expiry) ==
+                          OE_OK)
+    {
+        items[0] = args->qe_id_info;
+        sizes[0] = args->qe_id_info_size;
+        items[1] = args->issuer_chain;
+        sizes[1] = args->issuer_chain_size;
+        _write_collateral_cache(
+            cache_path, &expiry, OE_COUNTOF(items), items, sizes);
+    }
+
     result = OE_OK;
 done:
     if (identity != NULL)
     {
         provider.free_qe_identity_info(identity);
     }
+    free(cache_path);
     return result;
 }
 
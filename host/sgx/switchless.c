@@ -6,6 +6,7 @@
 #include <openenclave/internal/calls.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/switchless.h>
+#include <openenclave/internal/utils.h>
 #include "../calls.h"
 #include "../hostthread.h"
 #include "../ocalls.h"
@@ -16,6 +17,57 @@
  */
 #define OE_HOST_WORKER_SPIN_COUNT_THRESHOLD (4096U)
 
+/*
+** Execute the oldest asynchronous ocall of the ring, if there is one.
+** Return whether a call was executed.
+**
+*/
+static bool _run_async_ocall(oe_async_ocall_ring_t* ring, oe_enclave_t* enclave)
+{
+    const uint64_t mask = OE_ASYNC_OCALL_RING_SIZE - 1;
+    oe_async_ocall_slot_t* slot = NULL;
+    uint64_t pos = ring->tail;
+    size_t input_buffer_size;
+    size_t output_buffer_size;
+
+    // Claim the slot at the tail once the enclave has written its call.
+    for (;;)
+    {
+        slot = &ring->slots[pos & mask];
+        int64_t diff = (int64_t)(slot->sequence - (pos + 1));
+
+        if (diff < 0)
+            return false;
+
+        if (diff == 0 &&
+            oe_atomic_compare_and_swap(
+                (int64_t volatile*)&ring->tail, (int64_t)pos, (int64_t)pos + 1))
+            break;
+
+        pos = ring->tail;
+    }
+
+    OE_ATOMIC_MEMORY_BARRIER_ACQUIRE();
+
+    // The buffers are in the slot. Drop calls whose sizes do not fit.
+    input_buffer_size = slot->args.input_buffer_size;
+    output_buffer_size = slot->args.output_buffer_size;
+
+    if (input_buffer_size <= OE_ASYNC_OCALL_BUFFER_SIZE &&
+        output_buffer_size <= OE_ASYNC_OCALL_BUFFER_SIZE - input_buffer_size)
+    {
+        slot->args.input_buffer = slot->buffer;
+        slot->args.output_buffer = slot->buffer + input_buffer_size;
+        oe_handle_call_host_function((uint64_t)&slot->args, enclave);
+    }
+
+    // Free the slot for the next round.
+    OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+    slot->sequence = pos + OE_ASYNC_OCALL_RING_SIZE;
+
+    return true;
+}
+
 /*
 ** The thread function that handles switchless ocalls
 **
@@ -23,6 +75,8 @@
 static void* _switchless_ocall_worker(void* arg)
 {
     oe_host_worker_context_t* context = (oe_host_worker_context_t*)arg;
+    oe_async_ocall_ring_t* ring =
+        context->enclave->switchless_manager->async_ocall_ring;
 
     while (!context->is_stopping)
     {
@@ -38,6 +92,13 @@ static void* _switchless_ocall_worker(void* arg)
             context->total_spin_count += context->spin_count;
             context->spin_count = 0;
         }
+        else if (_run_async_ocall(ring, context->enclave))
+        {
+            // Asynchronous ocalls only run while no synchronous switchless
+            // ocall, which has an enclave thread waiting for it, is posted.
+            context->total_spin_count += context->spin_count;
+            context->spin_count = 0;
+        }
         else
         {
             // If there is no message, increment spin count until threshold is
@@ -89,6 +150,7 @@ oe_result_t oe_start_switchless_manager(
     oe_switchless_call_manager_t* manager = NULL;
     oe_host_worker_context_t* contexts = NULL;
     oe_thread_t* threads = NULL;
+    oe_async_ocall_ring_t* ring = NULL;
 
     if (num_host_workers < 1 || enclave == NULL)
         OE_RAISE(OE_INVALID_PARAMETER);
@@ -116,9 +178,22 @@ oe_result_t oe_start_switchless_manager(
     if (threads == NULL)
         OE_RAISE(OE_OUT_OF_MEMORY);
 
+    ring = calloc(1, sizeof(oe_async_ocall_ring_t));
+    if (ring == NULL)
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    // Every slot is free for the first round.
+    for (uint64_t i = 0; i < OE_ASYNC_OCALL_RING_SIZE; i++)
+        ring->slots[i].sequence = i;
+
     manager->num_host_workers = num_host_workers;
     manager->host_worker_contexts = contexts;
     manager->host_worker_threads = threads;
+    manager->async_ocall_ring = ring;
+
+    // Each enclave has at most one switchless manager. The worker threads
+    // find the ring of asynchronous ocalls through it.
+    enclave->switchless_manager = manager;
 
     // Start the worker threads, and assign each one a private context.
     for (size_t i = 0; i < num_host_workers; i++)
@@ -135,9 +210,6 @@ oe_result_t oe_start_switchless_manager(
         }
     }
 
-    // Each enclave has at most one switchless manager.
-    enclave->switchless_manager = manager;
-
     // Inform the enclave about the switchless manager through an ECALL
     OE_CHECK(oe_ecall(
         enclave,
@@ -162,6 +234,9 @@ done:
 
         if (threads)
             free(threads);
+
+        if (ring)
+            free(ring);
     }
 
     return result;
@@ -172,7 +247,20 @@ oe_result_t oe_stop_switchless_manager(oe_enclave_t* enclave)
     oe_result_t result = OE_UNEXPECTED;
     if (enclave != NULL && enclave->switchless_manager != NULL)
     {
-        OE_CHECK(oe_stop_worker_threads(enclave->switchless_manager));
+        oe_switchless_call_manager_t* manager = enclave->switchless_manager;
+
+        OE_CHECK(oe_stop_worker_threads(manager));
+
+        // Run the asynchronous ocalls that are still queued, so that none is
+        // lost when the enclave is terminated.
+        if (manager->async_ocall_ring)
+        {
+            while (_run_async_ocall(manager->async_ocall_ring, enclave))
+                ;
+
+            free(manager->async_ocall_ring);
+            manager->async_ocall_ring = NULL;
+        }
     }
     result = OE_OK;
 done:
@@ -0,0 +1,122 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <inttypes.h>
+#include <openenclave/host.h>
+#include <openenclave/internal/cpuid.h>
+#include <openenclave/internal/elf.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/trapprofile.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "enclave.h"
+#include "sgx_u.h"
+
+static const char* _instruction_name(uint16_t opcode)
+{
+    switch (opcode)
+    {
+        case OE_CPUID_OPCODE:
+            return "cpuid";
+        case OE_RDTSC_OPCODE:
+            return "rdtsc";
+        default:
+            return "other";
+    }
+}
+
+/* Sort the instructions by decreasing number of traps. */
+static int _compare_entries(const void* left, const void* right)
+{
+    const oe_trap_profile_entry_t* a = (const oe_trap_profile_entry_t*)left;
+    const oe_trap_profile_entry_t* b = (const oe_trap_profile_entry_t*)right;
+
+    if (a->count != b->count)
+        return a->count > b->count ? -1 : 1;
+
+    return a->address < b->address ? -1 : a->address > b->address;
+}
+
+oe_result_t oe_dump_trap_profile(oe_enclave_t* enclave, FILE* stream)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_result_t retval = OE_UNEXPECTED;
+    oe_trap_profile_entry_t* entries = NULL;
+    size_t num_entries = 0;
+    uint64_t num_dropped = 0;
+    uint64_t total = 0;
+    elf64_t elf = ELF64_INIT;
+    bool elf_loaded = false;
+
+    if (!enclave || enclave->magic != ENCLAVE_MAGIC || !stream)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (!(entries = calloc(OE_TRAP_PROFILE_SIZE, sizeof(*entries))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    /* The table of the enclave never holds more than this. */
+    OE_CHECK(oe_get_trap_profile_ecall(
+        enclave,
+        &retval,
+        entries,
+        OE_TRAP_PROFILE_SIZE * sizeof(*entries),
+        &num_entries,
+        &num_dropped));
+    OE_CHECK(retval);
+
+    if (num_entries > OE_TRAP_PROFILE_SIZE)
+        OE_RAISE(OE_UNEXPECTED);
+
+    qsort(entries, num_entries, sizeof(*entries), _compare_entries);
+
+    /* The function names are only available if the image has symbols. */
+    elf_loaded = enclave->path && elf64_load(enclave->path, &elf) == 0;
+
+    for (size_t i = 0; i < num_entries; i++)
+        total += entries[i].count;
+
+    fprintf(
+        stream,
+        "Illegal instruction traps of enclave %s: %" PRIu64 "\n"
+        "%-6s %-18s %12s %12s %s\n",
+        enclave->path ? enclave->path : "",
+        total + num_dropped,
+        "instr",
+        "offset",
+        "traps",
+        "emulated",
+        "function");
+
+    for (size_t i = 0; i < num_entries; i++)
+    {
+        const oe_trap_profile_entry_t* entry = &entries[i];
+        const char* name = NULL;
+
+        if (elf_loaded)
+            name = elf64_get_function_name(&elf, entry->address);
+
+        fprintf(
+            stream,
+            "%-6s 0x%016" PRIx64 " %12" PRIu64 " %12" PRIu64 " %s\n",
+            _instruction_name(entry->opcode),
+            entry->address,
+            entry->count,
+            entry->emulated,
+            name ? name : "<unknown>");
+    }
+
+    if (num_dropped)
+        fprintf(
+            stream,
+            "%" PRIu64 " traps of other instructions were not recorded\n",
+            num_dropped);
+
+    result = OE_OK;
+
+done:
+    if (elf_loaded)
+        elf64_unload(&elf);
+
+    free(entries);
+    return result;
+}
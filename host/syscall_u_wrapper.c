@@ -15,6 +15,7 @@
 
 /* Override oe_call_enclave_function() calls with _call_enclave_function(). */
 #define oe_call_enclave_function _call_enclave_function
+#define oe_call_enclave_function_batch _call_enclave_function_batch
 
 /* The ocall edge routines will use this function to route ecalls. */
 static oe_result_t _call_enclave_function(
@@ -37,6 +38,15 @@ static oe_result_t _call_enclave_function(
         output_bytes_written);
 }
 
+static oe_result_t _call_enclave_function_batch(
+    oe_enclave_t* enclave,
+    oe_enclave_function_call_t* calls,
+    size_t num_calls)
+{
+    return oe_call_enclave_function_batch_by_table_id(
+        enclave, OE_SYSCALL_ECALL_FUNCTION_TABLE_ID, calls, num_calls);
+}
+
 /* Ignore missing edge-routine prototypes. */
 #if defined(__GNUC__)
 #pragma GCC diagnostic ignored "-Wmissing-prototypes"
@@ -58,6 +68,15 @@ static void _once_function(void)
         fprintf(stderr, "%s(%u): %s(): failed\n", __FILE__, __LINE__, func);
         abort();
     }
+
+    /* The name tables end with NULL. */
+    oe_register_call_function_names(
+        OE_SYSCALL_OCALL_FUNCTION_TABLE_ID,
+        __syscall_ocall_function_table,
+        __syscall_ecall_function_names,
+        OE_COUNTOF(__syscall_ecall_function_names) - 1,
+        __syscall_ocall_function_names,
+        OE_COUNTOF(__syscall_ocall_function_names) - 1);
 }
 
 void oe_register_syscall_ocall_function_table(void)
@@ -44,6 +44,13 @@ int oe_thread_equal(oe_thread_t thread1, oe_thread_t thread2)
     return thread1 == thread2;
 }
 
+size_t oe_thread_get_processor_count(void)
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? info.dwNumberOfProcessors : 1;
+}
+
 /*
 **==============================================================================
 **
@@ -127,11 +134,22 @@ int oe_mutex_destroy(oe_mutex* Lock)
 **==============================================================================
 */
 
+/* The keys are fiber-local storage indexes, which behave as thread-local
+ * storage indexes for the threads that do not use fibers, but also support
+ * destructors. */
+
 int oe_thread_key_create(oe_thread_key* key)
+{
+    return oe_thread_key_create_with_destructor(key, NULL);
+}
+
+int oe_thread_key_create_with_destructor(
+    oe_thread_key* key,
+    void (*destructor)(void*))
 {
     oe_thread_key k;
-    k = TlsAlloc();
-    if (k == TLS_OUT_OF_INDEXES)
+    k = FlsAlloc((PFLS_CALLBACK_FUNCTION)destructor);
+    if (k == FLS_OUT_OF_INDEXES)
         return 1;
 
     *key = k;
@@ -140,15 +158,15 @@ int oe_thread_key_create(oe_thread_key* key)
 
 int oe_thread_key_delete(oe_thread_key key)
 {
-    return !TlsFree(key);
+    return !FlsFree(key);
 }
 
 int oe_thread_setspecific(oe_thread_key key, void* value)
 {
-    return !TlsSetValue(key, value);
+    return !FlsSetValue(key, value);
 }
 
 void* oe_thread_getspecific(oe_thread_key key)
 {
-    return TlsGetValue(key);
+    return FlsGetValue(key);
 }
@@ -478,6 +478,48 @@ done:
     return ret;
 }
 
+ssize_t oe_syscall_pread_ocall(
+    oe_host_fd_t fd,
+    void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    OE_UNUSED(fd);
+    OE_UNUSED(buf);
+    OE_UNUSED(count);
+    OE_UNUSED(offset);
+
+    PANIC;
+}
+
+ssize_t oe_syscall_pwrite_ocall(
+    oe_host_fd_t fd,
+    const void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    OE_UNUSED(fd);
+    OE_UNUSED(buf);
+    OE_UNUSED(count);
+    OE_UNUSED(offset);
+
+    PANIC;
+}
+
+ssize_t oe_syscall_sendfile_ocall(
+    oe_host_fd_t out_fd,
+    oe_host_fd_t in_fd,
+    oe_off_t* offset,
+    size_t count)
+{
+    OE_UNUSED(out_fd);
+    OE_UNUSED(in_fd);
+    OE_UNUSED(offset);
+    OE_UNUSED(count);
+
+    PANIC;
+}
+
 oe_off_t oe_syscall_lseek_ocall(oe_host_fd_t fd, oe_off_t offset, int whence)
 {
     OE_UNUSED(fd);
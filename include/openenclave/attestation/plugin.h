@@ -411,6 +411,69 @@ oe_result_t oe_verify_evidence(
     oe_claim_t** claims,
     size_t* claims_length);
 
+/**
+ * A piece of evidence to verify with oe_verify_evidence_batch() and the
+ * result of its verification.
+ */
+typedef struct _oe_evidence_batch_item
+{
+    /** The evidence buffer. */
+    const uint8_t* evidence_buffer;
+
+    /** The size of evidence_buffer in bytes. */
+    size_t evidence_buffer_size;
+
+    /** The optional endorsements buffer. */
+    const uint8_t* endorsements_buffer;
+
+    /** The size of endorsements_buffer in bytes. */
+    size_t endorsements_buffer_size;
+
+    /** Set to the result of oe_verify_evidence() for this item. */
+    oe_result_t result;
+
+    /**
+     * Set to the list of claims if the item was verified. The caller must
+     * free it with oe_free_claims_list().
+     */
+    oe_claim_t* claims;
+
+    /** Set to the length of the claims list. */
+    size_t claims_length;
+} oe_evidence_batch_item_t;
+
+/**
+ * oe_verify_evidence_batch
+ *
+ * Verifies many pieces of evidence with oe_verify_evidence(), using a pool of
+ * threads. This function is only available on the host.
+ *
+ * Items that share their endorsements (or, without endorsements, their
+ * evidence format and platform) are grouped. One item of each group is
+ * verified before the rest, so that the collateral it parses is cached once
+ * and then shared by the other items of the group instead of being parsed by
+ * several threads at the same time.
+ *
+ * The result and claims of each item are returned in the item. Verifiers must
+ * not be registered or unregistered while this function runs.
+ *
+ * @param[in,out] items The items to verify.
+ * @param[in] items_length The number of items.
+ * @param[in] policies An optional list of policies to use for every item.
+ * @param[in] policies_size The size of the policy list.
+ * @param[in] num_threads The maximum number of threads verifying items,
+ * including the calling thread, or zero to use one per processor.
+ * @retval OE_OK Every item was processed (see each item's result).
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ * @retval OE_OUT_OF_MEMORY Failed to allocate memory.
+ */
+oe_result_t oe_verify_evidence_batch(
+    oe_evidence_batch_item_t* items,
+    size_t items_length,
+    const oe_policy_t* policies,
+    size_t policies_size,
+    size_t num_threads);
+
 /**
  * oe_free_claims_list
  *
@@ -0,0 +1,126 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+/**
+ * @file channel.h
+ *
+ * This file defines the types and functions of the shared-memory channels,
+ * which are common to the host and the enclave.
+ *
+ * A channel is a region of host memory that the host and the enclave share.
+ * It holds two single-producer/single-consumer rings of messages, one in
+ * each direction, and a data area. The data itself stays in the data area:
+ * the messages only carry its offset and size, so bulk data is passed to
+ * the enclave without being marshalled by an ECALL.
+ *
+ */
+#ifndef _OE_BITS_CHANNEL_H
+#define _OE_BITS_CHANNEL_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/result.h>
+#include <openenclave/bits/types.h>
+
+OE_EXTERNC_BEGIN
+
+/** The alignment of the region of a channel. */
+#define OE_CHANNEL_ALIGNMENT 64
+
+/**
+ * Describes a channel to the enclave. The host gets it with
+ * oe_channel_get_descriptor() and passes it to an ECALL, by value or as an
+ * [in] pointer, as in this EDL function:
+ *
+ *     public oe_result_t enc_open_channel(oe_channel_descriptor_t channel);
+ *
+ * The enclave then opens the channel with oe_channel_open().
+ */
+typedef struct _oe_channel_descriptor
+{
+    /** The address of the region of the channel in host memory. */
+    void* region;
+
+    /** The size of the region. */
+    uint64_t region_size;
+
+    /** The number of messages each ring of the channel holds. */
+    uint64_t num_slots;
+} oe_channel_descriptor_t;
+
+/**
+ * A message sent over a channel. It refers to data in the data area of the
+ * channel.
+ */
+typedef struct _oe_channel_message
+{
+    /** The offset of the data in the data area of the channel. */
+    uint64_t offset;
+
+    /** The size of the data. */
+    uint64_t size;
+
+    /** A value defined by the application. */
+    uint64_t tag;
+} oe_channel_message_t;
+
+/** A channel opened by the host or by the enclave. */
+typedef struct _oe_channel oe_channel_t;
+
+/**
+ * Send a message over a channel.
+ *
+ * The data that the message refers to must have been written to the data
+ * area of the channel (see oe_channel_get_data()) before the message is
+ * sent. Only one thread of each side may send messages over a channel at a
+ * time.
+ *
+ * @param channel The channel.
+ * @param message The message to send.
+ *
+ * @retval OE_OK The message was sent.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ * @retval OE_OUT_OF_BOUNDS The message refers to data outside of the data
+ * area.
+ * @retval OE_BUSY The ring of the channel is full.
+ */
+oe_result_t oe_channel_send(
+    oe_channel_t* channel,
+    const oe_channel_message_t* message);
+
+/**
+ * Receive a message from a channel.
+ *
+ * Only one thread of each side may receive messages from a channel at a
+ * time.
+ *
+ * @param channel The channel.
+ * @param message The message received.
+ *
+ * @retval OE_OK A message was received.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ * @retval OE_NOT_FOUND The ring of the channel is empty.
+ * @retval OE_OUT_OF_BOUNDS The message refers to data outside of the data
+ * area. The message is dropped.
+ * @retval OE_UNEXPECTED The ring of the channel is corrupted.
+ */
+oe_result_t oe_channel_receive(
+    oe_channel_t* channel,
+    oe_channel_message_t* message);
+
+/**
+ * Get the data area of a channel, in host memory.
+ *
+ * The enclave writes the data of the messages that it sends there directly.
+ * The host may change the data area at any time, so the enclave reads the
+ * data of the messages that it receives with oe_channel_snapshot().
+ *
+ * @param channel The channel.
+ * @param size Set to the size of the data area.
+ *
+ * @returns The data area, or NULL if a parameter is invalid.
+ */
+void* oe_channel_get_data(oe_channel_t* channel, size_t* size);
+
+OE_EXTERNC_END
+
+#endif /* _OE_BITS_CHANNEL_H */
@@ -0,0 +1,70 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+/**
+ * @file console.h
+ *
+ * This file defines functions that control buffering of the enclave's
+ * standard output and standard error.
+ *
+ */
+#ifndef _OE_BITS_CONSOLE_H
+#define _OE_BITS_CONSOLE_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/types.h>
+
+OE_EXTERNC_BEGIN
+
+/**
+ * Buffering modes passed to oe_console_setvbuf(). These have the values of
+ * the C library's **_IOFBF**, **_IOLBF** and **_IONBF**.
+ */
+#define OE_IOFBF 0
+#define OE_IOLBF 1
+#define OE_IONBF 2
+
+/** Buffer size used when oe_console_setvbuf() is passed a size of zero. */
+#define OE_CONSOLE_BUFFER_SIZE 4096
+
+/**
+ * Set the buffering mode of the enclave's standard output or standard error.
+ *
+ * By default, every write to these file descriptors is passed to the host
+ * with its own OCALL. This function enables buffering in the enclave
+ * instead, using a separate buffer for each enclave thread so that output
+ * from different threads is not interleaved within a buffer. A thread's
+ * buffers are written to the host:
+ *
+ *     - when a buffer fills up,
+ *     - after each newline (**OE_IOLBF** only),
+ *     - when oe_console_flush() or **fflush()** is called,
+ *     - when the thread reads from standard input,
+ *     - when the thread returns from its outermost ECALL, and
+ *     - when the enclave terminates or aborts.
+ *
+ * This is the file descriptor counterpart of **setvbuf()**, applied below
+ * the C library's own stream buffering.
+ *
+ * @param fd The file descriptor (**STDOUT_FILENO** or **STDERR_FILENO**).
+ * @param mode The buffering mode (**OE_IOFBF**, **OE_IOLBF** or
+ *        **OE_IONBF**).
+ * @param size The size of each per-thread buffer or zero for the default
+ *        size (**OE_CONSOLE_BUFFER_SIZE**).
+ *
+ * @return 0 on success or -1 (with errno set) on failure.
+ *
+ */
+int oe_console_setvbuf(int fd, int mode, size_t size);
+
+/**
+ * Write the calling thread's buffered console output to the host.
+ *
+ * @return 0 on success or -1 (with errno set) on failure.
+ *
+ */
+int oe_console_flush(void);
+
+OE_EXTERNC_END
+
+#endif /* _OE_BITS_CONSOLE_H */
@@ -25,6 +25,18 @@ OE_EXTERNC_BEGIN
  */
 #define OE_HOST_FILE_SYSTEM "oe_host_file_system"
 
+/**
+ * Name of the in-enclave RAM file system (passed to **mount()** as the
+ * **filesystemtype** parameter).
+ */
+#define OE_RAM_FILE_SYSTEM "oe_ram_file_system"
+
+/**
+ * Name of the encrypted, integrity-protected host file system (passed to
+ * **mount()** as the **filesystemtype** parameter).
+ */
+#define OE_PROTECTED_FILE_SYSTEM "oe_protected_file_system"
+
 OE_EXTERNC_END
 
 #endif /* _OE_BITS_FS_H */
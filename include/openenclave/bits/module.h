@@ -38,6 +38,35 @@ OE_EXTERNC_BEGIN
  */
 oe_result_t oe_load_module_host_file_system(void);
 
+/**
+ * Load the RAM file system module.
+ *
+ * This function loads the RAM file system module, which keeps files in
+ * enclave memory. Once loaded, the file system may be mounted at any path
+ * by passing **OE_RAM_FILE_SYSTEM** to **mount()**; file operations on that
+ * path are then performed without leaving the enclave.
+ *
+ * @retval OE_OK The module was successfully loaded.
+ * @retval OE_FAILURE Module failed to load.
+ *
+ */
+oe_result_t oe_load_module_ram_file_system(void);
+
+/**
+ * Load the protected file system module.
+ *
+ * This function loads the protected file system module, which stores files
+ * in a host directory encrypted and integrity-protected with a key derived
+ * from the enclave's seal key. Once loaded, a host directory may be mounted
+ * by passing **OE_PROTECTED_FILE_SYSTEM** to **mount()**. Decrypted blocks
+ * are cached in the enclave and written back in batches.
+ *
+ * @retval OE_OK The module was successfully loaded.
+ * @retval OE_FAILURE Module failed to load.
+ *
+ */
+oe_result_t oe_load_module_protected_file_system(void);
+
 /**
  * Load the host socket interface module.
  *
@@ -112,6 +112,34 @@ oe_result_t oe_switchless_call_host_function(
     size_t output_buffer_size,
     size_t* output_bytes_written);
 
+/**
+ * Perform a high-level host function call (OCALL) asynchronously.
+ *
+ * The input buffer is copied into a ring shared with the host worker threads
+ * that handle switchless ocalls, and the function returns without waiting
+ * for the host function to be called. The host function's output buffer is
+ * not returned. The call is made synchronously if the enclave has no host
+ * worker threads, the ring is full or the buffers do not fit in a slot of the
+ * ring. Use oe_flush_async_ocalls() to wait for the posted calls.
+ *
+ * @param function_id The id of the host function that will be called.
+ * @param input_buffer Buffer containing inputs data.
+ * @param input_buffer_size Size of the input data buffer.
+ * @param output_buffer Buffer where the outputs of the host function are
+ * written to when the call is made synchronously.
+ * @param output_buffer_size Size of the output buffer.
+ *
+ * @return OE_OK the call was posted or made.
+ * @return OE_INVALID_PARAMETER a parameter is invalid.
+ * @return OE_FAILURE the synchronous call failed.
+ */
+oe_result_t oe_async_call_host_function(
+    size_t function_id,
+    const void* input_buffer,
+    size_t input_buffer_size,
+    void* output_buffer,
+    size_t output_buffer_size);
+
 /**
  * Allocate a buffer of given size for doing an ocall.
  *
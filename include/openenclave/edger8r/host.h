@@ -66,6 +66,66 @@ oe_result_t oe_call_enclave_function(
     size_t output_buffer_size,
     size_t* output_bytes_written);
 
+/**
+ * One of the calls made by **oe_call_enclave_function_batch()**.
+ */
+typedef struct _oe_enclave_function_call
+{
+    /** The id of the enclave function to call. */
+    uint64_t function_id;
+
+    /** The input and output buffers, as for oe_call_enclave_function(). */
+    const void* input_buffer;
+    size_t input_buffer_size;
+    void* output_buffer;
+    size_t output_buffer_size;
+
+    /** Set to the number of bytes written in the output buffer. */
+    size_t output_bytes_written;
+
+    /** Set to the result of the call. */
+    oe_result_t result;
+} oe_enclave_function_call_t;
+
+/**
+ * Perform several high-level enclave function calls in a single ECALL.
+ *
+ * The calls are made one after the other, in order, by a single enclave
+ * thread, so the cost of entering and leaving the enclave is paid once for
+ * the whole batch. A call that fails does not stop the calls after it: the
+ * result of each call is returned in its **result** field.
+ *
+ * @param calls The calls to make.
+ * @param num_calls The number of calls.
+ *
+ * @return OE_OK the batch was executed. The result of each call is in its
+ * **result** field.
+ * @return OE_INVALID_PARAMETER a parameter is invalid.
+ * @return OE_OUT_OF_MEMORY the batch could not be allocated.
+ */
+oe_result_t oe_call_enclave_function_batch(
+    oe_enclave_t* enclave,
+    oe_enclave_function_call_t* calls,
+    size_t num_calls);
+
+/**
+ * Allocate a buffer to marshal the parameters of an ECALL. Each thread keeps
+ * a small buffer for its next ECALL, so that small ECALLs do not allocate
+ * memory.
+ *
+ * @param size The size of the buffer.
+ *
+ * @return The buffer, or NULL if it could not be allocated.
+ */
+void* oe_allocate_ecall_buffer(size_t size);
+
+/**
+ * Free a buffer allocated with oe_allocate_ecall_buffer().
+ *
+ * @param buffer The buffer to free.
+ */
+void oe_free_ecall_buffer(void* buffer);
+
 /**
  * Placeholder.
  */
@@ -78,6 +138,28 @@ oe_result_t oe_switchless_call_enclave_function(
     size_t output_buffer_size,
     size_t* output_bytes_written);
 
+/**
+ * Register the names of the functions of an EDL file, which the call profiler
+ * (see **oe_start_call_profiling()**) reports with the counters of each
+ * function. This is called by the edge routines generated by oeedger8r.
+ *
+ * @param table_id The id of the function tables of the EDL file, or
+ * OE_UINT64_MAX for the EDL file of an enclave.
+ * @param ocall_table The ocall table of the EDL file, which identifies the
+ * EDL file of an enclave when **table_id** is OE_UINT64_MAX.
+ * @param ecall_names The names of the ecalls, indexed by function id.
+ * @param num_ecalls The number of names in **ecall_names**.
+ * @param ocall_names The names of the ocalls, indexed by function id.
+ * @param num_ocalls The number of names in **ocall_names**.
+ */
+void oe_register_call_function_names(
+    uint64_t table_id,
+    const oe_ocall_func_t* ocall_table,
+    const char* const* ecall_names,
+    size_t num_ecalls,
+    const char* const* ocall_names,
+    size_t num_ocalls);
+
 OE_EXTERNC_END
 
 #endif // _OE_EDGER8R_HOST_H
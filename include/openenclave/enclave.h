@@ -14,6 +14,8 @@
 #error "enclave.h and host.h must not be included in the same compilation unit."
 #endif
 
+#include "bits/channel.h"
+#include "bits/console.h"
 #include "bits/defs.h"
 #include "bits/exception.h"
 #include "bits/fs.h"
@@ -199,6 +201,185 @@ void oe_host_free(void* ptr);
  */
 char* oe_host_strndup(const char* str, size_t n);
 
+/**
+ * Wait until the host has executed the asynchronous ocalls posted so far.
+ *
+ * OCALLs declared with the **transition_async** attribute in EDL return
+ * without waiting for the host function to be called, and are executed by
+ * the host worker threads in no particular order. This function returns once
+ * every asynchronous ocall posted before it, by any enclave thread, has been
+ * executed.
+ *
+ * @retval OE_OK The asynchronous ocalls have been executed.
+ */
+oe_result_t oe_flush_async_ocalls(void);
+
+/**
+ * Open a shared-memory channel created by the host.
+ *
+ * The region of the channel must lie entirely outside the enclave, and must
+ * not overlap the region of another channel opened by the enclave. The
+ * channel stays open until oe_channel_close() is called, so that the
+ * enclave only validates it once, and the host must not free the region
+ * before then.
+ *
+ * @param descriptor The descriptor of the channel, from
+ * oe_channel_get_descriptor() on the host.
+ * @param channel Set to the channel.
+ *
+ * @retval OE_OK The channel was opened.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid, or the
+ * region is not outside the enclave.
+ * @retval OE_BAD_ALIGNMENT The region is not aligned on
+ * **OE_CHANNEL_ALIGNMENT** bytes.
+ * @retval OE_BUFFER_TOO_SMALL The region is too small for its rings.
+ * @retval OE_ALREADY_EXISTS The region overlaps an open channel.
+ * @retval OE_OUT_OF_MEMORY Failed to allocate memory.
+ */
+oe_result_t oe_channel_open(
+    const oe_channel_descriptor_t* descriptor,
+    oe_channel_t** channel);
+
+/**
+ * Close a channel opened with oe_channel_open().
+ *
+ * @param channel The channel.
+ *
+ * @retval OE_OK The channel was closed.
+ * @retval OE_INVALID_PARAMETER The channel is NULL.
+ * @retval OE_NOT_FOUND The channel is not open.
+ */
+oe_result_t oe_channel_close(oe_channel_t* channel);
+
+/**
+ * Copy a slice of the data of a message received from a channel to enclave
+ * memory.
+ *
+ * The host may change the data area of the channel at any time. This
+ * function reads the slice once after checking its bounds, so the enclave
+ * can use the copy safely. Only the slices that the enclave consumes need
+ * to be copied.
+ *
+ * @param channel The channel.
+ * @param message The message, from oe_channel_receive().
+ * @param offset The offset of the slice in the data of the message.
+ * @param buffer The buffer to copy the slice to, in enclave memory.
+ * @param size The size of the slice.
+ *
+ * @retval OE_OK The slice was copied.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid, or the
+ * buffer is not within the enclave.
+ * @retval OE_OUT_OF_BOUNDS The slice is not within the data of the message,
+ * or the data of the message is not within the data area.
+ * @retval OE_INTEGER_OVERFLOW The end of the slice overflows.
+ */
+oe_result_t oe_channel_snapshot(
+    oe_channel_t* channel,
+    const oe_channel_message_t* message,
+    size_t offset,
+    void* buffer,
+    size_t size);
+
+/**
+ * Start sampling the heap allocations of the enclave.
+ *
+ * Each enclave thread samples one allocation every **sample_interval** bytes
+ * that it allocates on average, so that an allocation is sampled with a
+ * probability proportional to its size, and records its backtrace. The
+ * samples of the blocks that are still allocated make up the heap profile
+ * (see oe_get_heap_profile()). Sampling takes no lock, and the allocations
+ * that are not sampled only update a per-thread counter.
+ *
+ * The backtraces are obtained by following the frame pointers, which the
+ * allocation functions of the SDK keep. Past a function that does not keep a
+ * frame pointer, the frames are missing or wrong, so the backtraces are only
+ * reliable if the enclave is built with -fno-omit-frame-pointer.
+ *
+ * @param sample_interval The mean number of bytes allocated between two
+ * samples, or zero for the default of 512 KiB.
+ *
+ * @retval OE_OK Profiling was started.
+ * @retval OE_INVALID_PARAMETER The interval is larger than 4 GiB.
+ * @retval OE_OUT_OF_MEMORY Failed to allocate memory.
+ */
+oe_result_t oe_start_heap_profiling(size_t sample_interval);
+
+/**
+ * Stop sampling the heap allocations of the enclave.
+ *
+ * The samples of the blocks that are still allocated are kept, and are
+ * removed as the blocks are freed.
+ *
+ * @retval OE_OK Profiling was stopped.
+ */
+oe_result_t oe_stop_heap_profiling(void);
+
+/**
+ * Get a snapshot of the heap profile of the enclave.
+ *
+ * The profile is the text of a heap profile of gperftools, which pprof
+ * reads, with the symbols of the enclave functions. It estimates the number
+ * of blocks and bytes that are allocated from each backtrace. The host can
+ * also write it to a file with oe_dump_heap_profile().
+ *
+ * @param profile Set to the profile, to be freed with oe_free().
+ * @param profile_size Set to the length of the profile.
+ *
+ * @retval OE_OK The profile was returned.
+ * @retval OE_INVALID_PARAMETER At least one parameter is NULL.
+ * @retval OE_OUT_OF_MEMORY Failed to allocate memory.
+ */
+oe_result_t oe_get_heap_profile(char** profile, size_t* profile_size);
+
+/**
+ * Get the CPUID information of a leaf from the table that the enclave
+ * cached at its creation.
+ *
+ * CPUID is illegal in an SGX enclave: executing it exits the enclave, and
+ * the host enters the enclave again to emulate it from the same table. This
+ * function returns the same values without the trap, so it should be used
+ * by code that checks CPU features often. The values come from the host and
+ * are not trusted.
+ *
+ * This function is only supported in SGX enclaves.
+ *
+ * @param leaf The CPUID leaf (EAX): 0, 1, 4 or 7.
+ * @param subleaf The CPUID subleaf (ECX), which must be 0 for leaf 4.
+ * @param eax Set to the value of EAX.
+ * @param ebx Set to the value of EBX.
+ * @param ecx Set to the value of ECX.
+ * @param edx Set to the value of EDX.
+ *
+ * @retval OE_OK The values were returned.
+ * @retval OE_INVALID_PARAMETER At least one parameter is NULL.
+ * @retval OE_UNSUPPORTED The leaf or subleaf is not cached.
+ */
+oe_result_t oe_cpuid(
+    uint32_t leaf,
+    uint32_t subleaf,
+    uint32_t* eax,
+    uint32_t* ebx,
+    uint32_t* ecx,
+    uint32_t* edx);
+
+/**
+ * Read the time stamp counter.
+ *
+ * RDTSC is legal in an SGX2 enclave, and is executed as such. On SGX1 it
+ * traps, and is emulated with the time stamp counter of the host. Once it
+ * has trapped, this function reads the time stamp counter with an OCALL,
+ * which costs less than the trap. The value is not trusted in either case.
+ *
+ * The RDTSC instructions of the enclave itself are only emulated this way if
+ * the enclave has no vectored exception handler. Otherwise their traps are
+ * dispatched to the handlers.
+ *
+ * This function is only supported in SGX enclaves.
+ *
+ * @returns The time stamp counter, or 0 if it could not be read.
+ */
+uint64_t oe_rdtsc(void);
+
 /**
  * Abort execution of the enclave.
  *
@@ -577,6 +758,205 @@ oe_result_t oe_get_seal_key_v2(
  */
 void oe_free_seal_key(uint8_t* key_buffer, uint8_t* key_info);
 
+/**
+ * Wipe the platform keys cached by the enclave.
+ *
+ * The report keys used by oe_verify_report() and the seal keys returned by
+ * oe_get_seal_key*() and used by oe_seal() are requested from the processor
+ * once and then kept in enclave memory. This function discards them, and the
+ * AES-GCM contexts that oe_seal() and oe_unseal() expanded from the seal keys,
+ * so the next use requests them again. The cache is also wiped when the
+ * enclave is terminated.
+ */
+void oe_clear_key_cache(void);
+
+/**
+ * The size of the header of a sealed blob.
+ */
+#define OE_SEAL_HEADER_SIZE 80
+
+/**
+ * The number of bytes added to each chunk of a sealed blob (its AES-GCM tag).
+ */
+#define OE_SEAL_CHUNK_OVERHEAD 16
+
+/**
+ * The chunk size used by oe_seal() and by default by oe_seal_init().
+ */
+#define OE_SEAL_DEFAULT_CHUNK_SIZE (64 * 1024)
+
+/**
+ * Opaque state of a chunked seal or unseal operation.
+ */
+typedef struct _oe_seal_context oe_seal_context_t;
+
+/**
+ * Seal data for this enclave with AES-GCM.
+ *
+ * The data is encrypted with a seal key derived according to the given
+ * policy. The key is derived once and cached inside the enclave, so sealing
+ * does not request a key from the platform each time. The key is renewed
+ * (with a new random key ID) after many uses to bound the number of random
+ * nonces used with it.
+ *
+ * A sealed blob (format version 1) consists of a header of
+ * OE_SEAL_HEADER_SIZE bytes, which holds the information needed to derive the
+ * seal key again and the nonce, followed by the plaintext split into chunks
+ * of the chunk size given in the header (the last chunk may be shorter or
+ * empty), each encrypted and followed by its AES-GCM tag. Every chunk
+ * authenticates the header, the additional data, its index and whether it is
+ * the last chunk, so chunks cannot be reordered, dropped or truncated.
+ *
+ * @param[in] seal_policy The policy for the identity properties used to derive
+ * the seal key.
+ * @param[in] plaintext The data to seal.
+ * @param[in] plaintext_size The size of the data to seal.
+ * @param[in] additional_data Optional data that is authenticated but not
+ * encrypted or stored in the blob. It must be passed to oe_unseal() again.
+ * @param[in] additional_data_size The size of the additional data.
+ * @param[out] blob The buffer that receives the sealed blob.
+ * @param[in,out] blob_size The size of the blob buffer on input and the size
+ * of the sealed blob on output.
+ *
+ * @retval OE_OK The data was sealed.
+ * @retval OE_BUFFER_TOO_SMALL The blob buffer is too small (or NULL), in which
+ * case **blob_size** is set to the required size.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ * @retval OE_UNSUPPORTED The platform does not support sealing.
+ */
+oe_result_t oe_seal(
+    oe_seal_policy_t seal_policy,
+    const void* plaintext,
+    size_t plaintext_size,
+    const void* additional_data,
+    size_t additional_data_size,
+    uint8_t* blob,
+    size_t* blob_size);
+
+/**
+ * Unseal a blob created by oe_seal() or by oe_seal_init() and
+ * oe_seal_update().
+ *
+ * @param[in] blob The sealed blob.
+ * @param[in] blob_size The size of the sealed blob.
+ * @param[in] additional_data The additional data passed when sealing.
+ * @param[in] additional_data_size The size of the additional data.
+ * @param[out] plaintext The buffer that receives the unsealed data.
+ * @param[in,out] plaintext_size The size of the plaintext buffer on input
+ * and the size of the unsealed data on output.
+ *
+ * @retval OE_OK The blob was unsealed.
+ * @retval OE_BUFFER_TOO_SMALL The plaintext buffer is too small (or NULL), in
+ * which case **plaintext_size** is set to the required size.
+ * @retval OE_CRYPTO_ERROR The blob or the additional data is not authentic.
+ * @retval OE_UNSUPPORTED The blob has an unsupported format version.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ * @retval OE_INVALID_CPUSVN or OE_INVALID_ISVSVN The seal key of the blob
+ * cannot be derived by this enclave (e.g. it was sealed by a newer version).
+ */
+oe_result_t oe_unseal(
+    const uint8_t* blob,
+    size_t blob_size,
+    const void* additional_data,
+    size_t additional_data_size,
+    uint8_t* plaintext,
+    size_t* plaintext_size);
+
+/**
+ * Start sealing data in chunks, e.g. to seal a large file without holding all
+ * of it in enclave memory. The header and the sealed chunks, concatenated in
+ * order, form a blob that oe_unseal() accepts.
+ *
+ * @param[in] seal_policy The policy for the identity properties used to derive
+ * the seal key.
+ * @param[in] chunk_size The size of each chunk but the last, or 0 for
+ * OE_SEAL_DEFAULT_CHUNK_SIZE.
+ * @param[in] additional_data Optional data that is authenticated but not
+ * encrypted or stored in the blob.
+ * @param[in] additional_data_size The size of the additional data.
+ * @param[out] header The buffer that receives the header of the blob.
+ * @param[out] context The sealing context, which must be freed with
+ * oe_seal_free().
+ *
+ * @retval OE_OK on success.
+ */
+oe_result_t oe_seal_init(
+    oe_seal_policy_t seal_policy,
+    uint32_t chunk_size,
+    const void* additional_data,
+    size_t additional_data_size,
+    uint8_t header[OE_SEAL_HEADER_SIZE],
+    oe_seal_context_t** context);
+
+/**
+ * Seal the next chunk of data.
+ *
+ * @param[in] context The context created by oe_seal_init().
+ * @param[in] chunk The data of the chunk.
+ * @param[in] chunk_size The size of the chunk, which must be the chunk size
+ * passed to oe_seal_init() unless this is the last chunk.
+ * @param[in] final Whether this is the last chunk.
+ * @param[out] output The buffer that receives the sealed chunk of
+ * chunk_size + OE_SEAL_CHUNK_OVERHEAD bytes.
+ *
+ * @retval OE_OK on success.
+ * @retval OE_INVALID_PARAMETER The chunk size is wrong or the last chunk was
+ * already sealed.
+ */
+oe_result_t oe_seal_update(
+    oe_seal_context_t* context,
+    const void* chunk,
+    size_t chunk_size,
+    bool final,
+    uint8_t* output);
+
+/**
+ * Start unsealing a blob in chunks.
+ *
+ * @param[in] header The header of the blob.
+ * @param[in] additional_data The additional data passed when sealing.
+ * @param[in] additional_data_size The size of the additional data.
+ * @param[out] chunk_size The chunk size of the blob. Every sealed chunk but the
+ * last one has chunk_size + OE_SEAL_CHUNK_OVERHEAD bytes.
+ * @param[out] context The unsealing context, which must be freed with
+ * oe_seal_free().
+ *
+ * @retval OE_OK on success.
+ */
+oe_result_t oe_unseal_init(
+    const uint8_t header[OE_SEAL_HEADER_SIZE],
+    const void* additional_data,
+    size_t additional_data_size,
+    uint32_t* chunk_size,
+    oe_seal_context_t** context);
+
+/**
+ * Unseal the next chunk of a blob. The data is only complete once the last
+ * chunk (with final set) was unsealed.
+ *
+ * @param[in] context The context created by oe_unseal_init().
+ * @param[in] sealed_chunk The sealed chunk.
+ * @param[in] sealed_chunk_size The size of the sealed chunk.
+ * @param[in] final Whether this is the last chunk of the blob.
+ * @param[out] output The buffer that receives the
+ * sealed_chunk_size - OE_SEAL_CHUNK_OVERHEAD bytes of unsealed data.
+ *
+ * @retval OE_OK on success.
+ * @retval OE_CRYPTO_ERROR The chunk is not authentic, or is not the chunk
+ * that follows the previous one, or final does not match.
+ */
+oe_result_t oe_unseal_update(
+    oe_seal_context_t* context,
+    const uint8_t* sealed_chunk,
+    size_t sealed_chunk_size,
+    bool final,
+    uint8_t* output);
+
+/**
+ * Free a context created by oe_seal_init() or oe_unseal_init(). Accepts NULL.
+ */
+void oe_seal_free(oe_seal_context_t* context);
+
 /**
  * Obtains the enclave handle.
  *
@@ -634,6 +1014,44 @@ oe_result_t oe_generate_attestation_certificate(
     uint8_t** output_cert,
     size_t* output_cert_size);
 
+/**
+ * oe_set_evidence_cache_freshness
+ *
+ * Enable reuse of the evidence generated by the enclave. While enabled,
+ * oe_generate_attestation_certificate() returns the certificate it generated
+ * for the same subject name and keys, and oe_get_evidence() with the SGX
+ * plugin reuses the quote generated for the same custom claims, as long as
+ * they are no older than freshness_seconds. A verifier that requires fresher
+ * evidence must use a nonce in the custom claims or a new key.
+ *
+ * Cached evidence is due for a refresh after half of the freshness window.
+ * oe_refresh_evidence_cache() regenerates it so that a new certificate is
+ * ready before the old one expires.
+ *
+ * Setting a new freshness window drops all cached evidence. Note that the
+ * time inside the enclave is provided by the host.
+ *
+ * @param[in] freshness_seconds The time in seconds for which evidence is
+ * reused, or 0 to disable the cache (the default).
+ * @retval OE_OK on success.
+ * @retval OE_UNSUPPORTED if the platform does not support the cache.
+ */
+oe_result_t oe_set_evidence_cache_freshness(uint32_t freshness_seconds);
+
+/**
+ * oe_refresh_evidence_cache
+ *
+ * Regenerate the cached evidence that is due for a refresh (see
+ * oe_set_evidence_cache_freshness()). The cached evidence remains in use
+ * while it is regenerated. The enclave has no threads of its own, so the
+ * application calls this function periodically (e.g. every quarter of the
+ * freshness window) from an ECALL on a thread that does not serve requests.
+ *
+ * @retval OE_OK on success or if the cache is disabled.
+ * @retval The first error that occurred while regenerating the evidence.
+ */
+oe_result_t oe_refresh_evidence_cache(void);
+
 /**
  * Free the given cert
  * @param[in] cert If not NULL, the buffer to free.
@@ -675,6 +1093,26 @@ oe_result_t oe_verify_attestation_certificate(
     oe_identity_verify_callback_t enclave_identity_callback,
     void* arg);
 
+/**
+ * oe_set_attestation_certificate_cache_ttl
+ *
+ * Enable caching of the certificates accepted by
+ * oe_verify_attestation_certificate(). A certificate that was accepted within
+ * the last ttl_seconds is accepted again without verifying its evidence,
+ * based on a hash of the certificate. The enclave_identity_callback is still
+ * called for every certificate. A cached certificate is never accepted after
+ * the certificate itself or the collateral of its evidence expires.
+ *
+ * Setting a new TTL drops all cached certificates.
+ *
+ * Note that the time inside the enclave is provided by the host, so the host
+ * can extend the lifetime of the cached certificates.
+ * @param[in] ttl_seconds The time in seconds for which an accepted certificate
+ * is cached, or 0 to disable the cache (the default).
+ * @retval OE_OK on success.
+ */
+oe_result_t oe_set_attestation_certificate_cache_ttl(uint32_t ttl_seconds);
+
 OE_EXTERNC_END
 
 #endif /* _OE_ENCLAVE_H */
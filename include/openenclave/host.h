@@ -20,6 +20,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "bits/channel.h"
 #include "bits/defs.h"
 #include "bits/report.h"
 #include "bits/result.h"
@@ -365,6 +366,255 @@ void oe_free_key(
     uint8_t* key_info,
     size_t key_info_size);
 
+/**
+ * The number of buckets of the latency histogram of a call profile entry.
+ *
+ * Latencies are recorded in nanoseconds. Bucket i counts the latency i for
+ * i < 8. Above that, each power of two is split into 8 buckets of equal
+ * width, so that bucket i starts at (8 + i % 8) << (i / 8 - 1). The last
+ * bucket also counts the latencies that are too large for it (above 17
+ * seconds).
+ */
+#define OE_CALL_PROFILE_HISTOGRAM_BUCKETS 256
+
+/**
+ * The counters of an EDL function, as returned by **oe_get_call_profile()**.
+ */
+typedef struct _oe_call_profile_entry
+{
+    /** Whether the function is an ocall (true) or an ecall (false) */
+    bool is_ocall;
+
+    /** The function table: OE_UINT64_MAX for the EDL file of the enclave,
+     * or the id of one of the EDL files of the SDK */
+    uint64_t table_id;
+
+    /** The function id within the table */
+    uint64_t function_id;
+
+    /** The name of the function, or NULL if it was not registered */
+    const char* name;
+
+    /** The number of calls */
+    uint64_t count;
+
+    /** The bytes marshalled into the callee (the input buffer) */
+    uint64_t bytes_in;
+
+    /** The bytes marshalled back to the caller (the output written) */
+    uint64_t bytes_out;
+
+    /** The ocalls handled by a switchless worker thread */
+    uint64_t switchless_hits;
+
+    /** The switchless ocalls that fell back to a regular ocall because no
+     * worker thread was available */
+    uint64_t switchless_misses;
+
+    /** The sum, minimum and maximum latency of the calls in nanoseconds */
+    uint64_t total_ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+
+    /** The latency histogram (see OE_CALL_PROFILE_HISTOGRAM_BUCKETS) */
+    uint64_t histogram[OE_CALL_PROFILE_HISTOGRAM_BUCKETS];
+} oe_call_profile_entry_t;
+
+/**
+ * Start recording the calls between the host and the enclave.
+ *
+ * Each host thread records the calls it makes or handles in its own counters,
+ * which are merged when the profile is read, so that recording takes no lock.
+ * The latency of an ecall is measured on the host from the enclave entry to
+ * the enclave exit, and includes the ocalls it makes. The latency of an ocall
+ * is the time the host takes to handle it. Calls made through the internal
+ * ecalls and ocalls of the SDK (such as memory allocation and thread
+ * synchronization) are not recorded.
+ *
+ * Profiling can be stopped and started again; the counters are kept until the
+ * enclave is terminated.
+ *
+ * This function is only supported for SGX enclaves.
+ *
+ * @param[in] enclave The enclave to profile.
+ * @param[in] dump_interval_ms If non-zero, the profile is written every
+ * **dump_interval_ms** milliseconds (as **oe_dump_call_profile()** does) by
+ * a background thread, and once more when the enclave is terminated.
+ * @param[in] dump_path The file the profile is appended to, or NULL to write
+ * it to stderr.
+ *
+ * @retval OE_OK Profiling was started.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ * @retval OE_OUT_OF_MEMORY Failed to allocate memory.
+ * @retval OE_UNSUPPORTED The enclave type does not support profiling.
+ */
+oe_result_t oe_start_call_profiling(
+    oe_enclave_t* enclave,
+    uint32_t dump_interval_ms,
+    const char* dump_path);
+
+/**
+ * Stop recording the calls between the host and the enclave, and stop the
+ * periodic dump of the profile.
+ *
+ * @param[in] enclave The enclave being profiled.
+ *
+ * @retval OE_OK Profiling was stopped.
+ * @retval OE_INVALID_PARAMETER The enclave is not valid.
+ * @retval OE_UNSUPPORTED The enclave type does not support profiling.
+ */
+oe_result_t oe_stop_call_profiling(oe_enclave_t* enclave);
+
+/**
+ * Get the counters of the EDL functions that were called since profiling was
+ * first started, sorted by decreasing total latency.
+ *
+ * @param[in] enclave The enclave being profiled.
+ * @param[out] entries The counters, to be freed with
+ * **oe_free_call_profile()**. NULL if no call was recorded.
+ * @param[out] num_entries The number of entries.
+ *
+ * @retval OE_OK The profile was returned.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ * @retval OE_OUT_OF_MEMORY Failed to allocate memory.
+ * @retval OE_UNSUPPORTED The enclave type does not support profiling.
+ */
+oe_result_t oe_get_call_profile(
+    oe_enclave_t* enclave,
+    oe_call_profile_entry_t** entries,
+    size_t* num_entries);
+
+/**
+ * Free the entries returned by **oe_get_call_profile()**.
+ *
+ * @param[in] entries The entries to free.
+ */
+void oe_free_call_profile(oe_call_profile_entry_t* entries);
+
+/**
+ * Get a percentile of the latency of a call profile entry from its histogram.
+ *
+ * @param[in] entry The call profile entry.
+ * @param[in] percentile The percentile, between 0 and 100.
+ *
+ * @returns The upper bound of the histogram bucket of the percentile in
+ * nanoseconds, at most the maximum latency, or 0 if there were no calls.
+ */
+uint64_t oe_call_profile_percentile(
+    const oe_call_profile_entry_t* entry,
+    double percentile);
+
+/**
+ * Write the profile of an enclave as a table, one line per EDL function.
+ *
+ * @param[in] enclave The enclave being profiled.
+ * @param[in] stream The stream to write to.
+ *
+ * @retval OE_OK The profile was written.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ * @retval OE_OUT_OF_MEMORY Failed to allocate memory.
+ * @retval OE_UNSUPPORTED The enclave type does not support profiling.
+ */
+oe_result_t oe_dump_call_profile(oe_enclave_t* enclave, FILE* stream);
+
+/**
+ * Write a snapshot of the heap profile of an enclave to a file.
+ *
+ * The enclave samples its heap allocations once it has called
+ * **oe_start_heap_profiling()**. The file is a heap profile of gperftools,
+ * with the symbols of the enclave functions, which can be read with pprof:
+ *
+ *     pprof --text <path>
+ *
+ * This function is only supported for SGX enclaves.
+ *
+ * @param[in] enclave The enclave.
+ * @param[in] path The file to write the profile to. It is replaced if it
+ * exists.
+ *
+ * @retval OE_OK The profile was written.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ * @retval OE_OUT_OF_MEMORY Failed to allocate memory.
+ * @retval OE_FAILURE Failed to write the file.
+ * @retval OE_UNSUPPORTED The enclave type does not support heap profiling.
+ */
+oe_result_t oe_dump_heap_profile(oe_enclave_t* enclave, const char* path);
+
+/**
+ * Write the number of illegal instruction traps of an enclave, per
+ * instruction.
+ *
+ * An instruction that is illegal in an SGX enclave, such as CPUID or RDTSC
+ * on SGX1, exits the enclave, and the host enters the enclave again to
+ * emulate it or to dispatch the exception to the enclave handlers. The
+ * enclave counts the traps of each instruction, which are written one line
+ * per instruction, from the most frequent, with the function of the
+ * instruction when the enclave image has symbols. The code that traps often
+ * can use oe_cpuid() and oe_rdtsc() instead.
+ *
+ * This function is only supported for SGX enclaves.
+ *
+ * @param[in] enclave The enclave.
+ * @param[in] stream The stream to write to.
+ *
+ * @retval OE_OK The traps were written.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ * @retval OE_OUT_OF_MEMORY Failed to allocate memory.
+ * @retval OE_UNSUPPORTED The enclave type does not support trap counting.
+ */
+oe_result_t oe_dump_trap_profile(oe_enclave_t* enclave, FILE* stream);
+
+/**
+ * Create a shared-memory channel over a region of host memory.
+ *
+ * The region holds the rings of the channel followed by its data area (see
+ * oe_channel_get_data()). It is allocated by the caller, once, and must not
+ * be freed before the channel is destroyed and closed by the enclave. The
+ * enclave opens the channel with oe_channel_open(), from the descriptor
+ * returned by oe_channel_get_descriptor().
+ *
+ * @param[in] region The region, aligned on **OE_CHANNEL_ALIGNMENT** bytes.
+ * @param[in] region_size The size of the region.
+ * @param[in] num_slots The number of messages each ring holds, a power of
+ * two.
+ * @param[out] channel Set to the channel.
+ *
+ * @retval OE_OK The channel was created.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ * @retval OE_BAD_ALIGNMENT The region is not aligned.
+ * @retval OE_BUFFER_TOO_SMALL The region is too small for its rings.
+ * @retval OE_OUT_OF_MEMORY Failed to allocate memory.
+ */
+oe_result_t oe_channel_create(
+    void* region,
+    size_t region_size,
+    size_t num_slots,
+    oe_channel_t** channel);
+
+/**
+ * Get the descriptor of a channel, to pass to the enclave.
+ *
+ * @param[in] channel The channel.
+ * @param[out] descriptor Set to the descriptor of the channel.
+ *
+ * @retval OE_OK The descriptor was returned.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ */
+oe_result_t oe_channel_get_descriptor(
+    oe_channel_t* channel,
+    oe_channel_descriptor_t* descriptor);
+
+/**
+ * Destroy a channel created with oe_channel_create(). The region of the
+ * channel is not freed.
+ *
+ * @param[in] channel The channel.
+ *
+ * @retval OE_OK The channel was destroyed.
+ * @retval OE_INVALID_PARAMETER The channel is invalid.
+ */
+oe_result_t oe_channel_destroy(oe_channel_t* channel);
+
 OE_EXTERNC_END
 
 #endif /* _OE_HOST_H */
@@ -83,6 +83,24 @@ oe_result_t oe_verify_attestation_certificate(
     oe_identity_verify_callback_t enclave_identity_callback,
     void* arg);
 
+/**
+ * oe_set_attestation_certificate_cache_ttl
+ *
+ * Enable caching of the certificates accepted by
+ * oe_verify_attestation_certificate(). A certificate that was accepted within
+ * the last ttl_seconds is accepted again without verifying its evidence,
+ * based on a hash of the certificate. The enclave_identity_callback is still
+ * called for every certificate. A cached certificate is never accepted after
+ * the certificate itself or the collateral of its evidence expires.
+ *
+ * Setting a new TTL drops all cached certificates.
+ *
+ * @param[in] ttl_seconds The time in seconds for which an accepted certificate
+ * is cached, or 0 to disable the cache (the default).
+ * @retval OE_OK on success.
+ */
+oe_result_t oe_set_attestation_certificate_cache_ttl(uint32_t ttl_seconds);
+
 OE_EXTERNC_END
 
 #endif
@@ -19,6 +19,16 @@ OE_EXTERNC_BEGIN
  */
 int oe_backtrace(void** buffer, int size);
 
+/**
+ * Like **oe_backtrace()**, but walks the frame pointers in all builds, not
+ * only in the builds with debug malloc. A function that does not keep a frame
+ * pointer is skipped and leaves whatever its callers hold in rbp as the next
+ * frame: the walk stops when that frame is outside the enclave or not above
+ * the current one, but the frames before that may be wrong. The backtrace is
+ * only reliable if every function on the stack keeps its frame pointer.
+ */
+int oe_backtrace_frames(void** buffer, int size);
+
 /**
  * This function behaves like the GNU **backtrace_symbols** function. See the
  * **backtrace_symbols** manpage for more information. The return value must
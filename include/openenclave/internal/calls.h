@@ -76,6 +76,7 @@ typedef enum _oe_func
     OE_ECALL_CALL_ENCLAVE_FUNCTION,
     OE_ECALL_VIRTUAL_EXCEPTION_HANDLER,
     OE_ECALL_INIT_CONTEXT_SWITCHLESS,
+    OE_ECALL_CALL_ENCLAVE_FUNCTION_BATCH,
     /* Caution: always add new ECALL function numbers here */
     OE_ECALL_MAX,
 
@@ -218,6 +219,53 @@ oe_result_t oe_call_enclave_function_by_table_id(
     size_t output_buffer_size,
     size_t* output_bytes_written);
 
+/*
+**==============================================================================
+**
+** oe_call_enclave_function_batch_args_t
+**
+**     The argument of OE_ECALL_CALL_ENCLAVE_FUNCTION_BATCH: the calls of the
+**     batch, which the enclave makes one after the other.
+**
+**==============================================================================
+*/
+
+typedef struct _oe_call_enclave_function_batch_args
+{
+    oe_call_enclave_function_args_t* calls;
+    size_t num_calls;
+} oe_call_enclave_function_batch_args_t;
+
+/*
+**==============================================================================
+**
+** oe_call_enclave_function_batch_by_table_id()
+**
+**==============================================================================
+*/
+
+struct _oe_enclave_function_call;
+
+oe_result_t oe_call_enclave_function_batch_by_table_id(
+    oe_enclave_t* enclave,
+    uint64_t table_id,
+    struct _oe_enclave_function_call* calls,
+    size_t num_calls);
+
+/*
+**==============================================================================
+**
+** OE_MAX_CACHED_ECALL_BUFFER_SIZE
+**
+**     The largest ECALL marshalling buffer that is kept for the next ECALL
+**     of the same thread, by the host and by the enclave. Bigger buffers are
+**     allocated and freed for each call.
+**
+**==============================================================================
+*/
+
+#define OE_MAX_CACHED_ECALL_BUFFER_SIZE (16 * 1024)
+
 /*
 **==============================================================================
 **
@@ -260,6 +308,26 @@ oe_result_t oe_call_host_function_by_table_id(
     size_t* output_bytes_written,
     bool switchless);
 
+/*
+**==============================================================================
+**
+** oe_async_call_host_function_by_table_id()
+**
+** Post a call to the host function specified by the given table-id and
+** function-id to the host worker threads and return without waiting for it.
+** The call is made synchronously when it cannot be posted.
+**
+**==============================================================================
+*/
+
+oe_result_t oe_async_call_host_function_by_table_id(
+    uint64_t table_id,
+    uint64_t function_id,
+    const void* input_buffer,
+    size_t input_buffer_size,
+    void* output_buffer,
+    size_t output_buffer_size);
+
 /*
 **==============================================================================
 **
@@ -432,6 +500,10 @@ void oe_register_syscall_ocall_function_table(void);
 /* Register the ECALL table needed by the SYSCALL interface (enclave side). */
 void oe_register_syscall_ecall_function_table(void);
 
+/* Set a function that oe_abort() calls once, before the enclave enters the
+ * aborting state, while OCALLs can still be made (enclave side). */
+void oe_set_abort_handler(void (*handler)(void));
+
 OE_EXTERNC_END
 
 #endif /* _OE_CALLS_H */
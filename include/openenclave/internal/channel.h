@@ -0,0 +1,90 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_INTERNAL_CHANNEL_H
+#define _OE_INTERNAL_CHANNEL_H
+
+#include <openenclave/bits/channel.h>
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/types.h>
+#include <openenclave/internal/defs.h>
+
+OE_EXTERNC_BEGIN
+
+/*
+**==============================================================================
+**
+** Layout of the region of a channel:
+**
+**     [ ring from the host to the enclave ]
+**     [ ring from the enclave to the host ]
+**     [ data area                         ]
+**
+** The layout is computed from the size of the region and the number of
+** slots of the rings, so the enclave does not read it from host memory.
+**
+**==============================================================================
+*/
+
+#define OE_CHANNEL_MAX_SLOTS (1024 * 1024)
+
+typedef struct _oe_channel_ring
+{
+    /* The number of messages received, written by the consumer. */
+    volatile uint64_t head;
+    uint8_t padding1[OE_CHANNEL_ALIGNMENT - sizeof(uint64_t)];
+
+    /* The number of messages sent, written by the producer. */
+    volatile uint64_t tail;
+    uint8_t padding2[OE_CHANNEL_ALIGNMENT - sizeof(uint64_t)];
+
+    oe_channel_message_t messages[];
+} oe_channel_ring_t;
+
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_channel_ring_t, tail) == OE_CHANNEL_ALIGNMENT);
+OE_STATIC_ASSERT(sizeof(oe_channel_ring_t) == 2 * OE_CHANNEL_ALIGNMENT);
+
+#define OE_CHANNEL_MAGIC 0x3e9c5a41d2b7f608
+
+struct _oe_channel
+{
+    uint64_t magic;
+
+    /* The region of the channel, in host memory. */
+    uint8_t* region;
+    uint64_t region_size;
+    uint64_t num_slots;
+
+    oe_channel_ring_t* send_ring;
+    oe_channel_ring_t* receive_ring;
+    uint8_t* data;
+    uint64_t data_size;
+
+    /* The indexes that this side writes to the rings. They are kept here so
+     * that the other side cannot change them. */
+    uint64_t send_tail;
+    uint64_t receive_head;
+
+    /* The next channel opened by the enclave. */
+    struct _oe_channel* next;
+};
+
+/* Set up a channel over the given region, from the host side or from the
+ * enclave side. The region must have been validated by the caller. */
+oe_result_t oe_channel_init(
+    oe_channel_t* channel,
+    void* region,
+    uint64_t region_size,
+    uint64_t num_slots,
+    bool is_host);
+
+/* Check that data of the given size at the given offset is within the data
+ * area of a channel. */
+bool oe_channel_is_within_data(
+    const oe_channel_t* channel,
+    uint64_t offset,
+    uint64_t size);
+
+OE_EXTERNC_END
+
+#endif /* _OE_INTERNAL_CHANNEL_H */
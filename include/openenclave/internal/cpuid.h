@@ -5,8 +5,10 @@
 #define _OE_CPUID_H
 
 #include <openenclave/bits/defs.h>
+#include <openenclave/bits/types.h>
 
 #define OE_CPUID_OPCODE 0xA20F
+#define OE_RDTSC_OPCODE 0x310F
 #define OE_CPUID_LEAF_COUNT 8
 #define OE_CPUID_EXTENDED_CPUID_LEAF 0x80000000
 
@@ -18,7 +20,11 @@
 
 #define OE_CPUID_AESNI_FEATURE 0x02000000u  /* Leaf 1, subleaf 0, ECX */
 #define OE_CPUID_RDRAND_FEATURE 0x40000000u /* Leaf 1, subleaf 0, ECX */
-#define OE_CPUID_RDSEED_FEATURE 0x00040000u /* Leaf 7, subleaf 0, EBX */
+#define OE_CPUID_OSXSAVE_FEATURE 0x08000000u /* Leaf 1, subleaf 0, ECX */
+#define OE_CPUID_RDSEED_FEATURE 0x00040000u  /* Leaf 7, subleaf 0, EBX */
+#define OE_CPUID_AVX2_FEATURE 0x00000020u    /* Leaf 7, subleaf 0, EBX */
+#define OE_CPUID_SHA_FEATURE 0x20000000u     /* Leaf 7, subleaf 0, EBX */
+#define OE_CPUID_ERMS_FEATURE 0x00000200u    /* Leaf 7, subleaf 0, EBX */
 
 /**
  * The list of cpuid leafs that are emulated.
@@ -33,4 +39,31 @@ OE_INLINE bool oe_is_emulated_cpuid_leaf(uint32_t leaf)
     return (leaf == 0) || (leaf == 1) || (leaf == 4) || (leaf == 7);
 }
 
+/**
+ * Check a feature bit of a leaf (subleaf 0) of the CPUID table cached at
+ * enclave creation, without executing CPUID (which traps in an SGX enclave).
+ * Only implemented in SGX enclaves.
+ *
+ * @param leaf The CPUID leaf, which must be one of the emulated leaves.
+ * @param feature The feature bit mask.
+ * @param feature_register The register holding the feature bit
+ *        (OE_CPUID_RAX, OE_CPUID_RBX, OE_CPUID_RCX or OE_CPUID_RDX).
+ *
+ * @returns true if all bits of the mask are set.
+ */
+bool oe_has_cpuid_feature(
+    uint32_t leaf,
+    uint32_t feature,
+    uint32_t feature_register);
+
+/**
+ * Check whether the CPUID table of the enclave has been initialized. Before
+ * that, oe_has_cpuid_feature() reports every feature as missing, so callers
+ * that cache its result must not cache a missing feature until then.
+ * Only implemented in SGX enclaves.
+ *
+ * @returns true once the table is initialized.
+ */
+bool oe_is_cpuid_initialized(void);
+
 #endif /* _OE_CPUID_H */
@@ -0,0 +1,97 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_GCM_H
+#define _OE_GCM_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/result.h>
+#include <openenclave/bits/types.h>
+
+OE_EXTERNC_BEGIN
+
+#define OE_GCM_IV_SIZE 12
+#define OE_GCM_TAG_SIZE 16
+
+/* Opaque representation of an AES-GCM context (with its expanded key) */
+typedef struct _oe_aes_gcm_context
+{
+    /* Internal private implementation */
+    uint64_t impl[64];
+} oe_aes_gcm_context_t;
+
+/**
+ * Initializes an AES-GCM context with the given key.
+ *
+ * The key schedule is computed once, so the context may be used for any
+ * number of encrypt and decrypt operations. Release the context with
+ * oe_aes_gcm_free().
+ *
+ * @param context handle of context to be initialized
+ * @param key the AES key
+ * @param key_size the size of the key in bytes (16, 24 or 32)
+ *
+ * @return OE_OK upon success
+ */
+oe_result_t oe_aes_gcm_init(
+    oe_aes_gcm_context_t* context,
+    const uint8_t* key,
+    size_t key_size);
+
+/**
+ * Encrypts and authenticates a buffer.
+ *
+ * @param context an initialized context
+ * @param iv the initialization vector (must be unique for each key)
+ * @param iv_size the size of the initialization vector in bytes
+ * @param aad additional data that is authenticated but not encrypted
+ * @param aad_size the size of the additional data
+ * @param input the plaintext
+ * @param size the size of the plaintext (and ciphertext)
+ * @param output buffer where the ciphertext is written (may equal input)
+ * @param tag buffer where the authentication tag is written
+ *
+ * @return OE_OK upon success
+ */
+oe_result_t oe_aes_gcm_encrypt(
+    oe_aes_gcm_context_t* context,
+    const uint8_t* iv,
+    size_t iv_size,
+    const uint8_t* aad,
+    size_t aad_size,
+    const uint8_t* input,
+    size_t size,
+    uint8_t* output,
+    uint8_t tag[OE_GCM_TAG_SIZE]);
+
+/**
+ * Authenticates and decrypts a buffer.
+ *
+ * The parameters are the same as for oe_aes_gcm_encrypt(), except that
+ * the tag is an input.
+ *
+ * @return OE_OK upon success
+ * @return OE_CRYPTO_ERROR if the ciphertext or additional data is not
+ *         authentic (in which case the output buffer is cleared)
+ */
+oe_result_t oe_aes_gcm_decrypt(
+    oe_aes_gcm_context_t* context,
+    const uint8_t* iv,
+    size_t iv_size,
+    const uint8_t* aad,
+    size_t aad_size,
+    const uint8_t* input,
+    size_t size,
+    uint8_t* output,
+    const uint8_t tag[OE_GCM_TAG_SIZE]);
+
+/**
+ * Releases an AES-GCM context and clears its key material.
+ *
+ * @param context handle of context to be released
+ */
+void oe_aes_gcm_free(oe_aes_gcm_context_t* context);
+
+OE_EXTERNC_END
+
+#endif /* _OE_GCM_H */
@@ -66,6 +66,27 @@ oe_result_t oe_sha256_update(
  */
 oe_result_t oe_sha256_final(oe_sha256_context_t* context, OE_SHA256* sha256);
 
+/**
+ * Computes the SHA-256 hashes of several buffers
+ *
+ * This function computes the same hashes as oe_sha256_init(),
+ * oe_sha256_update() and oe_sha256_final() on each buffer. Inside an enclave
+ * on a CPU with AVX2 but without the SHA extensions, it hashes up to eight
+ * buffers at once, which is much faster for many small buffers.
+ *
+ * @param data array of count buffers to be hashed
+ * @param sizes array of the sizes of the buffers
+ * @param count number of buffers
+ * @param hashes array of count hashes to be written
+ *
+ * @return OE_OK upon success
+ */
+oe_result_t oe_sha256_multi(
+    const void* const* data,
+    const size_t* sizes,
+    size_t count,
+    OE_SHA256* hashes);
+
 OE_EXTERNC_END
 
 #endif /* _OE_SHA_H */
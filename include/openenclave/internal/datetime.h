@@ -46,6 +46,11 @@ int32_t oe_datetime_compare(
  */
 oe_result_t oe_datetime_now(oe_datetime_t* value);
 
+/**
+ * Return the system time the given number of seconds from now in GMT time.
+ */
+oe_result_t oe_datetime_from_now(uint32_t seconds, oe_datetime_t* value);
+
 /**
  * Log the given datetime.
  */
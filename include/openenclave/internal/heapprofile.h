@@ -0,0 +1,37 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_INTERNAL_HEAPPROFILE_H
+#define _OE_INTERNAL_HEAPPROFILE_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/types.h>
+
+OE_EXTERNC_BEGIN
+
+/* The default mean number of bytes allocated between two samples. */
+#define OE_HEAP_PROFILE_DEFAULT_INTERVAL (512 * 1024)
+
+/* The number of samples of each buffer of an enclave thread. A thread whose
+ * samples are all live gets another buffer. */
+#define OE_HEAP_PROFILE_SAMPLES_PER_THREAD 128
+
+/* The number of slots of the index of the live samples. */
+#define OE_HEAP_PROFILE_INDEX_SIZE 8192
+
+/* Called by the allocator after a block of the given size was allocated. */
+void oe_heap_profile_malloc(void* ptr, size_t size);
+
+/* Called by the allocator before a block is freed. */
+void oe_heap_profile_free(void* ptr);
+
+/* Called by the allocator before a block is reallocated. Returns a handle
+ * for oe_heap_profile_realloc_end(), to which the allocator then passes
+ * whether the reallocation failed, in which case the block keeps its sample.
+ */
+void* oe_heap_profile_realloc_begin(void* ptr);
+void oe_heap_profile_realloc_end(void* handle, bool failed);
+
+OE_EXTERNC_END
+
+#endif /* _OE_INTERNAL_HEAPPROFILE_H */
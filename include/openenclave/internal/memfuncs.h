@@ -0,0 +1,42 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_INTERNAL_MEMFUNCS_H
+#define _OE_INTERNAL_MEMFUNCS_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/types.h>
+#include <openenclave/corelibc/bits/defs.h>
+
+OE_EXTERNC_BEGIN
+
+/* The size from which memcpy() and memset() use REP MOVSB and REP STOSB when
+ * the CPU has enhanced REP MOVSB/STOSB (ERMS). */
+#define OE_MEMFUNCS_ERMS_THRESHOLD 2048
+
+/* The implementations that the SGX memcpy(), memmove(), memset() and
+ * memcmp() of oecore were selected to use. */
+#define OE_MEMFUNCS_GENERIC 0
+#define OE_MEMFUNCS_SSE2 1
+#define OE_MEMFUNCS_AVX2 2
+
+/* Select the implementation of the mem functions from the CPUID table, once
+ * it is initialized. The portable versions are used until then. */
+void oe_initialize_memfuncs(void);
+
+/* Get the selected implementation (OE_MEMFUNCS_GENERIC, OE_MEMFUNCS_SSE2 or
+ * OE_MEMFUNCS_AVX2), and whether the CPU has ERMS. */
+int oe_get_memfuncs(bool* erms);
+
+/* The portable versions of the mem functions, from musl. */
+void* oe_generic_memcpy(
+    void* OE_RESTRICT dest,
+    const void* OE_RESTRICT src,
+    size_t n);
+void* oe_generic_memmove(void* dest, const void* src, size_t n);
+void* oe_generic_memset(void* dest, int c, size_t n);
+int oe_generic_memcmp(const void* vl, const void* vr, size_t n);
+
+OE_EXTERNC_END
+
+#endif /* _OE_INTERNAL_MEMFUNCS_H */
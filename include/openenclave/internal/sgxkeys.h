@@ -37,6 +37,26 @@ oe_result_t oe_get_key(
     const sgx_key_request_t* sgx_key_request,
     sgx_key_t* sgx_key);
 
+/**
+ * Get the number of times the key cache has been cleared.
+ *
+ * oe_get_key() caches report and seal keys, and oe_clear_key_cache() wipes
+ * them. Code that keeps keys derived from oe_get_key() compares this value
+ * with the one seen when the key was derived to drop them as well.
+ *
+ * @returns The number of calls to oe_clear_key_cache() so far.
+ */
+uint64_t oe_get_key_cache_generation(void);
+
+/**
+ * Register a function that oe_clear_key_cache() calls after wiping the cached
+ * keys, to wipe the keys derived from them as well. It is called without any
+ * lock held. Only one function can be registered.
+ *
+ * @param hook The function to call.
+ */
+void oe_register_key_cache_clear_hook(void (*hook)(void));
+
 OE_EXTERNC_END
 
 #endif /* _OE_KEYS_H */
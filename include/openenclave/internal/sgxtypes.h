@@ -529,7 +529,11 @@ struct _oe_thread_data
     uint64_t __stack_limit_addr;
     uint64_t __first_ssa_gpr;
     uint64_t __stack_guard; /* 0x28 for x64 */
-    uint64_t __reserved_0;
+
+    /* Marshalling buffer kept for the next ECALL of this thread. Unlike the
+     * other fields, it is preserved when the outermost ECALL returns. */
+    void* ecall_buffer;
+
     uint64_t __ssa_frame_size;
     uint64_t __last_error;
 
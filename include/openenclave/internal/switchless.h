@@ -36,11 +36,67 @@ OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, event) == 20);
 OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, spin_count) == 24);
 OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, total_spin_count) == 32);
 
+/**
+ * Number of slots of the ring of asynchronous ocalls. Must be a power of two.
+ */
+#define OE_ASYNC_OCALL_RING_SIZE 256
+
+OE_STATIC_ASSERT(
+    (OE_ASYNC_OCALL_RING_SIZE & (OE_ASYNC_OCALL_RING_SIZE - 1)) == 0);
+
+/**
+ * Size of the buffer of a slot, which holds the input and output buffers of
+ * an asynchronous ocall. Larger calls are made synchronously.
+ */
+#define OE_ASYNC_OCALL_BUFFER_SIZE 1024
+
+/**
+ * A slot of the ring of asynchronous ocalls.
+ *
+ * The slots are used as in a bounded multi-producer multi-consumer queue:
+ * the sequence of the slot at position pos (modulo the ring size) is pos when
+ * the slot is free for the call at that position, pos + 1 once the enclave
+ * has written the call, and pos + OE_ASYNC_OCALL_RING_SIZE once the host has
+ * executed it, which frees the slot for the next round.
+ */
+typedef struct _oe_async_ocall_slot
+{
+    volatile uint64_t sequence;
+    uint64_t reserved;
+
+    // The enclave sets the table_id, function_id and the buffer sizes. The
+    // host points the buffers into the slot's buffer before the call.
+    oe_call_host_function_args_t args;
+
+    uint8_t buffer[OE_ASYNC_OCALL_BUFFER_SIZE];
+} oe_async_ocall_slot_t;
+
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_async_ocall_slot_t, args) == 16);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_async_ocall_slot_t, buffer) == 80);
+
+/**
+ * The ring of asynchronous ocalls, allocated by the host. The enclave claims
+ * slots by incrementing head and the host workers by incrementing tail. Both
+ * live on their own cache lines.
+ */
+typedef struct _oe_async_ocall_ring
+{
+    volatile uint64_t head;
+    uint8_t head_padding[56];
+    volatile uint64_t tail;
+    uint8_t tail_padding[56];
+    oe_async_ocall_slot_t slots[OE_ASYNC_OCALL_RING_SIZE];
+} oe_async_ocall_ring_t;
+
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_async_ocall_ring_t, tail) == 64);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_async_ocall_ring_t, slots) == 128);
+
 typedef struct _oe_switchless_call_manager
 {
     oe_host_worker_context_t* host_worker_contexts;
     oe_thread_t* host_worker_threads;
     size_t num_host_workers;
+    oe_async_ocall_ring_t* async_ocall_ring;
 } oe_switchless_call_manager_t;
 
 oe_result_t oe_start_switchless_manager(
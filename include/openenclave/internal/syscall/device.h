@@ -31,6 +31,12 @@ enum
 
     /* The host epoll device. */
     OE_DEVID_HOST_EPOLL,
+
+    /* The in-enclave RAM file system. */
+    OE_DEVID_RAM_FILE_SYSTEM,
+
+    /* The encrypted, integrity-protected host file system. */
+    OE_DEVID_PROTECTED_FILE_SYSTEM,
 };
 
 /* Device names. */
@@ -39,6 +45,8 @@ enum
 #define OE_DEVICE_NAME_SGX_FILE_SYSTEM OE_SGX_FILE_SYSTEM
 #define OE_DEVICE_NAME_HOST_SOCKET_INTERFACE "oe_host_socket_interface"
 #define OE_DEVICE_NAME_HOST_EPOLL "oe_host_epoll"
+#define OE_DEVICE_NAME_RAM_FILE_SYSTEM OE_RAM_FILE_SYSTEM
+#define OE_DEVICE_NAME_PROTECTED_FILE_SYSTEM OE_PROTECTED_FILE_SYSTEM
 
 typedef enum _oe_device_type
 {
@@ -151,6 +159,9 @@ oe_device_t* oe_device_table_find(const char* name, oe_device_type_t type);
 /* Remove the given device from the table and call its release() method. */
 int oe_device_table_remove(uint64_t devid);
 
+/* Return the (unmounted) host file system device. */
+oe_device_t* oe_get_hostfs_device(void);
+
 /**
  * Associate a device id with the current thread.
  *
@@ -153,6 +153,11 @@ typedef struct _oe_epoll_ops
 struct _oe_fd
 {
     oe_fd_type_t type;
+
+    /* References held by the fd table and by operations in progress. This
+     * is managed by the fd table (see oe_fdtable_get()). */
+    volatile uint64_t refcount;
+
     union {
         oe_fd_ops_t fd;
         oe_file_ops_t file;
@@ -10,12 +10,29 @@
 
 OE_EXTERNC_BEGIN
 
+/* Look up a descriptor and take a reference to it, which the caller must
+ * drop with oe_fdtable_put() once the operation on it is complete. The
+ * descriptor stays open until then, even if it is closed by another thread.
+ * Lookups do not take a lock. */
 oe_fd_t* oe_fdtable_get(int fd, oe_fd_type_t type);
 
+/* Drop a reference taken by oe_fdtable_get() (or returned by
+ * oe_fdtable_reassign()). The descriptor is closed when its last reference is
+ * dropped. */
+void oe_fdtable_put(oe_fd_t* desc);
+
+/* Assign the lowest unused file descriptor to the descriptor. The table takes
+ * over the caller's ownership of the descriptor. */
 int oe_fdtable_assign(oe_fd_t* desc);
 
+/* Assign the given file descriptor to the descriptor. The descriptor it
+ * replaces (if any) is returned in old_desc with the table's reference, which
+ * the caller must drop with oe_fdtable_put(). */
 int oe_fdtable_reassign(int fd, oe_fd_t* new_desc, oe_fd_t** old_desc);
 
+/* Remove the file descriptor from the table and drop the table's reference.
+ * Returns the result of closing the descriptor if that was the last
+ * reference and 0 otherwise. */
 int oe_fdtable_release(int fd);
 
 OE_EXTERNC_END
@@ -0,0 +1,22 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_SYSCALL_SYS_SENDFILE_H
+#define _OE_SYSCALL_SYS_SENDFILE_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/types.h>
+#include <openenclave/internal/syscall/types.h>
+
+OE_EXTERNC_BEGIN
+
+/* Copy count bytes from in_fd to out_fd without passing the data through the
+ * enclave. Both descriptors must be backed by host descriptors (host files or
+ * host sockets). Unlike Linux sendfile(), in_fd may be a socket, and the call
+ * returns only once count bytes have been copied, in_fd has reached end of
+ * file or an error has occurred. */
+ssize_t oe_sendfile(int out_fd, int in_fd, oe_off_t* offset, size_t count);
+
+OE_EXTERNC_END
+
+#endif /* _OE_SYSCALL_SYS_SENDFILE_H */
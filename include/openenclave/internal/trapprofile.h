@@ -0,0 +1,43 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_INTERNAL_TRAPPROFILE_H
+#define _OE_INTERNAL_TRAPPROFILE_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/types.h>
+#include <openenclave/internal/defs.h>
+
+OE_EXTERNC_BEGIN
+
+/* The number of distinct instructions whose traps are counted. The traps of
+ * the instructions that do not fit are only counted in the total. */
+#define OE_TRAP_PROFILE_SIZE 256
+
+/* The traps of an illegal instruction of the enclave, as returned by
+ * oe_get_trap_profile_ecall(). */
+typedef struct _oe_trap_profile_entry
+{
+    /* The offset of the instruction from the base of the enclave. */
+    uint64_t address;
+
+    /* The first two bytes of the instruction, such as OE_CPUID_OPCODE. */
+    uint16_t opcode;
+    uint16_t reserved1;
+    uint32_t reserved2;
+
+    /* The number of traps, and how many of them were emulated by the first
+     * pass exception handler rather than dispatched to the second pass. */
+    uint64_t count;
+    uint64_t emulated;
+} oe_trap_profile_entry_t;
+
+OE_STATIC_ASSERT(sizeof(oe_trap_profile_entry_t) == 32);
+
+/* Called by the first pass exception handler for each illegal instruction
+ * trap. */
+void oe_trap_profile_record(uint64_t address, bool emulated);
+
+OE_EXTERNC_END
+
+#endif /* _OE_INTERNAL_TRAPPROFILE_H */
@@ -0,0 +1,36 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/bits/console.h>
+
+/* Rename the MUSL implementation (and its fflush_unlocked alias) so that it
+ * can be wrapped below. */
+#define fflush __musl_fflush
+#define fflush_unlocked __musl_fflush_unlocked
+#include "../3rdparty/musl/musl/src/stdio/fflush.c"
+#undef fflush
+#undef fflush_unlocked
+
+/* Flushing stdout or stderr (or all streams) also writes out the calling
+ * thread's buffered console output (see oe_console_setvbuf()). */
+int fflush(FILE* f)
+{
+    int ret = __musl_fflush(f);
+
+    if (!f || f == __stdout_used || f == __stderr_used)
+    {
+        if (oe_console_flush() != 0)
+            ret = EOF;
+    }
+
+    return ret;
+}
+
+/* MUSL makes fflush_unlocked() an alias of fflush(). The declaration in
+ * <stdio.h> was renamed above, so declare it again here. */
+int fflush_unlocked(FILE* f);
+
+int fflush_unlocked(FILE* f)
+{
+    return fflush(f);
+}
@@ -3,9 +3,11 @@
 
 #include <openenclave/enclave.h>
 
+#include <openenclave/bits/safemath.h>
 #include <openenclave/corelibc/stdio.h>
 #include <openenclave/corelibc/stdlib.h>
 #include <openenclave/corelibc/string.h>
+#include <openenclave/internal/calls.h>
 #include <openenclave/internal/print.h>
 #include <openenclave/internal/syscall/fcntl.h>
 #include <openenclave/internal/syscall/fd.h>
@@ -25,8 +27,48 @@ typedef struct _file
     oe_fd_t base;
     uint32_t magic;
     oe_host_fd_t host_fd;
+
+    /* The standard stream this file was created for (or duplicated from). */
+    uint32_t fileno;
 } file_t;
 
+/* Buffered output of one thread for one stream. */
+typedef struct _buffer
+{
+    oe_host_fd_t host_fd;
+    size_t size;
+    size_t capacity;
+    char* data;
+} buffer_t;
+
+/* The buffers of one thread (stdout, then stderr). */
+typedef struct _buffers
+{
+    buffer_t streams[2];
+
+    /* Held by the thread while it uses its buffers, and by oe_abort() or by
+     * the closing of a file while they flush them. */
+    oe_spinlock_t lock;
+
+    /* All threads' buffers, so that oe_abort() and close() can flush them. */
+    struct _buffers* next;
+    struct _buffers* prev;
+} buffers_t;
+
+/* Buffering mode and buffer size of stdout and stderr. */
+static struct
+{
+    int mode;
+    size_t size;
+} _config[2] = {{OE_IONBF, 0}, {OE_IONBF, 0}};
+
+static oe_thread_key_t _key;
+static bool _key_created;
+static oe_once_t _once = OE_ONCE_INIT;
+
+static buffers_t* _all_buffers;
+static oe_spinlock_t _all_buffers_lock = OE_SPINLOCK_INITIALIZER;
+
 static oe_file_ops_t _get_ops(void);
 
 static file_t* _cast_file(const oe_fd_t* file_)
@@ -39,6 +81,332 @@ static file_t* _cast_file(const oe_fd_t* file_)
     return file;
 }
 
+/*
+**==============================================================================
+**
+** Output buffering.
+**
+**==============================================================================
+*/
+
+/* Write out the buffer. Output that cannot be written is discarded. */
+static int _flush_buffer(buffer_t* buffer)
+{
+    int ret = -1;
+    size_t offset = 0;
+
+    while (offset < buffer->size)
+    {
+        ssize_t n = -1;
+
+        if (oe_syscall_write_ocall(
+                &n,
+                buffer->host_fd,
+                buffer->data + offset,
+                buffer->size - offset) != OE_OK)
+        {
+            OE_RAISE_ERRNO(OE_EINVAL);
+        }
+
+        if (n <= 0)
+            OE_RAISE_ERRNO(n == 0 ? OE_EIO : oe_errno);
+
+        offset += (size_t)n;
+    }
+
+    ret = 0;
+
+done:
+    buffer->size = 0;
+    return ret;
+}
+
+static int _flush_buffers(buffers_t* buffers)
+{
+    int ret = 0;
+
+    for (size_t i = 0; i < OE_COUNTOF(buffers->streams); i++)
+    {
+        if (_flush_buffer(&buffers->streams[i]) != 0)
+            ret = -1;
+    }
+
+    return ret;
+}
+
+/* Called when a thread returns from its outermost ECALL. */
+static void _thread_destructor(void* value)
+{
+    buffers_t* buffers = (buffers_t*)value;
+
+    /* Flush before unlinking so that a concurrent close cannot miss the
+     * buffers and leave them bound to a host descriptor it has closed. */
+    oe_spin_lock(&_all_buffers_lock);
+    _flush_buffers(buffers);
+    if (buffers->next)
+        buffers->next->prev = buffers->prev;
+    if (buffers->prev)
+        buffers->prev->next = buffers->next;
+    else
+        _all_buffers = buffers->next;
+    oe_spin_unlock(&_all_buffers_lock);
+
+    for (size_t i = 0; i < OE_COUNTOF(buffers->streams); i++)
+        oe_free(buffers->streams[i].data);
+
+    oe_free(buffers);
+}
+
+/* Flush the output buffered by every thread. The buffers of a thread that is
+ * using them, possibly the aborting thread itself, are skipped. */
+static void _abort_handler(void)
+{
+    oe_spin_lock(&_all_buffers_lock);
+
+    for (buffers_t* p = _all_buffers; p; p = p->next)
+    {
+        if (__atomic_exchange_n(&p->lock, 1, __ATOMIC_ACQUIRE) == 0)
+        {
+            _flush_buffers(p);
+            oe_spin_unlock(&p->lock);
+        }
+    }
+
+    oe_spin_unlock(&_all_buffers_lock);
+}
+
+/* Write out the output that any thread has buffered for the file and detach
+ * those buffers from its host descriptor, which the host may reuse once the
+ * file is closed. */
+static void _flush_file_buffers(const file_t* file)
+{
+    oe_spin_lock(&_all_buffers_lock);
+
+    for (buffers_t* p = _all_buffers; p; p = p->next)
+    {
+        oe_spin_lock(&p->lock);
+
+        for (size_t i = 0; i < OE_COUNTOF(p->streams); i++)
+        {
+            buffer_t* buffer = &p->streams[i];
+
+            if (buffer->host_fd == file->host_fd)
+            {
+                _flush_buffer(buffer);
+                buffer->host_fd = -1;
+            }
+        }
+
+        oe_spin_unlock(&p->lock);
+    }
+
+    oe_spin_unlock(&_all_buffers_lock);
+}
+
+static void _initialize(void)
+{
+    if (oe_thread_key_create(&_key, _thread_destructor) == OE_OK)
+    {
+        oe_set_abort_handler(_abort_handler);
+        _key_created = true;
+    }
+}
+
+/* Return the calling thread's buffer for the file's stream or null if the
+ * stream is unbuffered (or the buffer cannot be allocated). The buffer is
+ * returned with the lock of buffers_out held. */
+static buffer_t* _get_buffer(file_t* file, int* mode, buffers_t** buffers_out)
+{
+    size_t stream;
+    size_t capacity;
+    buffers_t* buffers;
+    buffer_t* buffer;
+
+    if (file->fileno != OE_STDOUT_FILENO && file->fileno != OE_STDERR_FILENO)
+        return NULL;
+
+    stream = file->fileno - OE_STDOUT_FILENO;
+
+    if ((*mode = _config[stream].mode) == OE_IONBF)
+        return NULL;
+
+    capacity = _config[stream].size;
+
+    oe_once(&_once, _initialize);
+
+    if (!_key_created)
+        return NULL;
+
+    if (!(buffers = oe_thread_getspecific(_key)))
+    {
+        if (!(buffers = oe_calloc(1, sizeof(buffers_t))))
+            return NULL;
+
+        if (oe_thread_setspecific(_key, buffers) != OE_OK)
+        {
+            oe_free(buffers);
+            return NULL;
+        }
+
+        oe_spin_lock(&_all_buffers_lock);
+        if ((buffers->next = _all_buffers))
+            _all_buffers->prev = buffers;
+        _all_buffers = buffers;
+        oe_spin_unlock(&_all_buffers_lock);
+    }
+
+    oe_spin_lock(&buffers->lock);
+
+    buffer = &buffers->streams[stream];
+
+    /* Output already buffered for another host file goes out first. */
+    if (buffer->size && buffer->host_fd != file->host_fd)
+        _flush_buffer(buffer);
+
+    if (buffer->capacity != capacity)
+    {
+        char* data;
+
+        _flush_buffer(buffer);
+
+        if (!(data = oe_realloc(buffer->data, capacity)))
+        {
+            oe_spin_unlock(&buffers->lock);
+            return NULL;
+        }
+
+        buffer->data = data;
+        buffer->capacity = capacity;
+    }
+
+    buffer->host_fd = file->host_fd;
+    *buffers_out = buffers;
+
+    return buffer;
+}
+
+/* Append the output to the buffer. Return false if it is too large to be
+ * buffered, in which case the caller writes it directly. */
+static bool _buffer_output(
+    buffer_t* buffer,
+    int mode,
+    const struct oe_iovec* iov,
+    int iovcnt,
+    ssize_t* ret)
+{
+    size_t total = 0;
+    bool newline = false;
+
+    *ret = -1;
+
+    for (int i = 0; i < iovcnt; i++)
+    {
+        if (iov[i].iov_len && !iov[i].iov_base)
+        {
+            oe_errno = OE_EINVAL;
+            return true;
+        }
+
+        if (oe_safe_add_sizet(total, iov[i].iov_len, &total) != OE_OK)
+            total = OE_SIZE_MAX;
+    }
+
+    if (total > buffer->capacity - buffer->size)
+    {
+        if (_flush_buffer(buffer) != 0)
+            return true;
+
+        if (total > buffer->capacity)
+            return false;
+    }
+
+    for (int i = 0; i < iovcnt; i++)
+    {
+        const size_t n = iov[i].iov_len;
+
+        if (n == 0)
+            continue;
+
+        memcpy(buffer->data + buffer->size, iov[i].iov_base, n);
+
+        if (mode == OE_IOLBF && !newline)
+        {
+            for (size_t j = 0; j < n; j++)
+            {
+                if (buffer->data[buffer->size + j] == '\n')
+                {
+                    newline = true;
+                    break;
+                }
+            }
+        }
+
+        buffer->size += n;
+    }
+
+    if (newline && _flush_buffer(buffer) != 0)
+        return true;
+
+    *ret = (ssize_t)total;
+    return true;
+}
+
+int oe_console_setvbuf(int fd, int mode, size_t size)
+{
+    int ret = -1;
+    oe_fd_t* desc = NULL;
+    file_t* file;
+    size_t stream;
+
+    if (mode != OE_IOFBF && mode != OE_IOLBF && mode != OE_IONBF)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* Accept any descriptor that refers to stdout or stderr. */
+    if (!(desc = oe_fdtable_get(fd, OE_FD_TYPE_FILE)) ||
+        !(file = _cast_file(desc)) ||
+        (file->fileno != OE_STDOUT_FILENO && file->fileno != OE_STDERR_FILENO))
+    {
+        OE_RAISE_ERRNO(OE_EBADF);
+    }
+
+    stream = file->fileno - OE_STDOUT_FILENO;
+
+    if (oe_console_flush() != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    _config[stream].mode = mode;
+    _config[stream].size = size ? size : OE_CONSOLE_BUFFER_SIZE;
+
+    ret = 0;
+
+done:
+    oe_fdtable_put(desc);
+    return ret;
+}
+
+int oe_console_flush(void)
+{
+    int ret;
+    buffers_t* buffers;
+
+    if (!_key_created || !(buffers = oe_thread_getspecific(_key)))
+        return 0;
+
+    oe_spin_lock(&buffers->lock);
+    ret = _flush_buffers(buffers);
+    oe_spin_unlock(&buffers->lock);
+
+    return ret;
+}
+
+/*
+**==============================================================================
+**
+** File operations.
+**
+**==============================================================================
+*/
+
 static int _consolefs_dup(oe_fd_t* file_, oe_fd_t** new_file_out)
 {
     int ret = -1;
@@ -59,6 +427,7 @@ static int _consolefs_dup(oe_fd_t* file_, oe_fd_t** new_file_out)
         new_file->base.type = OE_FD_TYPE_FILE;
         new_file->base.ops.file = _get_ops();
         new_file->magic = MAGIC;
+        new_file->fileno = file->fileno;
     }
 
     /* Ask the host to perform this operation. */
@@ -208,6 +577,9 @@ static ssize_t _consolefs_read(oe_fd_t* file_, void* buf, size_t count)
     if (!file)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    /* Show pending output (such as a prompt) before waiting for input. */
+    oe_console_flush();
+
     if (oe_syscall_read_ocall(&ret, file->host_fd, buf, count) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
@@ -219,10 +591,28 @@ static ssize_t _consolefs_write(oe_fd_t* file_, const void* buf, size_t count)
 {
     ssize_t ret = -1;
     file_t* file = _cast_file(file_);
+    buffers_t* buffers;
+    buffer_t* buffer;
+    int mode;
 
     if (!file)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    if ((buffer = _get_buffer(file, &mode, &buffers)))
+    {
+        struct oe_iovec iov;
+        bool buffered;
+
+        iov.iov_base = (void*)buf;
+        iov.iov_len = count;
+
+        buffered = _buffer_output(buffer, mode, &iov, 1, &ret);
+        oe_spin_unlock(&buffers->lock);
+
+        if (buffered)
+            goto done;
+    }
+
     if (oe_syscall_write_ocall(&ret, file->host_fd, buf, count) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
@@ -275,10 +665,23 @@ static ssize_t _consolefs_writev(
     file_t* file = _cast_file(desc);
     void* buf = NULL;
     size_t buf_size = 0;
+    buffers_t* buffers;
+    buffer_t* buffer;
+    int mode;
 
     if (!file || (!iov && iovcnt) || iovcnt < 0 || iovcnt > OE_IOV_MAX)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    if ((buffer = _get_buffer(file, &mode, &buffers)))
+    {
+        bool buffered = _buffer_output(buffer, mode, iov, iovcnt, &ret);
+
+        oe_spin_unlock(&buffers->lock);
+
+        if (buffered)
+            goto done;
+    }
+
     /* Flatten the IO vector into contiguous heap memory. */
     if (oe_iov_pack(iov, iovcnt, &buf, &buf_size) != 0)
         OE_RAISE_ERRNO(OE_ENOMEM);
@@ -333,6 +736,11 @@ static int _consolefs_close(oe_fd_t* file_)
     if (!file)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    /* Write out every thread's buffered output while the host file is still
+     * open. This also covers the descriptor replaced by dup2(). */
+    if (file->fileno != OE_STDIN_FILENO)
+        _flush_file_buffers(file);
+
     /* Ask the host to perform this operation. */
     {
         if (oe_syscall_close_ocall(&ret, file->host_fd) != OE_OK)
@@ -400,6 +808,7 @@ static oe_fd_t* _new_file(uint32_t fileno)
         file->base.type = OE_FD_TYPE_FILE;
         file->base.ops.file = _ops;
         file->magic = MAGIC;
+        file->fileno = fileno;
     }
 
     /* Ask the host to duplicate the file descriptor. */
@@ -190,7 +190,7 @@ static oe_fd_t* _epoll_create(oe_device_t* device_, int size)
 static int _epoll_ctl_add(epoll_t* epoll, int fd, struct oe_epoll_event* event)
 {
     int ret = -1;
-    oe_fd_t* desc;
+    oe_fd_t* desc = NULL;
     oe_host_fd_t host_epfd;
     oe_host_fd_t host_fd;
     struct oe_epoll_event host_event;
@@ -252,13 +252,15 @@ done:
     if (locked)
         oe_mutex_unlock(&epoll->lock);
 
+    oe_fdtable_put(desc);
+
     return ret;
 }
 
 static int _epoll_ctl_mod(epoll_t* epoll, int fd, struct oe_epoll_event* event)
 {
     int ret = -1;
-    oe_fd_t* desc;
+    oe_fd_t* desc = NULL;
     oe_host_fd_t host_epfd;
     oe_host_fd_t host_fd;
     struct oe_epoll_event host_event;
@@ -319,13 +321,15 @@ done:
     if (locked)
         oe_mutex_unlock(&epoll->lock);
 
+    oe_fdtable_put(desc);
+
     return ret;
 }
 
 static int _epoll_ctl_del(epoll_t* epoll, int fd)
 {
     int ret = -1;
-    oe_fd_t* desc;
+    oe_fd_t* desc = NULL;
     oe_host_fd_t host_epfd;
     oe_host_fd_t host_fd;
     int retval;
@@ -383,6 +387,8 @@ done:
     if (locked)
         oe_mutex_unlock(&epoll->lock);
 
+    oe_fdtable_put(desc);
+
     return ret;
 }
 
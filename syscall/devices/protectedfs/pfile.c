@@ -0,0 +1,1180 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+// clang-format off
+#include <openenclave/enclave.h>
+// clang-format on
+
+#include <openenclave/corelibc/stdlib.h>
+#include <openenclave/corelibc/string.h>
+#include <openenclave/internal/crypto/gcm.h>
+#include <openenclave/internal/crypto/kdf.h>
+#include <openenclave/internal/syscall/raise.h>
+#include <openenclave/internal/utils.h>
+#include <openenclave/bits/safecrt.h>
+#include <openenclave/bits/safemath.h>
+#include "pfile.h"
+
+#include "syscall_t.h"
+
+#define BLOCK_SIZE OE_PFILE_BLOCK_SIZE
+
+/* Each tree node references this many children. */
+#define FANOUT_BITS 7
+#define FANOUT (1 << FANOUT_BITS)
+
+/* Number of node levels above the data blocks (level 0). */
+#define DEPTH 4
+
+/* Largest supported file: FANOUT^DEPTH data blocks (1 TB). */
+#define MAX_FILE_SIZE ((uint64_t)1 << (FANOUT_BITS * DEPTH)) * BLOCK_SIZE
+
+/* Upper bound on the number of blocks transferred by one host I/O. */
+#define MAX_RUN_BLOCKS 64
+
+/* Number of data blocks read ahead by sequential readers. */
+#define PREFETCH_BLOCKS 16
+
+#define HEADER_MAGIC 0x0031534650454f00 /* "\0OEPFS1\0" */
+#define HEADER_VERSION 1
+
+#define SALT_SIZE 32
+#define FILE_KEY_SIZE 32
+
+/* Locates and authenticates a child block. */
+typedef struct _ref
+{
+    uint8_t iv[OE_GCM_IV_SIZE];
+    uint8_t tag[OE_GCM_TAG_SIZE];
+    uint32_t present;
+} ref_t;
+
+OE_STATIC_ASSERT(sizeof(ref_t) * FANOUT == BLOCK_SIZE);
+
+/* The header stored at the beginning of block 0. */
+typedef struct _header
+{
+    /* Plaintext (authenticated as additional data). */
+    uint64_t magic;
+    uint32_t version;
+    uint32_t block_size;
+    uint8_t salt[SALT_SIZE];
+
+    /* Used to encrypt the secret part of the header. */
+    uint8_t iv[OE_GCM_IV_SIZE];
+    uint8_t tag[OE_GCM_TAG_SIZE];
+    uint32_t reserved;
+
+    /* Encrypted. */
+    struct
+    {
+        uint64_t size;
+        ref_t root;
+    } secret;
+} header_t;
+
+OE_STATIC_ASSERT(OE_OFFSETOF(header_t, secret) % 8 == 0);
+
+typedef struct _block block_t;
+
+/* A decrypted block (a tree node or a data block) in the cache. */
+struct _block
+{
+    /* Block number within the host file. */
+    uint64_t pos;
+
+    /* Zero for data blocks, DEPTH for the root. */
+    uint32_t level;
+
+    /* Index of this block within its parent. */
+    uint32_t index;
+
+    bool dirty;
+
+    /* Number of cached children (a block is pinned while non-zero). */
+    size_t children;
+
+    block_t* parent;
+
+    /* Hash chain. */
+    block_t* chain;
+
+    /* LRU list (the head is the most recently used block). */
+    block_t* prev;
+    block_t* next;
+
+    uint8_t data[BLOCK_SIZE];
+};
+
+struct _oe_pfile
+{
+    oe_host_fd_t host_fd;
+    bool read_only;
+    oe_aes_gcm_context_t gcm;
+
+    /* The header, with its secret part in plaintext. */
+    header_t header;
+    bool header_dirty;
+
+    /* The root node is always cached. */
+    block_t* root;
+
+    block_t** buckets;
+    size_t num_buckets;
+    block_t* head;
+    block_t* tail;
+    size_t num_blocks;
+    size_t max_blocks;
+
+    /* The data block that a sequential reader would read next. */
+    uint64_t next_read;
+};
+
+/* Return the number of host blocks occupied by a subtree rooted at the given
+ * level. The subtree is laid out as its node followed by its children's
+ * subtrees, so data blocks that share a leaf node are adjacent on the host.
+ */
+static uint64_t _span(uint32_t level)
+{
+    uint64_t span = 1;
+
+    for (uint32_t i = 0; i < level; i++)
+        span = 1 + FANOUT * span;
+
+    return span;
+}
+
+/* Return the host block number of the level node on the path to data block
+ * d (level zero is the data block itself). The root is block 1. */
+static uint64_t _block_pos(uint32_t level, uint64_t d)
+{
+    uint64_t pos = 1;
+
+    for (uint32_t l = DEPTH; l > level; l--)
+    {
+        uint64_t index = (d >> (FANOUT_BITS * (l - 1))) & (FANOUT - 1);
+        pos += 1 + index * _span(l - 1);
+    }
+
+    return pos;
+}
+
+static uint32_t _index_in_parent(uint32_t level, uint64_t d)
+{
+    return (uint32_t)((d >> (FANOUT_BITS * level)) & (FANOUT - 1));
+}
+
+/*
+**==============================================================================
+**
+** Host I/O and encryption.
+**
+**==============================================================================
+*/
+
+static int _host_read(oe_pfile_t* f, uint64_t pos, void* buf, size_t nblocks)
+{
+    int ret = -1;
+    ssize_t n = -1;
+    size_t size = nblocks * BLOCK_SIZE;
+    oe_off_t offset = (oe_off_t)(pos * BLOCK_SIZE);
+
+    if (oe_syscall_pread_ocall(&n, f->host_fd, buf, size, offset) != OE_OK)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (n < 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    /* A referenced block that is missing on the host was removed by it. */
+    if ((size_t)n != size)
+        OE_RAISE_ERRNO(OE_EBADMSG);
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+static int _host_write(
+    oe_pfile_t* f,
+    uint64_t offset,
+    const void* buf,
+    size_t size)
+{
+    int ret = -1;
+    ssize_t n = -1;
+
+    if (oe_syscall_pwrite_ocall(
+            &n, f->host_fd, buf, size, (oe_off_t)offset) != OE_OK)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (n < 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    if ((size_t)n != size)
+        OE_RAISE_ERRNO(OE_EIO);
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+/* Blocks are bound to their location by using the block number as the
+ * additional authenticated data. */
+static int _encrypt_block(
+    oe_pfile_t* f,
+    uint64_t pos,
+    const uint8_t* in,
+    uint8_t* out,
+    ref_t* ref)
+{
+    int ret = -1;
+
+    if (oe_random(ref->iv, sizeof(ref->iv)) != OE_OK)
+        OE_RAISE_ERRNO(OE_EIO);
+
+    if (oe_aes_gcm_encrypt(
+            &f->gcm,
+            ref->iv,
+            sizeof(ref->iv),
+            (const uint8_t*)&pos,
+            sizeof(pos),
+            in,
+            BLOCK_SIZE,
+            out,
+            ref->tag) != OE_OK)
+    {
+        OE_RAISE_ERRNO(OE_EIO);
+    }
+
+    ref->present = 1;
+    ret = 0;
+
+done:
+    return ret;
+}
+
+static int _decrypt_block(
+    oe_pfile_t* f,
+    uint64_t pos,
+    const ref_t* ref,
+    const uint8_t* in,
+    uint8_t* out)
+{
+    int ret = -1;
+
+    if (oe_aes_gcm_decrypt(
+            &f->gcm,
+            ref->iv,
+            sizeof(ref->iv),
+            (const uint8_t*)&pos,
+            sizeof(pos),
+            in,
+            BLOCK_SIZE,
+            out,
+            ref->tag) != OE_OK)
+    {
+        OE_RAISE_ERRNO_MSG(
+            OE_EBADMSG, "integrity check failed: block=%lu", pos);
+    }
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+static int _write_header(oe_pfile_t* f)
+{
+    int ret = -1;
+    header_t header = f->header;
+
+    if (oe_random(header.iv, sizeof(header.iv)) != OE_OK)
+        OE_RAISE_ERRNO(OE_EIO);
+
+    if (oe_aes_gcm_encrypt(
+            &f->gcm,
+            header.iv,
+            sizeof(header.iv),
+            (const uint8_t*)&header,
+            OE_OFFSETOF(header_t, iv),
+            (const uint8_t*)&f->header.secret,
+            sizeof(header.secret),
+            (uint8_t*)&header.secret,
+            header.tag) != OE_OK)
+    {
+        OE_RAISE_ERRNO(OE_EIO);
+    }
+
+    if (_host_write(f, 0, &header, sizeof(header)) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    ret = 0;
+
+done:
+    oe_secure_zero_fill(&header, sizeof(header));
+    return ret;
+}
+
+/*
+**==============================================================================
+**
+** Block cache.
+**
+**==============================================================================
+*/
+
+static block_t** _bucket(oe_pfile_t* f, uint64_t pos)
+{
+    return &f->buckets[pos & (f->num_buckets - 1)];
+}
+
+static block_t* _lookup(oe_pfile_t* f, uint64_t pos)
+{
+    for (block_t* b = *_bucket(f, pos); b; b = b->chain)
+    {
+        if (b->pos == pos)
+            return b;
+    }
+
+    return NULL;
+}
+
+static void _list_remove(oe_pfile_t* f, block_t* b)
+{
+    if (b->prev)
+        b->prev->next = b->next;
+    else
+        f->head = b->next;
+
+    if (b->next)
+        b->next->prev = b->prev;
+    else
+        f->tail = b->prev;
+
+    b->prev = NULL;
+    b->next = NULL;
+}
+
+static void _list_push_front(oe_pfile_t* f, block_t* b)
+{
+    b->prev = NULL;
+    b->next = f->head;
+
+    if (f->head)
+        f->head->prev = b;
+    else
+        f->tail = b;
+
+    f->head = b;
+}
+
+static void _touch(oe_pfile_t* f, block_t* b)
+{
+    if (f->head != b)
+    {
+        _list_remove(f, b);
+        _list_push_front(f, b);
+    }
+}
+
+static void _insert(oe_pfile_t* f, block_t* b)
+{
+    block_t** bucket = _bucket(f, b->pos);
+
+    b->chain = *bucket;
+    *bucket = b;
+    _list_push_front(f, b);
+    f->num_blocks++;
+
+    if (b->parent)
+        b->parent->children++;
+}
+
+static void _evict(oe_pfile_t* f, block_t* b)
+{
+    block_t** p = _bucket(f, b->pos);
+
+    while (*p != b)
+        p = &(*p)->chain;
+
+    *p = b->chain;
+    _list_remove(f, b);
+    f->num_blocks--;
+
+    if (b->parent)
+        b->parent->children--;
+
+    oe_secure_zero_fill(b->data, sizeof(b->data));
+    oe_free(b);
+}
+
+/* Mark a block and its ancestors as modified. Ancestors of a dirty block are
+ * always dirty, since their references change when the block is written. */
+static void _mark_dirty(oe_pfile_t* f, block_t* b)
+{
+    for (; b && !b->dirty; b = b->parent)
+        b->dirty = true;
+
+    f->header_dirty = true;
+}
+
+/* Return the block at the given level on the path to data block d, loading
+ * it (and its ancestors) into the cache if necessary. If load is false, a
+ * data block that is not cached is returned zero-filled rather than read
+ * from the host (for callers that overwrite the whole block). */
+static block_t* _get_block(oe_pfile_t* f, uint32_t level, uint64_t d, bool load)
+{
+    block_t* ret = NULL;
+    block_t* parent;
+    block_t* b = NULL;
+    const ref_t* ref;
+    uint64_t pos;
+
+    if (level == DEPTH)
+    {
+        _touch(f, f->root);
+        return f->root;
+    }
+
+    if (!(parent = _get_block(f, level + 1, d, true)))
+        goto done;
+
+    pos = _block_pos(level, d);
+
+    if ((b = _lookup(f, pos)))
+    {
+        _touch(f, b);
+        ret = b;
+        b = NULL;
+        goto done;
+    }
+
+    if (!(b = oe_calloc(1, sizeof(block_t))))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    b->pos = pos;
+    b->level = level;
+    b->index = _index_in_parent(level, d);
+    b->parent = parent;
+
+    ref = &((const ref_t*)parent->data)[b->index];
+
+    /* Absent blocks read as zeros. */
+    if (ref->present && (load || level > 0))
+    {
+        if (_host_read(f, pos, b->data, 1) != 0)
+            goto done;
+
+        if (_decrypt_block(f, pos, ref, b->data, b->data) != 0)
+            goto done;
+    }
+
+    _insert(f, b);
+    ret = b;
+    b = NULL;
+
+done:
+
+    if (b)
+        oe_free(b);
+
+    return ret;
+}
+
+/* Read up to count data blocks starting at d with one host read. The run
+ * stops at the end of the leaf node (where the blocks stop being adjacent
+ * on the host), at an absent block or at a block that is already cached. */
+static int _prefetch(oe_pfile_t* f, uint64_t d, size_t count)
+{
+    int ret = -1;
+    block_t* leaf;
+    const ref_t* refs;
+    uint32_t first;
+    size_t n = 0;
+    uint8_t* buf = NULL;
+
+    if (!(leaf = _get_block(f, 1, d, true)))
+        goto done;
+
+    refs = (const ref_t*)leaf->data;
+    first = (uint32_t)(d & (FANOUT - 1));
+
+    while (n < count && first + n < FANOUT)
+    {
+        uint32_t index = first + (uint32_t)n;
+
+        if (!refs[index].present || _lookup(f, leaf->pos + 1 + index))
+            break;
+
+        n++;
+    }
+
+    /* Single blocks are loaded on demand. */
+    if (n < 2)
+    {
+        ret = 0;
+        goto done;
+    }
+
+    if (!(buf = oe_malloc(n * BLOCK_SIZE)))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    if (_host_read(f, leaf->pos + 1 + first, buf, n) != 0)
+        goto done;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        uint32_t index = first + (uint32_t)i;
+        block_t* b;
+
+        if (!(b = oe_calloc(1, sizeof(block_t))))
+            OE_RAISE_ERRNO(OE_ENOMEM);
+
+        b->pos = leaf->pos + 1 + index;
+        b->level = 0;
+        b->index = index;
+        b->parent = leaf;
+
+        if (_decrypt_block(
+                f, b->pos, &refs[index], buf + i * BLOCK_SIZE, b->data) != 0)
+        {
+            oe_free(b);
+            goto done;
+        }
+
+        _insert(f, b);
+    }
+
+    ret = 0;
+
+done:
+
+    if (buf)
+        oe_free(buf);
+
+    return ret;
+}
+
+/* Sort blocks by their position on the host (Shell sort). */
+static void _sort_by_pos(block_t** blocks, size_t n)
+{
+    for (size_t gap = n / 2; gap > 0; gap /= 2)
+    {
+        for (size_t i = gap; i < n; i++)
+        {
+            block_t* b = blocks[i];
+            size_t j = i;
+
+            for (; j >= gap && blocks[j - gap]->pos > b->pos; j -= gap)
+                blocks[j] = blocks[j - gap];
+
+            blocks[j] = b;
+        }
+    }
+}
+
+int oe_pfile_flush(oe_pfile_t* f)
+{
+    int ret = -1;
+    block_t** blocks = NULL;
+    uint8_t* staging = NULL;
+    size_t n = 0;
+
+    if (!f)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (f->read_only)
+        return 0;
+
+    for (block_t* b = f->head; b; b = b->next)
+    {
+        if (b->dirty)
+            n++;
+    }
+
+    if (n)
+    {
+        size_t i = 0;
+
+        if (!(blocks = oe_malloc(n * sizeof(block_t*))))
+            OE_RAISE_ERRNO(OE_ENOMEM);
+
+        if (!(staging = oe_malloc(n * BLOCK_SIZE)))
+            OE_RAISE_ERRNO(OE_ENOMEM);
+
+        for (block_t* b = f->head; b; b = b->next)
+        {
+            if (b->dirty)
+                blocks[i++] = b;
+        }
+
+        /* Ciphertext is staged in host order so that runs of adjacent blocks
+         * can be written with one host write. */
+        _sort_by_pos(blocks, n);
+
+        /* Encrypt children before parents, since each parent records the
+         * final tags of its children. */
+        for (uint32_t level = 0; level <= DEPTH; level++)
+        {
+            for (i = 0; i < n; i++)
+            {
+                block_t* b = blocks[i];
+                ref_t* ref;
+
+                if (b->level != level)
+                    continue;
+
+                if (b->parent)
+                    ref = &((ref_t*)b->parent->data)[b->index];
+                else
+                    ref = &f->header.secret.root;
+
+                if (_encrypt_block(
+                        f, b->pos, b->data, staging + i * BLOCK_SIZE, ref) != 0)
+                {
+                    goto done;
+                }
+            }
+        }
+
+        for (i = 0; i < n;)
+        {
+            size_t j = i + 1;
+
+            while (j < n && j - i < MAX_RUN_BLOCKS &&
+                   blocks[j]->pos == blocks[j - 1]->pos + 1)
+            {
+                j++;
+            }
+
+            if (_host_write(
+                    f,
+                    blocks[i]->pos * BLOCK_SIZE,
+                    staging + i * BLOCK_SIZE,
+                    (j - i) * BLOCK_SIZE) != 0)
+            {
+                goto done;
+            }
+
+            i = j;
+        }
+
+        for (i = 0; i < n; i++)
+            blocks[i]->dirty = false;
+    }
+
+    /* Write the header last so that it only refers to blocks on the host. */
+    if (f->header_dirty)
+    {
+        if (_write_header(f) != 0)
+            goto done;
+
+        f->header_dirty = false;
+    }
+
+    ret = 0;
+
+done:
+
+    if (staging)
+        oe_free(staging);
+
+    if (blocks)
+        oe_free(blocks);
+
+    return ret;
+}
+
+/* Evict least recently used blocks once the cache is over capacity. Dirty
+ * blocks are written back together first, rather than one at a time. */
+static int _shrink_cache(oe_pfile_t* f)
+{
+    int ret = -1;
+    size_t target;
+
+    if (f->num_blocks <= f->max_blocks)
+        return 0;
+
+    target = f->max_blocks - f->max_blocks / 4;
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (block_t* b = f->tail; b && f->num_blocks > target;)
+        {
+            block_t* prev = b->prev;
+
+            if (!b->dirty && b->children == 0 && b != f->root)
+                _evict(f, b);
+
+            b = prev;
+        }
+
+        if (pass == 0 && f->num_blocks > target && oe_pfile_flush(f) != 0)
+            goto done;
+    }
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+/* Discard cached blocks whose host position lies in [lo, hi). */
+static void _drop_range(oe_pfile_t* f, uint64_t lo, uint64_t hi)
+{
+    /* Detach blocks whose parents are dropped as well, before freeing. */
+    for (block_t* b = f->head; b; b = b->next)
+    {
+        if (b->pos >= lo && b->pos < hi && b->parent &&
+            b->parent->pos >= lo && b->parent->pos < hi)
+        {
+            b->parent = NULL;
+        }
+    }
+
+    for (block_t* b = f->head; b;)
+    {
+        block_t* next = b->next;
+
+        if (b->pos >= lo && b->pos < hi)
+            _evict(f, b);
+
+        b = next;
+    }
+}
+
+/* Remove the references to data blocks numbered from and above within the
+ * subtree of the given node, whose first data block is first. */
+static int _clear_from(
+    oe_pfile_t* f,
+    block_t* node,
+    uint32_t level,
+    uint64_t first,
+    uint64_t from)
+{
+    int ret = -1;
+    ref_t* refs = (ref_t*)node->data;
+    uint64_t per_child = (uint64_t)1 << (FANOUT_BITS * (level - 1));
+    uint64_t child_span = _span(level - 1);
+    uint64_t i0;
+
+    if (from <= first)
+        i0 = 0;
+    else
+        i0 = (from - first + per_child - 1) / per_child;
+
+    /* Descend into the child that straddles the new end of file. */
+    if (i0 > 0 && i0 <= FANOUT && first + i0 * per_child > from && level > 1)
+    {
+        uint64_t child_first = first + (i0 - 1) * per_child;
+        block_t* child;
+
+        if (!(child = _get_block(f, level - 1, child_first, true)))
+            goto done;
+
+        if (_clear_from(f, child, level - 1, child_first, from) != 0)
+            goto done;
+    }
+
+    if (i0 < FANOUT)
+    {
+        bool changed = false;
+
+        for (uint64_t i = i0; i < FANOUT; i++)
+        {
+            if (refs[i].present)
+            {
+                oe_memset_s(&refs[i], sizeof(ref_t), 0, sizeof(ref_t));
+                changed = true;
+            }
+        }
+
+        _drop_range(
+            f,
+            node->pos + 1 + i0 * child_span,
+            node->pos + 1 + FANOUT * child_span);
+
+        if (changed)
+            _mark_dirty(f, node);
+    }
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+/*
+**==============================================================================
+**
+** Public interface.
+**
+**==============================================================================
+*/
+
+int oe_pfile_open(
+    oe_host_fd_t host_fd,
+    const uint8_t* key,
+    size_t key_size,
+    size_t cache_blocks,
+    bool read_only,
+    oe_pfile_t** pfile_out)
+{
+    int ret = -1;
+    oe_pfile_t* f = NULL;
+    bool gcm_initialized = false;
+    ssize_t n = -1;
+    uint8_t file_key[FILE_KEY_SIZE];
+    static const char _label[] = "oe_protected_file_system";
+    uint8_t fixed_data[sizeof(_label) + SALT_SIZE];
+
+    if (pfile_out)
+        *pfile_out = NULL;
+
+    if (!key || !key_size || !pfile_out)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (!(f = oe_calloc(1, sizeof(oe_pfile_t))))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    f->host_fd = host_fd;
+    f->read_only = read_only;
+    f->max_blocks = cache_blocks ? cache_blocks : OE_PFILE_DEFAULT_CACHE_BLOCKS;
+
+    /* A path from the root to a data block must fit, plus a prefetch run. */
+    if (f->max_blocks < 2 * (DEPTH + PREFETCH_BLOCKS))
+        f->max_blocks = 2 * (DEPTH + PREFETCH_BLOCKS);
+
+    for (f->num_buckets = 64; f->num_buckets < f->max_blocks;)
+        f->num_buckets *= 2;
+
+    if (!(f->buckets = oe_calloc(f->num_buckets, sizeof(block_t*))))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    /* Read the header. */
+    if (oe_syscall_pread_ocall(
+            &n, host_fd, &f->header, sizeof(f->header), 0) != OE_OK)
+    {
+        OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+    if (n < 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (n == 0)
+    {
+        /* Initialize a new file. */
+        f->header.magic = HEADER_MAGIC;
+        f->header.version = HEADER_VERSION;
+        f->header.block_size = BLOCK_SIZE;
+
+        if (oe_random(f->header.salt, sizeof(f->header.salt)) != OE_OK)
+            OE_RAISE_ERRNO(OE_EIO);
+
+        f->header_dirty = !read_only;
+    }
+    else if (
+        (size_t)n != sizeof(f->header) || f->header.magic != HEADER_MAGIC ||
+        f->header.version != HEADER_VERSION ||
+        f->header.block_size != BLOCK_SIZE)
+    {
+        OE_RAISE_ERRNO(OE_EBADMSG);
+    }
+
+    /* Derive the file key from the caller's key and the file's salt. */
+    {
+        memcpy(fixed_data, _label, sizeof(_label));
+        memcpy(fixed_data + sizeof(_label), f->header.salt, SALT_SIZE);
+
+        if (oe_kdf_derive_key(
+                OE_KDF_HMAC_SHA256_CTR,
+                key,
+                key_size,
+                fixed_data,
+                sizeof(fixed_data),
+                file_key,
+                sizeof(file_key)) != OE_OK)
+        {
+            OE_RAISE_ERRNO(OE_EIO);
+        }
+
+        if (oe_aes_gcm_init(&f->gcm, file_key, sizeof(file_key)) != OE_OK)
+            OE_RAISE_ERRNO(OE_EIO);
+
+        gcm_initialized = true;
+    }
+
+    /* Authenticate and decrypt the secret part of an existing header. */
+    if (n != 0)
+    {
+        if (oe_aes_gcm_decrypt(
+                &f->gcm,
+                f->header.iv,
+                sizeof(f->header.iv),
+                (const uint8_t*)&f->header,
+                OE_OFFSETOF(header_t, iv),
+                (const uint8_t*)&f->header.secret,
+                sizeof(f->header.secret),
+                (uint8_t*)&f->header.secret,
+                f->header.tag) != OE_OK)
+        {
+            OE_RAISE_ERRNO_MSG(
+                OE_EBADMSG, "%s", "header integrity check failed");
+        }
+    }
+
+    /* Load the root node. */
+    {
+        if (!(f->root = oe_calloc(1, sizeof(block_t))))
+            OE_RAISE_ERRNO(OE_ENOMEM);
+
+        f->root->pos = 1;
+        f->root->level = DEPTH;
+
+        if (f->header.secret.root.present)
+        {
+            if (_host_read(f, 1, f->root->data, 1) != 0)
+                goto done;
+
+            if (_decrypt_block(
+                    f,
+                    1,
+                    &f->header.secret.root,
+                    f->root->data,
+                    f->root->data) != 0)
+            {
+                goto done;
+            }
+        }
+
+        _insert(f, f->root);
+    }
+
+    *pfile_out = f;
+    f = NULL;
+    ret = 0;
+
+done:
+
+    oe_secure_zero_fill(file_key, sizeof(file_key));
+
+    if (f)
+    {
+        if (f->root && !f->num_blocks)
+            oe_free(f->root);
+
+        if (gcm_initialized)
+            oe_aes_gcm_free(&f->gcm);
+
+        oe_free(f->buckets);
+        oe_secure_zero_fill(f, sizeof(oe_pfile_t));
+        oe_free(f);
+    }
+
+    return ret;
+}
+
+ssize_t oe_pfile_read(
+    oe_pfile_t* f,
+    uint64_t offset,
+    void* buf,
+    size_t count)
+{
+    ssize_t ret = -1;
+    uint8_t* p = (uint8_t*)buf;
+    size_t remaining;
+
+    if (!f || (count && !buf))
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (offset >= f->header.secret.size)
+        return 0;
+
+    if (count > f->header.secret.size - offset)
+        count = (size_t)(f->header.secret.size - offset);
+
+    if (count > OE_SSIZE_MAX)
+        count = OE_SSIZE_MAX;
+
+    for (remaining = count; remaining;)
+    {
+        uint64_t d = offset / BLOCK_SIZE;
+        size_t o = (size_t)(offset % BLOCK_SIZE);
+        size_t n = BLOCK_SIZE - o;
+        block_t* b;
+
+        if (n > remaining)
+            n = remaining;
+
+        /* Read ahead when the request spans several blocks or the reader is
+         * sequential. */
+        if (!_lookup(f, _block_pos(0, d)))
+        {
+            size_t want = (o + remaining + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+            if (d == f->next_read && want < PREFETCH_BLOCKS)
+                want = PREFETCH_BLOCKS;
+
+            if (want > f->max_blocks / 2)
+                want = f->max_blocks / 2;
+
+            if (want > 1 && _prefetch(f, d, want) != 0)
+                goto done;
+        }
+
+        if (!(b = _get_block(f, 0, d, true)))
+            goto done;
+
+        memcpy(p, b->data + o, n);
+        p += n;
+        offset += n;
+        remaining -= n;
+        f->next_read = offset / BLOCK_SIZE;
+
+        if (_shrink_cache(f) != 0)
+            goto done;
+    }
+
+    ret = (ssize_t)count;
+
+done:
+    return ret;
+}
+
+ssize_t oe_pfile_write(
+    oe_pfile_t* f,
+    uint64_t offset,
+    const void* buf,
+    size_t count)
+{
+    ssize_t ret = -1;
+    const uint8_t* p = (const uint8_t*)buf;
+    uint64_t end;
+    size_t remaining;
+
+    if (!f || (count && !buf))
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (f->read_only)
+        OE_RAISE_ERRNO(OE_EBADF);
+
+    if (count > OE_SSIZE_MAX || oe_safe_add_u64(offset, count, &end) != OE_OK ||
+        end > MAX_FILE_SIZE)
+    {
+        OE_RAISE_ERRNO(OE_EFBIG);
+    }
+
+    for (remaining = count; remaining;)
+    {
+        uint64_t d = offset / BLOCK_SIZE;
+        size_t o = (size_t)(offset % BLOCK_SIZE);
+        size_t n = BLOCK_SIZE - o;
+        block_t* b;
+
+        if (n > remaining)
+            n = remaining;
+
+        /* Blocks that are overwritten entirely need not be read. */
+        if (!(b = _get_block(f, 0, d, n != BLOCK_SIZE)))
+            goto done;
+
+        memcpy(b->data + o, p, n);
+        _mark_dirty(f, b);
+        p += n;
+        offset += n;
+        remaining -= n;
+
+        if (offset > f->header.secret.size)
+            f->header.secret.size = offset;
+
+        if (_shrink_cache(f) != 0)
+            goto done;
+    }
+
+    ret = (ssize_t)count;
+
+done:
+    return ret;
+}
+
+int oe_pfile_truncate(oe_pfile_t* f, uint64_t length)
+{
+    int ret = -1;
+
+    if (!f)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (f->read_only)
+        OE_RAISE_ERRNO(OE_EBADF);
+
+    if (length > MAX_FILE_SIZE)
+        OE_RAISE_ERRNO(OE_EFBIG);
+
+    if (length < f->header.secret.size)
+    {
+        size_t o = (size_t)(length % BLOCK_SIZE);
+
+        /* Bytes past the end of file must read as zero if it grows again. */
+        if (o)
+        {
+            block_t* b;
+
+            if (!(b = _get_block(f, 0, length / BLOCK_SIZE, true)))
+                goto done;
+
+            oe_memset_s(b->data + o, BLOCK_SIZE - o, 0, BLOCK_SIZE - o);
+            _mark_dirty(f, b);
+        }
+
+        if (_clear_from(
+                f, f->root, DEPTH, 0, (length + BLOCK_SIZE - 1) / BLOCK_SIZE) !=
+            0)
+        {
+            goto done;
+        }
+    }
+
+    f->header.secret.size = length;
+    f->header_dirty = true;
+
+    if (_shrink_cache(f) != 0)
+        goto done;
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+uint64_t oe_pfile_size(const oe_pfile_t* f)
+{
+    return f ? f->header.secret.size : 0;
+}
+
+int oe_pfile_close(oe_pfile_t* f)
+{
+    int ret = -1;
+
+    if (!f)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    ret = oe_pfile_flush(f);
+
+    while (f->head)
+    {
+        block_t* b = f->head;
+
+        b->parent = NULL;
+        _evict(f, b);
+    }
+
+    oe_aes_gcm_free(&f->gcm);
+    oe_free(f->buckets);
+    oe_secure_zero_fill(f, sizeof(oe_pfile_t));
+    oe_free(f);
+
+done:
+    return ret;
+}
@@ -0,0 +1,80 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_PROTECTEDFS_PFILE_H
+#define _OE_PROTECTEDFS_PFILE_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/types.h>
+#include <openenclave/internal/syscall/types.h>
+
+OE_EXTERNC_BEGIN
+
+/*
+**==============================================================================
+**
+** Protected file engine:
+**
+**     A protected file is stored on the host as a sequence of 4 KB blocks.
+**     Block 0 holds a header with a random salt (from which the file key is
+**     derived) and the encrypted file size and root reference. The remaining
+**     blocks form a Merkle tree of fixed depth: each tree node holds, for
+**     each of its 128 children, the GCM initialization vector and tag that
+**     were used to encrypt that child. Every block is encrypted with
+**     AES-256-GCM using its block number as additional data, so the host can
+**     neither read, modify nor rearrange blocks without detection.
+**
+**     Decrypted blocks are kept in an LRU cache. Modified blocks are written
+**     back in batches of contiguous blocks (one host write per run) when the
+**     cache fills up or the file is closed. Sequential reads prefetch the
+**     next run of data blocks with a single host read.
+**
+**     All functions return -1 and set oe_errno on failure. Functions must
+**     not be called concurrently on the same file.
+**
+**==============================================================================
+*/
+
+#define OE_PFILE_BLOCK_SIZE 4096
+
+/* Default number of decrypted blocks cached per file (1 MB). */
+#define OE_PFILE_DEFAULT_CACHE_BLOCKS 256
+
+typedef struct _oe_pfile oe_pfile_t;
+
+/* Open the protected file stored in the given host file. An empty host file
+ * is initialized as a new protected file unless read_only is set. */
+int oe_pfile_open(
+    oe_host_fd_t host_fd,
+    const uint8_t* key,
+    size_t key_size,
+    size_t cache_blocks,
+    bool read_only,
+    oe_pfile_t** pfile_out);
+
+ssize_t oe_pfile_read(
+    oe_pfile_t* pfile,
+    uint64_t offset,
+    void* buf,
+    size_t count);
+
+ssize_t oe_pfile_write(
+    oe_pfile_t* pfile,
+    uint64_t offset,
+    const void* buf,
+    size_t count);
+
+int oe_pfile_truncate(oe_pfile_t* pfile, uint64_t length);
+
+uint64_t oe_pfile_size(const oe_pfile_t* pfile);
+
+/* Write all modified blocks and the header back to the host file. */
+int oe_pfile_flush(oe_pfile_t* pfile);
+
+/* Flush (unless read-only) and release the file. The host file descriptor
+ * is not closed. */
+int oe_pfile_close(oe_pfile_t* pfile);
+
+OE_EXTERNC_END
+
+#endif /* _OE_PROTECTEDFS_PFILE_H */
@@ -0,0 +1,1173 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+/*
+**==============================================================================
+**
+** protectedfs:
+**
+**     This module implements a protected file system, which stores files on
+**     the host encrypted and integrity-protected with a key derived from the
+**     enclave's seal key (see pfile.h for the file format). The host sees
+**     only file names, directory structure and approximate file sizes. To use
+**     this module, the enclave application must:
+**
+**     (1) Link the oeprotectedfs library.
+**     (2) Load the module by calling oe_load_module_protected_file_system().
+**     (3) Mount a host directory, for example:
+**
+**             mount("/var/data", "/data", OE_PROTECTED_FILE_SYSTEM, 0, NULL);
+**
+**     (4) Use the standard C file I/O functions (e.g., open, read, write).
+**
+**     The optional data parameter passed to mount() is a comma-separated
+**     option string. The supported options are:
+**
+**         policy=unique|product
+**             The seal key policy (OE_SEAL_POLICY_UNIQUE by default).
+**
+**         cache=<bytes>[k|m|g]
+**             The size of the decrypted block cache of each open file
+**             (1 MB by default).
+**
+**     Modified blocks are written back when the cache fills up and when the
+**     file is closed. Files are not crash-consistent: if the enclave stops
+**     before a file is closed, the host copy may fail integrity checks. The
+**     host can also replace a file with an older copy of itself. A file must
+**     not be open for writing through more than one open() at a time.
+**
+**==============================================================================
+*/
+
+// clang-format off
+#include <openenclave/enclave.h>
+// clang-format on
+
+#include <openenclave/internal/syscall/device.h>
+#include <openenclave/internal/thread.h>
+#include <openenclave/internal/syscall/sys/mount.h>
+#include <openenclave/corelibc/stdlib.h>
+#include <openenclave/corelibc/string.h>
+#include <openenclave/internal/syscall/fcntl.h>
+#include <openenclave/internal/syscall/raise.h>
+#include <openenclave/internal/syscall/unistd.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/bits/safecrt.h>
+#include "pfile.h"
+
+#define FS_MAGIC 0x61e5c0d2
+#define FILE_MAGIC 0xd3a90f47
+
+/* Mask to extract the access mode: O_RDONLY, O_WRONLY, O_RDWR. */
+#define ACCESS_MODE_MASK 000000003
+
+/* The protected file system device. */
+typedef struct _device
+{
+    oe_device_t base;
+
+    /* Must be FS_MAGIC. */
+    uint32_t magic;
+
+    /* True if this file system has been mounted. */
+    bool is_mounted;
+
+    /* The parameters that were passed to the mount() function. */
+    struct
+    {
+        unsigned long flags;
+        char target[OE_PATH_MAX];
+    } mount;
+
+    /* The host file system instance that stores the files. */
+    oe_device_t* host;
+
+    /* The seal key from which file keys are derived. */
+    uint8_t* key;
+    size_t key_size;
+
+    /* Number of cached blocks per open file. */
+    size_t cache_blocks;
+} device_t;
+
+/* An open file description, shared between dup() copies. */
+typedef struct _handle
+{
+    oe_mutex_t lock;
+    size_t refs;
+    oe_fd_t* host_file;
+    oe_pfile_t* pfile;
+    oe_off_t offset;
+    int flags;
+} handle_t;
+
+/* Created by open(). */
+typedef struct _file
+{
+    oe_fd_t base;
+
+    /* Must be FILE_MAGIC. */
+    uint32_t magic;
+
+    handle_t* handle;
+} file_t;
+
+static oe_file_ops_t _get_file_ops(void);
+
+/* Return true if the file system was mounted as read-only. */
+OE_INLINE bool _is_read_only(const device_t* fs)
+{
+    return fs->mount.flags & OE_MS_RDONLY;
+}
+
+static device_t* _cast_device(const oe_device_t* device)
+{
+    device_t* ret = NULL;
+    device_t* fs = (device_t*)device;
+
+    if (fs == NULL || fs->magic != FS_MAGIC)
+        goto done;
+
+    ret = fs;
+
+done:
+    return ret;
+}
+
+/* Cast to a mounted device (one that owns a host file system instance). */
+static device_t* _cast_mounted_device(const oe_device_t* device)
+{
+    device_t* fs = _cast_device(device);
+
+    return (fs && fs->host) ? fs : NULL;
+}
+
+static file_t* _cast_file(const oe_fd_t* desc)
+{
+    file_t* ret = NULL;
+    file_t* file = (file_t*)desc;
+
+    if (file == NULL || file->magic != FILE_MAGIC)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    ret = file;
+
+done:
+    return ret;
+}
+
+/* Parse the mount() data parameter (e.g., "policy=product,cache=4m"). */
+static int _parse_options(
+    const char* options,
+    oe_seal_policy_t* policy,
+    size_t* cache_blocks)
+{
+    int ret = -1;
+    char buf[OE_PATH_MAX];
+    char* p;
+    char* save = NULL;
+
+    *policy = OE_SEAL_POLICY_UNIQUE;
+    *cache_blocks = OE_PFILE_DEFAULT_CACHE_BLOCKS;
+
+    if (!options)
+        return 0;
+
+    if (oe_strlcpy(buf, options, sizeof(buf)) >= sizeof(buf))
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    for (p = oe_strtok_r(buf, ",", &save); p; p = oe_strtok_r(NULL, ",", &save))
+    {
+        if (oe_strcmp(p, "policy=unique") == 0)
+        {
+            *policy = OE_SEAL_POLICY_UNIQUE;
+        }
+        else if (oe_strcmp(p, "policy=product") == 0)
+        {
+            *policy = OE_SEAL_POLICY_PRODUCT;
+        }
+        else if (oe_strncmp(p, "cache=", 6) == 0)
+        {
+            char* end = NULL;
+            uint64_t size;
+            uint64_t shift = 0;
+
+            size = oe_strtoul(p + 6, &end, 10);
+
+            if (end == p + 6)
+                OE_RAISE_ERRNO_MSG(OE_EINVAL, "option=%s", p);
+
+            switch (*end)
+            {
+                case '\0':
+                    break;
+                case 'k':
+                case 'K':
+                    shift = 10;
+                    break;
+                case 'm':
+                case 'M':
+                    shift = 20;
+                    break;
+                case 'g':
+                case 'G':
+                    shift = 30;
+                    break;
+                default:
+                    OE_RAISE_ERRNO_MSG(OE_EINVAL, "option=%s", p);
+            }
+
+            if (shift && end[1] != '\0')
+                OE_RAISE_ERRNO_MSG(OE_EINVAL, "option=%s", p);
+
+            if (size > (OE_SIZE_MAX >> shift))
+                OE_RAISE_ERRNO_MSG(OE_EINVAL, "option=%s", p);
+
+            *cache_blocks = (size_t)(size << shift) / OE_PFILE_BLOCK_SIZE;
+        }
+        else
+        {
+            OE_RAISE_ERRNO_MSG(OE_EINVAL, "option=%s", p);
+        }
+    }
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+/* Open the host file that backs a protected file. */
+static int _open_pfile(
+    device_t* fs,
+    const char* pathname,
+    int flags,
+    oe_mode_t mode,
+    oe_fd_t** host_file_out,
+    oe_pfile_t** pfile_out)
+{
+    int ret = -1;
+    oe_device_t* host = fs->host;
+    oe_fd_t* host_file = NULL;
+    bool read_only = (flags & ACCESS_MODE_MASK) == OE_O_RDONLY;
+    int host_flags;
+    oe_host_fd_t host_fd;
+
+    /* Blocks are read back to update them, so the host file is opened for
+     * reading even if the enclave only writes. Appending is handled here. */
+    host_flags = flags & (OE_O_CREAT | OE_O_EXCL);
+    host_flags |= read_only ? OE_O_RDONLY : OE_O_RDWR;
+
+    /* An empty host file is a new (empty) protected file. */
+    if (!read_only)
+        host_flags |= flags & OE_O_TRUNC;
+
+    if (!(host_file = host->ops.fs.open(host, pathname, host_flags, mode)))
+        OE_RAISE_ERRNO_MSG(oe_errno, "pathname=%s", pathname);
+
+    if ((host_fd = host_file->ops.fd.get_host_fd(host_file)) == -1)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (oe_pfile_open(
+            host_fd,
+            fs->key,
+            fs->key_size,
+            fs->cache_blocks,
+            read_only,
+            pfile_out) != 0)
+    {
+        OE_RAISE_ERRNO_MSG(oe_errno, "pathname=%s", pathname);
+    }
+
+    *host_file_out = host_file;
+    host_file = NULL;
+    ret = 0;
+
+done:
+
+    if (host_file)
+        host_file->ops.fd.close(host_file);
+
+    return ret;
+}
+
+/*
+**==============================================================================
+**
+** Device operations.
+**
+**==============================================================================
+*/
+
+/* Called by oe_mount(). */
+static int _protectedfs_mount(
+    oe_device_t* device,
+    const char* source,
+    const char* target,
+    const char* filesystemtype,
+    unsigned long flags,
+    const void* data)
+{
+    int ret = -1;
+    device_t* fs = _cast_device(device);
+    oe_device_t* hostfs = oe_get_hostfs_device();
+    oe_device_t* host = NULL;
+    oe_seal_policy_t policy;
+    size_t cache_blocks;
+    uint8_t* key = NULL;
+    size_t key_size = 0;
+
+    /* Fail if required parameters are null. */
+    if (!fs || !source || !target)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* Fail if this file system is already mounted. */
+    if (fs->is_mounted)
+        OE_RAISE_ERRNO(OE_EBUSY);
+
+    /* Cross check the file system type. */
+    if (oe_strcmp(filesystemtype, OE_DEVICE_NAME_PROTECTED_FILE_SYSTEM) != 0)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (_parse_options((const char*)data, &policy, &cache_blocks) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    /* Mount a private host file system instance on the source directory. */
+    {
+        if (hostfs->ops.fs.clone(hostfs, &host) != 0)
+            OE_RAISE_ERRNO(oe_errno);
+
+        if (host->ops.fs.mount(
+                host,
+                source,
+                target,
+                OE_DEVICE_NAME_HOST_FILE_SYSTEM,
+                flags,
+                NULL) != 0)
+        {
+            OE_RAISE_ERRNO(oe_errno);
+        }
+    }
+
+    if (oe_get_seal_key_by_policy(policy, &key, &key_size, NULL, NULL) !=
+        OE_OK)
+    {
+        OE_RAISE_ERRNO(OE_EACCES);
+    }
+
+    fs->host = host;
+    fs->key = key;
+    fs->key_size = key_size;
+    fs->cache_blocks = cache_blocks;
+    host = NULL;
+    key = NULL;
+
+    fs->mount.flags = flags;
+
+    /* Save the target parameter (checked by the umount2() function). */
+    oe_strlcpy(fs->mount.target, target, sizeof(fs->mount.target));
+
+    /* Set the flag indicating that this file system is mounted. */
+    fs->is_mounted = true;
+
+    ret = 0;
+
+done:
+
+    if (host)
+        host->ops.fs.base.release(host);
+
+    return ret;
+}
+
+/* Called by oe_umount2(). */
+static int _protectedfs_umount2(
+    oe_device_t* device,
+    const char* target,
+    int flags)
+{
+    int ret = -1;
+    device_t* fs = _cast_device(device);
+
+    /* Fail if any required parameters are null. */
+    if (!fs || !target)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* Fail if this file system is not mounted. */
+    if (!fs->is_mounted)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* Cross check target parameter with the one passed to mount(). */
+    if (oe_strcmp(target, fs->mount.target) != 0)
+        OE_RAISE_ERRNO(OE_ENOENT);
+
+    if (fs->host->ops.fs.umount2(fs->host, target, flags) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    /* Clear the cached mount parameters. */
+    oe_memset_s(&fs->mount, sizeof(fs->mount), 0, sizeof(fs->mount));
+
+    /* Set the flag indicating that this file system is mounted. */
+    fs->is_mounted = false;
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+/* Called by oe_mount() to make a copy of this device. */
+static int _protectedfs_clone(oe_device_t* device, oe_device_t** new_device)
+{
+    int ret = -1;
+    device_t* fs = _cast_device(device);
+    device_t* new_fs = NULL;
+
+    if (!fs || !new_device)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* Only the unmounted template device is cloned. */
+    if (fs->host)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (!(new_fs = oe_calloc(1, sizeof(device_t))))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    *new_fs = *fs;
+    *new_device = &new_fs->base;
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+/* Called by oe_umount() to release this device. Open files do not refer to
+ * the device, so they remain usable until closed. */
+static int _protectedfs_release(oe_device_t* device)
+{
+    int ret = -1;
+    device_t* fs = _cast_device(device);
+
+    if (!fs)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (fs->host)
+        fs->host->ops.fs.base.release(fs->host);
+
+    if (fs->key)
+        oe_free_key(fs->key, fs->key_size, NULL, 0);
+
+    oe_free(fs);
+    ret = 0;
+
+done:
+    return ret;
+}
+
+static oe_fd_t* _protectedfs_open(
+    oe_device_t* device,
+    const char* pathname,
+    int flags,
+    oe_mode_t mode)
+{
+    oe_fd_t* ret = NULL;
+    device_t* fs = _cast_mounted_device(device);
+    file_t* file = NULL;
+    handle_t* handle = NULL;
+    oe_fd_t* host_file = NULL;
+    oe_pfile_t* pfile = NULL;
+
+    /* Fail if any required parameters are null. */
+    if (!fs || !pathname)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* Directories are not encrypted, so they are served by the host file
+     * system instance directly. */
+    if ((flags & OE_O_DIRECTORY))
+        return fs->host->ops.fs.open(fs->host, pathname, flags, mode);
+
+    /* Fail if attempting to write to a read-only file system. */
+    if (_is_read_only(fs) && (flags & ACCESS_MODE_MASK) != OE_O_RDONLY)
+        OE_RAISE_ERRNO(OE_EPERM);
+
+    /* Allocate the file and the open file description. */
+    {
+        if (!(file = oe_calloc(1, sizeof(file_t))))
+            OE_RAISE_ERRNO(OE_ENOMEM);
+
+        if (!(handle = oe_calloc(1, sizeof(handle_t))))
+            OE_RAISE_ERRNO(OE_ENOMEM);
+
+        if (oe_mutex_init(&handle->lock) != OE_OK)
+            OE_RAISE_ERRNO(OE_ENOMEM);
+
+        file->base.type = OE_FD_TYPE_FILE;
+        file->magic = FILE_MAGIC;
+        file->base.ops.file = _get_file_ops();
+        file->handle = handle;
+    }
+
+    if (_open_pfile(fs, pathname, flags, mode, &host_file, &pfile) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    handle->refs = 1;
+    handle->host_file = host_file;
+    handle->pfile = pfile;
+    handle->flags = flags & ~(OE_O_CREAT | OE_O_EXCL | OE_O_TRUNC);
+
+    ret = &file->base;
+    file = NULL;
+    handle = NULL;
+
+done:
+
+    if (handle)
+    {
+        oe_mutex_destroy(&handle->lock);
+        oe_free(handle);
+    }
+
+    if (file)
+        oe_free(file);
+
+    return ret;
+}
+
+static int _protectedfs_dup(oe_fd_t* desc, oe_fd_t** new_file_out)
+{
+    int ret = -1;
+    file_t* file = _cast_file(desc);
+    file_t* new_file = NULL;
+
+    if (!new_file_out)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    *new_file_out = NULL;
+
+    /* Check parameters. */
+    if (!file)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* Create a new file that shares the open file description. */
+    {
+        if (!(new_file = oe_calloc(1, sizeof(file_t))))
+            OE_RAISE_ERRNO(OE_ENOMEM);
+
+        new_file->base.type = OE_FD_TYPE_FILE;
+        new_file->base.ops.file = _get_file_ops();
+        new_file->magic = FILE_MAGIC;
+        new_file->handle = file->handle;
+    }
+
+    oe_mutex_lock(&file->handle->lock);
+    file->handle->refs++;
+    oe_mutex_unlock(&file->handle->lock);
+
+    *new_file_out = &new_file->base;
+    new_file = NULL;
+    ret = 0;
+
+done:
+
+    if (new_file)
+        oe_free(new_file);
+
+    return ret;
+}
+
+static ssize_t _protectedfs_readv(
+    oe_fd_t* desc,
+    const struct oe_iovec* iov,
+    int iovcnt)
+{
+    ssize_t ret = -1;
+    file_t* file = _cast_file(desc);
+    handle_t* handle;
+    bool locked = false;
+    ssize_t total = 0;
+
+    if (!file || (!iov && iovcnt) || iovcnt < 0 || iovcnt > OE_IOV_MAX)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    handle = file->handle;
+
+    if ((handle->flags & ACCESS_MODE_MASK) == OE_O_WRONLY)
+        OE_RAISE_ERRNO(OE_EBADF);
+
+    oe_mutex_lock(&handle->lock);
+    locked = true;
+
+    for (int i = 0; i < iovcnt; i++)
+    {
+        ssize_t n;
+
+        if (iov[i].iov_len && !iov[i].iov_base)
+            OE_RAISE_ERRNO(OE_EINVAL);
+
+        n = oe_pfile_read(
+            handle->pfile,
+            (uint64_t)handle->offset,
+            iov[i].iov_base,
+            iov[i].iov_len);
+
+        if (n < 0)
+            OE_RAISE_ERRNO(oe_errno);
+
+        handle->offset += n;
+        total += n;
+
+        if ((size_t)n < iov[i].iov_len)
+            break;
+    }
+
+    ret = total;
+
+done:
+
+    if (locked)
+        oe_mutex_unlock(&handle->lock);
+
+    return ret;
+}
+
+static ssize_t _protectedfs_writev(
+    oe_fd_t* desc,
+    const struct oe_iovec* iov,
+    int iovcnt)
+{
+    ssize_t ret = -1;
+    file_t* file = _cast_file(desc);
+    handle_t* handle;
+    bool locked = false;
+    ssize_t total = 0;
+
+    if (!file || (!iov && iovcnt) || iovcnt < 0 || iovcnt > OE_IOV_MAX)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    handle = file->handle;
+
+    if ((handle->flags & ACCESS_MODE_MASK) == OE_O_RDONLY)
+        OE_RAISE_ERRNO(OE_EBADF);
+
+    oe_mutex_lock(&handle->lock);
+    locked = true;
+
+    if (handle->flags & OE_O_APPEND)
+        handle->offset = (oe_off_t)oe_pfile_size(handle->pfile);
+
+    for (int i = 0; i < iovcnt; i++)
+    {
+        ssize_t n;
+
+        if (iov[i].iov_len && !iov[i].iov_base)
+            OE_RAISE_ERRNO(OE_EINVAL);
+
+        n = oe_pfile_write(
+            handle->pfile,
+            (uint64_t)handle->offset,
+            iov[i].iov_base,
+            iov[i].iov_len);
+
+        if (n < 0)
+        {
+            /* Report a short write if some data was already written. */
+            if (total > 0)
+                break;
+
+            OE_RAISE_ERRNO(oe_errno);
+        }
+
+        handle->offset += n;
+        total += n;
+    }
+
+    ret = total;
+
+done:
+
+    if (locked)
+        oe_mutex_unlock(&handle->lock);
+
+    return ret;
+}
+
+static ssize_t _protectedfs_read(oe_fd_t* desc, void* buf, size_t count)
+{
+    struct oe_iovec iov;
+
+    iov.iov_base = buf;
+    iov.iov_len = count;
+
+    return _protectedfs_readv(desc, &iov, 1);
+}
+
+static ssize_t _protectedfs_write(oe_fd_t* desc, const void* buf, size_t count)
+{
+    struct oe_iovec iov;
+
+    iov.iov_base = (void*)buf;
+    iov.iov_len = count;
+
+    return _protectedfs_writev(desc, &iov, 1);
+}
+
+/* Directories are opened by the host file system instance, so a protected
+ * file is never a directory. */
+static int _protectedfs_getdents64(
+    oe_fd_t* desc,
+    struct oe_dirent* dirp,
+    unsigned int count)
+{
+    int ret = -1;
+    file_t* file = _cast_file(desc);
+
+    OE_UNUSED(dirp);
+    OE_UNUSED(count);
+
+    if (!file)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    OE_RAISE_ERRNO(OE_ENOTDIR);
+
+done:
+    return ret;
+}
+
+static oe_off_t _protectedfs_lseek(oe_fd_t* desc, oe_off_t offset, int whence)
+{
+    oe_off_t ret = -1;
+    file_t* file = _cast_file(desc);
+    handle_t* handle;
+    bool locked = false;
+    oe_off_t base;
+
+    if (!file)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    handle = file->handle;
+
+    oe_mutex_lock(&handle->lock);
+    locked = true;
+
+    switch (whence)
+    {
+        case OE_SEEK_SET:
+            base = 0;
+            break;
+        case OE_SEEK_CUR:
+            base = handle->offset;
+            break;
+        case OE_SEEK_END:
+            base = (oe_off_t)oe_pfile_size(handle->pfile);
+            break;
+        default:
+            OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+    if ((offset < 0 && base + offset < 0) ||
+        (offset > 0 && base > OE_INT64_MAX - offset))
+    {
+        OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+    handle->offset = base + offset;
+    ret = handle->offset;
+
+done:
+
+    if (locked)
+        oe_mutex_unlock(&handle->lock);
+
+    return ret;
+}
+
+static int _protectedfs_close(oe_fd_t* desc)
+{
+    int ret = -1;
+    file_t* file = _cast_file(desc);
+    handle_t* handle;
+    bool last;
+
+    if (!file)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    handle = file->handle;
+
+    oe_mutex_lock(&handle->lock);
+    last = (--handle->refs == 0);
+    oe_mutex_unlock(&handle->lock);
+
+    ret = 0;
+
+    if (last)
+    {
+        oe_fd_t* host_file = handle->host_file;
+
+        /* Write back modified blocks before closing the host file. */
+        if (oe_pfile_close(handle->pfile) != 0)
+            ret = -1;
+
+        if (host_file->ops.fd.close(host_file) != 0)
+            ret = -1;
+
+        oe_mutex_destroy(&handle->lock);
+        oe_free(handle);
+    }
+
+    oe_free(file);
+
+done:
+    return ret;
+}
+
+static int _protectedfs_ioctl(
+    oe_fd_t* desc,
+    unsigned long request,
+    uint64_t arg)
+{
+    int ret = -1;
+    file_t* file = _cast_file(desc);
+
+    OE_UNUSED(request);
+    OE_UNUSED(arg);
+
+    if (!file)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* Protected files are not terminal devices (see the note in hostfs). */
+    OE_RAISE_ERRNO(OE_ENOTTY);
+
+done:
+    return ret;
+}
+
+static int _protectedfs_fcntl(oe_fd_t* desc, int cmd, uint64_t arg)
+{
+    int ret = -1;
+    file_t* file = _cast_file(desc);
+    const int settable = OE_O_APPEND | OE_O_NONBLOCK;
+
+    if (!file)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    switch (cmd)
+    {
+        case OE_F_GETFD:
+        case OE_F_SETFD:
+            ret = 0;
+            break;
+
+        case OE_F_GETFL:
+            ret = file->handle->flags;
+            break;
+
+        case OE_F_SETFL:
+        {
+            handle_t* handle = file->handle;
+
+            oe_mutex_lock(&handle->lock);
+            handle->flags = (handle->flags & ~settable) | ((int)arg & settable);
+            oe_mutex_unlock(&handle->lock);
+            ret = 0;
+            break;
+        }
+
+        /* Record locks apply to the host file, so that they are visible to
+         * other processes sharing the host directory. */
+        case OE_F_GETLK64:
+        case OE_F_OFD_GETLK:
+        case OE_F_SETLKW64:
+        case OE_F_SETLK64:
+        case OE_F_OFD_SETLK:
+        case OE_F_OFD_SETLKW:
+        {
+            oe_fd_t* host_file = file->handle->host_file;
+
+            ret = host_file->ops.fd.fcntl(host_file, cmd, arg);
+            break;
+        }
+
+        default:
+            OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+done:
+    return ret;
+}
+
+/* The size of a regular file is the logical size recorded in its header as
+ * of the last time the file was written back. */
+static int _protectedfs_stat(
+    oe_device_t* device,
+    const char* pathname,
+    struct oe_stat* buf)
+{
+    int ret = -1;
+    device_t* fs = _cast_device(device);
+    oe_fd_t* host_file = NULL;
+    oe_pfile_t* pfile = NULL;
+
+    if (buf)
+        oe_memset_s(buf, sizeof(*buf), 0, sizeof(*buf));
+
+    if (!fs || !pathname || !buf)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* oe_mount() validates the mount target by calling stat() on the
+     * unmounted device, which checks it as the host file system would. */
+    if (!fs->host)
+    {
+        oe_device_t* hostfs = oe_get_hostfs_device();
+
+        ret = hostfs->ops.fs.stat(hostfs, pathname, buf);
+        goto done;
+    }
+
+    if (fs->host->ops.fs.stat(fs->host, pathname, buf) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (OE_S_ISREG(buf->st_mode) && buf->st_size > 0)
+    {
+        if (_open_pfile(fs, pathname, OE_O_RDONLY, 0, &host_file, &pfile) !=
+            0)
+        {
+            OE_RAISE_ERRNO(oe_errno);
+        }
+
+        buf->st_size = (oe_off_t)oe_pfile_size(pfile);
+    }
+
+    ret = 0;
+
+done:
+
+    if (pfile)
+        oe_pfile_close(pfile);
+
+    if (host_file)
+        host_file->ops.fd.close(host_file);
+
+    return ret;
+}
+
+static int _protectedfs_access(
+    oe_device_t* device,
+    const char* pathname,
+    int mode)
+{
+    int ret = -1;
+    device_t* fs = _cast_mounted_device(device);
+
+    if (!fs)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    ret = fs->host->ops.fs.access(fs->host, pathname, mode);
+
+done:
+    return ret;
+}
+
+/* Files are not bound to their names, so links and renames are performed by
+ * the host file system instance. */
+static int _protectedfs_link(
+    oe_device_t* device,
+    const char* oldpath,
+    const char* newpath)
+{
+    int ret = -1;
+    device_t* fs = _cast_mounted_device(device);
+
+    if (!fs)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    ret = fs->host->ops.fs.link(fs->host, oldpath, newpath);
+
+done:
+    return ret;
+}
+
+static int _protectedfs_unlink(oe_device_t* device, const char* pathname)
+{
+    int ret = -1;
+    device_t* fs = _cast_mounted_device(device);
+
+    if (!fs)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    ret = fs->host->ops.fs.unlink(fs->host, pathname);
+
+done:
+    return ret;
+}
+
+static int _protectedfs_rename(
+    oe_device_t* device,
+    const char* oldpath,
+    const char* newpath)
+{
+    int ret = -1;
+    device_t* fs = _cast_mounted_device(device);
+
+    if (!fs)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    ret = fs->host->ops.fs.rename(fs->host, oldpath, newpath);
+
+done:
+    return ret;
+}
+
+static int _protectedfs_truncate(
+    oe_device_t* device,
+    const char* path,
+    oe_off_t length)
+{
+    int ret = -1;
+    device_t* fs = _cast_mounted_device(device);
+    oe_fd_t* host_file = NULL;
+    oe_pfile_t* pfile = NULL;
+
+    if (!fs || !path || length < 0)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (_is_read_only(fs))
+        OE_RAISE_ERRNO(OE_EPERM);
+
+    if (_open_pfile(fs, path, OE_O_WRONLY, 0, &host_file, &pfile) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (oe_pfile_truncate(pfile, (uint64_t)length) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    ret = 0;
+
+done:
+
+    if (pfile && oe_pfile_close(pfile) != 0)
+        ret = -1;
+
+    if (host_file)
+        host_file->ops.fd.close(host_file);
+
+    return ret;
+}
+
+static int _protectedfs_mkdir(
+    oe_device_t* device,
+    const char* pathname,
+    oe_mode_t mode)
+{
+    int ret = -1;
+    device_t* fs = _cast_mounted_device(device);
+
+    if (!fs)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    ret = fs->host->ops.fs.mkdir(fs->host, pathname, mode);
+
+done:
+    return ret;
+}
+
+static int _protectedfs_rmdir(oe_device_t* device, const char* pathname)
+{
+    int ret = -1;
+    device_t* fs = _cast_mounted_device(device);
+
+    if (!fs)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    ret = fs->host->ops.fs.rmdir(fs->host, pathname);
+
+done:
+    return ret;
+}
+
+/* The host file holds ciphertext, so it is not exposed. */
+static oe_host_fd_t _protectedfs_get_host_fd(oe_fd_t* desc)
+{
+    OE_UNUSED(desc);
+    return -1;
+}
+
+// clang-format off
+static oe_file_ops_t _file_ops =
+{
+    .fd.read = _protectedfs_read,
+    .fd.write = _protectedfs_write,
+    .fd.readv = _protectedfs_readv,
+    .fd.writev = _protectedfs_writev,
+    .fd.dup = _protectedfs_dup,
+    .fd.ioctl = _protectedfs_ioctl,
+    .fd.fcntl = _protectedfs_fcntl,
+    .fd.close = _protectedfs_close,
+    .fd.get_host_fd = _protectedfs_get_host_fd,
+    .lseek = _protectedfs_lseek,
+    .getdents64 = _protectedfs_getdents64,
+};
+// clang-format on
+
+static oe_file_ops_t _get_file_ops(void)
+{
+    return _file_ops;
+};
+
+// clang-format off
+static device_t _protectedfs =
+{
+    .base.type = OE_DEVICE_TYPE_FILE_SYSTEM,
+    .base.name = OE_DEVICE_NAME_PROTECTED_FILE_SYSTEM,
+    .base.ops.fs =
+    {
+        .base.release = _protectedfs_release,
+        .clone = _protectedfs_clone,
+        .mount = _protectedfs_mount,
+        .umount2 = _protectedfs_umount2,
+        .open = _protectedfs_open,
+        .stat = _protectedfs_stat,
+        .access = _protectedfs_access,
+        .link = _protectedfs_link,
+        .unlink = _protectedfs_unlink,
+        .rename = _protectedfs_rename,
+        .truncate = _protectedfs_truncate,
+        .mkdir = _protectedfs_mkdir,
+        .rmdir = _protectedfs_rmdir,
+    },
+    .magic = FS_MAGIC,
+};
+// clang-format on
+
+oe_device_t* oe_get_protectedfs_device(void)
+{
+    return &_protectedfs.base;
+}
+
+oe_result_t oe_load_module_protected_file_system(void)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    static oe_spinlock_t _lock = OE_SPINLOCK_INITIALIZER;
+    static bool _loaded = false;
+
+    oe_spin_lock(&_lock);
+
+    if (!_loaded)
+    {
+        if (oe_device_table_set(
+                OE_DEVID_PROTECTED_FILE_SYSTEM, &_protectedfs.base) != 0)
+        {
+            /* Do not propagate errno to caller. */
+            oe_errno = 0;
+            OE_RAISE(OE_FAILURE);
+        }
+
+        _loaded = true;
+    }
+
+    result = OE_OK;
+
+done:
+    oe_spin_unlock(&_lock);
+
+    return result;
+}
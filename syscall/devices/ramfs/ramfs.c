@@ -0,0 +1,1926 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+/*
+**==============================================================================
+**
+** ramfs:
+**
+**     This module implements an in-enclave RAM file system. Files and
+**     directories live entirely in the enclave heap, so file I/O on paths
+**     under a ramfs mount point never leaves the enclave. The contents are
+**     lost when the file system is unmounted (and all of its files are
+**     closed) or when the enclave terminates. To use this module, the enclave
+**     application must:
+**
+**     (1) Link the oeramfs library.
+**     (2) Load the module by calling oe_load_module_ram_file_system().
+**     (3) Mount the file system, for example:
+**
+**             mount(NULL, "/tmp", OE_RAM_FILE_SYSTEM, 0, "size=16m");
+**
+**     (4) Use the standard C file I/O functions (e.g., open, read, write).
+**
+**     The optional data parameter passed to mount() is a comma-separated
+**     option string. The only supported option is "size=<bytes>[k|m|g]",
+**     which caps the number of bytes of file data the instance may hold.
+**     Writes that would exceed the cap fail with ENOSPC.
+**
+**==============================================================================
+*/
+
+// clang-format off
+#include <openenclave/enclave.h>
+// clang-format on
+
+#include <openenclave/internal/syscall/device.h>
+#include <openenclave/internal/thread.h>
+#include <openenclave/internal/syscall/dirent.h>
+#include <openenclave/internal/syscall/sys/mount.h>
+#include <openenclave/corelibc/stdlib.h>
+#include <openenclave/corelibc/string.h>
+#include <openenclave/internal/syscall/fcntl.h>
+#include <openenclave/internal/syscall/sys/ioctl.h>
+#include <openenclave/internal/syscall/raise.h>
+#include <openenclave/internal/syscall/unistd.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/utils.h>
+#include <openenclave/bits/safecrt.h>
+#include <openenclave/bits/safemath.h>
+
+#define FS_MAGIC 0x3c8d61a5
+#define FILE_MAGIC 0x9e07b2d4
+
+/* Mask to extract the access mode: O_RDONLY, O_WRONLY, O_RDWR. */
+#define ACCESS_MODE_MASK 000000003
+
+/* File data is allocated in multiples of this size. */
+#define RAMFS_BLOCK_SIZE 4096
+
+/* Upper bound on the size of extents added by geometric growth. */
+#define RAMFS_MAX_GROWTH (1024 * 1024)
+
+/* A contiguous run of file data starting at the given file offset. */
+typedef struct _extent
+{
+    size_t offset;
+    size_t size;
+    uint8_t* data;
+} extent_t;
+
+typedef struct _inode inode_t;
+
+/* A named entry within a directory. */
+typedef struct _entry
+{
+    char* name;
+    inode_t* inode;
+} entry_t;
+
+struct _inode
+{
+    oe_ino_t ino;
+    oe_mode_t mode;
+    oe_nlink_t nlink;
+
+    /* Number of open file descriptions that refer to this inode. */
+    size_t nopen;
+
+    /* Regular files: logical size and the extents covering [0, capacity).
+     * The bytes in [size, capacity) are always zero, so a file may be
+     * extended without touching its existing storage. */
+    size_t size;
+    size_t capacity;
+    extent_t* extents;
+    size_t num_extents;
+    size_t max_extents;
+
+    /* Directories: the parent directory and the entries (in creation order
+     * so that readdir() offsets remain stable across removals). */
+    inode_t* parent;
+    entry_t* entries;
+    size_t num_entries;
+    size_t max_entries;
+};
+
+/* The state of a mounted instance, shared by its device and open files. */
+typedef struct _ramfs
+{
+    oe_spinlock_t lock;
+
+    /* References held by the mounted device and by open file descriptions. */
+    size_t refs;
+
+    inode_t* root;
+    oe_ino_t next_ino;
+
+    /* Maximum bytes of file data (zero means limited only by the heap). */
+    size_t max_size;
+
+    /* Bytes of file data currently allocated. */
+    size_t used;
+} ramfs_t;
+
+/* The RAM file system device. */
+typedef struct _device
+{
+    oe_device_t base;
+
+    /* Must be FS_MAGIC. */
+    uint32_t magic;
+
+    /* True if this file system has been mounted. */
+    bool is_mounted;
+
+    /* The parameters that were passed to the mount() function. */
+    struct
+    {
+        unsigned long flags;
+        char target[OE_PATH_MAX];
+    } mount;
+
+    /* The file system tree (null for the unmounted device). */
+    ramfs_t* ramfs;
+} device_t;
+
+/* An open file description, shared between dup() copies. */
+typedef struct _handle
+{
+    size_t refs;
+    ramfs_t* ramfs;
+    inode_t* inode;
+    oe_off_t offset;
+    int flags;
+} handle_t;
+
+/* Created by open(). */
+typedef struct _file
+{
+    oe_fd_t base;
+
+    /* Must be FILE_MAGIC. */
+    uint32_t magic;
+
+    handle_t* handle;
+} file_t;
+
+static oe_file_ops_t _get_file_ops(void);
+
+/* Return true if the file system was mounted as read-only. */
+OE_INLINE bool _is_read_only(const device_t* fs)
+{
+    return fs->mount.flags & OE_MS_RDONLY;
+}
+
+static device_t* _cast_device(const oe_device_t* device)
+{
+    device_t* ret = NULL;
+    device_t* fs = (device_t*)device;
+
+    if (fs == NULL || fs->magic != FS_MAGIC)
+        goto done;
+
+    ret = fs;
+
+done:
+    return ret;
+}
+
+/* Cast to a mounted device (one that owns a file system tree). */
+static device_t* _cast_mounted_device(const oe_device_t* device)
+{
+    device_t* fs = _cast_device(device);
+
+    return (fs && fs->ramfs) ? fs : NULL;
+}
+
+static file_t* _cast_file(const oe_fd_t* desc)
+{
+    file_t* ret = NULL;
+    file_t* file = (file_t*)desc;
+
+    if (file == NULL || file->magic != FILE_MAGIC)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    ret = file;
+
+done:
+    return ret;
+}
+
+/*
+**==============================================================================
+**
+** Inode management (all called with the ramfs lock held).
+**
+**==============================================================================
+*/
+
+static inode_t* _new_inode(ramfs_t* ramfs, oe_mode_t mode)
+{
+    inode_t* inode;
+
+    if (!(inode = oe_calloc(1, sizeof(inode_t))))
+        return NULL;
+
+    inode->ino = ramfs->next_ino++;
+    inode->mode = mode;
+    inode->nlink = OE_S_ISDIR(mode) ? 2 : 1;
+
+    return inode;
+}
+
+static void _free_extents(ramfs_t* ramfs, inode_t* inode, size_t first)
+{
+    for (size_t i = first; i < inode->num_extents; i++)
+    {
+        ramfs->used -= inode->extents[i].size;
+        inode->capacity -= inode->extents[i].size;
+        oe_free(inode->extents[i].data);
+    }
+
+    inode->num_extents = first;
+}
+
+static void _free_inode(ramfs_t* ramfs, inode_t* inode)
+{
+    _free_extents(ramfs, inode, 0);
+    oe_free(inode->extents);
+
+    for (size_t i = 0; i < inode->num_entries; i++)
+        oe_free(inode->entries[i].name);
+
+    oe_free(inode->entries);
+    oe_free(inode);
+}
+
+/* Free the inode once it is neither linked nor open. */
+static void _put_inode(ramfs_t* ramfs, inode_t* inode)
+{
+    if (inode->nlink == 0 && inode->nopen == 0)
+        _free_inode(ramfs, inode);
+}
+
+/* Recursively release a directory tree when the file system is destroyed. */
+static void _free_tree(ramfs_t* ramfs, inode_t* dir)
+{
+    for (size_t i = 0; i < dir->num_entries; i++)
+    {
+        inode_t* inode = dir->entries[i].inode;
+
+        if (OE_S_ISDIR(inode->mode))
+        {
+            _free_tree(ramfs, inode);
+        }
+        else if (--inode->nlink == 0)
+        {
+            /* Hard links share the inode, so free it with its last link. */
+            _free_inode(ramfs, inode);
+        }
+    }
+
+    _free_inode(ramfs, dir);
+}
+
+static entry_t* _find_entry(const inode_t* dir, const char* name)
+{
+    for (size_t i = 0; i < dir->num_entries; i++)
+    {
+        if (oe_strcmp(dir->entries[i].name, name) == 0)
+            return &dir->entries[i];
+    }
+
+    return NULL;
+}
+
+static int _add_entry(inode_t* dir, const char* name, inode_t* inode)
+{
+    int ret = -1;
+    char* name_copy = NULL;
+
+    if (oe_strlen(name) > OE_NAME_MAX)
+        OE_RAISE_ERRNO(OE_ENAMETOOLONG);
+
+    if (dir->num_entries == dir->max_entries)
+    {
+        size_t n = dir->max_entries ? dir->max_entries * 2 : 8;
+        entry_t* entries;
+
+        if (!(entries = oe_realloc(dir->entries, n * sizeof(entry_t))))
+            OE_RAISE_ERRNO(OE_ENOMEM);
+
+        dir->entries = entries;
+        dir->max_entries = n;
+    }
+
+    if (!(name_copy = oe_strdup(name)))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    dir->entries[dir->num_entries].name = name_copy;
+    dir->entries[dir->num_entries].inode = inode;
+    dir->num_entries++;
+
+    if (OE_S_ISDIR(inode->mode))
+    {
+        inode->parent = dir;
+        dir->nlink++;
+    }
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+static void _remove_entry(inode_t* dir, entry_t* entry)
+{
+    size_t index = (size_t)(entry - dir->entries);
+    size_t tail = dir->num_entries - index - 1;
+
+    if (OE_S_ISDIR(entry->inode->mode))
+        dir->nlink--;
+
+    oe_free(entry->name);
+    memmove(entry, entry + 1, tail * sizeof(entry_t));
+    dir->num_entries--;
+}
+
+/* Split a path into its parent directory and final component. */
+static int _split_path(
+    const char* path,
+    char dirname[OE_PATH_MAX],
+    char basename[OE_PATH_MAX])
+{
+    int ret = -1;
+    const char* slash;
+
+    if (oe_strlcpy(dirname, path, OE_PATH_MAX) >= OE_PATH_MAX)
+        OE_RAISE_ERRNO(OE_ENAMETOOLONG);
+
+    if (!(slash = oe_strrchr(path, '/')))
+    {
+        oe_strlcpy(dirname, "/", OE_PATH_MAX);
+        oe_strlcpy(basename, path, OE_PATH_MAX);
+    }
+    else
+    {
+        oe_strlcpy(basename, slash + 1, OE_PATH_MAX);
+
+        if (slash == path)
+            dirname[1] = '\0';
+        else
+            dirname[slash - path] = '\0';
+    }
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+/* Resolve a path relative to the root of the file system. The mounter has
+ * already normalized the path, so it contains no "." or ".." components. */
+static inode_t* _lookup(ramfs_t* ramfs, const char* path)
+{
+    inode_t* ret = NULL;
+    inode_t* inode = ramfs->root;
+    char buf[OE_PATH_MAX];
+    char* p;
+    char* save = NULL;
+
+    if (oe_strlcpy(buf, path, sizeof(buf)) >= sizeof(buf))
+        OE_RAISE_ERRNO(OE_ENAMETOOLONG);
+
+    for (p = oe_strtok_r(buf, "/", &save); p; p = oe_strtok_r(NULL, "/", &save))
+    {
+        entry_t* entry;
+
+        if (!OE_S_ISDIR(inode->mode))
+            OE_RAISE_ERRNO(OE_ENOTDIR);
+
+        if (!(entry = _find_entry(inode, p)))
+            OE_RAISE_ERRNO(OE_ENOENT);
+
+        inode = entry->inode;
+    }
+
+    ret = inode;
+
+done:
+    return ret;
+}
+
+/* Resolve the parent directory of a path and return its final component. */
+static inode_t* _lookup_parent(
+    ramfs_t* ramfs,
+    const char* path,
+    char basename[OE_PATH_MAX])
+{
+    inode_t* ret = NULL;
+    inode_t* dir;
+    char dirname[OE_PATH_MAX];
+
+    if (_split_path(path, dirname, basename) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (*basename == '\0')
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (!(dir = _lookup(ramfs, dirname)))
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (!OE_S_ISDIR(dir->mode))
+        OE_RAISE_ERRNO(OE_ENOTDIR);
+
+    ret = dir;
+
+done:
+    return ret;
+}
+
+/*
+**==============================================================================
+**
+** File data (all called with the ramfs lock held).
+**
+**==============================================================================
+*/
+
+/* Return the index of the extent that contains the given offset. */
+static size_t _find_extent(const inode_t* inode, size_t offset)
+{
+    size_t lo = 0;
+    size_t hi = inode->num_extents;
+
+    while (hi - lo > 1)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+
+        if (inode->extents[mid].offset <= offset)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+/* Grow the storage of a file so that it covers at least the given size. */
+static int _reserve(ramfs_t* ramfs, inode_t* inode, size_t size)
+{
+    int ret = -1;
+    size_t needed;
+    size_t grow;
+    uint8_t* data = NULL;
+
+    if (size <= inode->capacity)
+        return 0;
+
+    /* Grow geometrically (bounded) to keep the number of extents small. */
+    needed = oe_round_up_to_multiple(size - inode->capacity, RAMFS_BLOCK_SIZE);
+    grow = inode->capacity;
+
+    if (grow > RAMFS_MAX_GROWTH)
+        grow = RAMFS_MAX_GROWTH;
+
+    if (grow < needed)
+        grow = needed;
+
+    if (ramfs->max_size)
+    {
+        if (ramfs->used + needed > ramfs->max_size)
+            OE_RAISE_ERRNO(OE_ENOSPC);
+
+        if (ramfs->used + grow > ramfs->max_size)
+            grow = needed;
+    }
+
+    if (inode->num_extents == inode->max_extents)
+    {
+        size_t n = inode->max_extents ? inode->max_extents * 2 : 4;
+        extent_t* extents;
+
+        if (!(extents = oe_realloc(inode->extents, n * sizeof(extent_t))))
+            OE_RAISE_ERRNO(OE_ENOMEM);
+
+        inode->extents = extents;
+        inode->max_extents = n;
+    }
+
+    if (!(data = oe_calloc(1, grow)))
+        OE_RAISE_ERRNO(OE_ENOSPC);
+
+    inode->extents[inode->num_extents].offset = inode->capacity;
+    inode->extents[inode->num_extents].size = grow;
+    inode->extents[inode->num_extents].data = data;
+    inode->num_extents++;
+    inode->capacity += grow;
+    ramfs->used += grow;
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+static void _copy_out(
+    const inode_t* inode,
+    size_t offset,
+    uint8_t* buf,
+    size_t count)
+{
+    size_t i = _find_extent(inode, offset);
+
+    while (count)
+    {
+        const extent_t* extent = &inode->extents[i++];
+        size_t start = offset - extent->offset;
+        size_t n = extent->size - start;
+
+        if (n > count)
+            n = count;
+
+        memcpy(buf, extent->data + start, n);
+        buf += n;
+        offset += n;
+        count -= n;
+    }
+}
+
+static void _copy_in(
+    inode_t* inode,
+    size_t offset,
+    const uint8_t* buf,
+    size_t count)
+{
+    size_t i = _find_extent(inode, offset);
+
+    while (count)
+    {
+        extent_t* extent = &inode->extents[i++];
+        size_t start = offset - extent->offset;
+        size_t n = extent->size - start;
+
+        if (n > count)
+            n = count;
+
+        memcpy(extent->data + start, buf, n);
+        buf += n;
+        offset += n;
+        count -= n;
+    }
+}
+
+static int _truncate_inode(ramfs_t* ramfs, inode_t* inode, size_t length)
+{
+    int ret = -1;
+
+    if (length > inode->size)
+    {
+        /* The bytes past the end of file are already zero. */
+        if (_reserve(ramfs, inode, length) != 0)
+            OE_RAISE_ERRNO(oe_errno);
+    }
+    else if (length < inode->size)
+    {
+        size_t i = 0;
+
+        /* Release the extents that lie wholly beyond the new size. */
+        while (i < inode->num_extents && inode->extents[i].offset < length)
+            i++;
+
+        _free_extents(ramfs, inode, i);
+
+        /* Restore the zero invariant for the rest of the last extent. */
+        if (i > 0)
+        {
+            extent_t* extent = &inode->extents[i - 1];
+            size_t start = length - extent->offset;
+
+            memset(extent->data + start, 0, extent->size - start);
+        }
+    }
+
+    inode->size = length;
+    ret = 0;
+
+done:
+    return ret;
+}
+
+static ssize_t _read_inode(
+    inode_t* inode,
+    size_t offset,
+    void* buf,
+    size_t count)
+{
+    if (offset >= inode->size)
+        return 0;
+
+    if (count > inode->size - offset)
+        count = inode->size - offset;
+
+    _copy_out(inode, offset, buf, count);
+
+    return (ssize_t)count;
+}
+
+static ssize_t _write_inode(
+    ramfs_t* ramfs,
+    inode_t* inode,
+    size_t offset,
+    const void* buf,
+    size_t count)
+{
+    ssize_t ret = -1;
+    size_t end;
+
+    if (oe_safe_add_sizet(offset, count, &end) != OE_OK ||
+        end > OE_SSIZE_MAX)
+        OE_RAISE_ERRNO(OE_EFBIG);
+
+    if (_reserve(ramfs, inode, end) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    _copy_in(inode, offset, buf, count);
+
+    if (end > inode->size)
+        inode->size = end;
+
+    ret = (ssize_t)count;
+
+done:
+    return ret;
+}
+
+/*
+**==============================================================================
+**
+** File system instances.
+**
+**==============================================================================
+*/
+
+static void _ramfs_unref(ramfs_t* ramfs)
+{
+    size_t refs;
+
+    oe_spin_lock(&ramfs->lock);
+    refs = --ramfs->refs;
+    oe_spin_unlock(&ramfs->lock);
+
+    if (refs == 0)
+    {
+        _free_tree(ramfs, ramfs->root);
+        oe_free(ramfs);
+    }
+}
+
+static ramfs_t* _ramfs_new(size_t max_size)
+{
+    ramfs_t* ramfs;
+
+    if (!(ramfs = oe_calloc(1, sizeof(ramfs_t))))
+        return NULL;
+
+    ramfs->lock = OE_SPINLOCK_INITIALIZER;
+    ramfs->refs = 1;
+    ramfs->next_ino = 1;
+    ramfs->max_size = max_size;
+
+    if (!(ramfs->root = _new_inode(ramfs, OE_S_IFDIR | 0777)))
+    {
+        oe_free(ramfs);
+        return NULL;
+    }
+
+    ramfs->root->parent = ramfs->root;
+
+    return ramfs;
+}
+
+/* Parse the mount() data parameter (e.g., "size=64m"). */
+static int _parse_options(const char* options, size_t* max_size)
+{
+    int ret = -1;
+    char buf[OE_PATH_MAX];
+    char* p;
+    char* save = NULL;
+
+    *max_size = 0;
+
+    if (!options)
+        return 0;
+
+    if (oe_strlcpy(buf, options, sizeof(buf)) >= sizeof(buf))
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    for (p = oe_strtok_r(buf, ",", &save); p; p = oe_strtok_r(NULL, ",", &save))
+    {
+        char* end = NULL;
+        uint64_t size;
+        uint64_t shift = 0;
+
+        if (oe_strncmp(p, "size=", 5) != 0)
+            OE_RAISE_ERRNO_MSG(OE_EINVAL, "option=%s", p);
+
+        size = oe_strtoul(p + 5, &end, 10);
+
+        if (end == p + 5)
+            OE_RAISE_ERRNO_MSG(OE_EINVAL, "option=%s", p);
+
+        switch (*end)
+        {
+            case '\0':
+                break;
+            case 'k':
+            case 'K':
+                shift = 10;
+                break;
+            case 'm':
+            case 'M':
+                shift = 20;
+                break;
+            case 'g':
+            case 'G':
+                shift = 30;
+                break;
+            default:
+                OE_RAISE_ERRNO_MSG(OE_EINVAL, "option=%s", p);
+        }
+
+        if (shift && end[1] != '\0')
+            OE_RAISE_ERRNO_MSG(OE_EINVAL, "option=%s", p);
+
+        if (size > (OE_SIZE_MAX >> shift))
+            OE_RAISE_ERRNO_MSG(OE_EINVAL, "option=%s", p);
+
+        *max_size = (size_t)(size << shift);
+    }
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+static void _fill_stat(const inode_t* inode, struct oe_stat* buf)
+{
+    oe_memset_s(buf, sizeof(*buf), 0, sizeof(*buf));
+    buf->st_ino = inode->ino;
+    buf->st_mode = inode->mode;
+    buf->st_nlink = inode->nlink;
+    buf->st_size = (oe_off_t)inode->size;
+    buf->st_blksize = RAMFS_BLOCK_SIZE;
+    buf->st_blocks = (oe_blkcnt_t)(inode->capacity / 512);
+}
+
+/*
+**==============================================================================
+**
+** Device operations.
+**
+**==============================================================================
+*/
+
+/* Called by oe_mount(). */
+static int _ramfs_mount(
+    oe_device_t* device,
+    const char* source,
+    const char* target,
+    const char* filesystemtype,
+    unsigned long flags,
+    const void* data)
+{
+    int ret = -1;
+    device_t* fs = _cast_device(device);
+    size_t max_size;
+
+    /* The source parameter is ignored (there is no backing store). */
+    OE_UNUSED(source);
+
+    /* Fail if required parameters are null. */
+    if (!fs || !target)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* Fail if this file system is already mounted. */
+    if (fs->is_mounted)
+        OE_RAISE_ERRNO(OE_EBUSY);
+
+    /* Cross check the file system type. */
+    if (oe_strcmp(filesystemtype, OE_DEVICE_NAME_RAM_FILE_SYSTEM) != 0)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (_parse_options((const char*)data, &max_size) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (!(fs->ramfs = _ramfs_new(max_size)))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    fs->mount.flags = flags;
+
+    /* Save the target parameter (checked by the umount2() function). */
+    oe_strlcpy(fs->mount.target, target, sizeof(fs->mount.target));
+
+    /* Set the flag indicating that this file system is mounted. */
+    fs->is_mounted = true;
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+/* Called by oe_umount2(). */
+static int _ramfs_umount2(oe_device_t* device, const char* target, int flags)
+{
+    int ret = -1;
+    device_t* fs = _cast_device(device);
+
+    OE_UNUSED(flags);
+
+    /* Fail if any required parameters are null. */
+    if (!fs || !target)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* Fail if this file system is not mounted. */
+    if (!fs->is_mounted)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* Cross check target parameter with the one passed to mount(). */
+    if (oe_strcmp(target, fs->mount.target) != 0)
+        OE_RAISE_ERRNO(OE_ENOENT);
+
+    /* Clear the cached mount parameters. */
+    oe_memset_s(&fs->mount, sizeof(fs->mount), 0, sizeof(fs->mount));
+
+    /* Set the flag indicating that this file system is mounted. */
+    fs->is_mounted = false;
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+/* Called by oe_mount() to make a copy of this device. */
+static int _ramfs_clone(oe_device_t* device, oe_device_t** new_device)
+{
+    int ret = -1;
+    device_t* fs = _cast_device(device);
+    device_t* new_fs = NULL;
+
+    if (!fs || !new_device)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (!(new_fs = oe_calloc(1, sizeof(device_t))))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    *new_fs = *fs;
+    *new_device = &new_fs->base;
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+/* Called by oe_umount() to release this device. The tree itself outlives
+ * the device until the last file that refers to it is closed. */
+static int _ramfs_release(oe_device_t* device)
+{
+    int ret = -1;
+    device_t* fs = _cast_device(device);
+
+    if (!fs)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (fs->ramfs)
+        _ramfs_unref(fs->ramfs);
+
+    oe_free(fs);
+    ret = 0;
+
+done:
+    return ret;
+}
+
+static oe_fd_t* _ramfs_open(
+    oe_device_t* device,
+    const char* pathname,
+    int flags,
+    oe_mode_t mode)
+{
+    oe_fd_t* ret = NULL;
+    device_t* fs = _cast_mounted_device(device);
+    ramfs_t* ramfs = NULL;
+    file_t* file = NULL;
+    handle_t* handle = NULL;
+    inode_t* inode = NULL;
+    bool locked = false;
+    int access = flags & ACCESS_MODE_MASK;
+
+    /* Fail if any required parameters are null. */
+    if (!fs || !pathname)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    ramfs = fs->ramfs;
+
+    /* Fail if attempting to write to a read-only file system. */
+    if (_is_read_only(fs) && (access != OE_O_RDONLY || (flags & OE_O_CREAT)))
+        OE_RAISE_ERRNO(OE_EPERM);
+
+    /* Allocate the file and the open file description. */
+    {
+        if (!(file = oe_calloc(1, sizeof(file_t))))
+            OE_RAISE_ERRNO(OE_ENOMEM);
+
+        if (!(handle = oe_calloc(1, sizeof(handle_t))))
+            OE_RAISE_ERRNO(OE_ENOMEM);
+
+        file->base.type = OE_FD_TYPE_FILE;
+        file->magic = FILE_MAGIC;
+        file->base.ops.file = _get_file_ops();
+        file->handle = handle;
+    }
+
+    oe_spin_lock(&ramfs->lock);
+    locked = true;
+
+    if (!(inode = _lookup(ramfs, pathname)))
+    {
+        char basename[OE_PATH_MAX];
+        inode_t* dir;
+
+        if (oe_errno != OE_ENOENT || !(flags & OE_O_CREAT) ||
+            (flags & OE_O_DIRECTORY))
+        {
+            OE_RAISE_ERRNO(oe_errno);
+        }
+
+        if (!(dir = _lookup_parent(ramfs, pathname, basename)))
+            OE_RAISE_ERRNO(oe_errno);
+
+        if (!(inode = _new_inode(ramfs, OE_S_IFREG | (mode & 07777))))
+            OE_RAISE_ERRNO(OE_ENOMEM);
+
+        if (_add_entry(dir, basename, inode) != 0)
+        {
+            _free_inode(ramfs, inode);
+            OE_RAISE_ERRNO(oe_errno);
+        }
+    }
+    else
+    {
+        if ((flags & OE_O_CREAT) && (flags & OE_O_EXCL))
+            OE_RAISE_ERRNO(OE_EEXIST);
+
+        if (OE_S_ISDIR(inode->mode))
+        {
+            /* Directories can only be opened for read access. */
+            if (access != OE_O_RDONLY)
+                OE_RAISE_ERRNO(OE_EISDIR);
+        }
+        else
+        {
+            if (flags & OE_O_DIRECTORY)
+                OE_RAISE_ERRNO(OE_ENOTDIR);
+
+            if ((flags & OE_O_TRUNC) && access != OE_O_RDONLY)
+            {
+                if (_truncate_inode(ramfs, inode, 0) != 0)
+                    OE_RAISE_ERRNO(oe_errno);
+            }
+        }
+    }
+
+    inode->nopen++;
+    ramfs->refs++;
+
+    handle->refs = 1;
+    handle->ramfs = ramfs;
+    handle->inode = inode;
+    handle->flags = flags & ~(OE_O_CREAT | OE_O_EXCL | OE_O_TRUNC);
+
+    ret = &file->base;
+    file = NULL;
+    handle = NULL;
+
+done:
+
+    if (locked)
+        oe_spin_unlock(&ramfs->lock);
+
+    if (handle)
+        oe_free(handle);
+
+    if (file)
+        oe_free(file);
+
+    return ret;
+}
+
+static int _ramfs_dup(oe_fd_t* desc, oe_fd_t** new_file_out)
+{
+    int ret = -1;
+    file_t* file = _cast_file(desc);
+    file_t* new_file = NULL;
+
+    if (!new_file_out)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    *new_file_out = NULL;
+
+    /* Check parameters. */
+    if (!file)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* Create a new file that shares the open file description. */
+    {
+        if (!(new_file = oe_calloc(1, sizeof(file_t))))
+            OE_RAISE_ERRNO(OE_ENOMEM);
+
+        new_file->base.type = OE_FD_TYPE_FILE;
+        new_file->base.ops.file = _get_file_ops();
+        new_file->magic = FILE_MAGIC;
+        new_file->handle = file->handle;
+    }
+
+    oe_spin_lock(&file->handle->ramfs->lock);
+    file->handle->refs++;
+    oe_spin_unlock(&file->handle->ramfs->lock);
+
+    *new_file_out = &new_file->base;
+    new_file = NULL;
+    ret = 0;
+
+done:
+
+    if (new_file)
+        oe_free(new_file);
+
+    return ret;
+}
+
+static ssize_t _ramfs_readv(
+    oe_fd_t* desc,
+    const struct oe_iovec* iov,
+    int iovcnt)
+{
+    ssize_t ret = -1;
+    file_t* file = _cast_file(desc);
+    handle_t* handle;
+    bool locked = false;
+    ssize_t total = 0;
+
+    if (!file || (!iov && iovcnt) || iovcnt < 0 || iovcnt > OE_IOV_MAX)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    handle = file->handle;
+
+    if ((handle->flags & ACCESS_MODE_MASK) == OE_O_WRONLY)
+        OE_RAISE_ERRNO(OE_EBADF);
+
+    oe_spin_lock(&handle->ramfs->lock);
+    locked = true;
+
+    if (OE_S_ISDIR(handle->inode->mode))
+        OE_RAISE_ERRNO(OE_EISDIR);
+
+    for (int i = 0; i < iovcnt; i++)
+    {
+        ssize_t n;
+
+        if (iov[i].iov_len && !iov[i].iov_base)
+            OE_RAISE_ERRNO(OE_EINVAL);
+
+        n = _read_inode(
+            handle->inode,
+            (size_t)handle->offset,
+            iov[i].iov_base,
+            iov[i].iov_len);
+
+        handle->offset += n;
+        total += n;
+
+        if ((size_t)n < iov[i].iov_len)
+            break;
+    }
+
+    ret = total;
+
+done:
+
+    if (locked)
+        oe_spin_unlock(&handle->ramfs->lock);
+
+    return ret;
+}
+
+static ssize_t _ramfs_writev(
+    oe_fd_t* desc,
+    const struct oe_iovec* iov,
+    int iovcnt)
+{
+    ssize_t ret = -1;
+    file_t* file = _cast_file(desc);
+    handle_t* handle;
+    bool locked = false;
+    ssize_t total = 0;
+
+    if (!file || (!iov && iovcnt) || iovcnt < 0 || iovcnt > OE_IOV_MAX)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    handle = file->handle;
+
+    if ((handle->flags & ACCESS_MODE_MASK) == OE_O_RDONLY)
+        OE_RAISE_ERRNO(OE_EBADF);
+
+    oe_spin_lock(&handle->ramfs->lock);
+    locked = true;
+
+    if (handle->flags & OE_O_APPEND)
+        handle->offset = (oe_off_t)handle->inode->size;
+
+    for (int i = 0; i < iovcnt; i++)
+    {
+        ssize_t n;
+
+        if (iov[i].iov_len && !iov[i].iov_base)
+            OE_RAISE_ERRNO(OE_EINVAL);
+
+        n = _write_inode(
+            handle->ramfs,
+            handle->inode,
+            (size_t)handle->offset,
+            iov[i].iov_base,
+            iov[i].iov_len);
+
+        if (n < 0)
+        {
+            /* Report a short write if some data was already written. */
+            if (total > 0)
+                break;
+
+            OE_RAISE_ERRNO(oe_errno);
+        }
+
+        handle->offset += n;
+        total += n;
+    }
+
+    ret = total;
+
+done:
+
+    if (locked)
+        oe_spin_unlock(&handle->ramfs->lock);
+
+    return ret;
+}
+
+static ssize_t _ramfs_read(oe_fd_t* desc, void* buf, size_t count)
+{
+    struct oe_iovec iov;
+
+    iov.iov_base = buf;
+    iov.iov_len = count;
+
+    return _ramfs_readv(desc, &iov, 1);
+}
+
+static ssize_t _ramfs_write(oe_fd_t* desc, const void* buf, size_t count)
+{
+    struct oe_iovec iov;
+
+    iov.iov_base = (void*)buf;
+    iov.iov_len = count;
+
+    return _ramfs_writev(desc, &iov, 1);
+}
+
+/* Called by oe_getdents64() to handle the getdents64 system call. The file
+ * offset of a directory is the index of the next entry, where entries 0 and
+ * 1 are "." and "..". */
+static int _ramfs_getdents64(
+    oe_fd_t* desc,
+    struct oe_dirent* dirp,
+    unsigned int count)
+{
+    int ret = -1;
+    int bytes = 0;
+    file_t* file = _cast_file(desc);
+    handle_t* handle;
+    bool locked = false;
+    unsigned int n = count / sizeof(struct oe_dirent);
+
+    if (!file || !dirp)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    handle = file->handle;
+
+    oe_spin_lock(&handle->ramfs->lock);
+    locked = true;
+
+    if (!OE_S_ISDIR(handle->inode->mode))
+        OE_RAISE_ERRNO(OE_ENOTDIR);
+
+    for (unsigned int i = 0; i < n; i++)
+    {
+        const inode_t* dir = handle->inode;
+        size_t index = (size_t)handle->offset;
+        const inode_t* inode;
+        const char* name;
+
+        if (index == 0)
+        {
+            inode = dir;
+            name = ".";
+        }
+        else if (index == 1)
+        {
+            inode = dir->parent;
+            name = "..";
+        }
+        else if (index - 2 < dir->num_entries)
+        {
+            inode = dir->entries[index - 2].inode;
+            name = dir->entries[index - 2].name;
+        }
+        else
+        {
+            break;
+        }
+
+        oe_memset_s(dirp, sizeof(*dirp), 0, sizeof(*dirp));
+        dirp->d_ino = inode->ino;
+        dirp->d_off = (oe_off_t)(index + 1);
+        dirp->d_reclen = sizeof(struct oe_dirent);
+        dirp->d_type = OE_S_ISDIR(inode->mode) ? OE_DT_DIR : OE_DT_REG;
+        oe_strlcpy(dirp->d_name, name, sizeof(dirp->d_name));
+
+        handle->offset++;
+        bytes += (int)sizeof(struct oe_dirent);
+        dirp++;
+    }
+
+    /* Do not leave a stale errno behind at end of directory. */
+    oe_errno = 0;
+    ret = bytes;
+
+done:
+
+    if (locked)
+        oe_spin_unlock(&handle->ramfs->lock);
+
+    return ret;
+}
+
+static oe_off_t _ramfs_lseek(oe_fd_t* desc, oe_off_t offset, int whence)
+{
+    oe_off_t ret = -1;
+    file_t* file = _cast_file(desc);
+    handle_t* handle;
+    bool locked = false;
+    oe_off_t base;
+
+    if (!file)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    handle = file->handle;
+
+    oe_spin_lock(&handle->ramfs->lock);
+    locked = true;
+
+    /* Only rewind is permitted on a directory. */
+    if (OE_S_ISDIR(handle->inode->mode) &&
+        (offset != 0 || whence != OE_SEEK_SET))
+    {
+        OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+    switch (whence)
+    {
+        case OE_SEEK_SET:
+            base = 0;
+            break;
+        case OE_SEEK_CUR:
+            base = handle->offset;
+            break;
+        case OE_SEEK_END:
+            base = (oe_off_t)handle->inode->size;
+            break;
+        default:
+            OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+    if ((offset < 0 && base + offset < 0) ||
+        (offset > 0 && base > OE_INT64_MAX - offset))
+    {
+        OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+    handle->offset = base + offset;
+    ret = handle->offset;
+
+done:
+
+    if (locked)
+        oe_spin_unlock(&handle->ramfs->lock);
+
+    return ret;
+}
+
+static int _ramfs_close(oe_fd_t* desc)
+{
+    int ret = -1;
+    file_t* file = _cast_file(desc);
+    handle_t* handle;
+    ramfs_t* ramfs;
+    bool last;
+
+    if (!file)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    handle = file->handle;
+    ramfs = handle->ramfs;
+
+    oe_spin_lock(&ramfs->lock);
+    {
+        if ((last = (--handle->refs == 0)))
+        {
+            handle->inode->nopen--;
+            _put_inode(ramfs, handle->inode);
+        }
+    }
+    oe_spin_unlock(&ramfs->lock);
+
+    if (last)
+    {
+        oe_free(handle);
+        _ramfs_unref(ramfs);
+    }
+
+    oe_free(file);
+    ret = 0;
+
+done:
+    return ret;
+}
+
+static int _ramfs_ioctl(oe_fd_t* desc, unsigned long request, uint64_t arg)
+{
+    int ret = -1;
+    file_t* file = _cast_file(desc);
+
+    OE_UNUSED(request);
+    OE_UNUSED(arg);
+
+    if (!file)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* RAM files are not terminal devices (see the note in hostfs). */
+    OE_RAISE_ERRNO(OE_ENOTTY);
+
+done:
+    return ret;
+}
+
+static int _ramfs_fcntl(oe_fd_t* desc, int cmd, uint64_t arg)
+{
+    int ret = -1;
+    file_t* file = _cast_file(desc);
+    const int settable = OE_O_APPEND | OE_O_NONBLOCK;
+
+    if (!file)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    switch (cmd)
+    {
+        case OE_F_GETFD:
+        case OE_F_SETFD:
+            ret = 0;
+            break;
+
+        case OE_F_GETFL:
+            ret = file->handle->flags;
+            break;
+
+        case OE_F_SETFL:
+        {
+            handle_t* handle = file->handle;
+
+            oe_spin_lock(&handle->ramfs->lock);
+            handle->flags = (handle->flags & ~settable) | ((int)arg & settable);
+            oe_spin_unlock(&handle->ramfs->lock);
+            ret = 0;
+            break;
+        }
+
+        /* The file system is private to this enclave, which is a single
+         * process, so record locks never conflict. */
+        case OE_F_GETLK64:
+        case OE_F_OFD_GETLK:
+        {
+            struct oe_flock* lock = (struct oe_flock*)arg;
+
+            if (!lock)
+                OE_RAISE_ERRNO(OE_EINVAL);
+
+            lock->l_type = OE_F_UNLCK;
+            ret = 0;
+            break;
+        }
+
+        case OE_F_SETLKW64:
+        case OE_F_SETLK64:
+        case OE_F_OFD_SETLK:
+        case OE_F_OFD_SETLKW:
+            ret = 0;
+            break;
+
+        default:
+            OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+done:
+    return ret;
+}
+
+static int _ramfs_stat(
+    oe_device_t* device,
+    const char* pathname,
+    struct oe_stat* buf)
+{
+    int ret = -1;
+    device_t* fs = _cast_device(device);
+    inode_t* inode;
+    bool locked = false;
+
+    if (buf)
+        oe_memset_s(buf, sizeof(*buf), 0, sizeof(*buf));
+
+    if (!fs || !pathname || !buf)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* oe_mount() validates the mount target by calling stat() on the
+     * unmounted device. A RAM file system brings its own (empty) root, so
+     * report a directory for any target. */
+    if (!fs->ramfs)
+    {
+        buf->st_mode = OE_S_IFDIR | 0777;
+        buf->st_nlink = 2;
+        ret = 0;
+        goto done;
+    }
+
+    oe_spin_lock(&fs->ramfs->lock);
+    locked = true;
+
+    if (!(inode = _lookup(fs->ramfs, pathname)))
+        OE_RAISE_ERRNO(oe_errno);
+
+    _fill_stat(inode, buf);
+    ret = 0;
+
+done:
+
+    if (locked)
+        oe_spin_unlock(&fs->ramfs->lock);
+
+    return ret;
+}
+
+static int _ramfs_access(oe_device_t* device, const char* pathname, int mode)
+{
+    int ret = -1;
+    device_t* fs = _cast_mounted_device(device);
+    const uint32_t MASK = (OE_R_OK | OE_W_OK | OE_X_OK);
+    bool locked = false;
+
+    if (!fs || !pathname || ((uint32_t)mode & ~MASK))
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (_is_read_only(fs) && (mode & OE_W_OK))
+        OE_RAISE_ERRNO(OE_EROFS);
+
+    oe_spin_lock(&fs->ramfs->lock);
+    locked = true;
+
+    if (!_lookup(fs->ramfs, pathname))
+        OE_RAISE_ERRNO(oe_errno);
+
+    ret = 0;
+
+done:
+
+    if (locked)
+        oe_spin_unlock(&fs->ramfs->lock);
+
+    return ret;
+}
+
+static int _ramfs_link(
+    oe_device_t* device,
+    const char* oldpath,
+    const char* newpath)
+{
+    int ret = -1;
+    device_t* fs = _cast_mounted_device(device);
+    char basename[OE_PATH_MAX];
+    inode_t* inode;
+    inode_t* dir;
+    bool locked = false;
+
+    if (!fs || !oldpath || !newpath)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* Fail if attempting to write to a read-only file system. */
+    if (_is_read_only(fs))
+        OE_RAISE_ERRNO(OE_EPERM);
+
+    oe_spin_lock(&fs->ramfs->lock);
+    locked = true;
+
+    if (!(inode = _lookup(fs->ramfs, oldpath)))
+        OE_RAISE_ERRNO(oe_errno);
+
+    /* Hard links to directories are not permitted. */
+    if (OE_S_ISDIR(inode->mode))
+        OE_RAISE_ERRNO(OE_EPERM);
+
+    if (!(dir = _lookup_parent(fs->ramfs, newpath, basename)))
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (_find_entry(dir, basename))
+        OE_RAISE_ERRNO(OE_EEXIST);
+
+    if (_add_entry(dir, basename, inode) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    inode->nlink++;
+    ret = 0;
+
+done:
+
+    if (locked)
+        oe_spin_unlock(&fs->ramfs->lock);
+
+    return ret;
+}
+
+/* Remove a directory entry; if want_dir, the entry must be an empty
+ * directory, otherwise it must not be a directory. */
+static int _remove(oe_device_t* device, const char* pathname, bool want_dir)
+{
+    int ret = -1;
+    device_t* fs = _cast_mounted_device(device);
+    char basename[OE_PATH_MAX];
+    inode_t* dir;
+    entry_t* entry;
+    inode_t* inode;
+    bool locked = false;
+
+    if (!fs || !pathname)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* Fail if attempting to write to a read-only file system. */
+    if (_is_read_only(fs))
+        OE_RAISE_ERRNO(OE_EPERM);
+
+    oe_spin_lock(&fs->ramfs->lock);
+    locked = true;
+
+    if (!(dir = _lookup_parent(fs->ramfs, pathname, basename)))
+    {
+        /* The root directory has no parent entry. */
+        if (want_dir && oe_errno == OE_EINVAL)
+            OE_RAISE_ERRNO(OE_EBUSY);
+
+        OE_RAISE_ERRNO(oe_errno);
+    }
+
+    if (!(entry = _find_entry(dir, basename)))
+        OE_RAISE_ERRNO(OE_ENOENT);
+
+    inode = entry->inode;
+
+    if (want_dir)
+    {
+        if (!OE_S_ISDIR(inode->mode))
+            OE_RAISE_ERRNO(OE_ENOTDIR);
+
+        if (inode->num_entries)
+            OE_RAISE_ERRNO(OE_ENOTEMPTY);
+
+        /* Detach from the parent, which may be freed while this directory
+         * is still open. */
+        inode->nlink = 0;
+        inode->parent = inode;
+    }
+    else
+    {
+        if (OE_S_ISDIR(inode->mode))
+            OE_RAISE_ERRNO(OE_EISDIR);
+
+        inode->nlink--;
+    }
+
+    _remove_entry(dir, entry);
+    _put_inode(fs->ramfs, inode);
+
+    ret = 0;
+
+done:
+
+    if (locked)
+        oe_spin_unlock(&fs->ramfs->lock);
+
+    return ret;
+}
+
+static int _ramfs_unlink(oe_device_t* device, const char* pathname)
+{
+    return _remove(device, pathname, false);
+}
+
+static int _ramfs_rmdir(oe_device_t* device, const char* pathname)
+{
+    return _remove(device, pathname, true);
+}
+
+static int _ramfs_rename(
+    oe_device_t* device,
+    const char* oldpath,
+    const char* newpath)
+{
+    int ret = -1;
+    device_t* fs = _cast_mounted_device(device);
+    char old_basename[OE_PATH_MAX];
+    char new_basename[OE_PATH_MAX];
+    inode_t* old_dir;
+    inode_t* new_dir;
+    entry_t* old_entry;
+    entry_t* new_entry;
+    inode_t* inode;
+    bool locked = false;
+
+    if (!fs || !oldpath || !newpath)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (_is_read_only(fs))
+        OE_RAISE_ERRNO(OE_EPERM);
+
+    oe_spin_lock(&fs->ramfs->lock);
+    locked = true;
+
+    if (!(old_dir = _lookup_parent(fs->ramfs, oldpath, old_basename)))
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (!(old_entry = _find_entry(old_dir, old_basename)))
+        OE_RAISE_ERRNO(OE_ENOENT);
+
+    inode = old_entry->inode;
+
+    if (!(new_dir = _lookup_parent(fs->ramfs, newpath, new_basename)))
+        OE_RAISE_ERRNO(oe_errno);
+
+    /* A directory cannot be moved into its own subtree. */
+    if (OE_S_ISDIR(inode->mode))
+    {
+        for (inode_t* p = new_dir; p != fs->ramfs->root; p = p->parent)
+        {
+            if (p == inode)
+                OE_RAISE_ERRNO(OE_EINVAL);
+        }
+    }
+
+    if ((new_entry = _find_entry(new_dir, new_basename)))
+    {
+        inode_t* victim = new_entry->inode;
+
+        /* Renaming a file onto itself (or onto another link to the same
+         * inode) does nothing. */
+        if (victim == inode)
+        {
+            ret = 0;
+            goto done;
+        }
+
+        if (OE_S_ISDIR(inode->mode))
+        {
+            if (!OE_S_ISDIR(victim->mode))
+                OE_RAISE_ERRNO(OE_ENOTDIR);
+
+            if (victim->num_entries)
+                OE_RAISE_ERRNO(OE_ENOTEMPTY);
+
+            victim->nlink = 0;
+        }
+        else
+        {
+            if (OE_S_ISDIR(victim->mode))
+                OE_RAISE_ERRNO(OE_EISDIR);
+
+            victim->nlink--;
+        }
+
+        _remove_entry(new_dir, new_entry);
+        _put_inode(fs->ramfs, victim);
+    }
+
+    if (_add_entry(new_dir, new_basename, inode) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    /* Re-find the old entry since the entry arrays may have changed. */
+    if ((old_entry = _find_entry(old_dir, old_basename)))
+        _remove_entry(old_dir, old_entry);
+
+    ret = 0;
+
+done:
+
+    if (locked)
+        oe_spin_unlock(&fs->ramfs->lock);
+
+    return ret;
+}
+
+static int _ramfs_truncate(
+    oe_device_t* device,
+    const char* path,
+    oe_off_t length)
+{
+    int ret = -1;
+    device_t* fs = _cast_mounted_device(device);
+    inode_t* inode;
+    bool locked = false;
+
+    if (!fs || !path || length < 0)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (_is_read_only(fs))
+        OE_RAISE_ERRNO(OE_EPERM);
+
+    oe_spin_lock(&fs->ramfs->lock);
+    locked = true;
+
+    if (!(inode = _lookup(fs->ramfs, path)))
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (OE_S_ISDIR(inode->mode))
+        OE_RAISE_ERRNO(OE_EISDIR);
+
+    if (_truncate_inode(fs->ramfs, inode, (size_t)length) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    ret = 0;
+
+done:
+
+    if (locked)
+        oe_spin_unlock(&fs->ramfs->lock);
+
+    return ret;
+}
+
+static int _ramfs_mkdir(
+    oe_device_t* device,
+    const char* pathname,
+    oe_mode_t mode)
+{
+    int ret = -1;
+    device_t* fs = _cast_mounted_device(device);
+    char basename[OE_PATH_MAX];
+    inode_t* dir;
+    inode_t* inode;
+    bool locked = false;
+
+    if (!fs || !pathname)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* Fail if attempting to write to a read-only file system. */
+    if (_is_read_only(fs))
+        OE_RAISE_ERRNO(OE_EPERM);
+
+    oe_spin_lock(&fs->ramfs->lock);
+    locked = true;
+
+    if (!(dir = _lookup_parent(fs->ramfs, pathname, basename)))
+    {
+        /* The root directory always exists. */
+        if (oe_errno == OE_EINVAL)
+            OE_RAISE_ERRNO(OE_EEXIST);
+
+        OE_RAISE_ERRNO(oe_errno);
+    }
+
+    if (_find_entry(dir, basename))
+        OE_RAISE_ERRNO(OE_EEXIST);
+
+    if (!(inode = _new_inode(fs->ramfs, OE_S_IFDIR | (mode & 07777))))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    if (_add_entry(dir, basename, inode) != 0)
+    {
+        _free_inode(fs->ramfs, inode);
+        OE_RAISE_ERRNO(oe_errno);
+    }
+
+    ret = 0;
+
+done:
+
+    if (locked)
+        oe_spin_unlock(&fs->ramfs->lock);
+
+    return ret;
+}
+
+static oe_host_fd_t _ramfs_get_host_fd(oe_fd_t* desc)
+{
+    OE_UNUSED(desc);
+
+    /* RAM files have no host counterpart. */
+    return -1;
+}
+
+// clang-format off
+static oe_file_ops_t _file_ops =
+{
+    .fd.read = _ramfs_read,
+    .fd.write = _ramfs_write,
+    .fd.readv = _ramfs_readv,
+    .fd.writev = _ramfs_writev,
+    .fd.dup = _ramfs_dup,
+    .fd.ioctl = _ramfs_ioctl,
+    .fd.fcntl = _ramfs_fcntl,
+    .fd.close = _ramfs_close,
+    .fd.get_host_fd = _ramfs_get_host_fd,
+    .lseek = _ramfs_lseek,
+    .getdents64 = _ramfs_getdents64,
+};
+// clang-format on
+
+static oe_file_ops_t _get_file_ops(void)
+{
+    return _file_ops;
+};
+
+// clang-format off
+static device_t _ramfs =
+{
+    .base.type = OE_DEVICE_TYPE_FILE_SYSTEM,
+    .base.name = OE_DEVICE_NAME_RAM_FILE_SYSTEM,
+    .base.ops.fs =
+    {
+        .base.release = _ramfs_release,
+        .clone = _ramfs_clone,
+        .mount = _ramfs_mount,
+        .umount2 = _ramfs_umount2,
+        .open = _ramfs_open,
+        .stat = _ramfs_stat,
+        .access = _ramfs_access,
+        .link = _ramfs_link,
+        .unlink = _ramfs_unlink,
+        .rename = _ramfs_rename,
+        .truncate = _ramfs_truncate,
+        .mkdir = _ramfs_mkdir,
+        .rmdir = _ramfs_rmdir,
+    },
+    .magic = FS_MAGIC,
+};
+// clang-format on
+
+oe_device_t* oe_get_ramfs_device(void)
+{
+    return &_ramfs.base;
+}
+
+oe_result_t oe_load_module_ram_file_system(void)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    static oe_spinlock_t _lock = OE_SPINLOCK_INITIALIZER;
+    static bool _loaded = false;
+
+    oe_spin_lock(&_lock);
+
+    if (!_loaded)
+    {
+        if (oe_device_table_set(OE_DEVID_RAM_FILE_SYSTEM, &_ramfs.base) != 0)
+        {
+            /* Do not propagate errno to caller. */
+            oe_errno = 0;
+            OE_RAISE(OE_FAILURE);
+        }
+
+        _loaded = true;
+    }
+
+    result = OE_OK;
+
+done:
+    oe_spin_unlock(&_lock);
+
+    return result;
+}
@@ -15,7 +15,7 @@
 int __oe_fcntl(int fd, int cmd, uint64_t arg)
 {
     int ret = -1;
-    oe_fd_t* desc;
+    oe_fd_t* desc = NULL;
 
     if (cmd == OE_F_DUPFD)
     {
@@ -28,6 +28,7 @@ int __oe_fcntl(int fd, int cmd, uint64_t arg)
     ret = desc->ops.fd.fcntl(desc, cmd, arg);
 
 done:
+    oe_fdtable_put(desc);
     return ret;
 }
 
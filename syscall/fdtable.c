@@ -2,12 +2,12 @@
 // Licensed under the MIT License.
 
 #include <openenclave/bits/module.h>
-#include <openenclave/bits/safecrt.h>
 #include <openenclave/corelibc/errno.h>
 #include <openenclave/corelibc/stdio.h>
 #include <openenclave/corelibc/stdlib.h>
 #include <openenclave/corelibc/string.h>
 #include <openenclave/enclave.h>
+#include <openenclave/internal/atomic.h>
 #include <openenclave/internal/print.h>
 #include <openenclave/internal/syscall/fd.h>
 #include <openenclave/internal/syscall/fdtable.h>
@@ -23,65 +23,92 @@
 **
 ** Local definitions:
 **
+**     The table is a two-level array: a fixed array of pointers to chunks of
+**     entries. Chunks are allocated on demand and never move or get freed
+**     (until exit), so oe_fdtable_get() can find an entry without taking a
+**     lock. Each chunk has a bitmap of the entries in use, from which new
+**     file descriptors are allocated.
+**
+**     Every descriptor has a reference count: one reference is held by the
+**     table and one by each operation in progress, so a descriptor is not
+**     closed until the last operation using it completes. To take a reference
+**     safely, a reader announces itself in the entry (entry_t.readers) before
+**     loading the descriptor pointer. A writer that removes a descriptor from
+**     an entry waits until the entry has no readers before dropping the
+**     table's reference, so no reader can be left holding a pointer to a
+**     freed descriptor.
+**
+**     Changes to the table (assign, release, reassign) are serialized by a
+**     spinlock.
+**
 **==============================================================================
 */
 
-/* The table allocation grows in multiples of the chunk size. */
+/* The number of entries in a chunk. */
 #define TABLE_CHUNK_SIZE 1024
 
-/* Define a table of file-descriptors. */
-typedef oe_fd_t* entry_t;
-static entry_t* _table;
-static size_t _table_size;
+/* The maximum number of chunks (and so of file descriptors). */
+#define TABLE_MAX_CHUNKS 1024
+
+#define BITS_PER_WORD (sizeof(uint64_t) * 8)
+
+typedef struct _entry
+{
+    oe_fd_t* volatile desc;
+    volatile uint64_t readers;
+} entry_t;
+
+typedef struct _chunk
+{
+    entry_t entries[TABLE_CHUNK_SIZE];
+
+    /* Bitmap of entries in use (guarded by _lock). */
+    uint64_t used[TABLE_CHUNK_SIZE / BITS_PER_WORD];
+} chunk_t;
+
+static chunk_t* volatile _chunks[TABLE_MAX_CHUNKS];
+static size_t _num_chunks;
+static volatile bool _initialized;
 static oe_spinlock_t _lock = OE_SPINLOCK_INITIALIZER;
 
-static void _atexit_handler(void)
+OE_STATIC_ASSERT(TABLE_CHUNK_SIZE % BITS_PER_WORD == 0);
+OE_STATIC_ASSERT((uint64_t)TABLE_CHUNK_SIZE * TABLE_MAX_CHUNKS <= OE_INT_MAX);
+
+/* Return the entry for the given file descriptor or null if its chunk has not
+ * been allocated. */
+static entry_t* _get_entry(int fd)
 {
-    /* Free the standard fds (but do not close them). */
-    for (size_t i = 0; i <= OE_STDERR_FILENO; i++)
-    {
-        oe_fd_t* desc = _table[i];
+    chunk_t* chunk;
+    const size_t index = (size_t)fd / TABLE_CHUNK_SIZE;
 
-        if (desc)
-            desc->ops.fd.close(desc);
-    }
+    if (fd < 0 || index >= TABLE_MAX_CHUNKS)
+        return NULL;
+
+    if (!(chunk = __atomic_load_n(&_chunks[index], __ATOMIC_ACQUIRE)))
+        return NULL;
 
-    oe_free(_table);
+    return &chunk->entries[(size_t)fd % TABLE_CHUNK_SIZE];
 }
 
-static int _resize_table(size_t new_size)
+/* Make the table large enough to contain the given file descriptor. Called
+ * with _lock held. */
+static int _grow_table(size_t fd)
 {
     int ret = -1;
 
-    /* The fdtable cannot be bigger than the maximum int file descriptor. */
-    if (new_size > OE_INT_MAX)
+    if (fd >= (size_t)TABLE_CHUNK_SIZE * TABLE_MAX_CHUNKS)
         goto done;
 
-    /* Round the new capacity up to the next multiple of the chunk size. */
-    new_size = oe_round_up_to_multiple(new_size, TABLE_CHUNK_SIZE);
-
-    if (new_size > OE_INT_MAX)
-        new_size = OE_INT_MAX;
-
-    if (new_size > _table_size)
+    while (_num_chunks <= fd / TABLE_CHUNK_SIZE)
     {
-        entry_t* p;
-        size_t n = new_size;
+        chunk_t* chunk;
 
-        /* Reallocate the table. */
-        if (!(p = oe_realloc(_table, n * sizeof(entry_t))))
+        if (!(chunk = oe_calloc(1, sizeof(chunk_t))))
             goto done;
 
-        /* Zero-fill the unused portion. */
-        {
-            const size_t num_bytes = (n - _table_size) * sizeof(entry_t);
-
-            if (oe_memset_s(p + _table_size, num_bytes, 0, num_bytes) != OE_OK)
-                goto done;
-        }
-
-        _table = p;
-        _table_size = new_size;
+        /* Publish the zero-filled chunk to lock-free readers. */
+        __atomic_store_n(&_chunks[_num_chunks], chunk, __ATOMIC_RELEASE);
+        _num_chunks++;
     }
 
     ret = 0;
@@ -90,16 +117,104 @@ done:
     return ret;
 }
 
+static void _set_used(size_t fd, bool used)
+{
+    chunk_t* chunk = _chunks[fd / TABLE_CHUNK_SIZE];
+    const size_t bit = fd % TABLE_CHUNK_SIZE;
+    const uint64_t mask = (uint64_t)1 << (bit % BITS_PER_WORD);
+
+    if (used)
+        chunk->used[bit / BITS_PER_WORD] |= mask;
+    else
+        chunk->used[bit / BITS_PER_WORD] &= ~mask;
+}
+
+/* Find the lowest unused file descriptor, growing the table if all are in
+ * use. Called with _lock held. */
+static int _find_unused(size_t* fd_out)
+{
+    for (size_t i = 0; i < _num_chunks; i++)
+    {
+        const chunk_t* chunk = _chunks[i];
+
+        for (size_t j = 0; j < OE_COUNTOF(chunk->used); j++)
+        {
+            const uint64_t free = ~chunk->used[j];
+
+            if (free)
+            {
+                const size_t bit = (size_t)__builtin_ctzll(free);
+
+                *fd_out = i * TABLE_CHUNK_SIZE + j * BITS_PER_WORD + bit;
+                return 0;
+            }
+        }
+    }
+
+    if (_grow_table(_num_chunks * TABLE_CHUNK_SIZE) != 0)
+        return -1;
+
+    *fd_out = (_num_chunks - 1) * TABLE_CHUNK_SIZE;
+    return 0;
+}
+
+/* Install a descriptor in an entry, taking the table's reference. Return the
+ * previous descriptor. Called with _lock held. */
+static oe_fd_t* _install(size_t fd, oe_fd_t* desc)
+{
+    entry_t* entry = _get_entry((int)fd);
+
+    if (desc)
+        desc->refcount = 1;
+
+    _set_used(fd, desc != NULL);
+
+    return __atomic_exchange_n(&entry->desc, desc, __ATOMIC_SEQ_CST);
+}
+
+/* Wait until no reader can still be taking a reference to a descriptor that
+ * was removed from the entry. Readers never block while announced, so this
+ * wait is short. */
+static void _wait_for_readers(entry_t* entry)
+{
+    while (__atomic_load_n(&entry->readers, __ATOMIC_SEQ_CST) != 0)
+        OE_CPU_RELAX();
+}
+
+/* Drop a reference, closing the descriptor with the last one. */
+static int _put(oe_fd_t* desc)
+{
+    if (oe_atomic_decrement(&desc->refcount) == 0)
+        return desc->ops.fd.close(desc);
+
+    return 0;
+}
+
+static void _atexit_handler(void)
+{
+    /* Free the standard fds (but do not close them). */
+    for (int i = 0; i <= OE_STDERR_FILENO; i++)
+    {
+        oe_fd_t* desc = _get_entry(i)->desc;
+
+        if (desc)
+            desc->ops.fd.close(desc);
+    }
+
+    for (size_t i = 0; i < _num_chunks; i++)
+        oe_free(_chunks[i]);
+}
+
+/* Called with _lock held. */
 static int _initialize(void)
 {
     int ret = -1;
-    static bool _initialized;
 
     /* Do this the first time only. */
     if (!_initialized)
     {
         /* Make the table more than large enough for standard files. */
-        if (_resize_table(TABLE_CHUNK_SIZE) != 0)
+        if (_grow_table(OE_STDERR_FILENO) != 0)
             OE_RAISE_ERRNO(OE_ENOMEM);
 
         /* Create the STDIN file. */
@@ -109,7 +224,7 @@ static int _initialize(void)
             if (!(file = oe_consolefs_create_file(OE_STDIN_FILENO)))
                 OE_RAISE_ERRNO(OE_ENOMEM);
 
-            _table[OE_STDIN_FILENO] = file;
+            _install(OE_STDIN_FILENO, file);
         }
 
         /* Create the STDOUT file. */
@@ -119,7 +234,7 @@ static int _initialize(void)
             if (!(file = oe_consolefs_create_file(OE_STDOUT_FILENO)))
                 OE_RAISE_ERRNO(OE_ENOMEM);
 
-            _table[OE_STDOUT_FILENO] = file;
+            _install(OE_STDOUT_FILENO, file);
         }
 
         /* Create the STDERR file. */
@@ -129,13 +244,13 @@ static int _initialize(void)
             if (!(file = oe_consolefs_create_file(OE_STDERR_FILENO)))
                 OE_RAISE_ERRNO(OE_ENOMEM);
 
-            _table[OE_STDERR_FILENO] = file;
+            _install(OE_STDERR_FILENO, file);
         }
 
         /* Install the atexit handler that will release the table. */
         oe_atexit(_atexit_handler);
 
-        _initialized = true;
+        __atomic_store_n(&_initialized, true, __ATOMIC_RELEASE);
     }
 
     ret = 0;
@@ -226,20 +341,10 @@ int oe_fdtable_assign(oe_fd_t* desc)
 #endif
 
     /* Find the first available file descriptor. */
-    for (index = 0; index < _table_size; index++)
-    {
-        if (!_table[index])
-            break;
-    }
+    if (_find_unused(&index) != 0)
+        OE_RAISE_ERRNO(OE_EMFILE);
 
-    /* If no free slot found, expand size of the file descriptor table. */
-    if (index == _table_size)
-    {
-        if (_resize_table(_table_size + 1) != 0)
-            OE_RAISE_ERRNO(OE_ENOMEM);
-    }
-
-    _table[index] = desc;
+    _install(index, desc);
     ret = (int)index;
 
 done:
@@ -253,27 +358,35 @@ done:
 int oe_fdtable_release(int fd)
 {
     int ret = -1;
+    entry_t* entry;
+    oe_fd_t* desc;
+    bool locked = false;
 
     oe_spin_lock(&_lock);
+    locked = true;
 
     if (_initialize() != 0)
         OE_RAISE_ERRNO(oe_errno);
 
-    /* Fail if fd is out of range. */
-    if (!(fd >= 0 && (size_t)fd < _table_size))
+    /* Fail if fd is out of range or was never assigned. */
+    if (!(entry = _get_entry(fd)) || !entry->desc)
         OE_RAISE_ERRNO(OE_EBADF);
 
-    /* Fail if entry was never assigned. */
-    if (!_table[fd])
-        OE_RAISE_ERRNO(OE_EINVAL);
+    desc = _install((size_t)fd, NULL);
 
-    _table[fd] = NULL;
+    oe_spin_unlock(&_lock);
+    locked = false;
 
-    ret = 0;
+    _wait_for_readers(entry);
+
+    /* Operations still in progress on other threads keep the descriptor open
+     * until they complete. */
+    ret = _put(desc);
 
 done:
 
-    oe_spin_unlock(&_lock);
+    if (locked)
+        oe_spin_unlock(&_lock);
 
     return ret;
 }
@@ -299,15 +412,16 @@ int oe_fdtable_reassign(int fd, oe_fd_t* new_desc, oe_fd_t** old_desc)
         OE_RAISE_ERRNO(oe_errno);
 
     /* Make table big enough to contain this file-descriptor. */
-    if (fd >= 0)
-        _resize_table((size_t)fd + 1);
-
-    if (fd < 0 || (size_t)fd >= _table_size)
+    if (fd < 0 || _grow_table((size_t)fd) != 0)
         OE_RAISE_ERRNO(OE_EBADF);
 
-    *old_desc = _table[fd];
+    *old_desc = _install((size_t)fd, new_desc);
+
+    oe_spin_unlock(&_lock);
+    locked = false;
 
-    _table[fd] = new_desc;
+    if (*old_desc)
+        _wait_for_readers(_get_entry(fd));
 
     ret = 0;
 
@@ -319,42 +433,45 @@ done:
     return ret;
 }
 
-static oe_fd_t* _get_fd(int fd)
+oe_fd_t* oe_fdtable_get(int fd, oe_fd_type_t type)
 {
     oe_fd_t* ret = NULL;
+    entry_t* entry;
+    oe_fd_t* desc;
 
-    oe_spin_lock(&_lock);
+    if (!__atomic_load_n(&_initialized, __ATOMIC_ACQUIRE))
+    {
+        int r;
 
-    if (_initialize() != 0)
-        OE_RAISE_ERRNO(oe_errno);
+        oe_spin_lock(&_lock);
+        r = _initialize();
+        oe_spin_unlock(&_lock);
 
-    if (fd < 0 || (size_t)fd >= _table_size)
-        OE_RAISE_ERRNO(OE_EBADF);
+        if (r != 0)
+            OE_RAISE_ERRNO(oe_errno);
+    }
 
-    if (_table[fd] == NULL)
+    if (!(entry = _get_entry(fd)))
         OE_RAISE_ERRNO(OE_EBADF);
 
-    ret = _table[fd];
+    /* Take a reference while announced as a reader of the entry. */
+    __atomic_add_fetch(&entry->readers, 1, __ATOMIC_SEQ_CST);
 
-done:
+    if ((desc = __atomic_load_n(&entry->desc, __ATOMIC_SEQ_CST)))
+        oe_atomic_increment(&desc->refcount);
 
-    oe_spin_unlock(&_lock);
+    __atomic_sub_fetch(&entry->readers, 1, __ATOMIC_SEQ_CST);
 
-    return ret;
-}
-
-oe_fd_t* oe_fdtable_get(int fd, oe_fd_type_t type)
-{
-    oe_fd_t* ret = NULL;
-    oe_fd_t* desc;
-
-    if (!(desc = _get_fd(fd)))
+    if (!desc)
         OE_RAISE_ERRNO(OE_EBADF);
 
     if (type != OE_FD_TYPE_ANY && desc->type != type)
     {
+        const oe_fd_type_t desc_type = desc->type;
+
+        oe_fdtable_put(desc);
         OE_RAISE_ERRNO_MSG(
-            OE_EINVAL, "fd=%d type=%u fd->type=%u", fd, type, desc->type);
+            OE_EINVAL, "fd=%d type=%u fd->type=%u", fd, type, desc_type);
     }
 
     ret = desc;
@@ -362,3 +479,14 @@ oe_fd_t* oe_fdtable_get(int fd, oe_fd_type_t type)
 done:
     return ret;
 }
+
+void oe_fdtable_put(oe_fd_t* desc)
+{
+    if (desc)
+    {
+        /* Errors from a deferred close cannot be reported to anyone. */
+        const int err = oe_errno;
+        _put(desc);
+        oe_errno = err;
+    }
+}
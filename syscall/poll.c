@@ -32,7 +32,10 @@ int oe_poll(struct oe_pollfd* fds, oe_nfds_t nfds, int timeout)
             OE_RAISE_ERRNO(OE_EBADF);
 
         /* Get the host fd for this fd struct. */
-        if ((host_fd = desc->ops.fd.get_host_fd(desc)) == -1)
+        host_fd = desc->ops.fd.get_host_fd(desc);
+        oe_fdtable_put(desc);
+
+        if (host_fd == -1)
             OE_RAISE_ERRNO(OE_EBADF);
 
         host_fds[i].events = fds[i].events;
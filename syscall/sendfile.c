@@ -0,0 +1,45 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/bits/console.h>
+#include <openenclave/internal/syscall/fdtable.h>
+#include <openenclave/internal/syscall/raise.h>
+#include <openenclave/internal/syscall/sys/sendfile.h>
+#include "syscall_t.h"
+
+ssize_t oe_sendfile(int out_fd, int in_fd, oe_off_t* offset, size_t count)
+{
+    ssize_t ret = -1;
+    oe_fd_t* out = NULL;
+    oe_fd_t* in = NULL;
+    oe_host_fd_t out_host_fd;
+    oe_host_fd_t in_host_fd;
+
+    if (!(out = oe_fdtable_get(out_fd, OE_FD_TYPE_ANY)))
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (!(in = oe_fdtable_get(in_fd, OE_FD_TYPE_ANY)))
+        OE_RAISE_ERRNO(oe_errno);
+
+    /* Descriptors implemented inside the enclave have no host descriptor. */
+    if ((out_host_fd = out->ops.fd.get_host_fd(out)) == -1)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if ((in_host_fd = in->ops.fd.get_host_fd(in)) == -1)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* Keep console output written before this call in order. */
+    if (oe_console_flush() != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (oe_syscall_sendfile_ocall(
+            &ret, out_host_fd, in_host_fd, offset, count) != OE_OK)
+    {
+        OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+done:
+    oe_fdtable_put(in);
+    oe_fdtable_put(out);
+    return ret;
+}
@@ -101,11 +101,17 @@ int oe_socketpair(int domain, int type, int protocol, int retfd[2])
     if ((retfd[0] = oe_fdtable_assign(socks[0])) < 0)
         OE_RAISE_ERRNO(oe_errno);
 
+    /* The table now owns the first socket. */
+    socks[0] = NULL;
+
     if ((retfd[1] = oe_fdtable_assign(socks[1])) < 0)
-        OE_RAISE_ERRNO(oe_errno);
+    {
+        const int err = oe_errno;
+        oe_fdtable_release(retfd[0]);
+        OE_RAISE_ERRNO(err);
+    }
 
     ret = (int)retval;
-    socks[0] = NULL;
     socks[1] = NULL;
 
 done:
@@ -128,7 +134,7 @@ int oe_socket(int domain, int type, int protocol)
 int oe_connect(int sockfd, const struct oe_sockaddr* addr, oe_socklen_t addrlen)
 {
     int ret = -1;
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
 
     if (!(sock = oe_fdtable_get(sockfd, OE_FD_TYPE_SOCKET)))
         OE_RAISE_ERRNO(oe_errno);
@@ -136,12 +142,13 @@ int oe_connect(int sockfd, const struct oe_sockaddr* addr, oe_socklen_t addrlen)
     ret = sock->ops.socket.connect(sock, addr, addrlen);
 
 done:
+    oe_fdtable_put(sock);
     return ret;
 }
 
 int oe_accept(int sockfd, struct oe_sockaddr* addr, oe_socklen_t* addrlen)
 {
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
     oe_fd_t* new_sock = NULL;
     int ret = -1;
 
@@ -161,13 +168,15 @@ done:
     if (new_sock)
         new_sock->ops.fd.close(new_sock);
 
+    oe_fdtable_put(sock);
+
     return ret;
 }
 
 int oe_listen(int sockfd, int backlog)
 {
     int ret = -1;
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
 
     if (!(sock = oe_fdtable_get(sockfd, OE_FD_TYPE_SOCKET)))
         OE_RAISE_ERRNO(oe_errno);
@@ -175,13 +184,14 @@ int oe_listen(int sockfd, int backlog)
     ret = sock->ops.socket.listen(sock, backlog);
 
 done:
+    oe_fdtable_put(sock);
     return ret;
 }
 
 ssize_t oe_recv(int sockfd, void* buf, size_t len, int flags)
 {
     ssize_t ret = -1;
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
 
     if (!(sock = oe_fdtable_get(sockfd, OE_FD_TYPE_SOCKET)))
         OE_RAISE_ERRNO(oe_errno);
@@ -189,6 +199,7 @@ ssize_t oe_recv(int sockfd, void* buf, size_t len, int flags)
     ret = sock->ops.socket.recv(sock, buf, len, flags);
 
 done:
+    oe_fdtable_put(sock);
     return ret;
 }
 
@@ -201,7 +212,7 @@ ssize_t oe_recvfrom(
     oe_socklen_t* addrlen)
 {
     ssize_t ret = -1;
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
 
     if (!(sock = oe_fdtable_get(sockfd, OE_FD_TYPE_SOCKET)))
         OE_RAISE_ERRNO(oe_errno);
@@ -209,13 +220,14 @@ ssize_t oe_recvfrom(
     ret = sock->ops.socket.recvfrom(sock, buf, len, flags, src_addr, addrlen);
 
 done:
+    oe_fdtable_put(sock);
     return ret;
 }
 
 ssize_t oe_send(int sockfd, const void* buf, size_t len, int flags)
 {
     ssize_t ret = -1;
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
 
     if (!(sock = oe_fdtable_get(sockfd, OE_FD_TYPE_SOCKET)))
         OE_RAISE_ERRNO(oe_errno);
@@ -223,6 +235,7 @@ ssize_t oe_send(int sockfd, const void* buf, size_t len, int flags)
     ret = sock->ops.socket.send(sock, buf, len, flags);
 
 done:
+    oe_fdtable_put(sock);
     return ret;
 }
 
@@ -235,7 +248,7 @@ ssize_t oe_sendto(
     oe_socklen_t addrlen)
 {
     ssize_t ret = -1;
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
 
     if (!(sock = oe_fdtable_get(sockfd, OE_FD_TYPE_SOCKET)))
         OE_RAISE_ERRNO(oe_errno);
@@ -243,13 +256,14 @@ ssize_t oe_sendto(
     ret = sock->ops.socket.sendto(sock, buf, len, flags, dest_addr, addrlen);
 
 done:
+    oe_fdtable_put(sock);
     return ret;
 }
 
 ssize_t oe_recvmsg(int sockfd, struct oe_msghdr* buf, int flags)
 {
     ssize_t ret = -1;
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
 
     if (!(sock = oe_fdtable_get(sockfd, OE_FD_TYPE_SOCKET)))
         OE_RAISE_ERRNO(oe_errno);
@@ -257,13 +271,14 @@ ssize_t oe_recvmsg(int sockfd, struct oe_msghdr* buf, int flags)
     ret = sock->ops.socket.recvmsg(sock, buf, flags);
 
 done:
+    oe_fdtable_put(sock);
     return ret;
 }
 
 ssize_t oe_sendmsg(int sockfd, const struct oe_msghdr* buf, int flags)
 {
     ssize_t ret = -1;
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
 
     if (!(sock = oe_fdtable_get(sockfd, OE_FD_TYPE_SOCKET)))
         OE_RAISE_ERRNO(oe_errno);
@@ -271,13 +286,14 @@ ssize_t oe_sendmsg(int sockfd, const struct oe_msghdr* buf, int flags)
     ret = sock->ops.socket.sendmsg(sock, buf, flags);
 
 done:
+    oe_fdtable_put(sock);
     return ret;
 }
 
 int oe_shutdown(int sockfd, int how)
 {
     int ret = -1;
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
 
     if (!(sock = oe_fdtable_get(sockfd, OE_FD_TYPE_SOCKET)))
         OE_RAISE_ERRNO(oe_errno);
@@ -285,13 +301,14 @@ int oe_shutdown(int sockfd, int how)
     ret = sock->ops.socket.shutdown(sock, how);
 
 done:
+    oe_fdtable_put(sock);
     return ret;
 }
 
 int oe_getsockname(int sockfd, struct oe_sockaddr* addr, oe_socklen_t* addrlen)
 {
     int ret = -1;
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
 
     if (!(sock = oe_fdtable_get(sockfd, OE_FD_TYPE_SOCKET)))
         OE_RAISE_ERRNO(oe_errno);
@@ -299,13 +316,14 @@ int oe_getsockname(int sockfd, struct oe_sockaddr* addr, oe_socklen_t* addrlen)
     ret = sock->ops.socket.getsockname(sock, addr, addrlen);
 
 done:
+    oe_fdtable_put(sock);
     return ret;
 }
 
 int oe_getpeername(int sockfd, struct oe_sockaddr* addr, oe_socklen_t* addrlen)
 {
     int ret = -1;
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
 
     if (!(sock = oe_fdtable_get(sockfd, OE_FD_TYPE_SOCKET)))
         OE_RAISE_ERRNO(oe_errno);
@@ -313,6 +331,7 @@ int oe_getpeername(int sockfd, struct oe_sockaddr* addr, oe_socklen_t* addrlen)
     ret = sock->ops.socket.getpeername(sock, addr, addrlen);
 
 done:
+    oe_fdtable_put(sock);
     return ret;
 }
 
@@ -324,7 +343,7 @@ int oe_getsockopt(
     oe_socklen_t* optlen)
 {
     int ret = -1;
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
 
     if (!(sock = oe_fdtable_get(sockfd, OE_FD_TYPE_SOCKET)))
         OE_RAISE_ERRNO(oe_errno);
@@ -332,6 +351,7 @@ int oe_getsockopt(
     ret = sock->ops.socket.getsockopt(sock, level, optname, optval, optlen);
 
 done:
+    oe_fdtable_put(sock);
     return ret;
 }
 
@@ -343,7 +363,7 @@ int oe_setsockopt(
     oe_socklen_t optlen)
 {
     int ret = -1;
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
 
     if (!(sock = oe_fdtable_get(sockfd, OE_FD_TYPE_SOCKET)))
         OE_RAISE_ERRNO(oe_errno);
@@ -351,13 +371,14 @@ int oe_setsockopt(
     ret = sock->ops.socket.setsockopt(sock, level, optname, optval, optlen);
 
 done:
+    oe_fdtable_put(sock);
     return ret;
 }
 
 int oe_bind(int sockfd, const struct oe_sockaddr* name, oe_socklen_t namelen)
 {
     int ret = -1;
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
 
     if (!(sock = oe_fdtable_get(sockfd, OE_FD_TYPE_SOCKET)))
         OE_RAISE_ERRNO(oe_errno);
@@ -365,5 +386,6 @@ int oe_bind(int sockfd, const struct oe_sockaddr* name, oe_socklen_t namelen)
     ret = sock->ops.socket.bind(sock, name, namelen);
 
 done:
+    oe_fdtable_put(sock);
     return ret;
 }
@@ -17,6 +17,7 @@
 #include <openenclave/internal/syscall/sys/mount.h>
 #include <openenclave/internal/syscall/sys/poll.h>
 #include <openenclave/internal/syscall/sys/select.h>
+#include <openenclave/internal/syscall/sys/sendfile.h>
 #include <openenclave/internal/syscall/sys/socket.h>
 #include <openenclave/internal/syscall/sys/stat.h>
 #include <openenclave/internal/syscall/sys/syscall.h>
@@ -130,6 +131,16 @@ static long _syscall(
             ret = oe_writev(fd, iov, iovcnt);
             goto done;
         }
+        case OE_SYS_sendfile:
+        {
+            int out_fd = (int)arg1;
+            int in_fd = (int)arg2;
+            oe_off_t* offset = (oe_off_t*)arg3;
+            size_t count = (size_t)arg4;
+
+            ret = oe_sendfile(out_fd, in_fd, offset, count);
+            goto done;
+        }
         case OE_SYS_read:
         {
             int fd = (int)arg1;
@@ -232,7 +232,7 @@ done:
 ssize_t oe_read(int fd, void* buf, size_t count)
 {
     ssize_t ret = -1;
-    oe_fd_t* desc;
+    oe_fd_t* desc = NULL;
 
     if (!(desc = oe_fdtable_get(fd, OE_FD_TYPE_ANY)))
         OE_RAISE_ERRNO(oe_errno);
@@ -240,13 +240,14 @@ ssize_t oe_read(int fd, void* buf, size_t count)
     ret = desc->ops.fd.read(desc, buf, count);
 
 done:
+    oe_fdtable_put(desc);
     return ret;
 }
 
 ssize_t oe_write(int fd, const void* buf, size_t count)
 {
     ssize_t ret = -1;
-    oe_fd_t* desc;
+    oe_fd_t* desc = NULL;
 
     if (!(desc = oe_fdtable_get(fd, OE_FD_TYPE_ANY)))
         OE_RAISE_ERRNO(oe_errno);
@@ -254,28 +255,21 @@ ssize_t oe_write(int fd, const void* buf, size_t count)
     ret = desc->ops.fd.write(desc, buf, count);
 
 done:
+    oe_fdtable_put(desc);
     return ret;
 }
 
 int oe_close(int fd)
 {
-    int ret = -1;
-    oe_fd_t* desc;
-
-    if (!(desc = oe_fdtable_get(fd, OE_FD_TYPE_ANY)))
-        OE_RAISE_ERRNO(oe_errno);
-
-    if ((ret = desc->ops.fd.close(desc)) == 0)
-        oe_fdtable_release(fd);
-
-done:
-    return ret;
+    /* The descriptor is closed once operations on it in other threads have
+     * completed. */
+    return oe_fdtable_release(fd);
 }
 
 int oe_dup(int oldfd)
 {
     int ret = -1;
-    oe_fd_t* old_desc;
+    oe_fd_t* old_desc = NULL;
     oe_fd_t* new_desc = NULL;
     int newfd;
 
@@ -296,12 +290,14 @@ done:
     if (new_desc)
         new_desc->ops.fd.close(new_desc);
 
+    oe_fdtable_put(old_desc);
+
     return ret;
 }
 
 int oe_dup2(int oldfd, int newfd)
 {
-    oe_fd_t* old_desc;
+    oe_fd_t* old_desc = NULL;
     oe_fd_t* new_desc = NULL;
     oe_fd_t* reassigned_desc;
     int retval = -1;
@@ -318,8 +314,8 @@ int oe_dup2(int oldfd, int newfd)
     if (oe_fdtable_reassign(newfd, new_desc, &reassigned_desc) == -1)
         OE_RAISE_ERRNO(OE_EINVAL);
 
-    if (reassigned_desc)
-        reassigned_desc->ops.fd.close(reassigned_desc);
+    /* Close the replaced descriptor (once other threads are done with it). */
+    oe_fdtable_put(reassigned_desc);
 
     new_desc = NULL;
 
@@ -328,6 +324,8 @@ done:
     if (new_desc)
         new_desc->ops.fd.close(new_desc);
 
+    oe_fdtable_put(old_desc);
+
     return newfd;
 }
 
@@ -490,7 +488,7 @@ done:
 oe_off_t oe_lseek(int fd, oe_off_t offset, int whence)
 {
     oe_off_t ret = -1;
-    oe_fd_t* file;
+    oe_fd_t* file = NULL;
 
     if (!(file = oe_fdtable_get(fd, OE_FD_TYPE_FILE)))
         OE_RAISE_ERRNO(oe_errno);
@@ -498,13 +496,14 @@ oe_off_t oe_lseek(int fd, oe_off_t offset, int whence)
     ret = file->ops.file.lseek(file, offset, whence);
 
 done:
+    oe_fdtable_put(file);
     return ret;
 }
 
 ssize_t oe_readv(int fd, const struct oe_iovec* iov, int iovcnt)
 {
     ssize_t ret = -1;
-    oe_fd_t* desc;
+    oe_fd_t* desc = NULL;
 
     if (!(desc = oe_fdtable_get(fd, OE_FD_TYPE_ANY)))
         OE_RAISE_ERRNO(oe_errno);
@@ -512,6 +511,7 @@ ssize_t oe_readv(int fd, const struct oe_iovec* iov, int iovcnt)
     ret = desc->ops.fd.readv(desc, iov, iovcnt);
 
 done:
+    oe_fdtable_put(desc);
     return ret;
 }
 
@@ -519,7 +519,7 @@ ssize_t oe_writev(int fd, const struct oe_iovec* iov, int iovcnt)
 {
     ssize_t ret = -1;
 
-    oe_fd_t* desc;
+    oe_fd_t* desc = NULL;
 
     if (!(desc = oe_fdtable_get(fd, OE_FD_TYPE_ANY)))
         OE_RAISE_ERRNO(oe_errno);
@@ -527,6 +527,7 @@ ssize_t oe_writev(int fd, const struct oe_iovec* iov, int iovcnt)
     ret = desc->ops.fd.writev(desc, iov, iovcnt);
 
 done:
+    oe_fdtable_put(desc);
     return ret;
 }
 
@@ -0,0 +1,10 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _ASYNC_OCALL_H
+#define _ASYNC_OCALL_H
+
+#define ASYNC_OCALL_TAG "async"
+#define ASYNC_OCALL_NUM_THREADS 4
+
+#endif /* _ASYNC_OCALL_H */
@@ -0,0 +1,69 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../async_ocall.h"
+#include "async_ocall_t.h"
+
+int enc_notify(int thread, int count, bool flush)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (host_notify(thread, i, ASYNC_OCALL_TAG) != OE_OK)
+            return -1;
+    }
+
+    if (flush && oe_flush_async_ocalls() != OE_OK)
+        return -1;
+
+    return 0;
+}
+
+int enc_notify_buffer(size_t size)
+{
+    int ret = -1;
+    uint8_t* buf = NULL;
+
+    if (!(buf = malloc(size)))
+        goto done;
+
+    for (size_t i = 0; i < size; i++)
+        buf[i] = (uint8_t)i;
+
+    if (host_notify_buffer(buf, size) != OE_OK)
+        goto done;
+
+    /* The call was copied, so the buffer can be reused right away. */
+    memset(buf, 0, size);
+
+    if (oe_flush_async_ocalls() != OE_OK)
+        goto done;
+
+    ret = 0;
+
+done:
+    free(buf);
+    return ret;
+}
+
+int enc_post_blocking(void)
+{
+    /* Return without waiting for the host function, which blocks. */
+    return host_block() == OE_OK ? 0 : -1;
+}
+
+int enc_flush(void)
+{
+    return oe_flush_async_ocalls() == OE_OK ? 0 : -1;
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,                          /* ProductID */
+    1,                          /* SecurityVersion */
+    true,                       /* AllowDebug */
+    64,                         /* HeapPageCount */
+    64,                         /* StackPageCount */
+    ASYNC_OCALL_NUM_THREADS + 1 /* TCSCount */
+);
@@ -0,0 +1,242 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/atomic.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../../host/hostthread.h"
+#include "../../../host/ocalls.h"
+#include "../async_ocall.h"
+#include "async_ocall_u.h"
+
+#define NUM_NOTIFICATIONS 2000
+#define LARGE_BUFFER_SIZE 4096
+#define BLOCK_TIMEOUT_MSEC 10000
+#define FLUSH_WAIT_MSEC 100
+
+static volatile uint64_t _num_received[ASYNC_OCALL_NUM_THREADS];
+static uint8_t _seen[ASYNC_OCALL_NUM_THREADS][NUM_NOTIFICATIONS];
+static volatile uint64_t _num_buffers;
+static volatile uint64_t _event;
+static volatile uint64_t _num_blocked;
+static volatile uint64_t _num_unblocked;
+static volatile uint64_t _flushed;
+
+void host_notify(int thread, int seq, const char* tag)
+{
+    OE_TEST(thread >= 0 && thread < ASYNC_OCALL_NUM_THREADS);
+    OE_TEST(seq >= 0 && seq < NUM_NOTIFICATIONS);
+    OE_TEST(strcmp(tag, ASYNC_OCALL_TAG) == 0);
+
+    /* Each call is made once, so no other thread writes this byte. */
+    _seen[thread][seq]++;
+    oe_atomic_increment(&_num_received[thread]);
+}
+
+void host_notify_buffer(const void* buf, size_t size)
+{
+    const uint8_t* bytes = (const uint8_t*)buf;
+
+    for (size_t i = 0; i < size; i++)
+        OE_TEST(bytes[i] == (uint8_t)i);
+
+    oe_atomic_increment(&_num_buffers);
+}
+
+void host_block(void)
+{
+    uint64_t msec = 0;
+
+    oe_atomic_increment(&_num_blocked);
+
+    /* If the call were synchronous, the event would never be released. */
+    while (!_event)
+    {
+        OE_TEST(msec++ < BLOCK_TIMEOUT_MSEC);
+        oe_handle_sleep(1);
+    }
+
+    oe_atomic_increment(&_num_unblocked);
+}
+
+static void _reset(void)
+{
+    for (size_t i = 0; i < ASYNC_OCALL_NUM_THREADS; i++)
+        _num_received[i] = 0;
+
+    memset(_seen, 0, sizeof(_seen));
+    _num_buffers = 0;
+}
+
+static void _check_received(int thread, int count)
+{
+    OE_TEST(_num_received[thread] == (uint64_t)count);
+
+    for (int i = 0; i < count; i++)
+        OE_TEST(_seen[thread][i] == 1);
+}
+
+static void _notify(oe_enclave_t* enclave, int thread, int count, bool flush)
+{
+    int ret = -1;
+
+    OE_TEST(enc_notify(enclave, &ret, thread, count, flush) == OE_OK);
+    OE_TEST(ret == 0);
+}
+
+typedef struct _thread_args
+{
+    oe_enclave_t* enclave;
+    int thread;
+} thread_args_t;
+
+static void* _notify_thread(void* arg)
+{
+    thread_args_t* args = (thread_args_t*)arg;
+
+    _notify(args->enclave, args->thread, NUM_NOTIFICATIONS, true);
+
+    /* Every call posted by this thread has been executed. */
+    _check_received(args->thread, NUM_NOTIFICATIONS);
+
+    return NULL;
+}
+
+static void* _flush_thread(void* arg)
+{
+    oe_enclave_t* enclave = (oe_enclave_t*)arg;
+    int ret = -1;
+
+    OE_TEST(enc_flush(enclave, &ret) == OE_OK);
+    OE_TEST(ret == 0);
+
+    /* The flush waited for the blocked call to complete. */
+    OE_TEST(_num_unblocked == 1);
+    _flushed = 1;
+
+    return NULL;
+}
+
+static void _test_blocking(oe_enclave_t* enclave)
+{
+    oe_thread_t thread;
+    int ret = -1;
+
+    _event = 0;
+    _num_blocked = 0;
+    _num_unblocked = 0;
+    _flushed = 0;
+
+    /* The ECALL returns while the host function waits for the event. */
+    OE_TEST(enc_post_blocking(enclave, &ret) == OE_OK);
+    OE_TEST(ret == 0);
+    OE_TEST(_num_unblocked == 0);
+
+    while (!_num_blocked)
+        oe_handle_sleep(1);
+
+    /* oe_flush_async_ocalls() does not return before the event is set. */
+    OE_TEST(oe_thread_create(&thread, _flush_thread, enclave) == 0);
+    oe_handle_sleep(FLUSH_WAIT_MSEC);
+    OE_TEST(!_flushed);
+
+    _event = 1;
+    OE_TEST(oe_thread_join(thread) == 0);
+    OE_TEST(_flushed);
+    OE_TEST(_num_unblocked == 1);
+}
+
+static oe_enclave_t* _create_enclave(const char* path, size_t num_host_workers)
+{
+    oe_enclave_t* enclave = NULL;
+    oe_enclave_setting_context_switchless_t switchless_setting = {
+        num_host_workers, 0};
+    oe_enclave_setting_t settings[] = {
+        {.setting_type = OE_ENCLAVE_SETTING_CONTEXT_SWITCHLESS,
+         .u.context_switchless_setting = &switchless_setting}};
+    oe_result_t result = oe_create_async_ocall_enclave(
+        path,
+        OE_ENCLAVE_TYPE_SGX,
+        oe_get_create_flags(),
+        num_host_workers ? settings : NULL,
+        num_host_workers ? OE_COUNTOF(settings) : 0,
+        &enclave);
+
+    if (result != OE_OK)
+        oe_put_err("oe_create_async_ocall_enclave(): result=%u", result);
+
+    return enclave;
+}
+
+static void _test_async(const char* path)
+{
+    oe_enclave_t* enclave = _create_enclave(path, 2);
+    oe_thread_t threads[ASYNC_OCALL_NUM_THREADS];
+    thread_args_t args[ASYNC_OCALL_NUM_THREADS];
+    int ret = -1;
+
+    /* oe_flush_async_ocalls() waits for the posted calls. */
+    _reset();
+    _notify(enclave, 0, NUM_NOTIFICATIONS, true);
+    _check_received(0, NUM_NOTIFICATIONS);
+
+    /* Several enclave threads post calls at the same time. */
+    _reset();
+    for (int i = 0; i < ASYNC_OCALL_NUM_THREADS; i++)
+    {
+        args[i].enclave = enclave;
+        args[i].thread = i;
+        OE_TEST(oe_thread_create(&threads[i], _notify_thread, &args[i]) == 0);
+    }
+
+    for (int i = 0; i < ASYNC_OCALL_NUM_THREADS; i++)
+        OE_TEST(oe_thread_join(threads[i]) == 0);
+
+    /* Async calls run while the enclave thread goes on. */
+    _test_blocking(enclave);
+
+    /* Calls that do not fit in a slot of the ring are made synchronously. */
+    OE_TEST(enc_notify_buffer(enclave, &ret, 64) == OE_OK);
+    OE_TEST(ret == 0);
+    OE_TEST(enc_notify_buffer(enclave, &ret, LARGE_BUFFER_SIZE) == OE_OK);
+    OE_TEST(ret == 0);
+    OE_TEST(_num_buffers == 2);
+
+    /* The calls still in the ring are made when the enclave is terminated. */
+    _reset();
+    _notify(enclave, 1, NUM_NOTIFICATIONS, false);
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+    _check_received(1, NUM_NOTIFICATIONS);
+}
+
+static void _test_without_workers(const char* path)
+{
+    oe_enclave_t* enclave = _create_enclave(path, 0);
+
+    /* Without host worker threads, the calls are made synchronously. */
+    _reset();
+    _notify(enclave, 0, 100, false);
+    _check_received(0, 100);
+
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+}
+
+int main(int argc, const char* argv[])
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    _test_async(argv[1]);
+    _test_without_workers(argv[1]);
+
+    printf("=== passed all tests (async_ocall)\n");
+
+    return 0;
+}
@@ -10,9 +10,11 @@
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/report.h>
 #include <openenclave/internal/tests.h>
+#include <openenclave/internal/time.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "../../../enclave/evidence_cache.h"
 #include "tls_t.h"
 
 // This is the identity validation callback. A TLS connecting party (client or
@@ -205,6 +207,140 @@ done:
     return result;
 }
 
+// With the evidence cache enabled, generating a certificate for the same keys
+// again returns the cached certificate instead of one with a new quote.
+static oe_result_t _get_cached_cert(
+    const unsigned char* subject_name,
+    uint8_t* private_key,
+    size_t private_key_size,
+    uint8_t* public_key,
+    size_t public_key_size)
+{
+    uint8_t* cert = NULL;
+    size_t cert_size = 0;
+    oe_result_t result = oe_get_cached_attestation_certificate(
+        subject_name,
+        private_key,
+        private_key_size,
+        public_key,
+        public_key_size,
+        &cert,
+        &cert_size);
+
+    oe_free_attestation_certificate(cert);
+    return result;
+}
+
+/* With a freshness of 2 seconds, an entry is due for a refresh after 1
+ * second and expires after 2 seconds. */
+static void _test_evidence_cache_expiry(
+    const unsigned char* subject_name,
+    uint8_t* private_key,
+    size_t private_key_size,
+    uint8_t* public_key,
+    size_t public_key_size)
+{
+    uint8_t* cert = NULL;
+    size_t cert_size = 0;
+
+    OE_TEST(oe_set_evidence_cache_freshness(2) == OE_OK);
+    OE_TEST(
+        oe_generate_attestation_certificate(
+            subject_name,
+            private_key,
+            private_key_size,
+            public_key,
+            public_key_size,
+            &cert,
+            &cert_size) == OE_OK);
+    oe_free_attestation_certificate(cert);
+    cert = NULL;
+
+    /* The refresh replaces the entry before it expires. */
+    oe_sleep_msec(1500);
+    OE_TEST(oe_refresh_evidence_cache() == OE_OK);
+    oe_sleep_msec(500);
+    OE_TEST(
+        _get_cached_cert(
+            subject_name,
+            private_key,
+            private_key_size,
+            public_key,
+            public_key_size) == OE_OK);
+
+    /* Without a refresh, the entry expires and is no longer used. */
+    oe_sleep_msec(2500);
+    OE_TEST(
+        _get_cached_cert(
+            subject_name,
+            private_key,
+            private_key_size,
+            public_key,
+            public_key_size) == OE_NOT_FOUND);
+
+    /* A new certificate is then generated and cached. */
+    OE_TEST(
+        oe_generate_attestation_certificate(
+            subject_name,
+            private_key,
+            private_key_size,
+            public_key,
+            public_key_size,
+            &cert,
+            &cert_size) == OE_OK);
+    oe_free_attestation_certificate(cert);
+    OE_TEST(
+        _get_cached_cert(
+            subject_name,
+            private_key,
+            private_key_size,
+            public_key,
+            public_key_size) == OE_OK);
+}
+
+static void _test_evidence_cache(
+    uint8_t* private_key,
+    size_t private_key_size,
+    uint8_t* public_key,
+    size_t public_key_size)
+{
+    const unsigned char* subject_name =
+        (const unsigned char*)"CN=Open Enclave SDK,O=OESDK TLS,C=US";
+    uint8_t* certs[2] = {NULL, NULL};
+    size_t cert_sizes[2] = {0, 0};
+
+    OE_TEST(oe_set_evidence_cache_freshness(60) == OE_OK);
+
+    for (size_t i = 0; i < 2; i++)
+    {
+        OE_TEST(
+            oe_generate_attestation_certificate(
+                subject_name,
+                private_key,
+                private_key_size,
+                public_key,
+                public_key_size,
+                &certs[i],
+                &cert_sizes[i]) == OE_OK);
+    }
+
+    OE_TEST(cert_sizes[0] == cert_sizes[1]);
+    OE_TEST(memcmp(certs[0], certs[1], cert_sizes[0]) == 0);
+    OE_TEST(oe_refresh_evidence_cache() == OE_OK);
+
+    for (size_t i = 0; i < 2; i++)
+        oe_free_attestation_certificate(certs[i]);
+
+    _test_evidence_cache_expiry(
+        subject_name,
+        private_key,
+        private_key_size,
+        public_key,
+        public_key_size);
+
+    OE_TEST(oe_set_evidence_cache_freshness(0) == OE_OK);
+}
+
 oe_result_t get_tls_cert_signed_with_key(
     int key_type,
     unsigned char** cert,
@@ -258,6 +394,9 @@ oe_result_t get_tls_cert_signed_with_key(
         goto done;
     }
 
+    _test_evidence_cache(
+        private_key, private_key_size, public_key, public_key_size);
+
     OE_TRACE_INFO("output_cert_size = 0x%x", output_cert_size);
     // validate cert inside the enclave
     result = oe_verify_attestation_certificate(
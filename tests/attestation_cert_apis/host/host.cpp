@@ -9,6 +9,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "../../../common/sgx/collateral.h"
 #include "tls_u.h"
 
 #if defined(_WIN32)
@@ -61,6 +62,54 @@ done:
     return result;
 }
 
+static int _verifier_calls;
+
+static oe_result_t _counting_verifier(oe_identity_t* identity, void* arg)
+{
+    _verifier_calls++;
+    return enclave_identity_verifier(identity, arg);
+}
+
+static oe_result_t _rejecting_verifier(oe_identity_t* identity, void* arg)
+{
+    (void)identity;
+    (void)arg;
+    return OE_VERIFY_FAILED;
+}
+
+// With the cache enabled, a certificate that was accepted is accepted again
+// without verifying its evidence, but the identity callback still decides.
+static void _test_cached_verification(unsigned char* cert, size_t cert_size)
+{
+    const oe_sgx_collateral_kind_t kind = OE_SGX_COLLATERAL_ATTESTATION_CERT;
+    uint64_t hits = 0;
+
+    OE_TEST(oe_set_attestation_certificate_cache_ttl(60) == OE_OK);
+    hits = oe_sgx_collateral_cache_hits(kind);
+
+    /* The first verification fills the cache, the second one hits it. */
+    _verifier_calls = 0;
+    for (uint64_t i = 0; i < 2; i++)
+    {
+        OE_TEST(
+            oe_verify_attestation_certificate(
+                cert, cert_size, _counting_verifier, NULL) == OE_OK);
+        OE_TEST(oe_sgx_collateral_cache_hits(kind) == hits + i);
+    }
+    OE_TEST(_verifier_calls == 2);
+
+    OE_TEST(
+        oe_verify_attestation_certificate(
+            cert, cert_size, _rejecting_verifier, NULL) == OE_VERIFY_FAILED);
+    OE_TEST(oe_sgx_collateral_cache_hits(kind) == hits + 2);
+    OE_TEST(
+        oe_verify_attestation_certificate(cert, cert_size, NULL, NULL) ==
+        OE_OK);
+    OE_TEST(oe_sgx_collateral_cache_hits(kind) == hits + 3);
+
+    OE_TEST(oe_set_attestation_certificate_cache_ttl(0) == OE_OK);
+}
+
 void run_test(oe_enclave_t* enclave, int test_type)
 {
     oe_result_t result = OE_FAILURE;
@@ -117,6 +166,8 @@ void run_test(oe_enclave_t* enclave, int test_type)
     fflush(stdout);
     OE_TEST(result == OE_OK);
 
+    _test_cached_verification(cert, cert_size);
+
     OE_TRACE_INFO("free cert 0xx%p\n", cert);
     free(cert);
 }
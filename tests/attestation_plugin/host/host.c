@@ -31,6 +31,58 @@ void host_verify(
         test_claims,
         NUM_TEST_CLAIMS,
         false);
+
+    printf("====== running host_verify batch.\n");
+    {
+        oe_evidence_batch_item_t items[8];
+        oe_claim_t* claims = NULL;
+        size_t claims_length = 0;
+
+        OE_TEST(
+            oe_verify_evidence(
+                evidence,
+                evidence_size,
+                endorsements,
+                endorsements_size,
+                NULL,
+                0,
+                &claims,
+                &claims_length) == OE_OK);
+
+        // Half of the items fetch their own endorsements.
+        for (size_t i = 0; i < OE_COUNTOF(items); i++)
+        {
+            items[i].evidence_buffer = evidence;
+            items[i].evidence_buffer_size = evidence_size;
+            items[i].endorsements_buffer = i % 2 ? endorsements : NULL;
+            items[i].endorsements_buffer_size = i % 2 ? endorsements_size : 0;
+        }
+
+        OE_TEST(
+            oe_verify_evidence_batch(items, OE_COUNTOF(items), NULL, 0, 4) ==
+            OE_OK);
+
+        for (size_t i = 0; i < OE_COUNTOF(items); i++)
+        {
+            OE_TEST(items[i].result == OE_OK);
+            OE_TEST(items[i].claims_length == claims_length);
+            OE_TEST(
+                oe_free_claims_list(items[i].claims, items[i].claims_length) ==
+                OE_OK);
+        }
+
+        OE_TEST(oe_free_claims_list(claims, claims_length) == OE_OK);
+
+        // Items that fail verification do not stop the others.
+        items[0].evidence_buffer_size = 0;
+        OE_TEST(oe_verify_evidence_batch(items, 2, NULL, 0, 0) == OE_OK);
+        OE_TEST(items[0].result == OE_INVALID_PARAMETER);
+        OE_TEST(items[0].claims == NULL);
+        OE_TEST(items[1].result == OE_OK);
+        OE_TEST(
+            oe_free_claims_list(items[1].claims, items[1].claims_length) ==
+            OE_OK);
+    }
 }
 
 int main(int argc, const char* argv[])
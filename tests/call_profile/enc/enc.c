@@ -0,0 +1,39 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <string.h>
+#include "call_profile_t.h"
+
+int enc_echo(const void* in, void* out, size_t size)
+{
+    memcpy(out, in, size);
+    return 0;
+}
+
+int enc_call_host(int count, bool switchless)
+{
+    char in[32] = "call profile";
+    char out[32];
+
+    for (int i = 0; i < count; i++)
+    {
+        int ret = -1;
+        oe_result_t result =
+            switchless ? host_echo_switchless(&ret, in, out, sizeof(in))
+                       : host_echo(&ret, in, out, sizeof(in));
+
+        if (result != OE_OK || ret != 0 || memcmp(in, out, sizeof(in)) != 0)
+            return -1;
+    }
+
+    return 0;
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* AllowDebug */
+    64,   /* HeapPageCount */
+    64,   /* StackPageCount */
+    2);   /* TCSCount */
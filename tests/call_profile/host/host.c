@@ -0,0 +1,223 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../../host/ocalls.h"
+#include "call_profile_u.h"
+
+#define NUM_ECHOS 10
+#define NUM_OCALLS 20
+#define ECHO_SIZE 64
+#define DUMP_PATH "call_profile_dump.txt"
+
+int host_echo(const void* in, void* out, size_t size)
+{
+    memcpy(out, in, size);
+    return 0;
+}
+
+int host_echo_switchless(const void* in, void* out, size_t size)
+{
+    memcpy(out, in, size);
+    return 0;
+}
+
+static const oe_call_profile_entry_t* _find(
+    const oe_call_profile_entry_t* entries,
+    size_t num_entries,
+    const char* name)
+{
+    for (size_t i = 0; i < num_entries; i++)
+    {
+        if (entries[i].name && strcmp(entries[i].name, name) == 0)
+            return &entries[i];
+    }
+
+    return NULL;
+}
+
+static void _check_entry(const oe_call_profile_entry_t* entry)
+{
+    uint64_t histogram_count = 0;
+
+    for (size_t i = 0; i < OE_CALL_PROFILE_HISTOGRAM_BUCKETS; i++)
+        histogram_count += entry->histogram[i];
+
+    OE_TEST(histogram_count == entry->count);
+    OE_TEST(entry->min_ns <= entry->max_ns);
+    OE_TEST(entry->total_ns >= entry->max_ns);
+    OE_TEST(oe_call_profile_percentile(entry, 50) <= entry->max_ns);
+    OE_TEST(
+        oe_call_profile_percentile(entry, 50) <=
+        oe_call_profile_percentile(entry, 99));
+    OE_TEST(oe_call_profile_percentile(entry, 100) == entry->max_ns);
+}
+
+static void _echo(oe_enclave_t* enclave, size_t count)
+{
+    uint8_t in[ECHO_SIZE];
+    uint8_t out[ECHO_SIZE];
+
+    memset(in, 0xab, sizeof(in));
+
+    for (size_t i = 0; i < count; i++)
+    {
+        int ret = -1;
+
+        OE_TEST(enc_echo(enclave, &ret, in, out, sizeof(in)) == OE_OK);
+        OE_TEST(ret == 0);
+        OE_TEST(memcmp(in, out, sizeof(in)) == 0);
+    }
+}
+
+static void _test_profile(oe_enclave_t* enclave)
+{
+    oe_call_profile_entry_t* entries = NULL;
+    size_t num_entries = 0;
+    const oe_call_profile_entry_t* entry = NULL;
+    size_t num_enclave_entries = 0;
+    int ret = -1;
+
+    /* Nothing is recorded before profiling is started. */
+    _echo(enclave, 1);
+    OE_TEST(oe_get_call_profile(enclave, &entries, &num_entries) == OE_OK);
+    OE_TEST(entries == NULL && num_entries == 0);
+
+    OE_TEST(oe_start_call_profiling(enclave, 0, NULL) == OE_OK);
+
+    _echo(enclave, NUM_ECHOS);
+    OE_TEST(enc_call_host(enclave, &ret, NUM_OCALLS, false) == OE_OK);
+    OE_TEST(ret == 0);
+    OE_TEST(enc_call_host(enclave, &ret, NUM_OCALLS, true) == OE_OK);
+    OE_TEST(ret == 0);
+
+    OE_TEST(oe_get_call_profile(enclave, &entries, &num_entries) == OE_OK);
+
+    /* The SDK's own EDL functions may also have been called. */
+    for (size_t i = 0; i < num_entries; i++)
+    {
+        _check_entry(&entries[i]);
+
+        if (entries[i].table_id == OE_UINT64_MAX)
+            num_enclave_entries++;
+
+        if (i > 0)
+            OE_TEST(entries[i - 1].total_ns >= entries[i].total_ns);
+    }
+
+    OE_TEST(num_enclave_entries == 4);
+
+    entry = _find(entries, num_entries, "enc_echo");
+    OE_TEST(entry && !entry->is_ocall);
+    OE_TEST(entry->table_id == OE_UINT64_MAX);
+    OE_TEST(entry->count == NUM_ECHOS);
+    OE_TEST(entry->bytes_in >= NUM_ECHOS * ECHO_SIZE);
+    OE_TEST(entry->bytes_out >= NUM_ECHOS * ECHO_SIZE);
+    OE_TEST(entry->switchless_hits == 0 && entry->switchless_misses == 0);
+
+    /* The ecall includes the latency of the ocalls it makes. */
+    entry = _find(entries, num_entries, "enc_call_host");
+    OE_TEST(entry && !entry->is_ocall);
+    OE_TEST(entry->count == 2);
+    OE_TEST(
+        entry->total_ns >=
+        _find(entries, num_entries, "host_echo")->total_ns);
+
+    entry = _find(entries, num_entries, "host_echo");
+    OE_TEST(entry && entry->is_ocall);
+    OE_TEST(entry->count == NUM_OCALLS);
+    OE_TEST(entry->bytes_out >= NUM_OCALLS * 32);
+    OE_TEST(entry->switchless_hits == 0 && entry->switchless_misses == 0);
+
+    entry = _find(entries, num_entries, "host_echo_switchless");
+    OE_TEST(entry && entry->is_ocall);
+    OE_TEST(entry->count == NUM_OCALLS);
+    OE_TEST(
+        entry->switchless_hits + entry->switchless_misses == NUM_OCALLS);
+
+    oe_free_call_profile(entries);
+    OE_TEST(oe_dump_call_profile(enclave, stdout) == OE_OK);
+
+    /* Calls made while profiling is stopped are not recorded. */
+    OE_TEST(oe_stop_call_profiling(enclave) == OE_OK);
+    _echo(enclave, 1);
+
+    OE_TEST(oe_get_call_profile(enclave, &entries, &num_entries) == OE_OK);
+    entry = _find(entries, num_entries, "enc_echo");
+    OE_TEST(entry && entry->count == NUM_ECHOS);
+    oe_free_call_profile(entries);
+}
+
+static void _test_dump(const char* path, uint32_t flags)
+{
+    oe_enclave_t* enclave = NULL;
+    FILE* stream = NULL;
+    char line[512];
+    bool found = false;
+
+    remove(DUMP_PATH);
+
+    OE_TEST(
+        oe_create_call_profile_enclave(
+            path, OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclave) == OE_OK);
+    OE_TEST(oe_start_call_profiling(enclave, 10, DUMP_PATH) == OE_OK);
+
+    _echo(enclave, NUM_ECHOS);
+    oe_handle_sleep(50);
+
+    /* The last dump is written when the enclave is terminated. */
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+
+    OE_TEST((stream = fopen(DUMP_PATH, "r")) != NULL);
+    while (fgets(line, sizeof(line), stream))
+    {
+        if (strstr(line, "enc_echo"))
+            found = true;
+    }
+    fclose(stream);
+    remove(DUMP_PATH);
+
+    OE_TEST(found);
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_result_t result;
+    oe_enclave_t* enclave = NULL;
+    const uint32_t flags = oe_get_create_flags();
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    oe_enclave_setting_context_switchless_t switchless_setting = {1, 0};
+    oe_enclave_setting_t settings[] = {
+        {.setting_type = OE_ENCLAVE_SETTING_CONTEXT_SWITCHLESS,
+         .u.context_switchless_setting = &switchless_setting}};
+
+    if ((result = oe_create_call_profile_enclave(
+             argv[1],
+             OE_ENCLAVE_TYPE_SGX,
+             flags,
+             settings,
+             OE_COUNTOF(settings),
+             &enclave)) != OE_OK)
+        oe_put_err("oe_create_enclave(): result=%u", result);
+
+    _test_profile(enclave);
+
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+
+    _test_dump(argv[1], flags);
+
+    printf("=== passed all tests (call_profile)\n");
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/globals.h>
+#include <openenclave/internal/raise.h>
+#include <stdint.h>
+#include <string.h>
+#include "channel_t.h"
+
+#define SLICE_SIZE 4096
+
+static oe_channel_t* _channel;
+
+oe_result_t enc_open_channel(oe_channel_descriptor_t descriptor)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_channel_t* channel = NULL;
+
+    OE_CHECK(oe_channel_open(&descriptor, &channel));
+    _channel = channel;
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+void enc_get_enclave_range(uint64_t* base, uint64_t* size)
+{
+    *base = (uint64_t)__oe_get_enclave_base();
+    *size = __oe_get_enclave_size();
+}
+
+/* Reply to each message with its data plus one, written to the second half
+ * of the data area. The data is read one slice at a time. */
+oe_result_t enc_echo(size_t count)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_channel_message_t message;
+    oe_channel_message_t reply;
+    uint8_t slice[SLICE_SIZE];
+    uint8_t* data = NULL;
+    size_t data_size = 0;
+
+    if (!(data = oe_channel_get_data(_channel, &data_size)))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        OE_CHECK(oe_channel_receive(_channel, &message));
+
+        reply.offset = message.offset + data_size / 2;
+        reply.size = message.size;
+        reply.tag = message.tag;
+
+        if (message.offset >= data_size / 2 ||
+            reply.offset + reply.size > data_size)
+            OE_RAISE(OE_OUT_OF_BOUNDS);
+
+        for (uint64_t pos = 0; pos < message.size; pos += SLICE_SIZE)
+        {
+            size_t size = (size_t)(message.size - pos);
+
+            if (size > SLICE_SIZE)
+                size = SLICE_SIZE;
+
+            OE_CHECK(oe_channel_snapshot(
+                _channel, &message, (size_t)pos, slice, size));
+
+            for (size_t j = 0; j < size; j++)
+                slice[j]++;
+
+            memcpy(data + reply.offset + pos, slice, size);
+        }
+
+        OE_CHECK(oe_channel_send(_channel, &reply));
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t enc_receive(void)
+{
+    oe_channel_message_t message;
+
+    return oe_channel_receive(_channel, &message);
+}
+
+oe_result_t enc_close_channel(void)
+{
+    oe_result_t result = oe_channel_close(_channel);
+
+    _channel = NULL;
+    return result;
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* AllowDebug */
+    64,   /* HeapPageCount */
+    64,   /* StackPageCount */
+    1);   /* TCSCount */
@@ -0,0 +1,216 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/channel.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../../host/memalign.h"
+#include "channel_u.h"
+
+#define NUM_SLOTS 8
+#define REGION_SIZE (8 * 1024 * 1024)
+
+/* The sizes of the messages of a round, which fill the ring. */
+static const size_t _sizes[NUM_SLOTS] =
+    {1, 100, 4096, 4097, 65536, 100000, 1024 * 1024, 3 * 1024 * 1024 / 2};
+
+static void _test_create_errors(uint8_t* region)
+{
+    oe_channel_t* channel = NULL;
+
+    OE_TEST(
+        oe_channel_create(NULL, REGION_SIZE, NUM_SLOTS, &channel) ==
+        OE_INVALID_PARAMETER);
+    OE_TEST(
+        oe_channel_create(region + 8, REGION_SIZE - 8, NUM_SLOTS, &channel) ==
+        OE_BAD_ALIGNMENT);
+    OE_TEST(
+        oe_channel_create(region, REGION_SIZE, 3, &channel) ==
+        OE_INVALID_PARAMETER);
+    OE_TEST(
+        oe_channel_create(region, REGION_SIZE, 0, &channel) ==
+        OE_INVALID_PARAMETER);
+    OE_TEST(
+        oe_channel_create(region, 64, NUM_SLOTS, &channel) ==
+        OE_BUFFER_TOO_SMALL);
+    OE_TEST(channel == NULL);
+}
+
+static void _test_open_error(
+    oe_enclave_t* enclave,
+    oe_channel_descriptor_t descriptor,
+    uint64_t region,
+    uint64_t region_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    descriptor.region = (void*)region;
+    descriptor.region_size = region_size;
+
+    OE_TEST(enc_open_channel(enclave, &result, descriptor) == OE_OK);
+    OE_TEST(result == OE_INVALID_PARAMETER);
+}
+
+/* The enclave only opens a region that lies entirely in host memory. */
+static void _test_open_errors(
+    oe_enclave_t* enclave,
+    const oe_channel_descriptor_t* descriptor)
+{
+    const uint64_t region = (uint64_t)descriptor->region;
+    uint64_t base = 0;
+    uint64_t size = 0;
+
+    OE_TEST(enc_get_enclave_range(enclave, &base, &size) == OE_OK);
+    OE_TEST(size > OE_PAGE_SIZE);
+
+    /* Inside the enclave. */
+    _test_open_error(enclave, *descriptor, base, OE_PAGE_SIZE);
+
+    /* Across the start and the end of the enclave. */
+    _test_open_error(enclave, *descriptor, base - OE_PAGE_SIZE, REGION_SIZE);
+    _test_open_error(
+        enclave, *descriptor, base + size - OE_PAGE_SIZE, REGION_SIZE);
+
+    /* region + region_size wraps around. */
+    _test_open_error(enclave, *descriptor, region, UINT64_MAX - region + 2);
+}
+
+static void _test_echo(oe_enclave_t* enclave, oe_channel_t* channel)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_channel_message_t message;
+    uint8_t* data = NULL;
+    size_t data_size = 0;
+    uint64_t offset = 0;
+
+    OE_TEST((data = oe_channel_get_data(channel, &data_size)) != NULL);
+
+    /* Write the data of each message to the first half of the data area. */
+    for (size_t i = 0; i < NUM_SLOTS; i++)
+    {
+        message.offset = offset;
+        message.size = _sizes[i];
+        message.tag = i;
+
+        for (size_t j = 0; j < _sizes[i]; j++)
+            data[offset + j] = (uint8_t)(i + j);
+
+        OE_TEST(oe_channel_send(channel, &message) == OE_OK);
+        offset += _sizes[i];
+    }
+
+    OE_TEST(offset <= data_size / 2);
+
+    /* The ring is full. */
+    message.offset = 0;
+    message.size = 1;
+    OE_TEST(oe_channel_send(channel, &message) == OE_BUSY);
+
+    OE_TEST(enc_echo(enclave, &result, NUM_SLOTS) == OE_OK);
+    OE_TEST(result == OE_OK);
+
+    /* Each reply refers to the data of its message plus one. */
+    offset = 0;
+    for (size_t i = 0; i < NUM_SLOTS; i++)
+    {
+        OE_TEST(oe_channel_receive(channel, &message) == OE_OK);
+        OE_TEST(message.tag == i);
+        OE_TEST(message.size == _sizes[i]);
+        OE_TEST(message.offset == offset + data_size / 2);
+
+        for (size_t j = 0; j < _sizes[i]; j++)
+            OE_TEST(data[message.offset + j] == (uint8_t)(i + j + 1));
+
+        offset += _sizes[i];
+    }
+
+    OE_TEST(oe_channel_receive(channel, &message) == OE_NOT_FOUND);
+}
+
+static void _test_out_of_bounds(oe_enclave_t* enclave, oe_channel_t* channel)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_channel_message_t message;
+    oe_channel_ring_t* ring = channel->send_ring;
+    size_t data_size = 0;
+
+    OE_TEST(oe_channel_get_data(channel, &data_size) != NULL);
+
+    message.offset = data_size;
+    message.size = 1;
+    message.tag = 0;
+    OE_TEST(oe_channel_send(channel, &message) == OE_OUT_OF_BOUNDS);
+
+    message.offset = 1;
+    message.size = UINT64_MAX;
+    OE_TEST(oe_channel_send(channel, &message) == OE_OUT_OF_BOUNDS);
+
+    /* A message written to the ring directly is checked by the enclave. */
+    message.offset = data_size - 1;
+    message.size = 2;
+    ring->messages[channel->send_tail & (NUM_SLOTS - 1)] = message;
+    ring->tail = ++channel->send_tail;
+
+    OE_TEST(enc_receive(enclave, &result) == OE_OK);
+    OE_TEST(result == OE_OUT_OF_BOUNDS);
+
+    OE_TEST(enc_receive(enclave, &result) == OE_OK);
+    OE_TEST(result == OE_NOT_FOUND);
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_result_t result;
+    oe_enclave_t* enclave = NULL;
+    oe_channel_t* channel = NULL;
+    oe_channel_descriptor_t descriptor;
+    uint8_t* region = NULL;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    result = oe_create_channel_enclave(
+        argv[1], OE_ENCLAVE_TYPE_SGX, oe_get_create_flags(), NULL, 0, &enclave);
+    if (result != OE_OK)
+        oe_put_err("oe_create_channel_enclave(): result=%u", result);
+
+    OE_TEST((region = oe_memalign(OE_CHANNEL_ALIGNMENT, REGION_SIZE)) != NULL);
+
+    _test_create_errors(region);
+
+    OE_TEST(
+        oe_channel_create(region, REGION_SIZE, NUM_SLOTS, &channel) == OE_OK);
+    OE_TEST(oe_channel_get_descriptor(channel, &descriptor) == OE_OK);
+
+    _test_open_errors(enclave, &descriptor);
+
+    OE_TEST(enc_open_channel(enclave, &result, descriptor) == OE_OK);
+    OE_TEST(result == OE_OK);
+
+    /* The region belongs to the channel that is already open. */
+    OE_TEST(enc_open_channel(enclave, &result, descriptor) == OE_OK);
+    OE_TEST(result == OE_ALREADY_EXISTS);
+
+    _test_echo(enclave, channel);
+    _test_echo(enclave, channel);
+    _test_out_of_bounds(enclave, channel);
+
+    OE_TEST(enc_close_channel(enclave, &result) == OE_OK);
+    OE_TEST(result == OE_OK);
+
+    OE_TEST(oe_channel_destroy(channel) == OE_OK);
+    oe_memalign_free(region);
+
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+
+    printf("=== passed all tests (channel)\n");
+
+    return 0;
+}
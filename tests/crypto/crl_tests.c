@@ -22,6 +22,8 @@
  * _CHAIN2 loads intermediate.cert.pem & root.cert.pem
  * _CRL1 loads intermediate.crl.der, which revokes leaf.cert.pem
  * _CRL2 loads root.crl.der, which also revokes leaf.cert.pem
+ * _LARGE_CRL loads root_large.crl.der, which revokes leaf.cert.pem and 10000
+ * other serial numbers
  */
 
 size_t crl_size1, crl_size2;
@@ -31,6 +33,8 @@ static char _CHAIN1[max_cert_chain_size];
 static char _CHAIN2[max_cert_chain_size];
 static uint8_t _CRL1[max_cert_size];
 static uint8_t _CRL2[max_cert_size];
+static uint8_t* _LARGE_CRL;
+static size_t _large_crl_size;
 oe_datetime_t _time;
 
 static void _test_verify(
@@ -242,6 +246,26 @@ static void _test_verify_with_two_crls(
     printf("=== passed %s()\n", __FUNCTION__);
 }
 
+static void _test_verify_with_large_crl(void)
+{
+    printf("=== begin %s()\n", __FUNCTION__);
+
+    /* The leaf certificate is one of many revoked by the root CA */
+    _test_verify_with_crl(_CERT2, _CHAIN2, _LARGE_CRL, _large_crl_size, true);
+
+    /* The intermediate certificate is not */
+    _test_verify_with_two_crls(
+        _CERT1,
+        _CHAIN2,
+        _LARGE_CRL,
+        _large_crl_size,
+        _CRL1,
+        crl_size1,
+        false);
+
+    printf("=== passed %s()\n", __FUNCTION__);
+}
+
 void TestCRL(void)
 {
     OE_TEST(read_cert("../data/intermediate.cert.pem", _CERT1) == OE_OK);
@@ -275,6 +299,66 @@ void TestCRL(void)
     _test_verify_with_two_crls(
         _CERT2, _CHAIN2, _CRL1, crl_size1, _CRL2, crl_size2, true);
 
+    OE_TEST(
+        read_large_crl(
+            "../data/root_large.crl.der", &_LARGE_CRL, &_large_crl_size) ==
+        OE_OK);
+    _test_verify_with_large_crl();
+    free(_LARGE_CRL);
+    _LARGE_CRL = NULL;
+
     OE_TEST(read_dates("../data/time.txt", &_time) == OE_OK);
     _test_get_dates();
 }
+
+/*
+ * Read the large or the small root CRL reads times, then verify the
+ * intermediate certificate, which neither revokes, against the root CRL and
+ * the intermediate CRL verifications times.
+ */
+void BenchmarkCRL(bool large_crl, size_t reads, size_t verifications)
+{
+    uint8_t* crl_der = NULL;
+    size_t crl_der_size = 0;
+    oe_crl_t root_crl;
+    oe_crl_t intermediate_crl;
+    const oe_crl_t* crls[] = {&root_crl, &intermediate_crl};
+    oe_cert_t cert;
+    oe_cert_chain_t chain;
+
+    OE_TEST(read_cert("../data/intermediate.cert.pem", _CERT1) == OE_OK);
+    OE_TEST(
+        read_chain(
+            "../data/intermediate.cert.pem",
+            "../data/root.cert.pem",
+            _CHAIN2,
+            OE_COUNTOF(_CHAIN2)) == OE_OK);
+    OE_TEST(
+        read_crl("../data/intermediate.crl.der", _CRL1, &crl_size1) == OE_OK);
+    OE_TEST(
+        read_large_crl(
+            large_crl ? "../data/root_large.crl.der" : "../data/root.crl.der",
+            &crl_der,
+            &crl_der_size) == OE_OK);
+
+    for (size_t i = 0; i < reads; i++)
+    {
+        OE_TEST(oe_crl_read_der(&root_crl, crl_der, crl_der_size) == OE_OK);
+        OE_TEST(oe_crl_free(&root_crl) == OE_OK);
+    }
+
+    OE_TEST(oe_crl_read_der(&root_crl, crl_der, crl_der_size) == OE_OK);
+    OE_TEST(oe_crl_read_der(&intermediate_crl, _CRL1, crl_size1) == OE_OK);
+    OE_TEST(oe_cert_read_pem(&cert, _CERT1, strlen(_CERT1) + 1) == OE_OK);
+    OE_TEST(
+        oe_cert_chain_read_pem(&chain, _CHAIN2, strlen(_CHAIN2) + 1) == OE_OK);
+
+    for (size_t i = 0; i < verifications; i++)
+        OE_TEST(oe_cert_verify(&cert, &chain, crls, 2) == OE_OK);
+
+    oe_cert_free(&cert);
+    oe_cert_chain_free(&chain);
+    OE_TEST(oe_crl_free(&intermediate_crl) == OE_OK);
+    OE_TEST(oe_crl_free(&root_crl) == OE_OK);
+    free(crl_der);
+}
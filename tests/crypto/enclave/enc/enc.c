@@ -190,6 +190,76 @@ void test()
     TestAll();
 }
 
+// Hash count messages of message_size bytes, where byte k of message j is
+// (j + k) mod 256, and return the hash of the last message.
+oe_result_t sha256_benchmark(
+    size_t message_size,
+    size_t count,
+    size_t iterations,
+    bool multi,
+    unsigned char* hash,
+    size_t hash_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint8_t* data = NULL;
+    const void** buffers = NULL;
+    size_t* sizes = NULL;
+    OE_SHA256* hashes = NULL;
+
+    if (count == 0 || hash_size != sizeof(OE_SHA256))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    data = (uint8_t*)malloc(message_size + count);
+    buffers = (const void**)malloc(count * sizeof(void*));
+    sizes = (size_t*)malloc(count * sizeof(size_t));
+    hashes = (OE_SHA256*)malloc(count * sizeof(OE_SHA256));
+    if (!data || !buffers || !sizes || !hashes)
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    for (size_t i = 0; i < message_size + count; i++)
+        data[i] = (uint8_t)i;
+
+    for (size_t j = 0; j < count; j++)
+    {
+        buffers[j] = data + j % 256;
+        sizes[j] = message_size;
+    }
+
+    for (size_t i = 0; i < iterations; i++)
+    {
+        if (multi)
+        {
+            OE_CHECK(oe_sha256_multi(buffers, sizes, count, hashes));
+            continue;
+        }
+
+        for (size_t j = 0; j < count; j++)
+        {
+            oe_sha256_context_t ctx;
+
+            OE_CHECK(oe_sha256_init(&ctx));
+            OE_CHECK(oe_sha256_update(&ctx, buffers[j], sizes[j]));
+            OE_CHECK(oe_sha256_final(&ctx, &hashes[j]));
+        }
+    }
+
+    memcpy(hash, &hashes[count - 1], sizeof(OE_SHA256));
+    result = OE_OK;
+
+done:
+    free(hashes);
+    free(sizes);
+    free(buffers);
+    free(data);
+    return result;
+}
+
+void crl_benchmark(bool large_crl, size_t reads, size_t verifications)
+{
+    oe_register_syscall_hook(_syscall_hook);
+    BenchmarkCRL(large_crl, reads, verifications);
+}
+
 OE_SET_ENCLAVE_SGX(
     1,    /* ProductID */
     1,    /* SecurityVersion */
@@ -5,6 +5,7 @@
 #include <fcntl.h>
 #include <limits.h>
 #include <openenclave/host.h>
+#include <openenclave/internal/crypto/sha.h>
 #include <openenclave/internal/error.h>
 #include <openenclave/internal/tests.h>
 #include <stdio.h>
@@ -12,6 +13,7 @@
 #include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <time.h>
 
 #if defined(__linux__)
 #include <unistd.h>
@@ -71,14 +73,132 @@ int f_close(int fd)
 #endif
 }
 
+/* Return a monotonic time in microseconds. */
+static uint64_t _now(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER counter;
+    LARGE_INTEGER frequency;
+
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (uint64_t)(counter.QuadPart * 1000000 / frequency.QuadPart);
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+#endif
+}
+
+/* Compute the hash that sha256_benchmark() returns for the last message. */
+static void _expected_hash(size_t message_size, size_t count, OE_SHA256* hash)
+{
+    uint8_t* message = (uint8_t*)malloc(message_size + 1);
+    size_t first = (count - 1) % 256;
+    oe_sha256_context_t context;
+
+    OE_TEST(message != NULL);
+
+    for (size_t k = 0; k < message_size; k++)
+        message[k] = (uint8_t)(first + k);
+
+    OE_TEST(oe_sha256_init(&context) == OE_OK);
+    OE_TEST(oe_sha256_update(&context, message, message_size) == OE_OK);
+    OE_TEST(oe_sha256_final(&context, hash) == OE_OK);
+    free(message);
+}
+
+/*
+ * Measure the SHA-256 throughput inside the enclave for small, medium and
+ * large messages, hashing one message at a time and with oe_sha256_multi().
+ */
+static void _benchmark_sha256(oe_enclave_t* enclave)
+{
+    static const size_t sizes[] = {64, 1024, 16384};
+    const size_t total = 1024 * 1024;
+    const size_t iterations = 16;
+
+    for (size_t i = 0; i < OE_COUNTOF(sizes); i++)
+    {
+        const size_t count = total / sizes[i];
+        OE_SHA256 expected;
+
+        _expected_hash(sizes[i], count, &expected);
+
+        for (int multi = 0; multi < 2; multi++)
+        {
+            OE_SHA256 hash;
+            oe_result_t return_value = OE_UNEXPECTED;
+            uint64_t start = _now();
+            uint64_t elapsed;
+
+            OE_TEST(
+                sha256_benchmark(
+                    enclave,
+                    &return_value,
+                    sizes[i],
+                    count,
+                    iterations,
+                    multi != 0,
+                    hash.buf,
+                    sizeof(hash)) == OE_OK);
+            OE_TEST(return_value == OE_OK);
+            OE_TEST(memcmp(&hash, &expected, sizeof(hash)) == 0);
+
+            elapsed = _now() - start;
+            printf(
+                "sha256 %6zu byte messages (%s): %8.1f MB/s\n",
+                sizes[i],
+                multi ? "multi " : "single",
+                (double)(total * iterations) / (double)(elapsed ? elapsed : 1));
+        }
+    }
+}
+
+/* Measure reading the small and the large root CRL in the enclave, and
+ * verifying a certificate against each. */
+static void _benchmark_crl(oe_enclave_t* enclave)
+{
+    const size_t reads = 20;
+    const size_t verifications = 1000;
+
+    for (int large = 0; large < 2; large++)
+    {
+        uint64_t start = _now();
+        uint64_t read;
+
+        OE_TEST(crl_benchmark(enclave, large != 0, reads, 0) == OE_OK);
+        read = _now() - start;
+
+        start = _now();
+        OE_TEST(
+            crl_benchmark(enclave, large != 0, 0, verifications) == OE_OK);
+
+        printf(
+            "%s CRL: read %8.1f us, verify %8.1f us\n",
+            large ? "large" : "small",
+            (double)read / (double)(reads + 1),
+            (double)(_now() - start) / (double)verifications);
+    }
+}
+
 int main(int argc, const char* argv[])
 {
     oe_result_t result;
     oe_enclave_t* enclave = NULL;
 
-    if (argc != 2)
+    const bool benchmark_sha256 =
+        argc == 3 && strcmp(argv[2], "--benchmark-sha256") == 0;
+    const bool benchmark_crl =
+        argc == 3 && strcmp(argv[2], "--benchmark-crl") == 0;
+
+    if (argc != 2 && !benchmark_sha256 && !benchmark_crl)
     {
-        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        fprintf(
+            stderr,
+            "Usage: %s ENCLAVE_PATH [--benchmark-sha256|--benchmark-crl]\n",
+            argv[0]);
         return 1;
     }
 
@@ -90,7 +210,15 @@ int main(int argc, const char* argv[])
         oe_put_err("oe_create_crypto_enclave(): result=%u", result);
     }
 
-    if ((result = test(enclave)) != OE_OK)
+    if (benchmark_sha256)
+    {
+        _benchmark_sha256(enclave);
+    }
+    else if (benchmark_crl)
+    {
+        _benchmark_crl(enclave);
+    }
+    else if ((result = test(enclave)) != OE_OK)
     {
         oe_put_err("test() failed: result=%u", result);
     }
@@ -0,0 +1,187 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/crypto/gcm.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <string.h>
+#include "tests.h"
+#include "utils.h"
+
+// Test cases 4, 6 and 16 from "The Galois/Counter Mode of Operation (GCM)"
+// by McGrew and Viega.
+#define GCM_KEY_128 "feffe9928665731c6d6a8f9467308308"
+#define GCM_KEY_256 GCM_KEY_128 GCM_KEY_128
+#define GCM_IV_96 "cafebabefacedbaddecaf888"
+#define GCM_IV_480                                                 \
+    "9313225df88406e555909c5aff5269aa6a7a9538534f7da1e4c303d2a318" \
+    "a728c3c0c95156809539fcf0e2429a6b525416aedbf5a0de6a57a637b39b"
+#define GCM_AAD "feedfacedeadbeeffeedfacedeadbeefabaddad2"
+#define GCM_PLAINTEXT                                              \
+    "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a31" \
+    "8a721c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39"
+
+typedef struct _gcm_test_data
+{
+    const char* key;
+    const char* iv;
+    const char* ciphertext;
+    const char* tag;
+} gcm_test_data_t;
+
+static gcm_test_data_t GCM_TESTS[] = {
+    {GCM_KEY_128,
+     GCM_IV_96,
+     "42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329ac"
+     "a12e21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091",
+     "5bc94fbc3221a5db94fae95ae7121a47"},
+    {GCM_KEY_128,
+     GCM_IV_480,
+     "8ce24998625615b603a033aca13fb894be9112a5c3a211a8ba262a3cca7e"
+     "2ca701e4a9a4fba43c90ccdcb281d48c7c6fd62875d2aca417034c34aee5",
+     "619cc5aefffe0bfa462af43c1699d050"},
+    {GCM_KEY_256,
+     GCM_IV_96,
+     "522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c97598a2bd2555"
+     "d1aa8cb08e48590dbb3da7b08b1056828838c5f61e6393ba7a0abcc9f662",
+     "76fc6ece0f4e1768cddf8853bb2d551b"},
+};
+
+// The tag of a 1000 byte message (0x00, 0x01, ...) encrypted with test case
+// 16, which goes through the eight-block path.
+#define GCM_LONG_SIZE 1000
+#define GCM_LONG_TAG "417e318018db1bead3b0342951d370fc"
+
+static void _test_known_answers(void)
+{
+    uint8_t plaintext[60];
+    uint8_t aad[20];
+    uint8_t key[32];
+    uint8_t iv[60];
+    uint8_t expected[60];
+    uint8_t expected_tag[OE_GCM_TAG_SIZE];
+    uint8_t output[60];
+    uint8_t tag[OE_GCM_TAG_SIZE];
+
+    hex_to_buf(GCM_PLAINTEXT, plaintext, sizeof(plaintext));
+    hex_to_buf(GCM_AAD, aad, sizeof(aad));
+
+    for (size_t i = 0; i < sizeof(GCM_TESTS) / sizeof(GCM_TESTS[0]); i++)
+    {
+        oe_aes_gcm_context_t context;
+        size_t key_size = strlen(GCM_TESTS[i].key) / 2;
+        size_t iv_size = strlen(GCM_TESTS[i].iv) / 2;
+
+        hex_to_buf(GCM_TESTS[i].key, key, sizeof(key));
+        hex_to_buf(GCM_TESTS[i].iv, iv, sizeof(iv));
+        hex_to_buf(GCM_TESTS[i].ciphertext, expected, sizeof(expected));
+        hex_to_buf(GCM_TESTS[i].tag, expected_tag, sizeof(expected_tag));
+
+        OE_TEST(oe_aes_gcm_init(&context, key, key_size) == OE_OK);
+        OE_TEST(
+            oe_aes_gcm_encrypt(
+                &context,
+                iv,
+                iv_size,
+                aad,
+                sizeof(aad),
+                plaintext,
+                sizeof(plaintext),
+                output,
+                tag) == OE_OK);
+        OE_TEST(memcmp(output, expected, sizeof(expected)) == 0);
+        OE_TEST(memcmp(tag, expected_tag, sizeof(tag)) == 0);
+
+        // Decrypt in place.
+        OE_TEST(
+            oe_aes_gcm_decrypt(
+                &context,
+                iv,
+                iv_size,
+                aad,
+                sizeof(aad),
+                output,
+                sizeof(output),
+                output,
+                tag) == OE_OK);
+        OE_TEST(memcmp(output, plaintext, sizeof(plaintext)) == 0);
+
+        oe_aes_gcm_free(&context);
+    }
+}
+
+static void _test_long_message(void)
+{
+    oe_aes_gcm_context_t context;
+    uint8_t key[32];
+    uint8_t iv[OE_GCM_IV_SIZE];
+    uint8_t aad[20];
+    uint8_t plaintext[GCM_LONG_SIZE];
+    uint8_t ciphertext[GCM_LONG_SIZE];
+    uint8_t output[GCM_LONG_SIZE];
+    uint8_t expected_tag[OE_GCM_TAG_SIZE];
+    uint8_t tag[OE_GCM_TAG_SIZE];
+
+    hex_to_buf(GCM_KEY_256, key, sizeof(key));
+    hex_to_buf(GCM_IV_96, iv, sizeof(iv));
+    hex_to_buf(GCM_AAD, aad, sizeof(aad));
+    hex_to_buf(GCM_LONG_TAG, expected_tag, sizeof(expected_tag));
+
+    for (size_t i = 0; i < sizeof(plaintext); i++)
+        plaintext[i] = (uint8_t)i;
+
+    OE_TEST(oe_aes_gcm_init(&context, key, sizeof(key)) == OE_OK);
+    OE_TEST(
+        oe_aes_gcm_encrypt(
+            &context,
+            iv,
+            sizeof(iv),
+            aad,
+            sizeof(aad),
+            plaintext,
+            sizeof(plaintext),
+            ciphertext,
+            tag) == OE_OK);
+    OE_TEST(memcmp(tag, expected_tag, sizeof(tag)) == 0);
+
+    OE_TEST(
+        oe_aes_gcm_decrypt(
+            &context,
+            iv,
+            sizeof(iv),
+            aad,
+            sizeof(aad),
+            ciphertext,
+            sizeof(ciphertext),
+            output,
+            tag) == OE_OK);
+    OE_TEST(memcmp(output, plaintext, sizeof(plaintext)) == 0);
+
+    // A modified ciphertext is rejected and nothing is returned.
+    ciphertext[sizeof(ciphertext) - 1] ^= 1;
+    OE_TEST(
+        oe_aes_gcm_decrypt(
+            &context,
+            iv,
+            sizeof(iv),
+            aad,
+            sizeof(aad),
+            ciphertext,
+            sizeof(ciphertext),
+            output,
+            tag) == OE_CRYPTO_ERROR);
+
+    oe_aes_gcm_free(&context);
+}
+
+// Test AES-GCM against known answers.
+void TestGCM(void)
+{
+    printf("=== begin %s()\n", __FUNCTION__);
+
+    _test_known_answers();
+    _test_long_message();
+
+    printf("=== passed %s()\n", __FUNCTION__);
+}
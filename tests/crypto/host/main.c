@@ -3,15 +3,70 @@
 
 #include <openenclave/internal/raise.h>
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
 #include "../tests.h"
 
+#if defined(_WIN32)
+#include <Windows.h>
+#endif
+
 const char* arg0;
 
+/* Return a monotonic time in microseconds. */
+static uint64_t _now(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER counter;
+    LARGE_INTEGER frequency;
+
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (uint64_t)(counter.QuadPart * 1000000 / frequency.QuadPart);
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+#endif
+}
+
+/* Measure reading the small and the large root CRL, and verifying a
+ * certificate against each. */
+static void _benchmark_crl(void)
+{
+    const size_t reads = 20;
+    const size_t verifications = 1000;
+
+    for (int large = 0; large < 2; large++)
+    {
+        uint64_t start = _now();
+        uint64_t read;
+
+        BenchmarkCRL(large != 0, reads, 0);
+        read = _now() - start;
+
+        start = _now();
+        BenchmarkCRL(large != 0, 0, verifications);
+
+        printf(
+            "%s CRL: read %8.1f us, verify %8.1f us\n",
+            large ? "large" : "small",
+            (double)read / (double)(reads + 1),
+            (double)(_now() - start) / (double)verifications);
+    }
+}
+
 int main(int argc, const char* argv[])
 {
-    OE_UNUSED(argc);
     arg0 = argv[0];
 
+    if (argc == 2 && strcmp(argv[1], "--benchmark-crl") == 0)
+    {
+        _benchmark_crl();
+        return 0;
+    }
+
     /* Run the tests */
     TestAll();
 
@@ -105,6 +105,42 @@ oe_result_t read_crl(char* filename, uint8_t* crl, size_t* crl_size)
     return OE_OK;
 }
 
+oe_result_t read_large_crl(char* filename, uint8_t** crl, size_t* crl_size)
+{
+    size_t len_crl = 0;
+    size_t capacity = 0;
+    size_t len_read = 0;
+    uint8_t* buffer = NULL;
+    FILE* cfp = fopen(filename, "rb");
+
+    if (cfp == NULL)
+        return OE_FAILURE;
+
+    do
+    {
+        if (len_crl == capacity)
+        {
+            uint8_t* grown;
+
+            capacity += 64 * 1024;
+            if (!(grown = (uint8_t*)realloc(buffer, capacity)))
+            {
+                free(buffer);
+                fclose(cfp);
+                return OE_OUT_OF_MEMORY;
+            }
+            buffer = grown;
+        }
+        len_read = fread(buffer + len_crl, 1, capacity - len_crl, cfp);
+        len_crl += len_read;
+    } while (len_read > 0);
+
+    fclose(cfp);
+    *crl = buffer;
+    *crl_size = len_crl;
+    return OE_OK;
+}
+
 oe_result_t read_dates(char* filename, oe_datetime_t* time)
 {
     size_t len_date = 0;
@@ -39,6 +39,9 @@ oe_result_t read_chains(
 
 oe_result_t read_crl(char* filename, uint8_t* crl, size_t* crl_size);
 
+/* Read a CRL of any size into a buffer that the caller must free. */
+oe_result_t read_large_crl(char* filename, uint8_t** crl, size_t* crl_size);
+
 oe_result_t read_dates(char* filename, oe_datetime_t* time);
 
 oe_result_t read_mod(char* filename, uint8_t* mod, size_t* mod_size);
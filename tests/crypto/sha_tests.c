@@ -5,13 +5,130 @@
 #include <openenclave/enclave.h>
 #endif
 
+#include <openenclave/internal/crypto/hmac.h>
 #include <openenclave/internal/crypto/sha.h>
 #include <openenclave/internal/tests.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "hash.h"
 #include "tests.h"
 
+/* Known answers from FIPS 180-2 and RFC 4231 (test case 2). */
+static const char* _abc_hash =
+    "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad";
+static const char* _empty_hash =
+    "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855";
+static const char* _two_block_message =
+    "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+static const char* _two_block_hash =
+    "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1";
+static const char* _million_a_hash =
+    "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0";
+static const char* _hmac_hash =
+    "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843";
+
+static bool _hash_equals(const OE_SHA256* hash, const char* hex)
+{
+    char str[2 * OE_SHA256_SIZE + 1];
+
+    for (size_t i = 0; i < OE_SHA256_SIZE; i++)
+        sprintf(str + 2 * i, "%02x", hash->buf[i]);
+
+    return strcmp(str, hex) == 0;
+}
+
+static void _sha256(const void* data, size_t size, OE_SHA256* hash)
+{
+    oe_sha256_context_t ctx = {0};
+
+    OE_TEST(oe_sha256_init(&ctx) == OE_OK);
+    if (size)
+        OE_TEST(oe_sha256_update(&ctx, data, size) == OE_OK);
+    OE_TEST(oe_sha256_final(&ctx, hash) == OE_OK);
+}
+
+// Test the known answers, which exercise the padding into one or two blocks
+// and hashing in many updates.
+static void _test_sha256_known_answers(void)
+{
+    OE_SHA256 hash = {0};
+    oe_sha256_context_t ctx = {0};
+    oe_hmac_sha256_context_t hmac_ctx = {0};
+    const char* hmac_data = "what do ya want for nothing?";
+    char block[1000];
+
+    _sha256("abc", 3, &hash);
+    OE_TEST(_hash_equals(&hash, _abc_hash));
+
+    _sha256(NULL, 0, &hash);
+    OE_TEST(_hash_equals(&hash, _empty_hash));
+
+    _sha256(_two_block_message, strlen(_two_block_message), &hash);
+    OE_TEST(_hash_equals(&hash, _two_block_hash));
+
+    memset(block, 'a', sizeof(block));
+    OE_TEST(oe_sha256_init(&ctx) == OE_OK);
+    for (size_t i = 0; i < 1000; i++)
+        OE_TEST(oe_sha256_update(&ctx, block, sizeof(block)) == OE_OK);
+    OE_TEST(oe_sha256_final(&ctx, &hash) == OE_OK);
+    OE_TEST(_hash_equals(&hash, _million_a_hash));
+
+    OE_TEST(
+        oe_hmac_sha256_init(&hmac_ctx, (const uint8_t*)"Jefe", 4) == OE_OK);
+    OE_TEST(
+        oe_hmac_sha256_update(&hmac_ctx, hmac_data, strlen(hmac_data)) ==
+        OE_OK);
+    OE_TEST(oe_hmac_sha256_final(&hmac_ctx, &hash) == OE_OK);
+    oe_hmac_sha256_free(&hmac_ctx);
+    OE_TEST(_hash_equals(&hash, _hmac_hash));
+}
+
+// Test that oe_sha256_multi() matches hashing each buffer, with sizes around
+// the block boundaries so that the lanes finish at different times.
+static void _test_sha256_multi(void)
+{
+    enum
+    {
+        COUNT = 200
+    };
+    uint8_t* data = (uint8_t*)malloc(COUNT + 2 * 64);
+    const void* buffers[COUNT];
+    size_t sizes[COUNT];
+    OE_SHA256* hashes = (OE_SHA256*)malloc(COUNT * sizeof(OE_SHA256));
+    OE_SHA256 hash;
+
+    OE_TEST(data && hashes);
+
+    for (size_t i = 0; i < COUNT + 2 * 64; i++)
+        data[i] = (uint8_t)(i * 7);
+
+    for (size_t i = 0; i < COUNT; i++)
+    {
+        buffers[i] = i % 5 == 0 ? data + (i % 3) : data + i;
+        sizes[i] = (i * 13) % 130;
+    }
+
+    OE_TEST(oe_sha256_multi(buffers, sizes, COUNT, hashes) == OE_OK);
+
+    for (size_t i = 0; i < COUNT; i++)
+    {
+        _sha256(buffers[i], sizes[i], &hash);
+        OE_TEST(memcmp(&hash, &hashes[i], sizeof(OE_SHA256)) == 0);
+    }
+
+    // Fewer buffers than lanes.
+    OE_TEST(oe_sha256_multi(buffers, sizes, 3, hashes) == OE_OK);
+    _sha256(buffers[2], sizes[2], &hash);
+    OE_TEST(memcmp(&hash, &hashes[2], sizeof(OE_SHA256)) == 0);
+
+    OE_TEST(oe_sha256_multi(NULL, NULL, 0, NULL) == OE_OK);
+    OE_TEST(oe_sha256_multi(NULL, sizes, 1, hashes) == OE_INVALID_PARAMETER);
+
+    free(hashes);
+    free(data);
+}
+
 // Test computation of SHA-256 hash over an ASCII alphabet string.
 void TestSHA(void)
 {
@@ -24,5 +141,8 @@ void TestSHA(void)
     oe_sha256_final(&ctx, &hash);
     OE_TEST(memcmp(&hash, &ALPHABET_HASH, sizeof(OE_SHA256)) == 0);
 
+    _test_sha256_known_answers();
+    _test_sha256_multi();
+
     printf("=== passed %s()\n", __FUNCTION__);
 }
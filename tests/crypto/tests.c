@@ -10,6 +10,10 @@ void TestAll()
 #endif
     TestCRL();
     TestEC();
+#if defined(OE_BUILD_ENCLAVE)
+    // AES-GCM is only available in the enclave.
+    TestGCM();
+#endif
     TestRSA();
     TestRandom();
 #if defined(__x86_64__) || defined(__i386__)
@@ -4,9 +4,13 @@
 #ifndef _TESTS_CRYPTO_TESTS_H
 #define _TESTS_CRYPTO_TESTS_H
 
+#include <stdbool.h>
+#include <stddef.h>
+
 void TestASN1(void);
 void TestCRL(void);
 void TestEC(void);
+void TestGCM(void);
 void TestKDF(void);
 void TestRandom(void);
 void TestCpuEntropy(void);
@@ -15,4 +19,6 @@ void TestSHA(void);
 void TestHMAC(void);
 void TestAll();
 
+void BenchmarkCRL(bool large_crl, size_t reads, size_t verifications);
+
 #endif /* _TESTS_CRYPTO_TESTS_H */
@@ -0,0 +1,79 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <string.h>
+#include "ecall_batch_t.h"
+
+static int _num_calls;
+
+int enc_add(int a, int b)
+{
+    _num_calls++;
+    return a + b;
+}
+
+int enc_echo(const void* in, void* out, size_t size)
+{
+    _num_calls++;
+    memcpy(out, in, size);
+    return (int)size;
+}
+
+void enc_upper(char* str)
+{
+    _num_calls++;
+
+    for (; *str; str++)
+    {
+        if (*str >= 'a' && *str <= 'z')
+            *str = (char)(*str - 'a' + 'A');
+    }
+}
+
+int enc_pointers(const int* in_value, int* out_value, int* in_out_value)
+{
+    int sum = 0;
+
+    _num_calls++;
+
+    if (in_value)
+        sum += *in_value;
+
+    if (in_out_value)
+    {
+        sum += *in_out_value;
+        *in_out_value = sum;
+    }
+
+    if (out_value)
+        *out_value = -sum;
+
+    return sum;
+}
+
+void enc_reverse(int in_values[4], int out_values[4])
+{
+    _num_calls++;
+
+    for (size_t i = 0; i < 4; i++)
+        out_values[i] = in_values[3 - i];
+}
+
+void enc_tick(void)
+{
+    _num_calls++;
+}
+
+int enc_count_calls(void)
+{
+    return _num_calls;
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* AllowDebug */
+    64,   /* HeapPageCount */
+    64,   /* StackPageCount */
+    1);   /* TCSCount */
@@ -0,0 +1,286 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ecall_batch_u.h"
+
+#define NUM_CALLS 32
+#define MAX_ECHO_SIZE 256
+
+static int _num_calls;
+
+static void _test_add_batch(oe_enclave_t* enclave)
+{
+    enc_add_args_t calls[NUM_CALLS];
+
+    memset(calls, 0, sizeof(calls));
+
+    for (int i = 0; i < NUM_CALLS; i++)
+    {
+        calls[i].a = i;
+        calls[i].b = 2 * i;
+        calls[i]._retval = -1;
+    }
+
+    OE_TEST(enc_add_batch(enclave, calls, NUM_CALLS) == OE_OK);
+
+    for (int i = 0; i < NUM_CALLS; i++)
+    {
+        OE_TEST(calls[i]._result == OE_OK);
+        OE_TEST(calls[i]._retval == 3 * i);
+    }
+
+    _num_calls += NUM_CALLS;
+
+    /* An empty batch does not enter the enclave. */
+    OE_TEST(enc_add_batch(enclave, NULL, 0) == OE_OK);
+    OE_TEST(enc_add_batch(enclave, NULL, 1) == OE_INVALID_PARAMETER);
+}
+
+static void _test_echo_batch(oe_enclave_t* enclave)
+{
+    enc_echo_args_t calls[NUM_CALLS];
+    uint8_t in[NUM_CALLS][MAX_ECHO_SIZE];
+    uint8_t out[NUM_CALLS][MAX_ECHO_SIZE];
+
+    memset(calls, 0, sizeof(calls));
+    memset(out, 0, sizeof(out));
+
+    /* Each call has a different size, so that the calls of the batch have
+     * buffers of different sizes. */
+    for (size_t i = 0; i < NUM_CALLS; i++)
+    {
+        memset(in[i], (int)i + 1, sizeof(in[i]));
+        calls[i].in = in[i];
+        calls[i].out = out[i];
+        calls[i].size = (i * 7) % MAX_ECHO_SIZE + 1;
+    }
+
+    OE_TEST(enc_echo_batch(enclave, calls, NUM_CALLS) == OE_OK);
+
+    for (size_t i = 0; i < NUM_CALLS; i++)
+    {
+        OE_TEST(calls[i]._result == OE_OK);
+        OE_TEST(calls[i]._retval == (int)calls[i].size);
+        OE_TEST(memcmp(in[i], out[i], calls[i].size) == 0);
+
+        /* Nothing is written past the size of the call. */
+        if (calls[i].size < MAX_ECHO_SIZE)
+            OE_TEST(out[i][calls[i].size] == 0);
+    }
+
+    _num_calls += NUM_CALLS;
+}
+
+static void _test_upper_batch(oe_enclave_t* enclave)
+{
+    static const char* const words[] = {"", "a", "batch", "Of ECalls", "z!"};
+    static const char* const upper[] = {"", "A", "BATCH", "OF ECALLS", "Z!"};
+    const size_t count = OE_COUNTOF(words);
+    enc_upper_args_t calls[OE_COUNTOF(words)];
+    char strings[OE_COUNTOF(words)][16];
+
+    memset(calls, 0, sizeof(calls));
+
+    for (size_t i = 0; i < count; i++)
+    {
+        strcpy(strings[i], words[i]);
+        calls[i].str = strings[i];
+    }
+
+    OE_TEST(enc_upper_batch(enclave, calls, count) == OE_OK);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        OE_TEST(calls[i]._result == OE_OK);
+        OE_TEST(strcmp(strings[i], upper[i]) == 0);
+    }
+
+    _num_calls += (int)count;
+}
+
+static void _test_pointers_batch(oe_enclave_t* enclave)
+{
+    enc_pointers_args_t calls[NUM_CALLS];
+    int in[NUM_CALLS];
+    int out[NUM_CALLS];
+    int in_out[NUM_CALLS];
+
+    memset(calls, 0, sizeof(calls));
+
+    /* Some calls leave one of their pointers NULL, which must not affect
+     * the marshalling of the other calls of the batch. */
+    for (int i = 0; i < NUM_CALLS; i++)
+    {
+        in[i] = i;
+        out[i] = 0;
+        in_out[i] = 100 * i;
+
+        calls[i].in_value = (i % 4 == 1) ? NULL : &in[i];
+        calls[i].out_value = (i % 4 == 2) ? NULL : &out[i];
+        calls[i].in_out_value = (i % 4 == 3) ? NULL : &in_out[i];
+        calls[i]._retval = -1;
+    }
+
+    OE_TEST(enc_pointers_batch(enclave, calls, NUM_CALLS) == OE_OK);
+
+    for (int i = 0; i < NUM_CALLS; i++)
+    {
+        const int sum = ((i % 4 == 1) ? 0 : i) + ((i % 4 == 3) ? 0 : 100 * i);
+
+        OE_TEST(calls[i]._result == OE_OK);
+        OE_TEST(calls[i]._retval == sum);
+        OE_TEST(in[i] == i);
+        OE_TEST(out[i] == ((i % 4 == 2) ? 0 : -sum));
+        OE_TEST(in_out[i] == ((i % 4 == 3) ? 100 * i : sum));
+    }
+
+    _num_calls += NUM_CALLS;
+}
+
+static void _test_reverse_batch(oe_enclave_t* enclave)
+{
+    enc_reverse_args_t calls[NUM_CALLS];
+    int in[NUM_CALLS][4];
+    int out[NUM_CALLS][4];
+
+    memset(calls, 0, sizeof(calls));
+    memset(out, 0, sizeof(out));
+
+    for (int i = 0; i < NUM_CALLS; i++)
+    {
+        for (int j = 0; j < 4; j++)
+            in[i][j] = 4 * i + j;
+
+        calls[i].in_values = in[i];
+        calls[i].out_values = out[i];
+    }
+
+    OE_TEST(enc_reverse_batch(enclave, calls, NUM_CALLS) == OE_OK);
+
+    for (int i = 0; i < NUM_CALLS; i++)
+    {
+        OE_TEST(calls[i]._result == OE_OK);
+
+        for (int j = 0; j < 4; j++)
+            OE_TEST(out[i][j] == in[i][3 - j]);
+    }
+
+    _num_calls += NUM_CALLS;
+}
+
+static void _test_tick_batch(oe_enclave_t* enclave)
+{
+    enc_tick_args_t calls[NUM_CALLS];
+
+    /* A function with neither parameters nor return value only reports
+     * the result of each call. */
+    for (int i = 0; i < NUM_CALLS; i++)
+        calls[i]._result = OE_UNEXPECTED;
+
+    OE_TEST(enc_tick_batch(enclave, calls, NUM_CALLS) == OE_OK);
+
+    for (int i = 0; i < NUM_CALLS; i++)
+        OE_TEST(calls[i]._result == OE_OK);
+
+    _num_calls += NUM_CALLS;
+}
+
+/* Marshal a call to enc_add() by hand, as the generated code does. */
+static void _marshal_add(oe_enclave_function_call_t* call, int a, int b)
+{
+    size_t size = 0;
+    enc_add_args_t* args = NULL;
+
+    OE_TEST(oe_add_size(&size, sizeof(enc_add_args_t)) == OE_OK);
+    OE_TEST((args = calloc(2, size)) != NULL);
+
+    args->a = a;
+    args->b = b;
+
+    call->function_id = ecall_batch_fcn_id_enc_add;
+    call->input_buffer = args;
+    call->input_buffer_size = size;
+    call->output_buffer = (uint8_t*)args + size;
+    call->output_buffer_size = size;
+}
+
+static void _test_failed_call(oe_enclave_t* enclave)
+{
+    oe_enclave_function_call_t calls[4];
+    const enc_add_args_t* out = NULL;
+
+    memset(calls, 0, sizeof(calls));
+
+    _marshal_add(&calls[0], 1, 2);
+    _marshal_add(&calls[2], 3, 4);
+    _marshal_add(&calls[3], 5, 6);
+
+    /* A call without buffers and a call to a function that does not exist
+     * fail, but do not stop the calls after them. */
+    calls[1].function_id = ecall_batch_fcn_id_enc_add;
+    calls[3].function_id = 1000;
+
+    OE_TEST(oe_call_enclave_function_batch(enclave, calls, 4) == OE_OK);
+
+    OE_TEST(calls[0].result == OE_OK);
+    OE_TEST(calls[0].output_bytes_written == calls[0].output_buffer_size);
+    out = calls[0].output_buffer;
+    OE_TEST(out->_result == OE_OK && out->_retval == 3);
+
+    OE_TEST(calls[1].result == OE_INVALID_PARAMETER);
+
+    OE_TEST(calls[2].result == OE_OK);
+    out = calls[2].output_buffer;
+    OE_TEST(out->_result == OE_OK && out->_retval == 7);
+
+    OE_TEST(calls[3].result == OE_NOT_FOUND);
+
+    _num_calls += 2;
+
+    free((void*)calls[0].input_buffer);
+    free((void*)calls[2].input_buffer);
+    free((void*)calls[3].input_buffer);
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_result_t result;
+    oe_enclave_t* enclave = NULL;
+    const uint32_t flags = oe_get_create_flags();
+    int num_calls = 0;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    result = oe_create_ecall_batch_enclave(
+        argv[1], OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclave);
+    if (result != OE_OK)
+        oe_put_err("oe_create_ecall_batch_enclave(): result=%u", result);
+
+    _test_add_batch(enclave);
+    _test_echo_batch(enclave);
+    _test_upper_batch(enclave);
+    _test_pointers_batch(enclave);
+    _test_reverse_batch(enclave);
+    _test_tick_batch(enclave);
+    _test_failed_call(enclave);
+
+    /* Every call that succeeded was made exactly once. */
+    OE_TEST(enc_count_calls(enclave, &num_calls) == OE_OK);
+    OE_TEST(num_calls == _num_calls);
+
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+
+    printf("=== passed all tests (ecall_batch)\n");
+
+    return 0;
+}
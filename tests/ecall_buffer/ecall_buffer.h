@@ -0,0 +1,9 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _ECALL_BUFFER_H
+#define _ECALL_BUFFER_H
+
+#define ECALL_BUFFER_NUM_THREADS 4
+
+#endif /* _ECALL_BUFFER_H */
@@ -0,0 +1,46 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <stdint.h>
+#include <string.h>
+#include "../ecall_buffer.h"
+#include "ecall_buffer_t.h"
+
+int enc_fill(const void* in, void* out, size_t size)
+{
+    const uint8_t* in_bytes = (const uint8_t*)in;
+    uint8_t* out_bytes = (uint8_t*)out;
+
+    /* The output buffer is cleared, even when its memory was used by a
+     * previous call of this thread. */
+    for (size_t i = 0; i < size; i++)
+    {
+        if (out_bytes[i] != 0)
+            return -1;
+    }
+
+    for (size_t i = 0; i < size; i++)
+        out_bytes[i] = (uint8_t)(in_bytes[i] + 1);
+
+    return 0;
+}
+
+int enc_call_host(size_t size)
+{
+    int ret = -1;
+
+    if (host_call_enclave(&ret, size) != OE_OK)
+        return -1;
+
+    return ret;
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,                           /* ProductID */
+    1,                           /* SecurityVersion */
+    true,                        /* AllowDebug */
+    1024,                        /* HeapPageCount */
+    64,                          /* StackPageCount */
+    ECALL_BUFFER_NUM_THREADS + 1 /* TCSCount */
+);
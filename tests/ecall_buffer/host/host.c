@@ -0,0 +1,131 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/calls.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../../host/hostthread.h"
+#include "../ecall_buffer.h"
+#include "ecall_buffer_u.h"
+
+#define NUM_ITERATIONS 100
+
+/* Sizes below and above the size of the kept buffers, in an order that makes
+ * the buffers grow, be bypassed, and be reused. */
+static const size_t _sizes[] = {
+    1,
+    64,
+    1000,
+    64,
+    4096,
+    OE_MAX_CACHED_ECALL_BUFFER_SIZE / 2,
+    OE_MAX_CACHED_ECALL_BUFFER_SIZE * 2,
+    16,
+    OE_MAX_CACHED_ECALL_BUFFER_SIZE / 4,
+    OE_MAX_CACHED_ECALL_BUFFER_SIZE * 4,
+    8,
+};
+
+static oe_enclave_t* _other_enclave;
+
+static void _fill(oe_enclave_t* enclave, size_t size, uint8_t seed)
+{
+    uint8_t* in = NULL;
+    uint8_t* out = NULL;
+    int ret = -1;
+
+    OE_TEST((in = malloc(size)) != NULL);
+    OE_TEST((out = malloc(size)) != NULL);
+
+    for (size_t i = 0; i < size; i++)
+        in[i] = (uint8_t)(i + seed);
+
+    memset(out, 0xcc, size);
+
+    OE_TEST(enc_fill(enclave, &ret, in, out, size) == OE_OK);
+    OE_TEST(ret == 0);
+
+    for (size_t i = 0; i < size; i++)
+        OE_TEST(out[i] == (uint8_t)(in[i] + 1));
+
+    free(in);
+    free(out);
+}
+
+static void _test_sizes(oe_enclave_t* enclave, uint8_t seed)
+{
+    for (size_t i = 0; i < OE_COUNTOF(_sizes); i++)
+        _fill(enclave, _sizes[i], (uint8_t)(seed + i));
+}
+
+int host_call_enclave(size_t size)
+{
+    /* The buffer of the ECALL that made this OCALL is still in use. */
+    _fill(_other_enclave, size, 3);
+    return 0;
+}
+
+static void* _thread(void* arg)
+{
+    oe_enclave_t* enclave = (oe_enclave_t*)arg;
+
+    for (int i = 0; i < NUM_ITERATIONS; i++)
+        _test_sizes(enclave, (uint8_t)i);
+
+    return NULL;
+}
+
+static oe_enclave_t* _create_enclave(const char* path)
+{
+    oe_enclave_t* enclave = NULL;
+    oe_result_t result = oe_create_ecall_buffer_enclave(
+        path, OE_ENCLAVE_TYPE_SGX, oe_get_create_flags(), NULL, 0, &enclave);
+
+    if (result != OE_OK)
+        oe_put_err("oe_create_ecall_buffer_enclave(): result=%u", result);
+
+    return enclave;
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_enclave_t* enclave = NULL;
+    oe_thread_t threads[ECALL_BUFFER_NUM_THREADS];
+    int ret = -1;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    enclave = _create_enclave(argv[1]);
+    _other_enclave = _create_enclave(argv[1]);
+
+    /* The buffers of a thread are reused by its calls of any size. */
+    _test_sizes(enclave, 0);
+    _test_sizes(enclave, 1);
+
+    /* Each thread uses its own buffers. */
+    for (int i = 0; i < ECALL_BUFFER_NUM_THREADS; i++)
+        OE_TEST(oe_thread_create(&threads[i], _thread, enclave) == 0);
+
+    for (int i = 0; i < ECALL_BUFFER_NUM_THREADS; i++)
+        OE_TEST(oe_thread_join(threads[i]) == 0);
+
+    /* An ECALL made while the buffer of the thread is in use. */
+    OE_TEST(enc_call_host(enclave, &ret, 64) == OE_OK);
+    OE_TEST(ret == 0);
+
+    /* The enclaves report no leak of the buffers kept by their threads. */
+    OE_TEST(oe_terminate_enclave(_other_enclave) == OE_OK);
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+
+    printf("=== passed all tests (ecall_buffer)\n");
+
+    return 0;
+}
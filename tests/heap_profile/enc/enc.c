@@ -0,0 +1,79 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/tests.h>
+#include <stdlib.h>
+#include <string.h>
+#include "heap_profile_t.h"
+
+#define MAX_BLOCKS 1024
+
+static void* _blocks[MAX_BLOCKS];
+static size_t _num_blocks;
+
+oe_result_t enc_start(size_t sample_interval)
+{
+    return oe_start_heap_profiling(sample_interval);
+}
+
+oe_result_t enc_stop(void)
+{
+    return oe_stop_heap_profiling();
+}
+
+void enc_allocate(size_t block_size, size_t num_blocks)
+{
+    OE_TEST(_num_blocks + num_blocks <= MAX_BLOCKS);
+
+    for (size_t i = 0; i < num_blocks; i++)
+    {
+        OE_TEST((_blocks[_num_blocks] = malloc(block_size)) != NULL);
+        _num_blocks++;
+    }
+}
+
+void enc_free(void)
+{
+    for (size_t i = 0; i < _num_blocks; i++)
+        free(_blocks[i]);
+
+    _num_blocks = 0;
+}
+
+/* A reallocation that fails leaves the block, and its sample, in place. */
+void enc_realloc_too_large(void)
+{
+    OE_TEST(_num_blocks > 0);
+    OE_TEST(realloc(_blocks[0], SIZE_MAX / 2) == NULL);
+}
+
+/* Get the number of bytes in the header of the heap profile. */
+oe_result_t enc_get_bytes(uint64_t* bytes)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    char* profile = NULL;
+    size_t profile_size = 0;
+    const char* header;
+
+    if ((result = oe_get_heap_profile(&profile, &profile_size)) != OE_OK)
+        return result;
+
+    OE_TEST(strlen(profile) == profile_size);
+    OE_TEST((header = strstr(profile, "heap profile: ")) != NULL);
+    OE_TEST((header = strchr(header, ':')) != NULL);
+    OE_TEST((header = strchr(header + 1, ':')) != NULL);
+
+    *bytes = strtoull(header + 1, NULL, 10);
+
+    free(profile);
+    return OE_OK;
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* AllowDebug */
+    1024, /* HeapPageCount */
+    64,   /* StackPageCount */
+    1);   /* TCSCount */
@@ -0,0 +1,118 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <inttypes.h>
+#include <openenclave/host.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "heap_profile_u.h"
+
+#define SAMPLE_INTERVAL 4096
+#define BLOCK_SIZE 1024
+#define NUM_BLOCKS 256
+#define SMALL_SAMPLE_INTERVAL 64
+#define MANY_BLOCKS 1024
+#define PROFILE_PATH "heap_profile.prof"
+
+static uint64_t _get_bytes(oe_enclave_t* enclave)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint64_t bytes = 0;
+
+    OE_TEST(enc_get_bytes(enclave, &result, &bytes) == OE_OK);
+    OE_TEST(result == OE_OK);
+
+    return bytes;
+}
+
+static void _test_dump(oe_enclave_t* enclave)
+{
+    FILE* stream;
+    char line[256];
+    bool found = false;
+
+    OE_TEST(oe_dump_heap_profile(NULL, PROFILE_PATH) == OE_INVALID_PARAMETER);
+    OE_TEST(oe_dump_heap_profile(enclave, NULL) == OE_INVALID_PARAMETER);
+    OE_TEST(oe_dump_heap_profile(enclave, PROFILE_PATH) == OE_OK);
+
+    OE_TEST((stream = fopen(PROFILE_PATH, "r")) != NULL);
+
+    while (fgets(line, sizeof(line), stream))
+    {
+        if (strncmp(line, "heap profile: ", 14) == 0)
+            found = true;
+    }
+
+    fclose(stream);
+    remove(PROFILE_PATH);
+
+    OE_TEST(found);
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_result_t result;
+    oe_enclave_t* enclave = NULL;
+    const uint32_t flags = oe_get_create_flags();
+    uint64_t bytes;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    result = oe_create_heap_profile_enclave(
+        argv[1], OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclave);
+
+    if (result != OE_OK)
+        oe_put_err("oe_create_heap_profile_enclave(): result=%u", result);
+
+    OE_TEST(enc_start(enclave, &result, SAMPLE_INTERVAL) == OE_OK);
+    OE_TEST(result == OE_OK);
+
+    /* The estimate of the live bytes is close to what was allocated. */
+    OE_TEST(enc_allocate(enclave, BLOCK_SIZE, NUM_BLOCKS) == OE_OK);
+    bytes = _get_bytes(enclave);
+    printf("estimated %" PRIu64 " bytes\n", bytes);
+    OE_TEST(bytes >= BLOCK_SIZE * NUM_BLOCKS / 2);
+    OE_TEST(bytes <= BLOCK_SIZE * NUM_BLOCKS * 2);
+
+    _test_dump(enclave);
+
+    /* The freed blocks leave the profile, even when profiling is stopped. */
+    OE_TEST(enc_stop(enclave, &result) == OE_OK);
+    OE_TEST(result == OE_OK);
+    OE_TEST(enc_free(enclave) == OE_OK);
+    OE_TEST(_get_bytes(enclave) < BLOCK_SIZE * NUM_BLOCKS / 2);
+
+    /* No allocation is sampled once profiling is stopped. */
+    OE_TEST(enc_allocate(enclave, BLOCK_SIZE, NUM_BLOCKS) == OE_OK);
+    OE_TEST(_get_bytes(enclave) < BLOCK_SIZE * NUM_BLOCKS / 2);
+    OE_TEST(enc_free(enclave) == OE_OK);
+
+    /* Every block is sampled with an interval below the block size, and a
+     * thread keeps more live samples than fit in one buffer. */
+    OE_TEST(enc_start(enclave, &result, SMALL_SAMPLE_INTERVAL) == OE_OK);
+    OE_TEST(result == OE_OK);
+    OE_TEST(enc_allocate(enclave, BLOCK_SIZE, MANY_BLOCKS) == OE_OK);
+    bytes = _get_bytes(enclave);
+    OE_TEST(bytes >= BLOCK_SIZE * MANY_BLOCKS);
+
+    OE_TEST(enc_realloc_too_large(enclave) == OE_OK);
+    OE_TEST(_get_bytes(enclave) >= bytes);
+
+    OE_TEST(enc_stop(enclave, &result) == OE_OK);
+    OE_TEST(result == OE_OK);
+    OE_TEST(enc_free(enclave) == OE_OK);
+    OE_TEST(_get_bytes(enclave) < BLOCK_SIZE * MANY_BLOCKS / 2);
+
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+
+    printf("=== passed all tests (heap_profile)\n");
+
+    return 0;
+}
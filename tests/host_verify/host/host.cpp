@@ -3,18 +3,23 @@
 
 #include <fcntl.h>
 #include <limits.h>
+#include <openenclave/attestation/plugin.h>
+#include <openenclave/attestation/sgx/verifier.h>
 #include <openenclave/host.h>
 #include <openenclave/host_verify.h>
 #include <openenclave/internal/error.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/report.h>
+#include <openenclave/internal/sgx/plugin.h>
 #include <openenclave/internal/tests.h>
+#include <chrono>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 
+#include "../../../common/sgx/collateral.h"
 #include "../../../common/sgx/quote.h"
 #include "../../../host/sgx/sgxquoteprovider.h"
 
@@ -34,6 +39,7 @@
 #define CERT_RSA_BAD_FILENAME "sgx_cert_rsa_bad.der"
 
 #define REPORT_FILENAME "sgx_report.bin"
+#define ENDORSEMENTS_FILENAME "sgx_report.bin.col"
 #define REPORT_BAD_FILENAME "sgx_report_bad.bin"
 
 #define SKIP_RETURN_CODE 2
@@ -234,7 +240,136 @@ static int _verify_report(
     return ret;
 }
 
-int main()
+// Attestation header that oe_get_evidence() puts in front of the evidence.
+typedef struct _header
+{
+    uint32_t version;
+    oe_uuid_t format_id;
+    uint64_t data_size;
+    uint8_t data[];
+} header_t;
+
+static uint8_t* _wrap_with_header(
+    const uint8_t* data,
+    size_t data_size,
+    size_t extra_size,
+    size_t* total_size)
+{
+    const oe_uuid_t format_id = {OE_SGX_PLUGIN_UUID};
+    header_t* header = NULL;
+
+    *total_size = sizeof(header_t) + data_size + extra_size;
+    header = (header_t*)calloc(1, *total_size);
+    OE_TEST(header != NULL);
+
+    header->version = OE_ATTESTATION_HEADER_VERSION;
+    header->format_id = format_id;
+    header->data_size = data_size + extra_size;
+    memcpy(header->data, data, data_size);
+    return (uint8_t*)header;
+}
+
+static double _verify_batch(
+    oe_evidence_batch_item_t* items,
+    size_t count,
+    size_t num_threads)
+{
+    // Start every run without cached collateral.
+    oe_sgx_clear_collateral_cache();
+
+    auto start = std::chrono::steady_clock::now();
+    OE_TEST(
+        oe_verify_evidence_batch(items, count, NULL, 0, num_threads) == OE_OK);
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        OE_TEST(items[i].result == OE_OK);
+        OE_TEST(
+            oe_free_claims_list(items[i].claims, items[i].claims_length) ==
+            OE_OK);
+    }
+
+    return (double)count / elapsed.count();
+}
+
+// Measure the throughput of oe_verify_evidence_batch() with the report and
+// endorsements recorded by oecert, turned into SGX plugin evidence without
+// custom claims.
+static int _benchmark_batch(size_t count)
+{
+    uint8_t* report_data = NULL;
+    uint8_t* endorsements_data = NULL;
+    size_t report_size = 0;
+    size_t endorsements_size = 0;
+    uint8_t* evidence = NULL;
+    uint8_t* endorsements = NULL;
+    size_t evidence_size = 0;
+    size_t wrapped_endorsements_size = 0;
+    oe_sgx_plugin_claims_header_t* claims_header = NULL;
+    oe_evidence_batch_item_t* items = NULL;
+
+    if (!_validate_file(REPORT_FILENAME, false) ||
+        !_validate_file(ENDORSEMENTS_FILENAME, false))
+    {
+        printf("=== Skipped batch benchmark without recorded %s and %s\n",
+               REPORT_FILENAME,
+               ENDORSEMENTS_FILENAME);
+        return SKIP_RETURN_CODE;
+    }
+
+    _read_binary_file(REPORT_FILENAME, &report_data, &report_size);
+    _read_binary_file(
+        ENDORSEMENTS_FILENAME, &endorsements_data, &endorsements_size);
+
+    evidence = _wrap_with_header(
+        report_data,
+        report_size,
+        sizeof(oe_sgx_plugin_claims_header_t),
+        &evidence_size);
+    claims_header = (oe_sgx_plugin_claims_header_t*)(
+        ((header_t*)evidence)->data + report_size);
+    claims_header->version = OE_SGX_PLUGIN_CLAIMS_VERSION;
+    claims_header->num_claims = 0;
+
+    endorsements = _wrap_with_header(
+        endorsements_data, endorsements_size, 0, &wrapped_endorsements_size);
+
+    items = (oe_evidence_batch_item_t*)calloc(count, sizeof(*items));
+    OE_TEST(items != NULL);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        items[i].evidence_buffer = evidence;
+        items[i].evidence_buffer_size = evidence_size;
+        items[i].endorsements_buffer = endorsements;
+        items[i].endorsements_buffer_size = wrapped_endorsements_size;
+    }
+
+    OE_TEST(oe_register_verifier(oe_sgx_plugin_verifier(), NULL, 0) == OE_OK);
+
+    double one_thread = _verify_batch(items, count, 1);
+    double all_threads = _verify_batch(items, count, 0);
+
+    printf(
+        "oe_verify_evidence_batch: %zu items, 1 thread: %.0f items/s, "
+        "all processors: %.0f items/s\n",
+        count,
+        one_thread,
+        all_threads);
+
+    OE_TEST(oe_unregister_verifier(oe_sgx_plugin_verifier()) == OE_OK);
+
+    free(items);
+    free(endorsements);
+    free(evidence);
+    free(endorsements_data);
+    free(report_data);
+    return 0;
+}
+
+int main(int argc, const char* argv[])
 {
     const uint32_t flags = oe_get_create_flags();
     if ((flags & OE_ENCLAVE_FLAG_SIMULATE) != 0)
@@ -244,6 +379,9 @@ int main()
         return SKIP_RETURN_CODE;
     }
 
+    if (argc >= 2 && strcmp(argv[1], "--benchmark-batch") == 0)
+        return _benchmark_batch(argc >= 3 ? strtoul(argv[2], NULL, 10) : 10000);
+
     //
     // Report only tests
     //
@@ -0,0 +1,65 @@
+# Copyright (c) Open Enclave SDK contributors.
+# Licensed under the MIT License.
+
+# This script requires the variables EDGER8R, EDL, SOURCE_DIR, and
+# BINARY_DIR to be defined:
+#
+#     cmake -DEDGER8R=edger8r -DEDL=batch -DSOURCE_DIR=. -DBINARY_DIR=gen -P check_generated.cmake
+#
+# It generates the untrusted code of ${EDL}.edl and checks each
+# generated file against the `.expected` file of the same name. An
+# expected file is a list of blocks separated by empty lines. Each block
+# must appear as consecutive whole lines of the generated file, and the
+# blocks must appear in the order of the expected file.
+
+file(REMOVE_RECURSE ${BINARY_DIR})
+file(MAKE_DIRECTORY ${BINARY_DIR})
+
+execute_process(
+  COMMAND ${EDGER8R} --experimental --untrusted --untrusted-dir ${BINARY_DIR}
+          --search-path ${SOURCE_DIR} ${EDL}.edl
+  RESULT_VARIABLE RESULT)
+if (NOT RESULT EQUAL 0)
+  message(FATAL_ERROR "edger8r failed on ${EDL}.edl: ${RESULT}")
+endif ()
+
+function (check_generated NAME)
+  file(READ ${BINARY_DIR}/${NAME} GENERATED)
+  file(READ ${SOURCE_DIR}/${NAME}.expected EXPECTED)
+
+  # Compare lines regardless of the line endings of the platform. The
+  # content is only ever quoted, so that the semicolons and brackets of
+  # the C code are not taken for CMake list separators.
+  string(REPLACE "\r" "" GENERATED "${GENERATED}")
+  string(REPLACE "\r" "" EXPECTED "${EXPECTED}")
+  set(GENERATED "\n${GENERATED}\n")
+  set(EXPECTED "${EXPECTED}\n\n")
+
+  string(FIND "${EXPECTED}" "\n\n" END)
+  while (NOT END EQUAL -1)
+    string(SUBSTRING "${EXPECTED}" 0 ${END} BLOCK)
+    math(EXPR NEXT "${END} + 2")
+    string(SUBSTRING "${EXPECTED}" ${NEXT} -1 EXPECTED)
+
+    if (NOT BLOCK STREQUAL "")
+      string(FIND "${GENERATED}" "\n${BLOCK}\n" POSITION)
+      if (POSITION EQUAL -1)
+        message(FATAL_ERROR
+                "${NAME} does not contain, after the previous block:\n"
+                "${BLOCK}")
+      endif ()
+
+      # Keep the newline that ends the block, so that the next block is
+      # also matched from the start of a line.
+      string(LENGTH "${BLOCK}" LENGTH)
+      math(EXPR POSITION "${POSITION} + ${LENGTH} + 1")
+      string(SUBSTRING "${GENERATED}" ${POSITION} -1 GENERATED)
+    endif ()
+
+    string(FIND "${EXPECTED}" "\n\n" END)
+  endwhile ()
+endfunction ()
+
+check_generated(${EDL}_args.h)
+check_generated(${EDL}_u.h)
+check_generated(${EDL}_u.c)
@@ -0,0 +1,18 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include "perf_map_t.h"
+
+int enc_perf_map_target(int value)
+{
+    return value + 1;
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* AllowDebug */
+    64,   /* HeapPageCount */
+    64,   /* StackPageCount */
+    1);   /* TCSCount */
@@ -0,0 +1,132 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "perf_map_u.h"
+
+static char _path[64];
+
+static oe_enclave_t* _create_enclave(const char* enclave_path)
+{
+    oe_result_t result;
+    oe_enclave_t* enclave = NULL;
+    int value = 0;
+
+    result = oe_create_perf_map_enclave(
+        enclave_path,
+        OE_ENCLAVE_TYPE_SGX,
+        oe_get_create_flags(),
+        NULL,
+        0,
+        &enclave);
+
+    if (result != OE_OK)
+        oe_put_err("oe_create_perf_map_enclave(): result=%u", result);
+
+    OE_TEST(enc_perf_map_target(enclave, &value, 1) == OE_OK);
+    OE_TEST(value == 2);
+
+    return enclave;
+}
+
+/* Check that the map has a line for the given function, of the form
+ * "<start> <size> <name>". */
+static bool _has_function(const char* name)
+{
+    FILE* stream;
+    char line[1024];
+    bool found = false;
+
+    if (!(stream = fopen(_path, "r")))
+        return false;
+
+    while (!found && fgets(line, sizeof(line), stream))
+    {
+        unsigned long start;
+        unsigned long size;
+        char symbol[256];
+
+        if (sscanf(line, "%lx %lx %255s", &start, &size, symbol) == 3 &&
+            strcmp(symbol, name) == 0 && start != 0 && size != 0)
+            found = true;
+    }
+
+    fclose(stream);
+    return found;
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_enclave_t* enclave;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    /* Only debug enclaves are written to the map. */
+    if (!(oe_get_create_flags() & OE_ENCLAVE_FLAG_DEBUG))
+    {
+        printf("=== skipped (perf_map): not a debug enclave\n");
+        return 0;
+    }
+
+    snprintf(_path, sizeof(_path), "/tmp/perf-%d.map", (int)getpid());
+    remove(_path);
+
+    /* No map is written by default. */
+    unsetenv("OE_PERF_MAP");
+    enclave = _create_enclave(argv[1]);
+    OE_TEST(access(_path, F_OK) != 0);
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+
+    /* The map is removed with the last enclave. */
+    setenv("OE_PERF_MAP", "1", 1);
+    enclave = _create_enclave(argv[1]);
+    OE_TEST(_has_function("enc_perf_map_target"));
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+    OE_TEST(access(_path, F_OK) != 0);
+
+    /* The map is kept for perf report if requested. */
+    setenv("OE_PERF_MAP", "keep", 1);
+    enclave = _create_enclave(argv[1]);
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+    OE_TEST(_has_function("enc_perf_map_target"));
+    remove(_path);
+
+    /* A symbolic link planted in place of the map is not followed. */
+    {
+        char target[sizeof(_path) + 8];
+        struct stat st;
+        FILE* stream;
+
+        snprintf(target, sizeof(target), "%s.target", _path);
+        OE_TEST((stream = fopen(target, "w")) != NULL);
+        fclose(stream);
+        OE_TEST(symlink(target, _path) == 0);
+
+        setenv("OE_PERF_MAP", "1", 1);
+        enclave = _create_enclave(argv[1]);
+        OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+
+        OE_TEST(stat(target, &st) == 0);
+        OE_TEST(st.st_size == 0);
+        OE_TEST(lstat(_path, &st) == 0);
+        OE_TEST(S_ISLNK(st.st_mode));
+
+        remove(_path);
+        remove(target);
+    }
+
+    printf("=== passed all tests (perf_map)\n");
+
+    return 0;
+}
@@ -309,6 +309,33 @@ void run_qe_identity_v2_test_cases(oe_enclave_t* enclave)
     }
     printf("QE Identity V2 positive test, with advisoryIDs. PASSED\n");
 
+    // QE Identity V2 with advisoryIDs in the levels after the matching one.
+    std::vector<uint8_t> qe_id_info_with_advisoryids_all_levels = FileToBytes(
+        "./data_v2/qe_identity_with_advisoryids_all_levels.json");
+    platform_tcb_level.isvsvn[0] = 2;
+    OE_TEST(
+        test_verify_qe_identity_info(
+            enclave,
+            &ecall_result,
+            (const char*)&qe_id_info_with_advisoryids_all_levels[0],
+            &platform_tcb_level,
+            &parsed_info) == OE_OK);
+    OE_TEST(ecall_result == OE_OK);
+    OE_TEST(parsed_info.tcb_level.tcb_status.fields.up_to_date == 1);
+
+    platform_tcb_level.isvsvn[0] = 1;
+    OE_TEST(
+        test_verify_qe_identity_info(
+            enclave,
+            &ecall_result,
+            (const char*)&qe_id_info_with_advisoryids_all_levels[0],
+            &platform_tcb_level,
+            &parsed_info) == OE_OK);
+    OE_TEST(ecall_result == OE_TCB_LEVEL_INVALID);
+    OE_TEST(parsed_info.tcb_level.tcb_status.fields.outofdate == 1);
+    OE_TEST(parsed_info.tcb_level.advisory_ids_size > 0);
+    printf("QE Identity V2 test, with advisoryIDs in all levels. PASSED\n");
+
     // QVE Identity V2 positive test
     platform_tcb_level.isvsvn[0] = 2;
     OE_TEST(
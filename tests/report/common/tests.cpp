@@ -11,6 +11,7 @@
 #include "../../../host/sgx/sgxquoteprovider.h"
 #endif
 #include "../../../common/oe_host_stdlib.h"
+#include "../../../common/sgx/collateral.h"
 #include "../../../common/sgx/endorsements.h"
 #include "../../../common/sgx/qeidentity.h"
 #include "../../../common/sgx/quote.h"
@@ -1189,9 +1190,25 @@ void test_local_verify_report()
             &report_size) == OE_OK);
     OE_TEST(VerifyReport(report_ptr, report_size, NULL) == OE_OK);
     oe_free_report(report_ptr);
+
+    // 4. The report key is cached by the first verification. Reports still
+    // verify once the cache has been wiped.
+    OE_TEST(
+        GetReport_v2(
+            0,
+            NULL,
+            0,
+            target_info,
+            target_info_size,
+            &report_ptr,
+            &report_size) == OE_OK);
+    oe_clear_key_cache();
+    OE_TEST(VerifyReport(report_ptr, report_size, NULL) == OE_OK);
+    OE_TEST(VerifyReport(report_ptr, report_size, NULL) == OE_OK);
+    oe_free_report(report_ptr);
 #endif
 
-    // 4. Negative case.
+    // 5. Negative case.
 
     // Tamper with the target info.
     tampered_target_info = (sgx_target_info_t*)target_info;
@@ -1212,6 +1229,38 @@ void test_local_verify_report()
     oe_free_report(report_ptr);
 }
 
+#ifdef OE_BUILD_ENCLAVE
+// Verify a local report many times, as an enclave receiving messages from a
+// co-located enclave would, with or without the key cache.
+void benchmark_local_verify_report(uint64_t count, bool cached)
+{
+    uint8_t target_info[sizeof(sgx_target_info_t)];
+    uint8_t* report_ptr;
+    size_t report_size;
+
+    GetSGXTargetInfo((sgx_target_info_t*)target_info);
+    OE_TEST(
+        GetReport_v2(
+            0,
+            NULL,
+            0,
+            target_info,
+            sizeof(target_info),
+            &report_ptr,
+            &report_size) == OE_OK);
+
+    for (uint64_t i = 0; i < count; i++)
+    {
+        if (!cached)
+            oe_clear_key_cache();
+
+        OE_TEST(VerifyReport(report_ptr, report_size, NULL) == OE_OK);
+    }
+
+    oe_free_report(report_ptr);
+}
+#endif
+
 void test_remote_verify_report()
 {
     uint8_t* report_ptr;
@@ -1387,3 +1436,71 @@ void test_verify_report_with_collaterals()
     collaterals_buffer_ptr = NULL;
     report_buffer_ptr = NULL;
 }
+
+void test_collateral_cache()
+{
+    uint32_t flags = OE_REPORT_FLAGS_REMOTE_ATTESTATION;
+
+    size_t report_ptr_size;
+    uint8_t* report_buffer_ptr;
+
+    uint8_t* collaterals[2] = {NULL, NULL};
+    size_t collaterals_size[2] = {0, 0};
+
+    OE_TEST(
+        GetReport_v2(
+            flags, NULL, 0, NULL, 0, &report_buffer_ptr, &report_ptr_size) ==
+        OE_OK);
+
+    /* The first verification fills the cache, the others use it. */
+    oe_sgx_clear_collateral_cache();
+    for (int i = 0; i < 3; i++)
+        OE_TEST(
+            VerifyReport(report_buffer_ptr, report_ptr_size, NULL) == OE_OK);
+
+    /* Collaterals fetched from the cache are complete copies. */
+    if (GetCollaterals(&collaterals[0], &collaterals_size[0]) == OE_OK)
+    {
+        OE_TEST(GetCollaterals(&collaterals[1], &collaterals_size[1]) == OE_OK);
+        OE_TEST(collaterals[0] != collaterals[1]);
+        OE_TEST(collaterals_size[0] == collaterals_size[1]);
+
+        for (int i = 0; i < 2; i++)
+        {
+            OE_TEST(
+                VerifyReportWithCollaterals(
+                    report_buffer_ptr,
+                    report_ptr_size,
+                    collaterals[i],
+                    collaterals_size[i],
+                    NULL,
+                    NULL) == OE_OK);
+            oe_free_collaterals(collaterals[i]);
+        }
+    }
+
+    /* Quotes with the same PCK certificate chain share its parsed form. */
+    {
+        oe_report_header_t* header = (oe_report_header_t*)report_buffer_ptr;
+        oe_sgx_pck_chain_t* pck_chain[2] = {NULL, NULL};
+
+        for (int i = 0; i < 2; i++)
+            OE_TEST(
+                oe_get_sgx_quote_pck_chain(
+                    header->report, header->report_size, &pck_chain[i]) ==
+                OE_OK);
+        OE_TEST(pck_chain[0] == pck_chain[1]);
+        OE_TEST(
+            oe_datetime_compare(
+                &pck_chain[0]->valid_from, &pck_chain[0]->valid_until) < 0);
+
+        for (int i = 0; i < 2; i++)
+            oe_sgx_collateral_release(&pck_chain[i]->base);
+    }
+
+    /* Verification still works after the cache has been emptied. */
+    oe_sgx_clear_collateral_cache();
+    OE_TEST(VerifyReport(report_buffer_ptr, report_ptr_size, NULL) == OE_OK);
+
+    oe_free_report(report_buffer_ptr);
+}
@@ -26,5 +26,10 @@ void test_parse_report_negative();
 void test_local_verify_report();
 void test_remote_verify_report();
 void test_verify_report_with_collaterals();
+void test_collateral_cache();
+
+#ifdef OE_BUILD_ENCLAVE
+void benchmark_local_verify_report(uint64_t count, bool cached);
+#endif
 
 #endif
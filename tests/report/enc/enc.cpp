@@ -137,6 +137,16 @@ void enclave_test_verify_report_with_collaterals()
     test_verify_report_with_collaterals();
 }
 
+void enclave_test_collateral_cache()
+{
+    test_collateral_cache();
+}
+
+void enclave_benchmark_local_verify_report(uint64_t count, bool cached)
+{
+    benchmark_local_verify_report(count, cached);
+}
+
 OE_SET_ENCLAVE_SGX(
     0,    /* ProductID */
     0,    /* SecurityVersion */
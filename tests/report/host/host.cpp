@@ -6,10 +6,16 @@
 #include <openenclave/internal/hexdump.h>
 #include <openenclave/internal/tests.h>
 #include <openenclave/internal/utils.h>
+#include <chrono>
+#include <cstdlib>
 #include <ctime>
 #include <vector>
+#include "../../../common/sgx/collateral.h"
+#include "../../../common/sgx/endorsements.h"
+#include "../../../common/sgx/quote.h"
 #include "../../../common/sgx/tcbinfo.h"
 #include "../../../host/sgx/quote.h"
+#include "../../../host/sgx/sgxquoteprovider.h"
 #include "../common/tests.h"
 #include "tests_u.h"
 
@@ -29,6 +35,12 @@ extern void TestVerifyTCBInfoV2(
 extern void TestVerifyTCBInfoV2_AdvisoryIDs(
     oe_enclave_t* enclave,
     const char* test_filename);
+extern void TestVerifyTCBInfoV2_AdvisoryIDsAllLevels(
+    oe_enclave_t* enclave,
+    const char* test_filename);
+extern void TestTCBInfoLevels(const char* test_filename);
+extern int FuzzTCBInfo(uint64_t iterations);
+extern int BenchmarkTCBInfoParse(uint64_t count);
 extern int FileToBytes(const char* path, std::vector<uint8_t>* output);
 
 void generate_and_save_report(oe_enclave_t* enclave)
@@ -72,6 +84,125 @@ int load_and_verify_report()
     return 0;
 }
 
+static double verify_quote_ms(
+    const oe_report_header_t* header,
+    const uint8_t* endorsements,
+    size_t endorsements_size,
+    size_t count,
+    bool cached)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!cached)
+            oe_sgx_clear_collateral_cache();
+
+        OE_TEST(
+            oe_verify_sgx_quote(
+                header->report,
+                header->report_size,
+                endorsements,
+                endorsements_size,
+                NULL) == OE_OK);
+    }
+
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / (double)count;
+}
+
+// Verify the generated report's quote many times, as a verifier receiving
+// quotes from a single platform would, with and without the collateral
+// cache.
+int benchmark_generated_report(size_t count)
+{
+    std::vector<uint8_t> report;
+    uint8_t* endorsements = NULL;
+    size_t endorsements_size = 0;
+
+    if (FileToBytes("./data/generated_report.bytes", &report) != 0)
+    {
+        printf("benchmark_generated_report(): Couldn't find report. "
+               "Skipping...\n");
+        return SKIP_RETURN_CODE;
+    }
+
+    const oe_report_header_t* header = (oe_report_header_t*)&report[0];
+    OE_TEST(oe_initialize_quote_provider() == OE_OK);
+    OE_TEST(
+        oe_get_sgx_endorsements(
+            header->report,
+            header->report_size,
+            &endorsements,
+            &endorsements_size) == OE_OK);
+
+    size_t uncached_count = count / 100 ? count / 100 : 1;
+    double uncached_ms = verify_quote_ms(
+        header, endorsements, endorsements_size, uncached_count, false);
+
+    // The first verification fills the cache.
+    oe_sgx_clear_collateral_cache();
+    double cached_ms =
+        verify_quote_ms(header, endorsements, endorsements_size, count, true);
+
+    printf(
+        "Quote verification: %zu without cache: %.3f ms/quote, "
+        "%zu with cache: %.3f ms/quote (%.1fx)\n",
+        uncached_count,
+        uncached_ms,
+        count,
+        cached_ms,
+        uncached_ms / cached_ms);
+
+    oe_free_sgx_endorsements(endorsements);
+    return 0;
+}
+
+static double verify_local_report_us(
+    oe_enclave_t* enclave,
+    uint64_t count,
+    bool cached)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    OE_TEST(
+        enclave_benchmark_local_verify_report(enclave, count, cached) ==
+        OE_OK);
+
+    std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / (double)count;
+}
+
+// Verify a local report in the enclave many times with and without the
+// cache of report keys.
+int benchmark_local_report(const char* path, uint32_t flags, uint64_t count)
+{
+    oe_result_t result;
+    oe_enclave_t* enclave = NULL;
+
+    if ((result = oe_create_tests_enclave(
+             path, OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclave)) != OE_OK)
+    {
+        oe_put_err("oe_create_tests_enclave(): result=%u", result);
+    }
+
+    double uncached_us = verify_local_report_us(enclave, count, false);
+    double cached_us = verify_local_report_us(enclave, count, true);
+
+    printf(
+        "Local report verification (%llu reports): without key cache: "
+        "%.2f us/report, with key cache: %.2f us/report (%.1fx)\n",
+        (unsigned long long)count,
+        uncached_us,
+        cached_us,
+        uncached_us / cached_us);
+
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+    return 0;
+}
+
 int main(int argc, const char* argv[])
 {
     oe_result_t result;
@@ -118,6 +249,20 @@ int main(int argc, const char* argv[])
     }
 #endif
 
+    // Fuzz the TCB info parser. It runs on the host, without an enclave.
+    if (argc >= 3 && argc <= 4 && strcmp(argv[2], "--fuzz-tcb-info") == 0)
+    {
+        return FuzzTCBInfo(argc == 4 ? strtoull(argv[3], NULL, 10) : 10000);
+    }
+
+    // Benchmark parsing of the TCB info on the host.
+    if (argc >= 3 && argc <= 4 &&
+        strcmp(argv[2], "--benchmark-tcb-info-parse") == 0)
+    {
+        return BenchmarkTCBInfoParse(
+            argc == 4 ? strtoull(argv[3], NULL, 10) : 100000);
+    }
+
     const uint32_t flags = oe_get_create_flags();
     if ((flags & OE_ENCLAVE_FLAG_SIMULATE) != 0)
     {
@@ -132,6 +277,22 @@ int main(int argc, const char* argv[])
         return load_and_verify_report();
     }
 
+    // Benchmark verification of the generated report.
+    if (argc >= 3 && argc <= 4 &&
+        strcmp(argv[2], "--benchmark-generated-report") == 0)
+    {
+        return benchmark_generated_report(
+            argc == 4 ? strtoul(argv[3], NULL, 10) : 10000);
+    }
+
+    // Benchmark verification of local reports in the enclave.
+    if (argc >= 3 && argc <= 4 &&
+        strcmp(argv[2], "--benchmark-local-report") == 0)
+    {
+        return benchmark_local_report(
+            argv[1], flags, argc == 4 ? strtoull(argv[3], NULL, 10) : 100000);
+    }
+
     /* Check arguments */
     if (argc != 2)
     {
@@ -170,6 +331,8 @@ int main(int argc, const char* argv[])
 
     test_verify_report_with_collaterals();
 
+    test_collateral_cache();
+
     OE_TEST(test_iso8601_time(enclave) == OE_OK);
     OE_TEST(test_iso8601_time_negative(enclave) == OE_OK);
 
@@ -187,6 +350,8 @@ int main(int argc, const char* argv[])
 
     OE_TEST(enclave_test_verify_report_with_collaterals(enclave) == OE_OK);
 
+    OE_TEST(enclave_test_collateral_cache(enclave) == OE_OK);
+
     TestVerifyTCBInfo(enclave, "./data/tcbInfo.json");
     TestVerifyTCBInfo(enclave, "./data/tcbInfo_with_pceid.json");
 
@@ -194,6 +359,10 @@ int main(int argc, const char* argv[])
     TestVerifyTCBInfoV2(enclave, "./data_v2/tcbInfo_with_pceid.json");
     TestVerifyTCBInfoV2_AdvisoryIDs(
         enclave, "./data_v2/tcbInfoAdvisoryIds.json");
+    TestVerifyTCBInfoV2_AdvisoryIDsAllLevels(
+        enclave, "./data_v2/tcbInfoAdvisoryIdsAllLevels.json");
+    TestTCBInfoLevels("./data_v2/tcbInfo.json");
+    TestTCBInfoLevels("./data_v2/tcbInfoAdvisoryIdsAllLevels.json");
 
     // Get current time and pass it to enclave.
     std::time_t t = std::time(0);
@@ -8,9 +8,11 @@
 #include <openenclave/internal/tests.h>
 #include <openenclave/internal/utils.h>
 
+#include <chrono>
 #include <fstream>
 #include <streambuf>
 #include <vector>
+#include "../../../common/sgx/collateral.h"
 #include "../../../common/sgx/tcbinfo.h"
 #include "../../../host/sgx/quote.h"
 #include "tests_u.h"
@@ -107,6 +109,13 @@ void TestVerifyTCBInfo(
 
     oe_datetime_t nextUpdate = {2019, 6, 6, 10, 12, 17};
     OE_TEST(oe_datetime_compare(&parsed_info->next_update, &nextUpdate) == 0);
+
+    // The collateral cache finds the same date without a full parse.
+    oe_datetime_t cacheNextUpdate = {0};
+    OE_TEST(
+        oe_sgx_get_json_next_update(
+            &tcbInfo[0], tcbInfo.size(), &cacheNextUpdate) == OE_OK);
+    OE_TEST(oe_datetime_compare(&cacheNextUpdate, &nextUpdate) == 0);
 }
 
 void TestVerifyTCBInfo(oe_enclave_t* enclave, const char* test_filename)
@@ -502,4 +511,300 @@ void TestVerifyTCBInfoV2_AdvisoryIDs(
                 advisoryIDs_length[i]) == 0);
     }
     printf("TCB Info V2 positive test, with advisoryIDs. PASSED\n");
-}
\ No newline at end of file
+}
+
+// The level table returned by oe_parse_tcb_info_json_levels() must give the
+// same results as a full parse for every platform TCB level.
+void TestTCBInfoLevels(const char* test_filename)
+{
+    std::vector<uint8_t> tcbInfo;
+    OE_TEST(FileToBytes(test_filename, &tcbInfo) == 0);
+
+    oe_parsed_tcb_info_t parsed_info = {0};
+    oe_tcb_info_tcb_level_t* tcb_levels = NULL;
+    size_t tcb_level_count = 0;
+    OE_TEST(
+        oe_parse_tcb_info_json_levels(
+            &tcbInfo[0],
+            tcbInfo.size(),
+            &parsed_info,
+            &tcb_levels,
+            &tcb_level_count) == OE_OK);
+    OE_TEST(tcb_level_count == 5);
+    OE_TEST(tcb_levels[0].status.fields.up_to_date == 1);
+    OE_TEST(tcb_levels[4].status.fields.revoked == 1);
+    OE_TEST(
+        parsed_info.tcb_level.status.AsUINT32 ==
+        tcb_levels[4].status.AsUINT32);
+    OE_TEST(parsed_info.tcb_level.pce_svn == tcb_levels[4].pce_svn);
+    OE_TEST(
+        memcmp(
+            parsed_info.tcb_level.sgx_tcb_comp_svn,
+            tcb_levels[4].sgx_tcb_comp_svn,
+            sizeof(tcb_levels[4].sgx_tcb_comp_svn)) == 0);
+
+    for (uint8_t comp_svn = 0; comp_svn <= 5; ++comp_svn)
+    {
+        for (uint16_t pce_svn = 0; pce_svn <= 9; ++pce_svn)
+        {
+            oe_tcb_info_tcb_level_t expected = {
+                {comp_svn, 4, 2, 4, 1, 128, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1},
+                pce_svn};
+            oe_tcb_info_tcb_level_t platform_tcb_level = expected;
+            oe_parsed_tcb_info_t full_parse = {0};
+
+            oe_result_t expected_result = oe_parse_tcb_info_json(
+                &tcbInfo[0], tcbInfo.size(), &expected, &full_parse);
+            OE_TEST(
+                expected_result == OE_OK ||
+                expected_result == OE_TCB_LEVEL_INVALID);
+            OE_TEST(
+                oe_evaluate_tcb_info_levels(
+                    tcb_levels, tcb_level_count, &platform_tcb_level) ==
+                expected_result);
+            OE_TEST(
+                platform_tcb_level.status.AsUINT32 ==
+                expected.status.AsUINT32);
+        }
+    }
+
+    // oe_free() is free() on the host.
+    free(tcb_levels);
+    printf("TCB Info level table test %s. PASSED\n", test_filename);
+}
+
+// The levels after the platform's level are skipped without being parsed.
+// The skip must step over the advisoryIDs arrays of those levels.
+void TestVerifyTCBInfoV2_AdvisoryIDsAllLevels(
+    oe_enclave_t* enclave,
+    const char* test_filename)
+{
+    std::vector<uint8_t> tcbInfo;
+    oe_result_t ecall_result = OE_FAILURE;
+    OE_TEST(FileToBytes(test_filename, &tcbInfo) == 0);
+
+    oe_tcb_info_tcb_level_t platform_tcb_level = {
+        {4, 4, 2, 4, 1, 128, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1}, 8};
+    oe_parsed_tcb_info_t parsed_info = {0};
+
+    OE_TEST(
+        test_verify_tcb_info(
+            enclave,
+            &ecall_result,
+            (const char*)&tcbInfo[0],
+            &platform_tcb_level,
+            &parsed_info) == OE_OK);
+    OE_TEST(ecall_result == OE_OK);
+    OE_TEST(platform_tcb_level.status.fields.up_to_date == 1);
+    OE_TEST(parsed_info.tcb_level.advisory_ids_size > 0);
+
+    // The OutOfDateConfigurationNeeded level has a single advisory ID.
+    platform_tcb_level.pce_svn = 5;
+    OE_TEST(
+        test_verify_tcb_info(
+            enclave,
+            &ecall_result,
+            (const char*)&tcbInfo[0],
+            &platform_tcb_level,
+            &parsed_info) == OE_OK);
+    OE_TEST(ecall_result == OE_TCB_LEVEL_INVALID);
+    OE_TEST(platform_tcb_level.status.fields.qe_identity_out_of_date == 1);
+
+    const uint8_t* advisoryIDs[1] = {0};
+    size_t advisoryIDs_length[1] = {0};
+    size_t num_advisory_ids = 0;
+    OE_TEST(
+        oe_parse_advisoryids_json(
+            &tcbInfo[parsed_info.tcb_level.advisory_ids_offset],
+            parsed_info.tcb_level.advisory_ids_size,
+            (const uint8_t**)&advisoryIDs,
+            1,
+            (size_t*)&advisoryIDs_length,
+            1,
+            &num_advisory_ids) == OE_OK);
+    OE_TEST(num_advisory_ids == 1);
+    OE_TEST(
+        strncmp(
+            (const char*)advisoryIDs[0],
+            "INTEL-SA-00115",
+            advisoryIDs_length[0]) == 0);
+    printf("TCB Info V2 test, with advisoryIDs in all levels. PASSED\n");
+}
+
+static uint64_t _fuzz_state = 0x9e3779b97f4a7c15;
+
+static uint32_t _fuzz_random()
+{
+    // xorshift64, so that every run mutates the same way.
+    _fuzz_state ^= _fuzz_state << 13;
+    _fuzz_state ^= _fuzz_state >> 7;
+    _fuzz_state ^= _fuzz_state << 17;
+    return (uint32_t)(_fuzz_state >> 32);
+}
+
+// Mutate a recorded TCB info: overwrite bytes with JSON syntax or random
+// bytes, drop bytes or truncate it.
+static std::vector<uint8_t> _mutate(const std::vector<uint8_t>& tcbInfo)
+{
+    static const char syntax[] = "\"[]{},:0123456789 \\";
+    std::vector<uint8_t> mutated = tcbInfo;
+
+    for (uint32_t i = 1 + _fuzz_random() % 4; i > 0 && mutated.size() > 1; --i)
+    {
+        size_t pos = _fuzz_random() % mutated.size();
+        switch (_fuzz_random() % 4)
+        {
+            case 0:
+                mutated[pos] =
+                    (uint8_t)syntax[_fuzz_random() % (sizeof(syntax) - 1)];
+                break;
+            case 1:
+                mutated[pos] = (uint8_t)_fuzz_random();
+                break;
+            case 2:
+                mutated.erase(mutated.begin() + (ptrdiff_t)pos);
+                break;
+            default:
+                mutated.resize(pos + 1);
+                break;
+        }
+    }
+
+    // Return an exactly sized buffer so that sanitizers catch reads past the
+    // end.
+    return std::vector<uint8_t>(mutated.begin(), mutated.end());
+}
+
+// Deterministic mutation fuzzing of the TCB info parser over the recorded
+// TCB infos. Parsing must fail cleanly, and whenever the TCB info can be
+// parsed, the level table must agree with the full parse.
+int FuzzTCBInfo(uint64_t iterations)
+{
+    const char* files[] = {
+        "./data/tcbInfo.json",
+        "./data/tcbInfo_with_pceid.json",
+        "./data_v2/tcbInfo.json",
+        "./data_v2/tcbInfoAdvisoryIds.json",
+        "./data_v2/tcbInfoAdvisoryIdsAllLevels.json",
+    };
+    uint64_t parsed = 0;
+
+    for (size_t f = 0; f < OE_COUNTOF(files); ++f)
+    {
+        std::vector<uint8_t> tcbInfo;
+        OE_TEST(FileToBytes(files[f], &tcbInfo) == 0);
+
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            std::vector<uint8_t> mutated = _mutate(tcbInfo);
+            oe_tcb_info_tcb_level_t platform_tcb_level = {
+                {4, 4, 2, 4, 1, 128, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1},
+                (uint16_t)(_fuzz_random() % 10)};
+            oe_tcb_info_tcb_level_t table_tcb_level = platform_tcb_level;
+            oe_parsed_tcb_info_t parsed_info = {0};
+            oe_tcb_info_tcb_level_t* tcb_levels = NULL;
+            size_t tcb_level_count = 0;
+
+            oe_result_t result = oe_parse_tcb_info_json(
+                &mutated[0], mutated.size(), &platform_tcb_level, &parsed_info);
+            OE_TEST(
+                result == OE_OK || result == OE_TCB_LEVEL_INVALID ||
+                result == OE_JSON_INFO_PARSE_ERROR);
+
+            oe_result_t levels_result = oe_parse_tcb_info_json_levels(
+                &mutated[0],
+                mutated.size(),
+                &parsed_info,
+                &tcb_levels,
+                &tcb_level_count);
+            OE_TEST(
+                levels_result == OE_OK ||
+                levels_result == OE_JSON_INFO_PARSE_ERROR);
+            if (levels_result == OE_OK)
+            {
+                // The full parse skips the levels after the platform's level,
+                // so it only fails if the table cannot be parsed either.
+                OE_TEST(result != OE_JSON_INFO_PARSE_ERROR);
+                OE_TEST(
+                    oe_evaluate_tcb_info_levels(
+                        tcb_levels, tcb_level_count, &table_tcb_level) ==
+                    result);
+                OE_TEST(
+                    table_tcb_level.status.AsUINT32 ==
+                    platform_tcb_level.status.AsUINT32);
+                free(tcb_levels);
+                parsed++;
+            }
+        }
+    }
+
+    printf(
+        "TCB Info fuzzing: %llu mutations, %llu parsed. PASSED\n",
+        (unsigned long long)(iterations * OE_COUNTOF(files)),
+        (unsigned long long)parsed);
+    return 0;
+}
+
+// Compare a full parse per platform TCB level with evaluating a level table
+// that is parsed once, over the recorded TCB infos.
+int BenchmarkTCBInfoParse(uint64_t count)
+{
+    const char* files[] = {
+        "./data/tcbInfo.json",
+        "./data_v2/tcbInfo.json",
+        "./data_v2/tcbInfoAdvisoryIdsAllLevels.json",
+    };
+
+    for (size_t f = 0; f < OE_COUNTOF(files); ++f)
+    {
+        std::vector<uint8_t> tcbInfo;
+        OE_TEST(FileToBytes(files[f], &tcbInfo) == 0);
+
+        // An up-to-date platform, which is the common case.
+        oe_tcb_info_tcb_level_t platform_tcb_level = {
+            {4, 4, 2, 4, 1, 128, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1}, 8};
+        oe_parsed_tcb_info_t parsed_info = {0};
+        oe_tcb_info_tcb_level_t* tcb_levels = NULL;
+        size_t tcb_level_count = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < count; ++i)
+            oe_parse_tcb_info_json(
+                &tcbInfo[0],
+                tcbInfo.size(),
+                &platform_tcb_level,
+                &parsed_info);
+        std::chrono::duration<double, std::micro> parse_us =
+            std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        OE_TEST(
+            oe_parse_tcb_info_json_levels(
+                &tcbInfo[0],
+                tcbInfo.size(),
+                &parsed_info,
+                &tcb_levels,
+                &tcb_level_count) == OE_OK);
+        for (uint64_t i = 0; i < count; ++i)
+            oe_evaluate_tcb_info_levels(
+                tcb_levels, tcb_level_count, &platform_tcb_level);
+        std::chrono::duration<double, std::micro> table_us =
+            std::chrono::steady_clock::now() - start;
+        free(tcb_levels);
+
+        double parse_mb_per_s =
+            (double)tcbInfo.size() * (double)count / parse_us.count();
+        printf(
+            "%s (%zu bytes, %llu platforms): parse: %.3f us/platform "
+            "(%.1f MB/s), level table: %.3f us/platform (%.1fx)\n",
+            files[f],
+            tcbInfo.size(),
+            (unsigned long long)count,
+            parse_us.count() / (double)count,
+            parse_mb_per_s,
+            table_us.count() / (double)count,
+            parse_us.count() / table_us.count());
+    }
+
+    return 0;
+}
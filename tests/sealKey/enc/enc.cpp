@@ -533,10 +533,248 @@ bool TestAsymKey()
     return true;
 }
 
+// Seal a buffer in one call and in a stream of chunks and check that every
+// change to the blob or to the additional data is detected.
+static void TestSealCase(oe_seal_policy_t seal_policy, size_t size)
+{
+    const char ad[] = "additional data";
+    const uint32_t chunk_size = 4096;
+    uint8_t* plaintext = (uint8_t*)malloc(size + 1);
+    uint8_t* output = (uint8_t*)malloc(size + 1);
+    uint8_t* blob = NULL;
+    size_t blob_size = 0;
+    size_t output_size = 0;
+    uint8_t header[OE_SEAL_HEADER_SIZE];
+    oe_seal_context_t* context = NULL;
+    uint32_t unseal_chunk_size = 0;
+    size_t offset = 0;
+
+    OE_TEST(plaintext && output);
+    for (size_t i = 0; i < size; i++)
+        plaintext[i] = (uint8_t)(i * 7);
+
+    // A NULL buffer returns the size of the blob.
+    OE_TEST(
+        oe_seal(
+            seal_policy,
+            plaintext,
+            size,
+            ad,
+            sizeof(ad),
+            NULL,
+            &blob_size) == OE_BUFFER_TOO_SMALL);
+    blob = (uint8_t*)malloc(blob_size);
+    OE_TEST(blob != NULL);
+    OE_TEST(
+        oe_seal(
+            seal_policy,
+            plaintext,
+            size,
+            ad,
+            sizeof(ad),
+            blob,
+            &blob_size) == OE_OK);
+
+    OE_TEST(
+        oe_unseal(blob, blob_size, ad, sizeof(ad), NULL, &output_size) ==
+        OE_BUFFER_TOO_SMALL);
+    OE_TEST(output_size == size);
+    OE_TEST(
+        oe_unseal(blob, blob_size, ad, sizeof(ad), output, &output_size) ==
+        OE_OK);
+    OE_TEST(output_size == size && memcmp(output, plaintext, size) == 0);
+
+    // Wrong additional data.
+    output_size = size;
+    OE_TEST(
+        oe_unseal(blob, blob_size, ad, sizeof(ad) - 1, output, &output_size) ==
+        OE_CRYPTO_ERROR);
+
+    // A modified header and a modified tag.
+    blob[20] ^= 1;
+    OE_TEST(
+        oe_unseal(blob, blob_size, ad, sizeof(ad), output, &output_size) !=
+        OE_OK);
+    blob[20] ^= 1;
+    blob[blob_size - 1] ^= 1;
+    OE_TEST(
+        oe_unseal(blob, blob_size, ad, sizeof(ad), output, &output_size) ==
+        OE_CRYPTO_ERROR);
+    blob[blob_size - 1] ^= 1;
+
+    // A truncated blob.
+    OE_TEST(
+        oe_unseal(
+            blob, blob_size - 1, ad, sizeof(ad), output, &output_size) !=
+        OE_OK);
+    free(blob);
+
+    // Seal in chunks: the result is a regular blob.
+    blob_size = OE_SEAL_HEADER_SIZE + size +
+                (size / chunk_size + 1) * OE_SEAL_CHUNK_OVERHEAD;
+    blob = (uint8_t*)malloc(blob_size);
+    OE_TEST(blob != NULL);
+    OE_TEST(
+        oe_seal_init(
+            seal_policy, chunk_size, ad, sizeof(ad), header, &context) ==
+        OE_OK);
+    memcpy(blob, header, sizeof(header));
+    offset = OE_SEAL_HEADER_SIZE;
+    for (size_t i = 0; i <= size; i += chunk_size)
+    {
+        size_t n = size - i < chunk_size ? size - i : chunk_size;
+        bool final = i + chunk_size > size;
+
+        OE_TEST(
+            oe_seal_update(context, plaintext + i, n, final, blob + offset) ==
+            OE_OK);
+        offset += n + OE_SEAL_CHUNK_OVERHEAD;
+    }
+    OE_TEST(offset == blob_size);
+    OE_TEST(
+        oe_seal_update(context, plaintext, 0, true, blob) ==
+        OE_INVALID_PARAMETER);
+    oe_seal_free(context);
+
+    output_size = size;
+    OE_TEST(
+        oe_unseal(blob, blob_size, ad, sizeof(ad), output, &output_size) ==
+        OE_OK);
+    OE_TEST(output_size == size && memcmp(output, plaintext, size) == 0);
+
+    // Unseal in chunks.
+    memset(output, 0, size);
+    OE_TEST(
+        oe_unseal_init(
+            blob, ad, sizeof(ad), &unseal_chunk_size, &context) == OE_OK);
+    OE_TEST(unseal_chunk_size == chunk_size);
+    offset = OE_SEAL_HEADER_SIZE;
+    for (size_t i = 0; i <= size; i += chunk_size)
+    {
+        size_t n = size - i < chunk_size ? size - i : chunk_size;
+        bool final = i + chunk_size > size;
+
+        OE_TEST(
+            oe_unseal_update(
+                context,
+                blob + offset,
+                n + OE_SEAL_CHUNK_OVERHEAD,
+                final,
+                output + i) == OE_OK);
+        offset += n + OE_SEAL_CHUNK_OVERHEAD;
+    }
+    oe_seal_free(context);
+    OE_TEST(memcmp(output, plaintext, size) == 0);
+
+    // A stream that ends early is rejected.
+    if (size >= chunk_size)
+    {
+        OE_TEST(
+            oe_unseal_init(
+                blob, ad, sizeof(ad), &unseal_chunk_size, &context) == OE_OK);
+        OE_TEST(
+            oe_unseal_update(
+                context,
+                blob + OE_SEAL_HEADER_SIZE,
+                chunk_size + OE_SEAL_CHUNK_OVERHEAD,
+                true,
+                output) == OE_CRYPTO_ERROR);
+        oe_seal_free(context);
+    }
+
+    free(blob);
+    free(output);
+    free(plaintext);
+}
+
+bool TestSeal()
+{
+    static const size_t sizes[] = {0, 1, 4095, 4096, 4097, 100000};
+
+    for (uint32_t seal_policy = OE_SEAL_POLICY_UNIQUE;
+         seal_policy <= OE_SEAL_POLICY_PRODUCT;
+         seal_policy++)
+    {
+        for (size_t i = 0; i < OE_COUNTOF(sizes); i++)
+            TestSealCase((oe_seal_policy_t)seal_policy, sizes[i]);
+    }
+
+    // Blobs still unseal after the cached keys have been wiped.
+    {
+        const uint8_t plaintext[] = "plaintext";
+        uint8_t blob[OE_SEAL_HEADER_SIZE + sizeof(plaintext) +
+                     OE_SEAL_CHUNK_OVERHEAD];
+        uint8_t output[sizeof(plaintext)];
+        size_t blob_size = sizeof(blob);
+        size_t output_size = sizeof(output);
+
+        OE_TEST(
+            oe_seal(
+                OE_SEAL_POLICY_UNIQUE,
+                plaintext,
+                sizeof(plaintext),
+                NULL,
+                0,
+                blob,
+                &blob_size) == OE_OK);
+        oe_clear_key_cache();
+        OE_TEST(
+            oe_unseal(blob, blob_size, NULL, 0, output, &output_size) ==
+            OE_OK);
+        OE_TEST(
+            output_size == sizeof(plaintext) &&
+            memcmp(output, plaintext, sizeof(plaintext)) == 0);
+    }
+
+    // Blobs still unseal after their key was evicted from the cache by the
+    // keys of other blobs.
+    {
+        const uint8_t plaintext[] = "plaintext";
+        uint8_t blob[OE_SEAL_HEADER_SIZE + sizeof(plaintext) +
+                     OE_SEAL_CHUNK_OVERHEAD];
+        uint8_t other[sizeof(blob)];
+        uint8_t output[sizeof(plaintext)];
+        size_t blob_size = sizeof(blob);
+        size_t output_size = sizeof(output);
+
+        OE_TEST(
+            oe_seal(
+                OE_SEAL_POLICY_UNIQUE,
+                plaintext,
+                sizeof(plaintext),
+                NULL,
+                0,
+                blob,
+                &blob_size) == OE_OK);
+
+        // The key ID ends the header, so changing its last byte selects
+        // another key (under which the blob does not authenticate).
+        for (uint8_t i = 1; i <= 16; i++)
+        {
+            memcpy(other, blob, blob_size);
+            other[OE_SEAL_HEADER_SIZE - 1] ^= i;
+            output_size = sizeof(output);
+            OE_TEST(
+                oe_unseal(other, blob_size, NULL, 0, output, &output_size) ==
+                OE_CRYPTO_ERROR);
+        }
+
+        output_size = sizeof(output);
+        OE_TEST(
+            oe_unseal(blob, blob_size, NULL, 0, output, &output_size) ==
+            OE_OK);
+        OE_TEST(
+            output_size == sizeof(plaintext) &&
+            memcmp(output, plaintext, sizeof(plaintext)) == 0);
+    }
+
+    return true;
+}
+
 int test_seal_key(int in)
 {
     if (TestOEGetPrivilegeKeys() && TestOEGetRegularKeys() &&
-        TestOEGetSealKey() && TestAsymKey())
+        TestOEGetSealKey() && TestAsymKey() && TestSeal())
     {
         return 0;
     }
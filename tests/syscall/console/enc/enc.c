@@ -0,0 +1,158 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <errno.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/syscall/fdtable.h>
+#include <openenclave/internal/tests.h>
+#include <openenclave/internal/time.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "test_console_t.h"
+
+/* Return the number of bytes the host has received on standard output. */
+static size_t _output_size(void)
+{
+    size_t size = 0;
+
+    OE_TEST(host_output_size(&size) == OE_OK);
+
+    return size;
+}
+
+static void _test_errors(void)
+{
+    OE_TEST(oe_console_setvbuf(STDIN_FILENO, OE_IOFBF, 0) == -1);
+    OE_TEST(errno == EBADF);
+
+    OE_TEST(oe_console_setvbuf(100, OE_IOFBF, 0) == -1);
+    OE_TEST(errno == EBADF);
+
+    OE_TEST(oe_console_setvbuf(STDOUT_FILENO, 3, 0) == -1);
+    OE_TEST(errno == EINVAL);
+}
+
+static void _test_full_buffering(void)
+{
+    static char data[64];
+    size_t size = _output_size();
+    int fd;
+
+    memset(data, 'x', sizeof(data));
+
+    OE_TEST(oe_console_setvbuf(STDOUT_FILENO, OE_IOFBF, 16) == 0);
+
+    /* Output is held until the buffer is flushed. */
+    OE_TEST(write(STDOUT_FILENO, data, 10) == 10);
+    OE_TEST(_output_size() == size);
+    OE_TEST(oe_console_flush() == 0);
+    OE_TEST(_output_size() == (size += 10));
+
+    /* Output that does not fit flushes the buffer first. */
+    OE_TEST(write(STDOUT_FILENO, data, 10) == 10);
+    OE_TEST(write(STDOUT_FILENO, data, 10) == 10);
+    OE_TEST(_output_size() == (size += 10));
+
+    /* Output larger than the buffer is written directly. */
+    OE_TEST(write(STDOUT_FILENO, data, sizeof(data)) == sizeof(data));
+    OE_TEST(_output_size() == (size += 10 + sizeof(data)));
+
+    /* Duplicates of stdout share its buffer. */
+    OE_TEST((fd = dup(STDOUT_FILENO)) >= 0);
+    OE_TEST(write(fd, data, 4) == 4);
+    OE_TEST(_output_size() == size);
+    OE_TEST(close(fd) == 0);
+    OE_TEST(_output_size() == (size += 4));
+
+    /* fflush() writes out the stream and the console buffer. */
+    printf("12345");
+    OE_TEST(_output_size() == size);
+    OE_TEST(fflush(stdout) == 0);
+    OE_TEST(_output_size() == (size += 5));
+}
+
+static void _test_line_buffering(void)
+{
+    size_t size = _output_size();
+
+    OE_TEST(oe_console_setvbuf(STDOUT_FILENO, OE_IOLBF, 0) == 0);
+
+    OE_TEST(write(STDOUT_FILENO, "abc", 3) == 3);
+    OE_TEST(_output_size() == size);
+    OE_TEST(write(STDOUT_FILENO, "d\nef", 4) == 4);
+    OE_TEST(_output_size() == (size += 7));
+
+    /* Changing the mode writes out pending output. */
+    OE_TEST(write(STDOUT_FILENO, "g", 1) == 1);
+    OE_TEST(oe_console_setvbuf(STDOUT_FILENO, OE_IONBF, 0) == 0);
+    OE_TEST(_output_size() == (size += 1));
+
+    OE_TEST(write(STDOUT_FILENO, "h", 1) == 1);
+    OE_TEST(_output_size() == (size += 1));
+}
+
+void test_console(void)
+{
+    _test_errors();
+    _test_full_buffering();
+    _test_line_buffering();
+
+    /* Leave output in the buffer for the host to find once this ECALL has
+     * returned. */
+    OE_TEST(oe_console_setvbuf(STDOUT_FILENO, OE_IOFBF, 0) == 0);
+    OE_TEST(write(STDOUT_FILENO, "END", 3) == 3);
+}
+
+/* A duplicate of stdout that one thread buffers output for while another
+ * thread closes it. */
+static volatile int _shared_fd = -1;
+static volatile bool _written;
+static volatile bool _closed;
+
+void test_close_writer(void)
+{
+    OE_TEST(oe_console_setvbuf(STDOUT_FILENO, OE_IOFBF, 0) == 0);
+    OE_TEST((_shared_fd = dup(STDOUT_FILENO)) >= 0);
+    OE_TEST(write(_shared_fd, "STALE", 5) == 5);
+    _written = true;
+
+    /* Keep the output buffered (by not returning from this ECALL) until the
+     * other thread has closed the descriptor. */
+    while (!_closed)
+        oe_sleep_msec(10);
+}
+
+void test_close_closer(void)
+{
+    oe_fd_t* desc;
+    oe_host_fd_t host_fd;
+    size_t size;
+
+    while (!_written)
+        oe_sleep_msec(10);
+
+    size = _output_size();
+
+    OE_TEST((desc = oe_fdtable_get(_shared_fd, OE_FD_TYPE_FILE)));
+    host_fd = desc->ops.fd.get_host_fd(desc);
+    oe_fdtable_put(desc);
+
+    /* Closing the descriptor writes out the other thread's output. */
+    OE_TEST(close(_shared_fd) == 0);
+    OE_TEST(_output_size() == size + 5);
+
+    /* The host may now give the number of the closed descriptor to another
+     * file, which must not receive the output. */
+    OE_TEST(host_reuse_fd(host_fd) == OE_OK);
+
+    _closed = true;
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* AllowDebug */
+    1024, /* HeapPageCount */
+    1024, /* StackPageCount */
+    2);   /* TCSCount */
@@ -0,0 +1,114 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <fcntl.h>
+#include <limits.h>
+#include <openenclave/host.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../../../../host/hostthread.h"
+#include "test_console_u.h"
+
+size_t host_output_size(void)
+{
+    struct stat st;
+
+    OE_TEST(fstat(STDOUT_FILENO, &st) == 0);
+
+    return (size_t)st.st_size;
+}
+
+static char _reused_path[PATH_MAX];
+static int _reused_fd = -1;
+
+/* Open another file on the host descriptor that the enclave closed. */
+void host_reuse_fd(int64_t host_fd)
+{
+    int fd;
+
+    OE_TEST((fd = open(_reused_path, O_CREAT | O_TRUNC | O_RDWR, 0644)) >= 0);
+
+    if (fd != (int)host_fd)
+    {
+        OE_TEST(dup2(fd, (int)host_fd) == (int)host_fd);
+        OE_TEST(close(fd) == 0);
+    }
+
+    _reused_fd = (int)host_fd;
+}
+
+static void* _writer(void* arg)
+{
+    OE_TEST(test_close_writer((oe_enclave_t*)arg) == OE_OK);
+    return NULL;
+}
+
+/* Close a descriptor while another enclave thread has output buffered for
+ * it. */
+static void _test_close(oe_enclave_t* enclave)
+{
+    oe_thread_t writer;
+    struct stat st;
+
+    OE_TEST(oe_thread_create(&writer, _writer, enclave) == 0);
+    OE_TEST(test_close_closer(enclave) == OE_OK);
+    OE_TEST(oe_thread_join(writer) == 0);
+
+    /* The writer's output went to stdout when the descriptor was closed,
+     * not to the file that has its number now. */
+    OE_TEST(_reused_fd != -1);
+    OE_TEST(fstat(_reused_fd, &st) == 0);
+    OE_TEST(st.st_size == 0);
+    OE_TEST(close(_reused_fd) == 0);
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_result_t r;
+    oe_enclave_t* enclave = NULL;
+    const uint32_t flags = oe_get_create_flags();
+    const oe_enclave_type_t type = OE_ENCLAVE_TYPE_SGX;
+    int fd;
+    int stdout_fd;
+    char buf[3];
+
+    if (argc != 3)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH OUTPUT_FILE\n", argv[0]);
+        return 1;
+    }
+
+    snprintf(_reused_path, sizeof(_reused_path), "%s.reused", argv[2]);
+
+    /* Send the enclave's standard output to a file that can be inspected. */
+    fflush(stdout);
+    OE_TEST((stdout_fd = dup(STDOUT_FILENO)) >= 0);
+    OE_TEST((fd = open(argv[2], O_CREAT | O_TRUNC | O_RDWR, 0644)) >= 0);
+    OE_TEST(dup2(fd, STDOUT_FILENO) == STDOUT_FILENO);
+
+    r = oe_create_test_console_enclave(argv[1], type, flags, NULL, 0, &enclave);
+    OE_TEST(r == OE_OK);
+
+    r = test_console(enclave);
+    OE_TEST(r == OE_OK);
+
+    /* Output buffered by the enclave is written when the ECALL returns. */
+    OE_TEST(pread(fd, buf, sizeof(buf), (off_t)host_output_size() - 3) == 3);
+    OE_TEST(memcmp(buf, "END", 3) == 0);
+
+    _test_close(enclave);
+
+    r = oe_terminate_enclave(enclave);
+    OE_TEST(r == OE_OK);
+
+    OE_TEST(dup2(stdout_fd, STDOUT_FILENO) == STDOUT_FILENO);
+    OE_TEST(close(stdout_fd) == 0);
+    OE_TEST(close(fd) == 0);
+
+    printf("=== passed all tests (test_console)\n");
+
+    return 0;
+}
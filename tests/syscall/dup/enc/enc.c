@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #include <assert.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <limits.h>
 #include <openenclave/corelibc/stdio.h>
@@ -93,6 +94,97 @@ void test_dup(const char* tmp_dir)
         TEST(close(fd) == 0);
     }
 
+    /* Use a descriptor beyond the initial size of the descriptor table. */
+    {
+        char buf[sizeof(MESSAGE)];
+        int high;
+
+        TEST((fd = open(path, O_RDONLY)) >= 0);
+        TEST((high = dup2(fd, 4000)) == 4000);
+        TEST(close(fd) == 0);
+
+        /* The lowest free descriptor is reused. */
+        TEST(dup(high) == fd);
+        TEST(close(fd) == 0);
+
+        TEST(read(high, buf, sizeof(buf)) == sizeof(MESSAGE) - 1);
+        TEST(close(high) == 0);
+        TEST(close(high) == -1 && errno == EBADF);
+    }
+
+    TEST(umount("/") == 0);
+}
+
+static char _race_path[PATH_MAX];
+static volatile int _race_fd = -1;
+static volatile int _race_done;
+
+void test_close_race_begin(const char* tmp_dir)
+{
+    const char MESSAGE[] = "This is a race\n";
+    int fd;
+
+    TEST(oe_load_module_host_file_system() == OE_OK);
+    TEST(mount("/", "/", OE_HOST_FILE_SYSTEM, 0, NULL) == 0);
+
+    strlcpy(_race_path, tmp_dir, sizeof(_race_path));
+    strlcat(_race_path, "/RACE", sizeof(_race_path));
+
+    fd = open(_race_path, (O_WRONLY | O_CREAT | O_TRUNC), 0666);
+    TEST(fd >= 0);
+    TEST(write(fd, MESSAGE, sizeof(MESSAGE)) == sizeof(MESSAGE));
+    TEST(close(fd) == 0);
+
+    _race_fd = -1;
+    _race_done = 0;
+}
+
+/* Open and close the shared descriptor while the readers use it. */
+void test_close_race_closer(size_t iterations)
+{
+    for (size_t i = 0; i < iterations; i++)
+    {
+        int fd = open(_race_path, O_RDONLY);
+
+        TEST(fd >= 0);
+        _race_fd = fd;
+        TEST(close(fd) == 0);
+    }
+
+    _race_done = 1;
+}
+
+/* Read and duplicate the shared descriptor, which may be closed at any
+ * time. Each call either works or fails with EBADF, and a duplicate keeps
+ * the file open after the shared descriptor is closed. */
+void test_close_race_reader(void)
+{
+    char buf[16];
+
+    while (!_race_done)
+    {
+        int fd = _race_fd;
+        int copy;
+
+        if (fd < 0)
+            continue;
+
+        TEST(read(fd, buf, sizeof(buf)) >= 0 || errno == EBADF);
+
+        if ((copy = dup(fd)) >= 0)
+        {
+            TEST(read(copy, buf, sizeof(buf)) >= 0);
+            TEST(close(copy) == 0);
+        }
+        else
+        {
+            TEST(errno == EBADF);
+        }
+    }
+}
+
+void test_close_race_end(void)
+{
     TEST(umount("/") == 0);
 }
 
@@ -102,4 +194,4 @@ OE_SET_ENCLAVE_SGX(
     true, /* AllowDebug */
     1024, /* HeapPageCount */
     1024, /* StackPageCount */
-    2);   /* TCSCount */
+    5);   /* TCSCount */
@@ -5,8 +5,36 @@
 #include <openenclave/internal/syscall/host.h>
 #include <openenclave/internal/tests.h>
 #include <stdio.h>
+#include "../../../../host/hostthread.h"
 #include "test_dup_u.h"
 
+#define NUM_READERS 3
+#define NUM_CLOSES 10000
+
+static void* _reader(void* arg)
+{
+    OE_TEST(test_close_race_reader((oe_enclave_t*)arg) == OE_OK);
+    return NULL;
+}
+
+/* Close a descriptor while other enclave threads read and duplicate it. */
+static void _test_close_race(oe_enclave_t* enclave, const char* tmp_dir)
+{
+    oe_thread_t readers[NUM_READERS];
+
+    OE_TEST(test_close_race_begin(enclave, tmp_dir) == OE_OK);
+
+    for (size_t i = 0; i < NUM_READERS; i++)
+        OE_TEST(oe_thread_create(&readers[i], _reader, enclave) == 0);
+
+    OE_TEST(test_close_race_closer(enclave, NUM_CLOSES) == OE_OK);
+
+    for (size_t i = 0; i < NUM_READERS; i++)
+        OE_TEST(oe_thread_join(readers[i]) == 0);
+
+    OE_TEST(test_close_race_end(enclave) == OE_OK);
+}
+
 int main(int argc, const char* argv[])
 {
     oe_result_t r;
@@ -32,6 +60,8 @@ int main(int argc, const char* argv[])
     r = test_dup(enclave, tmp_dir);
     OE_TEST(r == OE_OK);
 
+    _test_close_race(enclave, tmp_dir);
+
     r = oe_terminate_enclave(enclave);
     OE_TEST(r == OE_OK);
 
@@ -1,6 +1,8 @@
 // Copyright (c) Open Enclave SDK contributors.
 // Licensed under the MIT License.
 
+#include <errno.h>
+#include <fcntl.h>
 #include <openenclave/corelibc/limits.h>
 #include <openenclave/corelibc/stdlib.h>
 #include <openenclave/enclave.h>
@@ -8,9 +10,12 @@
 #include <openenclave/internal/syscall/device.h>
 #include <openenclave/internal/syscall/unistd.h>
 #include <openenclave/internal/tests.h>
+#include <openenclave/internal/time.h>
 #include <stdio.h>
 #include <string.h>
 #include <sys/mount.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
 #include <set>
 #include <string>
 #include "../../cpio/commands.h"
@@ -497,6 +502,189 @@ void test_zero_sized_iovs(void)
     OE_TEST(oe_readv(OE_STDIN_FILENO, &iov, 0) == 0);
 }
 
+static void test_sendfile(const char* tmp_dir)
+{
+    char path[OE_PATH_MAX];
+    char buf[sizeof(ALPHABET)];
+    int in_fd;
+    int out_fd;
+    off_t offset = 10;
+
+    printf("--- %s()\n", __FUNCTION__);
+
+    OE_TEST(mount("/", "/", OE_DEVICE_NAME_HOST_FILE_SYSTEM, 0, NULL) == 0);
+
+    mkpath(path, tmp_dir, "sendfile.in");
+    in_fd = open(path, OE_O_CREAT | OE_O_TRUNC | OE_O_RDWR, MODE);
+    OE_TEST(in_fd >= 0);
+    OE_TEST(write(in_fd, ALPHABET, sizeof(ALPHABET)) == sizeof(ALPHABET));
+
+    mkpath(path, tmp_dir, "sendfile.out");
+    out_fd = open(path, OE_O_CREAT | OE_O_TRUNC | OE_O_RDWR, MODE);
+    OE_TEST(out_fd >= 0);
+
+    /* With an offset, the input file position is left unchanged. */
+    OE_TEST(lseek(in_fd, 0, SEEK_SET) == 0);
+    OE_TEST(sendfile(out_fd, in_fd, &offset, 6) == 6);
+    OE_TEST(offset == 16);
+    OE_TEST(lseek(in_fd, 0, SEEK_CUR) == 0);
+
+    /* Without one, copying stops at the end of the input file. */
+    OE_TEST(sendfile(out_fd, in_fd, NULL, 100) == sizeof(ALPHABET));
+    OE_TEST(sendfile(out_fd, in_fd, NULL, 100) == 0);
+
+    OE_TEST(lseek(out_fd, 0, SEEK_SET) == 0);
+    OE_TEST(read(out_fd, buf, 6) == 6);
+    OE_TEST(memcmp(buf, "klmnop", 6) == 0);
+    OE_TEST(read(out_fd, buf, sizeof(buf)) == sizeof(buf));
+    OE_TEST(memcmp(buf, ALPHABET, sizeof(buf)) == 0);
+
+    OE_TEST(sendfile(out_fd, -1, NULL, 1) == -1);
+    OE_TEST(errno == EBADF);
+
+    OE_TEST(close(in_fd) == 0);
+    OE_TEST(close(out_fd) == 0);
+
+    OE_TEST(umount("/") == 0);
+}
+
+static void test_sendfile_socket(const char* tmp_dir)
+{
+    char path[OE_PATH_MAX];
+    char buf[sizeof(ALPHABET)];
+    int sv[2];
+    int in_fd;
+    int out_fd;
+    off_t offset = 0;
+
+    printf("--- %s()\n", __FUNCTION__);
+
+    OE_TEST(mount("/", "/", OE_DEVICE_NAME_HOST_FILE_SYSTEM, 0, NULL) == 0);
+    OE_TEST(oe_load_module_host_socket_interface() == OE_OK);
+    OE_TEST(socketpair(AF_LOCAL, SOCK_STREAM, 0, sv) == 0);
+
+    /* From a file to a socket, which sendfile() accepts as output. */
+    mkpath(path, tmp_dir, "sendfile.in");
+    in_fd = open(path, OE_O_CREAT | OE_O_TRUNC | OE_O_RDWR, MODE);
+    OE_TEST(in_fd >= 0);
+    OE_TEST(write(in_fd, ALPHABET, sizeof(ALPHABET)) == sizeof(ALPHABET));
+
+    OE_TEST(sendfile(sv[0], in_fd, &offset, sizeof(ALPHABET)) == sizeof(buf));
+    OE_TEST(offset == sizeof(ALPHABET));
+    OE_TEST(read(sv[1], buf, sizeof(buf)) == sizeof(buf));
+    OE_TEST(memcmp(buf, ALPHABET, sizeof(buf)) == 0);
+
+    /* From a socket to a file, which the host relays through a pipe. */
+    mkpath(path, tmp_dir, "sendfile.out");
+    out_fd = open(path, OE_O_CREAT | OE_O_TRUNC | OE_O_RDWR, MODE);
+    OE_TEST(out_fd >= 0);
+
+    OE_TEST(write(sv[1], ALPHABET, sizeof(ALPHABET)) == sizeof(ALPHABET));
+    OE_TEST(sendfile(out_fd, sv[0], NULL, sizeof(ALPHABET)) == sizeof(buf));
+
+    OE_TEST(lseek(out_fd, 0, SEEK_SET) == 0);
+    OE_TEST(read(out_fd, buf, sizeof(buf)) == sizeof(buf));
+    OE_TEST(memcmp(buf, ALPHABET, sizeof(buf)) == 0);
+
+    OE_TEST(close(sv[0]) == 0);
+    OE_TEST(close(sv[1]) == 0);
+    OE_TEST(close(in_fd) == 0);
+    OE_TEST(close(out_fd) == 0);
+
+    OE_TEST(umount("/") == 0);
+}
+
+/* The socket that test_sendfile_drain() reads from, set once the socket's
+ * peer has a full send buffer. */
+static volatile int _drain_fd = -1;
+static volatile size_t _drain_size;
+static volatile bool _drained;
+static char _drained_tail[sizeof(ALPHABET)];
+
+/* Called on a second enclave thread to empty the socket that
+ * test_sendfile_nonblocking() sends to. */
+extern "C" void test_sendfile_drain(void)
+{
+    static char buf[4096];
+    size_t total = 0;
+    int fd;
+
+    while ((fd = _drain_fd) == -1)
+        oe_sleep_msec(10);
+
+    /* Give sendfile() time to find the send buffer full. */
+    oe_sleep_msec(100);
+
+    while (total < _drain_size)
+    {
+        ssize_t n = read(fd, buf, sizeof(buf));
+        OE_TEST(n > 0);
+
+        /* Keep the bytes that follow the filler. */
+        for (size_t i = 0; i < (size_t)n; i++)
+        {
+            size_t pos = total + i;
+            size_t tail = _drain_size - sizeof(_drained_tail);
+
+            if (pos >= tail)
+                _drained_tail[pos - tail] = buf[i];
+        }
+
+        total += (size_t)n;
+    }
+
+    _drained = true;
+}
+
+/* sendfile() from a socket to a non-blocking socket whose send buffer is full
+ * must wait for room rather than drop the data it has already read. */
+static void test_sendfile_nonblocking(void)
+{
+    static const char filler[4096] = {0};
+    int in[2];
+    int out[2];
+    size_t filled = 0;
+
+    printf("--- %s()\n", __FUNCTION__);
+
+    OE_TEST(oe_load_module_host_socket_interface() == OE_OK);
+    OE_TEST(socketpair(AF_LOCAL, SOCK_STREAM, 0, in) == 0);
+    OE_TEST(socketpair(AF_LOCAL, SOCK_STREAM, 0, out) == 0);
+    OE_TEST(fcntl(out[0], F_SETFL, O_NONBLOCK) == 0);
+
+    /* Fill the send buffer of the output socket. */
+    for (;;)
+    {
+        ssize_t n = write(out[0], filler, sizeof(filler));
+
+        if (n < 0)
+        {
+            OE_TEST(errno == EAGAIN);
+            break;
+        }
+
+        filled += (size_t)n;
+    }
+
+    OE_TEST(write(in[1], ALPHABET, sizeof(ALPHABET)) == sizeof(ALPHABET));
+
+    _drain_size = filled + sizeof(ALPHABET);
+    _drain_fd = out[1];
+
+    OE_TEST(
+        sendfile(out[0], in[0], NULL, sizeof(ALPHABET)) == sizeof(ALPHABET));
+
+    while (!_drained)
+        oe_sleep_msec(10);
+
+    OE_TEST(memcmp(_drained_tail, ALPHABET, sizeof(ALPHABET)) == 0);
+
+    OE_TEST(close(in[0]) == 0);
+    OE_TEST(close(in[1]) == 0);
+    OE_TEST(close(out[0]) == 0);
+    OE_TEST(close(out[1]) == 0);
+}
+
 extern "C" void test_dup_case1(const char* tmp_dir)
 {
     FILE* stream;
@@ -705,6 +893,10 @@ void test_fs(const char* src_dir, const char* tmp_dir)
 
     test_zero_sized_iovs();
 
+    test_sendfile(tmp_dir);
+    test_sendfile_socket(tmp_dir);
+    test_sendfile_nonblocking();
+
     /* Note: these must come last since they change STDOUT and STDERR. */
     test_dup_case1(tmp_dir);
     test_dup_case2(tmp_dir);
@@ -0,0 +1,240 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mount.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "test_protectedfs_t.h"
+
+static const char _alphabet[] = "abcdefghijklmnopqrstuvwxyz";
+
+static void _make_path(char* path, const char* tmp_dir, const char* name)
+{
+    OE_TEST(snprintf(path, PATH_MAX, "%s/%s", tmp_dir, name) < PATH_MAX);
+}
+
+static void _test_read_write(const char* tmp_dir)
+{
+    char path[PATH_MAX];
+    FILE* stream;
+    char buf[sizeof(_alphabet)];
+    struct stat st;
+
+    _make_path(path, tmp_dir, "myfile");
+
+    OE_TEST((stream = fopen(path, "w")) != NULL);
+    OE_TEST(fwrite(_alphabet, 1, sizeof(_alphabet), stream) == sizeof(buf));
+    OE_TEST(fclose(stream) == 0);
+
+    /* The logical size is reported, not the size of the host file. */
+    OE_TEST(stat(path, &st) == 0);
+    OE_TEST(S_ISREG(st.st_mode));
+    OE_TEST(st.st_size == sizeof(_alphabet));
+
+    OE_TEST((stream = fopen(path, "r")) != NULL);
+    OE_TEST(fread(buf, 1, sizeof(buf), stream) == sizeof(buf));
+    OE_TEST(memcmp(buf, _alphabet, sizeof(buf)) == 0);
+    OE_TEST(fclose(stream) == 0);
+
+    /* Append and read back the tail. */
+    OE_TEST((stream = fopen(path, "a")) != NULL);
+    OE_TEST(fwrite(_alphabet, 1, 3, stream) == 3);
+    OE_TEST(fclose(stream) == 0);
+    OE_TEST(stat(path, &st) == 0);
+    OE_TEST(st.st_size == sizeof(_alphabet) + 3);
+
+    /* Truncate, then extend with zeros. */
+    OE_TEST(truncate(path, 4) == 0);
+    OE_TEST(truncate(path, 8) == 0);
+    {
+        int fd;
+
+        OE_TEST((fd = open(path, O_RDONLY)) >= 0);
+        OE_TEST(read(fd, buf, sizeof(buf)) == 8);
+        OE_TEST(memcmp(buf, "abcd\0\0\0\0", 8) == 0);
+        OE_TEST(close(fd) == 0);
+    }
+
+    OE_TEST(unlink(path) == 0);
+    OE_TEST(stat(path, &st) != 0 && errno == ENOENT);
+}
+
+/* Write a file that is larger than the block cache in uneven chunks, then
+ * read it back at random offsets and sequentially. */
+static void _test_large_file(const char* tmp_dir)
+{
+    static unsigned char block[5000];
+    static unsigned char buf[5000];
+    const size_t size = 1024 * 1024 + 77;
+    char path[PATH_MAX];
+    size_t offset;
+    int fd;
+
+    _make_path(path, tmp_dir, "large");
+
+    for (size_t i = 0; i < sizeof(block); i++)
+        block[i] = (unsigned char)(i * 7);
+
+    OE_TEST((fd = open(path, O_CREAT | O_TRUNC | O_RDWR, 0644)) >= 0);
+
+    for (offset = 0; offset < size;)
+    {
+        size_t n = size - offset < 4999 ? size - offset : 4999;
+        OE_TEST(write(fd, block + offset % 2, n) == (ssize_t)n);
+        offset += n;
+    }
+
+    OE_TEST(lseek(fd, 0, SEEK_END) == (off_t)size);
+
+    for (offset = 17; offset < size; offset += 65537)
+    {
+        size_t chunk = (offset / 4999) * 4999;
+        size_t n = chunk + 4999 - offset;
+
+        if (n > size - offset)
+            n = size - offset;
+
+        OE_TEST(lseek(fd, (off_t)offset, SEEK_SET) == (off_t)offset);
+        OE_TEST(read(fd, buf, n) == (ssize_t)n);
+        OE_TEST(
+            memcmp(buf, block + (chunk / 4999) % 2 + (offset - chunk), n) ==
+            0);
+    }
+
+    OE_TEST(close(fd) == 0);
+
+    OE_TEST((fd = open(path, O_RDONLY)) >= 0);
+
+    for (offset = 0; offset < size;)
+    {
+        size_t n = size - offset < 4999 ? size - offset : 4999;
+        OE_TEST(read(fd, buf, n) == (ssize_t)n);
+        OE_TEST(memcmp(buf, block + offset % 2, n) == 0);
+        offset += n;
+    }
+
+    OE_TEST(read(fd, buf, 1) == 0);
+    OE_TEST(close(fd) == 0);
+    OE_TEST(unlink(path) == 0);
+}
+
+static void _test_directories(const char* tmp_dir)
+{
+    char dir_path[PATH_MAX];
+    char a[PATH_MAX];
+    char b[PATH_MAX];
+    DIR* dir;
+    struct dirent* ent;
+    size_t count = 0;
+    int fd;
+
+    _make_path(dir_path, tmp_dir, "dir");
+    _make_path(a, tmp_dir, "dir/a");
+    _make_path(b, tmp_dir, "dir/b");
+
+    OE_TEST(mkdir(dir_path, 0777) == 0);
+    OE_TEST((fd = open(a, O_CREAT | O_WRONLY, 0644)) >= 0);
+    OE_TEST(write(fd, _alphabet, 5) == 5);
+    OE_TEST(close(fd) == 0);
+
+    /* Files are not bound to their names, so they survive renames. */
+    OE_TEST(rename(a, b) == 0);
+    OE_TEST(access(a, F_OK) != 0);
+    OE_TEST(access(b, F_OK) == 0);
+    {
+        char buf[5];
+
+        OE_TEST((fd = open(b, O_RDONLY)) >= 0);
+        OE_TEST(read(fd, buf, sizeof(buf)) == 5);
+        OE_TEST(memcmp(buf, _alphabet, 5) == 0);
+        OE_TEST(close(fd) == 0);
+    }
+
+    OE_TEST((dir = opendir(dir_path)) != NULL);
+
+    while ((ent = readdir(dir)))
+    {
+        if (strcmp(ent->d_name, ".") != 0 && strcmp(ent->d_name, "..") != 0)
+        {
+            OE_TEST(strcmp(ent->d_name, "b") == 0);
+            count++;
+        }
+    }
+
+    OE_TEST(count == 1);
+    OE_TEST(closedir(dir) == 0);
+
+    OE_TEST(unlink(b) == 0);
+    OE_TEST(rmdir(dir_path) == 0);
+}
+
+/* Leave a file behind for the host to inspect and tamper with. */
+static void _write_secret(const char* tmp_dir)
+{
+    char path[PATH_MAX];
+    int fd;
+
+    _make_path(path, tmp_dir, "secret");
+
+    OE_TEST((fd = open(path, O_CREAT | O_TRUNC | O_WRONLY, 0644)) >= 0);
+
+    for (size_t i = 0; i < 1000; i++)
+        OE_TEST(write(fd, _alphabet, 26) == 26);
+
+    OE_TEST(close(fd) == 0);
+}
+
+void test_protectedfs(const char* tmp_dir)
+{
+    OE_TEST(oe_load_module_protected_file_system() == OE_OK);
+
+    /* Reject malformed options. */
+    OE_TEST(
+        mount(tmp_dir, tmp_dir, OE_PROTECTED_FILE_SYSTEM, 0, "cache=big") !=
+        0);
+
+    OE_TEST(
+        mount(tmp_dir, tmp_dir, OE_PROTECTED_FILE_SYSTEM, 0, "cache=64k") ==
+        0);
+
+    _test_read_write(tmp_dir);
+    _test_large_file(tmp_dir);
+    _test_directories(tmp_dir);
+    _write_secret(tmp_dir);
+
+    OE_TEST(umount(tmp_dir) == 0);
+}
+
+void test_tampered_file(const char* tmp_dir)
+{
+    char path[PATH_MAX];
+    char buf[26];
+    int fd;
+
+    _make_path(path, tmp_dir, "secret");
+
+    OE_TEST(mount(tmp_dir, tmp_dir, OE_PROTECTED_FILE_SYSTEM, 0, NULL) == 0);
+
+    OE_TEST((fd = open(path, O_RDONLY)) >= 0);
+    OE_TEST(read(fd, buf, sizeof(buf)) == -1);
+    OE_TEST(errno == EBADMSG);
+    OE_TEST(close(fd) == 0);
+
+    OE_TEST(umount(tmp_dir) == 0);
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* AllowDebug */
+    1024, /* HeapPageCount */
+    1024, /* StackPageCount */
+    2);   /* TCSCount */
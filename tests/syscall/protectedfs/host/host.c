@@ -0,0 +1,72 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <limits.h>
+#include <openenclave/host.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "test_protectedfs_u.h"
+
+/* Check that the host copy of the file written by the enclave contains no
+ * plaintext, then corrupt its first data block. */
+static void _tamper(const char* tmp_dir)
+{
+    char path[PATH_MAX];
+    static char data[64 * 1024];
+    FILE* stream;
+    size_t n;
+
+    OE_TEST(snprintf(path, sizeof(path), "%s/secret", tmp_dir) < PATH_MAX);
+
+    OE_TEST((stream = fopen(path, "r+b")) != NULL);
+    OE_TEST((n = fread(data, 1, sizeof(data), stream)) > 5 * 4096);
+
+    for (size_t i = 0; i + 8 <= n; i++)
+        OE_TEST(memcmp(data + i, "abcdefgh", 8) != 0);
+
+    /* Blocks 1-4 are the tree nodes on the path to the first data block. */
+    data[5 * 4096 + 100] ^= 1;
+    OE_TEST(fseek(stream, 5 * 4096 + 100, SEEK_SET) == 0);
+    OE_TEST(fwrite(&data[5 * 4096 + 100], 1, 1, stream) == 1);
+    OE_TEST(fclose(stream) == 0);
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_result_t r;
+    oe_enclave_t* enclave = NULL;
+    const uint32_t flags = oe_get_create_flags();
+    const oe_enclave_type_t type = OE_ENCLAVE_TYPE_SGX;
+
+    if (argc != 3)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH TMP_DIR\n", argv[0]);
+        return 1;
+    }
+
+    const char* enclave_path = argv[1];
+    const char* tmp_dir = argv[2];
+
+    OE_TEST(mkdir(tmp_dir, 0777) == 0);
+
+    r = oe_create_test_protectedfs_enclave(
+        enclave_path, type, flags, NULL, 0, &enclave);
+    OE_TEST(r == OE_OK);
+
+    r = test_protectedfs(enclave, tmp_dir);
+    OE_TEST(r == OE_OK);
+
+    _tamper(tmp_dir);
+
+    r = test_tampered_file(enclave, tmp_dir);
+    OE_TEST(r == OE_OK);
+
+    r = oe_terminate_enclave(enclave);
+    OE_TEST(r == OE_OK);
+
+    printf("=== passed all tests (test_protectedfs)\n");
+
+    return 0;
+}
@@ -0,0 +1,133 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mount.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "test_ramfs_t.h"
+
+static const char _alphabet[] = "abcdefghijklmnopqrstuvwxyz";
+
+static void _test_read_write(void)
+{
+    FILE* stream;
+    char buf[sizeof(_alphabet)];
+    struct stat st;
+
+    OE_TEST((stream = fopen("/tmp/myfile", "w")) != NULL);
+    OE_TEST(fwrite(_alphabet, 1, sizeof(_alphabet), stream) == sizeof(buf));
+    OE_TEST(fclose(stream) == 0);
+
+    OE_TEST(stat("/tmp/myfile", &st) == 0);
+    OE_TEST(S_ISREG(st.st_mode));
+    OE_TEST(st.st_size == sizeof(_alphabet));
+
+    OE_TEST((stream = fopen("/tmp/myfile", "r")) != NULL);
+    OE_TEST(fread(buf, 1, sizeof(buf), stream) == sizeof(buf));
+    OE_TEST(memcmp(buf, _alphabet, sizeof(buf)) == 0);
+    OE_TEST(fclose(stream) == 0);
+
+    /* Append and read back the tail. */
+    OE_TEST((stream = fopen("/tmp/myfile", "a")) != NULL);
+    OE_TEST(fwrite(_alphabet, 1, 3, stream) == 3);
+    OE_TEST(fclose(stream) == 0);
+    OE_TEST(stat("/tmp/myfile", &st) == 0);
+    OE_TEST(st.st_size == sizeof(_alphabet) + 3);
+
+    /* Truncate, then extend with zeros. */
+    OE_TEST(truncate("/tmp/myfile", 4) == 0);
+    OE_TEST(truncate("/tmp/myfile", 8) == 0);
+    {
+        int fd;
+
+        OE_TEST((fd = open("/tmp/myfile", O_RDONLY)) >= 0);
+        OE_TEST(read(fd, buf, sizeof(buf)) == 8);
+        OE_TEST(memcmp(buf, "abcd\0\0\0\0", 8) == 0);
+        OE_TEST(close(fd) == 0);
+    }
+
+    OE_TEST(unlink("/tmp/myfile") == 0);
+    OE_TEST(stat("/tmp/myfile", &st) != 0 && errno == ENOENT);
+}
+
+static void _test_directories(void)
+{
+    DIR* dir;
+    struct dirent* ent;
+    size_t count = 0;
+    int fd;
+
+    OE_TEST(mkdir("/tmp/dir", 0777) == 0);
+    OE_TEST(mkdir("/tmp/dir", 0777) != 0 && errno == EEXIST);
+    OE_TEST((fd = open("/tmp/dir/a", O_CREAT | O_WRONLY, 0644)) >= 0);
+    OE_TEST(close(fd) == 0);
+    OE_TEST(rename("/tmp/dir/a", "/tmp/dir/b") == 0);
+    OE_TEST(access("/tmp/dir/a", F_OK) != 0);
+    OE_TEST(access("/tmp/dir/b", F_OK) == 0);
+
+    OE_TEST((dir = opendir("/tmp/dir")) != NULL);
+
+    while ((ent = readdir(dir)))
+    {
+        OE_TEST(
+            strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0 ||
+            strcmp(ent->d_name, "b") == 0);
+        count++;
+    }
+
+    OE_TEST(count == 3);
+    OE_TEST(closedir(dir) == 0);
+
+    OE_TEST(rmdir("/tmp/dir") != 0 && errno == ENOTEMPTY);
+    OE_TEST(unlink("/tmp/dir/b") == 0);
+    OE_TEST(rmdir("/tmp/dir") == 0);
+}
+
+static void _test_size_limit(void)
+{
+    static char block[4096];
+    int fd;
+    ssize_t n;
+    size_t total = 0;
+
+    OE_TEST((fd = open("/tmp/big", O_CREAT | O_WRONLY, 0644)) >= 0);
+
+    while ((n = write(fd, block, sizeof(block))) > 0)
+        total += (size_t)n;
+
+    OE_TEST(n == -1 && errno == ENOSPC);
+    OE_TEST(total == 64 * 1024);
+    OE_TEST(close(fd) == 0);
+    OE_TEST(unlink("/tmp/big") == 0);
+}
+
+void test_ramfs(void)
+{
+    OE_TEST(oe_load_module_ram_file_system() == OE_OK);
+
+    /* Reject malformed options. */
+    OE_TEST(mount(NULL, "/tmp", OE_RAM_FILE_SYSTEM, 0, "size=big") != 0);
+
+    OE_TEST(mount(NULL, "/tmp", OE_RAM_FILE_SYSTEM, 0, "size=64k") == 0);
+
+    _test_read_write();
+    _test_directories();
+    _test_size_limit();
+
+    OE_TEST(umount("/tmp") == 0);
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* AllowDebug */
+    1024, /* HeapPageCount */
+    1024, /* StackPageCount */
+    2);   /* TCSCount */
@@ -0,0 +1,34 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include "test_ramfs_u.h"
+
+int main(int argc, const char* argv[])
+{
+    oe_result_t r;
+    oe_enclave_t* enclave = NULL;
+    const uint32_t flags = oe_get_create_flags();
+    const oe_enclave_type_t type = OE_ENCLAVE_TYPE_SGX;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    r = oe_create_test_ramfs_enclave(argv[1], type, flags, NULL, 0, &enclave);
+    OE_TEST(r == OE_OK);
+
+    r = test_ramfs(enclave);
+    OE_TEST(r == OE_OK);
+
+    r = oe_terminate_enclave(enclave);
+    OE_TEST(r == OE_OK);
+
+    printf("=== passed all tests (test_ramfs)\n");
+
+    return 0;
+}
@@ -0,0 +1,119 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/calls.h>
+#include <openenclave/internal/cpuid.h>
+#include <openenclave/internal/tests.h>
+#include "trap_profile_t.h"
+
+/* Executes CPUID at a single address, so that its traps are counted in a
+ * single entry of the profile. */
+OE_NEVER_INLINE static void _execute_cpuid(
+    uint32_t leaf,
+    uint32_t subleaf,
+    uint32_t regs[4])
+{
+    asm volatile("cpuid"
+                 : "=a"(regs[0]), "=b"(regs[1]), "=c"(regs[2]), "=d"(regs[3])
+                 : "0"(leaf), "2"(subleaf));
+}
+
+#define HANDLER_TSC 0x1234567890ull
+
+static volatile uint64_t _handled_rdtsc_traps;
+
+/* Handles the RDTSC traps instead of the emulation. */
+static uint64_t _rdtsc_handler(oe_exception_record_t* record)
+{
+    if (record->code != OE_EXCEPTION_ILLEGAL_INSTRUCTION ||
+        *(const uint16_t*)record->address != OE_RDTSC_OPCODE)
+        return OE_EXCEPTION_CONTINUE_SEARCH;
+
+    record->context->rax = HANDLER_TSC & 0xFFFFFFFF;
+    record->context->rdx = HANDLER_TSC >> 32;
+    record->context->rip += 2;
+    _handled_rdtsc_traps++;
+    return OE_EXCEPTION_CONTINUE_EXECUTION;
+}
+
+OE_NEVER_INLINE static uint64_t _execute_rdtsc(void)
+{
+    uint32_t low;
+    uint32_t high;
+
+    asm volatile("rdtsc" : "=a"(low), "=d"(high));
+
+    return ((uint64_t)high << 32) | low;
+}
+
+void enc_execute_cpuid(size_t count)
+{
+    uint32_t regs[4];
+
+    for (size_t i = 0; i < count; i++)
+        _execute_cpuid(1, 0, regs);
+}
+
+void enc_test_cpuid(void)
+{
+    const uint32_t leaves[] = {0, 1, 4, 7};
+    uint32_t regs[4];
+    uint32_t eax, ebx, ecx, edx;
+
+    /* oe_cpuid() returns the values that the emulation of CPUID returns. */
+    for (size_t i = 0; i < OE_COUNTOF(leaves); i++)
+    {
+        _execute_cpuid(leaves[i], 0, regs);
+
+        OE_TEST(oe_cpuid(leaves[i], 0, &eax, &ebx, &ecx, &edx) == OE_OK);
+        OE_TEST(eax == regs[0]);
+        OE_TEST(ebx == regs[1]);
+        OE_TEST(ecx == regs[2]);
+        OE_TEST(edx == regs[3]);
+    }
+
+    OE_TEST(oe_cpuid(4, 1, &eax, &ebx, &ecx, &edx) == OE_UNSUPPORTED);
+    OE_TEST(oe_cpuid(2, 0, &eax, &ebx, &ecx, &edx) == OE_UNSUPPORTED);
+    OE_TEST(
+        oe_cpuid(0x80000000, 0, &eax, &ebx, &ecx, &edx) == OE_UNSUPPORTED);
+    OE_TEST(oe_cpuid(1, 0, NULL, &ebx, &ecx, &edx) == OE_INVALID_PARAMETER);
+}
+
+void enc_test_rdtsc(void)
+{
+    /* RDTSC is emulated with the counter of the host on SGX1, which is the
+     * same counter. */
+    const uint64_t before = _execute_rdtsc();
+    const uint64_t first = oe_rdtsc();
+    const uint64_t second = oe_rdtsc();
+
+    OE_TEST(before != 0);
+    OE_TEST(first >= before);
+    OE_TEST(second >= first);
+}
+
+void enc_test_rdtsc_handler(void)
+{
+    uint64_t tsc;
+
+    OE_TEST(oe_add_vectored_exception_handler(false, _rdtsc_handler) == OE_OK);
+
+    /* With a handler registered, a trap of RDTSC (on SGX1 only) goes to the
+     * handler, but oe_rdtsc() is still emulated. */
+    tsc = _execute_rdtsc();
+    OE_TEST(_handled_rdtsc_traps == 0 || tsc == HANDLER_TSC);
+
+    tsc = oe_rdtsc();
+    OE_TEST(tsc != 0 && tsc != HANDLER_TSC);
+
+    OE_TEST(oe_remove_vectored_exception_handler(_rdtsc_handler) == OE_OK);
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* AllowDebug */
+    64,   /* HeapPageCount */
+    64,   /* StackPageCount */
+    1);   /* TCSCount */
@@ -0,0 +1,105 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "trap_profile_u.h"
+
+#define SKIP_RETURN_CODE 2
+#define NUM_TRAPS 100
+#define PROFILE_PATH "trap_profile.txt"
+
+/* Check that the profile has a line for the CPUID of _execute_cpuid(). */
+static void _test_dump(oe_enclave_t* enclave)
+{
+    FILE* stream;
+    char line[512];
+    bool found = false;
+
+    OE_TEST(oe_dump_trap_profile(NULL, stdout) == OE_INVALID_PARAMETER);
+    OE_TEST(oe_dump_trap_profile(enclave, NULL) == OE_INVALID_PARAMETER);
+    OE_TEST(oe_dump_trap_profile(enclave, stdout) == OE_OK);
+
+    OE_TEST((stream = fopen(PROFILE_PATH, "w")) != NULL);
+    OE_TEST(oe_dump_trap_profile(enclave, stream) == OE_OK);
+    fclose(stream);
+
+    OE_TEST((stream = fopen(PROFILE_PATH, "r")) != NULL);
+
+    while (fgets(line, sizeof(line), stream))
+    {
+        char instruction[16];
+        unsigned long long offset;
+        unsigned long long count;
+        unsigned long long emulated;
+        char function[256];
+
+        if (sscanf(
+                line,
+                "%15s %llx %llu %llu %255s",
+                instruction,
+                &offset,
+                &count,
+                &emulated,
+                function) != 5)
+            continue;
+
+        if (strcmp(instruction, "cpuid") == 0 &&
+            strcmp(function, "_execute_cpuid") == 0)
+        {
+            /* Leaf 1 is always emulated. */
+            OE_TEST(count >= NUM_TRAPS);
+            OE_TEST(emulated >= NUM_TRAPS);
+            found = true;
+        }
+    }
+
+    fclose(stream);
+    remove(PROFILE_PATH);
+
+    OE_TEST(found);
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_result_t result;
+    oe_enclave_t* enclave = NULL;
+    const uint32_t flags = oe_get_create_flags();
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    /* CPUID does not trap in simulation mode. */
+    if ((flags & OE_ENCLAVE_FLAG_SIMULATE) != 0)
+    {
+        printf("=== Skipped unsupported test in simulation mode "
+               "(trap_profile)\n");
+        return SKIP_RETURN_CODE;
+    }
+
+    result = oe_create_trap_profile_enclave(
+        argv[1], OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclave);
+
+    if (result != OE_OK)
+        oe_put_err("oe_create_trap_profile_enclave(): result=%u", result);
+
+    OE_TEST(enc_execute_cpuid(enclave, NUM_TRAPS) == OE_OK);
+    OE_TEST(enc_test_cpuid(enclave) == OE_OK);
+    OE_TEST(enc_test_rdtsc(enclave) == OE_OK);
+    OE_TEST(enc_test_rdtsc_handler(enclave) == OE_OK);
+
+    _test_dump(enclave);
+
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+
+    printf("=== passed all tests (trap_profile)\n");
+
+    return 0;
+}
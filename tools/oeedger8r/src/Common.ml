@@ -39,6 +39,32 @@ let get_parameter_str (p : pdecl) =
   let str = get_typed_declr_str aty declr in
   if is_const_ptr pt then "const " ^ str else str
 
+(** [conv_array_to_ptr] is used to convert Array form into Pointer form.
+    {[
+      int array[10][20] => [count = 200] int* array
+    ]}
+
+    This function is called when generating proxy/bridge code and the
+    marshalling structure. *)
+let conv_array_to_ptr (pd : pdecl) : pdecl =
+  let pt, declr = pd in
+  let get_count_attr ilist =
+    (* XXX: assume the size of each dimension will be > 0. *)
+    ANumber (List.fold_left (fun acc i -> acc * i) 1 ilist)
+  in
+  match pt with
+  | PTVal _ -> (pt, declr)
+  | PTPtr (aty, pa) ->
+      if is_array declr then
+        let tmp_declr = { declr with array_dims = [] } in
+        let tmp_aty = Ptr aty in
+        let tmp_cnt = get_count_attr declr.array_dims in
+        let tmp_pa =
+          { pa with pa_size = { empty_ptr_size with ps_count = Some tmp_cnt } }
+        in
+        (PTPtr (tmp_aty, tmp_pa), tmp_declr)
+      else (pt, declr)
+
 (** ----- End code borrowed and tweaked from {!CodeGen.ml} ----- *)
 
 (* Helper to map and filter out None at the same time. *)
@@ -97,5 +123,21 @@ let get_wrapper_prototype (fd : func_decl) (is_ecall : bool) =
   in
   sprintf "oe_result_t %s(%s)" fd.fname plist_str
 
+(** Get the type of the marshalling struct member that holds a parameter
+    of type [ptype], after [conv_array_to_ptr]. *)
+let get_marshal_member_tystr (ptype : parameter_type) =
+  let tystr = get_tystr (get_param_atype ptype) in
+  if is_foreign_array ptype then
+    sprintf "/* foreign array of type %s */ void*" tystr
+  else tystr
+
+(** Generate the prototype of the [_batch] variant of the host wrapper
+    for ECALL [fd], which makes several calls in a single ECALL. *)
+let get_batch_wrapper_prototype (fd : func_decl) =
+  sprintf
+    "oe_result_t %s_batch(\n    oe_enclave_t* enclave,\n    %s_args_t* \
+     calls,\n    size_t count)"
+    fd.fname fd.fname
+
 let get_function_id (enclave_name : string) (f : func_decl) =
   enclave_name ^ "_fcn_id_" ^ f.fname
@@ -7,6 +7,8 @@ val get_array_dims : int list -> string
 
 val get_parameter_str : Intel.Ast.pdecl -> string
 
+val conv_array_to_ptr : Intel.Ast.pdecl -> Intel.Ast.pdecl
+
 val filter_map : ('a -> 'b option) -> 'a list -> 'b list
 
 val flatten_map : ('a -> 'b list) -> 'a list -> 'b list
@@ -31,6 +33,10 @@ val is_str_or_wstr_ptr : Intel.Ast.parameter_type * 'a -> bool
 
 val is_marshalled_ptr : Intel.Ast.parameter_type -> bool
 
+val get_marshal_member_tystr : Intel.Ast.parameter_type -> string
+
 val get_wrapper_prototype : Intel.Ast.func_decl -> bool -> string
 
+val get_batch_wrapper_prototype : Intel.Ast.func_decl -> string
+
 val get_function_id : string -> Intel.Ast.func_decl -> string
@@ -119,6 +119,29 @@ let warn_size_and_count_params (fd : func_decl) =
       | _ -> ())
     fd.plist
 
+(** Asynchronous ocalls return before the host function is called, so
+    they cannot return anything and the host must only read copies of
+    their parameters. *)
+let check_async_ocall (fd : func_decl) =
+  if fd.rtype <> Void then
+    Intel.Util.failwithf
+      "Function '%s': asynchronous ocalls must return void." fd.fname;
+  List.iter
+    (fun (ptype, decl) ->
+      match ptype with
+      | PTPtr (_, ptr_attr) when not ptr_attr.pa_chkptr ->
+          Intel.Util.failwithf
+            "Function '%s': asynchronous ocalls do not support user_check \
+             parameter '%s'."
+            fd.fname decl.identifier
+      | PTPtr _ when not (is_in_ptr ptype) ->
+          Intel.Util.failwithf
+            "Function '%s': asynchronous ocalls only support [in] pointer \
+             parameters, '%s' is not one."
+            fd.fname decl.identifier
+      | _ -> ())
+    fd.plist
+
 (** Generate the Enclave code. *)
 let write_enclave_code (ec : enclave_content) (ep : Intel.Util.edger8r_params) =
   (* Short aliases for the trusted and untrusted function
@@ -158,7 +181,8 @@ let write_enclave_code (ec : enclave_content) (ep : Intel.Util.edger8r_params) =
         printf
           "Warning: Function '%s': Reentrant ocalls are not supported by Open \
            Enclave. Allow list ignored.\n"
-          f.uf_fdecl.fname)
+          f.uf_fdecl.fname;
+      if f.uf_is_async then check_async_ocall f.uf_fdecl)
     ufs;
   (* Map warning functions over trusted and untrusted function
      declarations *)
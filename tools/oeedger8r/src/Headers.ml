@@ -5,36 +5,6 @@ open Intel.Ast
 open Common
 open Printf
 
-(** ----- Begin code borrowed and tweaked from {!CodeGen.ml}. ----- *)
-
-(** [conv_array_to_ptr] is used to convert Array form into Pointer form.
-    {[
-      int array[10][20] => [count = 200] int* array
-    ]}
-
-    This function is called when generating proxy/bridge code and the
-    marshalling structure. *)
-let conv_array_to_ptr (pd : pdecl) : pdecl =
-  let pt, declr = pd in
-  let get_count_attr ilist =
-    (* XXX: assume the size of each dimension will be > 0. *)
-    ANumber (List.fold_left (fun acc i -> acc * i) 1 ilist)
-  in
-  match pt with
-  | PTVal _ -> (pt, declr)
-  | PTPtr (aty, pa) ->
-      if is_array declr then
-        let tmp_declr = { declr with array_dims = [] } in
-        let tmp_aty = Ptr aty in
-        let tmp_cnt = get_count_attr declr.array_dims in
-        let tmp_pa =
-          { pa with pa_size = { empty_ptr_size with ps_count = Some tmp_cnt } }
-        in
-        (PTPtr (tmp_aty, tmp_pa), tmp_declr)
-      else (pt, declr)
-
-(** ----- End code borrowed and tweaked from {!CodeGen.ml} ----- *)
-
 (** Generate the prototype for a given function. *)
 let get_function_prototype (fd : func_decl) =
   let plist_str =
@@ -102,13 +72,7 @@ let get_composite_type =
 
 let get_marshal_struct (fd : func_decl) (errno : bool) =
   let get_member_decl (ptype, decl) =
-    let aty = get_param_atype ptype in
-    let tystr = get_tystr aty in
-    let tystr =
-      if is_foreign_array ptype then
-        sprintf "/* foreign array of type %s */ void*" tystr
-      else tystr
-    in
+    let tystr = get_marshal_member_tystr ptype in
     let need_strlen =
       is_str_or_wstr_ptr (ptype, decl) && is_in_or_inout_ptr (ptype, decl)
     in
@@ -281,6 +245,22 @@ let generate_untrusted (ec : enclave_content) =
       List.map (fun f -> get_wrapper_prototype f.tf_fdecl true ^ ";") tfs
     else [ "/* There were no ecalls. */" ]
   in
+  let tfunc_batch_prototypes =
+    let tfs = ec.tfunc_decls in
+    if tfs <> [] then
+      [
+        "/* Each <ecall>_batch() function makes count calls to <ecall> in a";
+        "   single ECALL. The parameters of the i-th call are read from";
+        "   calls[i], and its result and return value are written to";
+        "   calls[i]._result and calls[i]._retval. */";
+        "";
+        String.concat "\n\n"
+          (List.map
+             (fun f -> get_batch_wrapper_prototype f.tf_fdecl ^ ";")
+             tfs);
+      ]
+    else [ "/* There were no ecalls. */" ]
+  in
   let ufunc_prototypes =
     let ufs = ec.ufunc_decls in
     if ufs <> [] then
@@ -308,6 +288,9 @@ let generate_untrusted (ec : enclave_content) =
     "/**** ECALL prototypes. ****/";
     String.concat "\n\n" tfunc_wrapper_prototypes;
     "";
+    "/**** ECALL batch prototypes. ****/";
+    String.concat "\n" tfunc_batch_prototypes;
+    "";
     "/**** OCALL prototypes. ****/";
     String.concat "\n\n" ufunc_prototypes;
     "";
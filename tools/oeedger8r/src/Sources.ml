@@ -726,6 +726,64 @@ let get_ocall_function_wrapper get_deepcopy enclave_name (uf : untrusted_func) =
     "";
   ]
 
+(** Generate enclave asynchronous OCALL wrapper function. Only [in]
+    parameters are allowed, so there are no outputs to unmarshal. *)
+let get_async_ocall_function_wrapper get_deepcopy enclave_name
+    (uf : untrusted_func) =
+  let fd = uf.uf_fdecl in
+  [
+    get_wrapper_prototype fd false;
+    "{";
+    "    oe_result_t _result = OE_FAILURE;";
+    "";
+    "    /* If the enclave is in crashing/crashed status, new OCALL should fail";
+    "       immediately. */";
+    "    if (oe_get_enclave_status() != OE_OK)";
+    "        return oe_get_enclave_status();";
+    "";
+    "    /* Marshalling struct. */";
+    sprintf "    %s_args_t _args, *_pargs_in = NULL;" fd.fname;
+    "";
+    "    /* Marshalling buffer and sizes. */";
+    "    size_t _input_buffer_size = 0;";
+    "    size_t _output_buffer_size = 0;";
+    "    size_t _total_buffer_size = 0;";
+    "    uint8_t* _buffer = NULL;";
+    "    uint8_t* _input_buffer = NULL;";
+    "    uint8_t* _output_buffer = NULL;";
+    "    size_t _input_buffer_offset = 0;";
+    "";
+    "    /* Fill marshalling struct. */";
+    "    memset(&_args, 0, sizeof(_args));";
+    "    " ^ String.concat "\n    " (get_filled_marshal_struct get_deepcopy fd);
+    "";
+    "    "
+    ^ String.concat "\n    "
+        (get_input_buffer get_deepcopy fd "oe_allocate_switchless_ocall_buffer");
+    "";
+    "    /* Post the call to the host without waiting for it. */";
+    "    if ((_result = oe_async_call_host_function(";
+    "             "
+    ^ String.concat ",\n             "
+        [
+          get_function_id enclave_name fd;
+          "_input_buffer";
+          "_input_buffer_size";
+          "_output_buffer";
+          "_output_buffer_size)) != OE_OK)";
+        ];
+    "        goto done;";
+    "";
+    "    _result = OE_OK;";
+    "";
+    "done:";
+    "    if (_buffer)";
+    "        oe_free_switchless_ocall_buffer(_buffer);";
+    "    return _result;";
+    "}";
+    "";
+  ]
+
 let generate_trusted (ec : enclave_content) (ep : Intel.Util.edger8r_params) =
   let get_deepcopy = get_deepcopy_function ep.experimental ec.comp_defs in
   let tfs = ec.tfunc_decls in
@@ -752,7 +810,12 @@ let generate_trusted (ec : enclave_content) (ep : Intel.Util.edger8r_params) =
   in
   let ocall_function_wrappers =
     if ufs <> [] then
-      flatten_map (get_ocall_function_wrapper get_deepcopy ec.enclave_name) ufs
+      flatten_map
+        (fun uf ->
+          if uf.uf_is_async then
+            get_async_ocall_function_wrapper get_deepcopy ec.enclave_name uf
+          else get_ocall_function_wrapper get_deepcopy ec.enclave_name uf)
+        ufs
     else [ "/* There were no ocalls. */" ]
   in
   [
@@ -814,7 +877,9 @@ let get_host_ecall_wrapper get_deepcopy enclave_name (tf : trusted_func) =
     "    memset(&_args, 0, sizeof(_args));";
     "    " ^ String.concat "\n    " (get_filled_marshal_struct get_deepcopy fd);
     "";
-    "    " ^ String.concat "\n    " (get_input_buffer get_deepcopy fd "malloc");
+    "    "
+    ^ String.concat "\n    "
+        (get_input_buffer get_deepcopy fd "oe_allocate_ecall_buffer");
     "";
     "    /* Call enclave function. */";
     "    if ((_result = " ^ ecall_function ^ "(";
@@ -837,7 +902,7 @@ let get_host_ecall_wrapper get_deepcopy enclave_name (tf : trusted_func) =
     "";
     "done:";
     "    if (_buffer)";
-    "        free(_buffer);";
+    "        oe_free_ecall_buffer(_buffer);";
     "";
     "    " ^ String.concat "\n    " (get_ptr_free_expr get_deepcopy fd.plist);
     "";
@@ -846,6 +911,183 @@ let get_host_ecall_wrapper get_deepcopy enclave_name (tf : trusted_func) =
     "";
   ]
 
+(** Declare a local variable for each parameter in [plist], read from the
+    batch call record [_call], so that the marshalling code generated for
+    the regular wrappers can be reused as is. *)
+let get_batch_param_bindings (plist : pdecl list) =
+  List.map
+    (fun (ptype, decl) ->
+      sprintf "%s %s = _call->%s;"
+        (get_marshal_member_tystr ptype)
+        decl.identifier decl.identifier)
+    (List.map conv_array_to_ptr plist)
+
+(* Generate the [_batch] variant of the host ECALL wrapper, along with the
+   helpers that marshal and unmarshal each of its calls. *)
+let get_host_ecall_batch_wrapper get_deepcopy enclave_name (tf : trusted_func)
+    =
+  let fd = tf.tf_fdecl in
+  let has_saved_ptrs =
+    flatten_map
+      (get_ptr_count get_deepcopy [] "1")
+      (List.filter is_out_or_inout_ptr fd.plist)
+    <> []
+  in
+  if has_saved_ptrs then
+    [
+      get_batch_wrapper_prototype fd;
+      "{";
+      "    OE_UNUSED(enclave);";
+      "    OE_UNUSED(calls);";
+      "    OE_UNUSED(count);";
+      "";
+      "    /* Deep-copied out parameters cannot be batched. */";
+      "    return OE_UNSUPPORTED;";
+      "}";
+      "";
+    ]
+  else
+    let out_params = List.filter is_out_or_inout_ptr fd.plist in
+    [
+      sprintf "static oe_result_t _%s_batch_marshal(" fd.fname;
+      sprintf "    %s_args_t* _call," fd.fname;
+      "    oe_enclave_function_call_t* _ecall)";
+      "{";
+      "    oe_result_t _result = OE_FAILURE;";
+      "";
+      "    /* Marshalling struct. */";
+      sprintf "    %s_args_t _args, *_pargs_in = NULL;" fd.fname;
+      "";
+      "    /* Marshalling buffer and sizes. */";
+      "    size_t _input_buffer_size = 0;";
+      "    size_t _output_buffer_size = 0;";
+      "    size_t _total_buffer_size = 0;";
+      "    uint8_t* _buffer = NULL;";
+      "    uint8_t* _input_buffer = NULL;";
+      "    uint8_t* _output_buffer = NULL;";
+      "    size_t _input_buffer_offset = 0;";
+      "";
+      "    /* Parameters of the call. */";
+      ( if fd.plist <> [] then
+        "    " ^ String.concat "\n    " (get_batch_param_bindings fd.plist)
+      else "    /* There were no parameters. */" );
+      "";
+      "    /* Fill marshalling struct. */";
+      "    memset(&_args, 0, sizeof(_args));";
+      "    " ^ String.concat "\n    " (get_filled_marshal_struct get_deepcopy fd);
+      "";
+      "    " ^ String.concat "\n    " (get_input_buffer get_deepcopy fd "malloc");
+      "";
+      "    /* Hand the buffer over to the batch. */";
+      sprintf "    _ecall->function_id = %s;" (get_function_id enclave_name fd);
+      "    _ecall->input_buffer = _input_buffer;";
+      "    _ecall->input_buffer_size = _input_buffer_size;";
+      "    _ecall->output_buffer = _output_buffer;";
+      "    _ecall->output_buffer_size = _output_buffer_size;";
+      "    _buffer = NULL;";
+      "";
+      "    /* Keep the string lengths for unmarshalling. */";
+      "    memcpy(_call, &_args, sizeof(*_call));";
+      "";
+      "    _result = OE_OK;";
+      "";
+      "done:";
+      "    if (_buffer)";
+      "        free(_buffer);";
+      "";
+      "    return _result;";
+      "}";
+      "";
+      sprintf "static oe_result_t _%s_batch_unmarshal(" fd.fname;
+      sprintf "    %s_args_t* _call," fd.fname;
+      "    const oe_enclave_function_call_t* _ecall)";
+      "{";
+      "    oe_result_t _result = OE_FAILURE;";
+      "";
+      "    /* Marshalling struct, with the string lengths of the call. */";
+      sprintf "    %s_args_t _args = *_call, *_pargs_out = NULL;" fd.fname;
+      "";
+      "    /* Marshalling buffer and sizes. */";
+      "    uint8_t* _output_buffer = (uint8_t*)_ecall->output_buffer;";
+      "    size_t _output_buffer_size = _ecall->output_buffer_size;";
+      "    size_t _output_buffer_offset = 0;";
+      "    size_t _output_bytes_written = _ecall->output_bytes_written;";
+      "";
+      "    /* Return value and out, in-out parameters of the call. */";
+      ( if fd.rtype <> Void then
+        sprintf "    %s* _retval = &_call->_retval;" (get_tystr fd.rtype)
+      else "    /* No return value. */" );
+      ( if out_params <> [] then
+        "    " ^ String.concat "\n    " (get_batch_param_bindings out_params)
+      else "    /* There were no out nor in-out parameters. */" );
+      "    OE_UNUSED(_args);";
+      "";
+      "    " ^ String.concat "\n    " (get_output_buffer get_deepcopy fd);
+      "";
+      "    _result = OE_OK;";
+      "";
+      "done:";
+      "    return _result;";
+      "}";
+      "";
+      get_batch_wrapper_prototype fd;
+      "{";
+      "    oe_result_t _result = OE_FAILURE;";
+      "    oe_enclave_function_call_t* _calls = NULL;";
+      "    size_t _i = 0;";
+      "";
+      "    if (count == 0)";
+      "        return OE_OK;";
+      "";
+      "    if (!calls)";
+      "        return OE_INVALID_PARAMETER;";
+      "";
+      "    _calls = (oe_enclave_function_call_t*)calloc(count, sizeof(*_calls));";
+      "    if (_calls == NULL)";
+      "    {";
+      "        _result = OE_OUT_OF_MEMORY;";
+      "        goto done;";
+      "    }";
+      "";
+      "    /* Marshal all the calls. */";
+      "    for (_i = 0; _i < count; _i++)";
+      "    {";
+      sprintf "        _result = _%s_batch_marshal(&calls[_i], &_calls[_i]);"
+        fd.fname;
+      "        if (_result != OE_OK)";
+      "            goto done;";
+      "    }";
+      "";
+      "    /* Make all the calls in a single ECALL. */";
+      "    if ((_result = oe_call_enclave_function_batch(";
+      "             enclave, _calls, count)) != OE_OK)";
+      "        goto done;";
+      "";
+      "    /* Unmarshal the calls that succeeded. */";
+      "    for (_i = 0; _i < count; _i++)";
+      "    {";
+      "        calls[_i]._result = _calls[_i].result;";
+      "        if (calls[_i]._result == OE_OK)";
+      "            calls[_i]._result =";
+      sprintf "                _%s_batch_unmarshal(&calls[_i], &_calls[_i]);"
+        fd.fname;
+      "    }";
+      "";
+      "    _result = OE_OK;";
+      "";
+      "done:";
+      "    if (_calls)";
+      "    {";
+      "        for (_i = 0; _i < count; _i++)";
+      "            free((void*)_calls[_i].input_buffer);";
+      "        free(_calls);";
+      "    }";
+      "";
+      "    return _result;";
+      "}";
+      "";
+    ]
+
 (* Generate ocall function. *)
 let get_ocall_function get_deepcopy (uf : untrusted_func) =
   let fd = uf.uf_fdecl in
@@ -913,6 +1155,14 @@ let generate_untrusted (ec : enclave_content) (ep : Intel.Util.edger8r_params) =
       flatten_map (get_host_ecall_wrapper get_deepcopy ec.enclave_name) tfs
     else [ "/* There were no ecalls. */" ]
   in
+  let host_ecall_batch_wrappers =
+    let tfs = ec.tfunc_decls in
+    if tfs <> [] then
+      flatten_map
+        (get_host_ecall_batch_wrapper get_deepcopy ec.enclave_name)
+        tfs
+    else [ "/* There were no ecalls. */" ]
+  in
   let ocall_functions =
     let ufs = ec.ufunc_decls in
     if ufs <> [] then flatten_map (get_ocall_function get_deepcopy) ufs
@@ -931,6 +1181,25 @@ let generate_untrusted (ec : enclave_content) (ep : Intel.Util.edger8r_params) =
       "};";
     ]
   in
+  let function_names kind names =
+    [
+      sprintf "static const char* const __%s_%s_function_names[] = {"
+        ec.enclave_name kind;
+      "    "
+      ^ String.concat "\n    "
+          (List.map (fun name -> "\"" ^ name ^ "\",") names);
+      "    NULL";
+      "};";
+    ]
+  in
+  let ecall_names =
+    function_names "ecall"
+      (List.map (fun f -> f.tf_fdecl.fname) ec.tfunc_decls)
+  in
+  let ocall_names =
+    function_names "ocall"
+      (List.map (fun f -> f.uf_fdecl.fname) ec.ufunc_decls)
+  in
   [
     sprintf "#include \"%s_u.h\"" ec.file_shortnm;
     "";
@@ -945,6 +1214,9 @@ let generate_untrusted (ec : enclave_content) (ep : Intel.Util.edger8r_params) =
     "/**** ECALL function wrappers. ****/";
     "";
     String.concat "\n" host_ecall_wrappers;
+    "/**** ECALL batch wrappers. ****/";
+    "";
+    String.concat "\n" host_ecall_batch_wrappers;
     "/**** OCALL functions. ****/";
     "";
     String.concat "\n" ocall_functions;
@@ -952,6 +1224,12 @@ let generate_untrusted (ec : enclave_content) (ep : Intel.Util.edger8r_params) =
     "";
     String.concat "\n" ocall_table;
     "";
+    "/**** Function names, reported by the call profiler. ****/";
+    "";
+    String.concat "\n" ecall_names;
+    "";
+    String.concat "\n" ocall_names;
+    "";
     sprintf "oe_result_t oe_create_%s_enclave(" ec.enclave_name;
     "    const char* path,";
     "    oe_enclave_type_t type,";
@@ -960,6 +1238,14 @@ let generate_untrusted (ec : enclave_content) (ep : Intel.Util.edger8r_params) =
     "    uint32_t setting_count,";
     "    oe_enclave_t** enclave)";
     "{";
+    "    oe_register_call_function_names(";
+    "        OE_UINT64_MAX,";
+    sprintf "        __%s_ocall_function_table," ec.enclave_name;
+    sprintf "        __%s_ecall_function_names," ec.enclave_name;
+    sprintf "        %d," (List.length ec.tfunc_decls);
+    sprintf "        __%s_ocall_function_names," ec.enclave_name;
+    sprintf "        %d);" (List.length ec.ufunc_decls);
+    "";
     "    return oe_create_enclave(";
     "               path,";
     "               type,";